@@ -19,6 +19,7 @@
 #include <cstdint>
 #include <vector>
 #include <optional>
+#include <span>
 
 namespace KeepTower {
 
@@ -100,7 +101,7 @@ struct PasswordHistoryEntry {
      * @return Deserialized entry, or empty optional on error
      */
     static std::optional<PasswordHistoryEntry> deserialize(
-        const std::vector<uint8_t>& data, size_t offset);
+        std::span<const uint8_t> data, size_t offset);
 
     /**
      * @brief Get serialized size in bytes
@@ -377,7 +378,7 @@ struct VaultSecurityPolicy {
      * @param data Binary data (must be at least 131 bytes for V2, 141 bytes for migration support)
      * @return Deserialized policy, or empty optional on error
      */
-    static std::optional<VaultSecurityPolicy> deserialize(const std::vector<uint8_t>& data);
+    static std::optional<VaultSecurityPolicy> deserialize(std::span<const uint8_t> data);
 
     /**
      * @brief Get serialized size in bytes
@@ -799,7 +800,7 @@ struct KeySlot {
      * @return Pair of (deserialized slot, bytes consumed), or empty optional on error
      */
     static std::optional<std::pair<KeySlot, size_t>> deserialize(
-        const std::vector<uint8_t>& data, size_t offset);
+        std::span<const uint8_t> data, size_t offset);
 
     /**
      * @brief Calculate serialized size for this key slot
@@ -944,7 +945,7 @@ struct VaultHeaderV2 {
      * @param data Binary data
      * @return Deserialized header, or empty optional on error
      */
-    static std::optional<VaultHeaderV2> deserialize(const std::vector<uint8_t>& data);
+    static std::optional<VaultHeaderV2> deserialize(std::span<const uint8_t> data);
 
     /**
      * @brief Calculate total serialized size
@@ -33,7 +33,7 @@ std::vector<uint8_t> PasswordHistoryEntry::serialize() const {
 }
 
 std::optional<PasswordHistoryEntry> PasswordHistoryEntry::deserialize(
-    const std::vector<uint8_t>& data, size_t offset) {
+    std::span<const uint8_t> data, size_t offset) {
 
     if (!MultiUserTypesSerDeDetail::require_bytes(data, offset, SERIALIZED_SIZE,
                                                  "PasswordHistoryEntry")) {
@@ -136,7 +136,7 @@ std::vector<uint8_t> VaultSecurityPolicy::serialize() const {
     return result;
 }
 
-std::optional<VaultSecurityPolicy> VaultSecurityPolicy::deserialize(const std::vector<uint8_t>& data) {
+std::optional<VaultSecurityPolicy> VaultSecurityPolicy::deserialize(std::span<const uint8_t> data) {
     // V2 format evolved over development (no production vaults exist):
     // - Early V2 (121 bytes): Basic multi-user, no username hashing
     // - Mid V2 (122 bytes): Added username_hash_algorithm field
@@ -501,7 +501,7 @@ std::vector<uint8_t> KeySlot::serialize() const {
 }
 
 std::optional<std::pair<KeySlot, size_t>> KeySlot::deserialize(
-    const std::vector<uint8_t>& data, size_t offset) {
+    std::span<const uint8_t> data, size_t offset) {
 
     if (offset >= data.size()) {
         Log::error("KeySlot: Insufficient data for header at offset {}", offset);
@@ -512,7 +512,7 @@ std::optional<std::pair<KeySlot, size_t>> KeySlot::deserialize(
     size_t pos = offset;
 
     auto it = [&data](size_t idx) {
-        return data.begin() + static_cast<std::vector<uint8_t>::difference_type>(idx);
+        return data.begin() + static_cast<std::span<const uint8_t>::difference_type>(idx);
     };
 
     // Byte 0: active flag
@@ -787,7 +787,7 @@ std::vector<uint8_t> VaultHeaderV2::serialize() const {
     return result;
 }
 
-std::optional<VaultHeaderV2> VaultHeaderV2::deserialize(const std::vector<uint8_t>& data) {
+std::optional<VaultHeaderV2> VaultHeaderV2::deserialize(std::span<const uint8_t> data) {
     if (!MultiUserTypesSerDeDetail::require_bytes(data, 0, VaultSecurityPolicy::SERIALIZED_SIZE + 1,
                                                  "VaultHeaderV2")) {
         return std::nullopt;
@@ -797,8 +797,7 @@ std::optional<VaultHeaderV2> VaultHeaderV2::deserialize(const std::vector<uint8_
     size_t pos = 0;
 
     // Deserialize security policy
-    std::vector<uint8_t> policy_data(data.begin(), data.begin() + VaultSecurityPolicy::SERIALIZED_SIZE);
-    auto policy_opt = VaultSecurityPolicy::deserialize(policy_data);
+    auto policy_opt = VaultSecurityPolicy::deserialize(data.first(VaultSecurityPolicy::SERIALIZED_SIZE));
     if (!policy_opt) {
         Log::error("VaultHeaderV2: Failed to deserialize security policy");
         return std::nullopt;
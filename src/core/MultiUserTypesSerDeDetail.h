@@ -5,14 +5,14 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string_view>
-#include <vector>
 
 #include "../utils/Log.h"
 
 namespace KeepTower::MultiUserTypesSerDeDetail {
 
-inline bool require_bytes(const std::vector<uint8_t>& data,
+inline bool require_bytes(std::span<const uint8_t> data,
                           size_t pos,
                           size_t needed,
                           std::string_view what) {
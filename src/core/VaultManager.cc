@@ -13,6 +13,10 @@
 #include "services/VaultDataService.h"
 #include "lib/crypto/VaultCryptoService.h"
 #include "services/VaultFileService.h"
+#include "services/VaultJournalService.h"
+#include "services/VaultSaveScheduler.h"
+#include "services/VaultScrubService.h"
+#include "services/VaultVerificationService.h"
 #include "services/VaultYubiKeyService.h"
 #include "lib/backup/VaultBackupPolicy.h"
 #include "../utils/Log.h"
@@ -28,10 +32,12 @@
 #include <google/protobuf/message.h>
 #include <algorithm>
 #include <chrono>
+#include <future>
 #include <iomanip>
 #include <random>
 #include <mutex>
 #include <cstdlib>
+#include <cstring>
 
 #ifdef __linux__
 #include <sys/mman.h>  // For mlock/munlock
@@ -67,14 +73,38 @@ VaultManager::VaultManager(std::shared_ptr<KeepTower::IVaultYubiKeyService> yubi
       m_use_reed_solomon(false),
       m_rs_redundancy_percent(DEFAULT_RS_REDUNDANCY),
       m_fec_loaded_from_file(false),
+      m_journal_enabled(false),
+      m_journal(std::make_unique<KeepTower::VaultJournalService>()),
+      m_compress_payload(false),
       m_memory_locked(false),
       m_yubikey_required(false),
       m_vault_data(std::make_unique<keeptower::VaultData>()),
           m_yubikey_service(std::move(yubikey_service)),
+      m_account_details_failed(false),
       m_pbkdf2_iterations(DEFAULT_PBKDF2_ITERATIONS) {
         m_backup_policy = std::make_unique<KeepTower::VaultBackupPolicy>(
                 true, DEFAULT_BACKUP_COUNT, "");
 
+        // Implicit saves stay synchronous until a coalescing window is configured
+        m_save_scheduler = std::make_unique<KeepTower::VaultSaveScheduler>(
+            [this]() { return capture_save_snapshot(); },
+            [](std::function<void()> capture) {
+                Glib::signal_idle().connect_once(std::move(capture));
+            },
+            std::chrono::milliseconds{0});
+        m_save_scheduler->set_completion_callback([this](bool success) {
+            // A stale report may arrive after a synchronous save or close superseded it
+            if (success || !m_vault_open || !m_save_scheduler->last_save_failed()) {
+                return;
+            }
+            m_modified = true;  // The captured changes are still unsaved
+            if (m_save_failed_callback) {
+                m_save_failed_callback();
+            }
+        });
+
+        m_scrubber = std::make_unique<KeepTower::VaultScrubService>();
+
 #ifdef __linux__
     // Check if we need to increase RLIMIT_MEMLOCK for sensitive memory locking
     // V2 vaults with multiple users need ~50 KB worst case
@@ -143,6 +173,10 @@ KeepTower::VaultResult<const KeepTower::VaultHeaderV2*> VaultManager::require_op
 
 VaultManager::~VaultManager() noexcept {
     try {
+        // Persist coalesced changes while the DEK is still available
+        if (m_vault_open && !m_save_scheduler->flush()) {
+            KeepTower::Log::error("VaultManager: Pending background save failed during shutdown");
+        }
         secure_clear(m_encryption_key);
         secure_clear(m_salt);
         secure_clear(m_yubikey_challenge);
@@ -162,6 +196,18 @@ bool VaultManager::save_vault(bool explicit_save) {
         return false;
     }
 
+    m_scrubber->notify_activity();
+
+    // This save supersedes coalesced changes; wait out any write in flight
+    m_save_scheduler->cancel_pending();
+    m_save_scheduler->wait_idle();
+
+    // Writing index-only records would drop every password and note
+    if (!ensure_account_details_loaded()) {
+        KeepTower::Log::error("VaultManager: Refusing to save without complete account details");
+        return false;
+    }
+
     // V2 vault saving
     if (m_is_v2_vault) {
         if (!m_v2_header) {
@@ -173,62 +219,367 @@ bool VaultManager::save_vault(bool explicit_save) {
         auto* metadata = m_vault_data->mutable_metadata();
         metadata->set_last_modified(std::time(nullptr));
 
-        // Serialize protobuf to binary
-        auto serialized_result = KeepTower::VaultDataService::serialize_vault_data(*m_vault_data);
-        if (!serialized_result) {
-            KeepTower::Log::error("VaultManager: Failed to serialize vault data");
+        const uint8_t data_fec_redundancy = m_use_reed_solomon ? m_rs_redundancy_percent : 0;
+        const auto journal_generation = m_journal->close_generation();
+        if (!write_v2_state(*m_vault_data, *m_v2_header, m_v2_dek, m_current_vault_path,
+                            data_fec_redundancy, m_journal_enabled, journal_generation,
+                            m_compress_payload, explicit_save)) {
             return false;
         }
-        std::vector<uint8_t> plaintext = std::move(serialized_result.value());
-        std::vector<uint8_t> ciphertext;
-        std::vector<uint8_t> data_iv = KeepTower::VaultCrypto::generate_random_bytes(KeepTower::VaultCrypto::IV_LENGTH);
 
-        if (!KeepTower::VaultCrypto::encrypt_data(plaintext, m_v2_dek, ciphertext, data_iv)) {
-            KeepTower::Log::error("VaultManager: Failed to encrypt vault data");
-            secure_clear(plaintext);
-            return false;
+        m_modified = false;
+        m_save_scheduler->clear_failure();
+        if (explicit_save) {
+            // An explicit save closes a batch of deferred directory syncs
+            (void)KeepTower::VaultFileService::sync_deferred();
         }
-        secure_clear(plaintext);
+        return true;
+    }
 
-        // Explicit save backups must capture the pre-save on-disk state.
-        if (m_backup_policy) {
-            auto backup_result = m_backup_policy->maybe_create_backup(m_current_vault_path, explicit_save);
-            if (!backup_result) {
-                KeepTower::Log::error("VaultManager: Failed to create pre-save backup for explicit save");
-                return false;
+    KeepTower::Log::error("VaultManager: Refusing to save unsupported vault version");
+    return false;
+}
+
+bool VaultManager::write_v2_state(keeptower::VaultData& data,
+                                  const KeepTower::VaultHeaderV2& header,
+                                  std::span<const uint8_t> dek,
+                                  const std::string& path,
+                                  uint8_t data_fec_redundancy,
+                                  bool journal_enabled,
+                                  uint64_t journal_generation,
+                                  bool compress_payload,
+                                  bool explicit_save) {
+    const bool enable_header_fec = true;  // Header FEC is always enabled
+    // Full writes always use the segmented payload; V2 files upgrade on their first full save
+    constexpr uint32_t format_version = KeepTower::VaultFileService::FORMAT_VERSION_SEGMENTED_PAYLOAD;
+
+    // Journaled save: append a sealed delta record when the on-disk header
+    // is still current and no compaction threshold has been reached.
+    if (journal_enabled && m_journal->is_active()) {
+        const auto base_iv = m_journal->base_iv();
+        auto header_bytes = KeepTower::VaultFileService::build_v2_header(
+            header,
+            header.security_policy.pbkdf2_iterations,
+            base_iv,
+            base_iv,
+            enable_header_fec,
+            data_fec_redundancy,
+            format_version,
+            compress_payload);
+
+        if (header_bytes && m_journal->can_append(*header_bytes, journal_generation)) {
+            if (m_backup_policy) {
+                auto backup_result = m_backup_policy->maybe_create_backup(path, explicit_save);
+                if (!backup_result) {
+                    KeepTower::Log::error("VaultManager: Failed to create pre-save backup for explicit save");
+                    return false;
+                }
+            }
+
+            auto append_result = m_journal->append(path, data, dek, journal_generation);
+            if (append_result) {
+                KeepTower::Log::info("VaultManager: V2 vault saved to journal (record {})",
+                                     m_journal->record_count());
+                return true;
             }
+            KeepTower::Log::warning("VaultManager: Journal append failed ({}), compacting",
+                                    KeepTower::to_string(append_result.error()));
+            explicit_save = false;  // Backup of the pre-save state already taken
         }
+    }
 
-        // Build V2 file format
-        if (!m_v2_header.has_value()) {
-            KeepTower::Log::error("VaultManager: V2 header not initialized");
+    // Explicit save backups must capture the pre-save on-disk state. That file
+    // is untouched until the rename in write_v2_vault(), so the copy runs
+    // while the new image is serialized and encrypted and is joined below.
+    // An early return waits for it in the future's destructor.
+    std::future<KeepTower::VaultResult<>> pending_backup;
+    if (m_backup_policy) {
+        pending_backup = m_backup_policy->begin_backup(path, explicit_save);
+    }
+
+    // Serialize, encrypt and write through one buffer: the protobuf output
+    // lands in the tail of the sealed-stream buffer and is encrypted in place,
+    // so no separate plaintext, ciphertext or file image is ever built.
+    std::vector<uint8_t> ciphertext;
+    size_t plaintext_size = 0;
+    size_t locked_size = 0;
+    bool serialized = false;
+    {
+        auto payload = KeepTower::VaultDataService::prepare_vault_payload(data);
+        if (!payload) {
+            KeepTower::Log::error("VaultManager: Failed to serialize vault data");
             return false;
         }
-        // Write header with FEC - header ALWAYS uses FEC (minimum 20% per spec)
-        // Pass user's data FEC redundancy; write_v2_vault will enforce 20% minimum for header
-        const bool enable_header_fec = true;  // Header FEC is always enabled
-        const uint8_t data_fec_redundancy = m_use_reed_solomon ? m_rs_redundancy_percent : 0;
-        auto file_write_result = KeepTower::VaultFileService::write_v2_vault(
-            m_current_vault_path,
-            *m_v2_header,
-            m_v2_header->security_policy.pbkdf2_iterations,
+        plaintext_size = compress_payload
+            ? KeepTower::VaultDataService::compressed_payload_bound(*payload)
+            : payload->size();
+        const auto sealed_size = KeepTower::VaultCrypto::sealed_stream_size(plaintext_size);
+        if (!sealed_size) {
+            KeepTower::Log::error("VaultManager: Vault payload too large to encrypt");
+            return false;
+        }
+
+        ciphertext.resize(*sealed_size);
+        if (lock_memory(ciphertext)) {  // Holds plaintext until sealed
+            locked_size = ciphertext.size();
+        }
+        if (!compress_payload) {
+            serialized = KeepTower::VaultDataService::write_vault_payload(
+                *payload, std::span<uint8_t>(ciphertext).last(plaintext_size)).has_value();
+        } else if (auto compressed = KeepTower::VaultDataService::write_compressed_payload(*payload, ciphertext)) {
+            // Deflated to the front of the buffer: shrink it to the sealed
+            // size of the actual output and move the payload to its tail
+            plaintext_size = *compressed;
+            const size_t compressed_sealed_size = *KeepTower::VaultCrypto::sealed_stream_size(plaintext_size);
+            std::memmove(ciphertext.data() + compressed_sealed_size - plaintext_size,
+                         ciphertext.data(), plaintext_size);
+            ciphertext.resize(compressed_sealed_size);
+            serialized = true;
+        }
+    }  // Tier copies of the vault are released here
+
+    std::vector<uint8_t> data_iv = KeepTower::VaultCrypto::generate_random_bytes(KeepTower::VaultCrypto::IV_LENGTH);
+    const bool sealed = serialized &&
+        KeepTower::VaultCrypto::encrypt_stream_in_place(ciphertext, plaintext_size, dek, data_iv);
+    if (!serialized) {
+        OPENSSL_cleanse(ciphertext.data(), ciphertext.size());
+    }
+    if (locked_size > 0) {
+        unlock_memory(ciphertext.data(), locked_size);  // Only ciphertext remains
+    }
+    if (!serialized) {
+        KeepTower::Log::error("VaultManager: Failed to serialize vault data");
+        return false;
+    }
+    if (!sealed) {
+        KeepTower::Log::error("VaultManager: Failed to encrypt vault data");
+        return false;
+    }
+
+    if (pending_backup.valid()) {
+        auto backup_result = pending_backup.get();
+        if (!backup_result) {
+            KeepTower::Log::error("VaultManager: Failed to create pre-save backup for explicit save");
+            return false;
+        }
+    }
+
+    // Write header with FEC - header ALWAYS uses FEC (minimum 20% per spec)
+    // Pass user's data FEC redundancy; write_v2_vault will enforce 20% minimum for header
+    auto file_write_result = KeepTower::VaultFileService::write_v2_vault(
+        path,
+        header,
+        header.security_policy.pbkdf2_iterations,
+        data_iv,
+        data_iv,
+        ciphertext,
+        enable_header_fec,
+        data_fec_redundancy,
+        format_version,
+        compress_payload);
+    if (!file_write_result) {
+        KeepTower::Log::error("VaultManager: Failed to write V2 vault file");
+        m_journal->invalidate();
+        return false;
+    }
+
+    // A full write compacts the journal: track the new base image
+    m_journal->invalidate();
+    if (journal_enabled) {
+        auto header_bytes = KeepTower::VaultFileService::build_v2_header(
+            header,
+            header.security_policy.pbkdf2_iterations,
             data_iv,
             data_iv,
-            ciphertext,
             enable_header_fec,
-            data_fec_redundancy);
-        if (!file_write_result) {
-            KeepTower::Log::error("VaultManager: Failed to write V2 vault file");
-            return false;
+            data_fec_redundancy,
+            format_version,
+            compress_payload);
+        if (header_bytes) {
+            const size_t base_size = KeepTower::VaultFileService::v2_payload_size(
+                data_fec_redundancy, ciphertext.size());
+            const uint64_t file_size = header_bytes->size() + base_size;
+            m_journal->reset(std::move(*header_bytes), data_iv, base_size,
+                             file_size, 0, data, journal_generation);
         }
+    }
 
-        m_modified = false;
-        KeepTower::Log::info("VaultManager: V2 vault saved successfully");
-        return true;
+    KeepTower::Log::info("VaultManager: V2 vault saved successfully");
+    return true;
+}
+
+bool VaultManager::persist_change() {
+    // After a background failure, save synchronously so the caller sees the result
+    if (m_save_scheduler->window().count() == 0 || m_save_scheduler->last_save_failed()) {
+        return save_vault();
     }
 
-    KeepTower::Log::error("VaultManager: Refusing to save unsupported vault version");
-    return false;
+    // The snapshot taken when the window closes includes this change
+    m_scrubber->notify_activity();
+    m_save_scheduler->notify_dirty();
+    return true;
+}
+
+std::function<bool()> VaultManager::capture_save_snapshot() {
+    if (!m_vault_open || !m_is_v2_vault || !m_v2_header) {
+        return {};
+    }
+    if (!ensure_account_details_loaded()) {
+        m_modified = true;  // Keep the change visible as unsaved
+        return {};
+    }
+
+    m_vault_data->mutable_metadata()->set_last_modified(std::time(nullptr));
+    m_modified = false;  // Restored by the completion callback if the write fails
+
+    // The background write owns copies, so edits on the GTK thread cannot race it
+    struct Snapshot {
+        keeptower::VaultData data;
+        KeepTower::VaultHeaderV2 header;
+        std::array<uint8_t, 32> dek{};
+        std::string path;
+        uint8_t data_fec_redundancy = 0;
+        bool journal_enabled = false;
+        uint64_t journal_generation = 0;
+        bool compress_payload = false;
+
+        ~Snapshot() { OPENSSL_cleanse(dek.data(), dek.size()); }
+    };
+    auto snapshot = std::make_shared<Snapshot>();
+    snapshot->data = *m_vault_data;
+    snapshot->header = *m_v2_header;
+    snapshot->dek = m_v2_dek;
+    snapshot->path = m_current_vault_path;
+    snapshot->data_fec_redundancy = m_use_reed_solomon ? m_rs_redundancy_percent : 0;
+    snapshot->journal_enabled = m_journal_enabled;
+    snapshot->journal_generation = m_journal->close_generation();
+    snapshot->compress_payload = m_compress_payload;
+
+    return [this, snapshot]() {
+        return write_v2_state(snapshot->data, snapshot->header, snapshot->dek, snapshot->path,
+                              snapshot->data_fec_redundancy, snapshot->journal_enabled,
+                              snapshot->journal_generation, snapshot->compress_payload, false);
+    };
+}
+
+void VaultManager::set_save_coalesce_window(std::chrono::milliseconds window) {
+    if (window.count() == 0) {
+        // Switching to synchronous saves: nothing may stay queued behind the window
+        (void)m_save_scheduler->flush();
+    }
+    m_save_scheduler->set_window(window);
+}
+
+std::chrono::milliseconds VaultManager::get_save_coalesce_window() const {
+    return m_save_scheduler->window();
+}
+
+bool VaultManager::flush_pending_saves() {
+    const bool ok = m_save_scheduler->flush();
+    (void)KeepTower::VaultFileService::sync_deferred();  // End of the burst
+    return ok;
+}
+
+KeepTower::VaultScrubService::Status VaultManager::get_integrity_status() const {
+    return m_scrubber->status();
+}
+
+void VaultManager::request_integrity_check() {
+    if (m_vault_open && m_is_v2_vault) {
+        m_scrubber->request_pass();
+    }
+}
+
+void VaultManager::watch_for_scrubbing() {
+    if (m_vault_open && m_is_v2_vault && !m_current_vault_path.empty()) {
+        m_scrubber->watch(m_current_vault_path, m_backup_policy->backup_path());
+    }
+}
+
+bool VaultManager::is_modified() const {
+    return m_modified || m_save_scheduler->last_save_failed();
+}
+
+struct VaultManager::DeferredAccountDetails {
+    std::future<KeepTower::VaultResult<keeptower::VaultData>> details;  ///< Parsed details tier
+    std::function<void()> on_merged;  ///< Work that needs complete records
+};
+
+void VaultManager::start_deferred_account_details(std::shared_ptr<const KeepTower::MappedVaultFile> file,
+                                                  std::span<const uint8_t> ciphertext,
+                                                  std::span<const uint8_t> iv,
+                                                  size_t details_offset,
+                                                  std::function<void()> on_merged) {
+    auto deferred = std::make_shared<DeferredAccountDetails>();
+    deferred->on_merged = std::move(on_merged);
+
+    // The worker keeps the mapping alive and owns copies of the rest; it only
+    // reaches back through an idle callback that is dropped once this load is
+    // superseded or the vault is closed.
+    std::weak_ptr<DeferredAccountDetails> weak_deferred = deferred;
+    deferred->details = std::async(std::launch::async,
+        [this, weak_deferred, file = std::move(file), ciphertext,
+         iv = std::vector<uint8_t>(iv.begin(), iv.end()),
+         dek = m_v2_dek, details_offset]() mutable -> KeepTower::VaultResult<keeptower::VaultData> {
+            std::vector<uint8_t> plaintext;
+            const bool decrypted = KeepTower::VaultCrypto::decrypt_stream_range(
+                ciphertext, dek, iv, details_offset, SIZE_MAX, plaintext);
+            OPENSSL_cleanse(dek.data(), dek.size());
+
+            KeepTower::VaultResult<keeptower::VaultData> result =
+                std::unexpected(KeepTower::VaultError::DecryptionFailed);
+            if (decrypted) {
+                result = KeepTower::VaultDataService::deserialize_vault_data(plaintext);
+                secure_clear(plaintext);
+            }
+
+            Glib::signal_idle().connect_once([this, weak_deferred]() {
+                if (weak_deferred.lock()) {
+                    if (ensure_account_details_loaded() && m_account_details_loaded_callback) {
+                        m_account_details_loaded_callback();
+                    }
+                }
+            });
+            return result;
+        });
+
+    m_deferred_details = std::move(deferred);
+    m_account_details_failed = false;
+}
+
+bool VaultManager::ensure_account_details_loaded() {
+    if (!m_deferred_details || !m_deferred_details->details.valid()) {
+        return !m_account_details_failed;
+    }
+
+    auto details = m_deferred_details->details.get();
+    if (!details) {
+        KeepTower::Log::error("VaultManager: Failed to load account details: {}",
+                              KeepTower::to_string(details.error()));
+        m_account_details_failed = true;
+        return false;
+    }
+
+    KeepTower::VaultDataService::merge_account_details(*m_vault_data, *details);
+    if (auto on_merged = std::exchange(m_deferred_details->on_merged, nullptr)) {
+        on_merged();
+    }
+    KeepTower::Log::debug("VaultManager: Merged deferred details for {} accounts",
+                          details->accounts_size());
+    return true;
+}
+
+bool VaultManager::are_account_details_loaded() const {
+    return !m_account_details_failed &&
+           (!m_deferred_details || !m_deferred_details->details.valid());
+}
+
+void VaultManager::set_account_details_loaded_callback(std::function<void()> callback) {
+    m_account_details_loaded_callback = std::move(callback);
+}
+
+void VaultManager::set_save_failed_callback(std::function<void()> callback) {
+    m_save_failed_callback = std::move(callback);
 }
 
 
@@ -237,6 +588,20 @@ bool VaultManager::close_vault() {
         return true;
     }
 
+    // Barrier: coalesced changes are written before key material is cleared
+    if (!m_save_scheduler->flush()) {
+        KeepTower::Log::error("VaultManager: Pending background save failed before close");
+    }
+    m_save_scheduler->clear_failure();
+    (void)KeepTower::VaultFileService::sync_deferred();
+
+    // Abandons a scrub pass in progress (waits for its worker)
+    m_scrubber->unwatch();
+
+    // Abandon a details load still in flight (waits for its worker)
+    m_deferred_details.reset();
+    m_account_details_failed = false;
+
     // FIPS-140-3 Compliance: Unlock and zeroize all cryptographic key material (Section 7.9)
     KeepTower::VaultHeaderV2* v2_header = (m_is_v2_vault && m_v2_header)
         ? &*m_v2_header
@@ -274,6 +639,7 @@ bool VaultManager::close_vault() {
     // Clear managers
     m_account_manager.reset();
     m_group_manager.reset();
+    m_journal->clear();
 
     m_v2_header.reset();
     m_current_session.reset();
@@ -288,6 +654,39 @@ bool VaultManager::close_vault() {
     return true;
 }
 
+void VaultManager::create_data_managers() {
+    m_account_manager = std::make_unique<KeepTower::AccountManager>(*m_vault_data, m_modified);
+    m_group_manager = std::make_unique<KeepTower::GroupManager>(*m_vault_data, m_modified);
+
+    // Group membership is indexed by account position; the save journal
+    // writes only the accounts noted here
+    m_account_manager->set_change_listener(
+        [this](KeepTower::AccountManager::AccountChange change, std::string_view account_id) {
+            if (change != KeepTower::AccountManager::AccountChange::Reordered && m_group_manager) {
+                m_group_manager->invalidate_membership_index();
+            }
+            note_account_changed(account_id);
+        });
+    m_group_manager->set_account_change_listener(
+        [this](std::string_view account_id) { note_account_changed(account_id); });
+}
+
+void VaultManager::note_account_changed(std::string_view account_id) {
+    if (m_journal_enabled) {
+        m_journal->note_account_changed(account_id);
+    }
+}
+
+void VaultManager::restore_vault_data(const keeptower::VaultData& snapshot) {
+    *m_vault_data = snapshot;
+    m_journal->note_accounts_replaced();
+
+    // Positions and IDs may all have changed
+    m_account_manager->invalidate_id_index();
+    m_group_manager->invalidate_id_index();
+    m_group_manager->invalidate_membership_index();
+}
+
 std::vector<KeepTower::AccountListItem> VaultManager::get_all_accounts_view() const {
     if (!m_account_manager) {
         return {};
@@ -428,6 +827,13 @@ std::optional<KeepTower::AccountDetail> VaultManager::get_account_view(size_t in
     return detail;
 }
 
+std::optional<size_t> VaultManager::find_account_index(std::string_view account_id) const {
+    if (!m_account_manager) {
+        return std::nullopt;
+    }
+    return m_account_manager->find_index_by_id(account_id);
+}
+
 size_t VaultManager::get_account_count() const {
     if (!m_account_manager) {
         return 0;
@@ -448,7 +854,7 @@ bool VaultManager::reorder_account(size_t old_index, size_t new_index) {
 
     // Delegate to AccountManager and save changes
     if (m_account_manager->reorder_account(old_index, new_index)) {
-        return save_vault();
+        return persist_change();
     }
     return false;
 }
@@ -460,11 +866,15 @@ bool VaultManager::reset_global_display_order() {
 
     const size_t account_count = get_account_count();
     for (size_t i = 0; i < account_count; i++) {
-        m_vault_data->mutable_accounts(static_cast<int>(i))->set_global_display_order(-1);
+        auto* account = m_vault_data->mutable_accounts(static_cast<int>(i));
+        if (account->global_display_order() != -1) {
+            account->set_global_display_order(-1);
+            note_account_changed(account->id());
+        }
     }
 
     m_modified = true;
-    return save_vault();
+    return persist_change();
 }
 
 bool VaultManager::has_custom_global_ordering() const {
@@ -497,7 +907,7 @@ std::string VaultManager::create_group(std::string_view name) {
     std::string group_id = m_group_manager->create_group(name);
     if (!group_id.empty()) {
         // Save vault after creating group
-        if (!save_vault()) {
+        if (!persist_change()) {
             const bool rolled_back = m_group_manager->delete_group(group_id);
             if (!rolled_back) {
                 KeepTower::Log::error(
@@ -519,10 +929,10 @@ bool VaultManager::delete_group(std::string_view group_id) {
     const keeptower::VaultData snapshot = *m_vault_data;
     const bool was_modified = m_modified;
     if (m_group_manager->delete_group(group_id)) {
-        if (save_vault()) {
+        if (persist_change()) {
             return true;
         }
-        *m_vault_data = snapshot;
+        restore_vault_data(snapshot);
         m_modified = was_modified;
     }
     return false;
@@ -536,10 +946,10 @@ bool VaultManager::add_account_to_group(size_t account_index, std::string_view g
     const keeptower::VaultData snapshot = *m_vault_data;
     const bool was_modified = m_modified;
     if (m_group_manager->add_account_to_group(account_index, group_id)) {
-        if (save_vault()) {
+        if (persist_change()) {
             return true;
         }
-        *m_vault_data = snapshot;
+        restore_vault_data(snapshot);
         m_modified = was_modified;
     }
     return false;
@@ -553,10 +963,10 @@ bool VaultManager::remove_account_from_group(size_t account_index, std::string_v
     const keeptower::VaultData snapshot = *m_vault_data;
     const bool was_modified = m_modified;
     if (m_group_manager->remove_account_from_group(account_index, group_id)) {
-        if (save_vault()) {
+        if (persist_change()) {
             return true;
         }
-        *m_vault_data = snapshot;
+        restore_vault_data(snapshot);
         m_modified = was_modified;
     }
     return false;
@@ -572,10 +982,10 @@ bool VaultManager::reorder_account_in_group(size_t account_index,
     const keeptower::VaultData snapshot = *m_vault_data;
     const bool was_modified = m_modified;
     if (m_group_manager->reorder_account_in_group(account_index, group_id, new_order)) {
-        if (save_vault()) {
+        if (persist_change()) {
             return true;
         }
-        *m_vault_data = snapshot;
+        restore_vault_data(snapshot);
         m_modified = was_modified;
     }
     return false;
@@ -589,7 +999,7 @@ std::string VaultManager::get_favorites_group_id() {
     std::string group_id = m_group_manager->get_favorites_group_id();
     if (!group_id.empty() && m_modified) {
         // Save if favorites group was created (ignore result - favorites ID still valid)
-        (void)save_vault();
+        (void)persist_change();
     }
     return group_id;
 }
@@ -631,10 +1041,10 @@ bool VaultManager::rename_group(std::string_view group_id, std::string_view new_
     const keeptower::VaultData snapshot = *m_vault_data;
     const bool was_modified = m_modified;
     if (m_group_manager->rename_group(group_id, new_name)) {
-        if (save_vault()) {
+        if (persist_change()) {
             return true;
         }
-        *m_vault_data = snapshot;
+        restore_vault_data(snapshot);
         m_modified = was_modified;
     }
     return false;
@@ -648,10 +1058,10 @@ bool VaultManager::reorder_group(std::string_view group_id, int new_order) {
     const keeptower::VaultData snapshot = *m_vault_data;
     const bool was_modified = m_modified;
     if (m_group_manager->reorder_group(group_id, new_order)) {
-        if (save_vault()) {
+        if (persist_change()) {
             return true;
         }
-        *m_vault_data = snapshot;
+        restore_vault_data(snapshot);
         m_modified = was_modified;
     }
     return false;
@@ -773,6 +1183,7 @@ bool VaultManager::apply_backup_settings(const BackupSettings& settings) {
     if (!m_backup_policy) [[unlikely]] {
         return false;
     }
+    m_save_scheduler->wait_idle();  // A write in flight reads the policy it started with
 
     constexpr int kMinBackups = 1;
     constexpr int kMaxBackups = 50;
@@ -796,6 +1207,7 @@ bool VaultManager::apply_backup_settings(const BackupSettings& settings) {
 
     if (m_backup_policy->backup_path() != settings.path) {
         m_backup_policy->set_backup_path(settings.path);
+        watch_for_scrubbing();  // Backups now live elsewhere
     }
 
     if (m_vault_open && persisted_settings_changed) {
@@ -818,6 +1230,16 @@ VaultManager::BackupSettings VaultManager::get_backup_settings() const {
     return settings;
 }
 
+bool VaultManager::set_backup_store(std::string_view store) {
+    const auto mode = KeepTower::VaultBackupPolicy::parse_store_mode(store);
+    if (!mode || !m_backup_policy) {
+        return false;
+    }
+    m_save_scheduler->wait_idle();  // A write in flight reads the policy it started with
+    m_backup_policy->set_store_mode(*mode);
+    return true;
+}
+
 bool VaultManager::set_rs_redundancy_percent(uint8_t percent) {
     if (percent < 5 || percent > 50) {
         return false;
@@ -830,6 +1252,20 @@ bool VaultManager::set_rs_redundancy_percent(uint8_t percent) {
     return true;
 }
 
+void VaultManager::set_journal_enabled(bool enable) {
+    m_save_scheduler->wait_idle();  // The journal is owned by any write in flight
+    m_journal_enabled = enable;
+    if (!enable) {
+        // Next save rewrites the file, folding any existing records into the base
+        m_journal->clear();
+    }
+}
+
+void VaultManager::set_payload_compression(bool enable) {
+    m_save_scheduler->wait_idle();  // A write in flight keeps the setting it started with
+    m_compress_payload = enable;
+}
+
 void VaultManager::set_clipboard_timeout(int timeout_seconds) {
     m_preferences.set_clipboard_timeout(timeout_seconds);
     if (m_vault_open) {
@@ -1172,7 +1608,9 @@ KeepTower::VaultResult<> VaultManager::restore_from_most_recent_backup(const std
         return std::unexpected(KeepTower::VaultError::InvalidData);
     }
 
-    return m_backup_policy->restore_from_most_recent_backup(vault_path);
+    // Skip backups whose header or data would not survive an open
+    return m_backup_policy->restore_from_most_recent_backup(
+        vault_path, &KeepTower::VaultVerificationService::is_restorable);
 }
 
 std::string VaultManager::get_current_username() const {
@@ -15,6 +15,7 @@
 #define VAULTMANAGER_H
 
 #include <array>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <string>
@@ -36,6 +37,9 @@
 // FIPS-140-3 management delegates directly to FipsProviderManager
 #include "lib/fips/FipsProviderManager.h"
 
+// Integrity status is reported as the scrubber's own snapshot
+#include "services/VaultScrubService.h"
+
 // Forward declare for conditional compilation
 #if __has_include("config.h")
 #include "config.h"
@@ -58,10 +62,13 @@ namespace KeepTower {
 class AccountManager;
 class GroupManager;
 class IVaultYubiKeyService;
+class MappedVaultFile;
 class VaultBackupPolicy;
 class VaultCryptoService;
 class VaultYubiKeyService;
 class VaultFileService;
+class VaultJournalService;
+class VaultSaveScheduler;
 class VaultCreationOrchestrator;
 }  // namespace KeepTower
 
@@ -1076,6 +1083,14 @@ public:
      */
     [[nodiscard]] std::optional<KeepTower::AccountDetail> get_account_view(size_t index) const;
 
+    /**
+     * @brief Find an account by ID
+     * @param account_id Account ID
+     * @return Zero-based index, or std::nullopt if vault closed or no such account
+     * @note Constant time (hash index in AccountManager)
+     */
+    [[nodiscard]] std::optional<size_t> find_account_index(std::string_view account_id) const;
+
     /**
      * @brief Get number of accounts in vault
      * @return Account count, or 0 if vault not open
@@ -1242,8 +1257,9 @@ public:
     const std::string& get_current_vault_path() const { return m_current_vault_path; }
 
     /** @brief Check if vault has unsaved modifications
-     *  @return true if vault has been modified since last save */
-    bool is_modified() const { return m_modified; }
+     *  @return true if vault has been modified since last save, or a
+     *          coalesced background save failed */
+    bool is_modified() const;
 
     // Reed-Solomon error correction
 
@@ -1292,6 +1308,146 @@ public:
      */
     uint8_t get_rs_redundancy_percent() const { return m_rs_redundancy_percent; }
 
+    // Journaled saves
+
+    /**
+     * @brief Enable or disable journaled save mode
+     * @param enable true to append encrypted delta records instead of rewriting
+     *
+     * When enabled, save_vault() appends an individually sealed record holding
+     * only the accounts and settings that changed since the last save. The
+     * file is compacted into a fresh base image automatically once the journal
+     * grows past its thresholds, or whenever the header changes (user
+     * management, FEC settings, password changes).
+     *
+     * @note Vaults written in this mode open normally; the journal is replayed
+     *       on top of the base payload during open_vault_v2().
+     */
+    void set_journal_enabled(bool enable);
+
+    /**
+     * @brief Check if journaled save mode is enabled
+     * @return true if saves append delta records when possible
+     */
+    bool is_journal_enabled() const { return m_journal_enabled; }
+
+    // Payload compression
+
+    /**
+     * @brief Compress the vault payload before it is encrypted
+     * @param enable true to deflate the serialized vault data on full saves
+     *
+     * Takes effect on the next full write; the header flags record whether a
+     * file's payload is compressed, so vaults open either way. A compressed
+     * payload has to be decrypted whole, so unlocking it cannot show the
+     * account list before the remaining account fields are decrypted.
+     */
+    void set_payload_compression(bool enable);
+
+    /**
+     * @brief Check if full saves compress the vault payload
+     * @return true if payloads are compressed before encryption
+     */
+    bool is_payload_compression_enabled() const { return m_compress_payload; }
+
+    // Coalesced background saves
+
+    /**
+     * @brief Set the coalescing window for implicit saves
+     * @param window Window length (0 = save synchronously, the default)
+     *
+     * Structural edits that persist themselves (group changes, drag-and-drop
+     * reordering, display-order resets) normally save on the calling thread.
+     * With a non-zero window they only mark the vault dirty; once no further
+     * edit arrives within the window, a snapshot is taken on the GTK thread
+     * and written on a background thread. Bursts of edits therefore cost a
+     * single serialize/encrypt/fsync cycle.
+     *
+     * @note save_vault() and close_vault() act as barriers: pending changes
+     *       are superseded or flushed before they proceed.
+     * @note A failed background save marks the vault modified and invokes
+     *       the callback set with set_save_failed_callback(). Until a later
+     *       save succeeds, implicit saves run synchronously again so the
+     *       mutating call reports the failure itself.
+     */
+    void set_save_coalesce_window(std::chrono::milliseconds window);
+
+    /**
+     * @brief Get the coalescing window for implicit saves
+     * @return Window length (0 when implicit saves are synchronous)
+     */
+    [[nodiscard]] std::chrono::milliseconds get_save_coalesce_window() const;
+
+    /**
+     * @brief Write pending coalesced changes now and wait for completion
+     * @return true if nothing was pending or the write succeeded
+     *
+     * Also completes directory syncs deferred by
+     * VaultFileService::SyncPolicy::Batched, as do explicit saves and
+     * close_vault().
+     */
+    [[nodiscard]] bool flush_pending_saves();
+
+    /**
+     * @brief Get the state of the background integrity scrubber
+     * @return Whether the open vault is watched, whether a pass is running,
+     *         and the findings of the last complete pass
+     *
+     * While a V2 vault is open, its file and backup copies are re-read in the
+     * background once the application has been idle for a while, and
+     * damage that FEC can correct is repaired in place. See VaultScrubService.
+     */
+    [[nodiscard]] KeepTower::VaultScrubService::Status get_integrity_status() const;
+
+    /**
+     * @brief Check the open vault and its backups now rather than when idle
+     *
+     * Returns immediately; poll get_integrity_status() for the outcome.
+     */
+    void request_integrity_check();
+
+    // Deferred account details
+
+    /**
+     * @brief Wait for account details deferred by open_vault_v2()
+     * @return false if the details could not be decrypted or parsed
+     *
+     * Vaults saved with a two-tier payload open from their account-list index
+     * (names, usernames, websites, tags, groups, flags, ordering). The
+     * remaining account fields (passwords, notes, custom fields, history) are
+     * decrypted and parsed on a background thread. Accessors that need full
+     * records (get_account_view(), update_account(), AccountManager::get_account())
+     * wait for them automatically; this is the explicit barrier.
+     *
+     * @note After a failure the vault refuses to save, since a write would
+     *       drop the missing details.
+     */
+    [[nodiscard]] bool ensure_account_details_loaded();
+
+    /**
+     * @brief Check whether every account record is complete
+     * @return false while details are still loading or after they failed to load
+     */
+    [[nodiscard]] bool are_account_details_loaded() const;
+
+    /**
+     * @brief Register a callback for background completion of account details
+     * @param callback Invoked on the GTK thread once deferred details are merged
+     *
+     * Account lists built before completion lack detail fields such as notes;
+     * the callback lets views refresh themselves.
+     */
+    void set_account_details_loaded_callback(std::function<void()> callback);
+
+    /**
+     * @brief Register a callback for failed background saves
+     * @param callback Invoked on the GTK thread when a coalesced save fails
+     *
+     * The in-memory changes are kept and is_modified() reports them, so the
+     * callback only has to tell the user; an explicit save retries the write.
+     */
+    void set_save_failed_callback(std::function<void()> callback);
+
     /**
      * @brief Set clipboard timeout for current vault
      * @param timeout_seconds Timeout in seconds (0 = disabled)
@@ -1440,13 +1596,24 @@ public:
      *  @return Current backup settings. */
     [[nodiscard]] BackupSettings get_backup_settings() const;
 
+    /**
+     * @brief Select where new backups are kept
+     * @param store "copies" (full copy per backup), "chunked" (deduplicated
+     *        chunk store) or "chunked-compressed"
+     * @return false for an unknown store name (the setting is unchanged)
+     *
+     * A runtime setting like the backup path; it is not stored in the vault.
+     */
+    [[nodiscard]] bool set_backup_store(std::string_view store);
+
     /**
      * @brief Restore vault from most recent backup
         * @param vault_path Vault file path whose latest backup should be restored.
      * @return Expected void or VaultError
      *
-     * Finds the most recent timestamped backup and restores it.
-     * Current vault must be closed before calling.
+     * Finds the most recent timestamped backup that would open (header and
+     * data pass VaultVerificationService's structural checks) and restores
+     * it. Current vault must be closed before calling.
      *
      * @note This replaces the current vault file with the backup
      */
@@ -1564,6 +1731,76 @@ private:
     // Schema migration
     bool migrate_vault_schema();
 
+    /**
+     * @brief Write a V2 vault image (or journal record) for the given state
+     * @param data Vault data to persist
+     * @param header V2 header to write
+     * @param dek Data encryption key
+     * @param path Vault file path
+     * @param data_fec_redundancy Data FEC redundancy (0 = disabled)
+     * @param journal_enabled Whether a journal append may replace the full write
+     * @param journal_generation Generation of journal notes @p data includes
+     * @param compress_payload Whether a full write compresses the payload
+     * @param explicit_save Whether a pre-save backup is taken
+     * @return true on success
+     *
+     * Shared by the synchronous save_vault() path and coalesced background
+     * saves. Does not touch m_modified or any other GTK-thread state.
+     */
+    [[nodiscard]] bool write_v2_state(keeptower::VaultData& data,
+                                      const KeepTower::VaultHeaderV2& header,
+                                      std::span<const uint8_t> dek,
+                                      const std::string& path,
+                                      uint8_t data_fec_redundancy,
+                                      bool journal_enabled,
+                                      uint64_t journal_generation,
+                                      bool compress_payload,
+                                      bool explicit_save);
+
+    /**
+     * @brief Persist a structural change, coalesced when a save window is set
+     * @return Result of the synchronous save, or true once a background save is scheduled
+     *
+     * Saves synchronously while the last background save is failed, so
+     * callers that roll back on failure still see it.
+     */
+    [[nodiscard]] bool persist_change();
+
+    /**
+     * @brief Snapshot current state for a background save (GTK thread)
+     * @return Write task, or empty when no V2 vault is open
+     */
+    [[nodiscard]] std::function<bool()> capture_save_snapshot();
+
+    /** @brief Create the account and group managers over m_vault_data */
+    void create_data_managers();
+
+    /** @brief Tell the save journal an account changed (when journaling) */
+    void note_account_changed(std::string_view account_id);
+
+    /** @brief Put back vault data saved before a failed change, dropping stale indexes */
+    void restore_vault_data(const keeptower::VaultData& snapshot);
+
+    /** @brief Point the integrity scrubber at the open vault and current backup directory */
+    void watch_for_scrubbing();
+
+    /// Background load of the account-details tier (defined in VaultManager.cc)
+    struct DeferredAccountDetails;
+
+    /**
+     * @brief Decrypt and parse the account-details tier on a worker thread
+     * @param file Mapped vault file (the worker keeps it alive)
+     * @param ciphertext Base payload ciphertext inside @p file
+     * @param iv Payload IV
+     * @param details_offset Plaintext offset of the details tier
+     * @param on_merged Runs on the GTK thread once records are complete
+     */
+    void start_deferred_account_details(std::shared_ptr<const KeepTower::MappedVaultFile> file,
+                                        std::span<const uint8_t> ciphertext,
+                                        std::span<const uint8_t> iv,
+                                        size_t details_offset,
+                                        std::function<void()> on_merged);
+
     // State
     bool m_vault_open;
     bool m_modified;
@@ -1586,6 +1823,12 @@ private:
     // Backup configuration
     std::unique_ptr<KeepTower::VaultBackupPolicy> m_backup_policy;
 
+    // Mutation journal (journaled save mode)
+    bool m_journal_enabled;
+    std::unique_ptr<KeepTower::VaultJournalService> m_journal;
+
+    bool m_compress_payload;  // Compress payloads before encryption on full saves
+
     // Phase C: Vault runtime preferences (clipboard timeout, auto-lock, undo/redo, etc.)
     KeepTower::VaultRuntimePreferences m_preferences;
 
@@ -1611,6 +1854,18 @@ private:
     std::shared_ptr<KeepTower::IVaultYubiKeyService> m_yubikey_service;
     std::shared_ptr<KeepTower::VaultFileService> m_file_service;
 
+    // Two-tier open: account details still being decrypted in the background
+    std::shared_ptr<DeferredAccountDetails> m_deferred_details;
+    bool m_account_details_failed;
+    std::function<void()> m_account_details_loaded_callback;
+    std::function<void()> m_save_failed_callback;
+
+    // Idle-time integrity checks of the vault file and its backups
+    std::unique_ptr<KeepTower::VaultScrubService> m_scrubber;
+
+    // Coalesced background saves (declared last so its worker stops first)
+    std::unique_ptr<KeepTower::VaultSaveScheduler> m_save_scheduler;
+
     /**
      * @brief Create and configure VaultCreationOrchestrator with services
      * @return Configured orchestrator instance
@@ -22,6 +22,7 @@
 #include "lib/crypto/VaultCryptoService.h"
 #include "services/VaultFileService.h"
 #include "services/VaultDataService.h"
+#include "services/VaultJournalService.h"
 #include "lib/backup/VaultBackupPolicy.h"
 #include "services/KeySlotManager.h"
 #include "services/VaultYubiKeyService.h"
@@ -54,6 +55,38 @@ using KeepTower::VaultSecurityPolicy;
 using KeepTower::KeyWrapping;
 namespace Log = KeepTower::Log;
 
+namespace {
+
+/**
+ * Decrypt only the account-list index of a two-tier segmented payload.
+ * Returns the plaintext offset of the details tier, or nullopt for payloads
+ * that must be decrypted whole (single-tier layout or damaged index).
+ */
+std::optional<size_t> decrypt_payload_index(std::span<const uint8_t> ciphertext,
+                                            std::span<const uint8_t> dek,
+                                            std::span<const uint8_t> iv,
+                                            std::vector<uint8_t>& index) {
+    constexpr size_t prefix_length = KeepTower::VaultDataService::PAYLOAD_PREFIX_LENGTH;
+    std::vector<uint8_t> prefix;
+    if (!KeepTower::VaultCrypto::decrypt_stream_range(ciphertext, dek, iv, 0, prefix_length, prefix)) {
+        return std::nullopt;
+    }
+    const auto index_end = KeepTower::VaultDataService::payload_index_end(prefix);
+    if (!index_end ||
+        !KeepTower::VaultCrypto::decrypt_stream_range(ciphertext, dek, iv, prefix_length,
+                                                      *index_end - prefix_length, index)) {
+        return std::nullopt;
+    }
+    if (index.size() != *index_end - prefix_length) {
+        OPENSSL_cleanse(index.data(), index.size());
+        index.clear();
+        return std::nullopt;
+    }
+    return index_end;
+}
+
+}  // namespace
+
 // ============================================================================
 // Phase 2 Day 5: Orchestrator Factory
 // ============================================================================
@@ -155,8 +188,9 @@ KeepTower::VaultResult<> VaultManager::create_vault_v2(
 
     // Initialize empty vault data and managers
     m_vault_data->Clear();  // Empty protobuf structure
-    m_account_manager = std::make_unique<KeepTower::AccountManager>(*m_vault_data, m_modified);
-    m_group_manager = std::make_unique<KeepTower::GroupManager>(*m_vault_data, m_modified);
+    create_data_managers();
+
+    watch_for_scrubbing();
 
     Log::info("VaultManager: V2 vault created successfully with admin user");
     return {};
@@ -239,8 +273,9 @@ void VaultManager::create_vault_v2_async(
 
         // Initialize empty vault data and managers
         m_vault_data->Clear();
-        m_account_manager = std::make_unique<KeepTower::AccountManager>(*m_vault_data, m_modified);
-        m_group_manager = std::make_unique<KeepTower::GroupManager>(*m_vault_data, m_modified);
+        create_data_managers();
+
+        watch_for_scrubbing();
 
         Log::info("VaultManager: Async V2 vault created successfully with admin user");
 
@@ -274,14 +309,14 @@ KeepTower::VaultResult<KeepTower::UserSession> VaultManager::open_vault_v2(
         }
     }
 
-    // Read vault file from disk
-    std::vector<uint8_t> file_data;
-    int iterations_from_file = 0;
-    auto read_result = KeepTower::VaultFileService::read_vault_file(path, file_data, iterations_from_file);
-    if (!read_result) {
+    // Map vault file read-only; every stage below parses spans of the mapping
+    auto map_result = KeepTower::VaultFileService::map_vault_file(path);
+    if (!map_result) {
         Log::error("VaultManager: Failed to read V2 vault file: {}", path);
-        return std::unexpected(read_result.error());
+        return std::unexpected(map_result.error());
     }
+    const auto mapped_file = std::make_shared<const KeepTower::MappedVaultFile>(std::move(*map_result));
+    const std::span<const uint8_t> file_data = mapped_file->bytes();
 
     // Parse V2 header
     auto metadata_result = KeepTower::VaultFileService::read_v2_metadata(file_data);
@@ -412,20 +447,86 @@ KeepTower::VaultResult<KeepTower::UserSession> VaultManager::open_vault_v2(
         return std::unexpected(VaultError::CorruptedFile);
     }
 
-    std::vector<uint8_t> ciphertext(
-        file_data.begin() + static_cast<std::ptrdiff_t>(metadata.data_offset),
-        file_data.end());
+    // Split base ciphertext from any mutation journal appended behind it
+    const std::span<const uint8_t> payload = file_data.subspan(metadata.data_offset);
+    const bool segmented = metadata.format_version ==
+        KeepTower::VaultFileService::FORMAT_VERSION_SEGMENTED_PAYLOAD;
+
+    // Data FEC repairs the ciphertext before GCM sees it
+    auto data_section = KeepTower::VaultFileService::open_v2_data_section(metadata, payload);
+    if (!data_section) {
+        Log::error("VaultManager: Vault data section unreadable: {}", to_string(data_section.error()));
+        return std::unexpected(data_section.error());
+    }
+    const bool data_fec = metadata.data_fec_parity_symbols != 0;
+    const bool repaired = !data_section->repaired.empty();
 
     // Decrypt vault data
     std::vector<uint8_t> plaintext;
     std::span<const uint8_t> iv_span(metadata.data_iv);
-    if (!KeepTower::VaultCrypto::decrypt_data(ciphertext, m_v2_dek, iv_span, plaintext)) {
-        Log::error("VaultManager: Failed to decrypt vault data");
-        return std::unexpected(VaultError::DecryptionFailed);
+    KeepTower::VaultJournalService::PayloadLayout journal_layout;
+    std::span<const uint8_t> base_ciphertext;
+    std::optional<size_t> details_offset;  // Set when account details load in the background
+    if (segmented) {
+        // Segmented payloads record their own length: no magic scan needed
+        const auto ciphertext = data_section->ciphertext;
+        const auto base_size = KeepTower::VaultCrypto::stream_ciphertext_size(ciphertext);
+        if (!base_size || *base_size > ciphertext.size() ||
+            (data_fec && *base_size != ciphertext.size())) {
+            Log::error("VaultManager: Invalid segmented payload header");
+            return std::unexpected(VaultError::CorruptedFile);
+        }
+        journal_layout = KeepTower::VaultJournalService::split_payload(
+            payload, data_fec ? data_section->stored_size : *base_size);
+        base_ciphertext = ciphertext.first(*base_size);
+
+        // Journal records apply to complete accounts, so only a bare base
+        // image can open from its account-list index alone; a compressed
+        // payload has no index readable on its own. A repaired image is not
+        // in the mapping the background loader reads from.
+        if (journal_layout.frames.empty() && !metadata.compressed_payload && !repaired) {
+            details_offset = decrypt_payload_index(base_ciphertext, m_v2_dek, iv_span, plaintext);
+        }
+        if (!details_offset &&
+            !KeepTower::VaultCrypto::decrypt_stream(base_ciphertext, m_v2_dek, iv_span, plaintext)) {
+            Log::error("VaultManager: Failed to decrypt vault data");
+            return std::unexpected(VaultError::DecryptionFailed);
+        }
+    } else if (data_fec) {
+        journal_layout = KeepTower::VaultJournalService::split_payload(payload, data_section->stored_size);
+        if (!KeepTower::VaultCrypto::decrypt_data(data_section->ciphertext, m_v2_dek, iv_span, plaintext)) {
+            Log::error("VaultManager: Failed to decrypt vault data");
+            return std::unexpected(VaultError::DecryptionFailed);
+        }
+    } else {
+        journal_layout = KeepTower::VaultJournalService::split_payload(payload);
+        if (!KeepTower::VaultCrypto::decrypt_data(
+                payload.first(journal_layout.base_size), m_v2_dek, iv_span, plaintext)) {
+            // Ciphertext may contain the frame magic by chance: retry as a plain payload
+            const bool retried = journal_layout.base_size != payload.size() &&
+                KeepTower::VaultCrypto::decrypt_data(payload, m_v2_dek, iv_span, plaintext);
+            if (!retried) {
+                Log::error("VaultManager: Failed to decrypt vault data");
+                return std::unexpected(VaultError::DecryptionFailed);
+            }
+            journal_layout = {payload.size(), payload.size(), {}};
+        }
     }
 
-    // Parse protobuf
-    auto vault_data_result = KeepTower::VaultDataService::deserialize_vault_data(plaintext);
+    if (metadata.compressed_payload) {
+        auto inflated = KeepTower::VaultDataService::decompress_vault_payload(plaintext);
+        secure_clear(plaintext);
+        if (!inflated) {
+            Log::error("VaultManager: Failed to decompress vault data");
+            return std::unexpected(VaultError::CorruptedFile);
+        }
+        plaintext = std::move(*inflated);
+    }
+
+    // Parse protobuf (the index tier alone when details are deferred)
+    auto vault_data_result = details_offset
+        ? KeepTower::VaultDataService::deserialize_vault_data(plaintext)
+        : KeepTower::VaultDataService::deserialize_vault_payload(plaintext);
     if (!vault_data_result) {
         Log::error("VaultManager: Failed to parse vault data");
         secure_clear(plaintext);
@@ -434,6 +535,16 @@ KeepTower::VaultResult<KeepTower::UserSession> VaultManager::open_vault_v2(
     keeptower::VaultData vault_data = std::move(vault_data_result.value());
     secure_clear(plaintext);
 
+    // Replay journaled mutations on top of the base image
+    const size_t journal_records = KeepTower::VaultJournalService::replay(
+        journal_layout.frames, m_v2_dek, iv_span, vault_data);
+    const bool journal_intact = journal_records == journal_layout.frames.size() &&
+                                journal_layout.valid_size == payload.size();
+    if (!journal_intact) {
+        Log::warning("VaultManager: Ignoring damaged journal tail ({} of {} records replayed)",
+                     journal_records, journal_layout.frames.size());
+    }
+
     // Update last login timestamp
     user_slot->last_login_at = std::chrono::system_clock::now().time_since_epoch().count();
 
@@ -502,9 +613,36 @@ KeepTower::VaultResult<KeepTower::UserSession> VaultManager::open_vault_v2(
         Log::info("VaultManager: V2 vault has data FEC disabled (header FEC still enabled at 20% per spec)");
     }
 
+    // Track the on-disk image so the next save can append; a damaged journal
+    // tail forces a compacting rewrite instead. The journal diffs against
+    // complete records, so a deferred open tracks the image once they arrive.
+    m_journal->clear();
+    std::function<void()> track_journal_base;
+    if (m_journal_enabled && journal_intact) {
+        track_journal_base = [this,
+                              header_bytes = std::vector<uint8_t>(
+                                  file_data.begin(),
+                                  file_data.begin() + static_cast<std::ptrdiff_t>(metadata.data_offset)),
+                              base_iv = metadata.data_iv,
+                              base_size = journal_layout.base_size,
+                              file_size = file_data.size(),
+                              journal_records]() mutable {
+            m_journal->reset(std::move(header_bytes), base_iv, base_size, file_size,
+                             journal_records, *m_vault_data);
+        };
+    }
+
     // Initialize managers after vault data is loaded
-    m_account_manager = std::make_unique<KeepTower::AccountManager>(*m_vault_data, m_modified);
-    m_group_manager = std::make_unique<KeepTower::GroupManager>(*m_vault_data, m_modified);
+    create_data_managers();
+
+    if (details_offset) {
+        m_account_manager->set_details_loader([this]() { return ensure_account_details_loaded(); });
+        start_deferred_account_details(mapped_file, base_ciphertext, iv_span, *details_offset,
+                                       std::move(track_journal_base));
+        Log::info("VaultManager: Opened account index; loading account details in background");
+    } else if (track_journal_base) {
+        track_journal_base();
+    }
 
     // Create session
     UserSession session{
@@ -522,6 +660,7 @@ KeepTower::VaultResult<KeepTower::UserSession> VaultManager::open_vault_v2(
     }
 
     m_current_session = session;
+    watch_for_scrubbing();
 
     Log::info("VaultManager: User authenticated successfully");
     return session;
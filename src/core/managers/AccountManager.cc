@@ -3,7 +3,9 @@
 
 #include "AccountManager.h"
 #include "../../utils/Cpp23Compat.h"
+#include "../../utils/Log.h"
 #include <algorithm>
+#include <utility>
 
 #if KEEPTOWER_HAS_RANGES
 #include <ranges>
@@ -11,13 +13,42 @@
 
 namespace KeepTower {
 
+namespace {
+
+const std::string& account_id_of(const keeptower::AccountRecord& account) {
+    return account.id();
+}
+
+}  // namespace
+
 AccountManager::AccountManager(keeptower::VaultData& vault_data, bool& modified_flag)
     : m_vault_data(vault_data), m_modified_flag(modified_flag) {}
 
+void AccountManager::set_details_loader(DetailsLoader loader) {
+    m_details_loader = std::move(loader);
+}
+
+void AccountManager::set_change_listener(ChangeListener listener) {
+    m_change_listener = std::move(listener);
+}
+
+bool AccountManager::load_details() const {
+    return !m_details_loader || m_details_loader();
+}
+
+void AccountManager::notify_changed(AccountChange change, std::string_view account_id) const {
+    if (m_change_listener) {
+        m_change_listener(change, account_id);
+    }
+}
+
 bool AccountManager::add_account(const keeptower::AccountRecord& account) {
     auto* new_account = m_vault_data.add_accounts();
     new_account->CopyFrom(account);
+    m_id_index.appended(m_vault_data.accounts(), account_id_of);
+    check_id_index();
     m_modified_flag = true;
+    notify_changed(AccountChange::Added, account.id());
     return true;
 }
 
@@ -42,12 +73,19 @@ std::vector<keeptower::AccountRecord> AccountManager::get_all_accounts() const {
 }
 
 bool AccountManager::update_account(size_t index, const keeptower::AccountRecord& account) {
-    if (!compat::is_valid_index(index, m_vault_data.accounts_size())) {
+    if (!compat::is_valid_index(index, m_vault_data.accounts_size()) || !load_details()) {
         return false;
     }
 
-    m_vault_data.mutable_accounts(static_cast<int>(index))->CopyFrom(account);
+    auto* existing = m_vault_data.mutable_accounts(static_cast<int>(index));
+    const std::string old_id = existing->id();
+    existing->CopyFrom(account);
     m_modified_flag = true;
+    notify_changed(AccountChange::Rewritten, old_id);
+    if (old_id != account.id()) {
+        m_id_index.invalidate();
+        notify_changed(AccountChange::Added, account.id());
+    }
     return true;
 }
 
@@ -58,23 +96,48 @@ bool AccountManager::delete_account(size_t index) {
 
     // Remove account by shifting
     auto* accounts = m_vault_data.mutable_accounts();
+    const std::string erased_id = accounts->Get(static_cast<int>(index)).id();
     accounts->erase(accounts->begin() + static_cast<std::ptrdiff_t>(index));
+    m_id_index.erased(*accounts, index, erased_id, account_id_of);
+    check_id_index();
     m_modified_flag = true;
+    notify_changed(AccountChange::Removed, erased_id);
     return true;
 }
 
 const keeptower::AccountRecord* AccountManager::get_account(size_t index) const {
-    if (!compat::is_valid_index(index, m_vault_data.accounts_size())) {
+    if (!compat::is_valid_index(index, m_vault_data.accounts_size()) || !load_details()) {
         return nullptr;
     }
     return &m_vault_data.accounts(static_cast<int>(index));
 }
 
 keeptower::AccountRecord* AccountManager::get_account_mutable(size_t index) {
-    if (!compat::is_valid_index(index, m_vault_data.accounts_size())) {
+    if (!compat::is_valid_index(index, m_vault_data.accounts_size()) || !load_details()) {
         return nullptr;
     }
-    return m_vault_data.mutable_accounts(static_cast<int>(index));
+    auto* account = m_vault_data.mutable_accounts(static_cast<int>(index));
+    notify_changed(AccountChange::Rewritten, account->id());
+    m_id_index.invalidate();
+    return account;
+}
+
+std::optional<size_t> AccountManager::find_index_by_id(std::string_view account_id) const {
+    return m_id_index.lookup(m_vault_data.accounts(), account_id, account_id_of);
+}
+
+void AccountManager::invalidate_id_index() noexcept {
+    m_id_index.invalidate();
+}
+
+void AccountManager::check_id_index() const {
+#ifndef NDEBUG
+    // Debug builds re-verify the whole index after every change to the list
+    if (!m_id_index.consistent_with(m_vault_data.accounts(), account_id_of)) {
+        Log::error("AccountManager: account ID index out of step with the account list; rebuilding");
+        m_id_index.invalidate();
+    }
+#endif
 }
 
 size_t AccountManager::get_account_count() const {
@@ -94,6 +157,13 @@ bool AccountManager::reorder_account(size_t old_index, size_t new_index) {
         return true;
     }
 
+    // Display orders before the move, to report the accounts renumbered
+    std::vector<int32_t> previous_orders;
+    previous_orders.reserve(account_count);
+    for (const auto& account : m_vault_data.accounts()) {
+        previous_orders.push_back(account.global_display_order());
+    }
+
     // Initialize global_display_order for all accounts if not already set
     bool has_custom_ordering = false;
     if (account_count > 0) {
@@ -155,7 +225,15 @@ bool AccountManager::reorder_account(size_t old_index, size_t new_index) {
         m_vault_data.mutable_accounts(static_cast<int>(account_idx))->set_global_display_order(static_cast<int32_t>(i));
     }
 
+    // Only display order changed; positions, and so the ID index, are untouched
+    check_id_index();
     m_modified_flag = true;
+    for (size_t i = 0; i < account_count; i++) {
+        const auto& account = m_vault_data.accounts(static_cast<int>(i));
+        if (account.global_display_order() != previous_orders[i]) {
+            notify_changed(AccountChange::Reordered, account.id());
+        }
+    }
     return true;
 }
 
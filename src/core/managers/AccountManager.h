@@ -17,6 +17,11 @@
 
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string_view>
+#include "IdPositionIndex.h"
 #include "record.pb.h"
 
 namespace KeepTower {
@@ -33,6 +38,13 @@ namespace KeepTower {
  * - Account reordering for UI consistency
  * - Permission validation
  *
+ * ## Deferred Account Details
+ * A vault may be opened from its account-list index while the remaining
+ * account fields are still being decrypted (see set_details_loader()).
+ * get_all_accounts() and the ordering operations work on the index alone;
+ * get_account(), get_account_mutable() and update_account() first wait for
+ * the full records.
+ *
  * ## Thread Safety
  * This class is not thread-safe. The caller must ensure
  * proper synchronization when accessing from multiple threads.
@@ -77,6 +89,37 @@ public:
     AccountManager(AccountManager&&) = delete;
     AccountManager& operator=(AccountManager&&) = delete;
 
+    /// Completes deferred account details; returns false if they could not be loaded
+    using DetailsLoader = std::function<bool()>;
+
+    /**
+     * @brief Install the hook that completes deferred account details
+     * @param loader Called before full records are accessed (empty = records are complete)
+     */
+    void set_details_loader(DetailsLoader loader);
+
+    /// What happened to an account
+    enum class AccountChange : uint8_t {
+        Added,      ///< Appended to the list
+        Removed,    ///< Erased; later accounts moved up
+        Rewritten,  ///< Fields, possibly including the ID, may have changed in place
+        Reordered   ///< Only global_display_order changed
+    };
+
+    /// Told about one account; the ID is the one it had before the change
+    using ChangeListener = std::function<void(AccountChange change, std::string_view account_id)>;
+
+    /**
+     * @brief Install the hook told about changes to accounts
+     * @param listener Called after add_account(), update_account() (once
+     *        more, as Added, with the new ID if it changed) and
+     *        delete_account(), when get_account_mutable() hands out a record,
+     *        and for each account reorder_account() renumbers
+     * @note Lets indexes over account positions (GroupMembershipIndex) go
+     *       stale safely, and the save journal write only changed accounts
+     */
+    void set_change_listener(ChangeListener listener);
+
     /**
      * @brief Add new account to vault
      * @param account Account record to add
@@ -89,6 +132,9 @@ public:
     /**
      * @brief Get all accounts from vault
      * @return Vector of all account records (copies)
+     *
+     * @note While account details are deferred the records only carry the
+     *       list fields (names, website, tags, groups, flags, ordering).
      */
     [[nodiscard]] std::vector<keeptower::AccountRecord> get_all_accounts() const;
 
@@ -96,7 +142,8 @@ public:
      * @brief Update existing account
      * @param index Zero-based index of account to update
      * @param account New account data
-     * @return true if updated successfully, false if index invalid
+     * @return true if updated successfully, false if index invalid or
+     *         deferred details could not be loaded
      *
      * @note Sets modified flag on success
      */
@@ -115,7 +162,8 @@ public:
     /**
      * @brief Get read-only pointer to account
      * @param index Zero-based index of account
-     * @return Pointer to account or nullptr if invalid index
+     * @return Pointer to account or nullptr if invalid index or deferred
+     *         details could not be loaded
      */
     [[nodiscard]] const keeptower::AccountRecord* get_account(size_t index) const;
 
@@ -125,9 +173,26 @@ public:
      * @return Pointer to account or nullptr if invalid index
      *
      * @warning Caller must set modified flag after making changes
+     * @note Notifies the change listener and drops the ID index, as the
+     *       record (including its ID) may be rewritten
      */
     [[nodiscard]] keeptower::AccountRecord* get_account_mutable(size_t index);
 
+    /**
+     * @brief Find an account by ID
+     * @param account_id Account ID
+     * @return Index of the first account with this ID, or nullopt
+     * @note Constant time: served from a hash index kept in step with the
+     *       account list (rebuilt after get_account_mutable() or outside edits)
+     */
+    [[nodiscard]] std::optional<size_t> find_index_by_id(std::string_view account_id) const;
+
+    /**
+     * @brief Discard the ID index after an outside change to the account list
+     * @note The index is rebuilt on next use
+     */
+    void invalidate_id_index() noexcept;
+
     /**
      * @brief Get number of accounts in vault
      * @return Account count
@@ -163,8 +228,15 @@ public:
     [[nodiscard]] bool can_delete_account(size_t account_index) const noexcept;
 
 private:
+    [[nodiscard]] bool load_details() const;
+    void notify_changed(AccountChange change, std::string_view account_id) const;
+    void check_id_index() const;
+
     keeptower::VaultData& m_vault_data;  ///< Reference to protobuf vault data
     bool& m_modified_flag;               ///< Reference to vault modified flag
+    DetailsLoader m_details_loader;      ///< Completes deferred account details
+    ChangeListener m_change_listener;    ///< Told about account list changes
+    mutable IdPositionIndex m_id_index;  ///< Account ID -> index
 };
 
 }  // namespace KeepTower
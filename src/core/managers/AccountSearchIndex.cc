@@ -0,0 +1,349 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "AccountSearchIndex.h"
+#include <algorithm>
+
+namespace KeepTower {
+
+namespace {
+
+constexpr unsigned char BOUNDARY = 0;
+
+constexpr unsigned char fold(unsigned char c) noexcept {
+    return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char>(c - 'A' + 'a') : c;
+}
+
+/// Slides a three-byte window over casefolded text, emitting packed terms
+class TermWriter {
+public:
+    TermWriter(std::vector<uint32_t>& terms, uint8_t field) : m_terms(terms), m_field(field) {}
+
+    void put(unsigned char c) {
+        m_window = ((m_window << 8) | fold(c)) & 0xFFFFFFu;
+        if (++m_fed >= 3) {
+            m_terms.push_back((m_window << 8) | m_field);
+        }
+    }
+
+    void put(std::string_view text) {
+        for (const char c : text) {
+            put(static_cast<unsigned char>(c));
+        }
+    }
+
+private:
+    std::vector<uint32_t>& m_terms;
+    uint8_t m_field;
+    uint32_t m_window = 0;
+    size_t m_fed = 0;
+};
+
+void add_field(std::vector<uint32_t>& terms, uint8_t field, std::string_view text) {
+    TermWriter writer(terms, field);
+    writer.put(BOUNDARY);
+    writer.put(text);
+    writer.put(BOUNDARY);
+}
+
+/// FNV-1a over the searchable fields, to skip reindexing unchanged accounts
+uint64_t fingerprint(const keeptower::AccountRecord& account) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](std::string_view text) {
+        for (const char c : text) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        hash = (hash ^ 0xFFu) * 1099511628211ull;  // Never in UTF-8, so fields cannot run together
+    };
+    mix(account.account_name());
+    mix(account.user_name());
+    mix(account.email());
+    mix(account.website());
+    mix(account.notes());
+    for (const auto& tag : account.tags()) {
+        mix(tag);
+    }
+    return hash;
+}
+
+/// Distinct trigrams of a query, sorted
+std::vector<uint32_t> query_trigrams(std::string_view query) {
+    std::vector<uint32_t> trigrams;
+    if (query.size() < 3) {
+        return trigrams;
+    }
+    trigrams.reserve(query.size() - 2);
+    for (size_t i = 0; i + 3 <= query.size(); ++i) {
+        trigrams.push_back((uint32_t{fold(static_cast<unsigned char>(query[i]))} << 16) |
+                           (uint32_t{fold(static_cast<unsigned char>(query[i + 1]))} << 8) |
+                           uint32_t{fold(static_cast<unsigned char>(query[i + 2]))});
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+}  // namespace
+
+void AccountSearchIndex::clear() {
+    m_slots.clear();
+    m_blocks_by_prefix.clear();
+    m_blocks.clear();
+    m_lists.clear();
+    m_list_trigrams.clear();
+    m_slot_ids.clear();
+    m_terms.clear();
+    m_fingerprints.clear();
+    m_live.clear();
+    m_free_slots.clear();
+}
+
+uint32_t AccountSearchIndex::upsert(const keeptower::AccountRecord& account) {
+    const uint64_t print = fingerprint(account);
+
+    if (const auto it = m_slots.find(account.id()); it != m_slots.end()) {
+        const uint32_t slot = it->second;
+        if (m_fingerprints[slot] != print) {
+            collect_terms(account, m_scratch);
+            remove_postings(slot, m_terms[slot]);
+            add_postings(slot, m_scratch);
+            m_terms[slot].assign(m_scratch.begin(), m_scratch.end());
+            m_fingerprints[slot] = print;
+        }
+        return slot;
+    }
+    if (m_free_slots.empty() && m_slot_ids.size() >= MAX_ACCOUNTS) {
+        return NO_SLOT;
+    }
+
+    uint32_t slot;
+    if (!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+        m_slot_ids[slot] = account.id();
+        m_live[slot] = 1;
+    } else {
+        slot = static_cast<uint32_t>(m_slot_ids.size());
+        m_slot_ids.push_back(account.id());
+        m_terms.emplace_back();
+        m_fingerprints.push_back(0);
+        m_live.push_back(1);
+    }
+    m_slots.emplace(account.id(), slot);
+    collect_terms(account, m_scratch);
+    add_postings(slot, m_scratch);
+    m_terms[slot].assign(m_scratch.begin(), m_scratch.end());
+    m_fingerprints[slot] = print;
+    return slot;
+}
+
+bool AccountSearchIndex::remove(std::string_view account_id) {
+    const auto it = m_slots.find(account_id);
+    if (it == m_slots.end()) {
+        return false;
+    }
+    const uint32_t slot = it->second;
+    m_slots.erase(it);
+
+    remove_postings(slot, m_terms[slot]);
+    m_terms[slot] = {};
+    m_slot_ids[slot].clear();
+    m_live[slot] = 0;
+    m_free_slots.push_back(slot);
+    return true;
+}
+
+uint32_t AccountSearchIndex::slot_of(std::string_view account_id) const {
+    const auto it = m_slots.find(account_id);
+    return it != m_slots.end() ? it->second : NO_SLOT;
+}
+
+std::string_view AccountSearchIndex::id_of(uint32_t slot) const noexcept {
+    if (slot >= m_slot_ids.size()) {
+        return {};
+    }
+    return m_slot_ids[slot];
+}
+
+std::vector<uint32_t> AccountSearchIndex::candidates(std::string_view query,
+                                                     uint8_t fields,
+                                                     size_t max_missing) const {
+    std::vector<uint32_t> result;
+    if (query.empty()) {
+        return result;
+    }
+
+    // Too short for a trigram of its own: every trigram containing it
+    if (query.size() < 3) {
+        std::string folded;
+        for (const char c : query) {
+            folded.push_back(static_cast<char>(fold(static_cast<unsigned char>(c))));
+        }
+        std::vector<uint8_t> marked(m_slot_ids.size(), 0);
+        for (size_t list = 0; list < m_lists.size(); ++list) {
+            const uint32_t trigram = m_list_trigrams[list];
+            const char bytes[3] = {static_cast<char>(trigram >> 16), static_cast<char>(trigram >> 8),
+                                   static_cast<char>(trigram)};
+            if (std::string_view(bytes, 3).find(folded) == std::string_view::npos) {
+                continue;
+            }
+            for (const Posting posting : m_lists[list]) {
+                marked[slot_in(posting)] |= posting & fields;
+            }
+        }
+        for (uint32_t slot = 0; slot < marked.size(); ++slot) {
+            if (marked[slot]) {
+                result.push_back(slot);
+            }
+        }
+        return result;
+    }
+
+    const std::vector<uint32_t> trigrams = query_trigrams(query);
+    std::vector<const std::vector<Posting>*> lists;
+    lists.reserve(trigrams.size());
+    for (const uint32_t trigram : trigrams) {
+        if (const uint32_t list = list_of(trigram); list != 0 && !m_lists[list - 1].empty()) {
+            lists.push_back(&m_lists[list - 1]);
+        }
+    }
+    const size_t required = trigrams.size() > max_missing ? trigrams.size() - max_missing : 1;
+    if (lists.size() < required) {
+        return result;
+    }
+
+    if (required == trigrams.size()) {
+        // Intersect, smallest list first, so the work follows the rarest trigram
+        std::sort(lists.begin(), lists.end(),
+                  [](const auto* a, const auto* b) { return a->size() < b->size(); });
+        for (const Posting posting : *lists.front()) {
+            if (posting & fields) {
+                result.push_back(slot_in(posting));
+            }
+        }
+        for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+            auto from = lists[i]->begin();
+            const auto end = lists[i]->end();
+            size_t kept = 0;
+            for (const uint32_t slot : result) {
+                from = std::lower_bound(from, end, first_posting(slot));
+                if (from == end) {
+                    break;
+                }
+                if (slot_in(*from) == slot && (*from & fields)) {
+                    result[kept++] = slot;
+                }
+            }
+            result.resize(kept);
+        }
+        return result;
+    }
+
+    // Count the query trigrams each account has
+    std::vector<uint32_t> counts(m_slot_ids.size(), 0);
+    for (const auto* list : lists) {
+        for (const Posting posting : *list) {
+            if (posting & fields) {
+                ++counts[slot_in(posting)];
+            }
+        }
+    }
+    for (uint32_t slot = 0; slot < counts.size(); ++slot) {
+        if (counts[slot] >= required) {
+            result.push_back(slot);
+        }
+    }
+    return result;
+}
+
+size_t AccountSearchIndex::trigram_count(std::string_view query) {
+    return query_trigrams(query).size();
+}
+
+size_t AccountSearchIndex::trigram_total() const noexcept {
+    return static_cast<size_t>(std::count_if(m_lists.begin(), m_lists.end(),
+                                             [](const auto& list) { return !list.empty(); }));
+}
+
+void AccountSearchIndex::collect_terms(const keeptower::AccountRecord& account, std::vector<uint32_t>& terms) const {
+    terms.clear();
+    add_field(terms, ACCOUNT_NAME, account.account_name());
+    add_field(terms, USER_NAME, account.user_name());
+    add_field(terms, EMAIL, account.email());
+    add_field(terms, WEBSITE, account.website());
+    add_field(terms, NOTES, account.notes());
+
+    // Tags are searched as one space-joined string
+    TermWriter tags(terms, TAGS);
+    tags.put(BOUNDARY);
+    for (int i = 0; i < account.tags_size(); ++i) {
+        if (i > 0) {
+            tags.put(static_cast<unsigned char>(' '));
+        }
+        tags.put(account.tags(i));
+    }
+    tags.put(BOUNDARY);
+}
+
+uint32_t AccountSearchIndex::list_of(uint32_t trigram) const noexcept {
+    if (m_blocks_by_prefix.empty()) {
+        return 0;
+    }
+    const uint32_t block = m_blocks_by_prefix[trigram >> 8];
+    return block != 0 ? m_blocks[block - 1][trigram & 0xFFu] : 0;
+}
+
+std::vector<AccountSearchIndex::Posting>& AccountSearchIndex::list_for(uint32_t trigram) {
+    if (m_blocks_by_prefix.empty()) {
+        m_blocks_by_prefix.assign(size_t{1} << 16, 0);
+    }
+    uint32_t& block = m_blocks_by_prefix[trigram >> 8];
+    if (block == 0) {
+        m_blocks.emplace_back();
+        m_blocks.back().fill(0);
+        block = static_cast<uint32_t>(m_blocks.size());
+    }
+    uint32_t& list = m_blocks[block - 1][trigram & 0xFFu];
+    if (list == 0) {
+        m_lists.emplace_back();
+        m_list_trigrams.push_back(trigram);
+        list = static_cast<uint32_t>(m_lists.size());
+    }
+    return m_lists[list - 1];
+}
+
+void AccountSearchIndex::add_postings(uint32_t slot, const std::vector<uint32_t>& terms) {
+    // A trigram may recur within the account; its fields share one posting
+    for (const uint32_t term : terms) {
+        auto& postings = list_for(term >> 8);
+        const Posting posting = first_posting(slot) | (term & FIELD_MASK);
+        if (postings.empty() || slot_in(postings.back()) < slot) {
+            postings.push_back(posting);
+        } else if (slot_in(postings.back()) == slot) {
+            postings.back() |= posting;
+        } else {
+            const auto at = std::lower_bound(postings.begin(), postings.end(), first_posting(slot));
+            if (at != postings.end() && slot_in(*at) == slot) {
+                *at |= posting;
+            } else {
+                postings.insert(at, posting);
+            }
+        }
+    }
+}
+
+void AccountSearchIndex::remove_postings(uint32_t slot, const std::vector<uint32_t>& terms) {
+    for (const uint32_t term : terms) {
+        const uint32_t list = list_of(term >> 8);
+        if (list == 0) {
+            continue;
+        }
+        auto& postings = m_lists[list - 1];
+        const auto at = std::lower_bound(postings.begin(), postings.end(), first_posting(slot));
+        if (at != postings.end() && slot_in(*at) == slot) {
+            postings.erase(at);
+        }
+    }
+}
+
+}  // namespace KeepTower
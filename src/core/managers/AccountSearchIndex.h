@@ -0,0 +1,217 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#ifndef KEEPTOWER_ACCOUNTSEARCHINDEX_H
+#define KEEPTOWER_ACCOUNTSEARCHINDEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "record.pb.h"
+
+namespace KeepTower {
+
+/**
+ * @brief Trigram index over the searchable text of accounts
+ *
+ * Every searchable field (account name, user name, email, website, notes
+ * and the space-joined tags) is casefolded and split into overlapping
+ * three-byte trigrams, with a boundary byte at either end so that short
+ * fields have trigrams too. Each trigram has a posting list of the account
+ * slots containing it, with a bit per field it occurs in.
+ *
+ * A field containing the query as a substring contains every trigram of
+ * the query, so intersecting the query's posting lists yields a small
+ * superset of the substring matches without looking at the other
+ * accounts. Searches that tolerate typos may instead ask for accounts
+ * missing some of the query's trigrams. Callers confirm the candidates
+ * with their own matching.
+ *
+ * Accounts are keyed by ID and held in stable slots, so adding, updating
+ * or removing one account touches only its own posting entries. IDs are
+ * expected to be unique; a repeated ID shares one slot.
+ *
+ * Casefolding is ASCII-only, matching FuzzyMatch and the tree filter;
+ * other bytes are indexed as they are.
+ *
+ * @section Thread Safety
+ * Not thread-safe; callers synchronize as for the accounts it mirrors.
+ */
+class AccountSearchIndex {
+public:
+    /// Slot value for an account that is not indexed
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    /// Most accounts the index holds (slots share a word with field bits)
+    static constexpr uint32_t MAX_ACCOUNTS = 1u << 26;
+
+    /// Field bits for candidates()
+    enum Field : uint8_t {
+        ACCOUNT_NAME = 1u << 0,
+        USER_NAME = 1u << 1,
+        EMAIL = 1u << 2,
+        WEBSITE = 1u << 3,
+        NOTES = 1u << 4,
+        TAGS = 1u << 5,
+        ALL_FIELDS = ACCOUNT_NAME | USER_NAME | EMAIL | WEBSITE | NOTES | TAGS
+    };
+
+    /**
+     * @brief Index the given accounts, replacing any previous state
+     * @param accounts Accounts in order (ranges of keeptower::AccountRecord)
+     * @note Slots are assigned in order, so until the next change an
+     *       account's slot is its position
+     */
+    template <typename Accounts>
+    void rebuild(const Accounts& accounts) {
+        clear();
+        for (const auto& account : accounts) {
+            upsert(account);
+        }
+    }
+
+    /**
+     * @brief Bring the index in line with the given accounts
+     *
+     * Upserts every account and removes the ones no longer present.
+     * Accounts whose searchable text did not change cost a hash of that
+     * text, not trigram extraction or posting list updates.
+     *
+     * @param accounts Accounts in order (ranges of keeptower::AccountRecord)
+     * @return Slot of each account (NO_SLOT if it did not fit), by position
+     */
+    template <typename Accounts>
+    std::vector<uint32_t> sync(const Accounts& accounts) {
+        std::vector<uint32_t> slots;
+        slots.reserve(static_cast<size_t>(std::size(accounts)));
+        std::vector<uint8_t> seen(m_slot_ids.size(), 0);
+        for (const auto& account : accounts) {
+            const uint32_t slot = upsert(account);
+            slots.push_back(slot);
+            if (slot == NO_SLOT) {
+                continue;
+            }
+            if (slot >= seen.size()) {
+                seen.resize(slot + 1, 0);
+            }
+            seen[slot] = 1;
+        }
+        for (uint32_t slot = 0; slot < m_live.size(); ++slot) {
+            if (m_live[slot] && !seen[slot]) {
+                remove(std::string{m_slot_ids[slot]});
+            }
+        }
+        return slots;
+    }
+
+    /** @brief Drop all accounts */
+    void clear();
+
+    /**
+     * @brief Add an account, or reindex it if its ID is already indexed
+     * @param account Account to index
+     * @return Slot of the account, or NO_SLOT if MAX_ACCOUNTS are indexed
+     */
+    uint32_t upsert(const keeptower::AccountRecord& account);
+
+    /**
+     * @brief Remove an account
+     * @param account_id Account ID
+     * @return false if it was not indexed
+     * @note Its slot is reused by a later upsert()
+     */
+    bool remove(std::string_view account_id);
+
+    /**
+     * @brief Slot of an account
+     * @param account_id Account ID
+     * @return Slot, or NO_SLOT if the account is not indexed
+     */
+    [[nodiscard]] uint32_t slot_of(std::string_view account_id) const;
+
+    /**
+     * @brief ID of the account in a slot
+     * @param slot Account slot
+     * @return ID, or empty for a free or unknown slot
+     */
+    [[nodiscard]] std::string_view id_of(uint32_t slot) const noexcept;
+
+    /**
+     * @brief Accounts that may contain @p query in one of @p fields
+     *
+     * Queries of three or more bytes intersect the posting lists of their
+     * trigrams, or with @p max_missing > 0 keep accounts sharing all but
+     * that many of them (always at least one). Shorter queries take the
+     * union of every trigram containing them, which is exact for substring
+     * matches and ignores @p max_missing.
+     *
+     * @param query Search text, in any case
+     * @param fields Field bits to search
+     * @param max_missing Query trigrams a candidate may lack
+     * @return Candidate slots in ascending order (empty for an empty query)
+     */
+    [[nodiscard]] std::vector<uint32_t> candidates(std::string_view query,
+                                                   uint8_t fields = ALL_FIELDS,
+                                                   size_t max_missing = 0) const;
+
+    /**
+     * @brief Number of distinct trigrams in a query
+     * @param query Search text, in any case
+     * @return Trigrams candidates() looks up (0 for queries under three bytes)
+     */
+    [[nodiscard]] static size_t trigram_count(std::string_view query);
+
+    /** @brief Number of indexed accounts */
+    [[nodiscard]] size_t size() const noexcept { return m_slots.size(); }
+
+    /** @brief Number of slots in use or free (valid slots are below this) */
+    [[nodiscard]] size_t slot_count() const noexcept { return m_slot_ids.size(); }
+
+    /** @brief Number of distinct trigrams in the indexed accounts */
+    [[nodiscard]] size_t trigram_total() const noexcept;
+
+private:
+    struct IdHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view id) const noexcept { return std::hash<std::string_view>{}(id); }
+    };
+
+    /// Posting list entry: slot << FIELD_SHIFT | field bits, so lists sort by slot
+    using Posting = uint32_t;
+    static constexpr uint32_t FIELD_SHIFT = 6;
+    static constexpr uint32_t FIELD_MASK = (1u << FIELD_SHIFT) - 1;
+
+    [[nodiscard]] static constexpr uint32_t slot_in(Posting posting) noexcept { return posting >> FIELD_SHIFT; }
+    [[nodiscard]] static constexpr Posting first_posting(uint32_t slot) noexcept { return slot << FIELD_SHIFT; }
+
+    // Packed (trigram << 8 | field bit) entries of an account, in text order
+    void collect_terms(const keeptower::AccountRecord& account, std::vector<uint32_t>& terms) const;
+    [[nodiscard]] uint32_t list_of(uint32_t trigram) const noexcept;  // List + 1, or 0
+    std::vector<Posting>& list_for(uint32_t trigram);
+    void add_postings(uint32_t slot, const std::vector<uint32_t>& terms);
+    void remove_postings(uint32_t slot, const std::vector<uint32_t>& terms);
+
+    // Trigram -> posting list in two array steps: the first two bytes pick
+    // a block, the third a list in it
+    std::unordered_map<std::string, uint32_t, IdHash, std::equal_to<>> m_slots;  ///< Account ID -> slot
+    std::vector<uint32_t> m_blocks_by_prefix;               ///< First two bytes -> block + 1 (0 = none)
+    std::vector<std::array<uint32_t, 256>> m_blocks;        ///< Third byte -> list + 1 (0 = none)
+    std::vector<std::vector<Posting>> m_lists;              ///< Posting lists, sorted by slot
+    std::vector<uint32_t> m_list_trigrams;                  ///< List -> its trigram
+    std::vector<std::string> m_slot_ids;          ///< Slot -> account ID
+    std::vector<std::vector<uint32_t>> m_terms;   ///< Slot -> indexed terms, for updates
+    std::vector<uint64_t> m_fingerprints;         ///< Slot -> hash of the indexed text
+    std::vector<uint8_t> m_live;                  ///< Slot -> whether it holds an account
+    std::vector<uint32_t> m_free_slots;           ///< Slots of removed accounts
+    std::vector<uint32_t> m_scratch;              ///< Term buffer reused by upsert()
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_ACCOUNTSEARCHINDEX_H
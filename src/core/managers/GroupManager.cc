@@ -3,11 +3,13 @@
 
 #include "GroupManager.h"
 #include "../../utils/Cpp23Compat.h"
+#include "../../utils/Log.h"
 #include <algorithm>
 #include <random>
 #include <sstream>
 #include <iomanip>
 #include <cctype>
+#include <utility>
 
 #if KEEPTOWER_HAS_RANGES
 #include <ranges>
@@ -17,9 +19,27 @@ namespace views = std::views;
 
 namespace KeepTower {
 
+namespace {
+
+const std::string& group_id_of(const keeptower::AccountGroup& group) {
+    return group.group_id();
+}
+
+}  // namespace
+
 GroupManager::GroupManager(keeptower::VaultData& vault_data, bool& modified_flag)
     : m_vault_data(vault_data), m_modified_flag(modified_flag) {}
 
+void GroupManager::set_account_change_listener(AccountChangeListener listener) {
+    m_account_listener = std::move(listener);
+}
+
+void GroupManager::notify_account_changed(size_t account_index) const {
+    if (m_account_listener) {
+        m_account_listener(m_vault_data.accounts(static_cast<int>(account_index)).id());
+    }
+}
+
 std::string GroupManager::create_group(std::string_view name) {
     // Validate group name
     if (!is_valid_group_name(name)) {
@@ -57,6 +77,12 @@ std::string GroupManager::create_group(std::string_view name) {
     new_group->set_display_order(m_vault_data.groups_size() - 1);
     new_group->set_is_expanded(true);  // New groups start expanded
 
+    if (m_index_valid) {
+        m_index.add_group(group_id);
+    }
+    m_group_ids.appended(m_vault_data.groups(), group_id_of);
+    check_id_index();
+
     m_modified_flag = true;
     return group_id;
 }
@@ -68,54 +94,40 @@ bool GroupManager::delete_group(std::string_view group_id) {
     }
 
     // Find the group
-    int group_index = -1;
-#if KEEPTOWER_HAS_RANGES
-    // Modern C++23: Use ranges::find_if for cleaner search
-    auto it = ranges::find_if(m_vault_data.groups(),
-        [group_id](const auto& group) { return group.group_id() == group_id; });
-
-    if (it != m_vault_data.groups().end()) {
-        // Prevent deletion of system groups
-        if (it->is_system_group()) {
-            return false;
-        }
-        group_index = static_cast<int>(std::distance(m_vault_data.groups().begin(), it));
-    }
-#else
-    // GCC 13 fallback: Traditional loop
-    for (int i = 0; i < m_vault_data.groups_size(); ++i) {
-        if (m_vault_data.groups(i).group_id() == group_id) {
-            // Prevent deletion of system groups
-            if (m_vault_data.groups(i).is_system_group()) {
-                return false;
-            }
-            group_index = i;
-            break;
-        }
+    const auto position = m_group_ids.lookup(m_vault_data.groups(), group_id, group_id_of);
+    if (!position) {
+        return false;  // Group not found
     }
-#endif
+    const int group_index = static_cast<int>(*position);
 
-    if (group_index == -1) {
-        return false;  // Group not found
+    // Prevent deletion of system groups
+    if (m_vault_data.groups(group_index).is_system_group()) {
+        return false;
     }
+    const std::string erased_id{group_id};  // group_id may view the record erased below
 
-    // Remove all references to this group from accounts
-    for (int i = 0; i < m_vault_data.accounts_size(); ++i) {
-        auto* account = m_vault_data.mutable_accounts(i);
-        auto* groups = account->mutable_groups();
+    // Remove the memberships of the accounts the index lists as members
+    (void)membership_index();
+    m_index_valid = false;  // Until the vault data agrees with the index again
+    for (const uint32_t account_index : m_index.remove_group(erased_id)) {
+        auto* groups = m_vault_data.mutable_accounts(static_cast<int>(account_index))->mutable_groups();
 
         // Remove matching group memberships
         for (int j = groups->size() - 1; j >= 0; --j) {
-            if (groups->Get(j).group_id() == group_id) {
+            if (groups->Get(j).group_id() == erased_id) {
                 groups->erase(groups->begin() + j);
             }
         }
+        notify_account_changed(account_index);
     }
 
     // Remove the group itself
     m_vault_data.mutable_groups()->erase(
         m_vault_data.mutable_groups()->begin() + group_index
     );
+    m_index_valid = true;
+    m_group_ids.erased(m_vault_data.groups(), *position, erased_id, group_id_of);
+    check_id_index();
 
     m_modified_flag = true;
     return true;
@@ -182,26 +194,27 @@ bool GroupManager::add_account_to_group(size_t account_index, std::string_view g
     }
 
     // Validate group exists
-    const auto* group = find_group_by_id(group_id);
-    if (!group) {
+    const uint32_t slot = membership_index().slot_of(group_id);
+    if (slot == GroupMembershipIndex::NO_SLOT) {
         return false;
     }
 
-    auto* account = m_vault_data.mutable_accounts(static_cast<int>(account_index));
-
     // Check if already in group (prevent duplicates)
-    for (const auto& membership : account->groups()) {
-        if (membership.group_id() == group_id) {
-            return true;  // Already in group, success (idempotent)
-        }
+    const auto position = static_cast<uint32_t>(account_index);
+    if (m_index.contains(position, slot)) {
+        return true;  // Already in group, success (idempotent)
     }
 
     // Add group membership
-    auto* membership = account->add_groups();
+    m_index_valid = false;
+    auto* membership = m_vault_data.mutable_accounts(static_cast<int>(account_index))->add_groups();
     membership->set_group_id(std::string{group_id});
     membership->set_display_order(-1);  // Use automatic ordering initially
+    m_index.insert(position, slot);
+    m_index_valid = true;
 
     m_modified_flag = true;
+    notify_account_changed(account_index);
     return true;
 }
 
@@ -211,24 +224,42 @@ bool GroupManager::remove_account_from_group(size_t account_index, std::string_v
         return false;
     }
 
+    // A listed group the account is not in needs no scan; a group that is
+    // no longer listed may still have a stale membership to remove
+    const uint32_t slot = membership_index().slot_of(group_id);
+    const auto position = static_cast<uint32_t>(account_index);
+    if (slot != GroupMembershipIndex::NO_SLOT && !m_index.contains(position, slot)) {
+        return true;  // Not in group, success (idempotent)
+    }
+
     auto* account = m_vault_data.mutable_accounts(static_cast<int>(account_index));
     auto* groups = account->mutable_groups();
 
     // Find and remove the group membership
     bool found = false;
+    bool still_member = false;
+    m_index_valid = false;
     for (int i = groups->size() - 1; i >= 0; --i) {
         if (groups->Get(i).group_id() == group_id) {
+            if (found) {
+                still_member = true;  // Duplicated membership entry
+                break;
+            }
             groups->erase(groups->begin() + i);
-            found = true;
-            break;  // Only remove one membership (should be unique anyway)
+            found = true;  // Only remove one membership (should be unique anyway)
         }
     }
+    if (found && !still_member && slot != GroupMembershipIndex::NO_SLOT) {
+        m_index.erase(position, slot);
+    }
+    m_index_valid = true;
 
     if (!found) {
         return true;  // Not in group, success (idempotent)
     }
 
     m_modified_flag = true;
+    notify_account_changed(account_index);
     return true;
 }
 
@@ -241,8 +272,8 @@ bool GroupManager::reorder_account_in_group(size_t account_index,
     }
 
     // Validate group exists
-    const keeptower::AccountGroup* group = find_group_by_id(group_id);
-    if (!group) {
+    const uint32_t slot = membership_index().slot_of(group_id);
+    if (slot == GroupMembershipIndex::NO_SLOT) {
         return false;
     }
 
@@ -251,6 +282,11 @@ bool GroupManager::reorder_account_in_group(size_t account_index,
         return false;
     }
 
+    // Account is not in this group
+    if (!m_index.contains(static_cast<uint32_t>(account_index), slot)) {
+        return false;
+    }
+
     auto* account = m_vault_data.mutable_accounts(static_cast<int>(account_index));
 
     // Find the membership for this group
@@ -259,6 +295,7 @@ bool GroupManager::reorder_account_in_group(size_t account_index,
         if (membership->group_id() == group_id) {
             membership->set_display_order(new_order);
             m_modified_flag = true;
+            notify_account_changed(account_index);
             return true;
         }
     }
@@ -287,6 +324,12 @@ std::string GroupManager::get_favorites_group_id() {
     favorites_group->set_is_expanded(true);  // Always expanded
     favorites_group->set_icon("favorite");  // Special icon
 
+    if (m_index_valid) {
+        m_index.add_group(group_id);
+    }
+    m_group_ids.appended(m_vault_data.groups(), group_id_of);
+    check_id_index();
+
     m_modified_flag = true;
     return group_id;
 }
@@ -297,9 +340,13 @@ bool GroupManager::is_account_in_group(size_t account_index, std::string_view gr
         return false;
     }
 
-    const auto& account = m_vault_data.accounts(static_cast<int>(account_index));
+    const auto& index = membership_index();
+    if (const uint32_t slot = index.slot_of(group_id); slot != GroupMembershipIndex::NO_SLOT) {
+        return index.contains(static_cast<uint32_t>(account_index), slot);
+    }
 
-    // Check if account has this group membership
+    // Group no longer listed: look for a stale membership
+    const auto& account = m_vault_data.accounts(static_cast<int>(account_index));
     for (const auto& membership : account.groups()) {
         if (membership.group_id() == group_id) {
             return true;
@@ -321,10 +368,43 @@ std::vector<keeptower::AccountGroup> GroupManager::get_all_groups() const {
     return groups;
 }
 
+const keeptower::AccountGroup* GroupManager::get_group(std::string_view group_id) const {
+    return find_group_by_id(group_id);
+}
+
 size_t GroupManager::get_group_count() const {
     return static_cast<size_t>(m_vault_data.groups_size());
 }
 
+const GroupMembershipIndex& GroupManager::membership_index() const {
+    // Counts catch accounts or groups added or removed behind our back
+    if (!m_index_valid ||
+        m_index.account_count() != static_cast<size_t>(m_vault_data.accounts_size()) ||
+        m_index.group_count() != static_cast<size_t>(m_vault_data.groups_size())) {
+        m_index.rebuild(m_vault_data.groups(), m_vault_data.accounts());
+        m_index_valid = true;
+    }
+    return m_index;
+}
+
+void GroupManager::invalidate_membership_index() noexcept {
+    m_index_valid = false;
+}
+
+void GroupManager::invalidate_id_index() noexcept {
+    m_group_ids.invalidate();
+}
+
+void GroupManager::check_id_index() const {
+#ifndef NDEBUG
+    // Debug builds re-verify the whole index after every change to the list
+    if (!m_group_ids.consistent_with(m_vault_data.groups(), group_id_of)) {
+        Log::error("GroupManager: group ID index out of step with the group list; rebuilding");
+        m_group_ids.invalidate();
+    }
+#endif
+}
+
 bool GroupManager::is_valid_group_name(std::string_view name) const {
     if (name.empty() || name.length() > 100) {
         return false;
@@ -372,21 +452,13 @@ std::string GroupManager::generate_uuid() {
 }
 
 keeptower::AccountGroup* GroupManager::find_group_by_id(std::string_view group_id) {
-    for (int i = 0; i < m_vault_data.groups_size(); ++i) {
-        if (m_vault_data.groups(i).group_id() == group_id) {
-            return m_vault_data.mutable_groups(i);
-        }
-    }
-    return nullptr;
+    const auto position = m_group_ids.lookup(m_vault_data.groups(), group_id, group_id_of);
+    return position ? m_vault_data.mutable_groups(static_cast<int>(*position)) : nullptr;
 }
 
 const keeptower::AccountGroup* GroupManager::find_group_by_id(std::string_view group_id) const {
-    for (int i = 0; i < m_vault_data.groups_size(); ++i) {
-        if (m_vault_data.groups(i).group_id() == group_id) {
-            return &m_vault_data.groups(i);
-        }
-    }
-    return nullptr;
+    const auto position = m_group_ids.lookup(m_vault_data.groups(), group_id, group_id_of);
+    return position ? &m_vault_data.groups(static_cast<int>(*position)) : nullptr;
 }
 
 }  // namespace KeepTower
@@ -4,9 +4,12 @@
 #ifndef KEEPTOWER_GROUPMANAGER_H
 #define KEEPTOWER_GROUPMANAGER_H
 
+#include <functional>
 #include <string>
 #include <string_view>
 #include <vector>
+#include "GroupMembershipIndex.h"
+#include "IdPositionIndex.h"
 #include "record.pb.h"
 
 namespace KeepTower {
@@ -27,6 +30,17 @@ namespace KeepTower {
  * - Caller must ensure thread safety (e.g., via VaultManager's mutex)
  * - All methods require vault to be open
  *
+ * @section Membership Index
+ * Membership queries and updates go through a GroupMembershipIndex built
+ * from the vault data on first use. Membership changes made here update
+ * the vault data and the index together; any other change to the account
+ * list must be followed by invalidate_membership_index() (VaultManager
+ * wires this to AccountManager). A changed account or group count is
+ * also detected and triggers a rebuild.
+ *
+ * Group lookups by ID use an IdPositionIndex over the group list, kept in
+ * step by create_group(), delete_group() and get_favorites_group_id().
+ *
  * @section Usage Example
  * @code
  * keeptower::VaultData vault_data;
@@ -58,6 +72,17 @@ public:
     GroupManager(GroupManager&&) = delete;
     GroupManager& operator=(GroupManager&&) = delete;
 
+    /// Told that an account's group memberships changed
+    using AccountChangeListener = std::function<void(std::string_view account_id)>;
+
+    /**
+     * @brief Install the hook told about accounts whose memberships change
+     * @param listener Called for each account delete_group(),
+     *        add_account_to_group(), remove_account_from_group() and
+     *        reorder_account_in_group() modify
+     */
+    void set_account_change_listener(AccountChangeListener listener);
+
     /**
      * @brief Create a new account group
      * @param name Display name for the group
@@ -161,6 +186,14 @@ public:
      */
     [[nodiscard]] bool is_account_in_group(size_t account_index, std::string_view group_id) const;
 
+    /**
+     * @brief Look up a group by ID
+     * @param group_id UUID of the group
+     * @return The group, or nullptr if there is none (valid until the group list changes)
+     * @note Constant time (hash index over the group list)
+     */
+    [[nodiscard]] const keeptower::AccountGroup* get_group(std::string_view group_id) const;
+
     /**
      * @brief Get all account groups
      * @return Vector of all groups in the vault
@@ -173,9 +206,38 @@ public:
      */
     [[nodiscard]] size_t get_group_count() const;
 
+    /**
+     * @brief Membership index over the current vault data
+     * @return Index keyed by account position, rebuilt first if stale
+     * @note The reference stays valid, but its contents change with the vault
+     */
+    [[nodiscard]] const GroupMembershipIndex& membership_index() const;
+
+    /**
+     * @brief Discard the membership index after an outside change to accounts
+     * @note The index is rebuilt on next use
+     */
+    void invalidate_membership_index() noexcept;
+
+    /**
+     * @brief Discard the group ID index after an outside change to the group list
+     * @note The index is rebuilt on next use
+     */
+    void invalidate_id_index() noexcept;
+
 private:
     keeptower::VaultData& m_vault_data;  ///< Reference to vault data
     bool& m_modified_flag;               ///< Reference to modified flag
+    mutable GroupMembershipIndex m_index;  ///< Membership index (see membership_index())
+    mutable bool m_index_valid = false;    ///< Whether m_index matches m_vault_data
+    mutable IdPositionIndex m_group_ids;   ///< Group ID -> position in the group list
+    AccountChangeListener m_account_listener;  ///< Told about membership changes
+
+    /** @brief Tell the listener that the account at @p account_index changed */
+    void notify_account_changed(size_t account_index) const;
+
+    /** @brief Debug builds: verify m_group_ids against the group list */
+    void check_id_index() const;
 
     /**
      * @brief Validate group name for security and usability
@@ -0,0 +1,129 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "GroupMembershipIndex.h"
+#include <algorithm>
+
+namespace KeepTower {
+
+namespace {
+
+size_t words_for(size_t slots) {
+    return (slots + 63) / 64;
+}
+
+}  // namespace
+
+void GroupMembershipIndex::clear() {
+    m_slots.clear();
+    m_slot_ids.clear();
+    m_free_slots.clear();
+    m_members.clear();
+    m_bits.clear();
+    m_words = 0;
+    m_account_count = 0;
+}
+
+uint32_t GroupMembershipIndex::slot_of(std::string_view group_id) const {
+    const auto it = m_slots.find(group_id);
+    return it != m_slots.end() ? it->second : NO_SLOT;
+}
+
+uint32_t GroupMembershipIndex::add_group(std::string_view group_id) {
+    if (const uint32_t existing = slot_of(group_id); existing != NO_SLOT) {
+        return existing;
+    }
+
+    uint32_t slot;
+    if (!m_free_slots.empty()) {
+        slot = m_free_slots.back();
+        m_free_slots.pop_back();
+        m_slot_ids[slot] = std::string{group_id};
+    } else {
+        slot = static_cast<uint32_t>(m_slot_ids.size());
+        m_slot_ids.emplace_back(group_id);
+        m_members.emplace_back();
+    }
+    m_slots.emplace(std::string{group_id}, slot);
+
+    // Widen every account's bitset when the slots outgrow it
+    const size_t words = words_for(m_slot_ids.size());
+    if (words > m_words) {
+        std::vector<uint64_t> bits(m_account_count * words, 0);
+        for (size_t account = 0; account < m_account_count; ++account) {
+            std::copy_n(m_bits.begin() + static_cast<std::ptrdiff_t>(account * m_words), m_words,
+                        bits.begin() + static_cast<std::ptrdiff_t>(account * words));
+        }
+        m_bits = std::move(bits);
+        m_words = words;
+    }
+    return slot;
+}
+
+std::vector<uint32_t> GroupMembershipIndex::remove_group(std::string_view group_id) {
+    const auto it = m_slots.find(group_id);
+    if (it == m_slots.end()) {
+        return {};
+    }
+    const uint32_t slot = it->second;
+    m_slots.erase(it);
+
+    std::vector<uint32_t> former = std::move(m_members[slot]);
+    m_members[slot].clear();
+    const uint64_t mask = ~(uint64_t{1} << (slot % 64));
+    for (const uint32_t account : former) {
+        m_bits[account * m_words + slot / 64] &= mask;
+    }
+    m_slot_ids[slot].clear();
+    m_free_slots.push_back(slot);
+    return former;
+}
+
+bool GroupMembershipIndex::insert(uint32_t account, uint32_t slot) {
+    if (account >= m_account_count || slot >= m_slot_ids.size() || contains(account, slot)) {
+        return false;
+    }
+    auto& members = m_members[slot];
+    members.insert(std::lower_bound(members.begin(), members.end(), account), account);
+    set_bit(account, slot);
+    return true;
+}
+
+bool GroupMembershipIndex::erase(uint32_t account, uint32_t slot) {
+    if (!contains(account, slot)) {
+        return false;
+    }
+    auto& members = m_members[slot];
+    members.erase(std::lower_bound(members.begin(), members.end(), account));
+    m_bits[account * m_words + slot / 64] &= ~(uint64_t{1} << (slot % 64));
+    return true;
+}
+
+std::span<const uint32_t> GroupMembershipIndex::members(uint32_t slot) const noexcept {
+    if (slot >= m_members.size()) {
+        return {};
+    }
+    return m_members[slot];
+}
+
+void GroupMembershipIndex::resize_accounts(size_t count) {
+    m_words = std::max(m_words, words_for(m_slot_ids.size()));
+    m_bits.assign(count * m_words, 0);
+    m_account_count = count;
+}
+
+void GroupMembershipIndex::set_bit(uint32_t account, uint32_t slot) noexcept {
+    m_bits[account * m_words + slot / 64] |= uint64_t{1} << (slot % 64);
+}
+
+void GroupMembershipIndex::collect_members() {
+    // Walking accounts in order leaves every list sorted
+    for (auto& members : m_members) {
+        members.clear();
+    }
+    for (uint32_t account = 0; account < m_account_count; ++account) {
+        for_each_group(account, [this, account](uint32_t slot) { m_members[slot].push_back(account); });
+    }
+}
+
+}  // namespace KeepTower
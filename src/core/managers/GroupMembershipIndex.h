@@ -0,0 +1,177 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#ifndef KEEPTOWER_GROUPMEMBERSHIPINDEX_H
+#define KEEPTOWER_GROUPMEMBERSHIPINDEX_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "record.pb.h"
+
+namespace KeepTower {
+
+/**
+ * @brief Group membership of accounts, indexed both ways
+ *
+ * Each group ID is interned to a small integer slot once. For every slot
+ * the index keeps the sorted positions of its member accounts, and for
+ * every account a bitset of the slots it belongs to. Membership tests are
+ * a bit test instead of a scan of the account's memberships with UUID
+ * compares, and listing a group touches only its members.
+ *
+ * Accounts are identified by their position in the vault's account list,
+ * so the index must be rebuilt when accounts are added, removed, moved or
+ * replaced; GroupManager does this lazily.
+ *
+ * Memberships naming a group that is not in the group list are ignored,
+ * as are repeated memberships of one account in the same group.
+ *
+ * @section Thread Safety
+ * Not thread-safe; callers synchronize as for the vault data it mirrors.
+ */
+class GroupMembershipIndex {
+public:
+    /// Slot value for a group that is not indexed
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    /**
+     * @brief Index the given groups and accounts, replacing any previous state
+     * @param groups Groups in any order (ranges of keeptower::AccountGroup)
+     * @param accounts Accounts in vault order (ranges of keeptower::AccountRecord)
+     */
+    template <typename Groups, typename Accounts>
+    void rebuild(const Groups& groups, const Accounts& accounts) {
+        clear();
+        for (const auto& group : groups) {
+            add_group(group.group_id());
+        }
+        resize_accounts(static_cast<size_t>(std::size(accounts)));
+        uint32_t position = 0;
+        for (const auto& account : accounts) {
+            for (const auto& membership : account.groups()) {
+                if (const uint32_t slot = slot_of(membership.group_id()); slot != NO_SLOT) {
+                    set_bit(position, slot);
+                }
+            }
+            ++position;
+        }
+        collect_members();
+    }
+
+    /** @brief Drop all groups and accounts */
+    void clear();
+
+    /**
+     * @brief Slot of a group
+     * @param group_id Group UUID
+     * @return Slot, or NO_SLOT if the group is not indexed
+     */
+    [[nodiscard]] uint32_t slot_of(std::string_view group_id) const;
+
+    /**
+     * @brief Intern a group
+     * @param group_id Group UUID
+     * @return Slot of the group (its existing slot if already indexed)
+     * @note Slots of removed groups are reused
+     */
+    uint32_t add_group(std::string_view group_id);
+
+    /**
+     * @brief Forget a group and all memberships in it
+     * @param group_id Group UUID
+     * @return Positions of the accounts that were members, sorted
+     */
+    std::vector<uint32_t> remove_group(std::string_view group_id);
+
+    /**
+     * @brief Record that an account is in a group
+     * @param account Account position
+     * @param slot Group slot
+     * @return false if it already was
+     */
+    bool insert(uint32_t account, uint32_t slot);
+
+    /**
+     * @brief Record that an account left a group
+     * @param account Account position
+     * @param slot Group slot
+     * @return false if it was not a member
+     */
+    bool erase(uint32_t account, uint32_t slot);
+
+    /**
+     * @brief Whether an account is in a group
+     * @param account Account position
+     * @param slot Group slot (NO_SLOT gives false)
+     */
+    [[nodiscard]] bool contains(uint32_t account, uint32_t slot) const noexcept {
+        if (account >= m_account_count || slot >= m_slot_ids.size()) {
+            return false;
+        }
+        return (m_bits[account * m_words + slot / 64] >> (slot % 64)) & 1u;
+    }
+
+    /**
+     * @brief Members of a group
+     * @param slot Group slot
+     * @return Account positions in ascending order (empty for unknown slots)
+     */
+    [[nodiscard]] std::span<const uint32_t> members(uint32_t slot) const noexcept;
+
+    /**
+     * @brief Call @p visit with the slot of every group an account is in
+     * @param account Account position
+     * @param visit Callable taking a uint32_t slot, called in ascending slot order
+     */
+    template <typename Visit>
+    void for_each_group(uint32_t account, Visit&& visit) const {
+        if (account >= m_account_count) {
+            return;
+        }
+        const uint64_t* words = m_bits.data() + account * m_words;
+        for (size_t w = 0; w < m_words; ++w) {
+            for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+                std::invoke(visit, static_cast<uint32_t>(w * 64 + static_cast<size_t>(std::countr_zero(bits))));
+            }
+        }
+    }
+
+    /** @brief Number of slots in use or free (valid slots are below this) */
+    [[nodiscard]] size_t slot_count() const noexcept { return m_slot_ids.size(); }
+
+    /** @brief Number of indexed groups */
+    [[nodiscard]] size_t group_count() const noexcept { return m_slots.size(); }
+
+    /** @brief Number of indexed accounts */
+    [[nodiscard]] size_t account_count() const noexcept { return m_account_count; }
+
+private:
+    struct IdHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view id) const noexcept { return std::hash<std::string_view>{}(id); }
+    };
+
+    void resize_accounts(size_t count);
+    void set_bit(uint32_t account, uint32_t slot) noexcept;
+    void collect_members();
+
+    std::unordered_map<std::string, uint32_t, IdHash, std::equal_to<>> m_slots;  ///< Group ID -> slot
+    std::vector<std::string> m_slot_ids;               ///< Slot -> group ID (empty when free)
+    std::vector<uint32_t> m_free_slots;                ///< Slots of removed groups
+    std::vector<std::vector<uint32_t>> m_members;      ///< Slot -> sorted account positions
+    std::vector<uint64_t> m_bits;                      ///< m_words words of slot bits per account
+    size_t m_words = 0;                                ///< Bitset words per account
+    size_t m_account_count = 0;                        ///< Indexed accounts
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_GROUPMEMBERSHIPINDEX_H
@@ -0,0 +1,194 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#ifndef KEEPTOWER_IDPOSITIONINDEX_H
+#define KEEPTOWER_IDPOSITIONINDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace KeepTower {
+
+/**
+ * @brief Hash index from record ID to position in a repeated field
+ *
+ * Replaces the linear "walk the list comparing IDs" lookups over accounts
+ * and groups. The owner keeps it in step with appends and erases, and calls
+ * invalidate() for anything else that may move records or change IDs;
+ * lookup() rebuilds it when invalid, when the record count no longer
+ * matches, or when the record at the indexed position has a different ID.
+ *
+ * If several records share an ID, the first one is indexed, matching what
+ * a front-to-back scan would find.
+ *
+ * The functions taking records are templates over the container (a
+ * protobuf RepeatedPtrField or a std::vector) and an @p id_of projection
+ * returning the record's ID as something convertible to std::string_view.
+ *
+ * @section Thread Safety
+ * Not thread-safe; lookup() may rebuild, so even const owners must
+ * serialize access.
+ */
+class IdPositionIndex {
+public:
+    /**
+     * @brief Find a record, rebuilding the index first if it is stale
+     * @param records Records the index describes
+     * @param id Record ID
+     * @param id_of Projection from record to ID
+     * @return Position of the first record with @p id, or nullopt
+     */
+    template <typename Records, typename IdOf>
+    [[nodiscard]] std::optional<size_t> lookup(const Records& records, std::string_view id, IdOf id_of) {
+        if (!m_valid || m_size != static_cast<size_t>(std::size(records))) {
+            rebuild(records, id_of);
+        }
+        auto position = find(id);
+        if (position && std::string_view{id_of(records[static_cast<int>(*position)])} != id) {
+            // A record was rewritten in place without invalidate()
+            rebuild(records, id_of);
+            position = find(id);
+        }
+        return position;
+    }
+
+    /**
+     * @brief Index all records, replacing any previous state
+     * @param records Records in order
+     * @param id_of Projection from record to ID
+     */
+    template <typename Records, typename IdOf>
+    void rebuild(const Records& records, IdOf id_of) {
+        m_positions.clear();
+        m_positions.reserve(static_cast<size_t>(std::size(records)));
+        size_t position = 0;
+        for (const auto& record : records) {
+            m_positions.try_emplace(std::string{std::string_view{id_of(record)}}, position++);
+        }
+        m_size = position;
+        m_valid = true;
+    }
+
+    /**
+     * @brief Record that a record was appended
+     * @param records Records after the append
+     * @param id_of Projection from record to ID
+     * @note Ignored while invalid; invalidates if the count shows other changes
+     */
+    template <typename Records, typename IdOf>
+    void appended(const Records& records, IdOf id_of) {
+        if (!m_valid) {
+            return;
+        }
+        if (m_size + 1 != static_cast<size_t>(std::size(records))) {
+            m_valid = false;
+            return;
+        }
+        m_positions.try_emplace(std::string{std::string_view{id_of(records[static_cast<int>(m_size)])}}, m_size);
+        ++m_size;
+    }
+
+    /**
+     * @brief Record that a record was erased, shifting the ones after it
+     * @param records Records after the erase
+     * @param position Position the erased record had
+     * @param erased_id ID of the erased record
+     * @param id_of Projection from record to ID
+     * @note Updates only the records from @p position on; ignored while
+     *       invalid; invalidates if the count shows other changes
+     */
+    template <typename Records, typename IdOf>
+    void erased(const Records& records, size_t position, std::string_view erased_id, IdOf id_of) {
+        if (!m_valid) {
+            return;
+        }
+        const auto count = static_cast<size_t>(std::size(records));
+        if (count + 1 != m_size) {
+            m_valid = false;
+            return;
+        }
+
+        // A later record with the same ID becomes the indexed one
+        bool reindex_erased_id = false;
+        if (auto it = m_positions.find(erased_id); it != m_positions.end() && it->second == position) {
+            m_positions.erase(it);
+            reindex_erased_id = true;
+        }
+
+        for (size_t i = position; i < count; ++i) {
+            const std::string_view id{id_of(records[static_cast<int>(i)])};
+            if (auto it = m_positions.find(id); it != m_positions.end()) {
+                if (it->second == i + 1) {
+                    it->second = i;
+                }
+            } else if (reindex_erased_id && id == erased_id) {
+                m_positions.emplace(std::string{id}, i);
+                reindex_erased_id = false;
+            }
+        }
+        m_size = count;
+    }
+
+    /**
+     * @brief Whether the index describes @p records exactly (for debug checks)
+     * @param records Records the index should describe
+     * @param id_of Projection from record to ID
+     * @return true if invalid (nothing to check) or every entry matches
+     */
+    template <typename Records, typename IdOf>
+    [[nodiscard]] bool consistent_with(const Records& records, IdOf id_of) const {
+        if (!m_valid) {
+            return true;
+        }
+        if (m_size != static_cast<size_t>(std::size(records))) {
+            return false;
+        }
+        size_t position = 0;
+        size_t first_occurrences = 0;
+        for (const auto& record : records) {
+            const auto indexed = find(std::string_view{id_of(record)});
+            if (!indexed || *indexed > position) {
+                return false;
+            }
+            first_occurrences += *indexed == position ? 1 : 0;
+            ++position;
+        }
+        return first_occurrences == m_positions.size();
+    }
+
+    /** @brief Mark the index stale; the next lookup() rebuilds it */
+    void invalidate() noexcept { m_valid = false; }
+
+    /** @brief Whether the index is currently maintained */
+    [[nodiscard]] bool valid() const noexcept { return m_valid; }
+
+    /** @brief Number of records indexed */
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+
+private:
+    struct IdHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view id) const noexcept { return std::hash<std::string_view>{}(id); }
+    };
+
+    [[nodiscard]] std::optional<size_t> find(std::string_view id) const {
+        const auto it = m_positions.find(id);
+        if (it == m_positions.end()) {
+            return std::nullopt;
+        }
+        return it->second;
+    }
+
+    std::unordered_map<std::string, size_t, IdHash, std::equal_to<>> m_positions;  ///< ID -> first position
+    size_t m_size = 0;     ///< Records indexed
+    bool m_valid = false;  ///< Whether m_positions describes the records
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_IDPOSITIONINDEX_H
@@ -219,14 +219,7 @@ AccountRepository::find_index_by_id(std::string_view account_id) const noexcept
         return std::nullopt;
     }
 
-    const auto all_accounts = account_manager->get_all_accounts();
-    for (size_t i = 0; i < all_accounts.size(); ++i) {
-        if (all_accounts[i].id() == account_id) {
-            return i;
-        }
-    }
-
-    return std::nullopt;
+    return account_manager->find_index_by_id(account_id);
 }
 
 }  // namespace KeepTower
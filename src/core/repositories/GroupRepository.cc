@@ -57,18 +57,13 @@ GroupRepository::get(std::string_view group_id) const {
         return std::unexpected(RepositoryError::VAULT_CLOSED);
     }
 
-    // VaultManager doesn't have get_group_by_id, so search in all groups
     auto* group_manager = m_vault_manager->group_manager();
     if (!group_manager) {
         return std::unexpected(RepositoryError::SAVE_FAILED);
     }
 
-    auto all_groups = group_manager->get_all_groups();
-
-    for (const auto& group : all_groups) {
-        if (group.group_id() == group_id) {
-            return group;
-        }
+    if (const auto* group = group_manager->get_group(group_id)) {
+        return *group;
     }
 
     return std::unexpected(RepositoryError::ACCOUNT_NOT_FOUND);  // Reusing for group not found
@@ -202,29 +197,15 @@ GroupRepository::get_accounts_in_group(std::string_view group_id) const {
         return std::unexpected(RepositoryError::ACCOUNT_NOT_FOUND);
     }
 
-    // VaultManager doesn't have get_accounts_in_group
-    // Need to search through all accounts
-    std::vector<size_t> account_indices;
-    auto* account_manager = m_vault_manager->account_manager();
-    if (!account_manager) {
+    // Members come straight from the membership index, in account order
+    const auto* group_manager = m_vault_manager->group_manager();
+    if (!group_manager) {
         return std::unexpected(RepositoryError::SAVE_FAILED);
     }
 
-    const auto all_accounts = account_manager->get_all_accounts();
-
-    for (size_t i = 0; i < all_accounts.size(); ++i) {
-        const auto& account = all_accounts[i];
-
-        // Check if this account has the group_id (groups field is GroupMembership)
-        for (int j = 0; j < account.groups_size(); ++j) {
-            if (account.groups(j).group_id() == group_id) {
-                account_indices.push_back(i);
-                break;
-            }
-        }
-    }
-
-    return account_indices;
+    const auto& index = group_manager->membership_index();
+    const auto members = index.members(index.slot_of(group_id));
+    return std::vector<size_t>(members.begin(), members.end());
 }
 
 bool GroupRepository::is_vault_open() const noexcept {
@@ -241,15 +222,7 @@ bool GroupRepository::exists(std::string_view group_id) const noexcept {
         return false;
     }
 
-    auto all_groups = group_manager->get_all_groups();
-
-    for (const auto& group : all_groups) {
-        if (group.group_id() == group_id) {
-            return true;
-        }
-    }
-
-    return false;
+    return group_manager->get_group(group_id) != nullptr;
 }
 
 }  // namespace KeepTower
@@ -6,6 +6,8 @@
 
 namespace KeepTower {
 
+static_assert(VaultDataService::PAYLOAD_PREFIX_LENGTH == VaultSerialization::TIERED_PREFIX_LENGTH);
+
 VaultResult<std::vector<uint8_t>> VaultDataService::serialize_vault_data(
     const keeptower::VaultData& vault_data) {
     return VaultSerialization::serialize(vault_data);
@@ -16,6 +18,57 @@ VaultResult<keeptower::VaultData> VaultDataService::deserialize_vault_data(
     return VaultSerialization::deserialize(data);
 }
 
+VaultResult<keeptower::VaultData> VaultDataService::deserialize_vault_data(
+    std::span<const uint8_t> data) {
+    return VaultSerialization::deserialize(data);
+}
+
+VaultResult<std::vector<uint8_t>> VaultDataService::serialize_vault_payload(
+    const keeptower::VaultData& vault_data) {
+    return VaultSerialization::serialize_tiered(vault_data);
+}
+
+VaultResult<VaultDataService::PreparedPayload> VaultDataService::prepare_vault_payload(
+    const keeptower::VaultData& vault_data) {
+    return VaultSerialization::prepare_tiered(vault_data);
+}
+
+VaultResult<> VaultDataService::write_vault_payload(
+    const PreparedPayload& payload,
+    std::span<uint8_t> out) {
+    return VaultSerialization::write_payload(payload, out);
+}
+
+size_t VaultDataService::compressed_payload_bound(const PreparedPayload& payload) {
+    return VaultSerialization::compressed_payload_bound(payload.size());
+}
+
+VaultResult<size_t> VaultDataService::write_compressed_payload(
+    const PreparedPayload& payload,
+    std::span<uint8_t> out) {
+    return VaultSerialization::write_compressed_payload(payload, out);
+}
+
+VaultResult<std::vector<uint8_t>> VaultDataService::decompress_vault_payload(
+    std::span<const uint8_t> data) {
+    return VaultSerialization::decompress_payload(data);
+}
+
+VaultResult<keeptower::VaultData> VaultDataService::deserialize_vault_payload(
+    std::span<const uint8_t> data) {
+    return VaultSerialization::deserialize_payload(data);
+}
+
+std::optional<size_t> VaultDataService::payload_index_end(std::span<const uint8_t> prefix) {
+    return VaultSerialization::tiered_index_end(prefix);
+}
+
+void VaultDataService::merge_account_details(
+    keeptower::VaultData& vault_data,
+    const keeptower::VaultData& details) {
+    VaultSerialization::merge_account_details(vault_data, details);
+}
+
 bool VaultDataService::migrate_vault_schema(
     keeptower::VaultData& vault_data,
     bool& modified) {
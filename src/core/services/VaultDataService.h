@@ -6,6 +6,9 @@
 
 #include "../VaultError.h"
 #include "../record.pb.h"
+#include "lib/vaultformat/VaultSerialization.h"
+#include <optional>
+#include <span>
 #include <vector>
 
 namespace KeepTower {
@@ -21,6 +24,7 @@ namespace KeepTower {
  * **Responsibilities:**
  * - Serialize vault payload protobufs for save/create flows
  * - Deserialize vault payload protobufs for open flows
+ * - Split payloads into an account-list index and deferred account details
  * - Apply schema migration rules and modification tracking
  *
  * **NOT Responsible For:**
@@ -30,6 +34,12 @@ namespace KeepTower {
  */
 class VaultDataService {
 public:
+    /// Leading payload bytes needed by payload_index_end()
+    static constexpr size_t PAYLOAD_PREFIX_LENGTH = 16;
+
+    /// Payload split into tiers and sized, ready to encode into a caller buffer
+    using PreparedPayload = VaultSerialization::TieredPayload;
+
     /**
      * @brief Serialize vault protobuf data for save/create workflows.
      * @param vault_data Vault protobuf object to serialize.
@@ -46,6 +56,91 @@ public:
     [[nodiscard]] static VaultResult<keeptower::VaultData> deserialize_vault_data(
         const std::vector<uint8_t>& data);
 
+    /**
+     * @brief Deserialize vault protobuf data from a byte range.
+     * @param data Serialized vault payload bytes.
+     * @return Parsed vault protobuf object or an error.
+     */
+    [[nodiscard]] static VaultResult<keeptower::VaultData> deserialize_vault_data(
+        std::span<const uint8_t> data);
+
+    /**
+     * @brief Serialize vault data as a two-tier (index + details) payload.
+     * @param vault_data Vault protobuf object to serialize.
+     * @return Serialized payload or an error.
+     * @see VaultSerialization::serialize_tiered
+     */
+    [[nodiscard]] static VaultResult<std::vector<uint8_t>> serialize_vault_payload(
+        const keeptower::VaultData& vault_data);
+
+    /**
+     * @brief Split and size a payload so the caller can allocate its buffer first.
+     * @param vault_data Vault protobuf object to serialize.
+     * @return Prepared payload or an error.
+     * @see VaultSerialization::prepare_tiered
+     */
+    [[nodiscard]] static VaultResult<PreparedPayload> prepare_vault_payload(
+        const keeptower::VaultData& vault_data);
+
+    /**
+     * @brief Encode a prepared payload straight into a caller-provided buffer.
+     * @param payload Payload from prepare_vault_payload().
+     * @param out Destination of exactly payload.size() bytes.
+     * @return Success or an error.
+     */
+    [[nodiscard]] static VaultResult<> write_vault_payload(
+        const PreparedPayload& payload,
+        std::span<uint8_t> out);
+
+    /**
+     * @brief Buffer size that always fits write_compressed_payload() output.
+     * @param payload Payload from prepare_vault_payload().
+     * @return Upper bound in bytes.
+     */
+    [[nodiscard]] static size_t compressed_payload_bound(const PreparedPayload& payload);
+
+    /**
+     * @brief Encode a prepared payload and compress it into a caller-provided buffer.
+     * @param payload Payload from prepare_vault_payload().
+     * @param out Destination of at least compressed_payload_bound() bytes.
+     * @return Compressed size written to the start of out, or an error.
+     * @see VaultSerialization::write_compressed_payload
+     */
+    [[nodiscard]] static VaultResult<size_t> write_compressed_payload(
+        const PreparedPayload& payload,
+        std::span<uint8_t> out);
+
+    /**
+     * @brief Undo write_compressed_payload() on a decrypted payload.
+     * @param data Compressed payload bytes.
+     * @return Two-tier or plain payload bytes, or an error.
+     */
+    [[nodiscard]] static VaultResult<std::vector<uint8_t>> decompress_vault_payload(
+        std::span<const uint8_t> data);
+
+    /**
+     * @brief Deserialize a complete two-tier or plain payload.
+     * @param data Payload bytes.
+     * @return Parsed vault protobuf object or an error.
+     */
+    [[nodiscard]] static VaultResult<keeptower::VaultData> deserialize_vault_payload(
+        std::span<const uint8_t> data);
+
+    /**
+     * @brief Offset where the account-details tier of a payload begins.
+     * @param prefix At least the first PAYLOAD_PREFIX_LENGTH bytes.
+     * @return Details offset, or nullopt when the payload is not two-tier.
+     */
+    [[nodiscard]] static std::optional<size_t> payload_index_end(std::span<const uint8_t> prefix);
+
+    /**
+     * @brief Apply a parsed account-details tier to index-only vault data.
+     * @param vault_data Vault data opened from the index tier (updated in place).
+     * @param details Parsed details tier.
+     */
+    static void merge_account_details(keeptower::VaultData& vault_data,
+                                      const keeptower::VaultData& details);
+
     /**
      * @brief Apply schema migrations and modification tracking.
      * @param vault_data Vault protobuf object to migrate.
@@ -4,11 +4,14 @@
 
 #include "VaultFileService.h"
 #include "lib/vaultformat/VaultFormatV2.h"
+#include "lib/fec/ReedSolomon.h"
+#include "lib/fec/WindowedFec.h"
 #include "lib/storage/VaultIO.h"
 #include "../../utils/Log.h"
 #include "../../utils/SecureMemory.h"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <filesystem>
@@ -16,9 +19,18 @@
 #include <iomanip>
 #include <sstream>
 #include <limits>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
 
 #ifndef _WIN32
+#include <cerrno>
+#include <climits>
+#include <cstring>
 #include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #endif
 
@@ -27,6 +39,9 @@ namespace Log = KeepTower::Log;
 
 namespace KeepTower {
 
+static_assert(VaultFileService::FORMAT_VERSION_SINGLE_PAYLOAD == VaultFormatV2::VAULT_VERSION_V2);
+static_assert(VaultFileService::FORMAT_VERSION_SEGMENTED_PAYLOAD == VaultFormatV2::VAULT_VERSION_V3);
+
 // ============================================================================
 // File Reading Operations
 // ============================================================================
@@ -36,117 +51,341 @@ VaultResult<> VaultFileService::read_vault_file(
     std::vector<uint8_t>& data,
     int& pbkdf2_iterations) {
 
-    try {
-        // Check file exists and is readable
-        if (!fs::exists(path)) {
-            Log::error("VaultFileService: File does not exist: {}", path);
-            return std::unexpected(VaultError::FileNotFound);
-        }
+    auto file = map_vault_file(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
 
-        if (!fs::is_regular_file(path)) {
-            Log::error("VaultFileService: Not a regular file: {}", path);
-            return std::unexpected(VaultError::FileReadError);
-        }
+    const auto bytes = file->bytes();
+    data.assign(bytes.begin(), bytes.end());
 
-        // Open file for binary reading
-        std::ifstream file(path, std::ios::binary | std::ios::ate);
-        if (!file) {
-            Log::error("VaultFileService: Failed to open file: {}", path);
-            return std::unexpected(VaultError::FileReadError);
-        }
+    // V2 format: PBKDF2 iterations are stored in the V2 header and handled by VaultFormatV2.
+    pbkdf2_iterations = 0;
+    return {};
+}
 
-        // Get file size
-        const std::streamsize file_size = file.tellg();
-        if (file_size <= 0) {
-            Log::error("VaultFileService: Empty or invalid file: {}", path);
-            return std::unexpected(VaultError::InvalidData);
-        }
+VaultResult<MappedVaultFile> VaultFileService::map_vault_file(const std::string& path) {
+    auto file = MappedVaultFile::open(path);
+    if (!file) {
+        Log::error("VaultFileService: Failed to open vault file: {}", path);
+        return std::unexpected(file.error());
+    }
 
-        // Prevent excessive allocations on corrupted/hostile inputs.
-        constexpr std::streamsize MAX_VAULT_FILE_SIZE = 1024LL * 1024 * 1024;
-        if (file_size > MAX_VAULT_FILE_SIZE) {
-            Log::error("VaultFileService: Vault file too large: {} ({} bytes)", path, file_size);
-            return std::unexpected(VaultError::InvalidData);
-        }
+    if (file->empty()) {
+        Log::error("VaultFileService: Empty or invalid file: {}", path);
+        return std::unexpected(VaultError::InvalidData);
+    }
 
-        if (static_cast<std::uintmax_t>(file_size) > std::numeric_limits<size_t>::max()) {
-            Log::error("VaultFileService: Vault file size overflows addressable memory: {}", path);
-            return std::unexpected(VaultError::InvalidData);
-        }
+    // Detect format (V2 only)
+    auto version = detect_vault_version(file->bytes());
+    if (!version) {
+        Log::error("VaultFileService: Invalid vault format: {}", path);
+        return std::unexpected(VaultError::InvalidData);
+    }
+    if (*version != 2) {
+        Log::error("VaultFileService: Unsupported vault version {}: {}", *version, path);
+        return std::unexpected(VaultError::UnsupportedVersion);
+    }
 
-        // Read entire file into buffer
-        file.seekg(0, std::ios::beg);
-        data.resize(static_cast<size_t>(file_size));
+    Log::debug("VaultFileService: Mapped V2 vault ({} bytes)", file->size());
+    return file;
+}
+
+// ============================================================================
+// File Writing Operations
+// ============================================================================
 
-        if (!file.read(reinterpret_cast<char*>(data.data()), file_size)) {
-            Log::error("VaultFileService: Failed to read file contents: {}", path);
-            return std::unexpected(VaultError::FileReadError);
+namespace {
+
+using SyncPolicy = VaultFileService::SyncPolicy;
+using Clock = std::chrono::steady_clock;
+
+/// Process-wide durability settings and per-policy latency counters
+struct WriteSyncState {
+    std::atomic<SyncPolicy> policy{SyncPolicy::DataOnly};
+    std::mutex mutex;
+    std::set<std::string> deferred_dirs;  ///< Directories with renames not yet synced
+    std::array<VaultFileService::WriteLatency, 3> latency{};
+};
+
+WriteSyncState& write_sync_state() {
+    static WriteSyncState state;
+    return state;
+}
+
+void record_latency(SyncPolicy policy, Clock::duration total, Clock::duration sync) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    auto& state = write_sync_state();
+    std::lock_guard lock(state.mutex);
+    auto& latency = state.latency[static_cast<size_t>(policy)];
+    const auto total_us = duration_cast<microseconds>(total);
+    ++latency.writes;
+    latency.total += total_us;
+    latency.sync_total += duration_cast<microseconds>(sync);
+    latency.max = std::max(latency.max, total_us);
+    latency.last = total_us;
+}
+
+#ifndef _WIN32
+bool sync_fd(int fd, SyncPolicy policy) {
+    int rc = 0;
+    do {
+        rc = policy == SyncPolicy::Strict ? fsync(fd) : fdatasync(fd);
+    } while (rc != 0 && errno == EINTR);
+    return rc == 0;
+}
+
+bool writev_all(int fd, std::span<const std::span<const uint8_t>> parts) {
+    std::vector<struct iovec> iov;
+    iov.reserve(parts.size());
+    for (const auto& part : parts) {
+        if (!part.empty()) {
+            iov.push_back({const_cast<uint8_t*>(part.data()), part.size()});
         }
+    }
 
-        // Detect format (V2 only)
-        auto version = detect_vault_version(data);
-        if (!version) {
-            Log::error("VaultFileService: Invalid vault format: {}", path);
-            return std::unexpected(VaultError::InvalidData);
+    size_t next = 0;
+    while (next < iov.size()) {
+        const int count = static_cast<int>(std::min<size_t>(iov.size() - next, IOV_MAX));
+        const ssize_t n = writev(fd, iov.data() + next, count);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
         }
-        if (*version != 2) {
-            Log::error("VaultFileService: Unsupported vault version {}: {}", *version, path);
-            return std::unexpected(VaultError::UnsupportedVersion);
+        // Skip fully written parts, then trim a partially written one
+        size_t written = static_cast<size_t>(n);
+        while (next < iov.size() && written >= iov[next].iov_len) {
+            written -= iov[next].iov_len;
+            ++next;
         }
+        if (written > 0) {
+            iov[next].iov_base = static_cast<uint8_t*>(iov[next].iov_base) + written;
+            iov[next].iov_len -= written;
+        }
+    }
+    return true;
+}
 
-        // V2 format: PBKDF2 iterations are stored in the V2 header and handled by VaultFormatV2.
-        pbkdf2_iterations = 0;
+/// Serialises renames over vault files with guarded replaces and journal appends
+std::mutex& replace_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
 
-        Log::debug("VaultFileService: Read V2 vault ({} bytes)", data.size());
+VaultFileService::FileIdentity identity_of(const struct stat& st) {
+    constexpr int64_t NS = 1'000'000'000;
+    return {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino),
+            static_cast<uint64_t>(st.st_size),
+            static_cast<int64_t>(st.st_mtim.tv_sec) * NS + st.st_mtim.tv_nsec};
+}
 
-        return {};
+/// Sibling staging name unique across threads and processes
+std::string staging_name(const std::string& file_name) {
+    static std::atomic<uint64_t> counter{0};
+    static const uint64_t salt = std::random_device{}();
+    return file_name + ".tmp." + std::to_string(getpid()) + "." +
+           std::to_string(salt ^ counter.fetch_add(1, std::memory_order_relaxed));
+}
 
-    } catch (const std::exception& e) {
-        Log::error("VaultFileService: Exception reading file: {}", e.what());
-        return std::unexpected(VaultError::FileReadError);
+/// Give an O_TMPFILE inode a (staging) name in dir_fd
+bool link_anonymous(int fd, int dir_fd, const std::string& name) {
+#if defined(O_TMPFILE) && defined(AT_EMPTY_PATH)
+    if (linkat(fd, "", dir_fd, name.c_str(), AT_EMPTY_PATH) == 0) {
+        return true;
+    }
+    if (errno == EEXIST) {
+        return false;
     }
+    // AT_EMPTY_PATH needs CAP_DAC_READ_SEARCH; /proc works unprivileged
+    const std::string proc_path = "/proc/self/fd/" + std::to_string(fd);
+    return linkat(AT_FDCWD, proc_path.c_str(), dir_fd, name.c_str(), AT_SYMLINK_FOLLOW) == 0;
+#else
+    (void)fd;
+    (void)dir_fd;
+    (void)name;
+    errno = ENOTSUP;
+    return false;
+#endif
 }
+#endif
 
-// ============================================================================
-// File Writing Operations
-// ============================================================================
-
-VaultResult<> VaultFileService::write_vault_file(
-    const std::string& path,
-    const std::vector<uint8_t>& data,
-    bool is_v2_vault,
-    int pbkdf2_iterations) {
-    const std::string temp_path = path + ".tmp";
+/**
+ * Write parts back to back into path, atomically and durably.
+ *
+ * POSIX: the data goes to an anonymous O_TMPFILE in the target directory
+ * (or an O_EXCL staging file), preallocated with fallocate() and written with
+ * one writev(). It is synced per policy before it gets a name, then linked
+ * under a unique staging name and renamed over path, so no partial or
+ * unsynced file is ever visible under any name.
+ */
+VaultResult<> write_parts_atomically(const std::string& path,
+                                     std::span<const std::span<const uint8_t>> parts,
+                                     const VaultFileService::FileIdentity* expected = nullptr) {
+    const auto started = Clock::now();
+    const SyncPolicy policy = write_sync_state().policy.load();
+
+    const fs::path file_path(path);
+    const fs::path parent_dir = file_path.parent_path();
 
     try {
         // Ensure parent directory exists
-        const fs::path file_path(path);
-        const fs::path parent_dir = file_path.parent_path();
-
         if (!parent_dir.empty() && !fs::exists(parent_dir)) {
             fs::create_directories(parent_dir);
         }
+    } catch (const std::exception& e) {
+        Log::error("VaultFileService: Failed to create vault directory: {}", e.what());
+        return std::unexpected(VaultError::FileWriteError);
+    }
+
+#ifndef _WIN32
+    const std::string dir_path = parent_dir.empty() ? std::string(".") : parent_dir.string();
+    const std::string file_name = file_path.filename().string();
 
-        // Write to temporary file
+    const int dir_fd = open(dir_path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd < 0) {
+        Log::error("VaultFileService: Failed to open vault directory: {}", dir_path);
+        return std::unexpected(VaultError::FileWriteError);
+    }
+
+    int fd = -1;
+#ifdef O_TMPFILE
+    fd = openat(dir_fd, ".", O_TMPFILE | O_WRONLY | O_CLOEXEC, S_IRUSR | S_IWUSR);
+#endif
+    const bool anonymous = fd >= 0;
+    std::string temp_name;
+    if (!anonymous) {
+        // Filesystem without O_TMPFILE: O_EXCL on a fresh name, owner read/write only
+        for (int attempt = 0; attempt < 8 && fd < 0; ++attempt) {
+            temp_name = staging_name(file_name);
+            fd = openat(dir_fd, temp_name.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC | O_NOFOLLOW,
+                        S_IRUSR | S_IWUSR);
+            if (fd < 0 && errno != EEXIST) {
+                break;
+            }
+        }
+    }
+
+    auto fail = [&](const char* what) -> VaultResult<> {
+        Log::error("VaultFileService: {} for {}: {}", what, path, std::strerror(errno));
+        if (fd >= 0) {
+            close(fd);
+        }
+        if (!temp_name.empty()) {
+            unlinkat(dir_fd, temp_name.c_str(), 0);
+        }
+        close(dir_fd);
+        return std::unexpected(VaultError::FileWriteError);
+    };
+
+    if (fd < 0) {
+        temp_name.clear();
+        return fail("Failed to create temporary file");
+    }
+
+    size_t total_size = 0;
+    for (const auto& part : parts) {
+        total_size += part.size();
+    }
+
+#ifdef __linux__
+    // Reserve every extent up front: ENOSPC surfaces before a byte is written
+    if (total_size > 0 && fallocate(fd, 0, 0, static_cast<off_t>(total_size)) != 0 &&
+        errno != EOPNOTSUPP && errno != ENOSYS && errno != EINVAL) {
+        return fail("Failed to preallocate temporary file");
+    }
+#endif
+
+    if (!writev_all(fd, parts)) {
+        return fail("Failed to write data to temporary file");
+    }
+
+    // The data must be durable before any name can point at it
+    const auto sync_started = Clock::now();
+    if (!sync_fd(fd, policy)) {
+        return fail("Failed to sync temporary file");
+    }
+    auto sync_time = Clock::now() - sync_started;
+
+    if (anonymous) {
+        bool linked = false;
+        for (int attempt = 0; attempt < 8 && !linked; ++attempt) {
+            temp_name = staging_name(file_name);
+            linked = link_anonymous(fd, dir_fd, temp_name);
+            if (!linked && errno != EEXIST) {
+                break;
+            }
+        }
+        if (!linked) {
+            temp_name.clear();
+            return fail("Failed to link temporary file");
+        }
+    }
+
+    {
+        std::lock_guard replace_lock(replace_mutex());
+        struct stat current{};
+        if (expected && (fstatat(dir_fd, file_name.c_str(), &current, AT_SYMLINK_NOFOLLOW) != 0 ||
+                         !(identity_of(current) == *expected))) {
+            Log::warning("VaultFileService: {} changed since it was read, not replacing it", path);
+            close(fd);
+            if (!temp_name.empty()) {
+                unlinkat(dir_fd, temp_name.c_str(), 0);
+            }
+            close(dir_fd);
+            return std::unexpected(VaultError::Busy);
+        }
+
+        // Atomic rename (overwrites target if exists)
+        if (renameat(dir_fd, temp_name.c_str(), dir_fd, file_name.c_str()) != 0) {
+            return fail("Failed to rename temporary file");
+        }
+    }
+    temp_name.clear();
+    close(fd);
+    fd = -1;
+
+    // Make the rename durable now, or once per burst under Batched
+    if (policy == SyncPolicy::Batched) {
+        auto& state = write_sync_state();
+        std::lock_guard lock(state.mutex);
+        state.deferred_dirs.insert(dir_path);
+    } else {
+        const auto dir_sync_started = Clock::now();
+        if (fsync(dir_fd) != 0) {
+            // The new vault is in place; only the rename's durability is in doubt
+            Log::warning("VaultFileService: Failed to sync directory {}: {}", dir_path, std::strerror(errno));
+        }
+        sync_time += Clock::now() - dir_sync_started;
+    }
+    close(dir_fd);
+
+    const auto elapsed = Clock::now() - started;
+    record_latency(policy, elapsed, sync_time);
+    Log::debug("VaultFileService: Wrote {} bytes in {} us (sync {} us, policy {})", total_size,
+               std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(),
+               std::chrono::duration_cast<std::chrono::microseconds>(sync_time).count(),
+               VaultFileService::sync_policy_name(policy));
+    return {};
+#else
+    if (expected) {
+        Log::error("VaultFileService: Guarded replace is not supported on this platform");
+        return std::unexpected(VaultError::FileWriteError);
+    }
+    const std::string temp_path = path + ".tmp";
+    try {
         {
             std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
             if (!file) {
                 Log::error("VaultFileService: Failed to create temporary file: {}", temp_path);
                 return std::unexpected(VaultError::FileWriteError);
             }
-
-            (void)pbkdf2_iterations;
-
-            if (!is_v2_vault) {
-                Log::error("VaultFileService: V1 vault format is no longer supported");
-                return std::unexpected(VaultError::UnsupportedVersion);
+            for (const auto& part : parts) {
+                file.write(reinterpret_cast<const char*>(part.data()),
+                           static_cast<std::streamsize>(part.size()));
             }
-
-            // V2: Data already contains full header, write directly
-            file.write(reinterpret_cast<const char*>(data.data()),
-                      static_cast<std::streamsize>(data.size()));
-
-            // Flush and sync to disk
             file.flush();
             if (!file.good()) {
                 Log::error("VaultFileService: Failed to write data to temporary file");
@@ -154,65 +393,142 @@ VaultResult<> VaultFileService::write_vault_file(
             }
         }
 
-        // Set secure permissions (owner read/write only)
-#ifndef _WIN32
-        fs::permissions(temp_path,
-                       fs::perms::owner_read | fs::perms::owner_write,
-                       fs::perm_options::replace);
-#endif
-
         // Atomic rename (overwrites target if exists)
         fs::rename(temp_path, path);
+        record_latency(policy, Clock::now() - started, Clock::duration::zero());
+        return {};
+    } catch (const std::exception& e) {
+        Log::error("VaultFileService: Exception writing file: {}", e.what());
 
-        // Sync parent directory for durability
-#ifndef _WIN32
-        try {
-            const int dir_fd = open(parent_dir.c_str(), O_RDONLY | O_DIRECTORY);
-            if (dir_fd >= 0) {
-                fsync(dir_fd);
-                close(dir_fd);
-            }
-        } catch (...) {
-            // Non-fatal: directory sync is optimization
-        }
+        // Cleanup temporary file if it exists
+        std::error_code ec;
+        fs::remove(temp_path, ec);
+        return std::unexpected(VaultError::FileWriteError);
+    }
 #endif
+}
 
-        Log::debug("VaultFileService: Wrote V2 vault ({} bytes)", data.size());
+}  // namespace
 
-        return {};
+void VaultFileService::set_sync_policy(SyncPolicy policy) {
+    auto& state = write_sync_state();
+    if (state.policy.exchange(policy) == SyncPolicy::Batched && policy != SyncPolicy::Batched) {
+        (void)sync_deferred();
+    }
+}
 
-    } catch (const std::exception& e) {
-        Log::error("VaultFileService: Exception writing file: {}", e.what());
+VaultFileService::SyncPolicy VaultFileService::sync_policy() {
+    return write_sync_state().policy.load();
+}
 
-        // Cleanup temporary file if it exists
-        try {
-            if (fs::exists(temp_path)) {
-                fs::remove(temp_path);
-            }
-        } catch (...) {
-            // Ignore cleanup errors
-        }
+std::optional<VaultFileService::SyncPolicy> VaultFileService::parse_sync_policy(std::string_view name) {
+    if (name == "strict") {
+        return SyncPolicy::Strict;
+    }
+    if (name == "data") {
+        return SyncPolicy::DataOnly;
+    }
+    if (name == "batched") {
+        return SyncPolicy::Batched;
+    }
+    return std::nullopt;
+}
+
+const char* VaultFileService::sync_policy_name(SyncPolicy policy) {
+    switch (policy) {
+        case SyncPolicy::Strict:
+            return "strict";
+        case SyncPolicy::DataOnly:
+            return "data";
+        case SyncPolicy::Batched:
+            return "batched";
+    }
+    return "data";
+}
+
+VaultResult<> VaultFileService::sync_deferred() {
+    std::set<std::string> dirs;
+    {
+        auto& state = write_sync_state();
+        std::lock_guard lock(state.mutex);
+        dirs.swap(state.deferred_dirs);
+    }
 
+    bool ok = true;
+#ifndef _WIN32
+    for (const auto& dir : dirs) {
+        const int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd < 0 || fsync(dir_fd) != 0) {
+            Log::warning("VaultFileService: Failed to sync directory {}", dir);
+            ok = false;
+        }
+        if (dir_fd >= 0) {
+            close(dir_fd);
+        }
+    }
+#endif
+    if (!dirs.empty()) {
+        Log::debug("VaultFileService: Synced {} deferred director{}", dirs.size(), dirs.size() == 1 ? "y" : "ies");
+    }
+    if (!ok) {
         return std::unexpected(VaultError::FileWriteError);
     }
+    return {};
 }
 
-VaultResult<> VaultFileService::write_v2_vault(
+VaultFileService::WriteLatency VaultFileService::write_latency(SyncPolicy policy) {
+    auto& state = write_sync_state();
+    std::lock_guard lock(state.mutex);
+    return state.latency[static_cast<size_t>(policy)];
+}
+
+void VaultFileService::reset_write_latency() {
+    auto& state = write_sync_state();
+    std::lock_guard lock(state.mutex);
+    state.latency = {};
+}
+
+VaultResult<> VaultFileService::write_vault_file(
     const std::string& path,
+    const std::vector<uint8_t>& data,
+    bool is_v2_vault,
+    int pbkdf2_iterations) {
+    (void)pbkdf2_iterations;
+
+    if (!is_v2_vault) {
+        Log::error("VaultFileService: V1 vault format is no longer supported");
+        return std::unexpected(VaultError::UnsupportedVersion);
+    }
+
+    // V2: Data already contains full header, write directly
+    const std::span<const uint8_t> parts[] = {data};
+    auto result = write_parts_atomically(path, parts);
+    if (result) {
+        Log::debug("VaultFileService: Wrote V2 vault ({} bytes)", data.size());
+    }
+    return result;
+}
+
+VaultResult<std::vector<uint8_t>> VaultFileService::build_v2_header(
     const VaultHeaderV2& vault_header,
     uint32_t pbkdf2_iterations,
     std::span<const uint8_t> data_salt,
     std::span<const uint8_t> data_iv,
-    const std::vector<uint8_t>& ciphertext,
     bool enable_header_fec,
-    uint8_t data_fec_redundancy) {
+    uint8_t data_fec_redundancy,
+    uint32_t format_version,
+    bool compressed_payload) {
     if (data_iv.size() != VaultFormatV2::V2FileHeader{}.data_iv.size()) {
         Log::error("VaultFileService: Invalid V2 data IV size: {}", data_iv.size());
         return std::unexpected(VaultError::InvalidData);
     }
 
     VaultFormatV2::V2FileHeader file_header{};
+    file_header.version = format_version;
     file_header.pbkdf2_iterations = pbkdf2_iterations;
+    file_header.payload_compression = compressed_payload
+        ? VaultFormatV2::PAYLOAD_COMPRESSION_ZLIB
+        : VaultFormatV2::PAYLOAD_COMPRESSION_NONE;
     file_header.vault_header = vault_header;
 
     for (auto& slot : file_header.vault_header.key_slots) {
@@ -222,22 +538,162 @@ VaultResult<> VaultFileService::write_v2_vault(
     std::copy_n(data_salt.begin(), std::min(data_salt.size(), file_header.data_salt.size()), file_header.data_salt.begin());
     std::copy_n(data_iv.begin(), file_header.data_iv.size(), file_header.data_iv.begin());
 
-    auto header_bytes_result = VaultFormatV2::write_header(
+    if (data_fec_redundancy != 0) {
+        file_header.data_fec_parity_symbols =
+            static_cast<uint8_t>(ReedSolomon::parity_symbols_for(data_fec_redundancy));
+        file_header.data_fec_window_size = WindowedFec::DEFAULT_WINDOW_SIZE;
+    }
+
+    return VaultFormatV2::write_header(
         file_header,
         enable_header_fec,
         data_fec_redundancy);
+}
+
+VaultResult<> VaultFileService::write_v2_vault(
+    const std::string& path,
+    const VaultHeaderV2& vault_header,
+    uint32_t pbkdf2_iterations,
+    std::span<const uint8_t> data_salt,
+    std::span<const uint8_t> data_iv,
+    std::span<const uint8_t> ciphertext,
+    bool enable_header_fec,
+    uint8_t data_fec_redundancy,
+    uint32_t format_version,
+    bool compressed_payload) {
+    auto header_bytes_result = build_v2_header(
+        vault_header,
+        pbkdf2_iterations,
+        data_salt,
+        data_iv,
+        enable_header_fec,
+        data_fec_redundancy,
+        format_version,
+        compressed_payload);
     if (!header_bytes_result) {
         return std::unexpected(header_bytes_result.error());
     }
 
-    std::vector<uint8_t> file_data = *header_bytes_result;
-    file_data.insert(file_data.end(), ciphertext.begin(), ciphertext.end());
+    if (data_fec_redundancy == 0) {
+        // Header and ciphertext are written side by side, never concatenated
+        const std::span<const uint8_t> parts[] = {*header_bytes_result, ciphertext};
+        auto result = write_parts_atomically(path, parts);
+        if (result) {
+            Log::debug("VaultFileService: Wrote V2 vault ({} bytes)",
+                       header_bytes_result->size() + ciphertext.size());
+        }
+        return result;
+    }
+
+    // The ciphertext stays in place between its length prefix and FEC trailer
+    auto framing = VaultFormatV2::protect_data_section(
+        static_cast<uint8_t>(ReedSolomon::parity_symbols_for(data_fec_redundancy)),
+        WindowedFec::DEFAULT_WINDOW_SIZE,
+        ciphertext);
+    if (!framing) {
+        return std::unexpected(framing.error());
+    }
+    const std::span<const uint8_t> parts[] = {
+        *header_bytes_result, framing->prefix, ciphertext, framing->trailer};
+    auto result = write_parts_atomically(path, parts);
+    if (result) {
+        Log::debug("VaultFileService: Wrote V2 vault ({} bytes, {} bytes data FEC)",
+                   header_bytes_result->size() + ciphertext.size() +
+                       framing->prefix.size() + framing->trailer.size(),
+                   framing->prefix.size() + framing->trailer.size());
+    }
+    return result;
+}
+
+std::optional<VaultFileService::FileIdentity> VaultFileService::file_identity(int fd) {
+#ifndef _WIN32
+    struct stat st{};
+    if (fstat(fd, &st) != 0) {
+        return std::nullopt;
+    }
+    return identity_of(st);
+#else
+    (void)fd;
+    return std::nullopt;
+#endif
+}
 
-    return write_vault_file(path, file_data, true, 0);
+VaultResult<> VaultFileService::replace_vault_file_if_unchanged(
+    const std::string& path,
+    std::span<const std::span<const uint8_t>> parts,
+    const FileIdentity& expected) {
+    return write_parts_atomically(path, parts, &expected);
+}
+
+VaultResult<> VaultFileService::append_vault_file(
+    const std::string& path,
+    std::span<const uint8_t> data,
+    uint64_t expected_size,
+    std::span<const uint8_t> expected_prefix) {
+#ifndef _WIN32
+    // A guarded replace must not slip between the checks below and the write
+    std::lock_guard replace_lock(replace_mutex());
+    const int fd = open(path.c_str(), O_RDWR | O_APPEND | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        Log::error("VaultFileService: Failed to open vault for append: {}", path);
+        return std::unexpected(VaultError::FileWriteError);
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        static_cast<uint64_t>(st.st_size) != expected_size) {
+        Log::warning("VaultFileService: Vault changed on disk, refusing to append: {}", path);
+        close(fd);
+        return std::unexpected(VaultError::FileWriteError);
+    }
+
+    if (!expected_prefix.empty()) {
+        std::vector<uint8_t> on_disk(expected_prefix.size());
+        const ssize_t n = pread(fd, on_disk.data(), on_disk.size(), 0);
+        if (n != static_cast<ssize_t>(on_disk.size()) ||
+            !std::equal(on_disk.begin(), on_disk.end(), expected_prefix.begin())) {
+            Log::warning("VaultFileService: Vault header changed on disk, refusing to append: {}", path);
+            close(fd);
+            return std::unexpected(VaultError::FileWriteError);
+        }
+    }
+
+    size_t written = 0;
+    while (written < data.size()) {
+        const ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    if (written != data.size() || !sync_fd(fd, sync_policy())) {
+        Log::error("VaultFileService: Failed to append {} bytes to {}", data.size(), path);
+        // Drop the torn tail so the on-disk journal stays parseable
+        if (ftruncate(fd, static_cast<off_t>(expected_size)) == 0) {
+            (void)fdatasync(fd);
+        }
+        close(fd);
+        return std::unexpected(VaultError::FileWriteError);
+    }
+
+    close(fd);
+    Log::debug("VaultFileService: Appended {} bytes to {}", data.size(), path);
+    return {};
+#else
+    (void)path;
+    (void)data;
+    (void)expected_size;
+    (void)expected_prefix;
+    return std::unexpected(VaultError::FileWriteError);
+#endif
 }
 
 VaultResult<VaultFileService::V2VaultMetadata> VaultFileService::read_v2_metadata(
-    const std::vector<uint8_t>& file_data) {
+    std::span<const uint8_t> file_data) {
     auto parse_result = VaultFormatV2::read_header(file_data);
     if (!parse_result) {
         return std::unexpected(parse_result.error());
@@ -252,15 +708,52 @@ VaultResult<VaultFileService::V2VaultMetadata> VaultFileService::read_v2_metadat
     metadata.data_salt = file_header.data_salt;
     metadata.data_iv = file_header.data_iv;
     metadata.data_offset = data_offset;
+    metadata.format_version = file_header.version;
+    metadata.compressed_payload =
+        file_header.payload_compression != VaultFormatV2::PAYLOAD_COMPRESSION_NONE;
+    metadata.data_fec_parity_symbols = file_header.data_fec_parity_symbols;
+    metadata.data_fec_window_size = file_header.data_fec_window_size;
     return metadata;
 }
 
+VaultResult<VaultFileService::V2DataSection> VaultFileService::open_v2_data_section(
+    const V2VaultMetadata& metadata,
+    std::span<const uint8_t> payload) {
+    V2DataSection section;
+    if (metadata.data_fec_parity_symbols == 0) {
+        section.ciphertext = payload;
+        section.stored_size = payload.size();
+        return section;
+    }
+
+    auto opened = VaultFormatV2::open_data_section(
+        metadata.data_fec_parity_symbols, metadata.data_fec_window_size, payload);
+    if (!opened) {
+        return std::unexpected(opened.error());
+    }
+    // Moving the buffer keeps the span into it valid
+    section.ciphertext = opened->ciphertext;
+    section.repaired = std::move(opened->repaired);
+    section.stored_size = opened->stored_size;
+    section.damaged_windows = opened->damaged_windows;
+    section.repaired_bytes = opened->repaired_bytes;
+    return section;
+}
+
+size_t VaultFileService::v2_payload_size(uint8_t data_fec_redundancy, size_t ciphertext_size) {
+    if (data_fec_redundancy == 0) {
+        return ciphertext_size;
+    }
+    const WindowedFec fec(ReedSolomon::parity_symbols_for(data_fec_redundancy));
+    return VaultFormatV2::DATA_FEC_PREFIX_SIZE + ciphertext_size + fec.trailer_size(ciphertext_size);
+}
+
 // ============================================================================
 // Format Detection
 // ============================================================================
 
 std::optional<uint32_t> VaultFileService::detect_vault_version(
-    const std::vector<uint8_t>& data) {
+    std::span<const uint8_t> data) {
 
     // Minimum size check (at least magic + version)
     if (data.size() < 8) {
@@ -268,8 +761,9 @@ std::optional<uint32_t> VaultFileService::detect_vault_version(
     }
 
     // V2 format detection (delegate to VaultFormatV2)
+    // V3 differs only in payload encoding and shares the V2 open flow
     auto v2_result = VaultFormatV2::detect_version(data);
-    if (v2_result && v2_result.value() == 2) {
+    if (v2_result && VaultFormatV2::is_supported_version(v2_result.value())) {
         return 2;
     }
 
@@ -305,24 +799,186 @@ std::optional<uint32_t> VaultFileService::detect_vault_version_from_file(
     }
 }
 
-bool VaultFileService::check_vault_requires_yubikey(
-    const std::string& path,
-    std::string& serial) {
-    std::vector<uint8_t> file_data;
-    int unused_iterations = 0;
+namespace {
 
-    auto read_result = read_vault_file(path, file_data, unused_iterations);
-    if (!read_result) {
-        return false;
+#ifndef _WIN32
+/**
+ * Parsed headers of recently probed files, keyed by file identity.
+ *
+ * Timestamps have coarse granularity and inode numbers are reused, so a file
+ * replaced within the same tick can look identical. As in git's racy-clean
+ * check, an entry stored less than RACY_WINDOW after the file last changed is
+ * only trusted once its raw header bytes are compared again.
+ */
+class HeaderProbeCache {
+public:
+    static constexpr size_t CAPACITY = 16;
+    static constexpr int64_t RACY_WINDOW_NS = 2'000'000'000;
+
+    struct Identity {
+        dev_t device = 0;
+        ino_t inode = 0;
+        off_t size = 0;
+        int64_t mtime_ns = 0;
+        int64_t ctime_ns = 0;
+
+        bool operator==(const Identity&) const = default;
+    };
+
+    struct Entry {
+        Identity identity;
+        uint64_t last_used = 0;
+        bool racy = true;                   ///< Stored too soon after the file changed
+        std::vector<uint8_t> header_bytes;  ///< Raw bytes the metadata was parsed from
+        VaultFileService::V2VaultMetadata metadata;
+    };
+
+    static Identity identity_of(const struct stat& st) {
+        constexpr int64_t NS = 1'000'000'000;
+        return {st.st_dev, st.st_ino, st.st_size,
+                static_cast<int64_t>(st.st_mtim.tv_sec) * NS + st.st_mtim.tv_nsec,
+                static_cast<int64_t>(st.st_ctim.tv_sec) * NS + st.st_ctim.tv_nsec};
     }
 
-    auto parse_result = VaultFormatV2::read_header(file_data);
-    if (!parse_result) {
+    std::optional<Entry> find(const Identity& id) {
+        std::lock_guard lock(m_mutex);
+        auto it = m_entries.find({id.device, id.inode});
+        if (it == m_entries.end() || !(it->second.identity == id)) {
+            return std::nullopt;
+        }
+        it->second.last_used = ++m_clock;
+        return it->second;
+    }
+
+    void store(const Identity& id, std::vector<uint8_t> header_bytes,
+               const VaultFileService::V2VaultMetadata& metadata) {
+        const int64_t now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        const bool racy = now_ns - std::max(id.mtime_ns, id.ctime_ns) < RACY_WINDOW_NS;
+
+        std::lock_guard lock(m_mutex);
+        if (m_entries.size() >= CAPACITY && !m_entries.contains({id.device, id.inode})) {
+            auto oldest = std::min_element(m_entries.begin(), m_entries.end(),
+                [](const auto& a, const auto& b) { return a.second.last_used < b.second.last_used; });
+            m_entries.erase(oldest);
+        }
+        m_entries[{id.device, id.inode}] = Entry{id, ++m_clock, racy, std::move(header_bytes), metadata};
+    }
+
+    void clear() {
+        std::lock_guard lock(m_mutex);
+        m_entries.clear();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::map<std::pair<dev_t, ino_t>, Entry> m_entries;
+    uint64_t m_clock = 0;
+};
+
+HeaderProbeCache& header_probe_cache() {
+    static HeaderProbeCache cache;
+    return cache;
+}
+
+bool pread_exact(int fd, std::span<uint8_t> out, off_t offset) {
+    size_t done = 0;
+    while (done < out.size()) {
+        const ssize_t n = pread(fd, out.data() + done, out.size() - done,
+                                offset + static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+#endif
+
+}  // namespace
+
+VaultResult<VaultFileService::V2VaultMetadata> VaultFileService::probe_v2_header(const std::string& path) {
+#ifndef _WIN32
+    const int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        return std::unexpected(errno == ENOENT ? VaultError::FileNotFound : VaultError::FileReadError);
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return std::unexpected(VaultError::FileReadError);
+    }
+
+    const auto identity = HeaderProbeCache::identity_of(st);
+    auto cached = header_probe_cache().find(identity);
+    if (cached && !cached->racy) {
+        close(fd);
+        return std::move(cached->metadata);
+    }
+
+    // Preamble first: it says how long the protected header is
+    std::vector<uint8_t> header_bytes(VaultFormatV2::PREAMBLE_SIZE);
+    if (static_cast<uint64_t>(st.st_size) < header_bytes.size() || !pread_exact(fd, header_bytes, 0)) {
+        close(fd);
+        return std::unexpected(VaultError::CorruptedFile);
+    }
+
+    auto extent = VaultFormatV2::header_extent(header_bytes);
+    if (!extent || *extent > static_cast<uint64_t>(st.st_size)) {
+        close(fd);
+        return std::unexpected(extent ? VaultError::CorruptedFile : extent.error());
+    }
+
+    header_bytes.resize(*extent);
+    const bool read_ok = pread_exact(fd, std::span<uint8_t>(header_bytes).subspan(VaultFormatV2::PREAMBLE_SIZE),
+                                     static_cast<off_t>(VaultFormatV2::PREAMBLE_SIZE));
+    close(fd);
+    if (!read_ok) {
+        return std::unexpected(VaultError::FileReadError);
+    }
+
+    // Racy entry with unchanged bytes: still skip FEC decode and parsing
+    if (cached && cached->header_bytes == header_bytes) {
+        header_probe_cache().store(identity, std::move(header_bytes), cached->metadata);
+        return std::move(cached->metadata);
+    }
+
+    auto metadata = read_v2_metadata(header_bytes);
+    if (!metadata) {
+        return std::unexpected(metadata.error());
+    }
+
+    Log::debug("VaultFileService: Probed V2 header ({} of {} bytes): {}", header_bytes.size(), st.st_size, path);
+    header_probe_cache().store(identity, std::move(header_bytes), *metadata);
+    return metadata;
+#else
+    auto file = map_vault_file(path);
+    if (!file) {
+        return std::unexpected(file.error());
+    }
+    return read_v2_metadata(file->bytes());
+#endif
+}
+
+void VaultFileService::clear_header_probe_cache() {
+#ifndef _WIN32
+    header_probe_cache().clear();
+#endif
+}
+
+bool VaultFileService::check_vault_requires_yubikey(
+    const std::string& path,
+    std::string& serial) {
+    auto metadata = probe_v2_header(path);
+    if (!metadata) {
         return false;
     }
 
-    const auto& [header, _data_offset] = *parse_result;
-    const auto& vault_header = header.vault_header;
+    const auto& vault_header = metadata->vault_header;
 
     if (vault_header.security_policy.require_yubikey) {
         return true;
@@ -356,8 +1012,9 @@ VaultResult<std::string> VaultFileService::create_backup(
 
 VaultResult<> VaultFileService::restore_from_backup(
     std::string_view vault_path,
-    std::string_view backup_dir) {
-    return VaultIO::restore_from_backup(vault_path, backup_dir);
+    std::string_view backup_dir,
+    const VaultIO::BackupValidator& accept) {
+    return VaultIO::restore_from_backup(vault_path, backup_dir, accept);
 }
 
 std::vector<std::string> VaultFileService::list_backups(
@@ -7,6 +7,9 @@
 
 #include "../VaultError.h"
 #include "../MultiUserTypes.h"
+#include "lib/storage/MappedVaultFile.h"
+#include "lib/storage/VaultIO.h"
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <array>
@@ -51,9 +54,11 @@ namespace KeepTower {
  *
  * **V2 Format:**
  * ```
- * [Full V2 Header with FEC: variable] [Encrypted Vault Data: variable]
+ * [Full V2 Header with FEC: variable] [Encrypted Vault Data: variable] [Journal frames: optional]
  * ```
  *
+ * Journal frames are appended by VaultJournalService via append_vault_file().
+ *
  * @section atomic_writes Atomic Write Operations
  *
  * All writes follow the pattern:
@@ -136,6 +141,52 @@ namespace KeepTower {
  */
 class VaultFileService {
 public:
+    /// On-disk version for a single AES-256-GCM payload
+    static constexpr uint32_t FORMAT_VERSION_SINGLE_PAYLOAD = 2;
+
+    /// On-disk version for a segmented AES-256-GCM payload (VaultCrypto::encrypt_stream)
+    static constexpr uint32_t FORMAT_VERSION_SEGMENTED_PAYLOAD = 3;
+
+    /**
+     * @brief How full vault writes are made durable
+     *
+     * Every policy makes the new file's data durable before it is renamed
+     * over the vault, so a power cut can never expose a torn vault; the
+     * policies differ in how the rename itself is made durable.
+     */
+    enum class SyncPolicy : uint8_t {
+        Strict,    ///< fsync() the file (data and metadata) and its directory on every write
+        DataOnly,  ///< fdatasync() the file, fsync() the directory on every write (default)
+        Batched    ///< fdatasync() the file; directory syncs are deferred to sync_deferred()
+    };
+
+    /**
+     * @brief Which file a path named when it was read
+     *
+     * A save replaces the vault with a new inode and a journal append moves
+     * its size and modification time, so an unchanged identity means the
+     * bytes read are still the bytes on disk.
+     */
+    struct FileIdentity {
+        uint64_t device = 0;   ///< st_dev
+        uint64_t inode = 0;    ///< st_ino
+        uint64_t size = 0;     ///< st_size
+        int64_t mtime_ns = 0;  ///< Modification time, nanoseconds since the epoch
+
+        bool operator==(const FileIdentity&) const = default;
+    };
+
+    /**
+     * @brief Save latency accumulated for one sync policy
+     */
+    struct WriteLatency {
+        uint64_t writes = 0;                       ///< Completed full writes
+        std::chrono::microseconds total{0};        ///< Sum of whole-write durations
+        std::chrono::microseconds sync_total{0};   ///< Part of total spent in fsync/fdatasync
+        std::chrono::microseconds max{0};          ///< Slowest write
+        std::chrono::microseconds last{0};         ///< Most recent write
+    };
+
     /**
      * @brief Manager-facing V2 header metadata extracted from file bytes.
      *
@@ -151,6 +202,24 @@ public:
         std::array<uint8_t, 32> data_salt{};  ///< Salt used for data encryption/decryption.
         std::array<uint8_t, 12> data_iv{};    ///< IV used for data encryption/decryption.
         size_t data_offset = 0;               ///< Byte offset where encrypted payload begins.
+        uint32_t format_version = FORMAT_VERSION_SINGLE_PAYLOAD;  ///< Payload encoding version.
+        bool compressed_payload = false;      ///< Decrypted payload must be decompressed before parsing.
+        uint8_t data_fec_parity_symbols = 0;  ///< Data-section parity per codeword (0 = ciphertext stored bare).
+        uint32_t data_fec_window_size = 0;    ///< Data-section FEC window size in bytes.
+    };
+
+    /**
+     * @brief Encrypted payload located (and if needed repaired) by open_v2_data_section()
+     *
+     * ciphertext points into the payload that was passed in when it was
+     * intact, or into repaired after windows had to be decoded.
+     */
+    struct V2DataSection {
+        std::span<const uint8_t> ciphertext;  ///< Ciphertext to decrypt
+        std::vector<uint8_t> repaired;        ///< Owns the ciphertext after a repair (empty otherwise)
+        size_t stored_size = 0;               ///< Payload bytes before any journal frames
+        size_t damaged_windows = 0;           ///< FEC windows that needed decoding
+        size_t repaired_bytes = 0;            ///< Ciphertext bytes corrected
     };
 
     // ========================================================================
@@ -169,12 +238,27 @@ public:
      *
         * @note V1 vault files are no longer supported and will return UnsupportedVersion.
      * @note data will contain complete file contents (including headers)
+     * @note Copies the mapping from map_vault_file(); the open path uses the
+     *       mapping directly
      */
     [[nodiscard]] static VaultResult<> read_vault_file(
         const std::string& path,
         std::vector<uint8_t>& data,
         int& pbkdf2_iterations);
 
+    /**
+     * @brief Map a vault file read-only and validate its format
+     *
+     * Zero-copy counterpart of read_vault_file(): the file is opened once
+     * (O_NOFOLLOW), validated with fstat() and mapped, and header parsing and
+     * payload decryption then work on spans of the mapping.
+     *
+     * @param path Absolute path to vault file
+     * @return Mapped file, or FileNotFound / FileReadError / InvalidData /
+     *         UnsupportedVersion
+     */
+    [[nodiscard]] static VaultResult<MappedVaultFile> map_vault_file(const std::string& path);
+
     // ========================================================================
     // File Writing Operations
     // ========================================================================
@@ -182,7 +266,11 @@ public:
     /**
      * @brief Write vault file atomically to disk
      *
-     * Performs an atomic write operation using temporary file + rename.
+     * The data is written to an anonymous O_TMPFILE in the vault's directory
+     * (or a uniquely named temporary file where O_TMPFILE is unsupported),
+     * preallocated with fallocate(), synced according to sync_policy(), then
+     * linked and renamed over @p path. A crash at any point leaves either the
+     * old or the new vault, never a partial one.
         * Writes a V2 vault file atomically. V1 vault files are not supported.
      *
      * @param path Absolute path to target vault file
@@ -191,8 +279,8 @@ public:
         * @param pbkdf2_iterations Reserved (ignored)
      * @return VaultResult<void> Success or VaultError
      *
-     * @note Automatically sets file permissions to 0600 (owner only)
-     * @note Uses fsync for durability guarantees
+     * @note Creates the file with permissions 0600 (owner only)
+     * @note Durability follows sync_policy(); latency is recorded per policy
      * @note Never leaves partial writes visible
      */
     [[nodiscard]] static VaultResult<> write_vault_file(
@@ -201,12 +289,85 @@ public:
         bool is_v2_vault,
         int pbkdf2_iterations = 0);
 
+    /**
+     * @brief Identity of an open file, as replace_vault_file_if_unchanged() compares it
+     * @param fd Descriptor of the file that is being read
+     * @return Identity, or nullopt if it cannot be determined
+     */
+    [[nodiscard]] static std::optional<FileIdentity> file_identity(int fd);
+
+    /**
+     * @brief Atomically replace a file only if it is still the one that was read
+     *
+     * Same write path as write_vault_file() (staging file, sync, rename), but
+     * the rename only happens while @p path still has identity @p expected.
+     * Renames and journal appends made through this service are serialised
+     * with that check, so a save or append in this process can never be
+     * overwritten by a stale image.
+     *
+     * @param path File to replace (a vault or one of its backup copies)
+     * @param parts Bytes of the new file, written back to back
+     * @param expected Identity the file had when its contents were read
+     * @return Success, Busy if the file changed in the meantime, or FileWriteError
+     */
+    [[nodiscard]] static VaultResult<> replace_vault_file_if_unchanged(
+        const std::string& path,
+        std::span<const std::span<const uint8_t>> parts,
+        const FileIdentity& expected);
+
+    /**
+     * @brief Select the durability policy for subsequent writes (process-wide)
+     * @param policy New policy; leaving Batched runs sync_deferred() first
+     */
+    static void set_sync_policy(SyncPolicy policy);
+
+    /** @brief Current durability policy
+     *  @return Policy used by write_vault_file() and write_v2_vault() */
+    [[nodiscard]] static SyncPolicy sync_policy();
+
+    /**
+     * @brief Parse a policy name as stored in settings
+     * @param name "strict", "data" or "batched"
+     * @return Policy, or nullopt for an unknown name
+     */
+    [[nodiscard]] static std::optional<SyncPolicy> parse_sync_policy(std::string_view name);
+
+    /**
+     * @brief Settings name of a policy
+     * @param policy Policy to name
+     * @return "strict", "data" or "batched"
+     */
+    [[nodiscard]] static const char* sync_policy_name(SyncPolicy policy);
+
+    /**
+     * @brief Make renames deferred by the Batched policy durable
+     *
+     * Called by the save coordinator at the end of a burst of saves
+     * (explicit save, flush, close), so a burst pays for one directory sync.
+     *
+     * @return Success, or FileWriteError if a directory could not be synced
+     */
+    static VaultResult<> sync_deferred();
+
+    /**
+     * @brief Latency of full writes made under a policy since the last reset
+     * @param policy Policy to report
+     * @return Accumulated latency
+     */
+    [[nodiscard]] static WriteLatency write_latency(SyncPolicy policy);
+
+    /** @brief Clear the latency counters of every policy */
+    static void reset_write_latency();
+
     /**
      * @brief Build and write a V2 vault file from encrypted components
      *
      * Assembles the V2 on-disk header, clears plaintext usernames before
-     * serialization, appends encrypted payload data, and persists the complete
-     * file atomically using the standard vault write semantics.
+     * serialization, and persists header and encrypted payload atomically
+     * using the standard vault write semantics. The two are gathered into a
+     * single writev() rather than concatenated, so the ciphertext is never
+     * copied. A nonzero @p data_fec_redundancy frames the ciphertext with
+     * windowed Reed-Solomon parity (see VaultFormatV2 data FEC).
      *
      * @param path Absolute path to target vault file
      * @param vault_header Vault header to serialize
@@ -216,6 +377,8 @@ public:
      * @param ciphertext Encrypted vault payload
      * @param enable_header_fec Whether to enable header FEC encoding
      * @param data_fec_redundancy User-selected data FEC redundancy percentage
+     * @param format_version On-disk version matching the payload encoding
+     * @param compressed_payload Whether the payload was compressed before encryption
      * @return VaultResult<void> Success or VaultError
      */
     [[nodiscard]] static VaultResult<> write_v2_vault(
@@ -224,9 +387,62 @@ public:
         uint32_t pbkdf2_iterations,
         std::span<const uint8_t> data_salt,
         std::span<const uint8_t> data_iv,
-        const std::vector<uint8_t>& ciphertext,
+        std::span<const uint8_t> ciphertext,
+        bool enable_header_fec = true,
+        uint8_t data_fec_redundancy = 0,
+        uint32_t format_version = FORMAT_VERSION_SINGLE_PAYLOAD,
+        bool compressed_payload = false);
+
+    /**
+     * @brief Build the serialized V2 on-disk header without writing it
+     *
+     * Produces exactly the header bytes write_v2_vault() would place in front
+     * of the ciphertext. Journaled saves use this to detect whether the header
+     * on disk is still current before appending instead of rewriting.
+     *
+     * @param vault_header Vault header to serialize
+     * @param pbkdf2_iterations PBKDF2 iteration count to store in the file header
+     * @param data_salt Stored data salt bytes (copied up to 32 bytes)
+     * @param data_iv Stored data IV bytes (must be exactly 12 bytes)
+     * @param enable_header_fec Whether to enable header FEC encoding
+     * @param data_fec_redundancy User-selected data FEC redundancy percentage
+     * @param format_version On-disk version matching the payload encoding
+     * @param compressed_payload Whether the payload was compressed before encryption
+     * @return Serialized header bytes or VaultError
+     */
+    [[nodiscard]] static VaultResult<std::vector<uint8_t>> build_v2_header(
+        const VaultHeaderV2& vault_header,
+        uint32_t pbkdf2_iterations,
+        std::span<const uint8_t> data_salt,
+        std::span<const uint8_t> data_iv,
         bool enable_header_fec = true,
-        uint8_t data_fec_redundancy = 0);
+        uint8_t data_fec_redundancy = 0,
+        uint32_t format_version = FORMAT_VERSION_SINGLE_PAYLOAD,
+        bool compressed_payload = false);
+
+    /**
+     * @brief Durably append bytes to the end of an existing vault file
+     *
+     * Used by the mutation journal to add sealed delta records after the main
+     * payload. The append only proceeds when the file still has exactly
+     * @p expected_size bytes and starts with @p expected_prefix, so a file
+     * replaced or extended behind our back is never appended to. A failed
+     * write is truncated back to @p expected_size.
+     *
+     * @param path Absolute path to existing vault file
+     * @param data Bytes to append
+     * @param expected_size Current size the file must have before appending
+     * @param expected_prefix Bytes the file must start with (typically the header)
+     * @return VaultResult<void> Success or VaultError
+     *
+     * @note Data is fdatasync'ed before returning; no rename is involved
+     * @note Returns FileWriteError on platforms without POSIX file descriptors
+     */
+    [[nodiscard]] static VaultResult<> append_vault_file(
+        const std::string& path,
+        std::span<const uint8_t> data,
+        uint64_t expected_size,
+        std::span<const uint8_t> expected_prefix = {});
 
     /**
      * @brief Parse V2 vault metadata from already-loaded file bytes
@@ -238,7 +454,32 @@ public:
      * @return V2VaultMetadata on success, VaultError on parse failure
      */
     [[nodiscard]] static VaultResult<V2VaultMetadata> read_v2_metadata(
-        const std::vector<uint8_t>& file_data);
+        std::span<const uint8_t> file_data);
+
+    /**
+     * @brief Locate the ciphertext in a V2 payload, repairing it if needed
+     *
+     * Without data FEC the whole payload is returned as stored (journal
+     * frames included; the caller splits them off). With data FEC the
+     * windowed checksums are verified and damaged windows decoded before the
+     * ciphertext reaches GCM, which would otherwise reject a single flipped
+     * bit.
+     *
+     * @param metadata Metadata of the same file (see read_v2_metadata())
+     * @param payload File bytes from metadata.data_offset on
+     * @return Located ciphertext, or CorruptedFile / FECDecodingFailed
+     */
+    [[nodiscard]] static VaultResult<V2DataSection> open_v2_data_section(
+        const V2VaultMetadata& metadata,
+        std::span<const uint8_t> payload);
+
+    /**
+     * @brief Payload bytes write_v2_vault() stores for a ciphertext
+     * @param data_fec_redundancy User-selected data FEC redundancy percentage
+     * @param ciphertext_size Encrypted payload size
+     * @return Ciphertext plus data FEC framing, if any
+     */
+    [[nodiscard]] static size_t v2_payload_size(uint8_t data_fec_redundancy, size_t ciphertext_size);
 
     // ========================================================================
     // Format Detection
@@ -255,9 +496,12 @@ public:
      *
      * @note Returns nullopt for corrupted or non-vault files
      * @note Does not validate file integrity, only format identification
+     * @note Version 3 files (V2 header, segmented payload) report 2: they use
+     *       the same multi-user open flow. The exact version is available in
+     *       V2VaultMetadata::format_version.
      */
     [[nodiscard]] static std::optional<uint32_t> detect_vault_version(
-        const std::vector<uint8_t>& data);
+        std::span<const uint8_t> data);
 
     /**
      * @brief Detect vault format version from file path
@@ -272,11 +516,34 @@ public:
     [[nodiscard]] static std::optional<uint32_t> detect_vault_version_from_file(
         const std::string& path);
 
+    /**
+     * @brief Read V2 header metadata without reading the vault payload
+     *
+     * Reads the fixed preamble, then exactly the protected header plus the
+     * data salt/IV, and FEC-decodes only that. Results are cached per file
+     * identity (device, inode, size, mtime, ctime), so repeated probes by the
+     * recent-vault and login flows skip the read and the FEC decode
+     * entirely. Timestamps are coarse and inode numbers get reused, so an
+     * entry cached within two seconds of the file's last change is trusted
+     * only after its raw header bytes compare equal again.
+     *
+     * @param path Absolute path to vault file (symlinks are rejected)
+     * @return Parsed metadata (data_offset is the payload start), or VaultError
+     *
+     * @note Thread-safe; the cache holds at most a few recent files
+     */
+    [[nodiscard]] static VaultResult<V2VaultMetadata> probe_v2_header(const std::string& path);
+
+    /**
+     * @brief Drop all cached header probes
+     */
+    static void clear_header_probe_cache();
+
     /**
      * @brief Check whether a vault requires YubiKey authentication.
      *
-     * Reads and parses the V2 vault header to determine whether YubiKey is
-     * required by policy or by any active enrolled user slot.
+     * Probes the V2 vault header (see probe_v2_header()) to determine whether
+     * YubiKey is required by policy or by any active enrolled user slot.
      *
      * @param path Absolute path to vault file
      * @param serial Output parameter for an enrolled YubiKey serial, if present
@@ -315,13 +582,16 @@ public:
      *
      * @param vault_path Absolute path to vault file to restore
      * @param backup_dir Optional custom backup directory (empty = same as vault)
+     * @param accept Optional content check; backups it rejects are skipped
+     *        (see VaultVerificationService::is_restorable())
      * @return VaultResult<> Success or error
      *
         * @note Fails if no backups exist
      */
     [[nodiscard]] static VaultResult<> restore_from_backup(
         std::string_view vault_path,
-        std::string_view backup_dir = "");
+        std::string_view backup_dir = "",
+        const VaultIO::BackupValidator& accept = {});
 
     /**
      * @brief List all backup files for a vault
@@ -0,0 +1,518 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "VaultJournalService.h"
+#include "VaultFileService.h"
+#include "lib/crypto/AesGcmContext.h"
+#include "lib/crypto/VaultCrypto.h"
+#include "../../utils/Log.h"
+
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <unordered_set>
+
+namespace KeepTower {
+
+namespace {
+
+constexpr size_t IV_SIZE = VaultCrypto::IV_LENGTH;
+constexpr size_t MAGIC_SIZE = VaultJournalService::FRAME_MAGIC.size();
+
+bool magic_at(std::span<const uint8_t> data, size_t pos) {
+    return data.size() - pos >= MAGIC_SIZE &&
+           std::memcmp(data.data() + pos, VaultJournalService::FRAME_MAGIC.data(), MAGIC_SIZE) == 0;
+}
+
+size_t find_first_magic(std::span<const uint8_t> data) {
+    const auto first = VaultJournalService::FRAME_MAGIC[0];
+    size_t pos = 0;
+    while (data.size() - pos >= MAGIC_SIZE) {
+        const void* hit = std::memchr(data.data() + pos, first, data.size() - pos - MAGIC_SIZE + 1);
+        if (!hit) {
+            break;
+        }
+        pos = static_cast<size_t>(static_cast<const uint8_t*>(hit) - data.data());
+        if (magic_at(data, pos)) {
+            return pos;
+        }
+        ++pos;
+    }
+    return data.size();
+}
+
+uint32_t read_u32_le(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) |
+           (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void append_u32_le(std::vector<uint8_t>& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+bool sha256(const std::string& bytes, std::array<uint8_t, 32>& digest) {
+    unsigned int len = 0;
+    return EVP_Digest(bytes.data(), bytes.size(), digest.data(), &len, EVP_sha256(), nullptr) == 1 &&
+           len == digest.size();
+}
+
+/**
+ * Temporarily moves the accounts out of a VaultData so the remaining
+ * (small) fields can be copied or serialized without touching every record.
+ */
+class AccountsDetached {
+public:
+    explicit AccountsDetached(keeptower::VaultData& data) : m_data(data) {
+        m_accounts.Swap(m_data.mutable_accounts());
+    }
+    ~AccountsDetached() {
+        m_data.mutable_accounts()->Swap(&m_accounts);
+    }
+    AccountsDetached(const AccountsDetached&) = delete;
+    AccountsDetached& operator=(const AccountsDetached&) = delete;
+
+private:
+    keeptower::VaultData& m_data;
+    google::protobuf::RepeatedPtrField<keeptower::AccountRecord> m_accounts;
+};
+
+}  // namespace
+
+VaultJournalService::PayloadLayout VaultJournalService::split_payload(
+    std::span<const uint8_t> payload) {
+    return split_payload(payload, find_first_magic(payload));
+}
+
+VaultJournalService::PayloadLayout VaultJournalService::split_payload(
+    std::span<const uint8_t> payload,
+    size_t base_size) {
+    PayloadLayout layout;
+    layout.base_size = std::min(base_size, payload.size());
+
+    size_t pos = layout.base_size;
+    while (payload.size() - pos >= FRAME_OVERHEAD && magic_at(payload, pos)) {
+        const uint32_t sealed_len = read_u32_le(payload.data() + pos + MAGIC_SIZE);
+        if (sealed_len < VaultCrypto::TAG_LENGTH ||
+            sealed_len > payload.size() - pos - FRAME_OVERHEAD) {
+            break;  // Torn or damaged frame: ignore it and everything after
+        }
+        const size_t frame_size = FRAME_OVERHEAD + sealed_len;
+        layout.frames.push_back(payload.subspan(pos, frame_size));
+        pos += frame_size;
+    }
+    layout.valid_size = pos;
+
+    return layout;
+}
+
+size_t VaultJournalService::replay(
+    std::span<const std::span<const uint8_t>> frames,
+    std::span<const uint8_t> dek,
+    std::span<const uint8_t> base_iv,
+    keeptower::VaultData& vault_data) {
+    size_t applied = 0;
+
+    // One key schedule and one plaintext buffer serve every record
+    AesGcmContext cipher(dek);
+    std::vector<uint8_t> plaintext;
+
+    for (const auto& frame : frames) {
+        const auto iv = frame.subspan(MAGIC_SIZE + sizeof(uint32_t), IV_SIZE);
+        const auto sealed = frame.subspan(FRAME_OVERHEAD);
+        const auto body = sealed.first(sealed.size() - VaultCrypto::TAG_LENGTH);
+
+        plaintext.assign(body.begin(), body.end());
+        if (!cipher.open(iv, plaintext, sealed.last(VaultCrypto::TAG_LENGTH))) {
+            Log::warning("VaultJournalService: Journal record {} failed authentication", applied + 1);
+            break;
+        }
+
+        keeptower::VaultJournalRecord record;
+        const bool parsed = record.ParseFromArray(plaintext.data(), static_cast<int>(plaintext.size()));
+        OPENSSL_cleanse(plaintext.data(), plaintext.size());
+        if (!parsed) {
+            Log::warning("VaultJournalService: Journal record {} is malformed", applied + 1);
+            break;
+        }
+
+        const auto& record_iv = record.base_iv();
+        if (record.sequence() != applied + 1 ||
+            record_iv.size() != base_iv.size() ||
+            !std::equal(base_iv.begin(), base_iv.end(), record_iv.begin(),
+                        [](uint8_t a, char b) { return a == static_cast<uint8_t>(b); })) {
+            Log::warning("VaultJournalService: Journal record {} does not belong to this base image",
+                         applied + 1);
+            break;
+        }
+
+        apply_record(record, vault_data);
+        ++applied;
+    }
+
+    if (applied > 0) {
+        Log::debug("VaultJournalService: Replayed {} journal record(s)", applied);
+    }
+    return applied;
+}
+
+void VaultJournalService::apply_record(
+    const keeptower::VaultJournalRecord& record,
+    keeptower::VaultData& vault_data) {
+    if (record.has_vault_fields()) {
+        AccountsDetached detached(vault_data);
+        vault_data.CopyFrom(record.vault_fields());
+    }
+    if (record.last_modified() != 0) {
+        vault_data.mutable_metadata()->set_last_modified(record.last_modified());
+    }
+
+    auto* accounts = vault_data.mutable_accounts();
+
+    if (record.deleted_account_ids_size() > 0) {
+        const std::unordered_set<std::string> deleted(
+            record.deleted_account_ids().begin(), record.deleted_account_ids().end());
+        int kept = 0;
+        for (int i = 0; i < accounts->size(); ++i) {
+            if (deleted.contains(accounts->Get(i).id())) {
+                continue;
+            }
+            if (kept != i) {
+                accounts->SwapElements(kept, i);
+            }
+            ++kept;
+        }
+        accounts->DeleteSubrange(kept, accounts->size() - kept);
+    }
+
+    std::unordered_map<std::string, int> positions;
+    positions.reserve(static_cast<size_t>(accounts->size()));
+    for (int i = 0; i < accounts->size(); ++i) {
+        positions.emplace(accounts->Get(i).id(), i);
+    }
+
+    for (const auto& upserted : record.upserted_accounts()) {
+        if (auto it = positions.find(upserted.id()); it != positions.end()) {
+            accounts->Mutable(it->second)->CopyFrom(upserted);
+        } else {
+            positions.emplace(upserted.id(), accounts->size());
+            accounts->Add()->CopyFrom(upserted);
+        }
+    }
+
+    // Move each account to its recorded position, tracking where swaps send
+    // the displaced element. Ids missing from the order keep trailing slots.
+    int target = 0;
+    for (const auto& id : record.account_order()) {
+        auto it = positions.find(id);
+        if (it == positions.end() || it->second < target) {
+            continue;
+        }
+        const int from = it->second;
+        if (from != target) {
+            positions[accounts->Get(target).id()] = from;
+            accounts->SwapElements(target, from);
+            it->second = target;
+        }
+        ++target;
+    }
+}
+
+void VaultJournalService::reset(
+    std::vector<uint8_t> header_bytes,
+    std::span<const uint8_t> base_iv,
+    uint64_t base_size,
+    uint64_t file_size,
+    size_t record_count,
+    keeptower::VaultData& vault_data,
+    Generation generation) {
+    invalidate();
+    forget_changes_through(generation);
+
+    if (!index_accounts(vault_data, m_account_order, m_account_positions)) {
+        Log::debug("VaultJournalService: Account ids not unique, journaling disabled for this image");
+        invalidate();
+        return;
+    }
+    if (!digest_fields(vault_data, m_fields_digest)) {
+        invalidate();
+        return;
+    }
+
+    m_header_bytes = std::move(header_bytes);
+    m_base_iv.assign(base_iv.begin(), base_iv.end());
+    m_base_size = base_size;
+    m_file_size = file_size;
+    m_record_count = record_count;
+    m_last_modified = vault_data.metadata().last_modified();
+    m_active = true;
+}
+
+void VaultJournalService::clear() noexcept {
+    invalidate();
+    std::lock_guard lock(m_changes_mutex);
+    m_changed_accounts.clear();
+    m_generation = 1;
+    m_replaced_generation = 0;
+}
+
+void VaultJournalService::invalidate() noexcept {
+    m_active = false;
+    m_header_bytes.clear();
+    m_base_iv.clear();
+    m_base_size = 0;
+    m_file_size = 0;
+    m_record_count = 0;
+    m_account_order.clear();
+    m_account_positions.clear();
+    m_fields_digest = {};
+    m_last_modified = 0;
+}
+
+void VaultJournalService::note_account_changed(std::string_view account_id) {
+    std::lock_guard lock(m_changes_mutex);
+    if (auto it = m_changed_accounts.find(std::string{account_id}); it != m_changed_accounts.end()) {
+        it->second = m_generation;
+    } else {
+        m_changed_accounts.emplace(account_id, m_generation);
+    }
+}
+
+void VaultJournalService::note_accounts_replaced() {
+    std::lock_guard lock(m_changes_mutex);
+    m_replaced_generation = m_generation;
+}
+
+VaultJournalService::Generation VaultJournalService::close_generation() {
+    std::lock_guard lock(m_changes_mutex);
+    return m_generation++;
+}
+
+bool VaultJournalService::can_append(std::span<const uint8_t> header_bytes, Generation generation) const {
+    if (!m_active) {
+        return false;
+    }
+    if (m_max_records > 0 && m_record_count >= m_max_records) {
+        return false;
+    }
+    if (m_max_journal_percent > 0 &&
+        journal_size() * 100 > m_base_size * m_max_journal_percent) {
+        return false;
+    }
+    {
+        std::lock_guard lock(m_changes_mutex);
+        if (m_replaced_generation != 0 && m_replaced_generation <= generation) {
+            return false;
+        }
+    }
+    return std::ranges::equal(header_bytes, m_header_bytes);
+}
+
+VaultResult<> VaultJournalService::append(
+    const std::string& path,
+    keeptower::VaultData& vault_data,
+    std::span<const uint8_t> dek,
+    Generation generation) {
+    if (!m_active) {
+        return std::unexpected(VaultError::VaultNotOpen);
+    }
+
+    const std::vector<std::string> changed = changes_through(generation);
+    const auto& accounts = vault_data.accounts();
+
+    keeptower::VaultJournalRecord record;
+    record.set_sequence(m_record_count + 1);
+    record.set_base_iv(m_base_iv.data(), m_base_iv.size());
+
+    // Usually every changed account still sits where the persisted state
+    // has it, and only those records are looked at
+    bool in_place = static_cast<size_t>(accounts.size()) == m_account_order.size();
+    std::vector<int> upserted;
+    upserted.reserve(changed.size());
+    for (const auto& id : changed) {
+        const auto it = m_account_positions.find(id);
+        if (!in_place || it == m_account_positions.end() ||
+            accounts.Get(static_cast<int>(it->second)).id() != id) {
+            in_place = false;
+            break;
+        }
+        upserted.push_back(static_cast<int>(it->second));
+    }
+
+    // Otherwise accounts were added, removed or re-keyed: compare the id lists
+    std::vector<std::string> order;
+    std::unordered_map<std::string, size_t> positions;
+    if (!in_place) {
+        upserted.clear();
+        if (!index_accounts(vault_data, order, positions)) {
+            return std::unexpected(VaultError::InvalidData);
+        }
+
+        // Order replay will produce: survivors in old order, then new ids appended
+        std::vector<std::string> replayed_order;
+        replayed_order.reserve(order.size());
+        for (const auto& id : m_account_order) {
+            if (positions.contains(id)) {
+                replayed_order.push_back(id);
+            } else {
+                record.add_deleted_account_ids(id);
+            }
+        }
+        for (const auto& id : changed) {
+            const auto it = positions.find(id);
+            if (it == positions.end()) {
+                if (!m_account_positions.contains(id)) {
+                    // Noted before the tracked image was taken; may still be on disk
+                    record.add_deleted_account_ids(id);
+                }
+            } else if (m_account_positions.contains(id)) {
+                upserted.push_back(static_cast<int>(it->second));
+            }
+        }
+        for (size_t i = 0; i < order.size(); ++i) {
+            if (!m_account_positions.contains(order[i])) {
+                replayed_order.push_back(order[i]);
+                upserted.push_back(static_cast<int>(i));
+            }
+        }
+
+        if (replayed_order != order) {
+            for (const auto& id : order) {
+                record.add_account_order(id);
+            }
+        }
+    }
+    for (const int position : upserted) {
+        *record.add_upserted_accounts() = accounts.Get(position);
+    }
+
+    Digest fields_digest{};
+    if (!digest_fields(vault_data, fields_digest)) {
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+    if (fields_digest != m_fields_digest) {
+        AccountsDetached detached(vault_data);
+        record.mutable_vault_fields()->CopyFrom(vault_data);
+    }
+
+    if (record.upserted_accounts_size() == 0 && record.deleted_account_ids_size() == 0 &&
+        record.account_order_size() == 0 && !record.has_vault_fields()) {
+        // A save without changes does not need a record for its timestamp
+        forget_changes_through(generation);
+        return {};
+    }
+    const int64_t last_modified = vault_data.metadata().last_modified();
+    if (last_modified != m_last_modified) {
+        record.set_last_modified(last_modified);
+    }
+
+    // The record is serialized into the frame and sealed where it lies
+    const size_t plaintext_size = record.ByteSizeLong();
+    if (plaintext_size > static_cast<size_t>(std::numeric_limits<int>::max()) - VaultCrypto::TAG_LENGTH) {
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+    const size_t sealed_size = plaintext_size + VaultCrypto::TAG_LENGTH;
+    const auto iv = VaultCrypto::generate_random_bytes(IV_SIZE);
+
+    std::vector<uint8_t> frame;
+    frame.reserve(FRAME_OVERHEAD + sealed_size);
+    frame.insert(frame.end(), FRAME_MAGIC.begin(), FRAME_MAGIC.end());
+    append_u32_le(frame, static_cast<uint32_t>(sealed_size));
+    frame.insert(frame.end(), iv.begin(), iv.end());
+    frame.resize(FRAME_OVERHEAD + sealed_size);
+
+    const auto body = std::span<uint8_t>(frame).subspan(FRAME_OVERHEAD, plaintext_size);
+    if (!record.SerializeToArray(body.data(), static_cast<int>(body.size()))) {
+        OPENSSL_cleanse(body.data(), body.size());
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+    record.Clear();
+
+    if (!VaultCrypto::seal(body, dek, iv, std::span<uint8_t>(frame).last(VaultCrypto::TAG_LENGTH))) {
+        OPENSSL_cleanse(body.data(), body.size());
+        return std::unexpected(VaultError::EncryptionFailed);
+    }
+
+    auto append_result = VaultFileService::append_vault_file(path, frame, m_file_size, m_header_bytes);
+    if (!append_result) {
+        return std::unexpected(append_result.error());
+    }
+
+    m_file_size += frame.size();
+    ++m_record_count;
+    if (!in_place) {
+        m_account_order = std::move(order);
+        m_account_positions = std::move(positions);
+    }
+    m_fields_digest = fields_digest;
+    m_last_modified = last_modified;
+    forget_changes_through(generation);
+
+    Log::debug("VaultJournalService: Appended journal record {} ({} bytes)", m_record_count, frame.size());
+    return {};
+}
+
+bool VaultJournalService::index_accounts(
+    const keeptower::VaultData& vault_data,
+    std::vector<std::string>& account_order,
+    std::unordered_map<std::string, size_t>& positions) {
+    account_order.clear();
+    positions.clear();
+    account_order.reserve(static_cast<size_t>(vault_data.accounts_size()));
+    positions.reserve(static_cast<size_t>(vault_data.accounts_size()));
+
+    for (const auto& account : vault_data.accounts()) {
+        if (account.id().empty() || !positions.emplace(account.id(), account_order.size()).second) {
+            return false;
+        }
+        account_order.push_back(account.id());
+    }
+    return true;
+}
+
+bool VaultJournalService::digest_fields(keeptower::VaultData& vault_data, Digest& fields_digest) {
+    AccountsDetached detached(vault_data);
+
+    // Every save stamps last_modified; it is recorded separately
+    int64_t last_modified = 0;
+    if (vault_data.has_metadata()) {
+        last_modified = vault_data.metadata().last_modified();
+        vault_data.mutable_metadata()->set_last_modified(0);
+    }
+
+    std::string bytes;
+    const bool digested = vault_data.SerializeToString(&bytes) && sha256(bytes, fields_digest);
+    OPENSSL_cleanse(bytes.data(), bytes.size());
+
+    if (vault_data.has_metadata()) {
+        vault_data.mutable_metadata()->set_last_modified(last_modified);
+    }
+    return digested;
+}
+
+std::vector<std::string> VaultJournalService::changes_through(Generation generation) const {
+    std::vector<std::string> changed;
+    std::lock_guard lock(m_changes_mutex);
+    for (const auto& [id, noted] : m_changed_accounts) {
+        if (noted <= generation) {
+            changed.push_back(id);
+        }
+    }
+    return changed;
+}
+
+void VaultJournalService::forget_changes_through(Generation generation) {
+    std::lock_guard lock(m_changes_mutex);
+    std::erase_if(m_changed_accounts, [generation](const auto& entry) { return entry.second <= generation; });
+    if (m_replaced_generation != 0 && m_replaced_generation <= generation) {
+        m_replaced_generation = 0;
+    }
+}
+
+}  // namespace KeepTower
@@ -0,0 +1,296 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#ifndef KEEPTOWER_VAULT_JOURNAL_SERVICE_H
+#define KEEPTOWER_VAULT_JOURNAL_SERVICE_H
+
+#include "../VaultError.h"
+#include "../record.pb.h"
+#include <array>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace KeepTower {
+
+/**
+ * @brief Append-only encrypted mutation journal for V2 vault files.
+ *
+ * In journaled save mode a save does not rewrite the whole vault. Instead the
+ * difference between the in-memory VaultData and the last persisted state is
+ * encoded as a keeptower::VaultJournalRecord, sealed with the vault DEK under
+ * a fresh IV, and appended after the main encrypted payload. Opening a vault
+ * decrypts the base image and replays the records in order. Once the journal
+ * grows past a record-count or size threshold (or the header changes), the
+ * next save compacts everything back into a fresh base image.
+ *
+ * **Responsibilities:**
+ * - Locating journal frames behind the base ciphertext
+ * - Sealing and appending delta records for the current vault state
+ * - Authenticating and replaying records on open
+ * - Deciding when a full rewrite (compaction) is required
+ *
+ * **NOT Responsible For:**
+ * - Writing full vault images (VaultFileService)
+ * - Header construction or FEC (VaultFormatV2)
+ * - Deciding whether journaling is enabled (VaultManager)
+ *
+ * @section vault_journal_layout On-Disk Layout
+ * ```
+ * [V2 header][base ciphertext][frame 1][frame 2]...[frame N]
+ *
+ * frame := [magic: "KTJRNL01"][len: u32 LE][iv: 12][sealed record + GCM tag: len]
+ * ```
+ * The base ciphertext ends where the first frame magic appears, so it needs
+ * no length field and the header never has to be rewritten. A torn append
+ * leaves an incomplete last frame; it is ignored on open and discarded by the
+ * next compaction. Should random ciphertext ever contain the magic, open
+ * falls back to treating the whole payload as the base image.
+ *
+ * @section vault_journal_integrity Integrity
+ * Every record carries its sequence number and the IV of the base payload it
+ * applies to inside the authenticated plaintext, so records cannot be
+ * reordered, dropped from the middle, or spliced onto a different base image
+ * without replay rejecting them.
+ *
+ * @section vault_journal_changes Change Tracking
+ * The service does not diff the accounts itself. VaultManager notes the id
+ * of every account its managers add, edit or remove (note_account_changed())
+ * and closes a generation of notes whenever it takes a snapshot to write
+ * (close_generation()). A record carries exactly the noted accounts of its
+ * generation; the id lists are compared only when accounts were added,
+ * removed or re-keyed. Notes stay until a write covering them succeeds, so
+ * a snapshot that is superseded or fails leaves them for the next write.
+ * Changes that cannot be attributed to accounts (note_accounts_replaced())
+ * force a compacting rewrite.
+ *
+ * Groups and metadata are small and compared by digest; the save timestamp
+ * is left out of it and travels as a separate field, so saving without other
+ * changes writes nothing.
+ *
+ * Vaults with missing or duplicate account ids always use full rewrites.
+ */
+class VaultJournalService {
+public:
+    /// Magic opening every journal frame
+    static constexpr std::array<uint8_t, 8> FRAME_MAGIC = {'K', 'T', 'J', 'R', 'N', 'L', '0', '1'};
+
+    /// Bytes of framing in front of each sealed record (magic + length + IV)
+    static constexpr size_t FRAME_OVERHEAD = FRAME_MAGIC.size() + sizeof(uint32_t) + 12;
+
+    /// Compact after this many records by default
+    static constexpr size_t DEFAULT_MAX_RECORDS = 64;
+
+    /// Compact when the journal exceeds this percentage of the base payload
+    static constexpr size_t DEFAULT_MAX_JOURNAL_PERCENT = 25;
+
+    /// Batch of noted changes, see close_generation()
+    using Generation = uint64_t;
+
+    /**
+     * @brief Split of the bytes following the V2 header.
+     */
+    struct PayloadLayout {
+        size_t base_size = 0;                           ///< Length of the base ciphertext
+        size_t valid_size = 0;                          ///< Length up to the end of the last intact frame
+        std::vector<std::span<const uint8_t>> frames;   ///< Journal frames, oldest first
+    };
+
+    /**
+     * @brief Locate journal frames behind the base ciphertext.
+     * @param payload Bytes following the V2 header (base ciphertext plus journal)
+     * @return Layout describing base and frame boundaries
+     */
+    [[nodiscard]] static PayloadLayout split_payload(std::span<const uint8_t> payload);
+
+    /**
+     * @brief Locate journal frames behind a base ciphertext of known length.
+     *
+     * Used for segmented payloads, whose length is recorded in their stream
+     * header, so no magic scan is needed.
+     *
+     * @param payload Bytes following the V2 header
+     * @param base_size Length of the base ciphertext
+     * @return Layout describing base and frame boundaries
+     */
+    [[nodiscard]] static PayloadLayout split_payload(std::span<const uint8_t> payload, size_t base_size);
+
+    /**
+     * @brief Authenticate and apply journal frames to a decrypted base image.
+     *
+     * Replay stops at the first frame that fails authentication or carries an
+     * unexpected sequence number or base IV; earlier frames remain applied.
+     *
+     * @param frames Journal frames from split_payload(), oldest first
+     * @param dek Vault data encryption key
+     * @param base_iv IV of the base payload the frames must be bound to
+     * @param vault_data Decrypted base image, updated in place
+     * @return Number of frames applied
+     */
+    [[nodiscard]] static size_t replay(
+        std::span<const std::span<const uint8_t>> frames,
+        std::span<const uint8_t> dek,
+        std::span<const uint8_t> base_iv,
+        keeptower::VaultData& vault_data);
+
+    /**
+     * @brief Apply a single decoded journal record to vault data.
+     * @param record Decoded delta record
+     * @param vault_data Vault data updated in place
+     */
+    static void apply_record(
+        const keeptower::VaultJournalRecord& record,
+        keeptower::VaultData& vault_data);
+
+    /**
+     * @brief Start tracking a freshly written or opened base image.
+     *
+     * @param header_bytes Serialized V2 header currently on disk
+     * @param base_iv IV of the base payload on disk
+     * @param base_size Length of the base ciphertext
+     * @param file_size Total size of the file, including intact frames
+     * @param record_count Number of journal records already on disk
+     * @param vault_data Vault state that the file currently represents
+     * @param generation Last generation of notes @p vault_data includes
+     *        (0 when it is the state just opened)
+     */
+    void reset(
+        std::vector<uint8_t> header_bytes,
+        std::span<const uint8_t> base_iv,
+        uint64_t base_size,
+        uint64_t file_size,
+        size_t record_count,
+        keeptower::VaultData& vault_data,
+        Generation generation = 0);
+
+    /**
+     * @brief Forget all tracked state and notes (vault opened or closed).
+     */
+    void clear() noexcept;
+
+    /**
+     * @brief Stop appending until the next reset(), keeping noted changes.
+     *
+     * Used when a write fails: the file no longer matches the tracked image,
+     * but notes made after the failed snapshot still describe changes the
+     * next base image must be diffed against.
+     */
+    void invalidate() noexcept;
+
+    /**
+     * @brief Record that an account was added, edited or removed.
+     * @param account_id Account id (before the change, if it re-keyed the account)
+     * @note Thread-safe; called on the thread that mutates the vault data.
+     */
+    void note_account_changed(std::string_view account_id);
+
+    /**
+     * @brief Record that the account list was replaced wholesale.
+     *
+     * Writes of this generation or later compact instead of appending.
+     * @note Thread-safe.
+     */
+    void note_accounts_replaced();
+
+    /**
+     * @brief Close the generation of notes made so far.
+     *
+     * Called when taking the snapshot a write will persist; the snapshot
+     * includes every change noted up to the returned generation.
+     * @return Generation to pass to can_append(), append() and reset()
+     * @note Thread-safe.
+     */
+    [[nodiscard]] Generation close_generation();
+
+    /**
+     * @brief Check whether the next save may append instead of rewriting.
+     * @param header_bytes Header the next full write would produce with the tracked base IV
+     * @param generation Generation of the snapshot to save
+     * @return true when the on-disk header matches, no compaction threshold is
+     *         reached and the accounts were not replaced
+     */
+    [[nodiscard]] bool can_append(std::span<const uint8_t> header_bytes, Generation generation) const;
+
+    /**
+     * @brief Append a delta record describing changes since the last persisted state.
+     *
+     * @param path Vault file to append to
+     * @param vault_data Snapshot of the vault state
+     * @param dek Vault data encryption key
+     * @param generation Generation of notes @p vault_data includes
+     * @return Success (also when there was nothing to write) or VaultError.
+     *         On error the caller must fall back to a full rewrite.
+     */
+    [[nodiscard]] VaultResult<> append(
+        const std::string& path,
+        keeptower::VaultData& vault_data,
+        std::span<const uint8_t> dek,
+        Generation generation);
+
+    /**
+     * @brief Set compaction thresholds.
+     * @param max_records Compact after this many records (0 = never by count)
+     * @param max_journal_percent Compact when journal exceeds this percent of the base
+     */
+    void set_compaction_thresholds(size_t max_records, size_t max_journal_percent) noexcept {
+        m_max_records = max_records;
+        m_max_journal_percent = max_journal_percent;
+    }
+
+    /** @brief Whether a base image is currently tracked
+     *  @return true after reset() until clear() */
+    [[nodiscard]] bool is_active() const noexcept { return m_active; }
+
+    /** @brief IV of the tracked base payload
+     *  @return Base IV bytes (empty when inactive) */
+    [[nodiscard]] std::span<const uint8_t> base_iv() const noexcept { return m_base_iv; }
+
+    /** @brief Number of journal records behind the base image
+     *  @return Record count */
+    [[nodiscard]] size_t record_count() const noexcept { return m_record_count; }
+
+    /** @brief Bytes of journal frames behind the base image
+     *  @return Journal size in bytes */
+    [[nodiscard]] uint64_t journal_size() const noexcept {
+        return m_file_size - m_header_bytes.size() - m_base_size;
+    }
+
+private:
+    using Digest = std::array<uint8_t, 32>;
+
+    [[nodiscard]] static bool index_accounts(const keeptower::VaultData& vault_data,
+                                             std::vector<std::string>& account_order,
+                                             std::unordered_map<std::string, size_t>& positions);
+    [[nodiscard]] static bool digest_fields(keeptower::VaultData& vault_data, Digest& fields_digest);
+    [[nodiscard]] std::vector<std::string> changes_through(Generation generation) const;
+    void forget_changes_through(Generation generation);
+
+    bool m_active = false;
+    std::vector<uint8_t> m_header_bytes;
+    std::vector<uint8_t> m_base_iv;
+    uint64_t m_base_size = 0;
+    uint64_t m_file_size = 0;
+    size_t m_record_count = 0;
+    size_t m_max_records = DEFAULT_MAX_RECORDS;
+    size_t m_max_journal_percent = DEFAULT_MAX_JOURNAL_PERCENT;
+
+    // Persisted state the next delta is computed against
+    std::vector<std::string> m_account_order;
+    std::unordered_map<std::string, size_t> m_account_positions;
+    Digest m_fields_digest{};
+    int64_t m_last_modified = 0;
+
+    // Changes not yet persisted, noted on the mutating thread
+    mutable std::mutex m_changes_mutex;
+    std::unordered_map<std::string, Generation> m_changed_accounts;  ///< Id -> generation of its last note
+    Generation m_generation = 1;           ///< Generation new notes belong to
+    Generation m_replaced_generation = 0;  ///< Generation the accounts were replaced in (0 = not)
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_VAULT_JOURNAL_SERVICE_H
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "VaultSaveScheduler.h"
+#include "../../utils/Log.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace KeepTower {
+
+using Clock = std::chrono::steady_clock;
+
+struct VaultSaveScheduler::State {
+    State(CaptureFn capture_fn, PostFn post_fn, std::chrono::milliseconds window_length)
+        : capture(std::move(capture_fn)), post(std::move(post_fn)), window(window_length) {}
+
+    void run(const std::weak_ptr<State>& self);
+    void capture_on_owner();
+
+    void report(bool ok);
+
+    CaptureFn capture;
+    PostFn post;
+    CompletionFn completion;         ///< Owner thread only
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::chrono::milliseconds window;
+
+    bool dirty = false;              ///< Notifications not yet captured
+    bool capture_requested = false;  ///< Worker posted a capture that has not run yet
+    Clock::time_point first_dirty;
+    Clock::time_point deadline;
+
+    SaveTask queued;                 ///< Captured snapshot waiting for the worker
+    bool in_flight = false;
+    bool failed = false;
+    bool stop = false;
+    uint64_t completed = 0;
+
+    std::thread worker;
+};
+
+void VaultSaveScheduler::State::run(const std::weak_ptr<State>& self) {
+    std::unique_lock lock(mutex);
+    while (true) {
+        if (queued) {
+            SaveTask task = std::exchange(queued, nullptr);
+            in_flight = true;
+            lock.unlock();
+
+            bool ok = false;
+            try {
+                ok = task();
+            } catch (const std::exception& e) {
+                Log::error("VaultSaveScheduler: Background save threw: {}", e.what());
+            }
+            task = nullptr;  // Release the snapshot outside the lock
+
+            lock.lock();
+            in_flight = false;
+            failed = !ok;
+            ++completed;
+            cv.notify_all();
+
+            if (post) {
+                lock.unlock();
+                post([self, ok]() {
+                    if (auto state = self.lock()) {
+                        state->report(ok);
+                    }
+                });
+                lock.lock();
+            }
+            continue;
+        }
+
+        if (stop) {
+            break;
+        }
+
+        if (dirty && !capture_requested && post) {
+            if (Clock::now() < deadline) {
+                cv.wait_until(lock, deadline);
+                continue;
+            }
+
+            // Window closed: the snapshot must be taken on the owner thread
+            capture_requested = true;
+            lock.unlock();
+            post([self]() {
+                if (auto state = self.lock()) {
+                    state->capture_on_owner();
+                }
+            });
+            lock.lock();
+            continue;
+        }
+
+        cv.wait(lock);
+    }
+}
+
+void VaultSaveScheduler::State::capture_on_owner() {
+    {
+        std::lock_guard lock(mutex);
+        capture_requested = false;
+        if (!dirty) {
+            return;  // Already captured by flush() or dropped by cancel_pending()
+        }
+        dirty = false;
+    }
+
+    SaveTask task;
+    try {
+        task = capture();
+    } catch (const std::exception& e) {
+        Log::error("VaultSaveScheduler: Snapshot capture threw: {}", e.what());
+        {
+            std::lock_guard lock(mutex);
+            failed = true;
+        }
+        report(false);
+        return;
+    }
+
+    if (task) {
+        std::lock_guard lock(mutex);
+        queued = std::move(task);  // Supersedes an older snapshot the worker has not started
+        cv.notify_all();
+    }
+}
+
+void VaultSaveScheduler::State::report(bool ok) {
+    if (completion) {
+        completion(ok);
+    }
+}
+
+VaultSaveScheduler::VaultSaveScheduler(CaptureFn capture, PostFn post, std::chrono::milliseconds window)
+    : m_state(std::make_shared<State>(std::move(capture), std::move(post), window)) {
+    m_state->worker = std::thread([state = m_state.get(), self = std::weak_ptr<State>(m_state)]() {
+        state->run(self);
+    });
+}
+
+VaultSaveScheduler::~VaultSaveScheduler() noexcept {
+    {
+        std::lock_guard lock(m_state->mutex);
+        m_state->stop = true;
+        m_state->dirty = false;
+    }
+    m_state->cv.notify_all();
+    if (m_state->worker.joinable()) {
+        m_state->worker.join();
+    }
+}
+
+void VaultSaveScheduler::notify_dirty() {
+    std::lock_guard lock(m_state->mutex);
+    const auto now = Clock::now();
+    if (!m_state->dirty) {
+        m_state->dirty = true;
+        m_state->first_dirty = now;
+    }
+    m_state->deadline = std::min(now + m_state->window,
+                                 m_state->first_dirty + m_state->window * MAX_DELAY_FACTOR);
+    m_state->cv.notify_all();
+}
+
+bool VaultSaveScheduler::flush() {
+    capture_now();
+    wait_idle();
+    std::lock_guard lock(m_state->mutex);
+    return !m_state->failed;
+}
+
+void VaultSaveScheduler::cancel_pending() {
+    SaveTask dropped;
+    std::lock_guard lock(m_state->mutex);
+    m_state->dirty = false;
+    dropped = std::exchange(m_state->queued, nullptr);
+    m_state->cv.notify_all();
+}
+
+void VaultSaveScheduler::wait_idle() {
+    std::unique_lock lock(m_state->mutex);
+    m_state->cv.wait(lock, [this]() {
+        return !m_state->queued && !m_state->in_flight;
+    });
+}
+
+void VaultSaveScheduler::set_window(std::chrono::milliseconds window) {
+    std::lock_guard lock(m_state->mutex);
+    m_state->window = window;
+}
+
+std::chrono::milliseconds VaultSaveScheduler::window() const {
+    std::lock_guard lock(m_state->mutex);
+    return m_state->window;
+}
+
+bool VaultSaveScheduler::has_pending() const {
+    std::lock_guard lock(m_state->mutex);
+    return m_state->dirty || m_state->queued || m_state->in_flight;
+}
+
+void VaultSaveScheduler::set_completion_callback(CompletionFn callback) {
+    m_state->completion = std::move(callback);
+}
+
+bool VaultSaveScheduler::last_save_failed() const {
+    std::lock_guard lock(m_state->mutex);
+    return m_state->failed;
+}
+
+void VaultSaveScheduler::clear_failure() {
+    std::lock_guard lock(m_state->mutex);
+    m_state->failed = false;
+}
+
+uint64_t VaultSaveScheduler::completed_saves() const {
+    std::lock_guard lock(m_state->mutex);
+    return m_state->completed;
+}
+
+void VaultSaveScheduler::capture_now() {
+    m_state->capture_on_owner();
+}
+
+}  // namespace KeepTower
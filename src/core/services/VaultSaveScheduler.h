@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#ifndef KEEPTOWER_VAULT_SAVE_SCHEDULER_H
+#define KEEPTOWER_VAULT_SAVE_SCHEDULER_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace KeepTower {
+
+/**
+ * @brief Debounced background save coordinator.
+ *
+ * Bulk UI actions (drag-and-drop, group edits, display-order resets) each used
+ * to trigger a full serialize + encrypt + fsync cycle on the GTK thread. The
+ * scheduler coalesces these dirty notifications: the first notification opens
+ * a window, further notifications extend it (up to MAX_DELAY_FACTOR windows
+ * after the first one), and once it closes a single save runs on a worker
+ * thread.
+ *
+ * **Threading model:**
+ * - notify_dirty(), flush(), cancel_pending() and wait_idle() are called on
+ *   the owner (GTK) thread.
+ * - The capture callback always runs on the owner thread, so it can take a
+ *   consistent snapshot of state that is only ever mutated there. When the
+ *   window closes, the worker asks the owner to capture via the post callback
+ *   (VaultManager posts through Glib::signal_idle()).
+ * - The SaveTask returned by capture runs on the worker thread and must only
+ *   touch the data it captured.
+ *
+ * **Barriers:**
+ * - flush() captures any pending changes immediately and blocks until the
+ *   worker is idle; used before close and lock.
+ * - cancel_pending() + wait_idle() drop pending changes and wait for an
+ *   in-flight write; used before a synchronous explicit save that supersedes
+ *   them.
+ *
+ * **Completion:** the callback set with set_completion_callback() hears the
+ * result of every background write and of every capture that threw. It
+ * always runs on the owner thread: the worker posts write results through
+ * the post callback.
+ *
+ * @note A capture requested through post() that arrives after flush() already
+ *       captured is ignored, and it is safe for the scheduler to be destroyed
+ *       while such a request or a completion report is still queued on the
+ *       main loop.
+ */
+class VaultSaveScheduler {
+public:
+    /// Background write; returns true on success
+    using SaveTask = std::function<bool()>;
+
+    /// Takes a snapshot on the owner thread; returns an empty task when there is nothing to save
+    using CaptureFn = std::function<SaveTask()>;
+
+    /// Runs a callback on the owner thread at some later point
+    using PostFn = std::function<void(std::function<void()>)>;
+
+    /// Hears whether a background save succeeded (owner thread)
+    using CompletionFn = std::function<void(bool success)>;
+
+    /// Default coalescing window
+    static constexpr std::chrono::milliseconds DEFAULT_WINDOW{500};
+
+    /// A burst of notifications is saved at most this many windows after it began
+    static constexpr int MAX_DELAY_FACTOR = 4;
+
+    /**
+     * @brief Create scheduler and start its worker thread
+     * @param capture Snapshot callback (owner thread)
+     * @param post Dispatch callback used by the worker to reach the owner thread
+     * @param window Coalescing window (0 = save as soon as the owner thread is idle)
+     */
+    VaultSaveScheduler(CaptureFn capture, PostFn post,
+                       std::chrono::milliseconds window = DEFAULT_WINDOW);
+
+    /**
+     * @brief Stop the worker thread
+     *
+     * A write already in progress completes; pending notifications are
+     * dropped. Owners call flush() first if pending changes must persist.
+     */
+    ~VaultSaveScheduler() noexcept;
+
+    VaultSaveScheduler(const VaultSaveScheduler&) = delete;
+    VaultSaveScheduler& operator=(const VaultSaveScheduler&) = delete;
+    VaultSaveScheduler(VaultSaveScheduler&&) = delete;
+    VaultSaveScheduler& operator=(VaultSaveScheduler&&) = delete;
+
+    /**
+     * @brief Record that state changed and a save is due
+     *
+     * Opens the coalescing window or extends the current one.
+     */
+    void notify_dirty();
+
+    /**
+     * @brief Capture pending changes now and wait until they are written
+     * @return false if the most recent background write failed
+     */
+    [[nodiscard]] bool flush();
+
+    /**
+     * @brief Drop pending notifications and any capture not yet started
+     */
+    void cancel_pending();
+
+    /**
+     * @brief Block until no background write is queued or running
+     */
+    void wait_idle();
+
+    /**
+     * @brief Change the coalescing window for subsequent notifications
+     * @param window New window length
+     */
+    void set_window(std::chrono::milliseconds window);
+
+    /** @brief Current coalescing window
+     *  @return Window length */
+    [[nodiscard]] std::chrono::milliseconds window() const;
+
+    /** @brief Whether changes are waiting for or undergoing a background write
+     *  @return true while dirty, queued or in flight */
+    [[nodiscard]] bool has_pending() const;
+
+    /**
+     * @brief Register a callback for the outcome of background saves
+     * @param callback Invoked on the owner thread after each background write
+     *
+     * Writes performed while flush() waits are reported too, after flush()
+     * returns and the owner thread runs the posted report.
+     */
+    void set_completion_callback(CompletionFn callback);
+
+    /** @brief Whether the most recent background write failed
+     *  @return true until a later write succeeds or clear_failure() is called */
+    [[nodiscard]] bool last_save_failed() const;
+
+    /** @brief Forget a background write failure (a synchronous save superseded it) */
+    void clear_failure();
+
+    /** @brief Number of background writes performed
+     *  @return Completed write count (successful or not) */
+    [[nodiscard]] uint64_t completed_saves() const;
+
+private:
+    struct State;
+
+    void capture_now();
+
+    std::shared_ptr<State> m_state;
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_VAULT_SAVE_SCHEDULER_H
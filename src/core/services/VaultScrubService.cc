@@ -0,0 +1,591 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "VaultScrubService.h"
+#include "VaultJournalService.h"
+#include "lib/crypto/VaultCrypto.h"
+#include "lib/storage/BackupManifest.h"
+#include "lib/storage/MappedVaultFile.h"
+#include "lib/storage/VaultIO.h"
+#include "lib/vaultformat/VaultFormatV2.h"
+#include "../../utils/Log.h"
+
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace KeepTower {
+
+using Clock = std::chrono::steady_clock;
+using Digest = std::array<uint8_t, 32>;
+
+namespace {
+
+/// Incremental SHA-256
+class Sha256 {
+public:
+    Sha256() : m_ctx(EVP_MD_CTX_new()) {
+        m_ok = m_ctx && EVP_DigestInit_ex(m_ctx, EVP_sha256(), nullptr) == 1;
+    }
+    ~Sha256() { EVP_MD_CTX_free(m_ctx); }
+    Sha256(const Sha256&) = delete;
+    Sha256& operator=(const Sha256&) = delete;
+
+    void update(std::span<const uint8_t> bytes) {
+        m_ok = m_ok && EVP_DigestUpdate(m_ctx, bytes.data(), bytes.size()) == 1;
+    }
+
+    std::optional<Digest> finish() {
+        Digest digest{};
+        unsigned int size = 0;
+        if (!m_ok || EVP_DigestFinal_ex(m_ctx, digest.data(), &size) != 1 || size != digest.size()) {
+            return std::nullopt;
+        }
+        return digest;
+    }
+
+private:
+    EVP_MD_CTX* m_ctx;
+    bool m_ok = false;
+};
+
+/// SHA-256 of parts laid back to back, and of their first `head` bytes
+std::optional<std::pair<Digest, Digest>> digest_image(std::span<const std::span<const uint8_t>> parts,
+                                                      size_t head) {
+    Sha256 file;
+    Sha256 head_digest;
+    size_t remaining_head = head;
+    for (const auto& part : parts) {
+        file.update(part);
+        const size_t take = std::min(remaining_head, part.size());
+        head_digest.update(part.first(take));
+        remaining_head -= take;
+    }
+    auto file_result = file.finish();
+    auto head_result = head_digest.finish();
+    if (!file_result || !head_result) {
+        return std::nullopt;
+    }
+    return std::make_pair(*file_result, *head_result);
+}
+
+enum class ReadOutcome { Ok, Failed, Abandoned };
+
+/// Read a whole file through one descriptor, pacing between chunks
+ReadOutcome read_paced(const std::string& path,
+                       const VaultScrubService::Options& options,
+                       std::vector<uint8_t>& bytes,
+                       VaultFileService::FileIdentity& identity) {
+#ifndef _WIN32
+    const int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        return ReadOutcome::Failed;
+    }
+    auto before = VaultFileService::file_identity(fd);
+    if (!before || before->size == 0 || before->size > MappedVaultFile::MAX_FILE_SIZE) {
+        close(fd);
+        return ReadOutcome::Failed;
+    }
+
+    bytes.resize(static_cast<size_t>(before->size));
+    size_t done = 0;
+    while (done < bytes.size()) {
+        const size_t want = std::min(VaultScrubService::READ_CHUNK_SIZE, bytes.size() - done);
+        const ssize_t n = pread(fd, bytes.data() + done, want, static_cast<off_t>(done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            close(fd);
+            return ReadOutcome::Failed;
+        }
+        done += static_cast<size_t>(n);
+        if (options.pace && !options.pace(done)) {
+            close(fd);
+            return ReadOutcome::Abandoned;
+        }
+    }
+
+    // A save or append while we read: the bytes may mix two versions
+    auto after = VaultFileService::file_identity(fd);
+    close(fd);
+    if (!after || !(*after == *before)) {
+        return ReadOutcome::Abandoned;
+    }
+    identity = *after;
+    return ReadOutcome::Ok;
+#else
+    (void)path;
+    (void)options;
+    (void)bytes;
+    (void)identity;
+    return ReadOutcome::Failed;
+#endif
+}
+
+/// Identity of the file now at path (after a rewrite)
+std::optional<VaultFileService::FileIdentity> identity_at(const std::string& path) {
+#ifndef _WIN32
+    const int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    auto identity = VaultFileService::file_identity(fd);
+    close(fd);
+    return identity;
+#else
+    (void)path;
+    return std::nullopt;
+#endif
+}
+
+/// Put the calling thread in the idle I/O class at the lowest CPU priority
+void lower_thread_priority() {
+#ifdef __linux__
+    constexpr int IOPRIO_WHO_PROCESS = 1;  // who = 0: the calling thread
+    constexpr int IOPRIO_CLASS_IDLE = 3;
+    constexpr int IOPRIO_CLASS_SHIFT = 13;
+    if (syscall(SYS_ioprio_set, IOPRIO_WHO_PROCESS, 0, IOPRIO_CLASS_IDLE << IOPRIO_CLASS_SHIFT) != 0) {
+        Log::debug("VaultScrubService: Could not enter the idle I/O class");
+    }
+    if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19) != 0) {
+        Log::debug("VaultScrubService: Could not lower the worker's CPU priority");
+    }
+#endif
+}
+
+}  // namespace
+
+// ============================================================================
+// Scrubbing one file
+// ============================================================================
+
+VaultScrubService::ScrubbedFile VaultScrubService::scrub_file(const std::string& path,
+                                                              const Expectation& expected,
+                                                              const Options& options) {
+    ScrubbedFile result;
+    FileReport& report = result.report;
+    report.path = path;
+
+    std::vector<uint8_t> bytes;
+    VaultFileService::FileIdentity identity;
+    if (read_paced(path, options, bytes, identity) != ReadOutcome::Ok) {
+        report.status = FileStatus::Skipped;
+        return result;
+    }
+    const std::span<const uint8_t> file = bytes;
+
+    auto version = VaultFormatV2::detect_version(file);
+    if (!version) {
+        report.status = FileStatus::Skipped;
+        return result;
+    }
+
+    auto parsed = VaultFormatV2::read_header(file);
+    if (!parsed) {
+        Log::warning("VaultScrubService: Header of {} is beyond repair", path);
+        report.header_unreadable = true;
+        report.status = FileStatus::Damaged;
+        return result;
+    }
+    const auto& [header, data_offset] = *parsed;
+
+    // Headers in the current encoding re-encode to the same bytes, so any
+    // difference is damage that header FEC corrected on the way in
+    std::vector<uint8_t> fresh_header;
+    constexpr uint8_t CURRENT_ENCODING = VaultFormatV2::HEADER_FLAG_FEC_ENABLED |
+                                         VaultFormatV2::HEADER_FLAG_FEC_INTERLEAVED |
+                                         VaultFormatV2::HEADER_FLAG_FEC_CHECKSUMS;
+    if ((header.header_flags & CURRENT_ENCODING) == CURRENT_ENCODING) {
+        auto rebuilt = VaultFormatV2::write_header(header, true, header.fec_redundancy_percent);
+        if (rebuilt && rebuilt->size() == data_offset) {
+            const auto stored = file.first(data_offset);
+            report.header_bytes_repaired = static_cast<size_t>(std::inner_product(
+                stored.begin(), stored.end(), rebuilt->begin(), size_t{0}, std::plus<>(),
+                [](uint8_t a, uint8_t b) { return static_cast<size_t>(a != b); }));
+            if (report.header_bytes_repaired != 0) {
+                fresh_header = std::move(*rebuilt);
+            }
+        }
+    }
+
+    // Locate the base image and check whatever protects it
+    const auto payload = file.subspan(data_offset);
+    std::optional<VaultFormatV2::DataSection> section;
+    VaultJournalService::PayloadLayout layout;
+    if (header.data_fec_parity_symbols != 0) {
+        report.data_fec = true;
+        auto opened = VaultFormatV2::open_data_section(
+            header.data_fec_parity_symbols, header.data_fec_window_size, payload);
+        if (!opened) {
+            Log::warning("VaultScrubService: Encrypted data of {} is beyond repair", path);
+            report.data_unreadable = true;
+            report.status = FileStatus::Damaged;
+            return result;
+        }
+        section = std::move(*opened);
+        report.damaged_windows = section->damaged_windows;
+        report.damaged_length_copies = section->damaged_length_copies;
+        report.data_bytes_repaired = section->repaired_bytes;
+        layout = VaultJournalService::split_payload(payload, section->stored_size);
+    } else if (header.version == VaultFormatV2::VAULT_VERSION_V3) {
+        const auto base_size = VaultCrypto::stream_ciphertext_size(payload);
+        if (!base_size || *base_size > payload.size()) {
+            report.data_unreadable = true;
+            report.status = FileStatus::Damaged;
+            return result;
+        }
+        layout = VaultJournalService::split_payload(payload, *base_size);
+    } else {
+        layout = VaultJournalService::split_payload(payload);
+    }
+    report.journal_damaged = layout.valid_size != payload.size();
+
+    // The corrected image: fresh header, re-framed data section, journal as stored
+    const bool reframe = section && (section->damaged_windows != 0 || section->damaged_length_copies != 0);
+    VaultFormatV2::DataFecFraming framing;
+    std::vector<std::span<const uint8_t>> parts;
+    parts.push_back(fresh_header.empty() ? file.first(data_offset) : std::span<const uint8_t>(fresh_header));
+    if (reframe) {
+        auto protected_section = VaultFormatV2::protect_data_section(
+            header.data_fec_parity_symbols, header.data_fec_window_size, section->ciphertext);
+        if (!protected_section) {
+            report.status = FileStatus::Damaged;
+            return result;
+        }
+        framing = std::move(*protected_section);
+        parts.push_back(framing.prefix);
+        parts.push_back(section->ciphertext);
+        parts.push_back(framing.trailer);
+        parts.push_back(payload.subspan(section->stored_size));
+    } else {
+        parts.push_back(payload);
+    }
+
+    const auto digests = digest_image(parts, BackupManifest::HEADER_DIGEST_BYTES);
+    if (!digests) {
+        report.status = FileStatus::Skipped;
+        return result;
+    }
+    const auto& [image_digest, head_digest] = *digests;
+    uint64_t image_size = 0;
+    for (const auto& part : parts) {
+        image_size += part.size();
+    }
+
+    // Damage outside every FEC-protected region shows only in the digests
+    if (expected.identity && *expected.identity == identity && expected.file_digest &&
+        *expected.file_digest != image_digest) {
+        report.digest_mismatch = true;
+    }
+    if ((expected.size && *expected.size != image_size) ||
+        (expected.header_digest && *expected.header_digest != head_digest)) {
+        report.digest_mismatch = true;
+    }
+
+    const bool correctable = !fresh_header.empty() || reframe;
+    const bool uncorrectable = report.journal_damaged || report.digest_mismatch;
+    if (correctable && options.repair) {
+        auto written = VaultFileService::replace_vault_file_if_unchanged(path, parts, identity);
+        if (!written) {
+            // Busy: a save replaced the file, so there is nothing left to repair
+            report.status = written.error() == VaultError::Busy ? FileStatus::Skipped : FileStatus::Damaged;
+            return result;
+        }
+        report.rewritten = true;
+        Log::warning("VaultScrubService: Repaired {} ({} header bytes, {} data bytes in {} windows)",
+                     path, report.header_bytes_repaired, report.data_bytes_repaired, report.damaged_windows);
+    }
+
+    if (uncorrectable || (correctable && !report.rewritten)) {
+        if (uncorrectable) {
+            Log::warning("VaultScrubService: {} is damaged (journal {}, digest {})", path,
+                         report.journal_damaged ? "damaged" : "intact",
+                         report.digest_mismatch ? "mismatch" : "match");
+        }
+        // No baseline: the previous one keeps the damage visible on later passes
+        report.status = FileStatus::Damaged;
+        return result;
+    }
+
+    report.status = report.rewritten ? FileStatus::Repaired : FileStatus::Clean;
+    auto current = report.rewritten ? identity_at(path) : std::optional(identity);
+    if (current) {
+        result.baseline = Baseline{*current, image_digest};
+    }
+    return result;
+}
+
+size_t VaultScrubService::PassReport::count(FileStatus status) const noexcept {
+    return static_cast<size_t>(std::count_if(files.begin(), files.end(),
+        [status](const FileReport& file) { return file.status == status; }));
+}
+
+const char* to_string(VaultScrubService::FileStatus status) noexcept {
+    switch (status) {
+        case VaultScrubService::FileStatus::Clean:
+            return "clean";
+        case VaultScrubService::FileStatus::Repaired:
+            return "repaired";
+        case VaultScrubService::FileStatus::Damaged:
+            return "damaged";
+        case VaultScrubService::FileStatus::Skipped:
+            return "skipped";
+    }
+    return "skipped";
+}
+
+// ============================================================================
+// Background worker
+// ============================================================================
+
+struct VaultScrubService::State {
+    explicit State(Config scrub_config) : config(scrub_config) {}
+
+    void run();
+    void run_pass(const std::string& vault_path, const std::string& backup_dir, uint64_t generation);
+    bool pace(Clock::time_point started, uint64_t bytes_read, uint64_t generation);
+
+    const Config config;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+
+    std::string vault_path;            ///< Empty when nothing is watched
+    std::string backup_dir;
+    uint64_t generation = 0;           ///< Bumped by watch()/unwatch() to abandon a pass
+    bool pass_requested = false;
+    bool running = false;
+    bool running_requested = false;    ///< Pass in progress was asked for, so skips idle gating
+    bool stop = false;
+    Clock::time_point next_pass;
+    Clock::time_point last_activity;
+    std::optional<PassReport> last_pass;
+    uint64_t completed = 0;
+    std::map<std::string, Baseline> baselines;  ///< Last known-good state per file
+
+    std::thread worker;
+};
+
+void VaultScrubService::State::run() {
+    lower_thread_priority();
+
+    std::unique_lock lock(mutex);
+    while (!stop) {
+        if (vault_path.empty()) {
+            cv.wait(lock);
+            continue;
+        }
+
+        if (!pass_requested) {
+            const auto due = std::max(next_pass, last_activity + config.idle_delay);
+            if (Clock::now() < due) {
+                cv.wait_until(lock, due);
+                continue;
+            }
+        }
+
+        running_requested = pass_requested;
+        pass_requested = false;
+        running = true;
+        const std::string path = vault_path;
+        const std::string backups = backup_dir;
+        const uint64_t pass_generation = generation;
+        lock.unlock();
+
+        try {
+            run_pass(path, backups, pass_generation);
+        } catch (const std::exception& e) {
+            Log::error("VaultScrubService: Pass threw: {}", e.what());
+        }
+
+        lock.lock();
+        running = false;
+        next_pass = Clock::now() + config.interval;
+        cv.notify_all();
+    }
+}
+
+bool VaultScrubService::State::pace(Clock::time_point started, uint64_t bytes_read, uint64_t pass_generation) {
+    std::unique_lock lock(mutex);
+    auto abandoned = [&]() { return stop || generation != pass_generation; };
+
+    // Read no faster than the configured rate
+    if (config.bytes_per_second != 0) {
+        const auto budget = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(static_cast<double>(bytes_read) /
+                                          static_cast<double>(config.bytes_per_second)));
+        cv.wait_until(lock, started + budget, abandoned);
+    }
+
+    // Let interactive work finish before reading on
+    while (!abandoned() && !running_requested && !pass_requested &&
+           Clock::now() < last_activity + config.idle_delay) {
+        cv.wait_until(lock, last_activity + config.idle_delay);
+    }
+    return !abandoned();
+}
+
+void VaultScrubService::State::run_pass(const std::string& path,
+                                        const std::string& backups,
+                                        uint64_t pass_generation) {
+    namespace fs = std::filesystem;
+
+    std::vector<std::pair<std::string, bool>> files{{path, false}};
+    for (auto& backup : VaultIO::list_backups(path, backups)) {
+        files.emplace_back(std::move(backup), true);
+    }
+    std::map<std::string, BackupManifestEntry> manifest;
+    for (auto& entry : BackupManifest::load(path, backups)) {
+        const std::string filename = entry.filename;
+        manifest.emplace(filename, std::move(entry));
+    }
+
+    PassReport pass;
+    for (const auto& [file, is_backup] : files) {
+        Expectation expected;
+        {
+            std::lock_guard lock(mutex);
+            if (stop || generation != pass_generation) {
+                return;
+            }
+            if (auto it = baselines.find(file); it != baselines.end()) {
+                expected.identity = it->second.identity;
+                expected.file_digest = it->second.digest;
+            }
+        }
+        const auto entry = is_backup ? manifest.find(fs::path(file).filename().string()) : manifest.end();
+        if (entry != manifest.end()) {
+            expected.size = entry->second.size;
+            expected.header_digest = entry->second.header_digest;
+        }
+
+        Options options;
+        options.repair = config.repair;
+        const auto started = Clock::now();
+        options.pace = [this, started, pass_generation](uint64_t bytes_read) {
+            return pace(started, bytes_read, pass_generation);
+        };
+
+        auto scrubbed = scrub_file(file, expected, options);
+        scrubbed.report.backup = is_backup;
+
+        // A repaired backup copy is recorded afresh, keeping its creation time
+        if (scrubbed.report.rewritten && entry != manifest.end()) {
+            auto described = BackupManifest::describe(file, entry->second.created_ms);
+            if (!described || !BackupManifest::add(path, backups, std::move(*described))) {
+                Log::warning("VaultScrubService: Could not update the manifest entry of {}", file);
+            }
+        }
+
+        std::lock_guard lock(mutex);
+        if (stop || generation != pass_generation) {
+            return;
+        }
+        if (scrubbed.baseline) {
+            baselines[file] = *scrubbed.baseline;
+        }
+        pass.files.push_back(std::move(scrubbed.report));
+    }
+
+    std::lock_guard lock(mutex);
+    if (stop || generation != pass_generation) {
+        return;
+    }
+    // Forget backups that were pruned
+    std::erase_if(baselines, [&files](const auto& baseline) {
+        return std::none_of(files.begin(), files.end(),
+                            [&baseline](const auto& file) { return file.first == baseline.first; });
+    });
+    pass.finished = std::chrono::system_clock::now();
+    Log::info("VaultScrubService: Checked {} files ({} repaired, {} damaged, {} skipped)",
+              pass.files.size(), pass.count(FileStatus::Repaired), pass.count(FileStatus::Damaged),
+              pass.count(FileStatus::Skipped));
+    last_pass = std::move(pass);
+    ++completed;
+}
+
+VaultScrubService::VaultScrubService()
+    : VaultScrubService(Config{}) {}
+
+VaultScrubService::VaultScrubService(Config config)
+    : m_state(std::make_shared<State>(config)) {}
+
+VaultScrubService::~VaultScrubService() noexcept {
+    {
+        std::lock_guard lock(m_state->mutex);
+        m_state->stop = true;
+        m_state->cv.notify_all();
+    }
+    if (m_state->worker.joinable()) {
+        m_state->worker.join();
+    }
+}
+
+void VaultScrubService::watch(std::string vault_path, std::string backup_dir) {
+    std::lock_guard lock(m_state->mutex);
+    if (vault_path != m_state->vault_path) {
+        m_state->last_pass.reset();
+        m_state->baselines.clear();
+    }
+    m_state->vault_path = std::move(vault_path);
+    m_state->backup_dir = std::move(backup_dir);
+    ++m_state->generation;
+    m_state->next_pass = Clock::now();
+    m_state->last_activity = Clock::now();
+    if (!m_state->worker.joinable()) {
+        m_state->worker = std::thread([state = m_state.get()]() { state->run(); });
+    }
+    m_state->cv.notify_all();
+}
+
+void VaultScrubService::unwatch() {
+    std::unique_lock lock(m_state->mutex);
+    m_state->vault_path.clear();
+    m_state->pass_requested = false;
+    ++m_state->generation;
+    m_state->cv.notify_all();
+    m_state->cv.wait(lock, [this]() { return !m_state->running; });
+}
+
+void VaultScrubService::notify_activity() {
+    std::lock_guard lock(m_state->mutex);
+    m_state->last_activity = Clock::now();
+}
+
+void VaultScrubService::request_pass() {
+    std::lock_guard lock(m_state->mutex);
+    m_state->pass_requested = true;
+    m_state->cv.notify_all();
+}
+
+VaultScrubService::Status VaultScrubService::status() const {
+    std::lock_guard lock(m_state->mutex);
+    return Status{!m_state->vault_path.empty(), m_state->running, m_state->last_pass};
+}
+
+uint64_t VaultScrubService::completed_passes() const {
+    std::lock_guard lock(m_state->mutex);
+    return m_state->completed;
+}
+
+}  // namespace KeepTower
@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#ifndef KEEPTOWER_VAULT_SCRUB_SERVICE_H
+#define KEEPTOWER_VAULT_SCRUB_SERVICE_H
+
+#include "VaultFileService.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace KeepTower {
+
+/**
+ * @brief Idle-time integrity scrubber for a vault file and its backups.
+ *
+ * Bit rot used to surface only when open_vault_v2() failed. The scrubber
+ * re-reads the watched vault and every backup VaultIO::list_backups()
+ * reports, a few hours apart, and checks what can be checked without the
+ * vault key:
+ * - the protected header decodes, and matches a fresh encoding of itself
+ *   (so corrected symbols, damaged checksums and FEC metadata all show);
+ * - data FEC windows and length copies, when the file has data FEC;
+ * - appended journal frames parse to the end of the file;
+ * - a SHA-256 of the whole file against the previous clean pass of the
+ *   same inode, size and mtime, and for backups the size and header digest
+ *   recorded in their BackupManifest entry.
+ *
+ * Correctable damage is repaired in place: the corrected image (fresh
+ * header encoding, re-framed data section, journal tail as stored) goes
+ * through VaultFileService::replace_vault_file_if_unchanged(), so it is
+ * written atomically and never replaces a file that a save or journal
+ * append changed in the meantime. GCM tags need the key and are still
+ * checked only when the vault is opened.
+ *
+ * **Staying out of the way:**
+ * - One worker thread, in the idle I/O class (ioprio) at the lowest CPU
+ *   priority on Linux.
+ * - Reads are paced to Config::bytes_per_second.
+ * - A pass starts only after Config::idle_delay without notify_activity(),
+ *   and a running pass pauses while activity is recent.
+ *
+ * **Threading model:** every public method may be called from any thread;
+ * the owner typically calls them on the GTK thread and polls status().
+ */
+class VaultScrubService {
+public:
+    /// Default time between passes
+    static constexpr std::chrono::hours DEFAULT_INTERVAL{6};
+
+    /// Default quiet time before a pass starts
+    static constexpr std::chrono::seconds DEFAULT_IDLE_DELAY{120};
+
+    /// Default read rate (bytes per second)
+    static constexpr uint64_t DEFAULT_BYTES_PER_SECOND = 4 * 1024 * 1024;
+
+    /// Bytes read between pacing decisions
+    static constexpr size_t READ_CHUNK_SIZE = 256 * 1024;
+
+    /**
+     * @brief Outcome of scrubbing one file.
+     */
+    enum class FileStatus : uint8_t {
+        Clean,     ///< Every check passed
+        Repaired,  ///< Correctable damage was found and the corrected image written
+        Damaged,   ///< Damage that could not be (or was not) corrected
+        Skipped,   ///< Missing, unreadable, not a V2 vault, or changed while being read
+    };
+
+    /**
+     * @brief What a scrub found in one file.
+     */
+    struct FileReport {
+        std::string path;                    ///< File scrubbed
+        bool backup = false;                 ///< Backup copy rather than the vault itself
+        FileStatus status = FileStatus::Clean;  ///< Overall outcome
+        bool header_unreadable = false;      ///< Header FEC could not recover the header
+        bool data_unreadable = false;        ///< Data FEC could not locate or repair the ciphertext
+        bool data_fec = false;               ///< Ciphertext is covered by data FEC
+        size_t header_bytes_repaired = 0;    ///< Header bytes that differed from a fresh encoding
+        size_t damaged_windows = 0;          ///< Data FEC windows that failed their checksums
+        size_t damaged_length_copies = 0;    ///< Data FEC length copies that were damaged
+        size_t data_bytes_repaired = 0;      ///< Ciphertext bytes corrected
+        bool journal_damaged = false;        ///< Journal frames stop short of the end of the file
+        bool digest_mismatch = false;        ///< Bytes differ from the recorded digest after correction
+        bool rewritten = false;              ///< Corrected image written back
+    };
+
+    /**
+     * @brief What a file is expected to contain.
+     */
+    struct Expectation {
+        std::optional<VaultFileService::FileIdentity> identity;  ///< Identity at the last clean pass
+        std::optional<std::array<uint8_t, 32>> file_digest;       ///< SHA-256 of the file at that pass
+        std::optional<uint64_t> size;                              ///< Recorded size (backup manifest)
+        std::optional<std::array<uint8_t, 32>> header_digest;      ///< Recorded head digest (backup manifest)
+    };
+
+    /**
+     * @brief File state to expect on the next pass.
+     */
+    struct Baseline {
+        VaultFileService::FileIdentity identity;  ///< Identity of the file now on disk
+        std::array<uint8_t, 32> digest{};         ///< SHA-256 of its contents
+    };
+
+    /**
+     * @brief Result of scrub_file().
+     */
+    struct ScrubbedFile {
+        FileReport report;                 ///< Findings
+        std::optional<Baseline> baseline;  ///< Set when the file on disk is known good
+    };
+
+    /**
+     * @brief Knobs for scrub_file().
+     */
+    struct Options {
+        bool repair = true;  ///< Write corrected images back
+        /// Called after each chunk read with the bytes read so far; may sleep,
+        /// returns false to abandon the file (reported as Skipped)
+        std::function<bool(uint64_t)> pace;
+    };
+
+    /**
+     * @brief Findings of one complete pass.
+     */
+    struct PassReport {
+        std::chrono::system_clock::time_point finished;  ///< When the pass ended
+        std::vector<FileReport> files;                   ///< Vault first, then backups newest first
+
+        /** @brief Files with a given outcome
+         *  @param status Outcome to count
+         *  @return Number of files */
+        [[nodiscard]] size_t count(FileStatus status) const noexcept;
+    };
+
+    /**
+     * @brief Snapshot for status displays.
+     */
+    struct Status {
+        bool watching = false;                 ///< A vault is being watched
+        bool running = false;                  ///< A pass is in progress
+        std::optional<PassReport> last_pass;   ///< Most recent complete pass of the watched vault
+    };
+
+    /**
+     * @brief Scheduling and pacing.
+     */
+    struct Config {
+        std::chrono::milliseconds interval = DEFAULT_INTERVAL;      ///< Between passes
+        std::chrono::milliseconds idle_delay = DEFAULT_IDLE_DELAY;  ///< Quiet time before (and during) a pass
+        uint64_t bytes_per_second = DEFAULT_BYTES_PER_SECOND;      ///< Read rate (0 = unpaced)
+        bool repair = true;                                         ///< Write corrected images back
+    };
+
+    /**
+     * @brief Verify one file and repair what its FEC can correct.
+     *
+     * Synchronous and stateless; the worker calls it for each file, and
+     * tools can call it directly.
+     *
+     * @param path File to scrub
+     * @param expected Digests and sizes the file should match
+     * @param options Repair switch and read pacing
+     * @return Findings, plus the baseline to expect next time
+     */
+    [[nodiscard]] static ScrubbedFile scrub_file(const std::string& path,
+                                                 const Expectation& expected,
+                                                 const Options& options);
+
+    /** @brief Create an idle scrubber with the default schedule */
+    VaultScrubService();
+
+    /**
+     * @brief Create an idle scrubber (the worker starts with the first watch())
+     * @param config Scheduling and pacing
+     */
+    explicit VaultScrubService(Config config);
+
+    /** @brief Abandon any pass in progress and stop the worker */
+    ~VaultScrubService() noexcept;
+
+    VaultScrubService(const VaultScrubService&) = delete;
+    VaultScrubService& operator=(const VaultScrubService&) = delete;
+    VaultScrubService(VaultScrubService&&) = delete;
+    VaultScrubService& operator=(VaultScrubService&&) = delete;
+
+    /**
+     * @brief Scrub a vault and its backups from now on
+     *
+     * The first pass runs once the process has been idle for
+     * Config::idle_delay; later passes follow every Config::interval.
+     *
+     * @param vault_path Vault file
+     * @param backup_dir Backup directory override (empty = vault's directory)
+     */
+    void watch(std::string vault_path, std::string backup_dir);
+
+    /** @brief Stop scrubbing; waits for a pass in progress to be abandoned */
+    void unwatch();
+
+    /** @brief Record interactive work: passes wait until it has been quiet a while */
+    void notify_activity();
+
+    /** @brief Start a pass as soon as possible, ignoring the idle delay */
+    void request_pass();
+
+    /** @brief Current state
+     *  @return Copy of the status */
+    [[nodiscard]] Status status() const;
+
+    /** @brief Passes completed since construction
+     *  @return Completed pass count */
+    [[nodiscard]] uint64_t completed_passes() const;
+
+private:
+    struct State;
+
+    std::shared_ptr<State> m_state;
+};
+
+/**
+ * @brief Short description of a scrub outcome for status displays
+ * @param status Outcome
+ * @return "clean", "repaired", "damaged" or "skipped"
+ */
+[[nodiscard]] const char* to_string(VaultScrubService::FileStatus status) noexcept;
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_VAULT_SCRUB_SERVICE_H
@@ -0,0 +1,303 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "VaultVerificationService.h"
+#include "KeySlotManager.h"
+#include "VaultFileService.h"
+#include "VaultJournalService.h"
+#include "lib/crypto/KekDerivationService.h"
+#include "lib/crypto/KeyWrapping.h"
+#include "lib/crypto/VaultCrypto.h"
+#include "lib/storage/MappedVaultFile.h"
+#include "lib/vaultformat/VaultFormatV2.h"
+#include "../../utils/Log.h"
+#include "../../utils/WorkerRanges.h"
+
+#include <openssl/crypto.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace KeepTower {
+
+namespace {
+
+/// Bytes that determine a KEK: KDF algorithm, its parameters and the slot salt
+std::vector<uint8_t> kek_cache_key(const KeySlot& slot,
+                                   const KekDerivationService::AlgorithmParameters& params) {
+    std::vector<uint8_t> key;
+    key.reserve(1 + 13 + slot.salt.size());
+    key.push_back(slot.kek_derivation_algorithm);
+    for (uint32_t value : {params.pbkdf2_iterations, params.argon2_memory_kb, params.argon2_time_cost}) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            key.push_back(static_cast<uint8_t>(value >> shift));
+        }
+    }
+    key.push_back(params.argon2_parallelism);
+    key.insert(key.end(), slot.salt.begin(), slot.salt.end());
+    return key;
+}
+
+}  // namespace
+
+VaultVerificationService::VaultVerificationService() = default;
+
+VaultVerificationService::VaultVerificationService(Credential credential)
+    : m_credential(std::move(credential)) {}
+
+VaultVerificationService::~VaultVerificationService() noexcept {
+    if (m_credential) {
+        OPENSSL_cleanse(m_credential->password.data(), m_credential->password.size());
+    }
+    for (auto& [key, kek] : m_kek_cache) {
+        OPENSSL_cleanse(kek.data(), kek.size());
+    }
+}
+
+VaultVerificationService::Report VaultVerificationService::verify(const std::string& path) const {
+    Report report;
+    report.path = path;
+
+    auto fail = [&report](Stage stage, VaultError error) -> Report& {
+        report.status = FileStatus::Damaged;
+        report.failed_stage = stage;
+        report.error = error;
+        return report;
+    };
+
+    auto mapped = MappedVaultFile::open(path);
+    if (!mapped) {
+        return fail(Stage::File, mapped.error());
+    }
+    const std::span<const uint8_t> file = mapped->bytes();
+    report.size = file.size();
+
+    // 1. Magic and version
+    auto version = VaultFormatV2::detect_version(file);
+    if (!version) {
+        report.status = FileStatus::Unsupported;
+        report.error = version.error();
+        return report;
+    }
+    report.version = *version;
+
+    // 2. Header FEC and key slots
+    auto metadata = VaultFileService::read_v2_metadata(file);
+    if (!metadata) {
+        return fail(Stage::Header, metadata.error());
+    }
+    report.header_fec = (file[VaultFormatV2::PREAMBLE_SIZE] & VaultFormatV2::HEADER_FLAG_FEC_ENABLED) != 0;
+    report.key_slots = metadata->vault_header.key_slots.size();
+    report.active_key_slots = static_cast<size_t>(std::count_if(
+        metadata->vault_header.key_slots.begin(), metadata->vault_header.key_slots.end(),
+        [](const KeySlot& slot) { return slot.active; }));
+    if (metadata->data_offset >= file.size()) {
+        return fail(Stage::Data, VaultError::CorruptedFile);
+    }
+
+    // 3. Data FEC, or the framing of a bare ciphertext
+    const auto payload = file.subspan(metadata->data_offset);
+    auto section = VaultFileService::open_v2_data_section(*metadata, payload);
+    if (!section) {
+        return fail(Stage::Data, section.error());
+    }
+    report.data_fec = metadata->data_fec_parity_symbols != 0;
+    report.damaged_windows = section->damaged_windows;
+    report.repaired_bytes = section->repaired_bytes;
+
+    // 4. Journal frames behind the base ciphertext
+    const bool segmented = metadata->format_version == VaultFileService::FORMAT_VERSION_SEGMENTED_PAYLOAD;
+    VaultJournalService::PayloadLayout layout;
+    std::span<const uint8_t> base_ciphertext;
+    std::span<const uint8_t> whole_payload;
+    if (segmented) {
+        const auto base_size = VaultCrypto::stream_ciphertext_size(section->ciphertext);
+        if (!base_size || *base_size > section->ciphertext.size() ||
+            (report.data_fec && *base_size != section->ciphertext.size())) {
+            return fail(Stage::Data, VaultError::CorruptedFile);
+        }
+        layout = VaultJournalService::split_payload(payload, report.data_fec ? section->stored_size : *base_size);
+        base_ciphertext = section->ciphertext.first(*base_size);
+    } else if (report.data_fec) {
+        layout = VaultJournalService::split_payload(payload, section->stored_size);
+        base_ciphertext = section->ciphertext;
+    } else {
+        layout = VaultJournalService::split_payload(payload);
+        base_ciphertext = payload.first(layout.base_size);
+        if (layout.base_size != payload.size()) {
+            whole_payload = payload;
+        }
+    }
+    report.journal_frames = layout.frames.size();
+    report.journal_torn = layout.valid_size != payload.size();
+
+    if (report.damaged_windows != 0 || report.journal_torn) {
+        report.status = FileStatus::Degraded;
+    }
+
+    // 5. GCM, when a credential was given
+    if (m_credential) {
+        report.credential = check_credential(*metadata, base_ciphertext, whole_payload);
+        if (report.credential == CredentialStatus::TagMismatch) {
+            return fail(Stage::Credential, VaultError::DecryptionFailed);
+        }
+    }
+    return report;
+}
+
+VaultVerificationService::CredentialStatus VaultVerificationService::check_credential(
+    VaultFileService::V2VaultMetadata& metadata,
+    std::span<const uint8_t> base_ciphertext,
+    std::span<const uint8_t> whole_payload) const {
+    auto& header = metadata.vault_header;
+
+    KeySlot* slot = KeySlotManager::find_slot_by_username_hash(
+        header.key_slots, m_credential->username, header.security_policy);
+    if (!slot) {
+        return CredentialStatus::NoSuchUser;
+    }
+    if (slot->yubikey_enrolled) {
+        return CredentialStatus::NeedsYubiKey;
+    }
+
+    // Same parameters open_vault_v2() derives with
+    KekDerivationService::AlgorithmParameters params;
+    params.pbkdf2_iterations = metadata.pbkdf2_iterations;
+    params.argon2_memory_kb = header.security_policy.argon2_memory_kb;
+    params.argon2_time_cost = header.security_policy.argon2_iterations;
+    params.argon2_parallelism = header.security_policy.argon2_parallelism;
+
+    std::array<uint8_t, 32> kek{};
+    const auto cache_key = kek_cache_key(*slot, params);
+    bool cached = false;
+    {
+        std::lock_guard lock(m_kek_mutex);
+        if (auto it = m_kek_cache.find(cache_key); it != m_kek_cache.end()) {
+            kek = it->second;
+            cached = true;
+        }
+    }
+    if (!cached) {
+        auto derived = KekDerivationService::derive_kek(
+            m_credential->password,
+            static_cast<KekDerivationService::Algorithm>(slot->kek_derivation_algorithm),
+            std::span<const uint8_t>(slot->salt.data(), slot->salt.size()),
+            params);
+        if (!derived || derived->size() != kek.size()) {
+            return CredentialStatus::Rejected;
+        }
+        std::copy(derived->begin(), derived->end(), kek.begin());
+        std::lock_guard lock(m_kek_mutex);
+        m_kek_cache.emplace(cache_key, kek);
+    }
+
+    auto unwrapped = KeyWrapping::unwrap_key(kek, slot->wrapped_dek);
+    OPENSSL_cleanse(kek.data(), kek.size());
+    if (!unwrapped) {
+        return CredentialStatus::Rejected;
+    }
+    auto& dek = unwrapped->dek;
+
+    // verify_all() already runs one file per thread
+    const std::span<const uint8_t> iv(metadata.data_iv);
+    std::vector<uint8_t> plaintext;
+    bool authenticated = false;
+    if (metadata.format_version == VaultFileService::FORMAT_VERSION_SEGMENTED_PAYLOAD) {
+        authenticated = VaultCrypto::decrypt_stream(base_ciphertext, dek, iv, plaintext, 1);
+    } else {
+        // A bare ciphertext may contain the journal frame magic by chance
+        authenticated = VaultCrypto::decrypt_data(base_ciphertext, dek, iv, plaintext) ||
+            (!whole_payload.empty() && VaultCrypto::decrypt_data(whole_payload, dek, iv, plaintext));
+    }
+    OPENSSL_cleanse(plaintext.data(), plaintext.size());
+    OPENSSL_cleanse(dek.data(), dek.size());
+
+    return authenticated ? CredentialStatus::Verified : CredentialStatus::TagMismatch;
+}
+
+std::vector<VaultVerificationService::Report> VaultVerificationService::verify_all(
+    std::span<const std::string> paths, unsigned max_threads) const {
+    std::vector<Report> reports(paths.size());
+    if (paths.empty()) {
+        return reports;
+    }
+
+    // Files differ wildly in size, so workers pull the next index instead of taking fixed ranges
+    const size_t threads = worker_count(max_threads, paths.size(), paths.size(), 1);
+    std::atomic<size_t> next{0};
+    run_workers(threads, [&]() {
+        for (size_t i = next.fetch_add(1); i < paths.size(); i = next.fetch_add(1)) {
+            try {
+                reports[i] = verify(paths[i]);
+            } catch (const std::exception& e) {
+                Log::error("VaultVerificationService: Checking {} threw: {}", paths[i], e.what());
+                reports[i].path = paths[i];
+                reports[i].status = FileStatus::Damaged;
+                reports[i].failed_stage = Stage::File;
+                reports[i].error = VaultError::FileReadFailed;
+            }
+        }
+    });
+    return reports;
+}
+
+bool VaultVerificationService::is_restorable(const std::string& path) {
+    const auto report = VaultVerificationService().verify(path);
+    if (report.status == FileStatus::Damaged || report.status == FileStatus::Unsupported) {
+        Log::warning("VaultVerificationService: {} is {} ({} check)", path,
+                     to_string(report.status), to_string(report.failed_stage));
+        return false;
+    }
+    return true;
+}
+
+const char* to_string(VaultVerificationService::FileStatus status) noexcept {
+    switch (status) {
+        case VaultVerificationService::FileStatus::Intact:
+            return "intact";
+        case VaultVerificationService::FileStatus::Degraded:
+            return "degraded";
+        case VaultVerificationService::FileStatus::Damaged:
+            return "damaged";
+        case VaultVerificationService::FileStatus::Unsupported:
+            return "unsupported";
+    }
+    return "damaged";
+}
+
+const char* to_string(VaultVerificationService::Stage stage) noexcept {
+    switch (stage) {
+        case VaultVerificationService::Stage::None:
+            return "none";
+        case VaultVerificationService::Stage::File:
+            return "file";
+        case VaultVerificationService::Stage::Header:
+            return "header";
+        case VaultVerificationService::Stage::Data:
+            return "data";
+        case VaultVerificationService::Stage::Credential:
+            return "credential";
+    }
+    return "none";
+}
+
+const char* to_string(VaultVerificationService::CredentialStatus status) noexcept {
+    switch (status) {
+        case VaultVerificationService::CredentialStatus::NotChecked:
+            return "not_checked";
+        case VaultVerificationService::CredentialStatus::Verified:
+            return "verified";
+        case VaultVerificationService::CredentialStatus::NoSuchUser:
+            return "no_such_user";
+        case VaultVerificationService::CredentialStatus::Rejected:
+            return "rejected";
+        case VaultVerificationService::CredentialStatus::NeedsYubiKey:
+            return "needs_yubikey";
+        case VaultVerificationService::CredentialStatus::TagMismatch:
+            return "tag_mismatch";
+    }
+    return "not_checked";
+}
+
+}  // namespace KeepTower
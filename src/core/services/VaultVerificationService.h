@@ -0,0 +1,193 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#ifndef KEEPTOWER_VAULT_VERIFICATION_SERVICE_H
+#define KEEPTOWER_VAULT_VERIFICATION_SERVICE_H
+
+#include "VaultFileService.h"
+#include "../VaultError.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace KeepTower {
+
+/**
+ * @brief Offline verification of vault files, without opening them.
+ *
+ * Runs the checks open_vault_v2() would run, stopping before any plaintext
+ * is produced:
+ * 1. Magic and format version
+ * 2. Header FEC decode and key-slot deserialization
+ * 3. Data FEC (when present) or the segmented stream header
+ * 4. Journal framing behind the base ciphertext
+ * 5. Optionally, with a credential: the user's key slot, DEK unwrap and the
+ *    GCM tag(s) of the base ciphertext
+ *
+ * Files are memory-mapped and nothing is written. Used by keeptower-fsck to
+ * audit vault and backup sets, and by backup restore to skip backups that
+ * would not open.
+ *
+ * **Thread safety:** verify() may be called concurrently; KEKs derived for a
+ * credential are cached (keyed by slot salt and KDF parameters), so backups
+ * of the same vault pay for key derivation once.
+ */
+class VaultVerificationService {
+public:
+    /**
+     * @brief Overall verdict for one file.
+     */
+    enum class FileStatus : uint8_t {
+        Intact,       ///< Every check passed without correction
+        Degraded,     ///< Opens, but FEC corrected data or a torn journal tail is dropped
+        Damaged,      ///< Would not open
+        Unsupported,  ///< Not a V2 vault (missing magic, V1 or unknown version)
+    };
+
+    /**
+     * @brief First check a Damaged file failed.
+     */
+    enum class Stage : uint8_t {
+        None,        ///< No check failed
+        File,        ///< File could not be mapped
+        Header,      ///< Header FEC or key-slot deserialization
+        Data,        ///< Data FEC or payload framing
+        Credential,  ///< DEK unwrap or GCM authentication
+    };
+
+    /**
+     * @brief Outcome of checking a credential against a file.
+     */
+    enum class CredentialStatus : uint8_t {
+        NotChecked,    ///< No credential given, or an earlier check failed
+        Verified,      ///< DEK unwrapped and every GCM tag authenticated
+        NoSuchUser,    ///< No active key slot matches the username
+        Rejected,      ///< Wrong password: the DEK did not unwrap
+        NeedsYubiKey,  ///< The slot needs a hardware key; only the structure was checked
+        TagMismatch,   ///< DEK unwrapped, but the ciphertext failed authentication
+    };
+
+    /**
+     * @brief Credential used to authenticate ciphertext.
+     */
+    struct Credential {
+        std::string username;  ///< Vault username
+        std::string password;  ///< Password (cleared with the service)
+    };
+
+    /**
+     * @brief Findings for one file.
+     */
+    struct Report {
+        std::string path;                          ///< File checked
+        FileStatus status = FileStatus::Intact;    ///< Verdict
+        Stage failed_stage = Stage::None;          ///< Check that failed (Damaged only)
+        std::optional<VaultError> error;           ///< Error of the failed check
+        uint32_t version = 0;                      ///< On-disk format version (0 if unknown)
+        uint64_t size = 0;                         ///< File size in bytes
+        bool header_fec = false;                   ///< Header is FEC-protected
+        size_t key_slots = 0;                      ///< Key slots in the header
+        size_t active_key_slots = 0;               ///< Active key slots
+        bool data_fec = false;                     ///< Ciphertext is FEC-protected
+        size_t damaged_windows = 0;                ///< Data FEC windows that needed decoding
+        size_t repaired_bytes = 0;                 ///< Ciphertext bytes FEC corrected
+        size_t journal_frames = 0;                 ///< Intact journal frames
+        bool journal_torn = false;                 ///< Bytes after the last intact frame
+        CredentialStatus credential = CredentialStatus::NotChecked;  ///< Credential outcome
+    };
+
+    /** @brief Verifier for structure only */
+    VaultVerificationService();
+
+    /**
+     * @brief Verifier that also authenticates ciphertext
+     * @param credential User whose key slot unwraps the DEK
+     */
+    explicit VaultVerificationService(Credential credential);
+
+    /** @brief Clears the password and cached KEKs */
+    ~VaultVerificationService() noexcept;
+
+    VaultVerificationService(const VaultVerificationService&) = delete;
+    VaultVerificationService& operator=(const VaultVerificationService&) = delete;
+    VaultVerificationService(VaultVerificationService&&) = delete;
+    VaultVerificationService& operator=(VaultVerificationService&&) = delete;
+
+    /**
+     * @brief Check one file
+     * @param path File to check
+     * @return Findings (never throws; failures are reported in the result)
+     */
+    [[nodiscard]] Report verify(const std::string& path) const;
+
+    /**
+     * @brief Check many files in parallel
+     * @param paths Files to check
+     * @param max_threads Worker threads (0 = hardware concurrency)
+     * @return One report per path, in the order given
+     */
+    [[nodiscard]] std::vector<Report> verify_all(std::span<const std::string> paths,
+                                                 unsigned max_threads = 0) const;
+
+    /**
+     * @brief Whether a file would open (structure only)
+     *
+     * The validator backup restore uses: Intact and Degraded files qualify.
+     *
+     * @param path File to check
+     * @return true unless the file is Damaged or Unsupported
+     */
+    [[nodiscard]] static bool is_restorable(const std::string& path);
+
+private:
+    /**
+     * @brief Unwrap the DEK for the credential and authenticate the base ciphertext
+     * @param metadata Parsed header (its key slots are resolved in place)
+     * @param base_ciphertext Ciphertext located by the structural checks
+     * @param whole_payload Payload to retry a bare single ciphertext with, whose
+     *        journal split may have been fooled by frame magic (empty otherwise)
+     * @return Credential outcome
+     */
+    [[nodiscard]] CredentialStatus check_credential(VaultFileService::V2VaultMetadata& metadata,
+                                                    std::span<const uint8_t> base_ciphertext,
+                                                    std::span<const uint8_t> whole_payload) const;
+
+    std::optional<Credential> m_credential;
+
+    mutable std::mutex m_kek_mutex;
+    mutable std::map<std::vector<uint8_t>, std::array<uint8_t, 32>> m_kek_cache;  ///< KDF inputs -> KEK
+};
+
+/**
+ * @brief Machine-readable name of a verdict
+ * @param status Verdict
+ * @return "intact", "degraded", "damaged" or "unsupported"
+ */
+[[nodiscard]] const char* to_string(VaultVerificationService::FileStatus status) noexcept;
+
+/**
+ * @brief Machine-readable name of a check
+ * @param stage Check
+ * @return "none", "file", "header", "data" or "credential"
+ */
+[[nodiscard]] const char* to_string(VaultVerificationService::Stage stage) noexcept;
+
+/**
+ * @brief Machine-readable name of a credential outcome
+ * @param status Outcome
+ * @return "not_checked", "verified", "no_such_user", "rejected",
+ *         "needs_yubikey" or "tag_mismatch"
+ */
+[[nodiscard]] const char* to_string(VaultVerificationService::CredentialStatus status) noexcept;
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_VAULT_VERIFICATION_SERVICE_H
@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "lib/backup/BackupPruner.h"
+
+#include "lib/backup/ChunkedBackupStore.h"
+#include "lib/storage/VaultIO.h"
+#include "utils/Log.h"
+
+#include <algorithm>
+#include <system_error>
+
+namespace KeepTower {
+
+BackupPruner::~BackupPruner() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void BackupPruner::schedule(std::string vault_path, std::string backup_dir, int max_backups, bool chunked) {
+    {
+        std::lock_guard lock(m_mutex);
+        auto queued = std::find_if(m_jobs.begin(), m_jobs.end(), [&](const Job& job) {
+            return job.vault_path == vault_path && job.backup_dir == backup_dir && job.chunked == chunked;
+        });
+        if (queued != m_jobs.end()) {
+            queued->max_backups = max_backups;
+            return;
+        }
+        m_jobs.push_back({std::move(vault_path), std::move(backup_dir), max_backups, chunked});
+
+        if (!m_thread.joinable()) {
+            try {
+                m_thread = std::thread(&BackupPruner::run, this);
+            } catch (const std::system_error& e) {
+                Log::warning("BackupPruner: No worker thread ({}), pruning inline", e.what());
+                Job job = std::move(m_jobs.back());
+                m_jobs.pop_back();
+                prune(job);
+                return;
+            }
+        }
+    }
+    m_work_cv.notify_one();
+}
+
+void BackupPruner::wait_idle() {
+    std::unique_lock lock(m_mutex);
+    m_idle_cv.wait(lock, [this] { return m_jobs.empty() && !m_busy; });
+}
+
+void BackupPruner::prune(const Job& job) {
+    if (job.chunked) {
+        ChunkedBackupStore::prune(job.vault_path, job.max_backups, job.backup_dir);
+    } else {
+        VaultIO::cleanup_old_backups(job.vault_path, job.max_backups, job.backup_dir);
+    }
+}
+
+void BackupPruner::run() {
+    std::unique_lock lock(m_mutex);
+    for (;;) {
+        m_work_cv.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+        if (m_jobs.empty()) {
+            return;  // Stopping with nothing left to do
+        }
+
+        Job job = std::move(m_jobs.front());
+        m_jobs.pop_front();
+        m_busy = true;
+        lock.unlock();
+
+        prune(job);
+
+        lock.lock();
+        m_busy = false;
+        if (m_jobs.empty()) {
+            m_idle_cv.notify_all();
+        }
+    }
+}
+
+}  // namespace KeepTower
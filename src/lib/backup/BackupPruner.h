@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace KeepTower {
+
+/**
+ * @brief Background worker that applies backup retention off the save path.
+ *
+ * Deleting old backups does not affect the save that triggered it, so
+ * VaultBackupPolicy hands it here instead of blocking the save. Jobs for the
+ * same vault and directory that are still queued are merged, keeping only
+ * the latest retention count.
+ *
+ * The worker thread starts with the first job; destruction finishes queued
+ * jobs and joins it.
+ */
+class BackupPruner {
+public:
+    BackupPruner() = default;
+    ~BackupPruner();
+
+    BackupPruner(const BackupPruner&) = delete;
+    BackupPruner& operator=(const BackupPruner&) = delete;
+
+    /**
+     * @brief Queue retention for one vault's backups.
+     * @param vault_path Vault file path.
+     * @param backup_dir Backup directory override (empty means same directory as vault).
+     * @param max_backups Number of newest backups to keep.
+     * @param chunked Prune the ChunkedBackupStore instead of full-copy backups.
+     */
+    void schedule(std::string vault_path, std::string backup_dir, int max_backups, bool chunked = false);
+
+    /** @brief Block until every queued job has finished. */
+    void wait_idle();
+
+private:
+    struct Job {
+        std::string vault_path;
+        std::string backup_dir;
+        int max_backups;
+        bool chunked;
+    };
+
+    static void prune(const Job& job);
+
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_work_cv;
+    std::condition_variable m_idle_cv;
+    std::deque<Job> m_jobs;
+    bool m_busy = false;
+    bool m_stopping = false;
+    std::thread m_thread;
+};
+
+}  // namespace KeepTower
@@ -0,0 +1,491 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "lib/backup/ChunkedBackupStore.h"
+
+#include "lib/storage/BackupManifest.h"
+#include "lib/storage/MappedVaultFile.h"
+#include "utils/Log.h"
+
+#include <openssl/evp.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <unordered_set>
+
+namespace KeepTower {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using Digest = std::array<uint8_t, 32>;
+
+constexpr std::string_view RECIPE_SIGNATURE = "# KeepTower chunked backup 1";
+
+enum class Codec : uint8_t {
+    Raw = 0,
+    Zlib = 1,
+};
+
+/// Gear table for the rolling hash: fixed, so boundaries are stable across runs
+constexpr std::array<uint64_t, 256> make_gear_table() {
+    std::array<uint64_t, 256> table{};
+    uint64_t state = 0x4B54'4348'554E'4B53ULL;  // "KTCHUNKS"
+    for (auto& value : table) {
+        // splitmix64
+        state += 0x9E37'79B9'7F4A'7C15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xBF58'476D'1CE4'E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D0'49BB'1331'11EBULL;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr auto GEAR = make_gear_table();
+
+/// Serialises store updates (create, prune) within this process
+std::mutex& store_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+struct EvpMdCtxDeleter {
+    void operator()(EVP_MD_CTX* ctx) const noexcept { EVP_MD_CTX_free(ctx); }
+};
+
+Digest sha256(std::span<const uint8_t> data) {
+    Digest digest{};
+    unsigned int size = 0;
+    EVP_Digest(data.data(), data.size(), digest.data(), &size, EVP_sha256(), nullptr);
+    return digest;
+}
+
+std::string to_hex(std::span<const uint8_t> bytes) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (uint8_t b : bytes) {
+        out.push_back(digits[b >> 4]);
+        out.push_back(digits[b & 0x0F]);
+    }
+    return out;
+}
+
+std::optional<Digest> digest_from_hex(std::string_view hex) {
+    Digest digest{};
+    if (hex.size() != digest.size() * 2) {
+        return std::nullopt;
+    }
+    for (size_t i = 0; i < digest.size(); ++i) {
+        const auto* first = hex.data() + 2 * i;
+        if (std::from_chars(first, first + 2, digest[i], 16).ptr != first + 2) {
+            return std::nullopt;
+        }
+    }
+    return digest;
+}
+
+struct Recipe {
+    uint64_t image_size = 0;
+    Digest image_digest{};
+    std::vector<std::pair<Digest, size_t>> chunks;
+};
+
+std::optional<Recipe> read_recipe(const fs::path& path) {
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line) || line != RECIPE_SIGNATURE) {
+        return std::nullopt;
+    }
+
+    Recipe recipe;
+    std::string tag;
+    std::string hex;
+    if (!std::getline(in, line)) {
+        return std::nullopt;
+    }
+    std::istringstream image_line(line);
+    if (!(image_line >> tag >> recipe.image_size >> hex) || tag != "image") {
+        return std::nullopt;
+    }
+    auto image_digest = digest_from_hex(hex);
+    if (!image_digest) {
+        return std::nullopt;
+    }
+    recipe.image_digest = *image_digest;
+
+    uint64_t total = 0;
+    while (std::getline(in, line)) {
+        std::istringstream chunk_line(line);
+        size_t length = 0;
+        if (!(chunk_line >> hex >> length) || length == 0 || length > ChunkedBackupStore::MAX_CHUNK_SIZE) {
+            return std::nullopt;
+        }
+        auto digest = digest_from_hex(hex);
+        if (!digest) {
+            return std::nullopt;
+        }
+        recipe.chunks.emplace_back(*digest, length);
+        total += length;
+    }
+    if (total != recipe.image_size) {
+        return std::nullopt;
+    }
+    return recipe;
+}
+
+fs::path object_path(const fs::path& root, const Digest& digest) {
+    const std::string hex = to_hex(digest);
+    return root / "objects" / hex.substr(0, 2) / hex.substr(2);
+}
+
+fs::path recipe_directory(const fs::path& root, std::string_view vault_path) {
+    return root / "recipes" / fs::path(vault_path).filename();
+}
+
+/// Write @p parts to @p path through a staging file and rename()
+bool write_atomically(const fs::path& path, std::initializer_list<std::span<const uint8_t>> parts) {
+    const fs::path staging = path.parent_path() / ("." + path.filename().string() + ".tmp");
+    {
+        std::ofstream out(staging, std::ios::binary | std::ios::trunc);
+        for (const auto& part : parts) {
+            out.write(reinterpret_cast<const char*>(part.data()), static_cast<std::streamsize>(part.size()));
+        }
+        out.flush();
+        if (!out) {
+            std::error_code ec;
+            fs::remove(staging, ec);
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    fs::permissions(staging, fs::perms::owner_read | fs::perms::owner_write, fs::perm_options::replace, ec);
+    fs::rename(staging, path, ec);
+    if (ec) {
+        fs::remove(staging, ec);
+        return false;
+    }
+    return true;
+}
+
+/// Store one chunk unless an object with its hash already exists
+VaultResult<uint64_t> put_object(const fs::path& root, const Digest& digest,
+                                 std::span<const uint8_t> chunk, bool compress) {
+    const fs::path path = object_path(root, digest);
+    std::error_code ec;
+    if (fs::exists(path, ec)) {
+        return 0;
+    }
+    fs::create_directories(path.parent_path(), ec);
+
+    std::vector<uint8_t> compressed;
+    Codec codec = Codec::Raw;
+    std::span<const uint8_t> body = chunk;
+    if (compress) {
+        uLongf size = compressBound(static_cast<uLong>(chunk.size()));
+        compressed.resize(size);
+        if (compress2(compressed.data(), &size, chunk.data(), static_cast<uLong>(chunk.size()), 1) == Z_OK &&
+            size < chunk.size()) {
+            codec = Codec::Zlib;
+            body = std::span<const uint8_t>(compressed.data(), size);
+        }
+    }
+
+    const uint8_t codec_byte = static_cast<uint8_t>(codec);
+    if (!write_atomically(path, {std::span<const uint8_t>(&codec_byte, 1), body})) {
+        Log::warning("ChunkedBackupStore: Failed to write chunk {}", path.string());
+        return std::unexpected(VaultError::FileWriteFailed);
+    }
+    return 1 + body.size();
+}
+
+/// Read a chunk back, decompressing and checking it against its hash
+bool get_object(const fs::path& root, const Digest& digest, size_t length, std::vector<uint8_t>& out) {
+    std::ifstream in(object_path(root, digest), std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::vector<uint8_t> stored((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (stored.empty()) {
+        return false;
+    }
+
+    out.resize(length);
+    const std::span<const uint8_t> body(stored.data() + 1, stored.size() - 1);
+    switch (static_cast<Codec>(stored[0])) {
+        case Codec::Raw:
+            if (body.size() != length) {
+                return false;
+            }
+            std::copy(body.begin(), body.end(), out.begin());
+            break;
+        case Codec::Zlib: {
+            uLongf size = static_cast<uLongf>(length);
+            if (uncompress(out.data(), &size, body.data(), static_cast<uLong>(body.size())) != Z_OK ||
+                size != length) {
+                return false;
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+    return sha256(out) == digest;
+}
+
+std::string timestamp_name() {
+    const auto now = std::chrono::system_clock::now();
+    const auto time = std::chrono::system_clock::to_time_t(now);
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()) % 1000;
+    std::ostringstream name;
+    name << std::put_time(std::localtime(&time), "%Y%m%d_%H%M%S")
+         << "_" << std::setfill('0') << std::setw(3) << ms.count();
+    return name.str();
+}
+
+}  // namespace
+
+fs::path ChunkedBackupStore::store_root(std::string_view vault_path, std::string_view backup_dir) {
+    return BackupManifest::directory_for(vault_path, backup_dir) / ".keeptower-chunks";
+}
+
+std::vector<size_t> ChunkedBackupStore::split(std::span<const uint8_t> image) {
+    std::vector<size_t> lengths;
+    size_t pos = 0;
+    while (pos < image.size()) {
+        const size_t remaining = image.size() - pos;
+        size_t length = std::min(remaining, MAX_CHUNK_SIZE);
+        if (remaining > MIN_CHUNK_SIZE) {
+            uint64_t hash = 0;
+            for (size_t i = MIN_CHUNK_SIZE; i < length; ++i) {
+                hash = (hash << 1) + GEAR[image[pos + i]];
+                if ((hash & BOUNDARY_MASK) == 0) {
+                    length = i + 1;
+                    break;
+                }
+            }
+        }
+        lengths.push_back(length);
+        pos += length;
+    }
+    return lengths;
+}
+
+VaultResult<ChunkedBackupStore::BackupInfo> ChunkedBackupStore::create_backup(std::string_view vault_path,
+                                                                              std::string_view backup_dir,
+                                                                              bool compress) {
+    auto source = MappedVaultFile::open(std::string(vault_path));
+    if (!source) {
+        return std::unexpected(source.error() == VaultError::FileNotFound ? VaultError::FileNotFound
+                                                                          : VaultError::FileReadFailed);
+    }
+    const auto image = source->bytes();
+
+    const fs::path root = store_root(vault_path, backup_dir);
+    const fs::path recipes = recipe_directory(root, vault_path);
+    std::lock_guard lock(store_mutex());
+
+    std::error_code ec;
+    fs::create_directories(recipes, ec);
+    if (ec) {
+        Log::warning("ChunkedBackupStore: Failed to create {}: {}", recipes.string(), ec.message());
+        return std::unexpected(VaultError::FileWriteFailed);
+    }
+
+    BackupInfo info;
+    std::ostringstream recipe;
+    recipe << RECIPE_SIGNATURE << '\n'
+           << "image " << image.size() << ' ' << to_hex(sha256(image)) << '\n';
+
+    size_t pos = 0;
+    for (size_t length : split(image)) {
+        const auto chunk = image.subspan(pos, length);
+        const Digest digest = sha256(chunk);
+        auto written = put_object(root, digest, chunk, compress);
+        if (!written) {
+            return std::unexpected(written.error());
+        }
+        if (*written > 0) {
+            ++info.new_chunks;
+            info.bytes_written += *written;
+        }
+        recipe << to_hex(digest) << ' ' << length << '\n';
+        ++info.chunk_count;
+        pos += length;
+    }
+
+    const std::string text = recipe.str();
+    const fs::path recipe_path = recipes / timestamp_name();
+    if (!write_atomically(recipe_path, {std::span<const uint8_t>(
+            reinterpret_cast<const uint8_t*>(text.data()), text.size())})) {
+        Log::warning("ChunkedBackupStore: Failed to write recipe {}", recipe_path.string());
+        return std::unexpected(VaultError::FileWriteFailed);
+    }
+
+    Log::info("Created chunked backup: {} ({} of {} chunks new, {} bytes written)",
+              recipe_path.string(), info.new_chunks, info.chunk_count, info.bytes_written);
+    info.recipe = recipe_path.string();
+    return info;
+}
+
+std::vector<std::string> ChunkedBackupStore::list_backups(std::string_view vault_path,
+                                                          std::string_view backup_dir) {
+    std::vector<std::string> backups;
+    const fs::path recipes = recipe_directory(store_root(vault_path, backup_dir), vault_path);
+    std::error_code ec;
+    for (fs::directory_iterator it(recipes, ec), end; !ec && it != end; it.increment(ec)) {
+        const std::string name = it->path().filename().string();
+        if (it->is_regular_file(ec) && !name.starts_with(".")) {
+            backups.push_back(it->path().string());
+        }
+    }
+    // Names are timestamps, so lexical order is creation order
+    std::sort(backups.begin(), backups.end(), std::greater<std::string>());
+    return backups;
+}
+
+VaultResult<> ChunkedBackupStore::restore(std::string_view vault_path, const fs::path& recipe_path) {
+    const auto recipe = read_recipe(recipe_path);
+    if (!recipe) {
+        std::error_code ec;
+        return std::unexpected(fs::exists(recipe_path, ec) ? VaultError::FileReadFailed : VaultError::FileNotFound);
+    }
+
+    // Recipes live in <root>/recipes/<vault>/
+    const fs::path root = recipe_path.parent_path().parent_path().parent_path();
+    const fs::path target(vault_path);
+    const fs::path staging = target.parent_path() / ("." + target.filename().string() + ".restore");
+
+    std::unique_ptr<EVP_MD_CTX, EvpMdCtxDeleter> image_hash(EVP_MD_CTX_new());
+    if (!image_hash || EVP_DigestInit_ex(image_hash.get(), EVP_sha256(), nullptr) != 1) {
+        return std::unexpected(VaultError::FileReadFailed);
+    }
+
+    std::lock_guard lock(store_mutex());  // Keep prune() from deleting chunks mid-restore
+    bool ok = true;
+    {
+        std::ofstream out(staging, std::ios::binary | std::ios::trunc);
+        std::error_code perm_ec;
+        fs::permissions(staging, fs::perms::owner_read | fs::perms::owner_write,
+                        fs::perm_options::replace, perm_ec);
+        std::vector<uint8_t> chunk;
+        for (const auto& [digest, length] : recipe->chunks) {
+            if (!get_object(root, digest, length, chunk)) {
+                Log::error("ChunkedBackupStore: Missing or corrupt chunk {} in {}",
+                           to_hex(digest), recipe_path.string());
+                ok = false;
+                break;
+            }
+            EVP_DigestUpdate(image_hash.get(), chunk.data(), chunk.size());
+            out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+        }
+        out.flush();
+        ok = ok && static_cast<bool>(out);
+    }
+
+    Digest image_digest{};
+    unsigned int digest_size = 0;
+    if (ok && (EVP_DigestFinal_ex(image_hash.get(), image_digest.data(), &digest_size) != 1 ||
+               image_digest != recipe->image_digest)) {
+        Log::error("ChunkedBackupStore: Reassembled image does not match {}", recipe_path.string());
+        ok = false;
+    }
+
+    std::error_code ec;
+    if (ok) {
+        fs::rename(staging, target, ec);
+        if (!ec) {
+            Log::info("Restored from chunked backup: {}", recipe_path.string());
+            return {};
+        }
+        Log::error("ChunkedBackupStore: Failed to replace {}: {}", target.string(), ec.message());
+    }
+    fs::remove(staging, ec);
+    return std::unexpected(ok ? VaultError::FileWriteFailed : VaultError::FileReadFailed);
+}
+
+VaultResult<> ChunkedBackupStore::restore_most_recent(std::string_view vault_path, std::string_view backup_dir) {
+    for (const auto& recipe : list_backups(vault_path, backup_dir)) {
+        auto result = restore(vault_path, recipe);
+        if (result || result.error() == VaultError::FileWriteFailed) {
+            return result;  // Restored, or the vault itself can't be written
+        }
+        Log::warning("ChunkedBackupStore: Skipping unusable backup {}", recipe);
+    }
+    return std::unexpected(VaultError::FileNotFound);
+}
+
+void ChunkedBackupStore::prune(std::string_view vault_path, int max_backups, std::string_view backup_dir) {
+    if (max_backups < 1) [[unlikely]] {
+        return;
+    }
+
+    const fs::path root = store_root(vault_path, backup_dir);
+    std::lock_guard lock(store_mutex());
+
+    const auto backups = list_backups(vault_path, backup_dir);
+    if (backups.size() <= static_cast<size_t>(max_backups)) {
+        return;
+    }
+
+    // Chunks of the deleted backups are garbage unless another recipe
+    // (of any vault sharing the store) still uses them
+    std::vector<Digest> candidates;
+    for (size_t i = static_cast<size_t>(max_backups); i < backups.size(); ++i) {
+        if (auto recipe = read_recipe(backups[i])) {
+            for (const auto& chunk : recipe->chunks) {
+                candidates.push_back(chunk.first);
+            }
+        }
+        std::error_code ec;
+        fs::remove(backups[i], ec);
+        if (ec) {
+            Log::warning("ChunkedBackupStore: Failed to delete backup {}: {}", backups[i], ec.message());
+        } else {
+            Log::info("Deleted old chunked backup: {}", backups[i]);
+        }
+    }
+
+    std::unordered_set<std::string> live;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(root / "recipes", ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->path().filename().string().starts_with(".")) {
+            continue;
+        }
+        auto recipe = read_recipe(it->path());
+        if (!recipe) {
+            // Unreadable recipe: keep every candidate rather than guess
+            Log::warning("ChunkedBackupStore: Unreadable recipe {}, skipping chunk cleanup", it->path().string());
+            return;
+        }
+        for (const auto& chunk : recipe->chunks) {
+            live.insert(to_hex(chunk.first));
+        }
+    }
+    if (ec) {
+        return;
+    }
+
+    size_t removed = 0;
+    for (const auto& digest : candidates) {
+        if (!live.contains(to_hex(digest)) && fs::remove(object_path(root, digest), ec)) {
+            ++removed;
+        }
+    }
+    Log::debug("ChunkedBackupStore: Removed {} unreferenced chunks", removed);
+}
+
+}  // namespace KeepTower
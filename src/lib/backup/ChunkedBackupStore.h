@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "core/VaultError.h"
+
+namespace KeepTower {
+
+/**
+ * @brief Backup store that keeps vault images as deduplicated chunks.
+ *
+ * Full-copy backups cost one vault image each; with up to 50 retained
+ * backups that multiplies the vault size on disk. This store splits each
+ * backed-up image into content-defined chunks (gear rolling hash, 16 KiB
+ * minimum, ~64 KiB average, 256 KiB maximum) and stores every chunk once,
+ * named by its SHA-256. A backup is then only a recipe listing its chunks,
+ * and creating one writes only the chunks the store has not seen yet.
+ *
+ * Layout under the backup directory (shared by every vault using it):
+ * @code
+ * .keeptower-chunks/objects/<2 hex>/<62 hex>        chunk objects
+ * .keeptower-chunks/recipes/<vault file name>/<ts>  one recipe per backup
+ * @endcode
+ * Objects hold a codec byte (raw or zlib) followed by the data; recipes are
+ * text files with the image size and SHA-256 followed by one line per chunk.
+ * Both are written through a staging name and rename(), so a recipe only
+ * appears once all of its chunks exist.
+ *
+ * What deduplicates: the vault payload is re-encrypted under a fresh IV on
+ * every full save, so consecutive full saves share little beyond the
+ * header. Journaled saves append to an unchanged base image, and repeated
+ * backups of an unchanged vault are identical, so those collapse to one
+ * copy plus the appended deltas. Compression is optional for the same
+ * reason: ciphertext does not compress, and a chunk is only stored
+ * compressed when that makes it smaller.
+ *
+ * Restore verifies every chunk against its hash and the reassembled image
+ * against the recorded image digest before renaming it over the vault. The
+ * payload's GCM tags need the vault key and are checked when the restored
+ * vault is opened.
+ *
+ * @note Operations are serialised within the process. Concurrent use of one
+ *       store from several processes is not coordinated.
+ */
+class ChunkedBackupStore {
+public:
+    static constexpr size_t MIN_CHUNK_SIZE = 16 * 1024;   ///< No boundary before this
+    static constexpr size_t MAX_CHUNK_SIZE = 256 * 1024;  ///< Forced boundary
+    static constexpr uint64_t BOUNDARY_MASK = 0xFFFFULL << 48;  ///< ~64 KiB average chunks
+
+    /** @brief Outcome of create_backup(). */
+    struct BackupInfo {
+        std::string recipe;        ///< Path of the recipe naming this backup
+        size_t chunk_count = 0;    ///< Chunks in the image
+        size_t new_chunks = 0;     ///< Chunks that had to be written
+        uint64_t bytes_written = 0;  ///< Object bytes written (after compression)
+    };
+
+    /**
+     * @brief Root directory of the store used for a vault.
+     * @param vault_path Vault file path.
+     * @param backup_dir Backup directory override (empty means same directory as vault).
+     * @return Store root.
+     */
+    [[nodiscard]] static std::filesystem::path store_root(std::string_view vault_path,
+                                                          std::string_view backup_dir);
+
+    /**
+     * @brief Content-defined chunk lengths for an image.
+     * @param image Bytes to split.
+     * @return Lengths summing to image.size(); boundaries depend only on
+     *         nearby content, so an edit only changes the chunks around it.
+     */
+    [[nodiscard]] static std::vector<size_t> split(std::span<const uint8_t> image);
+
+    /**
+     * @brief Back up the vault file's current image.
+     * @param vault_path Vault file path.
+     * @param backup_dir Backup directory override (empty means same directory as vault).
+     * @param compress Try zlib on each new chunk, keeping it only if smaller.
+     * @return Backup details, or FileNotFound / FileReadFailed / FileWriteFailed.
+     */
+    [[nodiscard]] static VaultResult<BackupInfo> create_backup(std::string_view vault_path,
+                                                               std::string_view backup_dir,
+                                                               bool compress = false);
+
+    /**
+     * @brief Recipes of a vault's backups, newest first.
+     * @param vault_path Vault file path.
+     * @param backup_dir Backup directory override (empty means same directory as vault).
+     * @return Recipe paths (empty if there are none).
+     */
+    [[nodiscard]] static std::vector<std::string> list_backups(std::string_view vault_path,
+                                                               std::string_view backup_dir);
+
+    /**
+     * @brief Reassemble one backup over the vault file.
+     * @param vault_path Vault file path to overwrite.
+     * @param recipe Recipe path from create_backup() or list_backups().
+     * @return Success, FileNotFound, FileReadFailed (missing or corrupt chunk,
+     *         digest mismatch) or FileWriteFailed.
+     */
+    [[nodiscard]] static VaultResult<> restore(std::string_view vault_path, const std::filesystem::path& recipe);
+
+    /**
+     * @brief Restore the newest backup that reassembles and verifies.
+     * @param vault_path Vault file path to overwrite.
+     * @param backup_dir Backup directory override (empty means same directory as vault).
+     * @return Success, or FileNotFound when no backup could be restored.
+     */
+    [[nodiscard]] static VaultResult<> restore_most_recent(std::string_view vault_path,
+                                                           std::string_view backup_dir);
+
+    /**
+     * @brief Delete all but the newest backups and the chunks only they used.
+     * @param vault_path Vault file path.
+     * @param max_backups Number of newest backups to keep (< 1 keeps all).
+     * @param backup_dir Backup directory override (empty means same directory as vault).
+     */
+    static void prune(std::string_view vault_path, int max_backups, std::string_view backup_dir);
+
+    ChunkedBackupStore() = delete;
+};
+
+}  // namespace KeepTower
@@ -3,21 +3,66 @@
 
 #include "lib/backup/VaultBackupPolicy.h"
 
+#include "lib/backup/BackupPruner.h"
+#include "lib/backup/ChunkedBackupStore.h"
 #include "lib/storage/VaultIO.h"
 #include "record.pb.h"
 #include "utils/Log.h"
 
+#include <functional>
+#include <system_error>
+
 namespace KeepTower {
 
+namespace {
+
+/// Settings captured when a backup starts
+struct BackupJob {
+    std::string vault_path;
+    std::string backup_dir;
+    int max_backups;
+    VaultBackupPolicy::StoreMode mode;
+};
+
+VaultResult<> create_and_schedule_pruning(const BackupJob& job, BackupPruner& pruner) {
+    const bool chunked = job.mode != VaultBackupPolicy::StoreMode::Copies;
+    VaultResult<> created;
+    if (chunked) {
+        auto info = ChunkedBackupStore::create_backup(
+            job.vault_path, job.backup_dir, job.mode == VaultBackupPolicy::StoreMode::ChunkedCompressed);
+        if (!info) {
+            created = std::unexpected(info.error());
+        }
+    } else {
+        auto backup_result = VaultIO::create_backup(job.vault_path, job.backup_dir);
+        if (!backup_result) {
+            created = std::unexpected(backup_result.error());
+        }
+    }
+    if (!created) {
+        Log::warning("VaultBackupPolicy: Failed to create backup: {}",
+                     static_cast<int>(created.error()));
+        return created;
+    }
+
+    pruner.schedule(job.vault_path, job.backup_dir, job.max_backups, chunked);
+    return {};
+}
+
+}  // namespace
+
 VaultBackupPolicy::VaultBackupPolicy(bool enabled, int max_backups, std::string backup_path)
     : m_enabled(enabled),
       m_max_backups(max_backups),
-      m_backup_path(std::move(backup_path)) {
+      m_backup_path(std::move(backup_path)),
+      m_pruner(std::make_unique<BackupPruner>()) {
     if (m_max_backups < kMinBackups || m_max_backups > kMaxBackups) {
         m_max_backups = 5;
     }
 }
 
+VaultBackupPolicy::~VaultBackupPolicy() = default;
+
 void VaultBackupPolicy::set_enabled(bool enabled) {
     m_enabled = enabled;
 }
@@ -38,6 +83,27 @@ int VaultBackupPolicy::max_backups() const {
     return m_max_backups;
 }
 
+std::optional<VaultBackupPolicy::StoreMode> VaultBackupPolicy::parse_store_mode(std::string_view name) {
+    if (name == "copies") {
+        return StoreMode::Copies;
+    }
+    if (name == "chunked") {
+        return StoreMode::Chunked;
+    }
+    if (name == "chunked-compressed") {
+        return StoreMode::ChunkedCompressed;
+    }
+    return std::nullopt;
+}
+
+void VaultBackupPolicy::set_store_mode(StoreMode mode) {
+    m_store_mode = mode;
+}
+
+VaultBackupPolicy::StoreMode VaultBackupPolicy::store_mode() const {
+    return m_store_mode;
+}
+
 void VaultBackupPolicy::set_backup_path(std::string path) {
     m_backup_path = std::move(path);
 }
@@ -72,19 +138,40 @@ VaultResult<> VaultBackupPolicy::maybe_create_backup(std::string_view vault_path
         return {};
     }
 
-    auto backup_result = VaultIO::create_backup(vault_path, m_backup_path);
-    if (!backup_result) {
-        Log::warning("VaultBackupPolicy: Failed to create backup: {}",
-                     static_cast<int>(backup_result.error()));
-        return std::unexpected(backup_result.error());
+    return create_and_schedule_pruning({std::string(vault_path), m_backup_path, m_max_backups, m_store_mode},
+                                       *m_pruner);
+}
+
+std::future<VaultResult<>> VaultBackupPolicy::begin_backup(std::string_view vault_path, bool explicit_save) const {
+    std::promise<VaultResult<>> ready;
+    if (!explicit_save || !m_enabled) {
+        ready.set_value({});
+        return ready.get_future();
     }
 
-    VaultIO::cleanup_old_backups(vault_path, m_max_backups, m_backup_path);
-    return {};
+    BackupJob job{std::string(vault_path), m_backup_path, m_max_backups, m_store_mode};
+    try {
+        return std::async(std::launch::async, create_and_schedule_pruning, job, std::ref(*m_pruner));
+    } catch (const std::system_error&) {
+        // No thread available: fall back to backing up before the save
+        ready.set_value(create_and_schedule_pruning(job, *m_pruner));
+        return ready.get_future();
+    }
 }
 
-VaultResult<> VaultBackupPolicy::restore_from_most_recent_backup(std::string_view vault_path) const {
-    auto restore_result = VaultIO::restore_from_backup(vault_path, m_backup_path);
+VaultResult<> VaultBackupPolicy::restore_from_most_recent_backup(
+    std::string_view vault_path,
+    const VaultIO::BackupValidator& accept) const {
+    wait_for_pruning();  // Don't pick a backup the worker is about to delete
+
+    const auto restore_copy = [&] { return VaultIO::restore_from_backup(vault_path, m_backup_path, accept); };
+    const auto restore_chunked = [&] { return ChunkedBackupStore::restore_most_recent(vault_path, m_backup_path); };
+    const bool chunked_first = m_store_mode != StoreMode::Copies;
+
+    auto restore_result = chunked_first ? restore_chunked() : restore_copy();
+    if (!restore_result && restore_result.error() == VaultError::FileNotFound) {
+        restore_result = chunked_first ? restore_copy() : restore_chunked();
+    }
     if (!restore_result) {
         Log::error("VaultBackupPolicy: Failed to restore backup for vault");
         return std::unexpected(restore_result.error());
@@ -93,4 +180,8 @@ VaultResult<> VaultBackupPolicy::restore_from_most_recent_backup(std::string_vie
     return {};
 }
 
+void VaultBackupPolicy::wait_for_pruning() const {
+    m_pruner->wait_idle();
+}
+
 }  // namespace KeepTower
@@ -3,10 +3,15 @@
 
 #pragma once
 
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
 
 #include "core/VaultError.h"
+#include "lib/storage/VaultIO.h"
 
 namespace keeptower {
 class VaultData;
@@ -14,6 +19,8 @@ class VaultData;
 
 namespace KeepTower {
 
+class BackupPruner;
+
 /**
  * @brief Encapsulates backup configuration and backup/restore policy actions.
  *
@@ -24,6 +31,22 @@ namespace KeepTower {
  */
 class VaultBackupPolicy {
 public:
+    /**
+     * @brief Where backups are kept.
+     */
+    enum class StoreMode : uint8_t {
+        Copies,             ///< One full copy of the vault file per backup (default)
+        Chunked,            ///< Deduplicated chunks in a ChunkedBackupStore
+        ChunkedCompressed,  ///< As Chunked, zlib-compressing chunks that shrink
+    };
+
+    /**
+     * @brief Parse a store mode setting value.
+     * @param name "copies", "chunked" or "chunked-compressed".
+     * @return Mode, or std::nullopt for an unknown name.
+     */
+    [[nodiscard]] static std::optional<StoreMode> parse_store_mode(std::string_view name);
+
     /**
      * @brief Construct backup policy with defaults matching existing behavior.
         * @param enabled True to enable automatic backups.
@@ -34,6 +57,12 @@ public:
                                int max_backups = 5,
                                std::string backup_path = "");
 
+    /** @brief Finish queued retention work before the policy goes away. */
+    ~VaultBackupPolicy();
+
+    VaultBackupPolicy(const VaultBackupPolicy&) = delete;
+    VaultBackupPolicy& operator=(const VaultBackupPolicy&) = delete;
+
     /** @brief Enable or disable automatic backups.
      *  @param enabled True to enable automatic backups. */
     void set_enabled(bool enabled);
@@ -53,6 +82,14 @@ public:
         *  @return Configured retention count. */
     [[nodiscard]] int max_backups() const;
 
+    /** @brief Select where new backups are kept.
+     *  @param mode Store for backups created from now on. */
+    void set_store_mode(StoreMode mode);
+
+    /** @brief Get the store new backups are kept in.
+     *  @return Configured store mode. */
+    [[nodiscard]] StoreMode store_mode() const;
+
         /** @brief Set custom backup directory path (empty means same directory as vault).
         *  @param path Backup directory override. */
     void set_backup_path(std::string path);
@@ -82,22 +119,47 @@ public:
     * @brief Create and rotate backups if policy allows for this save.
      *
     * The policy determines when backup work should run; the storage layer
-    * performs the underlying file and backup operations.
+    * performs the underlying file and backup operations. Retention pruning
+    * is queued on a background worker, so old backups may still exist when
+    * this returns (see wait_for_pruning()).
     * @param vault_path Vault file path being saved.
     * @param explicit_save True when the save was explicitly triggered by the user.
     * @return Success when backup is created or skipped; error when backup fails.
      */
     [[nodiscard]] VaultResult<> maybe_create_backup(std::string_view vault_path, bool explicit_save) const;
 
+    /**
+    * @brief Start maybe_create_backup() on a worker thread.
+    *
+    * Lets a save copy the current vault file while it serializes and encrypts
+    * the replacement. The copy reads the file on disk, so the caller must
+    * wait for the result before renaming the new image over it. Settings are
+    * captured when the backup starts.
+    * @param vault_path Vault file path being saved.
+    * @param explicit_save True when the save was explicitly triggered by the user.
+    * @return Future with the same result maybe_create_backup() would return;
+    *         already ready when no backup is due.
+     */
+    [[nodiscard]] std::future<VaultResult<>> begin_backup(std::string_view vault_path, bool explicit_save) const;
+
     /**
     * @brief Restore vault from most recent backup according to configured path policy.
     *
     * Uses the storage layer's compatibility-aware backup lookup so both legacy
-    * and newer backup naming conventions can be restored transparently.
+    * and newer backup naming conventions can be restored transparently. The
+    * store of the current mode is tried first; if it has no usable backup the
+    * other store is tried, so switching modes keeps older backups reachable.
     * @param vault_path Vault path whose latest backup should be restored.
+    * @param accept Optional check of a backup copy's contents; copies it
+    *        rejects are skipped in favour of older ones.
     * @return Success or an error from the restore operation.
      */
-    [[nodiscard]] VaultResult<> restore_from_most_recent_backup(std::string_view vault_path) const;
+    [[nodiscard]] VaultResult<> restore_from_most_recent_backup(
+        std::string_view vault_path,
+        const VaultIO::BackupValidator& accept = {}) const;
+
+    /** @brief Block until queued retention pruning has finished. */
+    void wait_for_pruning() const;
 
 private:
     static constexpr int kMinBackups = 1;
@@ -106,6 +168,8 @@ private:
     bool m_enabled;
     int m_max_backups;
     std::string m_backup_path;
+    StoreMode m_store_mode = StoreMode::Copies;
+    std::unique_ptr<BackupPruner> m_pruner;
 };
 
 }  // namespace KeepTower
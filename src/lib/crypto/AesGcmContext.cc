@@ -0,0 +1,137 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "lib/crypto/AesGcmContext.h"
+#include "lib/crypto/VaultCrypto.h"
+#include "utils/SecureMemory.h"
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <array>
+#include <climits>
+
+namespace KeepTower {
+
+namespace {
+
+// EVP lengths are int; larger buffers are fed in chunks
+constexpr size_t MAX_UPDATE_LENGTH = static_cast<size_t>(INT_MAX) & ~size_t{15};
+
+bool update(EVP_CIPHER_CTX* ctx, bool encrypt, const uint8_t* in, uint8_t* out, size_t size) {
+    for (size_t done = 0; done < size;) {
+        const size_t chunk = std::min(size - done, MAX_UPDATE_LENGTH);
+        int len = 0;
+        const int rc = encrypt
+            ? EVP_EncryptUpdate(ctx, out + done, &len, in + done, static_cast<int>(chunk))
+            : EVP_DecryptUpdate(ctx, out + done, &len, in + done, static_cast<int>(chunk));
+        if (rc != 1 || static_cast<size_t>(len) != chunk) {
+            return false;
+        }
+        done += chunk;
+    }
+    return true;
+}
+
+bool feed_aad(EVP_CIPHER_CTX* ctx, bool encrypt, std::span<const uint8_t> aad) {
+    if (aad.empty()) {
+        return true;
+    }
+    if (aad.size() > MAX_UPDATE_LENGTH) {
+        return false;
+    }
+    int len = 0;
+    return encrypt
+        ? EVP_EncryptUpdate(ctx, nullptr, &len, aad.data(), static_cast<int>(aad.size())) == 1
+        : EVP_DecryptUpdate(ctx, nullptr, &len, aad.data(), static_cast<int>(aad.size())) == 1;
+}
+
+}  // namespace
+
+struct AesGcmContext::State {
+    EVPCipherContextPtr encrypt;
+    EVPCipherContextPtr decrypt;
+};
+
+AesGcmContext::AesGcmContext(std::span<const uint8_t> key) {
+    if (key.size() != VaultCrypto::KEY_LENGTH) {
+        return;
+    }
+
+    auto state = std::make_unique<State>();
+    state->encrypt.reset(EVP_CIPHER_CTX_new());
+    state->decrypt.reset(EVP_CIPHER_CTX_new());
+    if (!state->encrypt || !state->decrypt ||
+        EVP_EncryptInit_ex(state->encrypt.get(), EVP_aes_256_gcm(), nullptr, key.data(), nullptr) != 1 ||
+        EVP_DecryptInit_ex(state->decrypt.get(), EVP_aes_256_gcm(), nullptr, key.data(), nullptr) != 1) {
+        return;
+    }
+    m_state = std::move(state);
+}
+
+AesGcmContext::~AesGcmContext() noexcept = default;
+AesGcmContext::AesGcmContext(AesGcmContext&&) noexcept = default;
+AesGcmContext& AesGcmContext::operator=(AesGcmContext&&) noexcept = default;
+
+bool AesGcmContext::is_valid() const noexcept {
+    return m_state != nullptr;
+}
+
+bool AesGcmContext::seal(std::span<const uint8_t> iv,
+                         std::span<uint8_t> data,
+                         std::span<uint8_t> tag,
+                         std::span<const uint8_t> aad) {
+    return seal_to(iv, data.data(), data.data(), data.size(), tag, aad);
+}
+
+bool AesGcmContext::open(std::span<const uint8_t> iv,
+                         std::span<uint8_t> data,
+                         std::span<const uint8_t> tag,
+                         std::span<const uint8_t> aad) {
+    return open_to(iv, data.data(), data.data(), data.size(), tag, aad);
+}
+
+bool AesGcmContext::seal_to(std::span<const uint8_t> iv, const uint8_t* in, uint8_t* out, size_t size,
+                            std::span<uint8_t> tag, std::span<const uint8_t> aad) {
+    if (!m_state || iv.size() != VaultCrypto::IV_LENGTH || tag.size() != VaultCrypto::TAG_LENGTH) {
+        return false;
+    }
+
+    // A null key keeps the expanded schedule; only the IV is loaded
+    EVP_CIPHER_CTX* ctx = m_state->encrypt.get();
+    int len = 0;
+    return EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, iv.data()) == 1 &&
+           feed_aad(ctx, true, aad) &&
+           update(ctx, true, in, out, size) &&
+           EVP_EncryptFinal_ex(ctx, out + size, &len) == 1 &&
+           EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG,
+                               static_cast<int>(VaultCrypto::TAG_LENGTH), tag.data()) == 1;
+}
+
+bool AesGcmContext::open_to(std::span<const uint8_t> iv, const uint8_t* in, uint8_t* out, size_t size,
+                            std::span<const uint8_t> tag, std::span<const uint8_t> aad) {
+    if (!m_state || iv.size() != VaultCrypto::IV_LENGTH || tag.size() != VaultCrypto::TAG_LENGTH) {
+        return false;
+    }
+
+    // EVP_CTRL_GCM_SET_TAG takes a mutable pointer
+    std::array<uint8_t, VaultCrypto::TAG_LENGTH> expected_tag{};
+    std::copy(tag.begin(), tag.end(), expected_tag.begin());
+
+    EVP_CIPHER_CTX* ctx = m_state->decrypt.get();
+    int len = 0;
+    const bool ok = EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, iv.data()) == 1 &&
+                    feed_aad(ctx, false, aad) &&
+                    update(ctx, false, in, out, size) &&
+                    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG,
+                                        static_cast<int>(expected_tag.size()), expected_tag.data()) == 1 &&
+                    EVP_DecryptFinal_ex(ctx, out + size, &len) == 1;
+    OPENSSL_cleanse(expected_tag.data(), expected_tag.size());
+
+    if (!ok) {
+        // Unauthenticated plaintext must not survive a failed open
+        OPENSSL_cleanse(out, size);
+    }
+    return ok;
+}
+
+}  // namespace KeepTower
@@ -0,0 +1,115 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file AesGcmContext.h
+ * @brief Reusable AES-256-GCM key context with in-place seal/open
+ */
+
+#ifndef KEEPTOWER_AES_GCM_CONTEXT_H
+#define KEEPTOWER_AES_GCM_CONTEXT_H
+
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace KeepTower {
+
+class VaultCrypto;
+
+/**
+ * @brief AES-256-GCM bound to one key, for many seal/open calls
+ *
+ * The key schedule is expanded once, when the context is constructed; each
+ * seal() or open() afterwards only loads a fresh IV. This makes per-record or
+ * per-field encryption cost little more than the cipher work itself, where
+ * VaultCrypto::encrypt_data() allocates a cipher context and re-expands the
+ * key on every call.
+ *
+ * Both operations work in place on caller-owned spans: @p data holds the
+ * plaintext before seal() and the ciphertext after it (and the reverse for
+ * open()). The tag travels separately, so callers choose the record layout.
+ *
+ * @section aes_gcm_context_security Security
+ * - IVs must never repeat under one key; the context does not track them
+ * - open() writes plaintext before the tag is checked, so on failure the
+ *   whole span is cleansed rather than left half-decrypted
+ * - The key schedule is cleansed by OpenSSL when the context is destroyed
+ *
+ * @code
+ * AesGcmContext ctx(dek);
+ * std::array<uint8_t, VaultCrypto::TAG_LENGTH> tag{};
+ * if (!ctx.is_valid() || !ctx.seal(iv, record, tag)) {
+ *     // Handle error
+ * }
+ * @endcode
+ *
+ * @note Not thread-safe: use one context per thread. Move-only.
+ */
+class AesGcmContext {
+public:
+    /**
+     * @brief Expand a key for later seal/open calls
+     * @param key AES-256 key (VaultCrypto::KEY_LENGTH bytes); the context
+     *        keeps only the expanded schedule, not a reference to @p key
+     */
+    explicit AesGcmContext(std::span<const uint8_t> key);
+    ~AesGcmContext() noexcept;
+
+    AesGcmContext(const AesGcmContext&) = delete;
+    AesGcmContext& operator=(const AesGcmContext&) = delete;
+
+    /** @brief Take over another context */
+    AesGcmContext(AesGcmContext&&) noexcept;
+
+    /** @brief Release this context's key and take over another
+     *  @return Reference to this context */
+    AesGcmContext& operator=(AesGcmContext&&) noexcept;
+
+    /** @brief Whether the key was accepted and both directions initialised
+     *  @return false for a wrongly sized key or an OpenSSL failure */
+    [[nodiscard]] bool is_valid() const noexcept;
+
+    /**
+     * @brief Encrypt @p data in place and produce its tag
+     * @param iv Unique IV (VaultCrypto::IV_LENGTH bytes)
+     * @param data Plaintext, replaced by ciphertext of the same length
+     * @param tag Receives the VaultCrypto::TAG_LENGTH byte tag
+     * @param aad Additional authenticated data (may be empty)
+     * @return true if successful
+     */
+    [[nodiscard]] bool seal(std::span<const uint8_t> iv,
+                            std::span<uint8_t> data,
+                            std::span<uint8_t> tag,
+                            std::span<const uint8_t> aad = {});
+
+    /**
+     * @brief Authenticate and decrypt @p data in place
+     * @param iv IV used by seal() (VaultCrypto::IV_LENGTH bytes)
+     * @param data Ciphertext, replaced by plaintext (cleansed on failure)
+     * @param tag Tag produced by seal() (VaultCrypto::TAG_LENGTH bytes)
+     * @param aad Additional authenticated data given to seal()
+     * @return true only if the tag verified
+     */
+    [[nodiscard]] bool open(std::span<const uint8_t> iv,
+                            std::span<uint8_t> data,
+                            std::span<const uint8_t> tag,
+                            std::span<const uint8_t> aad = {});
+
+private:
+    friend class VaultCrypto;
+
+    // Copying forms behind VaultCrypto::encrypt_data()/decrypt_data();
+    // out may equal in but must not otherwise overlap it.
+    bool seal_to(std::span<const uint8_t> iv, const uint8_t* in, uint8_t* out, size_t size,
+                 std::span<uint8_t> tag, std::span<const uint8_t> aad);
+    bool open_to(std::span<const uint8_t> iv, const uint8_t* in, uint8_t* out, size_t size,
+                 std::span<const uint8_t> tag, std::span<const uint8_t> aad);
+
+    struct State;
+    std::unique_ptr<State> m_state;
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_AES_GCM_CONTEXT_H
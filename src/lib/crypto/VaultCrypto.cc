@@ -2,13 +2,196 @@
 // Copyright (C) 2024 Travis E. Hansen
 
 #include "lib/crypto/VaultCrypto.h"
+#include "lib/crypto/AesGcmContext.h"
 #include "utils/SecureMemory.h"
+#include "utils/WorkerRanges.h"
 #include <openssl/evp.h>
 #include <openssl/rand.h>
 #include <openssl/err.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
 namespace KeepTower {
 
+namespace {
+
+// Segments handed to each worker before another thread is worth starting
+constexpr size_t MIN_SEGMENTS_PER_THREAD = 4;
+
+struct StreamParams {
+    size_t segment_size = 0;
+    size_t plaintext_size = 0;
+    size_t segment_count = 0;
+    size_t total_size = 0;
+};
+
+std::optional<StreamParams> stream_params(size_t segment_size, uint64_t plaintext_size) {
+    if (segment_size < VaultCrypto::MIN_STREAM_SEGMENT_SIZE ||
+        segment_size > VaultCrypto::MAX_STREAM_SEGMENT_SIZE ||
+        plaintext_size > SIZE_MAX / 2) {
+        return std::nullopt;
+    }
+
+    StreamParams params;
+    params.segment_size = segment_size;
+    params.plaintext_size = static_cast<size_t>(plaintext_size);
+    params.segment_count = std::max<size_t>(1, (params.plaintext_size + segment_size - 1) / segment_size);
+    if (params.segment_count > UINT32_MAX) {
+        return std::nullopt;
+    }
+    params.total_size = VaultCrypto::STREAM_HEADER_LENGTH + params.plaintext_size +
+                        params.segment_count * VaultCrypto::TAG_LENGTH;
+    return params;
+}
+
+std::array<uint8_t, VaultCrypto::STREAM_HEADER_LENGTH> encode_stream_header(const StreamParams& params) {
+    std::array<uint8_t, VaultCrypto::STREAM_HEADER_LENGTH> header{};
+    for (size_t i = 0; i < 4; ++i) {
+        header[i] = static_cast<uint8_t>(params.segment_size >> (8 * i));
+    }
+    // Bytes 4..7 are reserved and must be zero
+    for (size_t i = 0; i < 8; ++i) {
+        header[8 + i] = static_cast<uint8_t>(static_cast<uint64_t>(params.plaintext_size) >> (8 * i));
+    }
+    return header;
+}
+
+std::optional<StreamParams> decode_stream_header(std::span<const uint8_t> data) {
+    if (data.size() < VaultCrypto::STREAM_HEADER_LENGTH) {
+        return std::nullopt;
+    }
+    uint32_t segment_size = 0;
+    uint32_t reserved = 0;
+    uint64_t plaintext_size = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        segment_size |= static_cast<uint32_t>(data[i]) << (8 * i);
+        reserved |= static_cast<uint32_t>(data[4 + i]) << (8 * i);
+    }
+    for (size_t i = 0; i < 8; ++i) {
+        plaintext_size |= static_cast<uint64_t>(data[8 + i]) << (8 * i);
+    }
+    if (reserved != 0) {
+        return std::nullopt;
+    }
+    return stream_params(segment_size, plaintext_size);
+}
+
+// STREAM nonce: iv prefix || be32(segment index) || last-segment flag
+std::array<uint8_t, VaultCrypto::IV_LENGTH> segment_nonce(std::span<const uint8_t> iv, size_t index, bool last) {
+    std::array<uint8_t, VaultCrypto::IV_LENGTH> nonce{};
+    std::copy_n(iv.begin(), VaultCrypto::STREAM_NONCE_PREFIX_LENGTH, nonce.begin());
+    const auto counter = static_cast<uint32_t>(index);
+    nonce[7] = static_cast<uint8_t>(counter >> 24);
+    nonce[8] = static_cast<uint8_t>(counter >> 16);
+    nonce[9] = static_cast<uint8_t>(counter >> 8);
+    nonce[10] = static_cast<uint8_t>(counter);
+    nonce[11] = last ? 1 : 0;
+    return nonce;
+}
+
+/**
+ * Run fn(ctx, first, last) over [0, count) split into contiguous ranges,
+ * one cipher context per range (see for_each_range()).
+ */
+template <typename Fn>
+bool for_each_segment_range(size_t count, unsigned max_threads, Fn&& fn) {
+    const size_t threads = worker_count(max_threads, count, count, MIN_SEGMENTS_PER_THREAD);
+    return for_each_range(count, threads, [&fn](size_t first, size_t last) {
+        EVPCipherContextPtr ctx(EVP_CIPHER_CTX_new());
+        return ctx && fn(ctx.get(), first, last);
+    });
+}
+
+/**
+ * Write the stream header and seal every segment into out (total_size bytes).
+ * plaintext holds the contiguous plaintext, or is null when each segment
+ * already sits at its sealed position in out and is encrypted in place.
+ */
+bool seal_segments(const StreamParams& params,
+                   std::span<const uint8_t> key,
+                   std::span<const uint8_t> iv,
+                   const uint8_t* plaintext,
+                   uint8_t* out,
+                   unsigned max_threads) {
+    const auto header = encode_stream_header(params);
+    std::copy(header.begin(), header.end(), out);
+
+    const size_t sealed_stride = params.segment_size + VaultCrypto::TAG_LENGTH;
+    return for_each_segment_range(params.segment_count, max_threads,
+        [&](EVP_CIPHER_CTX* ctx, size_t first, size_t last) {
+            if (EVP_EncryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, key.data(), nullptr) != 1) {
+                return false;
+            }
+            for (size_t i = first; i < last; ++i) {
+                const size_t offset = i * params.segment_size;
+                const size_t length = std::min(params.segment_size, params.plaintext_size - offset);
+                uint8_t* sealed = out + VaultCrypto::STREAM_HEADER_LENGTH + i * sealed_stride;
+                const uint8_t* in = plaintext ? plaintext + offset : sealed;
+                const auto nonce = segment_nonce(iv, i, i + 1 == params.segment_count);
+
+                int len = 0;
+                if (EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce.data()) != 1 ||
+                    EVP_EncryptUpdate(ctx, nullptr, &len, header.data(), static_cast<int>(header.size())) != 1 ||
+                    EVP_EncryptUpdate(ctx, sealed, &len, in, static_cast<int>(length)) != 1 ||
+                    EVP_EncryptFinal_ex(ctx, sealed + len, &len) != 1 ||
+                    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_GET_TAG, VaultCrypto::TAG_LENGTH, sealed + length) != 1) {
+                    return false;
+                }
+            }
+            return true;
+        });
+}
+
+/**
+ * Authenticate and decrypt segments [first_segment, last_segment) of a
+ * validated stream into out, which receives plaintext starting at
+ * first_segment * segment_size.
+ */
+bool open_segments(std::span<const uint8_t> ciphertext,
+                   const StreamParams& params,
+                   std::span<const uint8_t> key,
+                   std::span<const uint8_t> iv,
+                   size_t first_segment,
+                   size_t last_segment,
+                   uint8_t* out,
+                   unsigned max_threads) {
+    const auto header = ciphertext.first<VaultCrypto::STREAM_HEADER_LENGTH>();
+    const size_t sealed_stride = params.segment_size + VaultCrypto::TAG_LENGTH;
+    const size_t base_offset = first_segment * params.segment_size;
+
+    return for_each_segment_range(last_segment - first_segment, max_threads,
+        [&](EVP_CIPHER_CTX* ctx, size_t first, size_t last) {
+            if (EVP_DecryptInit_ex(ctx, EVP_aes_256_gcm(), nullptr, key.data(), nullptr) != 1) {
+                return false;
+            }
+            for (size_t i = first_segment + first; i < first_segment + last; ++i) {
+                const size_t offset = i * params.segment_size;
+                const size_t length = std::min(params.segment_size, params.plaintext_size - offset);
+                const uint8_t* in = ciphertext.data() + VaultCrypto::STREAM_HEADER_LENGTH + i * sealed_stride;
+                uint8_t* dest = out + (offset - base_offset);
+                const auto nonce = segment_nonce(iv, i, i + 1 == params.segment_count);
+
+                // Tag is copied because OpenSSL's SET_TAG takes a non-const pointer
+                std::array<uint8_t, VaultCrypto::TAG_LENGTH> tag{};
+                std::copy_n(in + length, VaultCrypto::TAG_LENGTH, tag.begin());
+
+                int len = 0;
+                if (EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce.data()) != 1 ||
+                    EVP_DecryptUpdate(ctx, nullptr, &len, header.data(), static_cast<int>(header.size())) != 1 ||
+                    EVP_DecryptUpdate(ctx, dest, &len, in, static_cast<int>(length)) != 1 ||
+                    EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_GCM_SET_TAG, VaultCrypto::TAG_LENGTH, tag.data()) != 1 ||
+                    EVP_DecryptFinal_ex(ctx, dest + len, &len) != 1) {
+                    return false;
+                }
+            }
+            return true;
+        });
+}
+
+}  // namespace
+
 bool VaultCrypto::derive_key(
     const Glib::ustring& password,
     std::span<const uint8_t> salt,
@@ -39,111 +222,208 @@ bool VaultCrypto::encrypt_data(
     std::vector<uint8_t>& ciphertext,
     std::span<const uint8_t> iv) {
 
-    // Validate inputs
-    if (key.size() != KEY_LENGTH) {
+    AesGcmContext ctx(key);
+    if (!ctx.is_valid()) {
         return false;
     }
-    if (iv.size() != IV_LENGTH) {
+
+    // Encrypt straight into the output, tag appended after the ciphertext
+    ciphertext.resize(plaintext.size() + TAG_LENGTH);
+    const std::span<uint8_t> tag(ciphertext.data() + plaintext.size(), TAG_LENGTH);
+    if (!ctx.seal_to(iv, plaintext.data(), ciphertext.data(), plaintext.size(), tag, {})) {
+        ciphertext.clear();
         return false;
     }
+    return true;
+}
 
-    KeepTower::EVPCipherContextPtr ctx(EVP_CIPHER_CTX_new());
-    if (!ctx) {
+bool VaultCrypto::decrypt_data(
+    std::span<const uint8_t> ciphertext,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> iv,
+    std::vector<uint8_t>& plaintext) {
+
+    if (ciphertext.size() < TAG_LENGTH) {
+        return false;
+    }
+    AesGcmContext ctx(key);
+    if (!ctx.is_valid()) {
         return false;
     }
 
-    // Initialize encryption with AES-256-GCM
-    if (EVP_EncryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, key.data(), iv.data()) != 1) {
+    // Decrypt straight from the caller's ciphertext; nothing is staged
+    const size_t size = ciphertext.size() - TAG_LENGTH;
+    plaintext.resize(size);
+    if (!ctx.open_to(iv, ciphertext.data(), plaintext.data(), size, ciphertext.last(TAG_LENGTH), {})) {
+        plaintext.clear();
         return false;
     }
+    return true;
+}
 
-    // Allocate output buffer
-    ciphertext.resize(plaintext.size() + EVP_CIPHER_block_size(EVP_aes_256_gcm()) + TAG_LENGTH);
-    int len = 0;
-    int ciphertext_len = 0;
+bool VaultCrypto::seal(
+    std::span<uint8_t> data,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> iv,
+    std::span<uint8_t> tag,
+    std::span<const uint8_t> aad) {
+    AesGcmContext ctx(key);
+    return ctx.is_valid() && ctx.seal(iv, data, tag, aad);
+}
 
-    // Encrypt
-    if (EVP_EncryptUpdate(ctx.get(), ciphertext.data(), &len, plaintext.data(), plaintext.size()) != 1) {
+bool VaultCrypto::open(
+    std::span<uint8_t> data,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> iv,
+    std::span<const uint8_t> tag,
+    std::span<const uint8_t> aad) {
+    AesGcmContext ctx(key);
+    if (!ctx.is_valid()) {
+        OPENSSL_cleanse(data.data(), data.size());
         return false;
     }
-    ciphertext_len = len;
+    return ctx.open(iv, data, tag, aad);
+}
+
+bool VaultCrypto::encrypt_stream(
+    std::span<const uint8_t> plaintext,
+    std::span<const uint8_t> key,
+    std::vector<uint8_t>& ciphertext,
+    std::span<const uint8_t> iv,
+    size_t segment_size,
+    unsigned max_threads) {
 
-    // Finalize
-    if (EVP_EncryptFinal_ex(ctx.get(), ciphertext.data() + len, &len) != 1) {
+    if (key.size() != KEY_LENGTH || iv.size() != IV_LENGTH) {
         return false;
     }
-    ciphertext_len += len;
-
-    // Get authentication tag (GCM) - use SecureVector for auto-zeroization
-    KeepTower::SecureVector<uint8_t> tag(TAG_LENGTH);
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_GET_TAG, TAG_LENGTH, tag.data()) != 1) {
+    const auto params = stream_params(segment_size, plaintext.size());
+    if (!params) {
         return false;
     }
 
-    // Append tag to ciphertext
-    ciphertext.resize(ciphertext_len);
-    ciphertext.insert(ciphertext.end(), tag.begin(), tag.end());
-
-    return true;
+    ciphertext.resize(params->total_size);
+    const bool ok = seal_segments(*params, key, iv, plaintext.data(), ciphertext.data(), max_threads);
+    if (!ok) {
+        ciphertext.clear();
+    }
+    return ok;
 }
 
-bool VaultCrypto::decrypt_data(
-    std::span<const uint8_t> ciphertext,
+bool VaultCrypto::encrypt_stream_in_place(
+    std::span<uint8_t> buffer,
+    size_t plaintext_size,
     std::span<const uint8_t> key,
     std::span<const uint8_t> iv,
-    std::vector<uint8_t>& plaintext) {
+    size_t segment_size,
+    unsigned max_threads) {
 
-    // Validate inputs
-    if (key.size() != KEY_LENGTH) {
+    const auto params = stream_params(segment_size, plaintext_size);
+    if (!params || buffer.size() != params->total_size) {
+        OPENSSL_cleanse(buffer.data(), buffer.size());
         return false;
     }
-    if (iv.size() != IV_LENGTH) {
-        return false;
-    }
-    if (ciphertext.size() < TAG_LENGTH) {
+    if (key.size() != KEY_LENGTH || iv.size() != IV_LENGTH) {
+        OPENSSL_cleanse(buffer.data(), buffer.size());
         return false;
     }
 
-    // Extract authentication tag (last TAG_LENGTH bytes)
-    // Use SecureVector for tag (contains key-derived authentication data)
-    KeepTower::SecureVector<uint8_t> tag(ciphertext.end() - TAG_LENGTH, ciphertext.end());
-    KeepTower::SecureVector<uint8_t> actual_ciphertext(ciphertext.begin(), ciphertext.end() - TAG_LENGTH);
+    // Spread the plaintext from the tail into its segment slots. Slot i ends
+    // no later than plaintext segment i + 1 begins, so front-to-back moves
+    // never clobber bytes still to be moved.
+    const size_t sealed_stride = params->segment_size + TAG_LENGTH;
+    const size_t plaintext_offset = params->total_size - params->plaintext_size;
+    for (size_t i = 0; i < params->segment_count; ++i) {
+        const size_t offset = i * params->segment_size;
+        const size_t length = std::min(params->segment_size, params->plaintext_size - offset);
+        std::memmove(buffer.data() + STREAM_HEADER_LENGTH + i * sealed_stride,
+                     buffer.data() + plaintext_offset + offset, length);
+    }
 
-    KeepTower::EVPCipherContextPtr ctx(EVP_CIPHER_CTX_new());
-    if (!ctx) {
-        return false;
+    const bool ok = seal_segments(*params, key, iv, nullptr, buffer.data(), max_threads);
+    if (!ok) {
+        OPENSSL_cleanse(buffer.data(), buffer.size());
     }
+    return ok;
+}
 
-    // Initialize decryption with AES-256-GCM
-    if (EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_gcm(), nullptr, key.data(), iv.data()) != 1) {
-        return false;
+std::optional<size_t> VaultCrypto::sealed_stream_size(size_t plaintext_size, size_t segment_size) {
+    const auto params = stream_params(segment_size, plaintext_size);
+    if (!params) {
+        return std::nullopt;
     }
+    return params->total_size;
+}
 
-    // Allocate output buffer
-    plaintext.resize(actual_ciphertext.size() + EVP_CIPHER_block_size(EVP_aes_256_gcm()));
-    int len = 0;
-    int plaintext_len = 0;
+bool VaultCrypto::decrypt_stream(
+    std::span<const uint8_t> ciphertext,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> iv,
+    std::vector<uint8_t>& plaintext,
+    unsigned max_threads) {
 
-    // Decrypt
-    if (EVP_DecryptUpdate(ctx.get(), plaintext.data(), &len, actual_ciphertext.data(), actual_ciphertext.size()) != 1) {
+    if (key.size() != KEY_LENGTH || iv.size() != IV_LENGTH) {
         return false;
     }
-    plaintext_len = len;
-
-    // Set authentication tag
-    if (EVP_CIPHER_CTX_ctrl(ctx.get(), EVP_CTRL_GCM_SET_TAG, TAG_LENGTH, tag.data()) != 1) {
+    const auto params = decode_stream_header(ciphertext);
+    if (!params || params->total_size != ciphertext.size()) {
         return false;
     }
 
-    // Finalize (verifies authentication tag)
-    if (EVP_DecryptFinal_ex(ctx.get(), plaintext.data() + len, &len) != 1) {
+    plaintext.resize(params->plaintext_size);
+    const bool ok = open_segments(ciphertext, *params, key, iv, 0, params->segment_count,
+                                  plaintext.data(), max_threads);
+    if (!ok) {
+        OPENSSL_cleanse(plaintext.data(), plaintext.size());
+        plaintext.clear();
+    }
+    return ok;
+}
+
+bool VaultCrypto::decrypt_stream_range(
+    std::span<const uint8_t> ciphertext,
+    std::span<const uint8_t> key,
+    std::span<const uint8_t> iv,
+    size_t offset,
+    size_t length,
+    std::vector<uint8_t>& plaintext,
+    unsigned max_threads) {
+
+    plaintext.clear();
+    if (key.size() != KEY_LENGTH || iv.size() != IV_LENGTH) {
+        return false;
+    }
+    const auto params = decode_stream_header(ciphertext);
+    if (!params || params->total_size != ciphertext.size() || offset > params->plaintext_size) {
         return false;
     }
-    plaintext_len += len;
+    length = std::min(length, params->plaintext_size - offset);
 
-    plaintext.resize(plaintext_len);
+    // Whole segments covering [offset, offset + length); an empty range still
+    // authenticates the segment it falls into
+    const size_t first_segment = std::min(offset / params->segment_size, params->segment_count - 1);
+    const size_t last_segment = std::max(first_segment + 1,
+        std::min(params->segment_count,
+                 (offset + length + params->segment_size - 1) / params->segment_size));
+    const size_t covered_begin = first_segment * params->segment_size;
+    const size_t covered_end = std::min(last_segment * params->segment_size, params->plaintext_size);
 
-    return true;
+    std::vector<uint8_t> covered(covered_end - covered_begin);
+    const bool ok = open_segments(ciphertext, *params, key, iv, first_segment, last_segment,
+                                  covered.data(), max_threads);
+    if (ok) {
+        const auto begin = covered.begin() + static_cast<std::ptrdiff_t>(offset - covered_begin);
+        plaintext.assign(begin, begin + static_cast<std::ptrdiff_t>(length));
+    }
+    OPENSSL_cleanse(covered.data(), covered.size());
+    return ok;
+}
+
+std::optional<size_t> VaultCrypto::stream_ciphertext_size(std::span<const uint8_t> stream_prefix) {
+    const auto params = decode_stream_header(stream_prefix);
+    if (!params) {
+        return std::nullopt;
+    }
+    return params->total_size;
 }
 
 std::vector<uint8_t> VaultCrypto::generate_random_bytes(size_t length) {
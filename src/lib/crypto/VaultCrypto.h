@@ -8,6 +8,7 @@
 #include <span>
 #include <glibmm/ustring.h>
 #include <cstdint>
+#include <optional>
 
 // Forward declare SecureVector to avoid pulling in OpenSSL headers
 namespace KeepTower {
@@ -25,9 +26,12 @@ namespace KeepTower {
  * Provides NIST-compliant cryptographic primitives for vault data protection:
  * - PBKDF2-HMAC-SHA256 key derivation
  * - AES-256-GCM authenticated encryption
+ * - Segmented (STREAM) AES-256-GCM for large payloads, parallelised across cores
  * - Cryptographically secure random generation
  *
- * This class is stateless and thread-safe. All methods are static.
+ * This class is stateless and thread-safe. All methods are static; callers
+ * encrypting many buffers under one key keep an AesGcmContext instead, which
+ * expands the key schedule once.
  *
  * @section vault_crypto_security Security Features
  * - NIST SP 800-132 compliant key derivation
@@ -70,6 +74,13 @@ public:
     static constexpr size_t TAG_LENGTH = 16;        ///< GCM authentication tag length (128 bits)
     static constexpr int DEFAULT_PBKDF2_ITERATIONS = 600000;  ///< NIST recommended minimum (2023)
 
+    // Segmented payload constants
+    static constexpr size_t STREAM_HEADER_LENGTH = 16;           ///< Segment size (u32) + reserved (u32) + plaintext size (u64)
+    static constexpr size_t STREAM_NONCE_PREFIX_LENGTH = 7;      ///< IV bytes shared by all segment nonces
+    static constexpr size_t MIN_STREAM_SEGMENT_SIZE = 1024;      ///< Smallest accepted segment size
+    static constexpr size_t MAX_STREAM_SEGMENT_SIZE = 16 * 1024 * 1024;  ///< Largest accepted segment size
+    static constexpr size_t DEFAULT_STREAM_SEGMENT_SIZE = 64 * 1024;     ///< Default segment size (64 KiB)
+
     /**
      * @brief Derive encryption key from password using PBKDF2-HMAC-SHA256
      *
@@ -128,6 +139,167 @@ public:
         std::span<const uint8_t> iv,
         std::vector<uint8_t>& plaintext);
 
+    /**
+     * @brief Encrypt a buffer in place with AES-256-GCM
+     *
+     * Unlike encrypt_data(), nothing is allocated: @p data is overwritten with
+     * ciphertext of the same length and the tag goes to @p tag. Use an
+     * AesGcmContext instead when sealing many buffers under one key.
+     *
+     * @param data Plaintext, replaced by ciphertext
+     * @param key Encryption key (must be KEY_LENGTH bytes)
+     * @param iv Unique IV (must be IV_LENGTH bytes)
+     * @param tag Receives the TAG_LENGTH byte authentication tag
+     * @param aad Additional authenticated data (may be empty)
+     * @return true if successful, false on error
+     */
+    [[nodiscard]] static bool seal(
+        std::span<uint8_t> data,
+        std::span<const uint8_t> key,
+        std::span<const uint8_t> iv,
+        std::span<uint8_t> tag,
+        std::span<const uint8_t> aad = {});
+
+    /**
+     * @brief Authenticate and decrypt a buffer in place with AES-256-GCM
+     *
+     * @param data Ciphertext, replaced by plaintext (cleansed on failure)
+     * @param key Decryption key (must be KEY_LENGTH bytes)
+     * @param iv IV used for sealing (must be IV_LENGTH bytes)
+     * @param tag Authentication tag from seal() (TAG_LENGTH bytes)
+     * @param aad Additional authenticated data given to seal()
+     * @return true only if the tag verified
+     */
+    [[nodiscard]] static bool open(
+        std::span<uint8_t> data,
+        std::span<const uint8_t> key,
+        std::span<const uint8_t> iv,
+        std::span<const uint8_t> tag,
+        std::span<const uint8_t> aad = {});
+
+    /**
+     * @brief Encrypt data as independently authenticated AES-256-GCM segments
+     *
+     * Implements the STREAM construction (Hoang, Reyhanitabar, Rogaway, Vizár):
+     * the plaintext is split into @p segment_size chunks, and segment i is
+     * sealed under the nonce `iv[0..7) || be32(i) || last_flag`. The 16-byte
+     * stream header (segment size, reserved zero word, plaintext size) is fed
+     * to every segment as AAD, so segments cannot be reordered, dropped,
+     * truncated at a segment boundary, or re-parsed with other parameters.
+     *
+     * Output layout:
+     * @code
+     * [stream header: 16][segment 0 + tag]...[segment N-1 + tag]
+     * @endcode
+     * All segments except the last hold exactly @p segment_size bytes, so
+     * every segment offset is computable and segments are processed in
+     * parallel.
+     *
+     * @param plaintext Data to encrypt (may be empty: one empty segment is written)
+     * @param key Encryption key (must be KEY_LENGTH bytes)
+     * @param ciphertext Output stream (header followed by sealed segments)
+     * @param iv Random IV (IV_LENGTH bytes); its first STREAM_NONCE_PREFIX_LENGTH
+     *        bytes prefix every segment nonce and must be unique per key
+     * @param segment_size Plaintext bytes per segment
+     *        (MIN_STREAM_SEGMENT_SIZE..MAX_STREAM_SEGMENT_SIZE)
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return true if successful, false on error
+     */
+    [[nodiscard]] static bool encrypt_stream(
+        std::span<const uint8_t> plaintext,
+        std::span<const uint8_t> key,
+        std::vector<uint8_t>& ciphertext,
+        std::span<const uint8_t> iv,
+        size_t segment_size = DEFAULT_STREAM_SEGMENT_SIZE,
+        unsigned max_threads = 0);
+
+    /**
+     * @brief Seal a segmented payload inside a single buffer
+     *
+     * Produces the same stream as encrypt_stream() without a second
+     * buffer: the caller serializes the plaintext into the last
+     * @p plaintext_size bytes of @p buffer, and each segment is moved to
+     * its sealed position and encrypted in place. Afterwards @p buffer
+     * holds only the stream; on failure it is cleansed.
+     *
+     * @param buffer Exactly sealed_stream_size(plaintext_size, segment_size) bytes
+     * @param plaintext_size Plaintext length, stored at the end of @p buffer
+     * @param key Encryption key (must be KEY_LENGTH bytes)
+     * @param iv Random IV (IV_LENGTH bytes), as for encrypt_stream()
+     * @param segment_size Plaintext bytes per segment
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return true if successful, false on error
+     */
+    [[nodiscard]] static bool encrypt_stream_in_place(
+        std::span<uint8_t> buffer,
+        size_t plaintext_size,
+        std::span<const uint8_t> key,
+        std::span<const uint8_t> iv,
+        size_t segment_size = DEFAULT_STREAM_SEGMENT_SIZE,
+        unsigned max_threads = 0);
+
+    /**
+     * @brief Length of the stream encrypt_stream() produces for a plaintext size
+     * @param plaintext_size Plaintext length in bytes
+     * @param segment_size Plaintext bytes per segment
+     * @return Stream length, or nullopt for unsupported parameters
+     */
+    [[nodiscard]] static std::optional<size_t> sealed_stream_size(
+        size_t plaintext_size,
+        size_t segment_size = DEFAULT_STREAM_SEGMENT_SIZE);
+
+    /**
+     * @brief Decrypt and authenticate a segmented payload from encrypt_stream()
+     *
+     * @param ciphertext Complete stream (header and all segments, nothing more)
+     * @param key Decryption key (must be KEY_LENGTH bytes)
+     * @param iv IV used for encryption (IV_LENGTH bytes)
+     * @param plaintext Output decrypted data (cleared on failure)
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return true only if every segment authenticated
+     */
+    [[nodiscard]] static bool decrypt_stream(
+        std::span<const uint8_t> ciphertext,
+        std::span<const uint8_t> key,
+        std::span<const uint8_t> iv,
+        std::vector<uint8_t>& plaintext,
+        unsigned max_threads = 0);
+
+    /**
+     * @brief Decrypt part of a segmented payload without opening the rest
+     *
+     * Only the segments overlapping the requested plaintext range are
+     * authenticated and decrypted, so a leading index can be read before the
+     * bulk of the stream. Every opened segment is still bound to its position
+     * and to the stream header, so a successful range read is as trustworthy
+     * as the same bytes from decrypt_stream().
+     *
+     * @param ciphertext Complete stream (header and all segments, nothing more)
+     * @param key Decryption key (must be KEY_LENGTH bytes)
+     * @param iv IV used for encryption (IV_LENGTH bytes)
+     * @param offset First plaintext byte to return
+     * @param length Bytes to return (clamped to the end of the plaintext)
+     * @param plaintext Output bytes [offset, offset + length) (empty on failure)
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return true only if every covering segment authenticated
+     */
+    [[nodiscard]] static bool decrypt_stream_range(
+        std::span<const uint8_t> ciphertext,
+        std::span<const uint8_t> key,
+        std::span<const uint8_t> iv,
+        size_t offset,
+        size_t length,
+        std::vector<uint8_t>& plaintext,
+        unsigned max_threads = 0);
+
+    /**
+     * @brief Total length of a segmented payload, from its stream header
+     * @param stream_prefix At least the first STREAM_HEADER_LENGTH bytes of the stream
+     * @return Stream length in bytes, or nullopt if the header is malformed
+     */
+    [[nodiscard]] static std::optional<size_t> stream_ciphertext_size(
+        std::span<const uint8_t> stream_prefix);
+
     /**
      * @brief Generate cryptographically secure random bytes
      *
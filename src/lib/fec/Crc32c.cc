@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "lib/fec/Crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define KEEPTOWER_CRC32C_X86 1
+#include <immintrin.h>
+#else
+#define KEEPTOWER_CRC32C_X86 0
+#endif
+
+namespace KeepTower {
+
+namespace {
+
+constexpr uint32_t CASTAGNOLI_REFLECTED = 0x82F63B78;
+
+constexpr std::array<uint32_t, 256> make_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ ((crc & 1) ? CASTAGNOLI_REFLECTED : 0);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 256> TABLE = make_table();
+
+uint32_t update_table(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+    for (size_t i = 0; i < size; ++i) {
+        crc = TABLE[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if KEEPTOWER_CRC32C_X86
+__attribute__((target("sse4.2")))
+uint32_t update_sse42(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+    uint64_t crc64 = crc;
+    for (; size >= 8; size -= 8, data += 8) {
+        uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; size > 0; --size, ++data) {
+        crc = _mm_crc32_u8(crc, *data);
+    }
+    return crc;
+}
+#endif
+
+}  // namespace
+
+bool crc32c_hardware_accelerated() noexcept {
+#if KEEPTOWER_CRC32C_X86
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+}
+
+uint32_t crc32c(std::span<const uint8_t> data) noexcept {
+#if KEEPTOWER_CRC32C_X86
+    static const bool hardware = crc32c_hardware_accelerated();
+    if (hardware) {
+        return ~update_sse42(~0u, data.data(), data.size());
+    }
+#endif
+    return ~update_table(~0u, data.data(), data.size());
+}
+
+}  // namespace KeepTower
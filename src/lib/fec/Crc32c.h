@@ -0,0 +1,35 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file Crc32c.h
+ * @brief CRC-32C (Castagnoli) checksums for FEC segments
+ */
+
+#ifndef KEEPTOWER_CRC32C_H
+#define KEEPTOWER_CRC32C_H
+
+#include <cstdint>
+#include <span>
+
+namespace KeepTower {
+
+/**
+ * @brief CRC-32C of a buffer.
+ *
+ * Uses the SSE4.2 crc32 instruction when the running CPU has it and a
+ * table-driven loop otherwise; both give the same (iSCSI/ext4) checksum,
+ * so values stored on disk do not depend on the machine that wrote them.
+ *
+ * @param data Bytes to checksum
+ * @return CRC-32C (0xE3069283 for "123456789")
+ */
+[[nodiscard]] uint32_t crc32c(std::span<const uint8_t> data) noexcept;
+
+/** @brief Whether crc32c() runs on the SSE4.2 instruction
+ *  @return true if hardware accelerated */
+[[nodiscard]] bool crc32c_hardware_accelerated() noexcept;
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_CRC32C_H
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file GF256.h
+ * @brief Compile-time GF(2^8) arithmetic tables for the Reed-Solomon codec
+ *
+ * The field is generated by the CCSDS primitive polynomial
+ * x^8 + x^7 + x^2 + x + 1 (0x187) with alpha = x, which is what vaults
+ * written through libcorrect's correct_rs_primitive_polynomial_ccsds use.
+ */
+
+#ifndef KEEPTOWER_GF256_H
+#define KEEPTOWER_GF256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace KeepTower::gf256 {
+
+inline constexpr uint16_t PRIMITIVE_POLYNOMIAL = 0x187;  ///< CCSDS field polynomial
+inline constexpr size_t FIELD_ORDER = 255;               ///< Non-zero field elements
+
+/**
+ * @brief Antilog/log tables.
+ *
+ * exp is doubled so exp[log[a] + log[b]] needs no modular reduction.
+ * log[0] is unused.
+ */
+struct LogTables {
+    std::array<uint8_t, 2 * FIELD_ORDER> exp{};
+    std::array<uint8_t, 256> log{};
+};
+
+constexpr LogTables make_log_tables() {
+    LogTables tables;
+    unsigned element = 1;
+    for (size_t i = 0; i < FIELD_ORDER; ++i) {
+        tables.exp[i] = static_cast<uint8_t>(element);
+        tables.exp[i + FIELD_ORDER] = static_cast<uint8_t>(element);
+        tables.log[element] = static_cast<uint8_t>(i);
+        element <<= 1;
+        if (element & 0x100) {
+            element ^= PRIMITIVE_POLYNOMIAL;
+        }
+    }
+    return tables;
+}
+
+inline constexpr LogTables LOG_TABLES = make_log_tables();
+
+/** @brief alpha^power for any non-negative power */
+constexpr uint8_t exp(size_t power) {
+    return LOG_TABLES.exp[power % FIELD_ORDER];
+}
+
+/** @brief Discrete logarithm of a non-zero element */
+constexpr uint8_t log(uint8_t value) {
+    return LOG_TABLES.log[value];
+}
+
+constexpr uint8_t mul(uint8_t a, uint8_t b) {
+    if (a == 0 || b == 0) {
+        return 0;
+    }
+    return LOG_TABLES.exp[LOG_TABLES.log[a] + LOG_TABLES.log[b]];
+}
+
+/** @brief a / b for non-zero b */
+constexpr uint8_t div(uint8_t a, uint8_t b) {
+    if (a == 0) {
+        return 0;
+    }
+    return LOG_TABLES.exp[LOG_TABLES.log[a] + FIELD_ORDER - LOG_TABLES.log[b]];
+}
+
+/**
+ * @brief Split-nibble product tables.
+ *
+ * Row c holds c * n for n = 0..15 followed by c * (n << 4), so
+ * c * x == row[x & 15] ^ row[16 + (x >> 4)]. Each half is one 16-byte
+ * PSHUFB lookup table.
+ */
+struct alignas(32) NibbleTables {
+    std::array<std::array<uint8_t, 32>, 256> rows{};
+};
+
+constexpr NibbleTables make_nibble_tables() {
+    NibbleTables tables;
+    for (unsigned c = 0; c < 256; ++c) {
+        for (unsigned n = 0; n < 16; ++n) {
+            tables.rows[c][n] = mul(static_cast<uint8_t>(c), static_cast<uint8_t>(n));
+            tables.rows[c][16 + n] = mul(static_cast<uint8_t>(c), static_cast<uint8_t>(n << 4));
+        }
+    }
+    return tables;
+}
+
+inline constexpr NibbleTables NIBBLE_TABLES = make_nibble_tables();
+
+static_assert(mul(0x80, 2) == (0x100 ^ PRIMITIVE_POLYNOMIAL), "alpha must be x");
+static_assert(log(exp(FIELD_ORDER - 1)) == FIELD_ORDER - 1, "alpha must be primitive");
+
+}  // namespace KeepTower::gf256
+
+#endif  // KEEPTOWER_GF256_H
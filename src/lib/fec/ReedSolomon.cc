@@ -2,14 +2,26 @@
 // SPDX-FileCopyrightText: 2025 tjdeveng
 
 #include "lib/fec/ReedSolomon.h"
-
-extern "C" {
-#include <correct.h>
-}
+#include "lib/fec/RsCodec.h"
+#include "lib/fec/Crc32c.h"
+#include "utils/WorkerRanges.h"
 
 #include <stdexcept>
 #include <cstring>
 #include <algorithm>
+#include <array>
+#include <atomic>
+
+namespace {
+
+// Below this a worker costs more to start than it saves
+constexpr size_t MIN_CODEWORDS_PER_THREAD = 1024;
+
+}  // namespace
+
+// Groups start at codeword-aligned stored offsets, so with one segment per
+// codeword a segment never straddles two groups (or two workers)
+static_assert(ReedSolomon::CHECKSUM_SEGMENT_SIZE == 255);
 
 ReedSolomon::ReedSolomon(uint8_t redundancy_percent)
     : m_redundancy_percent(redundancy_percent) {
@@ -35,38 +47,84 @@ bool ReedSolomon::set_redundancy_percent(uint8_t percent) {
     return true;
 }
 
-size_t ReedSolomon::calculate_encoded_size(size_t input_size) const {
-    // Calculate number of blocks needed
-    size_t num_blocks = (input_size + OPTIMAL_BLOCK_SIZE - 1) / OPTIMAL_BLOCK_SIZE;
-    size_t padded_size = num_blocks * OPTIMAL_BLOCK_SIZE;
+uint32_t ReedSolomon::parity_symbols_for(uint8_t redundancy_percent) {
+    // parity / (255 - parity) ~= percent / 100, rounded to nearest
+    const uint32_t percent = redundancy_percent;
+    uint32_t parity = (RS_BLOCK_SIZE * percent + (100 + percent) / 2) / (100 + percent);
+    // An even length spends every parity byte on correction capacity
+    parity += parity & 1;
+    return std::clamp<uint32_t>(parity, 2, RS_BLOCK_SIZE - 1);
+}
 
-    // Add parity based on redundancy percentage
-    size_t parity_size = (padded_size * m_redundancy_percent + 99) / 100;
+size_t ReedSolomon::calculate_encoded_size(size_t input_size) const {
+    if (input_size == 0) {
+        return 0;
+    }
+    return stored_size(make_layout(input_size, get_parity_symbols(), 0), input_size);
+}
 
-    return padded_size + parity_size;
+size_t ReedSolomon::encoded_size(uint32_t original_size, uint32_t parity_symbols) {
+    if (original_size == 0 || parity_symbols == 0 || parity_symbols >= RS_BLOCK_SIZE) {
+        return 0;
+    }
+    return stored_size(make_layout(original_size, parity_symbols, 1), original_size);
 }
 
-uint32_t ReedSolomon::calculate_parity_blocks(uint32_t data_blocks) const {
-    // Calculate parity blocks based on redundancy percentage
-    return (data_blocks * m_redundancy_percent + 99) / 100;
+ReedSolomon::Layout ReedSolomon::make_layout(size_t original_size, size_t parity, size_t depth) {
+    Layout layout;
+    layout.parity = parity;
+    layout.data_symbols = RS_BLOCK_SIZE - parity;
+    layout.codewords = (original_size + layout.data_symbols - 1) / layout.data_symbols;
+    layout.tail_data = original_size - (layout.codewords - 1) * layout.data_symbols;
+    if (depth == 0) {
+        // Spread codewords evenly so the last group is not left nearly empty
+        const size_t groups = (layout.codewords + MAX_INTERLEAVE_DEPTH - 1) / MAX_INTERLEAVE_DEPTH;
+        depth = (layout.codewords + groups - 1) / groups;
+    }
+    layout.depth = depth;
+    return layout;
 }
 
-std::vector<uint8_t> ReedSolomon::pad_data(const std::vector<uint8_t>& data) const {
-    size_t num_blocks = (data.size() + OPTIMAL_BLOCK_SIZE - 1) / OPTIMAL_BLOCK_SIZE;
-    size_t padded_size = num_blocks * OPTIMAL_BLOCK_SIZE;
+size_t ReedSolomon::group_stored_size(const Layout& layout, size_t first) {
+    const size_t count = std::min(layout.depth, layout.codewords - first);
+    const bool shortened = first + count == layout.codewords;
+    // The shortened codeword's implicit zeros are not stored
+    return count * RS_BLOCK_SIZE - (shortened ? layout.data_symbols - layout.tail_data : 0);
+}
 
-    std::vector<uint8_t> padded(padded_size, 0);
-    std::copy(data.begin(), data.end(), padded.begin());
+void ReedSolomon::interleave_group(const Layout& layout, size_t first, const uint8_t* codewords, uint8_t* out) {
+    const size_t count = std::min(layout.depth, layout.codewords - first);
+    const bool shortened = first + count == layout.codewords;
+    // The shortened codeword starts at this symbol; earlier ones are implicit zeros
+    const size_t tail_start = layout.data_symbols - layout.tail_data;
 
-    return padded;
+    for (size_t symbol = 0; symbol < RS_BLOCK_SIZE; ++symbol) {
+        const size_t lanes = shortened && symbol < tail_start ? count - 1 : count;
+        for (size_t i = 0; i < lanes; ++i) {
+            *out++ = codewords[i * RS_BLOCK_SIZE + symbol];
+        }
+    }
 }
 
-std::vector<uint8_t> ReedSolomon::unpad_data(const std::vector<uint8_t>& data, uint32_t original_size) const {
-    if (original_size > data.size()) {
-        return {};
+void ReedSolomon::deinterleave_group(const Layout& layout, size_t first, const uint8_t* stored, uint8_t* out,
+                                     size_t symbols) {
+    const size_t count = std::min(layout.depth, layout.codewords - first);
+    const bool shortened = first + count == layout.codewords;
+    const size_t tail_start = layout.data_symbols - layout.tail_data;
+    if (shortened) {
+        std::memset(out + (count - 1) * symbols, 0, std::min(tail_start, symbols));
     }
 
-    return std::vector<uint8_t>(data.begin(), data.begin() + original_size);
+    for (size_t symbol = 0; symbol < RS_BLOCK_SIZE; ++symbol) {
+        const size_t lanes = shortened && symbol < tail_start ? count - 1 : count;
+        if (symbol >= symbols) {
+            stored += lanes;
+            continue;
+        }
+        for (size_t i = 0; i < lanes; ++i) {
+            out[i * symbols + symbol] = *stored++;
+        }
+    }
 }
 
 std::expected<ReedSolomon::EncodedData, ReedSolomon::Error>
@@ -74,122 +132,239 @@ ReedSolomon::encode(const std::vector<uint8_t>& data) {
     if (data.empty()) {
         return std::unexpected(Error::INVALID_DATA);
     }
-
-    // Pad data to block boundaries
-    auto padded = pad_data(data);
-
-    // Calculate block configuration
-    uint32_t num_data_blocks = padded.size() / OPTIMAL_BLOCK_SIZE;
-    uint32_t num_parity_blocks = calculate_parity_blocks(num_data_blocks);
-
-    // Use RS(255, 223) encoding
-    // 223 data bytes + 32 parity bytes per block
-    const size_t RS_BLOCK_SIZE = 255;
-    const size_t RS_DATA_SIZE = 223;
-    const size_t RS_PARITY_SIZE = RS_BLOCK_SIZE - RS_DATA_SIZE;
-
-    // Create RS encoder
-    correct_reed_solomon* rs = correct_reed_solomon_create(
-        correct_rs_primitive_polynomial_ccsds,
-        1,  // first consecutive root
-        1,  // generator root gap
-        RS_PARITY_SIZE  // number of parity bytes
-    );
-
-    if (!rs) {
-        return std::unexpected(Error::LIBCORRECT_ERROR);
+    if (data.size() > UINT32_MAX) {
+        return std::unexpected(Error::BLOCK_SIZE_TOO_LARGE);
     }
 
-    // Allocate output buffer
-    size_t encoded_size = num_data_blocks * RS_BLOCK_SIZE;
-    std::vector<uint8_t> encoded_data(encoded_size);
-
-    // Encode each block
-    for (uint32_t i = 0; i < num_data_blocks; ++i) {
-        const uint8_t* data_block = padded.data() + (i * RS_DATA_SIZE);
-        uint8_t* encoded_block = encoded_data.data() + (i * RS_BLOCK_SIZE);
-
-        // Copy data portion
-        std::memcpy(encoded_block, data_block, RS_DATA_SIZE);
-
-        // Encode to generate parity
-        ssize_t result = correct_reed_solomon_encode(
-            rs,
-            data_block,
-            RS_DATA_SIZE,
-            encoded_block
-        );
+    const Layout layout = make_layout(data.size(), get_parity_symbols(), 0);
+    const size_t k = layout.data_symbols;
+    const KeepTower::RsCodec& rs = KeepTower::RsCodec::shared(layout.parity);
 
-        if (result < 0) {
-            correct_reed_solomon_destroy(rs);
-            return std::unexpected(Error::ENCODING_FAILED);
+    EncodedData result;
+    result.data.resize(stored_size(layout, data.size()));
+    result.checksums.resize(checksum_count(result.data.size()));
+
+    const size_t groups = group_count(layout);
+    const size_t threads = KeepTower::worker_count(m_max_threads, groups, layout.codewords, MIN_CODEWORDS_PER_THREAD);
+    const bool ok = KeepTower::for_each_range(groups, threads, [&](size_t first_group, size_t last_group) {
+        std::vector<uint8_t> message(layout.depth * k);
+        std::vector<uint8_t> codewords(layout.depth * RS_BLOCK_SIZE);
+
+        for (size_t group = first_group; group < last_group; ++group) {
+            const size_t first = group * layout.depth;
+            const size_t count = std::min(layout.depth, layout.codewords - first);
+
+            // Message symbols per codeword; the last codeword's data is
+            // right-aligned behind zeros that are never stored
+            const uint8_t* input = data.data() + first * k;
+            if (first + count == layout.codewords) {
+                const size_t head = (count - 1) * k;
+                std::memcpy(message.data(), input, head);
+                std::memset(message.data() + head, 0, k - layout.tail_data);
+                std::memcpy(message.data() + head + k - layout.tail_data, input + head, layout.tail_data);
+            } else {
+                std::memcpy(message.data(), input, count * k);
+            }
+            if (!rs.encode(std::span(message).first(count * k), std::span(codewords).first(count * RS_BLOCK_SIZE))) {
+                return false;
+            }
+
+            uint8_t* out = result.data.data() + first * RS_BLOCK_SIZE;
+            interleave_group(layout, first, codewords.data(), out);
+
+            const std::span<const uint8_t> stored(out, group_stored_size(layout, first));
+            for (size_t offset = 0; offset < stored.size(); offset += CHECKSUM_SEGMENT_SIZE) {
+                result.checksums[first + offset / CHECKSUM_SEGMENT_SIZE] = KeepTower::crc32c(
+                    stored.subspan(offset, std::min(CHECKSUM_SEGMENT_SIZE, stored.size() - offset)));
+            }
         }
+        return true;
+    });
+    if (!ok) {
+        return std::unexpected(Error::ENCODING_FAILED);
     }
 
-    correct_reed_solomon_destroy(rs);
-
-    EncodedData result;
-    result.data = std::move(encoded_data);
-    result.original_size = data.size();
+    result.original_size = static_cast<uint32_t>(data.size());
     result.redundancy_percent = m_redundancy_percent;
     result.block_size = RS_BLOCK_SIZE;
-    result.num_data_blocks = num_data_blocks;
-    result.num_parity_blocks = num_parity_blocks;
-
+    result.num_data_blocks = static_cast<uint32_t>(layout.codewords);
+    result.num_parity_blocks = static_cast<uint32_t>(
+        (layout.codewords * layout.parity + RS_BLOCK_SIZE - 1) / RS_BLOCK_SIZE);
+    result.parity_symbols = static_cast<uint32_t>(layout.parity);
+    result.interleave_depth = static_cast<uint32_t>(layout.depth);
     return result;
 }
 
 std::expected<std::vector<uint8_t>, ReedSolomon::Error>
 ReedSolomon::decode(const EncodedData& encoded) {
-    if (encoded.data.empty() || encoded.original_size == 0) {
-        return std::unexpected(Error::INVALID_DATA);
-    }
+    return decode(encoded.data, encoded.original_size, encoded.parity_symbols, encoded.interleave_depth,
+                  encoded.checksums, nullptr, m_max_threads);
+}
 
-    // Use RS(255, 223) configuration
-    const size_t RS_BLOCK_SIZE = 255;
-    const size_t RS_DATA_SIZE = 223;
-    const size_t RS_PARITY_SIZE = RS_BLOCK_SIZE - RS_DATA_SIZE;  // 32 parity bytes
+std::expected<std::vector<uint8_t>, ReedSolomon::Error>
+ReedSolomon::decode(EncodedData& encoded) {
+    CorrectionStats stats;
+    auto decoded = decode(encoded.data, encoded.original_size, encoded.parity_symbols, encoded.interleave_depth,
+                          encoded.checksums, &stats, m_max_threads);
+    if (decoded) {
+        encoded.corrections = std::move(stats);
+    }
+    return decoded;
+}
 
-    // Create RS decoder
-    correct_reed_solomon* rs = correct_reed_solomon_create(
-        correct_rs_primitive_polynomial_ccsds,
-        1,
-        1,
-        RS_PARITY_SIZE
-    );
+std::expected<std::vector<uint8_t>, ReedSolomon::Error>
+ReedSolomon::decode(std::span<const uint8_t> encoded_data,
+                    uint32_t original_size,
+                    uint32_t parity_symbols,
+                    uint32_t interleave_depth,
+                    std::span<const uint32_t> checksums,
+                    CorrectionStats* stats,
+                    unsigned max_threads) {
+    if (encoded_data.empty() || original_size == 0) {
+        return std::unexpected(Error::INVALID_DATA);
+    }
+    if (parity_symbols == 0 || parity_symbols >= RS_BLOCK_SIZE ||
+        interleave_depth == 0 || interleave_depth > MAX_INTERLEAVE_DEPTH) {
+        return std::unexpected(Error::INVALID_DATA);
+    }
 
-    if (!rs) {
-        return std::unexpected(Error::LIBCORRECT_ERROR);
+    const Layout layout = make_layout(original_size, parity_symbols, interleave_depth);
+    if (encoded_data.size() != stored_size(layout, original_size)) {
+        // Truncated or padded: symbols would be attributed to the wrong codewords
+        return std::unexpected(Error::DECODING_FAILED);
     }
 
-    // Calculate number of blocks from data size
-    uint32_t num_blocks = encoded.data.size() / RS_BLOCK_SIZE;
+    const size_t k = layout.data_symbols;
+    const KeepTower::RsCodec& rs = KeepTower::RsCodec::shared(layout.parity);
+    const bool checked = checksums.size() == checksum_count(encoded_data.size());
+    std::vector<uint8_t> message(layout.codewords * k);
+    std::vector<uint8_t> corrected(layout.codewords, 0);
+    std::atomic<size_t> damaged_segments{0};
+
+    const size_t groups = group_count(layout);
+    const size_t threads = KeepTower::worker_count(max_threads, groups, layout.codewords, MIN_CODEWORDS_PER_THREAD);
+    const bool ok = KeepTower::for_each_range(groups, threads, [&](size_t first_group, size_t last_group) {
+        std::vector<uint8_t> codewords(layout.depth * RS_BLOCK_SIZE);
+        std::vector<uint8_t> damaged(layout.depth * RS_BLOCK_SIZE);
+        std::vector<uint8_t> erased(layout.depth * RS_BLOCK_SIZE);
+        std::array<uint8_t, RS_BLOCK_SIZE> erasures;
+
+        for (size_t group = first_group; group < last_group; ++group) {
+            const size_t first = group * layout.depth;
+            const size_t count = std::min(layout.depth, layout.codewords - first);
+            const std::span<const uint8_t> stored =
+                encoded_data.subspan(first * RS_BLOCK_SIZE, group_stored_size(layout, first));
+            uint8_t* out = message.data() + first * k;
+
+            // Flag the bytes of every segment whose checksum does not match
+            bool dirty = !checked;
+            for (size_t offset = 0; checked && offset < stored.size(); offset += CHECKSUM_SEGMENT_SIZE) {
+                const size_t length = std::min(CHECKSUM_SEGMENT_SIZE, stored.size() - offset);
+                if (KeepTower::crc32c(stored.subspan(offset, length)) ==
+                    checksums[first + offset / CHECKSUM_SEGMENT_SIZE]) {
+                    continue;
+                }
+                if (!dirty) {
+                    std::fill_n(damaged.begin(), stored.size(), 0);
+                    dirty = true;
+                }
+                std::fill_n(damaged.begin() + static_cast<std::ptrdiff_t>(offset), length, 1);
+                damaged_segments.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            if (!dirty) {
+                // Pristine: gather the data symbols, no Reed-Solomon arithmetic
+                deinterleave_group(layout, first, stored.data(), out, k);
+                continue;
+            }
+
+            deinterleave_group(layout, first, stored.data(), codewords.data(), RS_BLOCK_SIZE);
+            if (!checked) {
+                if (!rs.decode(std::span(codewords).first(count * RS_BLOCK_SIZE), std::span(out, count * k),
+                               std::span(corrected).subspan(first, count))) {
+                    return false;
+                }
+                continue;
+            }
+
+            // Same arrangement as the symbols: erased[i * 255 + p] marks symbol p of codeword i
+            deinterleave_group(layout, first, damaged.data(), erased.data(), RS_BLOCK_SIZE);
+            for (size_t i = 0; i < count; ++i) {
+                uint8_t* codeword = codewords.data() + i * RS_BLOCK_SIZE;
+                size_t flagged = 0;
+                for (size_t p = 0; p < RS_BLOCK_SIZE; ++p) {
+                    if (erased[i * RS_BLOCK_SIZE + p] != 0) {
+                        erasures[flagged++] = static_cast<uint8_t>(p);
+                    }
+                }
+                if (flagged > 0) {
+                    const std::span<uint8_t> symbols(codeword, RS_BLOCK_SIZE);
+                    // Past erasure capacity the flags are no help; try locating errors instead
+                    auto fixed = flagged <= layout.parity
+                        ? rs.correct_erasures(symbols, std::span<const uint8_t>(erasures.data(), flagged))
+                        : std::nullopt;
+                    if (!fixed) {
+                        fixed = rs.correct_erasures(symbols, {});
+                    }
+                    if (!fixed) {
+                        return false;
+                    }
+                    corrected[first + i] = static_cast<uint8_t>(*fixed);
+                }
+                // Checksums vouch for codewords with no erasures
+                std::memcpy(out + i * k, codeword, k);
+            }
+        }
+        return true;
+    });
+    if (!ok) {
+        return std::unexpected(Error::DECODING_FAILED);
+    }
 
-    // Allocate output buffer
-    std::vector<uint8_t> decoded_data(num_blocks * RS_DATA_SIZE);
+    // Drop the shortened codeword's implicit zeros; a "correction" that
+    // touched them means the decoder landed on the wrong codeword
+    const size_t head = (layout.codewords - 1) * k;
+    const auto padding = std::span<const uint8_t>(message).subspan(head, k - layout.tail_data);
+    if (std::any_of(padding.begin(), padding.end(), [](uint8_t b) { return b != 0; })) {
+        return std::unexpected(Error::DECODING_FAILED);
+    }
+    message.erase(message.begin() + static_cast<std::ptrdiff_t>(head),
+                  message.begin() + static_cast<std::ptrdiff_t>(head + k - layout.tail_data));
+
+    if (stats) {
+        stats->corrected_symbols = 0;
+        stats->repaired_blocks = 0;
+        for (uint8_t symbols : corrected) {
+            stats->corrected_symbols += symbols;
+            stats->repaired_blocks += symbols != 0 ? 1 : 0;
+        }
+        stats->damaged_segments = damaged_segments.load();
+        stats->corrected_per_block = std::move(corrected);
+    }
+    return message;
+}
 
-    // Decode each block
-    for (uint32_t i = 0; i < num_blocks; ++i) {
-        const uint8_t* encoded_block = encoded.data.data() + (i * RS_BLOCK_SIZE);
-        uint8_t* decoded_block = decoded_data.data() + (i * RS_DATA_SIZE);
+std::expected<std::vector<uint8_t>, ReedSolomon::Error>
+ReedSolomon::decode_legacy(std::span<const uint8_t> encoded_data, uint32_t original_size) {
+    if (encoded_data.empty() || original_size == 0) {
+        return std::unexpected(Error::INVALID_DATA);
+    }
 
-        ssize_t result = correct_reed_solomon_decode(
-            rs,
-            encoded_block,
-            RS_BLOCK_SIZE,
-            decoded_block
-        );
+    // Calculate number of blocks from data size (a trailing partial block is ignored)
+    uint32_t num_blocks = encoded_data.size() / RS_BLOCK_SIZE;
 
-        if (result < 0) {
-            correct_reed_solomon_destroy(rs);
-            return std::unexpected(Error::DECODING_FAILED);
-        }
+    const KeepTower::RsCodec& rs = KeepTower::RsCodec::shared(LEGACY_PARITY_SIZE);
+    std::vector<uint8_t> decoded_data(num_blocks * OPTIMAL_BLOCK_SIZE);
+    if (!rs.decode(encoded_data.first(num_blocks * RS_BLOCK_SIZE), decoded_data)) {
+        return std::unexpected(Error::DECODING_FAILED);
     }
 
-    correct_reed_solomon_destroy(rs);
-
-    // Remove padding and return original data
-    return unpad_data(decoded_data, encoded.original_size);
+    // Remove zero padding
+    if (original_size > decoded_data.size()) {
+        return std::unexpected(Error::DECODING_FAILED);
+    }
+    decoded_data.resize(original_size);
+    return decoded_data;
 }
 
 std::string ReedSolomon::error_to_string(Error error) {
@@ -205,7 +380,7 @@ std::string ReedSolomon::error_to_string(Error error) {
         case Error::BLOCK_SIZE_TOO_LARGE:
             return "Data size exceeds maximum Reed-Solomon block size";
         case Error::LIBCORRECT_ERROR:
-            return "Libcorrect library error";
+            return "Libcorrect library error (no longer raised: the codec is built in)";
         default:
             return "Unknown error";
     }
@@ -13,10 +13,11 @@
 #include <cstdint>
 #include <memory>
 #include <expected>
+#include <span>
 #include <string>
 
 /**
- * @brief Reed-Solomon error correction wrapper using libcorrect
+ * @brief Reed-Solomon error correction for vault data
  *
  * Provides forward error correction capabilities for vault data, allowing
  * recovery from partial file corruption. Uses Reed-Solomon codes to add
@@ -41,14 +42,54 @@
  * @endcode
  *
  * @section reed_solomon_format Encoded Data Format
- * - Original data blocks
- * - Parity blocks (size based on redundancy percentage)
+ * The input is split into RS(255,k) codewords whose parity length follows
+ * the redundancy setting (see parity_symbols_for()), so 5% costs about 5%
+ * and 50% about 50%. The last codeword is shortened: its missing data
+ * symbols are implicit leading zeros and are not stored, so the output is
+ * exactly original_size + codewords * parity_symbols bytes.
+ *
+ * Codewords are interleaved in groups of up to MAX_INTERLEAVE_DEPTH: the
+ * output holds symbol 0 of every codeword in the group, then symbol 1, and
+ * so on. A contiguous burst of B bytes therefore costs each codeword of the
+ * group about B / depth symbols, and a group survives bursts of up to
+ * depth * parity_symbols / 2 bytes.
  *
  * @note The redundancy percentage directly affects file size overhead.
  *       10% redundancy adds approximately 10% to file size.
+ *
+ * Every CHECKSUM_SEGMENT_SIZE bytes of the encoded data (one codeword's
+ * worth) also get a CRC-32C, kept alongside it in EncodedData::checksums.
+ * When every segment matches, decode copies the data symbols out without
+ * any Reed-Solomon arithmetic. Symbols in a mismatching segment are handed
+ * to the decoder as erasures, and erasures cost half the parity that
+ * unlocated errors do.
+ *
+ * Interleaving groups are independent, so payloads of more than a few
+ * hundred KiB are split by group across worker threads (see
+ * set_max_threads()). Each worker keeps its own scratch codewords and
+ * writes straight into the preallocated output; the result is identical
+ * to a single-threaded run.
+ *
+ * Codewords are produced by the in-tree KeepTower::RsCodec, which is
+ * bit-compatible with the libcorrect CCSDS codec earlier releases used.
+ * Data written by those releases (fixed RS(255,223), zero-padded, not
+ * interleaved) is read with decode_legacy().
  */
 class ReedSolomon {
 public:
+    static constexpr uint32_t MAX_INTERLEAVE_DEPTH = 255;  ///< Codewords per interleaving group (fits a u8 on disk)
+    static constexpr size_t CHECKSUM_SEGMENT_SIZE = 255;   ///< Encoded bytes covered by each CRC-32C
+
+    /**
+     * @brief What a decode had to repair
+     */
+    struct CorrectionStats {
+        std::vector<uint8_t> corrected_per_block;  ///< Symbols repaired in each codeword, in codeword order
+        size_t corrected_symbols = 0;              ///< Sum of corrected_per_block
+        size_t repaired_blocks = 0;                ///< Codewords with at least one repaired symbol
+        size_t damaged_segments = 0;               ///< Segments whose checksum did not match
+    };
+
     /**
      * @brief Encoded data containing original data and parity information
      */
@@ -58,7 +99,11 @@ public:
         uint8_t redundancy_percent;          ///< Redundancy percentage used (0-50)
         uint32_t block_size;                 ///< Block size used for encoding
         uint32_t num_data_blocks;            ///< Number of data blocks
-        uint32_t num_parity_blocks;          ///< Number of parity blocks
+        uint32_t num_parity_blocks;          ///< Parity bytes expressed in whole blocks
+        uint32_t parity_symbols;             ///< Parity bytes per codeword (255 - k)
+        uint32_t interleave_depth;           ///< Codewords per interleaving group
+        std::vector<uint32_t> checksums;     ///< CRC-32C of each CHECKSUM_SEGMENT_SIZE slice of data
+        CorrectionStats corrections;         ///< Filled in by decode(EncodedData&)
     };
 
     /**
@@ -70,7 +115,7 @@ public:
         DECODING_FAILED,         ///< RS decoding operation failed (too much corruption)
         INVALID_DATA,            ///< Input data is invalid or corrupted beyond repair
         BLOCK_SIZE_TOO_LARGE,    ///< Data size exceeds maximum RS block size
-        LIBCORRECT_ERROR         ///< Underlying libcorrect library error
+        LIBCORRECT_ERROR         ///< Legacy libcorrect failure (no longer raised)
     };
 
     /**
@@ -120,12 +165,96 @@ public:
      */
     std::expected<std::vector<uint8_t>, Error> decode(const EncodedData& encoded);
 
+    /**
+     * @brief Decode, recording the repairs in encoded.corrections
+     *
+     * @param encoded Encoded data (possibly corrupted); corrections is
+     *        replaced on success
+     * @return Recovered original data, or error if corruption is too severe
+     */
+    std::expected<std::vector<uint8_t>, Error> decode(EncodedData& encoded);
+
+    /**
+     * @brief Decode codewords read directly from a larger buffer
+     *
+     * Same as decode(const EncodedData&), but reads the blocks in place so
+     * callers holding a mapped file do not copy them into an EncodedData.
+     * The layout comes from the recorded parameters, not from this
+     * instance's redundancy setting.
+     *
+     * @param encoded_data Encoded blocks (possibly corrupted)
+     * @param original_size Size of original data before encoding
+     * @param parity_symbols Parity bytes per codeword used when encoding
+     * @param interleave_depth Interleaving depth used when encoding
+     * @param checksums Recorded segment checksums; empty (or the wrong
+     *        count) runs the full decoder on every codeword
+     * @param stats If non-null, receives what was repaired (on success)
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return Recovered original data, or error if corruption is too severe
+     *         or the size does not match the parameters
+     */
+    static std::expected<std::vector<uint8_t>, Error> decode(std::span<const uint8_t> encoded_data,
+                                                             uint32_t original_size,
+                                                             uint32_t parity_symbols,
+                                                             uint32_t interleave_depth,
+                                                             std::span<const uint32_t> checksums = {},
+                                                             CorrectionStats* stats = nullptr,
+                                                             unsigned max_threads = 0);
+
+    /**
+     * @brief Encoded size for recorded parameters
+     * @param original_size Size of original data before encoding
+     * @param parity_symbols Parity bytes per codeword (1-254)
+     * @return Size of EncodedData::data, or 0 for invalid parameters
+     */
+    static size_t encoded_size(uint32_t original_size, uint32_t parity_symbols);
+
+    /**
+     * @brief Number of segment checksums covering an encoded buffer
+     * @param encoded_size Size of EncodedData::data
+     * @return Entries in EncodedData::checksums
+     */
+    static size_t checksum_count(size_t encoded_size) {
+        return (encoded_size + CHECKSUM_SEGMENT_SIZE - 1) / CHECKSUM_SEGMENT_SIZE;
+    }
+
+    /**
+     * @brief Decode data written before variable-rate encoding
+     *
+     * Earlier releases always wrote zero-padded RS(255,223) codewords back to
+     * back, whatever the redundancy setting. A trailing partial block is
+     * ignored.
+     *
+     * @param encoded_data Encoded blocks (possibly corrupted)
+     * @param original_size Size of original data before encoding
+     * @return Recovered original data, or error if corruption is too severe
+     */
+    static std::expected<std::vector<uint8_t>, Error> decode_legacy(std::span<const uint8_t> encoded_data,
+                                                                    uint32_t original_size);
+
     /**
      * @brief Get current redundancy percentage
      * @return Redundancy percentage (5-50)
      */
     uint8_t get_redundancy_percent() const { return m_redundancy_percent; }
 
+    /**
+     * @brief Parity bytes per codeword used for future encoding operations
+     * @return parity_symbols_for(get_redundancy_percent())
+     */
+    uint32_t get_parity_symbols() const { return parity_symbols_for(m_redundancy_percent); }
+
+    /**
+     * @brief Parity length that gives a redundancy percentage
+     *
+     * Picks the even parity length whose parity/data ratio is closest to
+     * the percentage (5% -> 12, 10% -> 24, 20% -> 44, 50% -> 86).
+     *
+     * @param redundancy_percent Redundancy percentage (5-50)
+     * @return Parity bytes per 255-byte codeword
+     */
+    static uint32_t parity_symbols_for(uint8_t redundancy_percent);
+
     /**
      * @brief Set redundancy percentage for future encoding operations
      * @param percent New redundancy percentage (5-50)
@@ -133,6 +262,16 @@ public:
      */
     bool set_redundancy_percent(uint8_t percent);
 
+    /**
+     * @brief Limit the worker threads used by encode() and decode()
+     * @param max_threads Thread cap (0 = hardware concurrency, 1 = serial)
+     */
+    void set_max_threads(unsigned max_threads) { m_max_threads = max_threads; }
+
+    /** @brief Worker thread cap
+     *  @return Value from set_max_threads() (default 0 = hardware concurrency) */
+    unsigned get_max_threads() const { return m_max_threads; }
+
     /**
      * @brief Calculate output size for given input size
      * @param input_size Size of data to encode
@@ -158,32 +297,84 @@ public:
 
 private:
     uint8_t m_redundancy_percent;          ///< Redundancy percentage (5-50)
+    unsigned m_max_threads = 0;            ///< Worker thread cap (0 = hardware concurrency)
     static constexpr uint8_t MIN_REDUNDANCY = 5;    ///< Minimum redundancy (5%)
     static constexpr uint8_t MAX_REDUNDANCY = 50;   ///< Maximum redundancy (50%)
     static constexpr size_t MAX_BLOCK_SIZE = 255;   ///< Maximum RS block size (GF(256) limitation)
     static constexpr size_t OPTIMAL_BLOCK_SIZE = 223; ///< Optimal block size for RS(255,223)
+    static constexpr size_t RS_BLOCK_SIZE = MAX_BLOCK_SIZE;  ///< Codeword size on disk
+    static constexpr size_t LEGACY_PARITY_SIZE = RS_BLOCK_SIZE - OPTIMAL_BLOCK_SIZE;  ///< Pre-variable-rate parity bytes
 
     /**
-     * @brief Calculate number of parity blocks needed
-     * @param data_blocks Number of data blocks
-     * @return Number of parity blocks
+     * @brief Codeword arrangement for one encoded buffer
      */
-    uint32_t calculate_parity_blocks(uint32_t data_blocks) const;
+    struct Layout {
+        size_t data_symbols;  ///< k
+        size_t parity;        ///< 255 - k
+        size_t codewords;     ///< Codeword count
+        size_t depth;         ///< Interleaving group size
+        size_t tail_data;     ///< Stored data symbols of the last (shortened) codeword
+    };
 
     /**
-     * @brief Pad data to align with block boundaries
-     * @param data Input data
-     * @return Padded data
+     * @brief Arrange original_size bytes into codewords
+     * @param original_size Input size (non-zero)
+     * @param parity Parity bytes per codeword
+     * @param depth Interleaving depth, or 0 to pick the balanced default
+     * @return Layout
      */
-    std::vector<uint8_t> pad_data(const std::vector<uint8_t>& data) const;
+    static Layout make_layout(size_t original_size, size_t parity, size_t depth);
+
+    /** @brief Stored size of the encoded buffer
+     *  @param layout Codeword arrangement
+     *  @param original_size Input size
+     *  @return original_size + codewords * parity */
+    static size_t stored_size(const Layout& layout, size_t original_size) {
+        return original_size + layout.codewords * layout.parity;
+    }
+
+    /** @brief Number of interleaving groups
+     *  @param layout Codeword arrangement
+     *  @return ceil(codewords / depth) */
+    static size_t group_count(const Layout& layout) {
+        return (layout.codewords + layout.depth - 1) / layout.depth;
+    }
 
     /**
-     * @brief Remove padding from decoded data
-     * @param data Padded data
-     * @param original_size Original size before padding
-     * @return Data with padding removed
+     * @brief Stored bytes of one interleaving group
+     *
+     * Every group but the last holds full codewords, so a group starting at
+     * codeword @p first also starts at stored offset first * 255.
+     *
+     * @param layout Codeword arrangement
+     * @param first First codeword of the group (a multiple of layout.depth)
+     * @return Bytes the group occupies in stored order
+     */
+    static size_t group_stored_size(const Layout& layout, size_t first);
+
+    /**
+     * @brief Write one group's codewords in stored (interleaved, shortened) order
+     * @param layout Codeword arrangement
+     * @param first First codeword of the group
+     * @param codewords The group's codewords, 255 bytes each
+     * @param out group_stored_size() bytes
+     */
+    static void interleave_group(const Layout& layout, size_t first, const uint8_t* codewords, uint8_t* out);
+
+    /**
+     * @brief Rebuild one group's codewords from stored order
+     *
+     * The shortened codeword's implicit leading zeros are filled in.
+     *
+     * @param layout Codeword arrangement
+     * @param first First codeword of the group
+     * @param stored group_stored_size() bytes
+     * @param out Group codeword count * symbols bytes
+     * @param symbols Leading symbols kept per codeword: 255 for whole
+     *        codewords, data_symbols to gather just the data
      */
-    std::vector<uint8_t> unpad_data(const std::vector<uint8_t>& data, uint32_t original_size) const;
+    static void deinterleave_group(const Layout& layout, size_t first, const uint8_t* stored, uint8_t* out,
+                                   size_t symbols);
 };
 
 #endif // REEDSOLOMON_H
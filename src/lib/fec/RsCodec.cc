@@ -0,0 +1,532 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "lib/fec/RsCodec.h"
+#include "lib/fec/GF256.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define KEEPTOWER_FEC_X86 1
+#include <immintrin.h>
+#else
+#define KEEPTOWER_FEC_X86 0
+#endif
+
+namespace KeepTower {
+
+namespace {
+
+// Scratch for one batch: BLOCK_SIZE rows of BATCH lanes
+using BatchBuffer = std::array<uint8_t, RsCodec::BLOCK_SIZE * RsCodec::BATCH>;
+
+#if KEEPTOWER_FEC_X86
+
+/*
+ * products[r][lane] = sum over c of matrix[r][c] * columns[c][lane]
+ *
+ * Rows are produced four at a time so each column is loaded and split into
+ * nibbles once per group.
+ */
+
+__attribute__((target("avx2")))
+inline __m256i mac_avx2(__m256i acc, uint8_t coefficient, __m256i low, __m256i high) {
+    const auto* row = gf256::NIBBLE_TABLES.rows[coefficient].data();
+    const __m256i low_table = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(row)));
+    const __m256i high_table = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(row + 16)));
+    return _mm256_xor_si256(acc, _mm256_xor_si256(_mm256_shuffle_epi8(low_table, low),
+                                                  _mm256_shuffle_epi8(high_table, high)));
+}
+
+__attribute__((target("avx2")))
+void multiply_avx2(const uint8_t* matrix, size_t rows, size_t cols, const uint8_t* columns, uint8_t* products) {
+    const __m256i mask = _mm256_set1_epi8(0x0F);
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const uint8_t* m0 = matrix + r * cols;
+        const uint8_t* m1 = m0 + cols;
+        const uint8_t* m2 = m1 + cols;
+        const uint8_t* m3 = m2 + cols;
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        __m256i acc2 = _mm256_setzero_si256();
+        __m256i acc3 = _mm256_setzero_si256();
+        for (size_t c = 0; c < cols; ++c) {
+            const __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(columns + c * RsCodec::BATCH));
+            const __m256i low = _mm256_and_si256(x, mask);
+            const __m256i high = _mm256_and_si256(_mm256_srli_epi64(x, 4), mask);
+            acc0 = mac_avx2(acc0, m0[c], low, high);
+            acc1 = mac_avx2(acc1, m1[c], low, high);
+            acc2 = mac_avx2(acc2, m2[c], low, high);
+            acc3 = mac_avx2(acc3, m3[c], low, high);
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(products + (r + 0) * RsCodec::BATCH), acc0);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(products + (r + 1) * RsCodec::BATCH), acc1);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(products + (r + 2) * RsCodec::BATCH), acc2);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(products + (r + 3) * RsCodec::BATCH), acc3);
+    }
+    for (; r < rows; ++r) {
+        const uint8_t* m0 = matrix + r * cols;
+        __m256i acc = _mm256_setzero_si256();
+        for (size_t c = 0; c < cols; ++c) {
+            const __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i*>(columns + c * RsCodec::BATCH));
+            acc = mac_avx2(acc, m0[c], _mm256_and_si256(x, mask), _mm256_and_si256(_mm256_srli_epi64(x, 4), mask));
+        }
+        _mm256_store_si256(reinterpret_cast<__m256i*>(products + r * RsCodec::BATCH), acc);
+    }
+}
+
+__attribute__((target("ssse3")))
+inline __m128i mac_ssse3(__m128i acc, uint8_t coefficient, __m128i low, __m128i high) {
+    const auto* row = gf256::NIBBLE_TABLES.rows[coefficient].data();
+    const __m128i low_table = _mm_load_si128(reinterpret_cast<const __m128i*>(row));
+    const __m128i high_table = _mm_load_si128(reinterpret_cast<const __m128i*>(row + 16));
+    return _mm_xor_si128(acc, _mm_xor_si128(_mm_shuffle_epi8(low_table, low),
+                                            _mm_shuffle_epi8(high_table, high)));
+}
+
+__attribute__((target("ssse3")))
+void multiply_ssse3(const uint8_t* matrix, size_t rows, size_t cols, const uint8_t* columns, uint8_t* products) {
+    const __m128i mask = _mm_set1_epi8(0x0F);
+    for (size_t lane = 0; lane < RsCodec::BATCH; lane += 16) {
+        size_t r = 0;
+        for (; r + 4 <= rows; r += 4) {
+            const uint8_t* m0 = matrix + r * cols;
+            const uint8_t* m1 = m0 + cols;
+            const uint8_t* m2 = m1 + cols;
+            const uint8_t* m3 = m2 + cols;
+            __m128i acc0 = _mm_setzero_si128();
+            __m128i acc1 = _mm_setzero_si128();
+            __m128i acc2 = _mm_setzero_si128();
+            __m128i acc3 = _mm_setzero_si128();
+            for (size_t c = 0; c < cols; ++c) {
+                const __m128i x = _mm_load_si128(
+                    reinterpret_cast<const __m128i*>(columns + c * RsCodec::BATCH + lane));
+                const __m128i low = _mm_and_si128(x, mask);
+                const __m128i high = _mm_and_si128(_mm_srli_epi64(x, 4), mask);
+                acc0 = mac_ssse3(acc0, m0[c], low, high);
+                acc1 = mac_ssse3(acc1, m1[c], low, high);
+                acc2 = mac_ssse3(acc2, m2[c], low, high);
+                acc3 = mac_ssse3(acc3, m3[c], low, high);
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(products + (r + 0) * RsCodec::BATCH + lane), acc0);
+            _mm_store_si128(reinterpret_cast<__m128i*>(products + (r + 1) * RsCodec::BATCH + lane), acc1);
+            _mm_store_si128(reinterpret_cast<__m128i*>(products + (r + 2) * RsCodec::BATCH + lane), acc2);
+            _mm_store_si128(reinterpret_cast<__m128i*>(products + (r + 3) * RsCodec::BATCH + lane), acc3);
+        }
+        for (; r < rows; ++r) {
+            const uint8_t* m0 = matrix + r * cols;
+            __m128i acc = _mm_setzero_si128();
+            for (size_t c = 0; c < cols; ++c) {
+                const __m128i x = _mm_load_si128(
+                    reinterpret_cast<const __m128i*>(columns + c * RsCodec::BATCH + lane));
+                acc = mac_ssse3(acc, m0[c], _mm_and_si128(x, mask), _mm_and_si128(_mm_srli_epi64(x, 4), mask));
+            }
+            _mm_store_si128(reinterpret_cast<__m128i*>(products + r * RsCodec::BATCH + lane), acc);
+        }
+    }
+}
+
+#endif  // KEEPTOWER_FEC_X86
+
+}  // namespace
+
+RsCodec::RsCodec(size_t parity_symbols, Kernel kernel)
+    : m_parity(parity_symbols),
+      m_kernel(kernel_supported(kernel) ? kernel : best_kernel()) {
+    if (parity_symbols == 0 || parity_symbols >= BLOCK_SIZE) {
+        throw std::invalid_argument("RS parity length must be between 1 and 254, got " +
+                                    std::to_string(parity_symbols));
+    }
+
+    // g(x) = (x - a^1)(x - a^2)...(x - a^n)
+    m_generator.assign(m_parity + 1, 0);
+    m_generator[0] = 1;
+    for (size_t root = 1; root <= m_parity; ++root) {
+        const uint8_t alpha = gf256::exp(root);
+        for (size_t j = root; j > 0; --j) {
+            m_generator[j] = m_generator[j - 1] ^ gf256::mul(m_generator[j], alpha);
+        }
+        m_generator[0] = gf256::mul(m_generator[0], alpha);
+    }
+
+    // Register cell j is the x^(n-1-j) remainder coefficient
+    m_lfsr_rows.resize(256 * m_parity);
+    for (size_t feedback = 0; feedback < 256; ++feedback) {
+        for (size_t j = 0; j < m_parity; ++j) {
+            m_lfsr_rows[feedback * m_parity + j] =
+                gf256::mul(static_cast<uint8_t>(feedback), m_generator[m_parity - 1 - j]);
+        }
+    }
+
+    // Column i of P is the parity of the unit message e_i
+    const size_t k = data_symbols();
+    m_parity_matrix.resize(m_parity * k);
+    std::vector<uint8_t> unit(k, 0);
+    std::vector<uint8_t> parity(m_parity);
+    for (size_t i = 0; i < k; ++i) {
+        unit[i] = 1;
+        parity_scalar(unit.data(), parity.data());
+        unit[i] = 0;
+        for (size_t r = 0; r < m_parity; ++r) {
+            m_parity_matrix[r * k + i] = parity[r];
+        }
+    }
+}
+
+const RsCodec& RsCodec::shared(size_t parity_symbols) {
+    static std::mutex mutex;
+    static std::array<std::unique_ptr<RsCodec>, BLOCK_SIZE> codecs;
+
+    if (parity_symbols == 0 || parity_symbols >= BLOCK_SIZE) {
+        throw std::invalid_argument("RS parity length must be between 1 and 254, got " +
+                                    std::to_string(parity_symbols));
+    }
+    std::lock_guard lock(mutex);
+    auto& codec = codecs[parity_symbols];
+    if (!codec) {
+        codec = std::make_unique<RsCodec>(parity_symbols);
+    }
+    return *codec;
+}
+
+RsCodec::Kernel RsCodec::best_kernel() noexcept {
+    if (kernel_supported(Kernel::Avx2)) {
+        return Kernel::Avx2;
+    }
+    if (kernel_supported(Kernel::Ssse3)) {
+        return Kernel::Ssse3;
+    }
+    return Kernel::Scalar;
+}
+
+bool RsCodec::kernel_supported(Kernel kernel) noexcept {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#if KEEPTOWER_FEC_X86
+        case Kernel::Ssse3:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("ssse3");
+        case Kernel::Avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+void RsCodec::parity_scalar(const uint8_t* message, uint8_t* parity) const {
+    std::array<uint8_t, BLOCK_SIZE> reg{};
+    const size_t k = data_symbols();
+    for (size_t i = 0; i < k; ++i) {
+        const uint8_t feedback = message[i] ^ reg[0];
+        std::memmove(reg.data(), reg.data() + 1, m_parity - 1);
+        reg[m_parity - 1] = 0;
+        if (feedback != 0) {
+            const uint8_t* taps = m_lfsr_rows.data() + feedback * m_parity;
+            for (size_t j = 0; j < m_parity; ++j) {
+                reg[j] ^= taps[j];
+            }
+        }
+    }
+    std::memcpy(parity, reg.data(), m_parity);
+}
+
+void RsCodec::parity_batch(const uint8_t* data, size_t stride, size_t count, uint8_t* parity) const {
+    alignas(32) BatchBuffer columns;
+    alignas(32) BatchBuffer products;
+    const size_t k = data_symbols();
+
+    // Lanes beyond count stay zero: their parity is zero and is dropped
+    if (count < BATCH) {
+        std::memset(columns.data(), 0, k * BATCH);
+    }
+    for (size_t lane = 0; lane < count; ++lane) {
+        const uint8_t* message = data + lane * stride;
+        for (size_t i = 0; i < k; ++i) {
+            columns[i * BATCH + lane] = message[i];
+        }
+    }
+
+#if KEEPTOWER_FEC_X86
+    if (m_kernel == Kernel::Avx2) {
+        multiply_avx2(m_parity_matrix.data(), m_parity, k, columns.data(), products.data());
+    } else {
+        multiply_ssse3(m_parity_matrix.data(), m_parity, k, columns.data(), products.data());
+    }
+#endif
+
+    for (size_t lane = 0; lane < count; ++lane) {
+        uint8_t* out = parity + lane * m_parity;
+        for (size_t r = 0; r < m_parity; ++r) {
+            out[r] = products[r * BATCH + lane];
+        }
+    }
+}
+
+void RsCodec::compute_parity(const uint8_t* data, size_t stride, size_t count, uint8_t* parity) const {
+    if (m_kernel == Kernel::Scalar) {
+        for (size_t i = 0; i < count; ++i) {
+            parity_scalar(data + i * stride, parity + i * m_parity);
+        }
+        return;
+    }
+    parity_batch(data, stride, count, parity);
+}
+
+bool RsCodec::encode(std::span<const uint8_t> data, std::span<uint8_t> codewords) const {
+    const size_t k = data_symbols();
+    const size_t count = codewords.size() / BLOCK_SIZE;
+    if (codewords.size() != count * BLOCK_SIZE || data.size() != count * k) {
+        return false;
+    }
+
+    BatchBuffer parity;
+    for (size_t first = 0; first < count; first += BATCH) {
+        const size_t batch = std::min(BATCH, count - first);
+        compute_parity(data.data() + first * k, k, batch, parity.data());
+        for (size_t i = 0; i < batch; ++i) {
+            uint8_t* codeword = codewords.data() + (first + i) * BLOCK_SIZE;
+            std::memcpy(codeword, data.data() + (first + i) * k, k);
+            std::memcpy(codeword + k, parity.data() + i * m_parity, m_parity);
+        }
+    }
+    return true;
+}
+
+std::optional<size_t> RsCodec::decode(std::span<const uint8_t> codewords, std::span<uint8_t> data,
+                                      std::span<uint8_t> corrected_per_codeword) const {
+    const size_t k = data_symbols();
+    const size_t count = codewords.size() / BLOCK_SIZE;
+    if (codewords.size() != count * BLOCK_SIZE || data.size() != count * k) {
+        return std::nullopt;
+    }
+    const bool per_codeword = !corrected_per_codeword.empty();
+    if (per_codeword) {
+        if (corrected_per_codeword.size() != count) {
+            return std::nullopt;
+        }
+        std::fill(corrected_per_codeword.begin(), corrected_per_codeword.end(), 0);
+    }
+
+    size_t corrected = 0;
+    BatchBuffer parity;
+    for (size_t first = 0; first < count; first += BATCH) {
+        const size_t batch = std::min(BATCH, count - first);
+        compute_parity(codewords.data() + first * BLOCK_SIZE, BLOCK_SIZE, batch, parity.data());
+
+        for (size_t i = 0; i < batch; ++i) {
+            const uint8_t* codeword = codewords.data() + (first + i) * BLOCK_SIZE;
+            uint8_t* out = data.data() + (first + i) * k;
+            std::memcpy(out, codeword, k);
+
+            // Stored parity matches recomputed parity: the codeword is clean
+            uint8_t* remainder = parity.data() + i * m_parity;
+            uint8_t dirty = 0;
+            for (size_t r = 0; r < m_parity; ++r) {
+                remainder[r] ^= codeword[k + r];
+                dirty |= remainder[r];
+            }
+            if (dirty == 0) {
+                continue;
+            }
+
+            std::array<uint8_t, BLOCK_SIZE> repaired;
+            std::memcpy(repaired.data(), codeword, BLOCK_SIZE);
+            const auto fixed = correct(repaired.data(), remainder);
+            if (!fixed) {
+                return std::nullopt;
+            }
+            std::memcpy(out, repaired.data(), k);
+            corrected += *fixed;
+            if (per_codeword) {
+                corrected_per_codeword[first + i] = static_cast<uint8_t>(*fixed);
+            }
+        }
+    }
+    return corrected;
+}
+
+std::optional<size_t> RsCodec::correct_erasures(std::span<uint8_t> codeword,
+                                                std::span<const uint8_t> erasures) const {
+    if (codeword.size() != BLOCK_SIZE || erasures.size() > m_parity) {
+        return std::nullopt;
+    }
+    const size_t k = data_symbols();
+    std::array<uint8_t, BLOCK_SIZE> remainder{};
+    parity_scalar(codeword.data(), remainder.data());
+    uint8_t dirty = 0;
+    for (size_t r = 0; r < m_parity; ++r) {
+        remainder[r] ^= codeword[k + r];
+        dirty |= remainder[r];
+    }
+    if (dirty == 0) {
+        return 0;
+    }
+    return correct(codeword.data(), remainder.data(), erasures);
+}
+
+std::optional<size_t> RsCodec::correct(uint8_t* codeword, const uint8_t* remainder,
+                                       std::span<const uint8_t> erasures) const {
+    const size_t n = m_parity;
+    const size_t k = data_symbols();
+    const size_t s = erasures.size();
+    if (s > n) {
+        return std::nullopt;
+    }
+
+    // c(x) and the remainder agree at every root of g(x): S_j = rem(a^j)
+    std::array<uint8_t, BLOCK_SIZE> syndromes{};
+    for (size_t j = 0; j < n; ++j) {
+        const uint8_t root = gf256::exp(j + 1);
+        uint8_t value = 0;
+        for (size_t i = 0; i < n; ++i) {
+            value = gf256::mul(value, root) ^ remainder[i];
+        }
+        syndromes[j] = value;
+    }
+
+    // Erasure locator Gamma(x) = prod(1 - X_e x), X_e = a^(254 - position)
+    std::array<uint8_t, BLOCK_SIZE + 1> gamma{};
+    gamma[0] = 1;
+    for (size_t e = 0; e < s; ++e) {
+        const uint8_t x = gf256::exp(BLOCK_SIZE - 1 - erasures[e]);
+        for (size_t i = e + 1; i > 0; --i) {
+            gamma[i] ^= gf256::mul(gamma[i - 1], x);
+        }
+    }
+
+    // Forney syndromes T(x) = S(x) Gamma(x) mod x^n; T_s .. T_(n-1) only
+    // see the unknown errors
+    std::array<uint8_t, BLOCK_SIZE> forney{};
+    for (size_t i = s; i < n; ++i) {
+        uint8_t value = 0;
+        for (size_t j = 0; j <= std::min(i, s); ++j) {
+            value ^= gf256::mul(gamma[j], syndromes[i - j]);
+        }
+        forney[i - s] = value;
+    }
+    const size_t m = n - s;
+
+    // Berlekamp-Massey on the Forney syndromes: error locator sigma(x)
+    std::array<uint8_t, BLOCK_SIZE + 1> sigma{};
+    std::array<uint8_t, BLOCK_SIZE + 1> previous{};
+    sigma[0] = 1;
+    previous[0] = 1;
+    size_t errors = 0;
+    size_t shift = 1;
+    uint8_t previous_delta = 1;
+    for (size_t r = 0; r < m; ++r) {
+        uint8_t delta = forney[r];
+        for (size_t i = 1; i <= errors; ++i) {
+            delta ^= gf256::mul(sigma[i], forney[r - i]);
+        }
+        if (delta == 0) {
+            ++shift;
+            continue;
+        }
+
+        const uint8_t scale = gf256::div(delta, previous_delta);
+        const auto before = sigma;
+        for (size_t i = 0; i + shift <= m; ++i) {
+            sigma[i + shift] ^= gf256::mul(scale, previous[i]);
+        }
+        if (2 * errors <= r) {
+            errors = r + 1 - errors;
+            previous = before;
+            previous_delta = delta;
+            shift = 1;
+        } else {
+            ++shift;
+        }
+    }
+    if (2 * errors > m) {
+        return std::nullopt;
+    }
+
+    // Errata locator Lambda(x) = sigma(x) Gamma(x)
+    const size_t length = errors + s;
+    std::array<uint8_t, BLOCK_SIZE + 1> lambda{};
+    for (size_t i = 0; i <= errors; ++i) {
+        if (sigma[i] == 0) {
+            continue;
+        }
+        for (size_t j = 0; j <= s; ++j) {
+            lambda[i + j] ^= gf256::mul(sigma[i], gamma[j]);
+        }
+    }
+
+    // Chien search: position p holds the x^(254 - p) coefficient
+    std::array<size_t, BLOCK_SIZE> positions{};
+    size_t found = 0;
+    for (size_t p = 0; p < BLOCK_SIZE && found <= length; ++p) {
+        const size_t inverse_power = (gf256::FIELD_ORDER - (BLOCK_SIZE - 1 - p)) % gf256::FIELD_ORDER;
+        uint8_t value = 0;
+        for (size_t i = 0; i <= length; ++i) {
+            if (lambda[i] != 0) {
+                value ^= gf256::exp(gf256::log(lambda[i]) + inverse_power * i);
+            }
+        }
+        if (value == 0) {
+            if (found == length) {
+                return std::nullopt;
+            }
+            positions[found++] = p;
+        }
+    }
+    if (found != length) {
+        return std::nullopt;
+    }
+
+    // Forney (first root a^1): Y = Omega(X^-1) / Lambda'(X^-1)
+    std::array<uint8_t, BLOCK_SIZE> omega{};
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t value = 0;
+        for (size_t j = 0; j <= std::min(i, length); ++j) {
+            value ^= gf256::mul(lambda[j], syndromes[i - j]);
+        }
+        omega[i] = value;
+    }
+    size_t changed = 0;
+    for (size_t e = 0; e < found; ++e) {
+        const size_t p = positions[e];
+        const uint8_t x_inverse = gf256::exp(gf256::FIELD_ORDER - (BLOCK_SIZE - 1 - p));
+        uint8_t numerator = 0;
+        uint8_t power = 1;
+        for (size_t i = 0; i < n; ++i) {
+            numerator ^= gf256::mul(omega[i], power);
+            power = gf256::mul(power, x_inverse);
+        }
+        uint8_t denominator = 0;
+        const uint8_t x_inverse_squared = gf256::mul(x_inverse, x_inverse);
+        power = 1;
+        for (size_t i = 1; i <= length; i += 2) {
+            denominator ^= gf256::mul(lambda[i], power);
+            power = gf256::mul(power, x_inverse_squared);
+        }
+        if (denominator == 0) {
+            return std::nullopt;
+        }
+        const uint8_t magnitude = gf256::div(numerator, denominator);
+        codeword[p] ^= magnitude;
+        changed += magnitude != 0 ? 1 : 0;
+    }
+
+    // Beyond capacity the locator can point at a wrong codeword: re-check
+    std::array<uint8_t, BLOCK_SIZE> check{};
+    parity_scalar(codeword, check.data());
+    if (std::memcmp(check.data(), codeword + k, n) != 0) {
+        return std::nullopt;
+    }
+    return changed;
+}
+
+}  // namespace KeepTower
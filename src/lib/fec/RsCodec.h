@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file RsCodec.h
+ * @brief In-tree Reed-Solomon RS(255,k) codec over GF(256)
+ */
+
+#ifndef KEEPTOWER_RS_CODEC_H
+#define KEEPTOWER_RS_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace KeepTower {
+
+/**
+ * @brief Systematic RS(255,k) encoder/decoder.
+ *
+ * Codewords are 255 bytes: k data bytes followed by 255 - k parity bytes,
+ * highest-order coefficient first. The generator polynomial has the roots
+ * alpha^1 .. alpha^(255-k) over the CCSDS field (see GF256.h), so the output
+ * is byte-for-byte what libcorrect produced for
+ * correct_reed_solomon_create(correct_rs_primitive_polynomial_ccsds, 1, 1, 255 - k).
+ *
+ * Encoding is a GF(256) matrix product: parity = P * data, with P derived
+ * from the generator once per codec. The SIMD kernels transpose 32 codewords
+ * into columns and multiply-accumulate a column per coefficient using
+ * split-nibble PSHUFB lookups (SSSE3: 16 bytes, AVX2: 32 bytes per
+ * instruction). The scalar kernel runs the generator LFSR per codeword. The
+ * kernel is picked from the running CPU unless one is requested.
+ *
+ * Decoding re-encodes the data part and compares it with the stored parity;
+ * only codewords whose parity differs go through Berlekamp-Massey, Chien
+ * search and Forney, and a correction is kept only if the repaired codeword
+ * checks out. Callers that know which symbols are damaged (see
+ * ReedSolomon's segment checksums) can pass them as erasures.
+ *
+ * Codecs hold only immutable tables, so one instance may be used from any
+ * number of threads; shared() hands out a process-wide instance per parity
+ * length.
+ */
+class RsCodec {
+public:
+    static constexpr size_t BLOCK_SIZE = 255;  ///< Codeword length
+    static constexpr size_t BATCH = 32;        ///< Codewords per SIMD batch
+
+    /** @brief Multiply-accumulate implementation */
+    enum class Kernel : uint8_t {
+        Scalar,  ///< Portable LFSR, one codeword at a time
+        Ssse3,   ///< 128-bit PSHUFB split-nibble tables
+        Avx2     ///< 256-bit VPSHUFB split-nibble tables
+    };
+
+    /**
+     * @brief Construct a codec.
+     * @param parity_symbols Parity bytes per codeword (1-254)
+     * @param kernel Implementation to use; falls back to best_kernel() if the
+     *        CPU does not support it
+     * @throws std::invalid_argument if parity_symbols is out of range
+     */
+    explicit RsCodec(size_t parity_symbols, Kernel kernel = best_kernel());
+
+    /**
+     * @brief Process-wide codec for a parity length.
+     * @param parity_symbols Parity bytes per codeword (1-254)
+     * @return Codec using best_kernel(), built on first use
+     */
+    [[nodiscard]] static const RsCodec& shared(size_t parity_symbols);
+
+    /** @brief Fastest kernel the running CPU supports
+     *  @return Kernel */
+    [[nodiscard]] static Kernel best_kernel() noexcept;
+
+    /** @brief Whether the running CPU supports a kernel
+     *  @param kernel Kernel to check
+     *  @return true if usable */
+    [[nodiscard]] static bool kernel_supported(Kernel kernel) noexcept;
+
+    /** @brief Parity bytes per codeword
+     *  @return 255 - data_symbols() */
+    [[nodiscard]] size_t parity_symbols() const noexcept { return m_parity; }
+
+    /** @brief Data bytes per codeword
+     *  @return k */
+    [[nodiscard]] size_t data_symbols() const noexcept { return BLOCK_SIZE - m_parity; }
+
+    /** @brief Kernel in use
+     *  @return Kernel */
+    [[nodiscard]] Kernel kernel() const noexcept { return m_kernel; }
+
+    /**
+     * @brief Encode whole codewords.
+     * @param data n * data_symbols() bytes
+     * @param codewords n * BLOCK_SIZE bytes receiving data and parity
+     * @return false if the sizes do not describe the same number of codewords
+     */
+    bool encode(std::span<const uint8_t> data, std::span<uint8_t> codewords) const;
+
+    /**
+     * @brief Decode whole codewords, correcting symbol errors.
+     * @param codewords n * BLOCK_SIZE bytes (possibly corrupted)
+     * @param data n * data_symbols() bytes receiving the corrected data
+     * @param corrected_per_codeword Empty, or n entries receiving the symbols
+     *        corrected in each codeword
+     * @return Number of corrected symbols, or nullopt if a codeword had more
+     *         than parity_symbols() / 2 errors or the sizes do not match
+     */
+    [[nodiscard]] std::optional<size_t> decode(std::span<const uint8_t> codewords,
+                                               std::span<uint8_t> data,
+                                               std::span<uint8_t> corrected_per_codeword = {}) const;
+
+    /**
+     * @brief Correct one codeword whose unreliable symbols are known.
+     *
+     * Errors-and-erasures decoding: a codeword is recoverable while
+     * 2 * errors + erasures <= parity_symbols(), so erased symbols cost half
+     * what unknown errors do.
+     *
+     * @param codeword BLOCK_SIZE bytes, corrected in place on success
+     * @param erasures Distinct symbol positions (0 = first byte) to treat as erased
+     * @return Number of symbols changed, or nullopt if uncorrectable
+     */
+    [[nodiscard]] std::optional<size_t> correct_erasures(std::span<uint8_t> codeword,
+                                                         std::span<const uint8_t> erasures) const;
+
+private:
+    /** Parity of `count` codewords at `stride` into parity (count * m_parity) */
+    void compute_parity(const uint8_t* data, size_t stride, size_t count, uint8_t* parity) const;
+    void parity_scalar(const uint8_t* message, uint8_t* parity) const;
+    void parity_batch(const uint8_t* data, size_t stride, size_t count, uint8_t* parity) const;
+
+    /**
+     * Locate and correct errors in one codeword.
+     * @param codeword Received codeword, corrected in place on success
+     * @param remainder Received parity XOR recomputed parity
+     * @param erasures Known unreliable positions (may be empty)
+     * @return Corrected symbol count, or nullopt if uncorrectable
+     */
+    std::optional<size_t> correct(uint8_t* codeword, const uint8_t* remainder,
+                                  std::span<const uint8_t> erasures = {}) const;
+
+    size_t m_parity;
+    Kernel m_kernel;
+    std::vector<uint8_t> m_generator;   ///< g(x) coefficients, lowest order first (monic)
+    std::vector<uint8_t> m_lfsr_rows;   ///< Row f: f * g feedback taps for the scalar LFSR
+    std::vector<uint8_t> m_parity_matrix;  ///< m_parity x k: parity byte r += P[r][i] * data[i]
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_RS_CODEC_H
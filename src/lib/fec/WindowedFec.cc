@@ -0,0 +1,288 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "lib/fec/WindowedFec.h"
+#include "lib/fec/Crc32c.h"
+#include "lib/fec/RsCodec.h"
+#include "utils/WorkerRanges.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace KeepTower {
+
+namespace {
+
+constexpr size_t BLOCK = RsCodec::BLOCK_SIZE;
+
+// Below this a worker costs more to start than it saves
+constexpr size_t MIN_BYTES_PER_THREAD = 512 * 1024;
+
+size_t segments(size_t bytes) {
+    return (bytes + WindowedFec::SEGMENT_SIZE - 1) / WindowedFec::SEGMENT_SIZE;
+}
+
+uint32_t load_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+void store_le32(uint8_t* p, uint32_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+/** CRC-32C of segment `index` of a region */
+uint32_t segment_crc(std::span<const uint8_t> region, size_t index) {
+    const size_t offset = index * WindowedFec::SEGMENT_SIZE;
+    return crc32c(region.subspan(offset, std::min(WindowedFec::SEGMENT_SIZE, region.size() - offset)));
+}
+
+}  // namespace
+
+WindowedFec::WindowedFec(size_t parity_symbols, uint32_t window_size)
+    : m_parity(parity_symbols), m_window_size(window_size), m_codec(nullptr) {
+    if (!valid_parameters(parity_symbols, window_size)) {
+        throw std::invalid_argument("Invalid windowed FEC parameters: parity " + std::to_string(parity_symbols) +
+                                    ", window " + std::to_string(window_size));
+    }
+    m_codec = &RsCodec::shared(parity_symbols);
+}
+
+bool WindowedFec::valid_parameters(size_t parity_symbols, uint32_t window_size) noexcept {
+    return parity_symbols >= 1 && parity_symbols < BLOCK &&
+           window_size >= MIN_WINDOW_SIZE && window_size <= MAX_WINDOW_SIZE;
+}
+
+size_t WindowedFec::window_trailer_size(size_t window_bytes) const noexcept {
+    const size_t columns = (window_bytes + (BLOCK - m_parity) - 1) / (BLOCK - m_parity);
+    const size_t parity_bytes = m_parity * columns;
+    return parity_bytes + 4 * (segments(window_bytes) + segments(parity_bytes));
+}
+
+size_t WindowedFec::trailer_size(size_t data_size) const noexcept {
+    if (data_size == 0) {
+        return 0;
+    }
+    const size_t full = data_size / m_window_size;
+    const size_t tail = data_size % m_window_size;
+    return full * window_trailer_size(m_window_size) + (tail != 0 ? window_trailer_size(tail) : 0);
+}
+
+WindowedFec::Window WindowedFec::window(size_t index, size_t data_size) const noexcept {
+    Window w;
+    w.offset = index * m_window_size;
+    w.size = std::min<size_t>(m_window_size, data_size - w.offset);
+    w.columns = (w.size + (BLOCK - m_parity) - 1) / (BLOCK - m_parity);
+    w.trailer_offset = index * window_trailer_size(m_window_size);
+    w.data_segments = segments(w.size);
+    w.parity_segments = segments(m_parity * w.columns);
+    return w;
+}
+
+bool WindowedFec::encode(std::span<const uint8_t> data, std::span<uint8_t> trailer, unsigned max_threads) const {
+    if (trailer.size() != trailer_size(data.size())) {
+        return false;
+    }
+
+    const size_t k = BLOCK - m_parity;
+    const size_t windows = window_count(data.size());
+    const size_t threads = worker_count(max_threads, windows, data.size(), MIN_BYTES_PER_THREAD);
+    return for_each_range(windows, threads, [&](size_t first, size_t last) {
+        std::vector<uint8_t> message;
+        std::vector<uint8_t> codewords;
+
+        for (size_t index = first; index < last; ++index) {
+            const Window w = window(index, data.size());
+            const std::span<const uint8_t> bytes = data.subspan(w.offset, w.size);
+            const size_t d = w.columns;
+
+            // Column c of the row-major window is the data of codeword c
+            message.assign(d * k, 0);
+            for (size_t r = 0; r < k && r * d < w.size; ++r) {
+                const uint8_t* row = bytes.data() + r * d;
+                const size_t cells = std::min(d, w.size - r * d);
+                for (size_t c = 0; c < cells; ++c) {
+                    message[c * k + r] = row[c];
+                }
+            }
+            codewords.resize(d * BLOCK);
+            if (!m_codec->encode(message, codewords)) {
+                return false;
+            }
+
+            uint8_t* parity = trailer.data() + w.trailer_offset;
+            for (size_t j = 0; j < m_parity; ++j) {
+                for (size_t c = 0; c < d; ++c) {
+                    parity[j * d + c] = codewords[c * BLOCK + k + j];
+                }
+            }
+
+            const std::span<const uint8_t> parity_bytes(parity, m_parity * d);
+            uint8_t* checksums = parity + parity_bytes.size();
+            for (size_t s = 0; s < w.data_segments; ++s) {
+                store_le32(checksums + 4 * s, segment_crc(bytes, s));
+            }
+            checksums += 4 * w.data_segments;
+            for (size_t s = 0; s < w.parity_segments; ++s) {
+                store_le32(checksums + 4 * s, segment_crc(parity_bytes, s));
+            }
+        }
+        return true;
+    });
+}
+
+std::optional<std::vector<size_t>> WindowedFec::find_damaged(std::span<const uint8_t> data,
+                                                             std::span<const uint8_t> trailer,
+                                                             unsigned max_threads) const {
+    if (trailer.size() != trailer_size(data.size())) {
+        return std::nullopt;
+    }
+
+    const size_t windows = window_count(data.size());
+    std::vector<uint8_t> damaged(windows, 0);
+    const size_t threads = worker_count(max_threads, windows, data.size(), MIN_BYTES_PER_THREAD);
+    for_each_range(windows, threads, [&](size_t first, size_t last) {
+        for (size_t index = first; index < last; ++index) {
+            const Window w = window(index, data.size());
+            const std::span<const uint8_t> bytes = data.subspan(w.offset, w.size);
+            const std::span<const uint8_t> parity = trailer.subspan(w.trailer_offset, m_parity * w.columns);
+            const uint8_t* checksums = parity.data() + parity.size();
+
+            bool clean = true;
+            for (size_t s = 0; clean && s < w.data_segments; ++s) {
+                clean = segment_crc(bytes, s) == load_le32(checksums + 4 * s);
+            }
+            checksums += 4 * w.data_segments;
+            for (size_t s = 0; clean && s < w.parity_segments; ++s) {
+                clean = segment_crc(parity, s) == load_le32(checksums + 4 * s);
+            }
+            damaged[index] = clean ? 0 : 1;
+        }
+        return true;
+    });
+
+    std::vector<size_t> result;
+    for (size_t index = 0; index < windows; ++index) {
+        if (damaged[index] != 0) {
+            result.push_back(index);
+        }
+    }
+    return result;
+}
+
+std::optional<size_t> WindowedFec::repair(std::span<uint8_t> data,
+                                          std::span<const uint8_t> trailer,
+                                          std::span<const size_t> windows,
+                                          unsigned max_threads) const {
+    if (trailer.size() != trailer_size(data.size())) {
+        return std::nullopt;
+    }
+    const size_t count = window_count(data.size());
+    if (std::any_of(windows.begin(), windows.end(), [count](size_t index) { return index >= count; })) {
+        return std::nullopt;
+    }
+
+    const size_t k = BLOCK - m_parity;
+    std::atomic<size_t> changed{0};
+    const size_t threads = worker_count(max_threads, windows.size(),
+                                             windows.size() * m_window_size, MIN_BYTES_PER_THREAD);
+    const bool ok = for_each_range(windows.size(), threads, [&](size_t first, size_t last) {
+        std::vector<uint8_t> codewords;
+        std::vector<uint8_t> erased;
+        std::array<uint8_t, BLOCK> erasures;
+
+        for (size_t i = first; i < last; ++i) {
+            const Window w = window(windows[i], data.size());
+            const std::span<uint8_t> bytes = data.subspan(w.offset, w.size);
+            const std::span<const uint8_t> parity = trailer.subspan(w.trailer_offset, m_parity * w.columns);
+            const uint8_t* checksums = parity.data() + parity.size();
+            const size_t d = w.columns;
+
+            // Codeword-major copy of the window; cells past its end are zero
+            codewords.assign(d * BLOCK, 0);
+            for (size_t pos = 0; pos < w.size; ++pos) {
+                codewords[(pos % d) * BLOCK + pos / d] = bytes[pos];
+            }
+            for (size_t q = 0; q < parity.size(); ++q) {
+                codewords[(q % d) * BLOCK + k + q / d] = parity[q];
+            }
+
+            // Every symbol of a segment that fails its checksum is an erasure
+            erased.assign(d * BLOCK, 0);
+            for (size_t s = 0; s < w.data_segments; ++s) {
+                if (segment_crc(bytes, s) == load_le32(checksums + 4 * s)) {
+                    continue;
+                }
+                const size_t end = std::min(w.size, (s + 1) * SEGMENT_SIZE);
+                for (size_t pos = s * SEGMENT_SIZE; pos < end; ++pos) {
+                    erased[(pos % d) * BLOCK + pos / d] = 1;
+                }
+            }
+            checksums += 4 * w.data_segments;
+            for (size_t s = 0; s < w.parity_segments; ++s) {
+                if (segment_crc(parity, s) == load_le32(checksums + 4 * s)) {
+                    continue;
+                }
+                const size_t end = std::min(parity.size(), (s + 1) * SEGMENT_SIZE);
+                for (size_t q = s * SEGMENT_SIZE; q < end; ++q) {
+                    erased[(q % d) * BLOCK + k + q / d] = 1;
+                }
+            }
+
+            for (size_t c = 0; c < d; ++c) {
+                uint8_t* codeword = codewords.data() + c * BLOCK;
+                const uint8_t* flags = erased.data() + c * BLOCK;
+                size_t flagged = 0;
+                for (size_t p = 0; p < BLOCK; ++p) {
+                    if (flags[p] != 0) {
+                        erasures[flagged++] = static_cast<uint8_t>(p);
+                    }
+                }
+                if (flagged == 0) {
+                    continue;  // Checksums vouch for every symbol
+                }
+
+                const std::span<uint8_t> symbols(codeword, BLOCK);
+                // Past erasure capacity the flags are no help; try locating errors instead
+                auto fixed = flagged <= m_parity
+                    ? m_codec->correct_erasures(symbols, std::span<const uint8_t>(erasures.data(), flagged))
+                    : std::nullopt;
+                if (!fixed) {
+                    fixed = m_codec->correct_erasures(symbols, {});
+                }
+                if (!fixed) {
+                    return false;
+                }
+
+                size_t repaired = 0;
+                for (size_t r = 0; r < k; ++r) {
+                    const size_t pos = r * d + c;
+                    if (pos >= w.size) {
+                        // A "correction" of the implicit zeros is a miscorrection
+                        if (codeword[r] != 0) {
+                            return false;
+                        }
+                    } else if (bytes[pos] != codeword[r]) {
+                        bytes[pos] = codeword[r];
+                        ++repaired;
+                    }
+                }
+                changed.fetch_add(repaired, std::memory_order_relaxed);
+            }
+        }
+        return true;
+    });
+    if (!ok) {
+        return std::nullopt;
+    }
+    return changed.load();
+}
+
+}  // namespace KeepTower
@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file WindowedFec.h
+ * @brief Windowed Reed-Solomon protection that leaves the data in place
+ */
+
+#ifndef KEEPTOWER_WINDOWED_FEC_H
+#define KEEPTOWER_WINDOWED_FEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace KeepTower {
+
+class RsCodec;
+
+/**
+ * @brief Systematic RS(255,k) protection for large buffers, one window at a time.
+ *
+ * The protected data is not rewritten: parity and checksums go into a
+ * separate trailer, so a clean buffer is used exactly where it lies (for
+ * instance in a mapped file) and never copied.
+ *
+ * The data is cut into windows of window_size() bytes (the last may be
+ * shorter). A window of n bytes is read as a row-major matrix with
+ * D = ceil(n / k) columns; column c is the data part of codeword c, so byte
+ * i of the window is symbol i / D of codeword i % D. Matrix cells past the
+ * end of the window are implicit zeros. A burst of B bytes therefore costs
+ * every codeword of the window about B / D symbols.
+ *
+ * The trailer holds, for each window in order:
+ * @code
+ * +------------------------+
+ * | Parity                 | parity * D bytes, row-major like the data
+ * | Data checksums         | u32 LE CRC-32C per SEGMENT_SIZE slice of the window
+ * | Parity checksums       | u32 LE CRC-32C per SEGMENT_SIZE slice of the parity
+ * +------------------------+
+ * @endcode
+ *
+ * find_damaged() only checksums; repair() decodes just the windows it is
+ * given, treating every symbol of a mismatching segment as an erasure (half
+ * the cost of an unlocated error). Working memory is a few window-sized
+ * buffers per worker thread, whatever the size of the data.
+ */
+class WindowedFec {
+public:
+    static constexpr size_t SEGMENT_SIZE = 4096;                  ///< Bytes covered by each CRC-32C
+    static constexpr uint32_t DEFAULT_WINDOW_SIZE = 1024 * 1024;  ///< Data bytes per window
+    static constexpr uint32_t MIN_WINDOW_SIZE = 4096;             ///< Smallest accepted window
+    static constexpr uint32_t MAX_WINDOW_SIZE = 16 * 1024 * 1024; ///< Largest accepted window
+
+    /**
+     * @brief Construct a coder
+     * @param parity_symbols Parity bytes per codeword (1-254)
+     * @param window_size Data bytes per window (MIN_WINDOW_SIZE..MAX_WINDOW_SIZE)
+     * @throws std::invalid_argument if a parameter is out of range
+     */
+    explicit WindowedFec(size_t parity_symbols, uint32_t window_size = DEFAULT_WINDOW_SIZE);
+
+    /** @brief Whether parameters read from disk are usable
+     *  @param parity_symbols Parity bytes per codeword
+     *  @param window_size Data bytes per window
+     *  @return true if the constructor would accept them */
+    [[nodiscard]] static bool valid_parameters(size_t parity_symbols, uint32_t window_size) noexcept;
+
+    /** @brief Parity bytes per codeword
+     *  @return 255 - k */
+    [[nodiscard]] size_t parity_symbols() const noexcept { return m_parity; }
+
+    /** @brief Data bytes per window
+     *  @return Window size */
+    [[nodiscard]] uint32_t window_size() const noexcept { return m_window_size; }
+
+    /** @brief Windows covering a buffer
+     *  @param data_size Protected bytes
+     *  @return ceil(data_size / window_size()) */
+    [[nodiscard]] size_t window_count(size_t data_size) const noexcept {
+        return (data_size + m_window_size - 1) / m_window_size;
+    }
+
+    /** @brief Trailer length for a buffer
+     *  @param data_size Protected bytes
+     *  @return Bytes encode() writes */
+    [[nodiscard]] size_t trailer_size(size_t data_size) const noexcept;
+
+    /**
+     * @brief Compute the trailer for a buffer
+     * @param data Bytes to protect
+     * @param trailer trailer_size(data.size()) bytes receiving parity and checksums
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return false if the trailer has the wrong size
+     */
+    bool encode(std::span<const uint8_t> data, std::span<uint8_t> trailer, unsigned max_threads = 0) const;
+
+    /**
+     * @brief Windows whose data or parity fails its checksums
+     * @param data Protected bytes (possibly corrupted)
+     * @param trailer Trailer written by encode() (possibly corrupted)
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return Damaged window indexes in ascending order (empty if clean), or
+     *         nullopt if the trailer has the wrong size
+     */
+    [[nodiscard]] std::optional<std::vector<size_t>> find_damaged(std::span<const uint8_t> data,
+                                                                  std::span<const uint8_t> trailer,
+                                                                  unsigned max_threads = 0) const;
+
+    /**
+     * @brief Repair windows in place
+     * @param data Protected bytes; the listed windows are corrected in place
+     * @param trailer Trailer written by encode() (possibly corrupted)
+     * @param windows Windows to decode, typically from find_damaged()
+     * @param max_threads Worker threads to use (0 = hardware concurrency)
+     * @return Number of data bytes changed, or nullopt if a window is beyond
+     *         repair (data is then partially repaired and must not be trusted)
+     */
+    [[nodiscard]] std::optional<size_t> repair(std::span<uint8_t> data,
+                                               std::span<const uint8_t> trailer,
+                                               std::span<const size_t> windows,
+                                               unsigned max_threads = 0) const;
+
+private:
+    /** @brief Geometry of one window */
+    struct Window {
+        size_t offset;          ///< First data byte
+        size_t size;            ///< Data bytes (n)
+        size_t columns;         ///< Codewords (D)
+        size_t trailer_offset;  ///< First trailer byte
+        size_t data_segments;   ///< Checksums over the data
+        size_t parity_segments; ///< Checksums over the parity
+    };
+
+    [[nodiscard]] Window window(size_t index, size_t data_size) const noexcept;
+    [[nodiscard]] size_t window_trailer_size(size_t window_bytes) const noexcept;
+
+    size_t m_parity;
+    uint32_t m_window_size;
+    const RsCodec* m_codec;
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_WINDOWED_FEC_H
@@ -0,0 +1,308 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "BackupManifest.h"
+#include "VaultIO.h"
+#include "utils/Log.h"
+
+#include <openssl/evp.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+namespace KeepTower {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::string_view MANIFEST_SIGNATURE = "# KeepTower backup manifest 1";
+
+/// VaultFormatV2::VAULT_MAGIC; the storage layer sits below vaultformat
+constexpr uint32_t VAULT_MAGIC_V2 = 0x4B505457;
+
+/// Serialises every read-modify-write of a manifest in this process
+std::mutex& manifest_mutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+bool is_service_style_backup_name(const std::string& vault_filename, const std::string& filename) {
+    const std::string prefix = vault_filename + ".";
+    const std::string suffix = ".backup";
+
+    return filename.size() > prefix.size() + suffix.size() &&
+           filename.starts_with(prefix) &&
+           filename.ends_with(suffix);
+}
+
+bool is_legacy_style_backup_name(const std::string& vault_filename, const std::string& filename) {
+    const std::string prefix = vault_filename + ".backup.";
+    return filename.starts_with(prefix);
+}
+
+void sort_newest_first(std::vector<BackupManifestEntry>& entries) {
+    std::sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+        return a.created_ms != b.created_ms ? a.created_ms > b.created_ms : a.filename > b.filename;
+    });
+}
+
+std::string to_hex(std::span<const uint8_t> bytes) {
+    static constexpr char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (uint8_t b : bytes) {
+        out.push_back(digits[b >> 4]);
+        out.push_back(digits[b & 0x0F]);
+    }
+    return out;
+}
+
+bool from_hex(std::string_view hex, std::span<uint8_t> out) {
+    if (hex.size() != out.size() * 2) {
+        return false;
+    }
+    for (size_t i = 0; i < out.size(); ++i) {
+        const auto* first = hex.data() + 2 * i;
+        if (std::from_chars(first, first + 2, out[i], 16).ptr != first + 2) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<BackupManifestEntry> parse_line(const std::string& line) {
+    std::istringstream in(line);
+    BackupManifestEntry entry;
+    std::string digest;
+    std::string flags;
+    if (!(in >> entry.created_ms >> entry.size >> digest >> flags)) {
+        return std::nullopt;
+    }
+    in >> std::ws;
+    std::getline(in, entry.filename);
+    if (entry.filename.empty() || entry.filename.find('/') != std::string::npos ||
+        !from_hex(digest, entry.header_digest)) {
+        return std::nullopt;
+    }
+    const auto [ptr, ec] = std::from_chars(flags.data(), flags.data() + flags.size(), entry.flags, 16);
+    if (ec != std::errc{} || ptr != flags.data() + flags.size()) {
+        return std::nullopt;
+    }
+    return entry;
+}
+
+/// Read a manifest; nullopt when it is missing or any line is malformed
+std::optional<std::vector<BackupManifestEntry>> read_manifest(const fs::path& path) {
+    std::ifstream in(path);
+    if (!in) {
+        return std::nullopt;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != MANIFEST_SIGNATURE) {
+        Log::warning("BackupManifest: Ignoring unrecognised manifest {}", path.string());
+        return std::nullopt;
+    }
+
+    std::vector<BackupManifestEntry> entries;
+    while (std::getline(in, line)) {
+        if (line.empty()) {
+            continue;
+        }
+        auto entry = parse_line(line);
+        if (!entry) {
+            Log::warning("BackupManifest: Ignoring corrupt manifest {}", path.string());
+            return std::nullopt;
+        }
+        entries.push_back(std::move(*entry));
+    }
+    sort_newest_first(entries);
+    return entries;
+}
+
+/// Replace a manifest through a staging file and rename()
+bool write_manifest(const fs::path& path, const std::vector<BackupManifestEntry>& entries) {
+    const fs::path staging = path.parent_path() / (path.filename().string() + ".tmp");
+    try {
+        {
+            std::ofstream out(staging, std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+            out << MANIFEST_SIGNATURE << '\n';
+            for (const auto& entry : entries) {
+                out << entry.created_ms << ' ' << entry.size << ' '
+                    << to_hex(entry.header_digest) << ' '
+                    << std::hex << entry.flags << std::dec << ' '
+                    << entry.filename << '\n';
+            }
+            out.flush();
+            if (!out) {
+                throw fs::filesystem_error("short write", staging, std::make_error_code(std::errc::io_error));
+            }
+        }
+        fs::permissions(staging, fs::perms::owner_read | fs::perms::owner_write, fs::perm_options::replace);
+        fs::rename(staging, path);
+        return true;
+    } catch (const fs::filesystem_error& e) {
+        Log::warning("BackupManifest: Failed to write {}: {}", path.string(), e.what());
+        std::error_code ec;
+        fs::remove(staging, ec);
+        return false;
+    }
+}
+
+int64_t to_epoch_ms(fs::file_time_type time) {
+    const auto system_time = std::chrono::file_clock::to_sys(time);
+    return std::chrono::duration_cast<std::chrono::milliseconds>(system_time.time_since_epoch()).count();
+}
+
+/// One-off directory scan used when there is no usable manifest
+std::vector<BackupManifestEntry> scan_directory(const fs::path& directory, const std::string& vault_filename) {
+    std::vector<BackupManifestEntry> entries;
+    std::error_code ec;
+    if (!fs::exists(directory, ec)) {
+        return entries;
+    }
+
+    try {
+        for (const auto& file : fs::directory_iterator(directory)) {
+            if (!file.is_regular_file()) {
+                continue;
+            }
+
+            const std::string filename = file.path().filename().string();
+            if (!is_legacy_style_backup_name(vault_filename, filename) &&
+                !is_service_style_backup_name(vault_filename, filename)) {
+                continue;
+            }
+
+            auto entry = BackupManifest::describe(file.path(), to_epoch_ms(file.last_write_time()));
+            if (entry) {
+                entries.push_back(std::move(*entry));
+            }
+        }
+    } catch (const fs::filesystem_error& e) {
+        Log::warning("BackupManifest: Failed to scan {}: {}", directory.string(), e.what());
+    }
+    sort_newest_first(entries);
+    return entries;
+}
+
+}  // namespace
+
+fs::path BackupManifest::directory_for(std::string_view vault_path, std::string_view backup_dir) {
+    if (!backup_dir.empty()) {
+        return fs::path(backup_dir);
+    }
+    fs::path parent = fs::path(vault_path).parent_path();
+    return parent.empty() ? fs::path(".") : parent;
+}
+
+fs::path BackupManifest::path_for(std::string_view vault_path, std::string_view backup_dir) {
+    // The leading '.' keeps the manifest out of both backup name patterns
+    return directory_for(vault_path, backup_dir) /
+           ("." + fs::path(vault_path).filename().string() + ".backups");
+}
+
+VaultResult<BackupManifestEntry> BackupManifest::describe(const fs::path& backup_file, int64_t created_ms) {
+    std::ifstream in(backup_file, std::ios::binary | std::ios::ate);
+    if (!in) {
+        std::error_code ec;
+        return std::unexpected(fs::exists(backup_file, ec) ? VaultError::FileReadFailed : VaultError::FileNotFound);
+    }
+
+    BackupManifestEntry entry;
+    entry.filename = backup_file.filename().string();
+    entry.created_ms = created_ms;
+    entry.size = static_cast<uint64_t>(in.tellg());
+    entry.flags = BackupManifestEntry::COMPLETE;  // Staging copies never carry a backup name
+
+    std::array<char, HEADER_DIGEST_BYTES> head{};
+    in.seekg(0);
+    in.read(head.data(), static_cast<std::streamsize>(std::min<uint64_t>(entry.size, head.size())));
+    const size_t head_size = static_cast<size_t>(in.gcount());
+
+    unsigned int digest_size = 0;
+    if (EVP_Digest(head.data(), head_size, entry.header_digest.data(), &digest_size, EVP_sha256(), nullptr) != 1) {
+        return std::unexpected(VaultError::FileReadFailed);
+    }
+
+    uint32_t magic = 0;
+    if (head_size >= sizeof(magic)) {
+        std::memcpy(&magic, head.data(), sizeof(magic));
+        if (magic == VaultIO::VAULT_MAGIC || magic == VAULT_MAGIC_V2) {
+            entry.flags |= BackupManifestEntry::HEADER_RECOGNISED;
+        }
+    }
+    return entry;
+}
+
+std::vector<BackupManifestEntry> BackupManifest::load(std::string_view vault_path, std::string_view backup_dir) {
+    const fs::path manifest = path_for(vault_path, backup_dir);
+    std::lock_guard lock(manifest_mutex());
+
+    if (auto entries = read_manifest(manifest)) {
+        return std::move(*entries);
+    }
+
+    auto entries = scan_directory(directory_for(vault_path, backup_dir), fs::path(vault_path).filename().string());
+    if (!entries.empty()) {
+        (void)write_manifest(manifest, entries);
+    }
+    return entries;
+}
+
+VaultResult<> BackupManifest::add(std::string_view vault_path, std::string_view backup_dir, BackupManifestEntry entry) {
+    const fs::path manifest = path_for(vault_path, backup_dir);
+    std::lock_guard lock(manifest_mutex());
+
+    auto entries = read_manifest(manifest);
+    if (!entries) {
+        // Fold in backups written before the manifest existed (this one included)
+        entries = scan_directory(directory_for(vault_path, backup_dir), fs::path(vault_path).filename().string());
+    }
+    std::erase_if(*entries, [&](const auto& existing) { return existing.filename == entry.filename; });
+    entries->push_back(std::move(entry));
+    sort_newest_first(*entries);
+
+    if (!write_manifest(manifest, *entries)) {
+        return std::unexpected(VaultError::FileWriteFailed);
+    }
+    return {};
+}
+
+VaultResult<> BackupManifest::remove(std::string_view vault_path,
+                                     std::string_view backup_dir,
+                                     std::span<const std::string> filenames) {
+    const fs::path manifest = path_for(vault_path, backup_dir);
+    std::lock_guard lock(manifest_mutex());
+
+    auto entries = read_manifest(manifest);
+    if (!entries) {
+        return {};  // Nothing indexed; the next load() rescans
+    }
+    std::erase_if(*entries, [&](const auto& entry) {
+        return std::find(filenames.begin(), filenames.end(), entry.filename) != filenames.end();
+    });
+
+    if (!write_manifest(manifest, *entries)) {
+        return std::unexpected(VaultError::FileWriteFailed);
+    }
+    return {};
+}
+
+void BackupManifest::invalidate(std::string_view vault_path, std::string_view backup_dir) {
+    std::lock_guard lock(manifest_mutex());
+    std::error_code ec;
+    fs::remove(path_for(vault_path, backup_dir), ec);
+}
+
+}  // namespace KeepTower
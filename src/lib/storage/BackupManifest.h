@@ -0,0 +1,147 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file BackupManifest.h
+ * @brief Per-vault index of backup files
+ */
+
+#ifndef KEEPTOWER_BACKUP_MANIFEST_H
+#define KEEPTOWER_BACKUP_MANIFEST_H
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "VaultError.h"
+
+namespace KeepTower {
+
+/**
+ * @brief One backup recorded in a BackupManifest
+ */
+struct BackupManifestEntry {
+    /// Validity flags, recorded when the backup is described
+    enum Flags : uint32_t {
+        COMPLETE = 1u << 0,           ///< Copy finished and was renamed into place
+        HEADER_RECOGNISED = 1u << 1,  ///< File starts with a V1 or V2 vault magic
+    };
+
+    std::string filename;                      ///< Backup name, relative to the manifest's directory
+    int64_t created_ms = 0;                    ///< Creation time, Unix epoch milliseconds
+    uint64_t size = 0;                         ///< File size in bytes
+    std::array<uint8_t, 32> header_digest{};   ///< SHA-256 of the leading bytes of the file
+    uint32_t flags = 0;                        ///< Combination of Flags
+
+    /** @brief Whether the backup is a candidate for restore
+     *  @return true when the copy completed and carries a vault header */
+    [[nodiscard]] bool is_intact() const noexcept {
+        return (flags & (COMPLETE | HEADER_RECOGNISED)) == (COMPLETE | HEADER_RECOGNISED);
+    }
+};
+
+/**
+ * @brief Index of one vault's backups, kept next to the backup files
+ *
+ * Listing, restore selection and retention used to scan the whole backup
+ * directory and string-match every name on each save. With a directory
+ * shared by many vaults that cost grows with every file in it; the manifest
+ * reduces it to reading one small file holding only this vault's entries.
+ *
+ * The manifest lives at `<backup dir>/.<vault filename>.backups`. It is a
+ * text file with one entry per line, newest first:
+ * @code
+ * # KeepTower backup manifest 1
+ * <created_ms> <size> <header_digest hex> <flags hex> <filename>
+ * @endcode
+ *
+ * Every update rewrites it through a staging file and rename(), so readers
+ * see either the old or the new index. When the manifest is missing or
+ * unreadable (first run, older versions, manual cleanup) it is rebuilt from
+ * a one-off directory scan that recognises both backup naming conventions.
+ *
+ * @note Updates are serialised within the process. Like VaultIO, concurrent
+ *       writers in separate processes are not coordinated.
+ */
+class BackupManifest {
+public:
+    /// Bytes covered by BackupManifestEntry::header_digest
+    static constexpr size_t HEADER_DIGEST_BYTES = 4096;
+
+    /**
+     * @brief Directory holding a vault's backups and manifest
+     * @param vault_path Vault file path
+     * @param backup_dir Backup directory override (empty = vault's directory)
+     * @return Backup directory
+     */
+    [[nodiscard]] static std::filesystem::path directory_for(std::string_view vault_path,
+                                                             std::string_view backup_dir);
+
+    /**
+     * @brief Manifest location for a vault
+     * @param vault_path Vault file path
+     * @param backup_dir Backup directory override (empty = vault's directory)
+     * @return Path of the manifest file
+     */
+    [[nodiscard]] static std::filesystem::path path_for(std::string_view vault_path,
+                                                        std::string_view backup_dir);
+
+    /**
+     * @brief Describe a backup file as it is on disk
+     * @param backup_file Backup file to inspect (the first HEADER_DIGEST_BYTES are read)
+     * @param created_ms Creation time to record
+     * @return Entry with size, digest and flags, or FileNotFound / FileReadFailed
+     */
+    [[nodiscard]] static VaultResult<BackupManifestEntry> describe(const std::filesystem::path& backup_file,
+                                                                   int64_t created_ms);
+
+    /**
+     * @brief Load a vault's backup entries, newest first
+     *
+     * Rebuilds and stores the manifest from a directory scan when it is
+     * missing or unreadable.
+     * @param vault_path Vault file path
+     * @param backup_dir Backup directory override (empty = vault's directory)
+     * @return Entries sorted newest first (empty if there are none)
+     */
+    [[nodiscard]] static std::vector<BackupManifestEntry> load(std::string_view vault_path,
+                                                               std::string_view backup_dir);
+
+    /**
+     * @brief Record a backup, replacing any entry with the same filename
+     * @param vault_path Vault file path
+     * @param backup_dir Backup directory override (empty = vault's directory)
+     * @param entry Entry to record
+     * @return Success or FileWriteFailed
+     */
+    [[nodiscard]] static VaultResult<> add(std::string_view vault_path,
+                                           std::string_view backup_dir,
+                                           BackupManifestEntry entry);
+
+    /**
+     * @brief Drop entries for backups that no longer exist
+     * @param vault_path Vault file path
+     * @param backup_dir Backup directory override (empty = vault's directory)
+     * @param filenames Names of the entries to drop
+     * @return Success or FileWriteFailed
+     */
+    [[nodiscard]] static VaultResult<> remove(std::string_view vault_path,
+                                              std::string_view backup_dir,
+                                              std::span<const std::string> filenames);
+
+    /**
+     * @brief Delete the manifest so the next load() rebuilds it
+     * @param vault_path Vault file path
+     * @param backup_dir Backup directory override (empty = vault's directory)
+     */
+    static void invalidate(std::string_view vault_path, std::string_view backup_dir);
+
+    BackupManifest() = delete;
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_BACKUP_MANIFEST_H
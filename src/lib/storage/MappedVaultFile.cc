@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include "MappedVaultFile.h"
+#include "utils/Log.h"
+
+#include <utility>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <filesystem>
+#include <fstream>
+#endif
+
+namespace KeepTower {
+
+VaultResult<MappedVaultFile> MappedVaultFile::open(const std::string& path) {
+    MappedVaultFile file;
+
+#ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) {
+        const int err = errno;
+        Log::error("MappedVaultFile: Failed to open {}: {}", path, std::strerror(err));
+        return std::unexpected(err == ENOENT ? VaultError::FileNotFound : VaultError::FileReadError);
+    }
+
+    struct stat st {};
+    if (fstat(fd, &st) != 0) {
+        Log::error("MappedVaultFile: Failed to stat {}", path);
+        ::close(fd);
+        return std::unexpected(VaultError::FileReadError);
+    }
+    if (!S_ISREG(st.st_mode)) {
+        Log::error("MappedVaultFile: Not a regular file: {}", path);
+        ::close(fd);
+        return std::unexpected(VaultError::FileReadError);
+    }
+    if (st.st_size < 0 || static_cast<uint64_t>(st.st_size) > MAX_FILE_SIZE) {
+        Log::error("MappedVaultFile: Vault file too large: {} ({} bytes)", path, st.st_size);
+        ::close(fd);
+        return std::unexpected(VaultError::InvalidData);
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return file;  // mmap() rejects zero-length mappings
+    }
+
+    void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping keeps its own reference
+    if (addr == MAP_FAILED) {
+        Log::error("MappedVaultFile: Failed to map {}: {}", path, std::strerror(errno));
+        return std::unexpected(VaultError::FileReadError);
+    }
+#ifdef MADV_WILLNEED
+    // Header, then the whole payload: start readahead for all of it
+    (void)madvise(addr, size, MADV_WILLNEED);
+#endif
+
+    file.m_data = static_cast<const uint8_t*>(addr);
+    file.m_size = size;
+    file.m_mapped = true;
+#else
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_regular_file(fs::symlink_status(path, ec))) {
+        Log::error("MappedVaultFile: Not a regular file: {}", path);
+        return std::unexpected(fs::exists(path, ec) ? VaultError::FileReadError : VaultError::FileNotFound);
+    }
+
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    const std::streamsize size = in ? static_cast<std::streamsize>(in.tellg()) : -1;
+    if (size < 0) {
+        Log::error("MappedVaultFile: Failed to open {}", path);
+        return std::unexpected(VaultError::FileReadError);
+    }
+    if (static_cast<uint64_t>(size) > MAX_FILE_SIZE) {
+        Log::error("MappedVaultFile: Vault file too large: {} ({} bytes)", path, size);
+        return std::unexpected(VaultError::InvalidData);
+    }
+
+    file.m_buffer.resize(static_cast<size_t>(size));
+    in.seekg(0, std::ios::beg);
+    if (!in.read(reinterpret_cast<char*>(file.m_buffer.data()), size)) {
+        Log::error("MappedVaultFile: Failed to read {}", path);
+        return std::unexpected(VaultError::FileReadError);
+    }
+    file.m_data = file.m_buffer.data();
+    file.m_size = file.m_buffer.size();
+#endif
+
+    return file;
+}
+
+MappedVaultFile::~MappedVaultFile() noexcept {
+    release();
+}
+
+MappedVaultFile::MappedVaultFile(MappedVaultFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)),
+      m_mapped(std::exchange(other.m_mapped, false)),
+      m_buffer(std::move(other.m_buffer)) {}
+
+MappedVaultFile& MappedVaultFile::operator=(MappedVaultFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_mapped = std::exchange(other.m_mapped, false);
+        m_buffer = std::move(other.m_buffer);
+    }
+    return *this;
+}
+
+void MappedVaultFile::release() noexcept {
+#ifndef _WIN32
+    if (m_mapped && m_data) {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+    m_buffer.clear();
+}
+
+}  // namespace KeepTower
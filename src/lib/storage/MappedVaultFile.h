@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file MappedVaultFile.h
+ * @brief Read-only memory mapping of a vault file
+ */
+
+#ifndef KEEPTOWER_MAPPED_VAULT_FILE_H
+#define KEEPTOWER_MAPPED_VAULT_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "VaultError.h"
+
+namespace KeepTower {
+
+/**
+ * @brief Read-only view of a complete vault file
+ *
+ * The vault open path parses the header, decodes header FEC and decrypts the
+ * payload straight out of this view, so the ciphertext is never copied into
+ * an intermediate buffer and peak memory during open is roughly one plaintext.
+ *
+ * @section mapped_vault_file_security Security
+ * - Opened once with O_NOFOLLOW | O_CLOEXEC; every check (regular file, size
+ *   limit) uses fstat() on that descriptor, so there is no TOCTOU window
+ *   between validation and reading
+ * - Mapped PROT_READ / MAP_PRIVATE; the descriptor is closed after mapping
+ * - Vault bytes are ciphertext, so the mapping is not locked or cleansed
+ *
+ * @section mapped_vault_file_lifetime Lifetime
+ * Writers never modify a vault file in place: full saves rename a new file
+ * over it and journal appends only grow it, so an existing mapping stays
+ * valid for as long as it is held. A foreign process truncating the file
+ * while it is mapped would fault on access; callers keep the mapping only
+ * for the duration of an open.
+ *
+ * Platforms without mmap() fall back to reading the file into an owned
+ * buffer behind the same interface.
+ *
+ * @note Move-only; the view returned by bytes() is invalidated by destruction
+ *       or move-assignment (moving keeps the address of the mapped bytes).
+ */
+class MappedVaultFile {
+public:
+    /// Largest file accepted (coarse guard against hostile inputs)
+    static constexpr size_t MAX_FILE_SIZE = 1024ULL * 1024 * 1024;  // 1 GiB
+
+    /**
+     * @brief Open and map a vault file
+     * @param path Path to the vault file (symlinks are rejected)
+     * @return Mapped file, or FileNotFound / FileReadError / InvalidData
+     */
+    [[nodiscard]] static VaultResult<MappedVaultFile> open(const std::string& path);
+
+    /** @brief Empty view */
+    MappedVaultFile() noexcept = default;
+    ~MappedVaultFile() noexcept;
+
+    MappedVaultFile(const MappedVaultFile&) = delete;
+    MappedVaultFile& operator=(const MappedVaultFile&) = delete;
+
+    /** @brief Take over another mapping */
+    MappedVaultFile(MappedVaultFile&& other) noexcept;
+
+    /** @brief Release the current mapping and take over another
+     *  @return Reference to this mapping */
+    MappedVaultFile& operator=(MappedVaultFile&& other) noexcept;
+
+    /** @brief File contents
+     *  @return View valid while this object lives */
+    [[nodiscard]] std::span<const uint8_t> bytes() const noexcept { return {m_data, m_size}; }
+
+    /** @brief File size in bytes
+     *  @return Size of the mapped view */
+    [[nodiscard]] size_t size() const noexcept { return m_size; }
+
+    /** @brief Whether the file is empty
+     *  @return true for a zero-length file or a default-constructed view */
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+
+private:
+    void release() noexcept;
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    bool m_mapped = false;           ///< m_data points at an mmap() region
+    std::vector<uint8_t> m_buffer;   ///< Owned copy where mmap() is unavailable
+};
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_MAPPED_VAULT_FILE_H
@@ -7,6 +7,7 @@
  */
 
 #include "VaultIO.h"
+#include "BackupManifest.h"
 #include "utils/Log.h"
 
 #include <fstream>
@@ -16,7 +17,10 @@
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <limits>
+#include <span>
 
 // Platform-specific headers for file operations
 #ifdef __linux__
@@ -24,25 +28,122 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 #endif
 
 namespace KeepTower {
 
 namespace {
 
-bool is_service_style_backup_name(const std::string& vault_filename, const std::string& filename) {
-    const std::string prefix = vault_filename + ".";
-    const std::string suffix = ".backup";
+/// Directory prefix for paths built from manifest filenames; matches the
+/// paths create_backup() returns
+std::filesystem::path backup_location(std::string_view path, std::string_view backup_dir) {
+    return backup_dir.empty() ? std::filesystem::path(path).parent_path() : std::filesystem::path(backup_dir);
+}
+
+#ifdef __linux__
+/**
+ * @brief Copy @p src_fd into the empty file @p dst_fd as cheaply as possible
+ *
+ * A reflink (FICLONE) shares extents with the source on btrfs, XFS and
+ * similar filesystems, so the copy costs no data I/O at all. Otherwise
+ * copy_file_range() keeps the copy in the kernel (and may still be offloaded
+ * by the filesystem or NFS server); plain read/write is the last resort for
+ * filesystems that support neither.
+ */
+bool copy_file_contents(int src_fd, int dst_fd) {
+#ifdef FICLONE
+    if (ioctl(dst_fd, FICLONE, src_fd) == 0) {
+        return true;
+    }
+#endif
+
+    for (;;) {
+        const ssize_t n = copy_file_range(src_fd, nullptr, dst_fd, nullptr, 1 << 30, 0);
+        if (n == 0) {
+            return true;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EXDEV || errno == EINVAL || errno == ENOSYS || errno == EOPNOTSUPP) {
+                break;
+            }
+            return false;
+        }
+    }
 
-    return filename.size() > prefix.size() + suffix.size() &&
-           filename.starts_with(prefix) &&
-           filename.ends_with(suffix);
+    // Neither offload is available; restart from the beginning in case
+    // copy_file_range() gave up after copying part of the file
+    if (lseek(src_fd, 0, SEEK_SET) < 0 || lseek(dst_fd, 0, SEEK_SET) < 0 || ftruncate(dst_fd, 0) != 0) {
+        return false;
+    }
+    std::array<char, 64 * 1024> buffer{};
+    for (;;) {
+        const ssize_t n = read(src_fd, buffer.data(), buffer.size());
+        if (n == 0) {
+            return true;
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        for (ssize_t done = 0; done < n;) {
+            const ssize_t w = write(dst_fd, buffer.data() + done, static_cast<size_t>(n - done));
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            done += w;
+        }
+    }
 }
 
-bool is_legacy_style_backup_name(const std::string& vault_filename, const std::string& filename) {
-    const std::string prefix = vault_filename + ".backup.";
-    return filename.starts_with(prefix);
+/**
+ * @brief Copy a vault file to @p dst through a hidden staging file
+ *
+ * The staging name starts with '.', so a half-written copy is never picked
+ * up by list_backups() or restore; it only gains its backup name by rename().
+ */
+bool copy_vault_file(const std::filesystem::path& src, const std::filesystem::path& dst) {
+    const int src_fd = open(src.c_str(), O_RDONLY | O_CLOEXEC);
+    if (src_fd < 0) {
+        return false;
+    }
+
+    const std::filesystem::path staging =
+        dst.parent_path() / ("." + dst.filename().string() + ".partial");
+    const int dst_fd = open(staging.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (dst_fd < 0) {
+        close(src_fd);
+        return false;
+    }
+
+    bool ok = copy_file_contents(src_fd, dst_fd);
+    int err = errno;
+    if (close(dst_fd) != 0 && ok) {
+        ok = false;
+        err = errno;
+    }
+    close(src_fd);
+
+    if (ok) {
+        if (rename(staging.c_str(), dst.c_str()) == 0) {
+            return true;
+        }
+        err = errno;
+    }
+    unlink(staging.c_str());
+    errno = err;  // Reported by the caller
+    return false;
 }
+#endif
 
 }  // namespace
 
@@ -55,7 +156,8 @@ bool VaultIO::read_file(
     try {
 #ifdef __linux__
         // SECURITY FIX: Use file descriptor to prevent TOCTOU race condition
-        // Open with O_NOFOLLOW to prevent symlink attacks
+        // Open with O_NOFOLLOW to prevent symlink attacks. Every check and
+        // every read below goes through this one descriptor.
         int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
         if (fd < 0) {
             std::cerr << "Failed to open vault file: " << path << " (errno: " << errno << ")\n";
@@ -77,98 +179,107 @@ bool VaultIO::read_file(
             return false;
         }
 
-        // Create ifstream from file descriptor
-        // Note: We need to use low-level API for this
-        std::ifstream file;
-        // Unfortunately, there's no portable way to construct ifstream from fd
-        // We'll read manually and close the fd
-        close(fd);
+        const std::streamsize size = static_cast<std::streamsize>(st.st_size);
 
-        // Reopen with ifstream (now we know it's safe)
-        file.open(path, std::ios::binary);
+        // Read [offset, offset + out.size()) from the descriptor
+        auto read_at = [fd](std::span<uint8_t> out, size_t offset) {
+            size_t done = 0;
+            while (done < out.size()) {
+                const ssize_t n = pread(fd, out.data() + done, out.size() - done,
+                                        static_cast<off_t>(offset + done));
+                if (n < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (n <= 0) {
+                    return false;
+                }
+                done += static_cast<size_t>(n);
+            }
+            return true;
+        };
 #else
         // Non-Linux platforms: Use standard ifstream (best effort)
-        std::ifstream file(path, std::ios::binary);
-#endif
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
         if (!file.is_open()) {
             std::cerr << "Failed to open vault file: " << path << '\n';
             return false;
         }
-
-        file.seekg(0, std::ios::end);
-        std::streamsize size = file.tellg();
+        const std::streamsize size = file.tellg();
+
+        auto read_at = [&file](std::span<uint8_t> out, size_t offset) {
+            file.clear();
+            file.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+            return static_cast<bool>(file.read(reinterpret_cast<char*>(out.data()),
+                                               static_cast<std::streamsize>(out.size())));
+        };
+#endif
 
         if (size < 0) {
             std::cerr << "Failed to determine vault file size" << '\n';
+#ifdef __linux__
+            close(fd);
+#endif
             return false;
         }
 
         // Prevent excessive allocations on corrupted/hostile inputs.
         // This is a coarse safety check; format-specific limits are validated elsewhere.
         constexpr std::streamsize MAX_VAULT_FILE_SIZE = 1024LL * 1024 * 1024;  // 1 GiB
-        if (size > MAX_VAULT_FILE_SIZE) {
+        if (size > MAX_VAULT_FILE_SIZE ||
+            static_cast<std::uintmax_t>(size) > std::numeric_limits<size_t>::max()) {
             std::cerr << "Vault file too large: " << size << " bytes" << '\n';
+#ifdef __linux__
+            close(fd);
+#endif
             return false;
         }
 
-        if (static_cast<std::uintmax_t>(size) > std::numeric_limits<size_t>::max()) {
-            std::cerr << "Vault file size overflows addressable memory" << '\n';
-            return false;
-        }
-
-        file.seekg(0, std::ios::beg);
-
         // Check if file has the new format with magic header
         constexpr size_t HEADER_SIZE = sizeof(uint32_t) * 3;  // magic + version + iterations
         pbkdf2_iterations = DEFAULT_PBKDF2_ITERATIONS;
+        size_t skip = 0;  // Leading bytes not returned to the caller
 
         if (size >= static_cast<std::streamsize>(HEADER_SIZE)) {
+            std::array<uint8_t, HEADER_SIZE> header{};
             uint32_t magic = 0;
             uint32_t version = 0;
             uint32_t iterations = 0;
 
-            if (!file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) ||
-                !file.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
-                !file.read(reinterpret_cast<char*>(&iterations), sizeof(iterations))) {
+            if (read_at(header, 0)) {
+                std::memcpy(&magic, header.data(), sizeof(magic));
+                std::memcpy(&version, header.data() + 4, sizeof(version));
+                std::memcpy(&iterations, header.data() + 8, sizeof(iterations));
+            } else {
                 // If the header can't be read (I/O error, concurrent truncation, etc.),
                 // fall back to legacy handling and read the full file from the start.
                 std::cerr << "Failed to read vault header" << '\n';
-                file.clear();
-                file.seekg(0, std::ios::beg);
-                magic = 0;
-                version = 0;
-                iterations = 0;
             }
 
             if (magic == VAULT_MAGIC) {
                 pbkdf2_iterations = static_cast<int>(iterations);
                 Log::info("Vault format version {}, {} PBKDF2 iterations", version, iterations);
 
-                // V2 vaults: Header is part of data, rewind to beginning
+                // V2/V3 vaults: Header is part of data
                 // V1 vaults: Header is separate, skip it
-                if (version == 2 || is_v2_vault) {
-                    file.seekg(0, std::ios::beg);  // Rewind for V2
-                } else {
-                    // V1: Adjust size to exclude header
-                    size -= HEADER_SIZE;
+                if (!(version == 2 || version == 3 || is_v2_vault)) {
+                    skip = HEADER_SIZE;
                 }
             } else {
                 // V2 vault format (no separate header, header is part of file data)
                 Log::info("V2 vault format detected (integrated header)");
-                file.seekg(0, std::ios::beg);
-                pbkdf2_iterations = DEFAULT_PBKDF2_ITERATIONS;
             }
         }
 
-        data.resize(static_cast<size_t>(size));
-        file.read(reinterpret_cast<char*>(data.data()), size);
-
-        if (!file.good() && !file.eof()) {
+        // Read the payload straight into the caller's buffer
+        data.resize(static_cast<size_t>(size) - skip);
+        const bool ok = data.empty() || read_at(data, skip);
+#ifdef __linux__
+        close(fd);
+#endif
+        if (!ok) {
             std::cerr << "Error reading vault file" << '\n';
             return false;
         }
-
-        file.close();
         return true;
 
     } catch (const std::exception& e) {
@@ -313,9 +424,25 @@ VaultResult<std::string> VaultIO::create_backup(std::string_view path, std::stri
             backup_path = backup_directory / backup_filename;
         }
 
+#ifdef __linux__
+        if (!copy_vault_file(vault_path, backup_path)) {
+            Log::warning("Failed to create backup {}: {}", backup_path.string(), std::strerror(errno));
+            return std::unexpected(VaultError::FileWriteFailed);
+        }
+#else
         fs::copy_file(path_str, backup_path, fs::copy_options::overwrite_existing);
+#endif
         Log::info("Created backup: {}", backup_path.string());
 
+        const int64_t created_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            now.time_since_epoch()).count();
+        auto entry = BackupManifest::describe(backup_path, created_ms);
+        if (!entry || !BackupManifest::add(path, backup_dir, std::move(*entry))) {
+            // The backup itself is fine; make the next listing rescan for it
+            Log::warning("Failed to record backup in manifest: {}", backup_path.string());
+            BackupManifest::invalidate(path, backup_dir);
+        }
+
         return backup_path.string();
     } catch (const fs::filesystem_error& e) {
         Log::warning("Failed to create backup: {}", e.what());
@@ -323,31 +450,37 @@ VaultResult<std::string> VaultIO::create_backup(std::string_view path, std::stri
     }
 }
 
-VaultResult<> VaultIO::restore_from_backup(std::string_view path, std::string_view backup_dir) {
+VaultResult<> VaultIO::restore_from_backup(std::string_view path, std::string_view backup_dir,
+                                           const BackupValidator& accept) {
     namespace fs = std::filesystem;
     std::string path_str(path);
 
-    // Get all backups and restore from the most recent
-    auto backups = list_backups(path, backup_dir);
-
     try {
-        if (backups.empty()) {
-            // Try legacy .backup format for backwards compatibility
-            std::string legacy_backup = path_str + ".backup";
-            if (fs::exists(legacy_backup)) {
-                fs::copy_file(legacy_backup, path_str, fs::copy_options::overwrite_existing);
-                Log::info("Restored from legacy backup: {}", legacy_backup);
-                return {};
+        // Newest intact backup whose file still matches its manifest entry
+        const fs::path directory = backup_location(path, backup_dir);
+        for (const auto& entry : BackupManifest::load(path, backup_dir)) {
+            const fs::path backup_path = directory / entry.filename;
+            std::error_code ec;
+            if (!entry.is_intact() || fs::file_size(backup_path, ec) != entry.size || ec ||
+                (accept && !accept(backup_path.string()))) {
+                Log::warning("Skipping unusable backup: {}", backup_path.string());
+                continue;
             }
-            Log::error("No backup files found for: {}", path_str);
-            return std::unexpected(VaultError::FileNotFound);
+
+            fs::copy_file(backup_path, path_str, fs::copy_options::overwrite_existing);
+            Log::info("Restored from backup: {}", backup_path.string());
+            return {};
         }
 
-        // Backups are sorted newest first, so restore from [0]
-        const std::string& backup_path = backups[0];
-        fs::copy_file(backup_path, path_str, fs::copy_options::overwrite_existing);
-        Log::info("Restored from backup: {}", backup_path);
-        return {};
+        // Try legacy .backup format for backwards compatibility
+        std::string legacy_backup = path_str + ".backup";
+        if (fs::exists(legacy_backup) && (!accept || accept(legacy_backup))) {
+            fs::copy_file(legacy_backup, path_str, fs::copy_options::overwrite_existing);
+            Log::info("Restored from legacy backup: {}", legacy_backup);
+            return {};
+        }
+        Log::error("No backup files found for: {}", path_str);
+        return std::unexpected(VaultError::FileNotFound);
     } catch (const fs::filesystem_error& e) {
         Log::error("Failed to restore backup: {}", e.what());
         return std::unexpected(VaultError::FileReadFailed);
@@ -356,47 +489,12 @@ VaultResult<> VaultIO::restore_from_backup(std::string_view path, std::string_vi
 
 std::vector<std::string> VaultIO::list_backups(std::string_view path, std::string_view backup_dir) {
     namespace fs = std::filesystem;
-    std::vector<std::string> backups;
-    std::string path_str(path);
-
-    fs::path vault_path(path_str);
-    std::string vault_filename = vault_path.filename().string();
-    std::string backup_dir_str(backup_dir);
-    try {
-        // Determine search directory
-        fs::path search_dir;
-        if (backup_dir_str.empty()) {
-            // Search in same directory as vault
-            search_dir = vault_path.parent_path();
-        } else {
-            // Search in custom backup directory
-            search_dir = fs::path(backup_dir_str);
-        }
-
-        if (!fs::exists(search_dir)) {
-            return backups;
-        }
-
-        // Find all backup files matching pattern
-        for (const auto& entry : fs::directory_iterator(search_dir)) {
-            if (!entry.is_regular_file()) {
-                continue;
-            }
 
-            std::string filename = entry.path().filename().string();
-            if (is_legacy_style_backup_name(vault_filename, filename) ||
-                is_service_style_backup_name(vault_filename, filename)) {
-                backups.push_back(entry.path().string());
-            }
-        }
-
-        // Sort by filename (timestamp is in filename), newest first
-        std::sort(backups.begin(), backups.end(), std::greater<std::string>());
-
-    } catch (const fs::filesystem_error& e) {
-        Log::warning("Failed to list backups: {}", e.what());
+    const fs::path directory = backup_location(path, backup_dir);
+    std::vector<std::string> backups;
+    for (const auto& entry : BackupManifest::load(path, backup_dir)) {
+        backups.push_back((directory / entry.filename).string());
     }
-
     return backups;
 }
 
@@ -407,16 +505,28 @@ void VaultIO::cleanup_old_backups(std::string_view path, int max_backups, std::s
         return;
     }
 
-    auto backups = list_backups(path, backup_dir);
+    const auto entries = BackupManifest::load(path, backup_dir);
+    if (entries.size() <= static_cast<size_t>(max_backups)) {
+        return;
+    }
 
-    // Delete oldest backups (backups are sorted newest first)
-    for (size_t i = static_cast<size_t>(max_backups); i < backups.size(); ++i) {
-        try {
-            fs::remove(backups[i]);
-            Log::info("Deleted old backup: {}", backups[i]);
-        } catch (const fs::filesystem_error& e) {
-            Log::warning("Failed to delete backup {}: {}", backups[i], e.what());
+    // Delete oldest backups (entries are sorted newest first)
+    const fs::path directory = backup_location(path, backup_dir);
+    std::vector<std::string> removed;
+    for (size_t i = static_cast<size_t>(max_backups); i < entries.size(); ++i) {
+        const fs::path backup_path = directory / entries[i].filename;
+        std::error_code ec;
+        fs::remove(backup_path, ec);
+        if (ec) {
+            Log::warning("Failed to delete backup {}: {}", backup_path.string(), ec.message());
+            continue;
         }
+        Log::info("Deleted old backup: {}", backup_path.string());
+        removed.push_back(entries[i].filename);
+    }
+
+    if (!removed.empty() && !BackupManifest::remove(path, backup_dir, removed)) {
+        BackupManifest::invalidate(path, backup_dir);
     }
 }
 
@@ -13,6 +13,7 @@
 #ifndef KEEPTOWER_VAULTIO_H
 #define KEEPTOWER_VAULTIO_H
 
+#include <functional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -33,6 +34,7 @@ namespace KeepTower {
  * - Atomic file writes using temporary files and rename
  * - Secure file permissions (0600 on Unix systems)
  * - Timestamped backup creation and management with compatibility-aware lookup
+ * - Per-vault backup manifest (BackupManifest) for listing, restore and retention
  * - Directory synchronization for durability
  * - Support for both V1 and V2 vault formats
 
@@ -70,6 +72,9 @@ namespace KeepTower {
  */
 class VaultIO {
 public:
+    /// Decides whether a backup file (by path) is fit to restore
+    using BackupValidator = std::function<bool(const std::string&)>;
+
     /**
      * @brief Default PBKDF2 iteration count (OWASP recommended minimum 2023)
      */
@@ -102,6 +107,8 @@ public:
      *
      * @note For files without magic header (legacy format), assumes DEFAULT_PBKDF2_ITERATIONS
      * @note Output data vector is resized to fit file contents
+     * @note On Linux the file is opened once (O_NOFOLLOW); permission checks and
+     *       reads all use that descriptor, and the payload is read straight into @p data
      *
      * @par Example:
      * @code
@@ -175,6 +182,8 @@ public:
     * @note Returns FileNotFound if the source vault does not exist
     * @note Overwrites existing backup with same timestamp (unlikely but possible)
      * @note If backup_dir specified, creates directory if it doesn't exist
+     * @note Records the backup (size, header digest, flags) in the vault's
+     *       BackupManifest once it has been renamed into place
      *
      * @par Example:
      * @code
@@ -189,12 +198,17 @@ public:
     /**
      * @brief Restore vault from most recent backup
      *
-    * Finds the most recent timestamped backup file and restores it by copying
-    * over the current vault file. Falls back to legacy single-file backup
-    * compatibility if no timestamped backups exist.
+    * Picks the newest backup in the vault's BackupManifest that is intact
+    * (complete, carries a vault header, still has its recorded size, and is
+    * accepted by @p accept) and restores it by copying over the current vault
+    * file. Falls back to legacy single-file backup compatibility if no
+    * timestamped backup qualifies.
      *
     * @param path Path to the vault file to restore
     * @param backup_dir Optional custom backup directory (empty=same as vault)
+    * @param accept Optional deeper check of a candidate's contents (for
+    *        example VaultVerificationService::is_restorable); empty accepts
+    *        every candidate that matches its manifest entry
      * @return VaultResult<> indicating success or FileNotFound/FileReadFailed
      *
      * @throws No exceptions (catches filesystem errors)
@@ -209,12 +223,15 @@ public:
      * }
      * @endcode
      */
-    [[nodiscard]] static VaultResult<> restore_from_backup(std::string_view path, std::string_view backup_dir = "");
+    [[nodiscard]] static VaultResult<> restore_from_backup(std::string_view path, std::string_view backup_dir = "",
+                                                           const BackupValidator& accept = {});
 
     /**
      * @brief List all backup files for a vault, sorted newest first
      *
-        * Searches for files matching either `path.backup.*` or `basename.*.backup`
+     * Reads the vault's BackupManifest instead of scanning the directory. The
+     * manifest is rebuilt from a scan for files matching either `path.backup.*`
+     * or `basename.*.backup` when it is missing or unreadable.
      * Returns paths sorted by timestamp (newest first).
      *
      * @param path Path to the vault file
@@ -226,6 +243,8 @@ public:
     * @note Returns empty vector if directory doesn't exist or on error
     * @note Created backups currently use the legacy `path.backup.*` convention
      * @note Ignores non-regular files (directories, symlinks, etc.)
+     * @note Paths come from the manifest; a backup deleted outside KeepTower
+     *       stays listed until the next cleanup_old_backups() or rebuild
      *
      * @par Example:
      * @code
@@ -242,7 +261,8 @@ public:
      * @brief Delete old backup files, keeping only the N most recent
      *
      * Deletes backup files older than the specified count, preserving the most
-     * recent backups. Uses list_backups() to find and sort backup files.
+     * recent backups. Selects backups from the manifest (see list_backups())
+     * and drops the deleted ones from it.
      *
      * @param path Path to the vault file
      * @param max_backups Maximum number of backup files to keep (must be >= 1)
@@ -2,13 +2,40 @@
 // SPDX-FileCopyrightText: 2025 tjdeveng
 
 #include "VaultFormatV2.h"
+#include "lib/fec/Crc32c.h"
+#include "lib/fec/WindowedFec.h"
 #include "../../utils/Log.h"
 #include <cstring>
 #include <algorithm>
+#include <array>
+#include <iterator>
+#include <optional>
 
 namespace KeepTower {
 
-KeepTower::VaultResult<uint32_t> VaultFormatV2::detect_version(const std::vector<uint8_t>& file_data) {
+namespace {
+
+/// One data FEC length copy: u64 LE length, then its u32 LE CRC-32C
+std::array<uint8_t, 12> encode_length_copy(uint64_t length) {
+    std::array<uint8_t, 12> copy{};
+    for (size_t i = 0; i < 8; ++i) {
+        copy[i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+    const uint32_t crc = crc32c(std::span<const uint8_t>(copy.data(), 8));
+    for (size_t i = 0; i < 4; ++i) {
+        copy[8 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+    return copy;
+}
+
+uint32_t load_le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+}  // namespace
+
+KeepTower::VaultResult<uint32_t> VaultFormatV2::detect_version(std::span<const uint8_t> file_data) {
     if (file_data.size() < 8) {
         return std::unexpected(VaultError::CorruptedFile);
     }
@@ -23,20 +50,40 @@ KeepTower::VaultResult<uint32_t> VaultFormatV2::detect_version(const std::vector
     uint32_t version = 0;
     std::memcpy(&version, file_data.data() + 4, sizeof(version));
 
-    if (version != VAULT_VERSION_V2) {
+    if (!is_supported_version(version)) {
         Log::error("VaultFormatV2: Unsupported vault version: {}", version);
         return std::unexpected(VaultError::UnsupportedVersion);
     }
 
-    return VAULT_VERSION_V2;
+    return version;
 }
 
-bool VaultFormatV2::is_valid_v2_vault(const std::vector<uint8_t>& file_data) {
+KeepTower::VaultResult<size_t> VaultFormatV2::header_extent(std::span<const uint8_t> preamble) {
+    if (preamble.size() < PREAMBLE_SIZE) {
+        return std::unexpected(VaultError::CorruptedFile);
+    }
+
+    auto version = detect_version(preamble);
+    if (!version) {
+        return std::unexpected(version.error());
+    }
+
+    uint32_t header_size = 0;
+    std::memcpy(&header_size, preamble.data() + 12, sizeof(header_size));
+    if (header_size == 0 || header_size > MAX_HEADER_SIZE) {
+        Log::error("VaultFormatV2: Invalid header size: {} (max: {})", header_size, MAX_HEADER_SIZE);
+        return std::unexpected(VaultError::CorruptedFile);
+    }
+
+    return PREAMBLE_SIZE + header_size + DATA_KEY_MATERIAL_SIZE;
+}
+
+bool VaultFormatV2::is_valid_v2_vault(std::span<const uint8_t> file_data) {
     auto version_result = detect_version(file_data);
     if (!version_result) {
         return false;
     }
-    return version_result.value() == VAULT_VERSION_V2;
+    return is_supported_version(version_result.value());
 }
 
 KeepTower::VaultResult<std::vector<uint8_t>>
@@ -55,7 +102,7 @@ VaultFormatV2::apply_header_fec(const std::vector<uint8_t>& header_data,
     const auto& encoded = encode_result.value();
 
     std::vector<uint8_t> result;
-    result.reserve(1 + 4 + encoded.data.size());
+    result.reserve(1 + 4 + 2 + encoded.data.size() + 4 * encoded.checksums.size());
     result.push_back(stored_redundancy);
 
     if (header_data.size() > UINT32_MAX) {
@@ -68,32 +115,44 @@ VaultFormatV2::apply_header_fec(const std::vector<uint8_t>& header_data,
     result.push_back((original_size >> 16) & 0xFF);
     result.push_back((original_size >> 8) & 0xFF);
     result.push_back(original_size & 0xFF);
+    result.push_back(static_cast<uint8_t>(encoded.parity_symbols));
+    result.push_back(static_cast<uint8_t>(encoded.interleave_depth));
     result.insert(result.end(), encoded.data.begin(), encoded.data.end());
+    for (uint32_t checksum : encoded.checksums) {
+        result.push_back(checksum & 0xFF);
+        result.push_back((checksum >> 8) & 0xFF);
+        result.push_back((checksum >> 16) & 0xFF);
+        result.push_back((checksum >> 24) & 0xFF);
+    }
 
-    Log::info("VaultFormatV2: Header FEC applied (encoding: {}%, stored: {}%, {} -> {} bytes)",
-              encoding_redundancy, stored_redundancy, header_data.size(), encoded.data.size());
+    Log::info("VaultFormatV2: Header FEC applied (encoding: {}%, stored: {}%, RS(255,{}) x{} interleaved, {} -> {} bytes)",
+              encoding_redundancy, stored_redundancy, 255 - encoded.parity_symbols, encoded.interleave_depth,
+              header_data.size(), encoded.data.size());
 
     return result;
 }
 
 KeepTower::VaultResult<std::vector<uint8_t>>
-VaultFormatV2::remove_header_fec(const std::vector<uint8_t>& protected_data,
+VaultFormatV2::remove_header_fec(std::span<const uint8_t> protected_data,
                                  uint32_t original_size,
-                                 uint8_t redundancy) {
-    ReedSolomon rs(redundancy);
-
-    ReedSolomon::EncodedData encoded;
-    encoded.data = protected_data;
-    encoded.original_size = original_size;
-    encoded.redundancy_percent = redundancy;
-
-    auto decode_result = rs.decode(encoded);
+                                 uint8_t parity_symbols,
+                                 uint8_t interleave_depth,
+                                 std::span<const uint32_t> checksums) {
+    ReedSolomon::CorrectionStats corrections;
+    auto decode_result = parity_symbols == 0
+        ? ReedSolomon::decode_legacy(protected_data, original_size)
+        : ReedSolomon::decode(protected_data, original_size, parity_symbols, interleave_depth, checksums,
+                              &corrections);
     if (!decode_result) {
         Log::error("VaultFormatV2: Header FEC decoding failed: {}",
                    ReedSolomon::error_to_string(decode_result.error()));
         return std::unexpected(VaultError::FECDecodingFailed);
     }
 
+    if (corrections.corrected_symbols != 0) {
+        Log::info("VaultFormatV2: Header FEC repaired {} bytes in {} codewords",
+                  corrections.corrected_symbols, corrections.repaired_blocks);
+    }
     Log::info("VaultFormatV2: Header FEC decoded successfully (recovered {} bytes)", original_size);
     return decode_result.value();
 }
@@ -102,6 +161,11 @@ KeepTower::VaultResult<std::vector<uint8_t>>
 VaultFormatV2::write_header(const V2FileHeader& header,
                             bool enable_header_fec,
                             uint8_t user_fec_redundancy) {
+    if (!is_supported_version(header.version)) {
+        Log::error("VaultFormatV2: Refusing to write unsupported version {}", header.version);
+        return std::unexpected(VaultError::UnsupportedVersion);
+    }
+
     std::vector<uint8_t> result;
     result.reserve(4096);
 
@@ -111,11 +175,32 @@ VaultFormatV2::write_header(const V2FileHeader& header,
         return std::unexpected(VaultError::SerializationFailed);
     }
 
+    if (header.payload_compression > PAYLOAD_COMPRESSION_ZLIB) {
+        Log::error("VaultFormatV2: Refusing to write unknown payload codec {}", header.payload_compression);
+        return std::unexpected(VaultError::InvalidData);
+    }
+
     std::vector<uint8_t> header_data_section;
-    uint8_t header_flags = 0;
+    uint8_t header_flags = static_cast<uint8_t>(header.payload_compression << HEADER_COMPRESSION_SHIFT);
+
+    if (header.data_fec_parity_symbols != 0) {
+        if (!WindowedFec::valid_parameters(header.data_fec_parity_symbols, header.data_fec_window_size)) {
+            Log::error("VaultFormatV2: Invalid data FEC parameters (parity {}, window {})",
+                       header.data_fec_parity_symbols, header.data_fec_window_size);
+            return std::unexpected(VaultError::InvalidData);
+        }
+        // Ahead of the header data, so header FEC covers them
+        const uint32_t window = header.data_fec_window_size;
+        const uint8_t params[DATA_FEC_PARAMS_SIZE] = {
+            header.data_fec_parity_symbols,
+            static_cast<uint8_t>(window), static_cast<uint8_t>(window >> 8),
+            static_cast<uint8_t>(window >> 16), static_cast<uint8_t>(window >> 24)};
+        vault_header_data.insert(vault_header_data.begin(), std::begin(params), std::end(params));
+        header_flags |= HEADER_FLAG_DATA_FEC;
+    }
 
     if (enable_header_fec) {
-        header_flags |= HEADER_FLAG_FEC_ENABLED;
+        header_flags |= HEADER_FLAG_FEC_ENABLED | HEADER_FLAG_FEC_INTERLEAVED | HEADER_FLAG_FEC_CHECKSUMS;
         uint8_t effective_redundancy = std::max(MIN_HEADER_FEC_REDUNDANCY, user_fec_redundancy);
         auto fec_result = apply_header_fec(vault_header_data, effective_redundancy, user_fec_redundancy);
         if (!fec_result) {
@@ -128,7 +213,7 @@ VaultFormatV2::write_header(const V2FileHeader& header,
 
     uint32_t header_size = 1 + header_data_section.size();
     uint32_t magic = VAULT_MAGIC;
-    uint32_t version = VAULT_VERSION_V2;
+    uint32_t version = header.version;
     uint32_t pbkdf2_iters = header.pbkdf2_iterations;
 
     Log::info("VaultFormatV2: Writing header with version={}, pbkdf2={}, header_size={}",
@@ -167,7 +252,7 @@ VaultFormatV2::write_header(const V2FileHeader& header,
 }
 
 KeepTower::VaultResult<std::pair<VaultFormatV2::V2FileHeader, size_t>>
-VaultFormatV2::read_header(const std::vector<uint8_t>& file_data) {
+VaultFormatV2::read_header(std::span<const uint8_t> file_data) {
     if (file_data.size() < 16) {
         return std::unexpected(VaultError::CorruptedFile);
     }
@@ -184,8 +269,8 @@ VaultFormatV2::read_header(const std::vector<uint8_t>& file_data) {
 
     std::memcpy(&header.version, file_data.data() + offset, sizeof(header.version));
     offset += 4;
-    if (header.version != VAULT_VERSION_V2) {
-        Log::error("VaultFormatV2: Expected version 2, got {}", header.version);
+    if (!is_supported_version(header.version)) {
+        Log::error("VaultFormatV2: Expected version 2 or 3, got {}", header.version);
         return std::unexpected(VaultError::UnsupportedVersion);
     }
 
@@ -205,6 +290,12 @@ VaultFormatV2::read_header(const std::vector<uint8_t>& file_data) {
 
     header.header_flags = file_data[offset++];
     bool fec_enabled = (header.header_flags & HEADER_FLAG_FEC_ENABLED) != 0;
+    header.payload_compression = static_cast<uint8_t>(
+        (header.header_flags & HEADER_COMPRESSION_MASK) >> HEADER_COMPRESSION_SHIFT);
+    if (header.payload_compression > PAYLOAD_COMPRESSION_ZLIB) {
+        Log::error("VaultFormatV2: Unknown payload codec {}", header.payload_compression);
+        return std::unexpected(VaultError::UnsupportedVersion);
+    }
     uint32_t header_data_size = header.header_size - 1;
     const size_t required_after_offset = static_cast<size_t>(header_data_size) + 32 + 12;
     if (offset > file_data.size() || (file_data.size() - offset) < required_after_offset) {
@@ -213,12 +304,11 @@ VaultFormatV2::read_header(const std::vector<uint8_t>& file_data) {
         return std::unexpected(VaultError::CorruptedFile);
     }
 
-    std::vector<uint8_t> header_data_section(
-        file_data.begin() + offset,
-        file_data.begin() + offset + header_data_size);
+    const auto header_data_section = file_data.subspan(offset, header_data_size);
     offset += header_data_size;
 
-    std::vector<uint8_t> vault_header_data;
+    std::vector<uint8_t> decoded_header_data;
+    std::span<const uint8_t> vault_header_data = header_data_section;
     if (fec_enabled) {
         if (header_data_section.size() < 5) {
             Log::error("VaultFormatV2: FEC header too small");
@@ -231,18 +321,67 @@ VaultFormatV2::read_header(const std::vector<uint8_t>& file_data) {
                                  (static_cast<uint32_t>(header_data_section[2]) << 16) |
                                  (static_cast<uint32_t>(header_data_section[3]) << 8) |
                                  static_cast<uint32_t>(header_data_section[4]);
-        std::vector<uint8_t> encoded_data(header_data_section.begin() + 5, header_data_section.end());
+        size_t metadata_size = 5;
+        if (header.header_flags & HEADER_FLAG_FEC_INTERLEAVED) {
+            if (header_data_section.size() < 7) {
+                Log::error("VaultFormatV2: FEC header too small");
+                return std::unexpected(VaultError::CorruptedFile);
+            }
+            header.fec_parity_symbols = header_data_section[5];
+            header.fec_interleave_depth = header_data_section[6];
+            if (header.fec_parity_symbols == 0) {
+                Log::error("VaultFormatV2: Invalid header FEC parity length");
+                return std::unexpected(VaultError::CorruptedFile);
+            }
+            metadata_size = 7;
+        }
+
+        auto protected_data = header_data_section.subspan(metadata_size);
+        std::vector<uint32_t> checksums;
+        if ((header.header_flags & HEADER_FLAG_FEC_CHECKSUMS) && header.fec_parity_symbols != 0) {
+            const size_t encoded_size = ReedSolomon::encoded_size(original_size, header.fec_parity_symbols);
+            const size_t count = ReedSolomon::checksum_count(encoded_size);
+            if (encoded_size == 0 || protected_data.size() != encoded_size + 4 * count) {
+                Log::error("VaultFormatV2: FEC header size does not match its parameters");
+                return std::unexpected(VaultError::CorruptedFile);
+            }
+            checksums.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                checksums[i] = load_le32(protected_data.data() + encoded_size + 4 * i);  // As apply_header_fec() wrote them
+            }
+            protected_data = protected_data.first(encoded_size);
+        }
+
         uint8_t decoding_redundancy = std::max(MIN_HEADER_FEC_REDUNDANCY, redundancy);
-        auto decode_result = remove_header_fec(encoded_data, original_size, decoding_redundancy);
+        auto decode_result = remove_header_fec(protected_data, original_size,
+                                               header.fec_parity_symbols, header.fec_interleave_depth,
+                                               checksums);
         if (!decode_result) {
             return std::unexpected(decode_result.error());
         }
 
-        vault_header_data = std::move(decode_result.value());
+        decoded_header_data = std::move(decode_result.value());
+        vault_header_data = decoded_header_data;
         Log::info("VaultFormatV2: Header FEC decoded successfully (recovered {} bytes, encoded: {}%, stored: {}%)",
                   vault_header_data.size(), decoding_redundancy, redundancy);
-    } else {
-        vault_header_data = header_data_section;
+    }
+
+    if (header.header_flags & HEADER_FLAG_DATA_FEC) {
+        if (vault_header_data.size() < DATA_FEC_PARAMS_SIZE) {
+            Log::error("VaultFormatV2: Header too small for data FEC parameters");
+            return std::unexpected(VaultError::CorruptedFile);
+        }
+        header.data_fec_parity_symbols = vault_header_data[0];
+        header.data_fec_window_size = static_cast<uint32_t>(vault_header_data[1]) |
+                                      (static_cast<uint32_t>(vault_header_data[2]) << 8) |
+                                      (static_cast<uint32_t>(vault_header_data[3]) << 16) |
+                                      (static_cast<uint32_t>(vault_header_data[4]) << 24);
+        if (!WindowedFec::valid_parameters(header.data_fec_parity_symbols, header.data_fec_window_size)) {
+            Log::error("VaultFormatV2: Invalid data FEC parameters (parity {}, window {})",
+                       header.data_fec_parity_symbols, header.data_fec_window_size);
+            return std::unexpected(VaultError::CorruptedFile);
+        }
+        vault_header_data = vault_header_data.subspan(DATA_FEC_PARAMS_SIZE);
     }
 
     auto vault_header_opt = VaultHeaderV2::deserialize(vault_header_data);
@@ -269,4 +408,102 @@ VaultFormatV2::read_header(const std::vector<uint8_t>& file_data) {
     return std::make_pair(header, offset);
 }
 
+KeepTower::VaultResult<VaultFormatV2::DataFecFraming>
+VaultFormatV2::protect_data_section(uint8_t parity_symbols,
+                                    uint32_t window_size,
+                                    std::span<const uint8_t> ciphertext) {
+    if (!WindowedFec::valid_parameters(parity_symbols, window_size) || ciphertext.empty()) {
+        Log::error("VaultFormatV2: Cannot apply data FEC (parity {}, window {}, {} bytes)",
+                   parity_symbols, window_size, ciphertext.size());
+        return std::unexpected(VaultError::FECEncodingFailed);
+    }
+
+    DataFecFraming framing;
+    const auto copy = encode_length_copy(ciphertext.size());
+    for (size_t i = 0; i < DATA_FEC_LENGTH_COPIES; ++i) {
+        framing.prefix.insert(framing.prefix.end(), copy.begin(), copy.end());
+    }
+
+    const WindowedFec fec(parity_symbols, window_size);
+    framing.trailer.resize(fec.trailer_size(ciphertext.size()));
+    if (!fec.encode(ciphertext, framing.trailer)) {
+        Log::error("VaultFormatV2: Data FEC encoding failed");
+        return std::unexpected(VaultError::FECEncodingFailed);
+    }
+
+    Log::info("VaultFormatV2: Data FEC applied (RS(255,{}), {} KiB windows, {} -> {} bytes)",
+              255 - parity_symbols, window_size / 1024, ciphertext.size(),
+              framing.prefix.size() + ciphertext.size() + framing.trailer.size());
+    return framing;
+}
+
+KeepTower::VaultResult<VaultFormatV2::DataSection>
+VaultFormatV2::open_data_section(uint8_t parity_symbols,
+                                 uint32_t window_size,
+                                 std::span<const uint8_t> data_section) {
+    if (!WindowedFec::valid_parameters(parity_symbols, window_size) ||
+        data_section.size() < DATA_FEC_PREFIX_SIZE) {
+        Log::error("VaultFormatV2: Data FEC section too small or parameters invalid");
+        return std::unexpected(VaultError::CorruptedFile);
+    }
+    const WindowedFec fec(parity_symbols, window_size);
+
+    // The first length copy that checks out and fits the file wins
+    std::optional<uint64_t> length;
+    for (size_t i = 0; i < DATA_FEC_LENGTH_COPIES && !length; ++i) {
+        const auto copy = data_section.subspan(12 * i, 12);
+        uint64_t value = 0;
+        uint32_t crc = 0;
+        for (size_t b = 0; b < 8; ++b) {
+            value |= static_cast<uint64_t>(copy[b]) << (8 * b);
+        }
+        for (size_t b = 0; b < 4; ++b) {
+            crc |= static_cast<uint32_t>(copy[8 + b]) << (8 * b);
+        }
+        const size_t available = data_section.size() - DATA_FEC_PREFIX_SIZE;
+        if (crc == crc32c(copy.first(8)) && value != 0 && value <= available &&
+            fec.trailer_size(value) <= available - value) {
+            length = value;
+        }
+    }
+    if (!length) {
+        Log::error("VaultFormatV2: Data FEC length copies are all damaged");
+        return std::unexpected(VaultError::CorruptedFile);
+    }
+
+    DataSection section;
+    const auto expected_copy = encode_length_copy(*length);
+    for (size_t i = 0; i < DATA_FEC_LENGTH_COPIES; ++i) {
+        const auto copy = data_section.subspan(12 * i, 12);
+        if (!std::equal(copy.begin(), copy.end(), expected_copy.begin())) {
+            ++section.damaged_length_copies;
+        }
+    }
+    section.ciphertext = data_section.subspan(DATA_FEC_PREFIX_SIZE, *length);
+    const auto trailer = data_section.subspan(DATA_FEC_PREFIX_SIZE + *length, fec.trailer_size(*length));
+    section.stored_size = DATA_FEC_PREFIX_SIZE + *length + trailer.size();
+
+    auto damaged = fec.find_damaged(section.ciphertext, trailer);
+    if (!damaged) {
+        return std::unexpected(VaultError::CorruptedFile);
+    }
+    if (damaged->empty()) {
+        return section;
+    }
+
+    // Only now is the ciphertext copied, to be repaired window by window
+    section.damaged_windows = damaged->size();
+    section.repaired.assign(section.ciphertext.begin(), section.ciphertext.end());
+    auto repaired = fec.repair(section.repaired, trailer, *damaged);
+    if (!repaired) {
+        Log::error("VaultFormatV2: Data FEC could not repair {} damaged window(s)", damaged->size());
+        return std::unexpected(VaultError::FECDecodingFailed);
+    }
+    section.repaired_bytes = *repaired;
+    section.ciphertext = section.repaired;
+    Log::warning("VaultFormatV2: Data FEC repaired {} bytes in {} of {} windows",
+                 *repaired, damaged->size(), fec.window_count(*length));
+    return section;
+}
+
 } // namespace KeepTower
\ No newline at end of file
@@ -17,15 +17,18 @@
  * | PBKDF2 Iters     | 4 bytes
  * | Header Size      | 4 bytes  (size of FEC-protected header)
  * +------------------+
- * | Header Flags     | 1 byte   (FEC enabled, etc.)
+ * | Header Flags     | 1 byte   (bit 0: header FEC, bits 1-3: payload compression,
+ * |                  |           bit 4: interleaved header FEC, bit 5: FEC checksums,
+ * |                  |           bit 6: data FEC)
  * | [FEC metadata]   | Variable (if FEC enabled)
  * | Header Data      | Variable (security policy + key slots)
  * | [FEC Parity]     | Variable (if FEC enabled)
  * +------------------+
  * | Data Salt        | 32 bytes (for encrypting vault data)
  * | Data IV          | 12 bytes (for encrypting vault data)
+ * | [Data FEC Length]| 36 bytes (if data FEC enabled, see below)
  * | [Encrypted Data] | Variable (protobuf-serialized accounts)
- * | [Data FEC]       | Variable (if FEC enabled for data)
+ * | [Data FEC]       | Variable (if data FEC enabled)
  * +------------------+
  * @endcode
  *
@@ -36,6 +39,60 @@
  *   - If user sets 30% or 50% for vault data, header gets same protection
  * - **Data FEC**: Protects encrypted account data (user-configurable)
  * - Both can be enabled/disabled independently
+ *
+ * The FEC metadata is the stored (user) redundancy byte and the u32 BE
+ * original header size. When bit 4 of the flags is set it continues with
+ * the parity bytes per codeword and the interleaving depth (one byte each),
+ * and the header is encoded with ReedSolomon's variable-rate, interleaved,
+ * shortened layout. Without bit 4 the header is a run of zero-padded
+ * RS(255,223) codewords, as written by earlier releases. Bit 5 adds the
+ * encoded bytes' segment CRC-32Cs (u32 LE each, see ReedSolomon) after
+ * them, which lets a clean header skip Reed-Solomon decoding and turns
+ * damaged segments into erasures.
+ *
+ * @section data_fec Data FEC
+ * When bit 6 of the flags is set, the decoded header data starts with the
+ * data FEC parameters (parity bytes per codeword, then the u32 LE window
+ * size) ahead of the serialized security policy and key slots, so header
+ * FEC protects them too. The encrypted data is stored unchanged; it is
+ * preceded by its length, written three times as u64 LE + u32 LE CRC-32C,
+ * and followed by a KeepTower::WindowedFec trailer (interleaved parity and
+ * CRC-32Cs per window). open_data_section() checks the windows' checksums
+ * and decodes only damaged windows, before anything is handed to GCM.
+ * Journal frames follow the trailer and are not covered by it.
+ *
+ * @section v3_payload V3 Segmented Payload
+ * Version 3 files use the V2 header framing unchanged; only the encrypted
+ * data section differs. Instead of one AES-256-GCM blob it holds a STREAM
+ * segmented payload (see VaultCrypto::encrypt_stream()):
+ * @code
+ * +----------------------+
+ * | Segment Size         | 4 bytes  (u32 LE, plaintext bytes per segment)
+ * | Reserved             | 4 bytes  (must be zero)
+ * | Plaintext Size       | 8 bytes  (u64 LE, serialized vault data length)
+ * +----------------------+
+ * | Segment 0 + GCM Tag  | segment size + 16 bytes
+ * | ...                  |
+ * | Segment N-1 + Tag    | remainder + 16 bytes (last segment, may be short)
+ * +----------------------+
+ * @endcode
+ * Segment i is sealed under the nonce `data_iv[0..7) || be32(i) || last`, so
+ * its index and whether it ends the stream are authenticated, and the
+ * 16-byte segment header is authenticated as AAD of every segment. Since
+ * every segment has a fixed offset, open and save encrypt/decrypt segments
+ * on all cores, and a reader can verify segments as they arrive. The
+ * payload length follows from the segment header, so journal frames
+ * appended behind it are located without scanning.
+ *
+ * Version 2 files (single GCM blob) remain readable; the next full save
+ * rewrites them as version 3.
+ *
+ * @section payload_compression Payload Compression
+ * Bits 1-3 of the header flags name the codec applied to the serialized
+ * vault data before it was encrypted (see VaultSerialization::compress_payload()).
+ * 0 means the payload is stored as serialized; readers reject codecs they do
+ * not know rather than hand compressed bytes to the protobuf parser. Journal
+ * frames are never compressed.
  */
 
 #ifndef VAULTFORMATV2_H
@@ -48,6 +105,7 @@
 #include <cstdint>
 #include <expected>
 #include <memory>
+#include <span>
 
 namespace KeepTower {
 
@@ -61,9 +119,22 @@ class VaultFormatV2 {
 public:
     static constexpr uint32_t VAULT_MAGIC = 0x4B505457;              ///< Magic number for KeepTower vault files.
     static constexpr uint32_t VAULT_VERSION_V2 = 2;                  ///< Supported V2 on-disk version.
+    static constexpr uint32_t VAULT_VERSION_V3 = 3;                  ///< V2 header framing with segmented payload.
     static constexpr uint8_t HEADER_FLAG_FEC_ENABLED = 0x01;         ///< Header bit flag indicating header FEC is enabled.
+    static constexpr uint8_t HEADER_FLAG_FEC_INTERLEAVED = 0x10;     ///< Header FEC uses the variable-rate interleaved layout.
+    static constexpr uint8_t HEADER_FLAG_FEC_CHECKSUMS = 0x20;       ///< Segment CRC-32Cs follow the interleaved header FEC.
+    static constexpr uint8_t HEADER_FLAG_DATA_FEC = 0x40;            ///< Encrypted data is wrapped in windowed FEC.
+    static constexpr uint8_t HEADER_COMPRESSION_MASK = 0x0E;         ///< Header flag bits holding the payload codec.
+    static constexpr uint8_t HEADER_COMPRESSION_SHIFT = 1;           ///< Position of the payload codec in the header flags.
+    static constexpr uint8_t PAYLOAD_COMPRESSION_NONE = 0;           ///< Payload stored as serialized.
+    static constexpr uint8_t PAYLOAD_COMPRESSION_ZLIB = 1;           ///< Payload deflated (zlib stream) before encryption.
     static constexpr uint8_t MIN_HEADER_FEC_REDUNDANCY = 20;         ///< Minimum redundancy percent for header protection.
     static constexpr uint32_t MAX_HEADER_SIZE = 1024 * 1024;         ///< Maximum supported serialized header size in bytes.
+    static constexpr size_t PREAMBLE_SIZE = 16;                      ///< Fixed magic/version/iterations/header_size prefix.
+    static constexpr size_t DATA_KEY_MATERIAL_SIZE = 32 + 12;        ///< Data salt + IV following the protected header.
+    static constexpr size_t DATA_FEC_PARAMS_SIZE = 1 + 4;            ///< Parity + window size ahead of the header data.
+    static constexpr size_t DATA_FEC_LENGTH_COPIES = 3;              ///< Copies of the ciphertext length.
+    static constexpr size_t DATA_FEC_PREFIX_SIZE = DATA_FEC_LENGTH_COPIES * (8 + 4);  ///< Length copies ahead of the ciphertext.
 
     /**
      * @brief Parsed V2 file header plus authentication metadata.
@@ -75,6 +146,11 @@ public:
         uint32_t header_size = 0;                     ///< Serialized protected header size in bytes.
         uint8_t header_flags = 0;                     ///< Header flags bitfield.
         uint8_t fec_redundancy_percent = 0;           ///< Stored header FEC redundancy percent.
+        uint8_t fec_parity_symbols = 0;               ///< Header FEC parity bytes per codeword (0: legacy RS(255,223)).
+        uint8_t fec_interleave_depth = 0;             ///< Header FEC interleaving depth (0: legacy, not interleaved).
+        uint8_t payload_compression = PAYLOAD_COMPRESSION_NONE;  ///< Codec applied before encryption.
+        uint8_t data_fec_parity_symbols = 0;          ///< Data FEC parity bytes per codeword (0: no data FEC).
+        uint32_t data_fec_window_size = 0;            ///< Data FEC window size in bytes.
 
         VaultHeaderV2 vault_header;                   ///< Structured security policy and key-slot header.
 
@@ -82,9 +158,33 @@ public:
         std::array<uint8_t, 12> data_iv;             ///< IV for encrypted vault payload.
     };
 
+    /**
+     * @brief Data FEC framing written around the ciphertext.
+     */
+    struct DataFecFraming {
+        std::vector<uint8_t> prefix;   ///< DATA_FEC_PREFIX_SIZE bytes of length copies
+        std::vector<uint8_t> trailer;  ///< Windowed parity and checksums
+    };
+
+    /**
+     * @brief Verified view of a data section.
+     *
+     * ciphertext points into the data section handed to open_data_section()
+     * when it was intact, or into repaired when windows had to be decoded;
+     * moving the struct keeps it valid.
+     */
+    struct DataSection {
+        std::span<const uint8_t> ciphertext;  ///< Ciphertext, safe to hand to GCM
+        std::vector<uint8_t> repaired;        ///< Owns the ciphertext after a repair
+        size_t stored_size = 0;               ///< Bytes of the section (prefix + ciphertext + trailer)
+        size_t damaged_windows = 0;           ///< Windows that failed their checksums
+        size_t repaired_bytes = 0;            ///< Ciphertext bytes corrected
+        size_t damaged_length_copies = 0;     ///< Length copies that disagree with the one used
+    };
+
     /**
      * @brief Serialize a V2 header to on-disk bytes.
-     * @param header Parsed header fields to serialize.
+     * @param header Parsed header fields to serialize (version selects V2 or V3 payload).
      * @param enable_header_fec True to protect the header with FEC.
      * @param user_fec_redundancy User-configured redundancy percent for data/header policy.
      * @return Encoded header bytes or an error.
@@ -98,9 +198,25 @@ public:
      * @brief Parse a V2 header from raw file bytes.
      * @param file_data Complete file bytes or a prefix containing the header.
      * @return Parsed header and header byte length, or an error.
+     *
+     * Parses in place: only the FEC-decoded header is materialized, so a
+     * memory-mapped file can be handed over without copying it.
      */
     [[nodiscard]] static KeepTower::VaultResult<std::pair<V2FileHeader, size_t>>
-    read_header(const std::vector<uint8_t>& file_data);
+    read_header(std::span<const uint8_t> file_data);
+
+    /**
+     * @brief Compute how many leading file bytes read_header() consumes.
+     *
+     * Lets metadata probes read just the preamble, then exactly the header,
+     * instead of the whole file.
+     *
+     * @param preamble At least PREAMBLE_SIZE leading file bytes.
+     * @return Preamble + protected header + data salt/IV size, or an error
+     *         when the magic, version or header size is invalid.
+     */
+    [[nodiscard]] static KeepTower::VaultResult<size_t>
+    header_extent(std::span<const uint8_t> preamble);
 
     /**
      * @brief Detect the vault format version from raw file bytes.
@@ -108,14 +224,47 @@ public:
      * @return Parsed version number or an error.
      */
     [[nodiscard]] static KeepTower::VaultResult<uint32_t>
-    detect_version(const std::vector<uint8_t>& file_data);
+    detect_version(std::span<const uint8_t> file_data);
+
+    /**
+     * @brief Check whether a version number uses the V2 header framing.
+     * @param version On-disk version number.
+     * @return True for VAULT_VERSION_V2 and VAULT_VERSION_V3.
+     */
+    [[nodiscard]] static constexpr bool is_supported_version(uint32_t version) noexcept {
+        return version == VAULT_VERSION_V2 || version == VAULT_VERSION_V3;
+    }
 
     /**
      * @brief Validate whether raw bytes appear to be a supported V2 vault.
      * @param file_data Raw file bytes.
      * @return True when the magic/version/header framing are valid for V2.
      */
-    [[nodiscard]] static bool is_valid_v2_vault(const std::vector<uint8_t>& file_data);
+    [[nodiscard]] static bool is_valid_v2_vault(std::span<const uint8_t> file_data);
+
+    /**
+     * @brief Compute the data FEC framing for a ciphertext.
+     *
+     * Works one window at a time; the ciphertext is not copied.
+     *
+     * @param parity_symbols Parity bytes per codeword (as in the header).
+     * @param window_size Window size (as in the header).
+     * @param ciphertext Encrypted payload to protect.
+     * @return Prefix and trailer to write around the ciphertext, or an error.
+     */
+    [[nodiscard]] static KeepTower::VaultResult<DataFecFraming>
+    protect_data_section(uint8_t parity_symbols, uint32_t window_size, std::span<const uint8_t> ciphertext);
+
+    /**
+     * @brief Locate, verify and if needed repair a FEC-wrapped ciphertext.
+     * @param parity_symbols Parity bytes per codeword (from the header).
+     * @param window_size Window size (from the header).
+     * @param data_section File bytes from the data offset on (journal frames may follow).
+     * @return Verified ciphertext, or CorruptedFile when the section cannot be
+     *         located and FECDecodingFailed when damage exceeds the parity.
+     */
+    [[nodiscard]] static KeepTower::VaultResult<DataSection>
+    open_data_section(uint8_t parity_symbols, uint32_t window_size, std::span<const uint8_t> data_section);
 
 private:
     /**
@@ -134,13 +283,17 @@ private:
      * @brief Decode FEC-protected header bytes.
      * @param protected_data Encoded header bytes with redundancy payload.
      * @param original_size Original unprotected header size.
-     * @param redundancy Stored redundancy percent.
+     * @param parity_symbols Recorded parity bytes per codeword (0: legacy layout).
+     * @param interleave_depth Recorded interleaving depth.
+     * @param checksums Recorded segment checksums (empty if none).
      * @return Decoded header bytes or an error.
      */
     [[nodiscard]] static KeepTower::VaultResult<std::vector<uint8_t>>
-    remove_header_fec(const std::vector<uint8_t>& protected_data,
+    remove_header_fec(std::span<const uint8_t> protected_data,
                       uint32_t original_size,
-                      uint8_t redundancy);
+                      uint8_t parity_symbols,
+                      uint8_t interleave_depth,
+                      std::span<const uint32_t> checksums);
 };
 
 } // namespace KeepTower
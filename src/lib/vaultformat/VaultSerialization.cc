@@ -3,11 +3,50 @@
 
 #include "VaultSerialization.h"
 #include "../../utils/Log.h"
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/reflection.h>
+#include <openssl/crypto.h>
+#include <zlib.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace KeepTower {
 
+namespace {
+
+// zlib keeps plaintext in its window and hash tables: wipe them on release
+constexpr size_t ZLIB_BLOCK_HEADER = alignof(std::max_align_t);
+
+voidpf wiping_zalloc(voidpf, uInt items, uInt size) {
+    const size_t bytes = static_cast<size_t>(items) * size;
+    auto* block = static_cast<uint8_t*>(std::malloc(ZLIB_BLOCK_HEADER + bytes));
+    if (block == nullptr) {
+        return Z_NULL;
+    }
+    std::memcpy(block, &bytes, sizeof(bytes));
+    return block + ZLIB_BLOCK_HEADER;
+}
+
+void wiping_zfree(voidpf, voidpf address) {
+    if (address == Z_NULL) {
+        return;
+    }
+    auto* block = static_cast<uint8_t*>(address) - ZLIB_BLOCK_HEADER;
+    size_t bytes = 0;
+    std::memcpy(&bytes, block, sizeof(bytes));
+    OPENSSL_cleanse(block, ZLIB_BLOCK_HEADER + bytes);
+    std::free(block);
+}
+
+}  // namespace
+
 VaultResult<std::vector<uint8_t>>
 VaultSerialization::serialize(const keeptower::VaultData& vault_data) {
     std::string serialized_data;
@@ -23,8 +62,11 @@ VaultSerialization::serialize(const keeptower::VaultData& vault_data) {
 
 VaultResult<keeptower::VaultData>
 VaultSerialization::deserialize(const std::vector<uint8_t>& data) {
-    constexpr size_t MAX_VAULT_SIZE = 100 * 1024 * 1024;
+    return deserialize(std::span<const uint8_t>(data));
+}
 
+VaultResult<keeptower::VaultData>
+VaultSerialization::deserialize(std::span<const uint8_t> data) {
     if (data.size() > MAX_VAULT_SIZE) {
         Log::error("VaultSerialization: Vault data exceeds maximum size ({} bytes > {} bytes)",
                    data.size(), MAX_VAULT_SIZE);
@@ -47,6 +89,266 @@ VaultSerialization::deserialize(const std::vector<uint8_t>& data) {
     return vault_data;
 }
 
+bool VaultSerialization::is_index_field(int field_number) {
+    using Record = keeptower::AccountRecord;
+    switch (field_number) {
+        case Record::kIdFieldNumber:
+        case Record::kAccountNameFieldNumber:
+        case Record::kUserNameFieldNumber:
+        case Record::kEmailFieldNumber:
+        case Record::kWebsiteFieldNumber:
+        case Record::kTagsFieldNumber:
+        case Record::kIsFavoriteFieldNumber:
+        case Record::kIsArchivedFieldNumber:
+        case Record::kColorFieldNumber:
+        case Record::kIconFieldNumber:
+        case Record::kGlobalDisplayOrderFieldNumber:
+        case Record::kIsAdminOnlyViewableFieldNumber:
+        case Record::kIsAdminOnlyDeletableFieldNumber:
+        case Record::kGroupsFieldNumber:
+            return true;
+        default:
+            return false;
+    }
+}
+
+VaultResult<std::vector<uint8_t>>
+VaultSerialization::serialize_tiered(const keeptower::VaultData& vault_data) {
+    auto payload = prepare_tiered(vault_data);
+    if (!payload) {
+        return std::unexpected(payload.error());
+    }
+
+    std::vector<uint8_t> result(payload->size());
+    if (auto written = write_payload(*payload, result); !written) {
+        return std::unexpected(written.error());
+    }
+    return result;
+}
+
+VaultResult<VaultSerialization::TieredPayload>
+VaultSerialization::prepare_tiered(const keeptower::VaultData& vault_data) {
+    constexpr size_t MAX_TIER_SIZE = static_cast<size_t>(std::numeric_limits<int>::max());
+
+    TieredPayload payload;
+
+    std::unordered_set<std::string_view> ids;
+    ids.reserve(static_cast<size_t>(vault_data.accounts_size()));
+    bool unique_ids = true;
+    for (const auto& account : vault_data.accounts()) {
+        if (account.id().empty() || !ids.insert(account.id()).second) {
+            unique_ids = false;
+            break;
+        }
+    }
+
+    if (unique_ids) {
+        // Every AccountRecord field lands in exactly one tier (the id in both)
+        const auto* descriptor = keeptower::AccountRecord::descriptor();
+        const auto* reflection = keeptower::AccountRecord::GetReflection();
+        std::vector<const google::protobuf::FieldDescriptor*> detail_fields;
+        for (int i = 0; i < descriptor->field_count(); ++i) {
+            const auto* field = descriptor->field(i);
+            if (!is_index_field(field->number())) {
+                detail_fields.push_back(field);
+            }
+        }
+
+        payload.index = vault_data;
+        for (auto& account : *payload.index.mutable_accounts()) {
+            auto* detail = payload.details.add_accounts();
+            detail->set_id(account.id());
+            reflection->SwapFields(&account, detail, detail_fields);
+        }
+        payload.tiered = true;
+        payload.details_size = payload.details.ByteSizeLong();
+    } else {
+        Log::debug("VaultSerialization: Account ids not unique, writing single-tier payload");
+        payload.index = vault_data;
+    }
+    payload.index_size = payload.index.ByteSizeLong();
+
+    if (payload.index_size > MAX_TIER_SIZE || payload.details_size > MAX_TIER_SIZE) {
+        Log::error("VaultSerialization: Payload tier exceeds protobuf size limit");
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+    return payload;
+}
+
+VaultResult<> VaultSerialization::write_payload(const TieredPayload& payload, std::span<uint8_t> out) {
+    if (out.size() != payload.size()) {
+        Log::error("VaultSerialization: Payload buffer is {} bytes, expected {}", out.size(), payload.size());
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+
+    uint8_t* cursor = out.data();
+    if (payload.tiered) {
+        cursor = std::copy(TIERED_MAGIC.begin(), TIERED_MAGIC.end(), cursor);
+        const uint64_t index_size = payload.index_size;
+        for (size_t i = 0; i < 8; ++i) {
+            *cursor++ = static_cast<uint8_t>(index_size >> (8 * i));
+        }
+    }
+
+    // SerializeToArray() fails rather than overrun when the message grew since sizing
+    if (!payload.index.SerializeToArray(cursor, static_cast<int>(payload.index_size))) {
+        Log::error("VaultSerialization: Failed to serialize payload index");
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+    cursor += payload.index_size;
+    if (payload.tiered &&
+        !payload.details.SerializeToArray(cursor, static_cast<int>(payload.details_size))) {
+        Log::error("VaultSerialization: Failed to serialize payload details");
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+    return {};
+}
+
+size_t VaultSerialization::compressed_payload_bound(size_t payload_size) {
+    return COMPRESSED_PREFIX_LENGTH + compressBound(static_cast<uLong>(payload_size));
+}
+
+VaultResult<size_t> VaultSerialization::write_compressed_payload(const TieredPayload& payload,
+                                                                 std::span<uint8_t> out) {
+    const size_t payload_size = payload.size();
+    if (payload_size > MAX_VAULT_SIZE || out.size() < compressed_payload_bound(payload_size)) {
+        Log::error("VaultSerialization: Cannot compress {} byte payload into {} bytes",
+                   payload_size, out.size());
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+
+    std::vector<uint8_t> encoded(payload_size);
+    struct Wipe {
+        std::vector<uint8_t>& bytes;
+        ~Wipe() { OPENSSL_cleanse(bytes.data(), bytes.size()); }
+    } wipe{encoded};
+    if (auto written = write_payload(payload, encoded); !written) {
+        return std::unexpected(written.error());
+    }
+
+    z_stream stream{};
+    stream.zalloc = wiping_zalloc;
+    stream.zfree = wiping_zfree;
+    if (deflateInit(&stream, 1) != Z_OK) {
+        Log::error("VaultSerialization: Failed to initialise payload compression");
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+    const auto output = out.subspan(COMPRESSED_PREFIX_LENGTH);
+    stream.next_in = encoded.data();
+    stream.avail_in = static_cast<uInt>(encoded.size());
+    stream.next_out = output.data();
+    stream.avail_out = static_cast<uInt>(std::min<size_t>(output.size(), std::numeric_limits<uInt>::max()));
+    const int status = deflate(&stream, Z_FINISH);
+    const size_t compressed_size = stream.total_out;
+    deflateEnd(&stream);
+    if (status != Z_STREAM_END) {
+        Log::error("VaultSerialization: Payload compression failed ({})", status);
+        OPENSSL_cleanse(out.data(), out.size());
+        return std::unexpected(VaultError::SerializationFailed);
+    }
+
+    for (size_t i = 0; i < COMPRESSED_PREFIX_LENGTH; ++i) {
+        out[i] = static_cast<uint8_t>(static_cast<uint64_t>(payload_size) >> (8 * i));
+    }
+    return COMPRESSED_PREFIX_LENGTH + compressed_size;
+}
+
+VaultResult<std::vector<uint8_t>> VaultSerialization::decompress_payload(std::span<const uint8_t> data) {
+    if (data.size() < COMPRESSED_PREFIX_LENGTH ||
+        data.size() > compressed_payload_bound(MAX_VAULT_SIZE)) {
+        Log::error("VaultSerialization: Compressed payload has invalid size {}", data.size());
+        return std::unexpected(VaultError::InvalidProtobuf);
+    }
+    uint64_t payload_size = 0;
+    for (size_t i = 0; i < COMPRESSED_PREFIX_LENGTH; ++i) {
+        payload_size |= static_cast<uint64_t>(data[i]) << (8 * i);
+    }
+    if (payload_size > MAX_VAULT_SIZE) {
+        Log::error("VaultSerialization: Compressed payload expands beyond maximum size ({} bytes)",
+                   payload_size);
+        return std::unexpected(VaultError::InvalidProtobuf);
+    }
+
+    std::vector<uint8_t> payload(static_cast<size_t>(payload_size));
+    z_stream stream{};
+    stream.zalloc = wiping_zalloc;
+    stream.zfree = wiping_zfree;
+    if (inflateInit(&stream) != Z_OK) {
+        Log::error("VaultSerialization: Failed to initialise payload decompression");
+        return std::unexpected(VaultError::InvalidProtobuf);
+    }
+    const auto input = data.subspan(COMPRESSED_PREFIX_LENGTH);
+    stream.next_in = const_cast<Bytef*>(input.data());
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = payload.data();
+    stream.avail_out = static_cast<uInt>(payload.size());
+    const int status = inflate(&stream, Z_FINISH);
+    const bool complete = status == Z_STREAM_END && stream.total_out == payload.size() &&
+                          stream.avail_in == 0;
+    inflateEnd(&stream);
+    if (!complete) {
+        Log::error("VaultSerialization: Compressed payload is malformed ({})", status);
+        OPENSSL_cleanse(payload.data(), payload.size());
+        return std::unexpected(VaultError::InvalidProtobuf);
+    }
+    return payload;
+}
+
+std::optional<size_t> VaultSerialization::tiered_index_end(std::span<const uint8_t> prefix) {
+    if (prefix.size() < TIERED_PREFIX_LENGTH ||
+        !std::equal(TIERED_MAGIC.begin(), TIERED_MAGIC.end(), prefix.begin())) {
+        return std::nullopt;
+    }
+    uint64_t index_size = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        index_size |= static_cast<uint64_t>(prefix[TIERED_MAGIC.size() + i]) << (8 * i);
+    }
+    if (index_size > std::numeric_limits<size_t>::max() - TIERED_PREFIX_LENGTH) {
+        return std::nullopt;
+    }
+    return TIERED_PREFIX_LENGTH + static_cast<size_t>(index_size);
+}
+
+VaultResult<keeptower::VaultData>
+VaultSerialization::deserialize_payload(std::span<const uint8_t> data) {
+    const auto index_end = tiered_index_end(data);
+    if (!index_end) {
+        return deserialize(data);
+    }
+    if (*index_end > data.size()) {
+        Log::error("VaultSerialization: Two-tier index exceeds payload size");
+        return std::unexpected(VaultError::InvalidProtobuf);
+    }
+
+    auto vault_data = deserialize(data.subspan(TIERED_PREFIX_LENGTH, *index_end - TIERED_PREFIX_LENGTH));
+    if (!vault_data) {
+        return vault_data;
+    }
+    auto details = deserialize(data.subspan(*index_end));
+    if (!details) {
+        return std::unexpected(details.error());
+    }
+    merge_account_details(*vault_data, *details);
+    return vault_data;
+}
+
+void VaultSerialization::merge_account_details(keeptower::VaultData& vault_data,
+                                               const keeptower::VaultData& details) {
+    std::unordered_map<std::string_view, keeptower::AccountRecord*> by_id;
+    by_id.reserve(static_cast<size_t>(vault_data.accounts_size()));
+    for (auto& account : *vault_data.mutable_accounts()) {
+        by_id.emplace(account.id(), &account);
+    }
+
+    for (const auto& detail : details.accounts()) {
+        const auto it = by_id.find(detail.id());
+        if (it != by_id.end()) {
+            // Detail records leave list fields unset, so merging cannot clobber index edits
+            it->second->MergeFrom(detail);
+        }
+    }
+}
+
 bool VaultSerialization::migrate_schema(keeptower::VaultData& vault_data, bool& modified) {
     auto* metadata = vault_data.mutable_metadata();
     int32_t current_version = metadata->schema_version();
@@ -11,6 +11,9 @@
 
 #include "core/VaultError.h"
 #include "record.pb.h"
+#include <array>
+#include <optional>
+#include <span>
 #include <vector>
 #include <cstdint>
 #include <string>
@@ -22,9 +25,59 @@ namespace KeepTower {
  *
  * VaultSerialization owns the low-level protobuf encode/decode and schema
  * migration mechanics used by higher-level workflow services.
+ *
+ * @section tiered_payload Two-Tier Payload
+ *
+ * serialize_tiered() splits the vault into a small index that is enough to
+ * build the account list and a bulk tier holding the remaining account
+ * fields (passwords, notes, custom fields, history, ...):
+ * @code
+ * [Magic "KTTIER01" (8)][Index Size (8, LE)][Index: VaultData][Bulk: VaultData]
+ * @endcode
+ * The index is a complete VaultData whose account records carry only list
+ * fields (see is_index_field()); the bulk tier holds one record per account
+ * with its id and all remaining fields. merge_account_details() joins them
+ * by account id, so bulk records can be applied after the index was edited.
+ * Payloads without the magic are plain serialize() output.
+ *
+ * @section compressed_payload Compressed Payload
+ *
+ * write_compressed_payload() deflates either layout (zlib, level 1) so
+ * that notes, custom fields and repeated group ids shrink before
+ * encryption:
+ * @code
+ * [Payload Size (8, LE)][zlib stream of the tiered or plain payload]
+ * @endcode
+ * The header flags record whether a stored payload is compressed (see
+ * VaultFormatV2::HEADER_COMPRESSION_MASK). A compressed payload can only be
+ * read whole, so opening it cannot defer the details tier.
  */
 class VaultSerialization {
 public:
+    static constexpr std::array<uint8_t, 8> TIERED_MAGIC = {'K', 'T', 'T', 'I', 'E', 'R', '0', '1'};
+    static constexpr size_t TIERED_PREFIX_LENGTH = 16;  ///< Magic + index size
+    static constexpr size_t COMPRESSED_PREFIX_LENGTH = 8;  ///< Uncompressed size ahead of the zlib stream
+
+    /**
+     * @brief Vault data split into payload tiers, sized but not yet encoded.
+     *
+     * Lets the save path allocate its final buffer before serializing, so
+     * protobuf output is written exactly once, straight into that buffer.
+     */
+    struct TieredPayload {
+        keeptower::VaultData index;    ///< Index tier (the whole vault when not tiered)
+        keeptower::VaultData details;  ///< Bulk tier (unused when not tiered)
+        bool tiered = false;           ///< Whether the two-tier prefix is written
+        size_t index_size = 0;         ///< Encoded size of index
+        size_t details_size = 0;       ///< Encoded size of details
+
+        /** @brief Encoded payload size
+         *  @return Bytes write_payload() produces */
+        [[nodiscard]] size_t size() const noexcept {
+            return (tiered ? TIERED_PREFIX_LENGTH : 0) + index_size + details_size;
+        }
+    };
+
     /**
      * @brief Serialize vault protobuf data into bytes.
      * @param vault_data Vault protobuf object to serialize.
@@ -39,6 +92,102 @@ public:
      */
     static VaultResult<keeptower::VaultData> deserialize(const std::vector<uint8_t>& data);
 
+    /**
+     * @brief Deserialize vault protobuf data from a byte range.
+     * @param data Serialized vault payload bytes.
+     * @return Parsed vault protobuf object or an error.
+     */
+    static VaultResult<keeptower::VaultData> deserialize(std::span<const uint8_t> data);
+
+    /**
+     * @brief Serialize vault data as a two-tier payload.
+     *
+     * Falls back to plain serialize() output when account ids are missing or
+     * duplicated, since the tiers could not be rejoined unambiguously.
+     *
+     * @param vault_data Vault protobuf object to serialize.
+     * @return Serialized payload or an error.
+     */
+    static VaultResult<std::vector<uint8_t>> serialize_tiered(const keeptower::VaultData& vault_data);
+
+    /**
+     * @brief Split and size vault data for serialize_tiered() without encoding it.
+     * @param vault_data Vault protobuf object to serialize.
+     * @return Prepared payload or an error (SerializationFailed if too large).
+     */
+    static VaultResult<TieredPayload> prepare_tiered(const keeptower::VaultData& vault_data);
+
+    /**
+     * @brief Encode a prepared payload into a caller-provided buffer.
+     *
+     * Produces the same bytes as serialize_tiered().
+     *
+     * @param payload Payload from prepare_tiered().
+     * @param out Destination of exactly payload.size() bytes.
+     * @return Success or SerializationFailed.
+     */
+    static VaultResult<> write_payload(const TieredPayload& payload, std::span<uint8_t> out);
+
+    /**
+     * @brief Largest output write_compressed_payload() can produce.
+     * @param payload_size Encoded payload size (TieredPayload::size()).
+     * @return Buffer size that always fits the compressed payload.
+     */
+    static size_t compressed_payload_bound(size_t payload_size);
+
+    /**
+     * @brief Encode a prepared payload and deflate it into a caller-provided buffer.
+     *
+     * The uncompressed encoding and zlib's working memory are wiped before
+     * they are released.
+     *
+     * @param payload Payload from prepare_tiered().
+     * @param out Destination of at least compressed_payload_bound(payload.size()) bytes.
+     * @return Compressed bytes written to the start of out, or SerializationFailed.
+     */
+    static VaultResult<size_t> write_compressed_payload(const TieredPayload& payload, std::span<uint8_t> out);
+
+    /**
+     * @brief Inflate a payload written by write_compressed_payload().
+     * @param data Compressed payload bytes.
+     * @return Tiered or plain payload bytes, or InvalidProtobuf when the
+     *         stream is malformed or does not match its recorded size.
+     */
+    static VaultResult<std::vector<uint8_t>> decompress_payload(std::span<const uint8_t> data);
+
+    /**
+     * @brief Locate the end of the index tier.
+     * @param prefix At least the first TIERED_PREFIX_LENGTH payload bytes.
+     * @return Offset of the bulk tier, or nullopt for a plain payload.
+     */
+    static std::optional<size_t> tiered_index_end(std::span<const uint8_t> prefix);
+
+    /**
+     * @brief Deserialize either payload layout into complete vault data.
+     * @param data Two-tier or plain payload bytes.
+     * @return Parsed vault protobuf object or an error.
+     */
+    static VaultResult<keeptower::VaultData> deserialize_payload(std::span<const uint8_t> data);
+
+    /**
+     * @brief Apply bulk-tier records to index-tier vault data.
+     *
+     * Records are matched by account id; bulk records for accounts that no
+     * longer exist are ignored.
+     *
+     * @param vault_data Vault data loaded from the index tier (updated in place).
+     * @param details Parsed bulk tier.
+     */
+    static void merge_account_details(keeptower::VaultData& vault_data,
+                                      const keeptower::VaultData& details);
+
+    /**
+     * @brief Whether an AccountRecord field belongs to the index tier.
+     * @param field_number Protobuf field number in AccountRecord.
+     * @return true for list fields (id, names, tags, groups, flags, ordering).
+     */
+    static bool is_index_field(int field_number);
+
     /**
      * @brief Apply schema migrations to a parsed vault protobuf object.
      * @param vault_data Vault protobuf object to migrate.
@@ -49,6 +198,7 @@ public:
 
 private:
     static constexpr int32_t CURRENT_SCHEMA_VERSION = 2;
+    static constexpr size_t MAX_VAULT_SIZE = 100 * 1024 * 1024;
 
     VaultSerialization() = delete;
     ~VaultSerialization() = delete;
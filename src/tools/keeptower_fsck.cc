@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file keeptower_fsck.cc
+ * @brief keeptower-fsck: offline integrity audit of vault files and backup sets
+ *
+ * Checks every vault file under the given paths in parallel with
+ * VaultVerificationService and prints one JSON object per file, then a
+ * summary object, on standard output. With --restore it instead restores a
+ * vault from its newest backup that passes the same checks.
+ */
+
+#include "core/services/VaultVerificationService.h"
+#include "lib/storage/VaultIO.h"
+#include "lib/vaultformat/VaultFormatV2.h"
+#include "utils/Log.h"
+
+#include <openssl/crypto.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <termios.h>
+#include <unistd.h>
+
+namespace {
+
+namespace fs = std::filesystem;
+using KeepTower::VaultVerificationService;
+
+constexpr int EXIT_CLEAN = 0;
+constexpr int EXIT_DAMAGED = 1;
+constexpr int EXIT_USAGE = 2;
+
+constexpr std::string_view USAGE =
+    "Usage: keeptower-fsck [OPTIONS] PATH...\n"
+    "       keeptower-fsck [OPTIONS] --restore VAULT\n"
+    "\n"
+    "Check KeepTower vault files and backups without opening them.\n"
+    "Directories are searched recursively for vaults and backups.\n"
+    "\n"
+    "Options:\n"
+    "  -j, --jobs N          Check N files at a time (default: CPU count)\n"
+    "  -u, --user NAME       Also authenticate the ciphertext as NAME; the password\n"
+    "                        is read from the first line of standard input\n"
+    "      --restore VAULT   Restore VAULT from its newest backup that passes the checks\n"
+    "      --backup-dir DIR  Backup directory for --restore (default: next to VAULT)\n"
+    "  -v, --verbose         Log progress to standard error\n"
+    "  -h, --help            Show this help\n"
+    "\n"
+    "Output: one JSON object per line on standard output.\n"
+    "Exit status: 0 if no file is damaged, 1 if one is (or restore failed), 2 on usage errors.\n";
+
+struct Options {
+    std::vector<std::string> paths;
+    unsigned jobs = 0;
+    std::optional<std::string> user;
+    std::optional<std::string> restore_vault;
+    std::string backup_dir;
+    bool verbose = false;
+};
+
+std::string json_string(std::string_view text) {
+    std::string out = "\"";
+    for (const char c : text) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+std::string to_json(const VaultVerificationService::Report& report) {
+    std::ostringstream out;
+    out << "{\"path\":" << json_string(report.path)
+        << ",\"status\":\"" << KeepTower::to_string(report.status) << '"'
+        << ",\"failed_check\":\"" << KeepTower::to_string(report.failed_stage) << '"'
+        << ",\"error\":" << (report.error ? json_string(KeepTower::to_string(*report.error)) : "null")
+        << ",\"version\":" << report.version
+        << ",\"size\":" << report.size
+        << ",\"header_fec\":" << (report.header_fec ? "true" : "false")
+        << ",\"key_slots\":" << report.key_slots
+        << ",\"active_key_slots\":" << report.active_key_slots
+        << ",\"data_fec\":" << (report.data_fec ? "true" : "false")
+        << ",\"damaged_windows\":" << report.damaged_windows
+        << ",\"repaired_bytes\":" << report.repaired_bytes
+        << ",\"journal_frames\":" << report.journal_frames
+        << ",\"journal_torn\":" << (report.journal_torn ? "true" : "false")
+        << ",\"credential\":\"" << KeepTower::to_string(report.credential) << "\"}";
+    return out.str();
+}
+
+/// Whether a file found while scanning a directory should be checked
+bool looks_like_vault(const fs::path& path) {
+    const std::string name = path.filename().string();
+    if (path.extension() == ".vault" || name.find(".backup") != std::string::npos) {
+        return true;
+    }
+    // Renamed vaults still carry the magic
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic = 0;
+    return file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) &&
+           magic == KeepTower::VaultFormatV2::VAULT_MAGIC;
+}
+
+bool collect(const std::string& argument, std::vector<std::string>& files) {
+    std::error_code ec;
+    const fs::path path(argument);
+    if (fs::is_regular_file(path, ec)) {
+        files.push_back(argument);  // Named explicitly: always reported
+        return true;
+    }
+    if (!fs::is_directory(path, ec)) {
+        std::cerr << "keeptower-fsck: " << argument << ": no such file or directory\n";
+        return false;
+    }
+    for (fs::recursive_directory_iterator it(path, fs::directory_options::skip_permission_denied, ec), end;
+         !ec && it != end; it.increment(ec)) {
+        if (it->is_regular_file(ec) && !it->is_symlink(ec) && looks_like_vault(it->path())) {
+            files.push_back(it->path().string());
+        }
+    }
+    if (ec) {
+        std::cerr << "keeptower-fsck: " << argument << ": " << ec.message() << '\n';
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::string> read_password() {
+    const bool terminal = isatty(STDIN_FILENO) != 0;
+    termios saved{};
+    if (terminal) {
+        std::cerr << "Password: " << std::flush;
+        if (tcgetattr(STDIN_FILENO, &saved) == 0) {
+            termios silent = saved;
+            silent.c_lflag &= ~static_cast<tcflag_t>(ECHO);
+            tcsetattr(STDIN_FILENO, TCSAFLUSH, &silent);
+        }
+    }
+    std::string password;
+    const bool read = static_cast<bool>(std::getline(std::cin, password));
+    if (terminal) {
+        tcsetattr(STDIN_FILENO, TCSAFLUSH, &saved);
+        std::cerr << '\n';
+    }
+    if (!read) {
+        return std::nullopt;
+    }
+    return password;
+}
+
+std::optional<Options> parse_arguments(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        auto value = [&]() -> const char* { return i + 1 < argc ? argv[++i] : nullptr; };
+
+        if (arg == "-h" || arg == "--help") {
+            std::cout << USAGE;
+            std::exit(EXIT_CLEAN);
+        } else if (arg == "-v" || arg == "--verbose") {
+            options.verbose = true;
+        } else if (arg == "-j" || arg == "--jobs") {
+            const char* jobs = value();
+            if (!jobs) {
+                return std::nullopt;
+            }
+            try {
+                options.jobs = static_cast<unsigned>(std::stoul(jobs));
+            } catch (const std::exception&) {
+                return std::nullopt;
+            }
+        } else if (arg == "-u" || arg == "--user") {
+            const char* user = value();
+            if (!user) {
+                return std::nullopt;
+            }
+            options.user = user;
+        } else if (arg == "--restore") {
+            const char* vault = value();
+            if (!vault) {
+                return std::nullopt;
+            }
+            options.restore_vault = vault;
+        } else if (arg == "--backup-dir") {
+            const char* dir = value();
+            if (!dir) {
+                return std::nullopt;
+            }
+            options.backup_dir = dir;
+        } else if (arg.starts_with('-') && arg != "-") {
+            return std::nullopt;
+        } else {
+            options.paths.emplace_back(arg);
+        }
+    }
+    if (options.paths.empty() == !options.restore_vault) {
+        return std::nullopt;
+    }
+    return options;
+}
+
+bool restorable(const VaultVerificationService::Report& report, bool credential_given) {
+    if (report.status != VaultVerificationService::FileStatus::Intact &&
+        report.status != VaultVerificationService::FileStatus::Degraded) {
+        return false;
+    }
+    return !credential_given || report.credential == VaultVerificationService::CredentialStatus::Verified;
+}
+
+int run_restore(const Options& options, const VaultVerificationService& verifier) {
+    std::mutex output_mutex;
+    std::optional<std::string> chosen;
+    const auto accept = [&](const std::string& backup) {
+        const auto report = verifier.verify(backup);
+        std::lock_guard lock(output_mutex);
+        std::cout << to_json(report) << '\n';
+        const bool ok = restorable(report, options.user.has_value());
+        if (ok) {
+            chosen = backup;
+        }
+        return ok;
+    };
+
+    const auto result = KeepTower::VaultIO::restore_from_backup(*options.restore_vault, options.backup_dir, accept);
+    std::cout << "{\"restore\":{\"vault\":" << json_string(*options.restore_vault)
+              << ",\"ok\":" << (result ? "true" : "false")
+              << ",\"backup\":" << (result && chosen ? json_string(*chosen) : "null")
+              << ",\"error\":" << (result ? "null" : json_string(KeepTower::to_string(result.error())))
+              << "}}\n";
+    return result ? EXIT_CLEAN : EXIT_DAMAGED;
+}
+
+int run_check(const Options& options, const VaultVerificationService& verifier) {
+    std::vector<std::string> files;
+    for (const auto& path : options.paths) {
+        if (!collect(path, files)) {
+            return EXIT_USAGE;
+        }
+    }
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+
+    const auto started = std::chrono::steady_clock::now();
+    const auto reports = verifier.verify_all(files, options.jobs);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    size_t counts[4] = {};
+    uint64_t bytes = 0;
+    for (const auto& report : reports) {
+        std::cout << to_json(report) << '\n';
+        ++counts[static_cast<size_t>(report.status)];
+        bytes += report.size;
+    }
+
+    using FileStatus = VaultVerificationService::FileStatus;
+    const size_t damaged = counts[static_cast<size_t>(FileStatus::Damaged)];
+    std::cout << "{\"summary\":{\"files\":" << reports.size()
+              << ",\"intact\":" << counts[static_cast<size_t>(FileStatus::Intact)]
+              << ",\"degraded\":" << counts[static_cast<size_t>(FileStatus::Degraded)]
+              << ",\"damaged\":" << damaged
+              << ",\"unsupported\":" << counts[static_cast<size_t>(FileStatus::Unsupported)]
+              << ",\"bytes\":" << bytes
+              << ",\"seconds\":" << seconds << "}}\n";
+    return damaged == 0 ? EXIT_CLEAN : EXIT_DAMAGED;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    const auto options = parse_arguments(argc, argv);
+    if (!options) {
+        std::cerr << USAGE;
+        return EXIT_USAGE;
+    }
+
+    // The report is the output; library logging is only for diagnosis
+    KeepTower::Log::current_level = options->verbose ? KeepTower::Log::Level::Info
+                                                     : KeepTower::Log::Level::Error;
+
+    std::optional<VaultVerificationService> verifier;
+    if (options->user) {
+        auto password = read_password();
+        if (!password) {
+            std::cerr << "keeptower-fsck: no password on standard input\n";
+            return EXIT_USAGE;
+        }
+        verifier.emplace(VaultVerificationService::Credential{*options->user, *password});
+        OPENSSL_cleanse(password->data(), password->size());
+    } else {
+        verifier.emplace();
+    }
+
+    return options->restore_vault ? run_restore(*options, *verifier) : run_check(*options, *verifier);
+}
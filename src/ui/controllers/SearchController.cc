@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <cctype>
 #include <set>
+#include <utility>
 
 // Convert string to lowercase for case-insensitive comparison
 static std::string to_lower(std::string str) {
@@ -14,43 +15,147 @@ static std::string to_lower(std::string str) {
     return str;
 }
 
+// Account ID, for the position index
+static const std::string& account_id_of(const keeptower::AccountRecord& account) {
+    return account.id();
+}
+
+// Index field bits searched for a field filter
+static uint8_t index_fields(SearchField field) {
+    using Index = KeepTower::AccountSearchIndex;
+    switch (field) {
+        case SearchField::ACCOUNT_NAME: return Index::ACCOUNT_NAME;
+        case SearchField::USERNAME:     return Index::USER_NAME;
+        case SearchField::EMAIL:        return Index::EMAIL;
+        case SearchField::WEBSITE:      return Index::WEBSITE;
+        case SearchField::NOTES:        return Index::NOTES;
+        case SearchField::TAGS:         return Index::TAGS;
+        case SearchField::ALL:
+        default:                        return Index::ALL_FIELDS;
+    }
+}
+
 std::vector<keeptower::AccountRecord> SearchController::filter_accounts(
     const std::vector<keeptower::AccountRecord>& accounts,
     const SearchCriteria& criteria) const {
 
-    std::vector<keeptower::AccountRecord> filtered;
-    filtered.reserve(accounts.size());
+    std::vector<const keeptower::AccountRecord*> candidates;
+    if (criteria.search_text.empty()) {
+        candidates.reserve(accounts.size());
+        for (const auto& account : accounts) {
+            candidates.push_back(&account);
+        }
+    } else {
+        candidates = search_candidates(accounts, criteria);
+    }
 
-    // Apply filters
-    for (const auto& account : accounts) {
+    // Apply filters, keeping each match with its sort key
+    const KeepTower::FoldedNeedle needle(criteria.search_text);
+    std::vector<std::pair<std::string, const keeptower::AccountRecord*>> matched;
+    for (const auto* account : candidates) {
         bool matches = true;
 
         // Apply search text filter
         if (!criteria.search_text.empty()) {
-            if (!matches_search(account, criteria.search_text,
-                               criteria.field_filter, criteria.fuzzy_threshold)) {
+            if (!matches_needle(*account, needle, criteria.search_text,
+                                criteria.field_filter, criteria.fuzzy_threshold)) {
                 matches = false;
             }
         }
 
         // Apply tag filter
         if (matches && !criteria.tag_filter.empty()) {
-            if (!has_tag(account, criteria.tag_filter)) {
+            if (!has_tag(*account, criteria.tag_filter)) {
                 matches = false;
             }
         }
 
         if (matches) {
-            filtered.push_back(account);
+            matched.emplace_back(to_lower(account->account_name()), account);
         }
     }
 
-    // Sort results
-    sort_accounts(filtered, criteria.sort_order);
+    // Sort results on names lowercased once, not once per comparison;
+    // candidates are in list order, so equal names keep it
+    if (criteria.sort_order == SortOrder::ASCENDING) {
+        std::stable_sort(matched.begin(), matched.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+    } else {
+        std::stable_sort(matched.begin(), matched.end(),
+                         [](const auto& a, const auto& b) { return a.first > b.first; });
+    }
 
+    std::vector<keeptower::AccountRecord> filtered;
+    filtered.reserve(matched.size());
+    for (const auto& [key, account] : matched) {
+        filtered.push_back(*account);
+    }
     return filtered;
 }
 
+void SearchController::index_accounts(const std::vector<keeptower::AccountRecord>& accounts) {
+    m_index.rebuild(accounts);
+    m_positions.rebuild(accounts, account_id_of);
+}
+
+void SearchController::index_account(const keeptower::AccountRecord& account) {
+    m_index.upsert(account);
+}
+
+void SearchController::unindex_account(std::string_view account_id) {
+    m_index.remove(account_id);
+}
+
+void SearchController::clear_index() {
+    m_index.clear();
+    m_positions.invalidate();
+}
+
+std::vector<const keeptower::AccountRecord*> SearchController::search_candidates(
+    const std::vector<keeptower::AccountRecord>& accounts,
+    const SearchCriteria& criteria) const {
+
+    std::vector<const keeptower::AccountRecord*> candidates;
+    auto every_account = [&]() {
+        candidates.reserve(accounts.size());
+        for (const auto& account : accounts) {
+            candidates.push_back(&account);
+        }
+        return candidates;
+    };
+
+    // Without an index that covers the list (or with a threshold every
+    // field passes), every account has to be scored
+    if (m_index.size() == 0 || m_index.size() != accounts.size() || criteria.fuzzy_threshold <= 0) {
+        return every_account();
+    }
+
+    // fuzzy_score() maps similarity onto 0-70 relative to the longer of
+    // query and field, so a field up to 70/threshold times the query's
+    // length can pass, with up to length * (70 - threshold) / threshold
+    // edits. Each edit breaks at most three of the query's trigrams; once
+    // the edits could break all of them (or the query is too short to have
+    // any), only scoring every account finds all typo matches
+    const size_t length = criteria.search_text.size();
+    const size_t edits = criteria.fuzzy_threshold >= 70
+        ? 0 : length * static_cast<size_t>(70 - criteria.fuzzy_threshold) /
+                  static_cast<size_t>(criteria.fuzzy_threshold);
+    if (edits > 0 && 3 * edits >= KeepTower::AccountSearchIndex::trigram_count(criteria.search_text)) {
+        return every_account();
+    }
+    const auto slots = m_index.candidates(criteria.search_text,
+                                          index_fields(criteria.field_filter), 3 * edits);
+
+    candidates.reserve(slots.size());
+    for (const uint32_t slot : slots) {
+        if (auto position = m_positions.lookup(accounts, m_index.id_of(slot), account_id_of)) {
+            candidates.push_back(&accounts[*position]);
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    return candidates;
+}
+
 bool SearchController::matches_search(
     const keeptower::AccountRecord& account,
     const std::string& search_text,
@@ -61,30 +166,40 @@ bool SearchController::matches_search(
         return true;
     }
 
-    // Check all fields if field == ALL
-    if (field == SearchField::ALL) {
-        // Try all fields until one matches
-        const SearchField all_fields[] = {
-            SearchField::ACCOUNT_NAME,
-            SearchField::USERNAME,
-            SearchField::EMAIL,
-            SearchField::WEBSITE,
-            SearchField::NOTES,
-            SearchField::TAGS
-        };
+    return matches_needle(account, KeepTower::FoldedNeedle(search_text), search_text,
+                          field, fuzzy_threshold);
+}
 
-        for (const auto& f : all_fields) {
-            std::string field_content = get_field_content(account, f);
-            if (field_matches(field_content, search_text, fuzzy_threshold)) {
-                return true;
-            }
-        }
-        return false;
-    }
+bool SearchController::matches_needle(
+    const keeptower::AccountRecord& account,
+    const KeepTower::FoldedNeedle& needle,
+    std::string_view search_text,
+    SearchField field,
+    int fuzzy_threshold) const {
 
-    // Check specific field
-    std::string field_content = get_field_content(account, field);
-    return field_matches(field_content, search_text, fuzzy_threshold);
+    // Fields are searched where they are; only the joined tags need a copy
+    auto matches = [&](std::string_view value) {
+        return field_matches(value, needle, search_text, fuzzy_threshold);
+    };
+
+    switch (field) {
+        case SearchField::ACCOUNT_NAME: return matches(account.account_name());
+        case SearchField::USERNAME:     return matches(account.user_name());
+        case SearchField::EMAIL:        return matches(account.email());
+        case SearchField::WEBSITE:      return matches(account.website());
+        case SearchField::NOTES:        return matches(account.notes());
+        case SearchField::TAGS:         return matches(get_field_content(account, SearchField::TAGS));
+        case SearchField::ALL:
+            // Try all fields until one matches
+            return matches(account.account_name()) ||
+                   matches(account.user_name()) ||
+                   matches(account.email()) ||
+                   matches(account.website()) ||
+                   matches(account.notes()) ||
+                   matches(get_field_content(account, SearchField::TAGS));
+        default:
+            return matches(get_field_content(account, field));
+    }
 }
 
 bool SearchController::has_tag(
@@ -183,16 +298,21 @@ int SearchController::calculate_relevance_score(
 }
 
 bool SearchController::field_matches(
-    const std::string& field_value,
-    const std::string& search_text,
+    std::string_view field_value,
+    const KeepTower::FoldedNeedle& needle,
+    std::string_view search_text,
     int fuzzy_threshold) const {
 
     if (field_value.empty()) {
         return false;
     }
 
-    // Use fuzzy matching from FuzzyMatch utility
-    return KeepTower::FuzzyMatch::fuzzy_matches(search_text, field_value, fuzzy_threshold);
+    // Exact, prefix and substring matches score as in FuzzyMatch::fuzzy_score()
+    if (const size_t at = needle.find_in(field_value); at != std::string_view::npos) {
+        const int score = at > 0 ? 80 : (field_value.size() == needle.size() ? 100 : 90);
+        return score >= fuzzy_threshold;
+    }
+    return KeepTower::FuzzyMatch::similarity_matches(search_text, field_value, fuzzy_threshold);
 }
 
 std::string SearchController::get_field_content(
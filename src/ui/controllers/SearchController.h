@@ -15,7 +15,11 @@
 #include <vector>
 #include <functional>
 #include <optional>
+#include <string_view>
 #include "record.pb.h"
+#include "../../core/managers/AccountSearchIndex.h"
+#include "../../core/managers/IdPositionIndex.h"
+#include "../../utils/helpers/FoldedSearch.h"
 
 /**
  * @brief Field filter options for searching
@@ -62,6 +66,13 @@ struct SearchCriteria {
  * This class separates search logic from MainWindow,
  * making it testable and reusable.
  *
+ * Without an index every keystroke scores every field of every account.
+ * After index_accounts(), filter_accounts() first narrows the accounts to
+ * those sharing trigrams with the query (see KeepTower::AccountSearchIndex)
+ * and scores only those. Substring matches are found exactly as before;
+ * typo matches must share at least one trigram with the query. The caller
+ * keeps the index in step with index_account() and unindex_account().
+ *
  * @section search_controller_usage Usage Example
  * @code
  * SearchController controller;
@@ -71,6 +82,7 @@ struct SearchCriteria {
  * criteria.field_filter = SearchField::ACCOUNT_NAME;
  * criteria.sort_order = SortOrder::ASCENDING;
  *
+ * controller.index_accounts(all_accounts);  // Optional, for large vaults
  * auto results = controller.filter_accounts(all_accounts, criteria);
  * @endcode
  */
@@ -80,7 +92,7 @@ public:
     ~SearchController() = default;
 
     // Allow copy and move
-    /** @brief Copy constructor - SearchController is stateless */
+    /** @brief Copy constructor - copies the search index, if any */
     SearchController(const SearchController&) = default;
 
     /** @brief Copy assignment operator.
@@ -100,6 +112,9 @@ public:
      * Applies search text, tag filter, and field filter to the account list.
      * Returns filtered accounts sorted according to criteria.
      *
+     * Uses the search index when it holds as many accounts as @p accounts;
+     * otherwise scans them all.
+     *
      * @param accounts All accounts to filter
      * @param criteria Search and filter criteria
      * @return Vector of accounts matching the criteria
@@ -108,6 +123,41 @@ public:
         const std::vector<keeptower::AccountRecord>& accounts,
         const SearchCriteria& criteria) const;
 
+    /**
+     * @brief Build the search index for an account list
+     *
+     * @param accounts All accounts later passed to filter_accounts()
+     */
+    void index_accounts(const std::vector<keeptower::AccountRecord>& accounts);
+
+    /**
+     * @brief Add an account to the search index, or reindex a changed one
+     *
+     * @param account Account that was added or updated
+     */
+    void index_account(const keeptower::AccountRecord& account);
+
+    /**
+     * @brief Remove an account from the search index
+     *
+     * @param account_id ID of the deleted account
+     */
+    void unindex_account(std::string_view account_id);
+
+    /**
+     * @brief Drop the search index, so filtering scans every account
+     */
+    void clear_index();
+
+    /**
+     * @brief Get the search index
+     *
+     * @return Index built by index_accounts() (empty if none)
+     */
+    [[nodiscard]] const KeepTower::AccountSearchIndex& search_index() const noexcept {
+        return m_index;
+    }
+
     /**
      * @brief Check if an account matches search text
      *
@@ -172,17 +222,55 @@ public:
         SearchField field = SearchField::ALL) const;
 
 private:
+    KeepTower::AccountSearchIndex m_index;               ///< Trigrams of the indexed accounts
+    mutable KeepTower::IdPositionIndex m_positions;      ///< Account ID -> position in the filtered list
+
+    /**
+     * @brief Accounts worth scoring for a search
+     *
+     * @param accounts All accounts
+     * @param criteria Search criteria with non-empty search text
+     * @return Candidates from the index, or every account when there is
+     *         none or the fuzzy threshold allows typo matches that share no
+     *         trigram with the search text
+     */
+    [[nodiscard]] std::vector<const keeptower::AccountRecord*> search_candidates(
+        const std::vector<keeptower::AccountRecord>& accounts,
+        const SearchCriteria& criteria) const;
+
+    /**
+     * @brief matches_search() with the search text already folded
+     *
+     * @param account Account to check
+     * @param needle Folded search text, built once per filter
+     * @param search_text Text to search for (non-empty)
+     * @param field Which field(s) to search
+     * @param fuzzy_threshold Minimum score for fuzzy matches (0-100)
+     * @return true if account matches search criteria
+     */
+    [[nodiscard]] bool matches_needle(
+        const keeptower::AccountRecord& account,
+        const KeepTower::FoldedNeedle& needle,
+        std::string_view search_text,
+        SearchField field,
+        int fuzzy_threshold) const;
+
     /**
      * @brief Check if text matches in a specific field
      *
+     * Same result as FuzzyMatch::fuzzy_matches(), with the substring test
+     * done in place against the folded search text.
+     *
      * @param field_value Field content to search
+     * @param needle Folded search text
      * @param search_text Text to find
      * @param fuzzy_threshold Minimum fuzzy match score
      * @return true if field matches
      */
     [[nodiscard]] bool field_matches(
-        const std::string& field_value,
-        const std::string& search_text,
+        std::string_view field_value,
+        const KeepTower::FoldedNeedle& needle,
+        std::string_view search_text,
         int fuzzy_threshold) const;
 
     /**
@@ -8,7 +8,9 @@
 #include "../../../utils/StringHelpers.h"
 
 #include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <string>
 
 namespace KeepTower::Ui {
 
@@ -21,6 +23,8 @@ constexpr int MIN_BACKUP_COUNT = 1;
 constexpr int MAX_BACKUP_COUNT = 50;
 constexpr int DEFAULT_BACKUP_COUNT = 5;
 
+constexpr unsigned int INTEGRITY_REFRESH_MS = 1000;
+
 }  // namespace
 
 StoragePreferencesPage::StoragePreferencesPage(VaultManager* vault_manager, Glib::RefPtr<Gio::Settings> settings)
@@ -44,7 +48,11 @@ StoragePreferencesPage::StoragePreferencesPage(VaultManager* vault_manager, Glib
       m_backup_help("Older backups are automatically deleted"),
       m_backup_path_box(Gtk::Orientation::HORIZONTAL, 12),
       m_backup_path_browse_button("Browse..."),
-      m_restore_backup_button("Restore from Backup...") {
+      m_restore_backup_button("Restore from Backup..."),
+      m_integrity_section_title("<b>Integrity Check</b>"),
+      m_integrity_description("The open vault and its backups are re-read in the background while "
+                              "KeepTower is idle; damage that error correction can fix is repaired"),
+      m_integrity_check_button("Check Now") {
     set_margin_start(18);
     set_margin_end(18);
     set_margin_top(18);
@@ -170,6 +178,32 @@ StoragePreferencesPage::StoragePreferencesPage(VaultManager* vault_manager, Glib
 
     append(*backup_section);
 
+    // Integrity check section
+    auto* integrity_section = Gtk::make_managed<Gtk::Box>(Gtk::Orientation::VERTICAL, 6);
+    integrity_section->set_margin_top(24);
+
+    m_integrity_section_title.set_use_markup(true);
+    m_integrity_section_title.set_halign(Gtk::Align::START);
+    m_integrity_section_title.add_css_class("heading");
+    integrity_section->append(m_integrity_section_title);
+
+    m_integrity_description.set_wrap(true);
+    m_integrity_description.set_max_width_chars(60);
+    m_integrity_description.set_halign(Gtk::Align::START);
+    m_integrity_description.add_css_class("dim-label");
+    integrity_section->append(m_integrity_description);
+
+    m_integrity_status_label.set_wrap(true);
+    m_integrity_status_label.set_max_width_chars(60);
+    m_integrity_status_label.set_halign(Gtk::Align::START);
+    integrity_section->append(m_integrity_status_label);
+
+    m_integrity_check_button.set_halign(Gtk::Align::START);
+    m_integrity_check_button.set_margin_top(6);
+    integrity_section->append(m_integrity_check_button);
+
+    append(*integrity_section);
+
     // Signals
     m_rs_enabled_check.signal_toggled().connect(
         sigc::mem_fun(*this, &StoragePreferencesPage::on_rs_enabled_toggled));
@@ -184,6 +218,13 @@ StoragePreferencesPage::StoragePreferencesPage(VaultManager* vault_manager, Glib
         sigc::mem_fun(*this, &StoragePreferencesPage::on_backup_path_browse));
     m_restore_backup_button.signal_clicked().connect(
         sigc::mem_fun(*this, &StoragePreferencesPage::on_restore_backup));
+    m_integrity_check_button.signal_clicked().connect(
+        sigc::mem_fun(*this, &StoragePreferencesPage::on_check_integrity_now));
+
+    // Passes finish on the scrubber's thread; poll while the page exists
+    refresh_integrity_status();
+    Glib::signal_timeout().connect(
+        sigc::mem_fun(*this, &StoragePreferencesPage::refresh_integrity_status), INTEGRITY_REFRESH_MS);
 }
 
 void StoragePreferencesPage::load_from_model(const PreferencesModel& model) {
@@ -266,6 +307,59 @@ void StoragePreferencesPage::on_backup_enabled_toggled() noexcept {
     m_backup_help.set_sensitive(enabled);
 }
 
+void StoragePreferencesPage::on_check_integrity_now() {
+    if (!m_vault_manager || !m_vault_manager->is_vault_open()) {
+        return;
+    }
+    m_vault_manager->request_integrity_check();
+    refresh_integrity_status();
+}
+
+bool StoragePreferencesPage::refresh_integrity_status() {
+    using FileStatus = KeepTower::VaultScrubService::FileStatus;
+
+    if (!m_vault_manager || !m_vault_manager->is_v2_vault()) {
+        m_integrity_status_label.set_text("No vault open");
+        m_integrity_check_button.set_sensitive(false);
+        return true;
+    }
+
+    const auto status = m_vault_manager->get_integrity_status();
+    m_integrity_check_button.set_sensitive(status.watching && !status.running);
+
+    std::string text;
+    if (status.last_pass) {
+        const auto& pass = *status.last_pass;
+        const auto finished = Glib::DateTime::create_now_local(
+            static_cast<gint64>(std::chrono::system_clock::to_time_t(pass.finished)));
+        text = "Last checked " + finished.format("%Y-%m-%d %H:%M").raw() + ": " +
+               std::to_string(pass.files.size()) + (pass.files.size() == 1 ? " file" : " files");
+
+        const size_t repaired = pass.count(FileStatus::Repaired);
+        const size_t damaged = pass.count(FileStatus::Damaged);
+        const size_t skipped = pass.count(FileStatus::Skipped);
+        if (repaired == 0 && damaged == 0) {
+            text += ", all intact";
+        }
+        if (repaired != 0) {
+            text += ", " + std::to_string(repaired) + " repaired";
+        }
+        if (damaged != 0) {
+            text += ", " + std::to_string(damaged) + " damaged beyond repair";
+        }
+        if (skipped != 0) {
+            text += ", " + std::to_string(skipped) + " skipped";
+        }
+    } else {
+        text = "Not checked yet";
+    }
+    if (status.running) {
+        text += " (checking now...)";
+    }
+    m_integrity_status_label.set_text(text);
+    return true;
+}
+
 void StoragePreferencesPage::on_backup_path_browse() {
     auto* parent_window = dynamic_cast<Gtk::Window*>(get_root());
     if (!parent_window) {
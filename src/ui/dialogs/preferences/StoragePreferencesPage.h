@@ -22,6 +22,7 @@ namespace KeepTower::Ui {
  * - Reed-Solomon settings can be edited as application defaults, or (when a
  *   vault is open) applied to the currently open vault.
  * - Backup settings are treated as vault-scoped when a vault is open.
+ * - Integrity check status reflects the background scrubber of the open vault.
  */
 class StoragePreferencesPage final : public Gtk::Box {
 public:
@@ -60,6 +61,15 @@ private:
     /** @brief Restore a vault from the most recent backup for a selected vault file. */
     void on_restore_backup();
 
+    /** @brief Ask the vault manager to check the open vault and its backups now. */
+    void on_check_integrity_now();
+
+    /**
+     * @brief Refresh the integrity status label from the vault manager.
+     * @return true to keep the periodic refresh running.
+     */
+    bool refresh_integrity_status();
+
     Gtk::Label* m_info_label = nullptr;  ///< Informational note (vault-scoped vs defaults)
 
     VaultManager* m_vault_manager = nullptr;  ///< Non-owning pointer to vault manager (optional)
@@ -90,6 +100,12 @@ private:
     Gtk::Entry m_backup_path_entry;  ///< Backup directory path entry
     Gtk::Button m_backup_path_browse_button;  ///< Browse button for backup directory
     Gtk::Button m_restore_backup_button;  ///< Restore from backup action
+
+    // Integrity check
+    Gtk::Label m_integrity_section_title;  ///< Section title label
+    Gtk::Label m_integrity_description;  ///< Section description label
+    Gtk::Label m_integrity_status_label;  ///< Outcome of the last background check
+    Gtk::Button m_integrity_check_button;  ///< Start a check now
 };
 
 }  // namespace KeepTower::Ui
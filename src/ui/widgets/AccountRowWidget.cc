@@ -30,9 +30,13 @@ AccountRowWidget::AccountRowWidget()
 AccountRowWidget::~AccountRowWidget() = default;
 
 void AccountRowWidget::set_account(const keeptower::AccountRecord& account) {
-    m_account_id = account.id();
-    m_label.set_text(account.account_name());
-    m_is_favorite = account.is_favorite();
+    set_account(account.id(), account.account_name(), account.is_favorite());
+}
+
+void AccountRowWidget::set_account(const std::string& account_id, const std::string& account_name, bool is_favorite) {
+    m_account_id = account_id;
+    m_label.set_text(account_name);
+    m_is_favorite = is_favorite;
     if (m_is_favorite) {
         m_favorite_icon.set_from_icon_name("starred-symbolic");
     } else {
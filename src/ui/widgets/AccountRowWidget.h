@@ -53,6 +53,14 @@ public:
      */
     void set_account(const keeptower::AccountRecord& account);
 
+    /**
+     * @brief Set the fields the row displays
+     * @param account_id Account unique identifier
+     * @param account_name Name to show
+     * @param is_favorite Whether to show a filled star
+     */
+    void set_account(const std::string& account_id, const std::string& account_name, bool is_favorite);
+
     /**
      * @brief Get current account ID
      * @return Account unique identifier
@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2026 tjdeveng
+
+/**
+ * @file AccountTreeItem.h
+ * @brief Model object for one row of the account tree
+ *
+ * AccountTreeWidget keeps one of these per visible group and per visible
+ * account-in-group. They carry only what a row displays; the widgets that
+ * show them are created by the list view for the rows on screen and
+ * recycled as the view scrolls.
+ */
+
+#pragma once
+#include <giomm/liststore.h>
+#include <glibmm/object.h>
+#include <string>
+
+#include "record.pb.h"
+
+/**
+ * @class AccountTreeItem
+ * @brief Lightweight group or account row in the account tree model
+ *
+ * Group items own the store of their account items, which the tree list
+ * model expands beneath them. Items are immutable once listed: a changed
+ * row is replaced, so only that row is rebound.
+ */
+class AccountTreeItem : public Glib::Object {
+public:
+    /** @brief Row kind */
+    enum class Kind {
+        GROUP,   ///< Group header with child accounts
+        ACCOUNT  ///< Account inside a group
+    };
+
+    /**
+     * @brief Create a group row
+     * @param group Group to display (favorites and "all" are synthetic groups)
+     * @return New item with an empty child store
+     */
+    static Glib::RefPtr<AccountTreeItem> create_group(const keeptower::AccountGroup& group) {
+        return Glib::make_refptr_for_instance<AccountTreeItem>(new AccountTreeItem(group));
+    }
+
+    /**
+     * @brief Create an account row
+     * @param account_id Account identifier
+     * @param account_name Name shown in the row
+     * @param is_favorite Whether the star is filled
+     * @param group_id Group the row is listed under
+     * @return New item
+     */
+    static Glib::RefPtr<AccountTreeItem> create_account(const std::string& account_id,
+                                                        const std::string& account_name,
+                                                        bool is_favorite,
+                                                        const std::string& group_id) {
+        return Glib::make_refptr_for_instance<AccountTreeItem>(
+            new AccountTreeItem(account_id, account_name, is_favorite, group_id));
+    }
+
+    /** @brief Row kind */
+    Kind kind() const { return m_kind; }
+
+    /** @brief Group ID (group rows) or account ID (account rows) */
+    const std::string& id() const { return m_id; }
+
+    /** @brief Group name or account name */
+    const std::string& name() const { return m_name; }
+
+    /** @brief Group the row belongs to (its own ID for group rows) */
+    const std::string& group_id() const { return m_group_id; }
+
+    /** @brief Whether the account is a favorite (account rows) */
+    bool is_favorite() const { return m_is_favorite; }
+
+    /** @brief Icon name (group rows) */
+    const std::string& icon() const { return m_icon; }
+
+    /** @brief Accounts listed under the group (group rows; null for accounts) */
+    const Glib::RefPtr<Gio::ListStore<AccountTreeItem>>& children() const { return m_children; }
+
+    /**
+     * @brief Whether two items display the same content
+     * @param other Item with the same kind and ID
+     * @return true if the row would not change
+     */
+    bool same_content(const AccountTreeItem& other) const {
+        if (m_kind == Kind::GROUP) {
+            return m_name == other.m_name && m_icon == other.m_icon;
+        }
+        return m_name == other.m_name && m_is_favorite == other.m_is_favorite;
+    }
+
+protected:
+    explicit AccountTreeItem(const keeptower::AccountGroup& group)
+        : m_kind(Kind::GROUP),
+          m_id(group.group_id()),
+          m_name(group.group_name()),
+          m_group_id(group.group_id()),
+          m_icon(group.icon()),
+          m_children(Gio::ListStore<AccountTreeItem>::create()) {}
+
+    AccountTreeItem(const std::string& account_id,
+                    const std::string& account_name,
+                    bool is_favorite,
+                    const std::string& group_id)
+        : m_kind(Kind::ACCOUNT),
+          m_id(account_id),
+          m_name(account_name),
+          m_group_id(group_id),
+          m_is_favorite(is_favorite) {}
+
+private:
+    Kind m_kind;
+    std::string m_id;
+    std::string m_name;
+    std::string m_group_id;
+    bool m_is_favorite = false;
+    std::string m_icon;
+    Glib::RefPtr<Gio::ListStore<AccountTreeItem>> m_children;
+};
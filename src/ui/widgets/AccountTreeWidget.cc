@@ -2,8 +2,165 @@
 #include "GroupRowWidget.h"
 #include "AccountRowWidget.h"
 #include "record.pb.h"
+#include "utils/helpers/FoldedSearch.h"
+#include <gtkmm/noselection.h>
+#include <gtkmm/treelistrow.h>
 #include <sigc++/signal.h>
 #include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::string_view FAVORITES_GROUP_ID = "favorites";
+constexpr std::string_view ALL_GROUP_ID = "all";
+
+using ItemStore = Gio::ListStore<AccountTreeItem>;
+
+/**
+ * @brief Bring a store in line with a wanted sequence using the fewest splices
+ *
+ * Walks the current and wanted sequences together. Items present in both
+ * in the same relative order are kept (or replaced in place when their
+ * content changed); everything else becomes a removal or insertion, and
+ * adjacent edits are merged into one splice. For the sorted, filtered lists
+ * the tree shows, a keystroke therefore costs one splice per run of rows
+ * that appeared or disappeared, not a rebuild.
+ *
+ * @param store Store to update
+ * @param wanted Entries in their new order
+ * @param key_of Unique ID of an entry
+ * @param same Whether a listed item already displays an entry
+ * @param make Create the item for an entry
+ */
+template <typename Entry, typename KeyOf, typename Same, typename Make>
+void sync_store(const Glib::RefPtr<ItemStore>& store,
+                const std::vector<Entry>& wanted,
+                KeyOf key_of,
+                Same same,
+                Make make) {
+    const guint old_count = store->get_n_items();
+    std::vector<Glib::RefPtr<AccountTreeItem>> old_items;
+    old_items.reserve(old_count);
+    std::unordered_set<std::string_view> old_ids;
+    old_ids.reserve(old_count);
+    for (guint i = 0; i < old_count; ++i) {
+        old_items.push_back(store->get_item(i));
+        old_ids.insert(old_items.back()->id());
+    }
+
+    std::unordered_set<std::string_view> wanted_ids;
+    wanted_ids.reserve(wanted.size());
+    for (const auto& entry : wanted) {
+        wanted_ids.insert(key_of(entry));
+    }
+
+    guint position = 0;
+    guint removals = 0;
+    std::vector<Glib::RefPtr<AccountTreeItem>> additions;
+    auto flush = [&]() {
+        if (removals != 0 || !additions.empty()) {
+            store->splice(position, removals, additions);
+            position += static_cast<guint>(additions.size());
+            removals = 0;
+            additions.clear();
+        }
+    };
+
+    size_t i = 0;
+    size_t j = 0;
+    while (i < old_items.size() || j < wanted.size()) {
+        if (i < old_items.size() && j < wanted.size() && old_items[i]->id() == key_of(wanted[j])) {
+            if (same(*old_items[i], wanted[j])) {
+                flush();
+                ++position;
+            } else {
+                ++removals;
+                additions.push_back(make(wanted[j]));
+            }
+            ++i;
+            ++j;
+        } else if (i < old_items.size() && !wanted_ids.contains(old_items[i]->id())) {
+            ++removals;
+            ++i;
+        } else if (j < wanted.size() && !old_ids.contains(key_of(wanted[j]))) {
+            additions.push_back(make(wanted[j]));
+            ++j;
+        } else if (i < old_items.size()) {
+            // Moved: drop it here and insert it where the new order wants it
+            old_ids.erase(old_items[i]->id());
+            ++removals;
+            ++i;
+        } else {
+            additions.push_back(make(wanted[j]));
+            ++j;
+        }
+    }
+    flush();
+}
+
+}  // namespace
+
+/**
+ * @class AccountTreeRow
+ * @brief Recyclable list row holding both row kinds
+ *
+ * The list view creates one per row on screen and rebinds it as the view
+ * scrolls; only the widget matching the bound item's kind is shown.
+ */
+class AccountTreeRow : public Gtk::Box {
+public:
+    AccountTreeRow()
+        : Gtk::Box(Gtk::Orientation::VERTICAL, 0)
+    {
+        set_hexpand(true);
+        // Matches the indentation accounts had inside an expanded group
+        m_account_row.set_margin_start(48);
+        append(m_group_row);
+        append(m_account_row);
+    }
+
+    void bind(const Glib::RefPtr<Gtk::TreeListRow>& tree_row,
+              const Glib::RefPtr<AccountTreeItem>& item) {
+        m_tree_row = tree_row;
+        m_item = item;
+        const bool is_group = item->kind() == AccountTreeItem::Kind::GROUP;
+        if (is_group) {
+            m_group_row.set_group(item->id(), item->name(), item->icon());
+        } else {
+            m_account_row.set_account(item->id(), item->name(), item->is_favorite());
+        }
+        m_group_row.set_visible(is_group);
+        m_account_row.set_visible(!is_group);
+    }
+
+    void unbind() {
+        m_tree_row.reset();
+        m_item.reset();
+    }
+
+    void refresh(const std::string& selected_account_id) {
+        if (!m_item) {
+            return;
+        }
+        if (m_item->kind() == AccountTreeItem::Kind::GROUP) {
+            m_group_row.set_expanded(m_tree_row && m_tree_row->get_expanded());
+        } else {
+            m_account_row.set_selected(m_item->id() == selected_account_id);
+        }
+    }
+
+    GroupRowWidget& group_row() { return m_group_row; }
+    AccountRowWidget& account_row() { return m_account_row; }
+    const Glib::RefPtr<AccountTreeItem>& item() const { return m_item; }
+
+private:
+    GroupRowWidget m_group_row;
+    AccountRowWidget m_account_row;
+    Glib::RefPtr<Gtk::TreeListRow> m_tree_row;
+    Glib::RefPtr<AccountTreeItem> m_item;
+};
 
 AccountTreeWidget::AccountTreeWidget()
     : Gtk::Box(Gtk::Orientation::VERTICAL, 0)
@@ -12,20 +169,43 @@ AccountTreeWidget::AccountTreeWidget()
     set_vexpand(true);
     set_hexpand(true);
 
-    // Configure ListBox for proper display
-    m_list_box.set_selection_mode(Gtk::SelectionMode::NONE);
-    m_list_box.set_show_separators(false);
-    m_list_box.add_css_class("navigation-sidebar");
+    // Groups expand into their account stores; accounts have no children
+    m_root_store = ItemStore::create();
+    m_tree_model = Gtk::TreeListModel::create(
+        m_root_store,
+        [](const Glib::RefPtr<Glib::ObjectBase>& object) -> Glib::RefPtr<Gio::ListModel> {
+            auto item = std::dynamic_pointer_cast<AccountTreeItem>(object);
+            if (!item || item->kind() != AccountTreeItem::Kind::GROUP) {
+                return {};
+            }
+            return item->children();
+        },
+        false,
+        true);
+
+    m_factory = Gtk::SignalListItemFactory::create();
+    m_factory->signal_setup().connect(sigc::mem_fun(*this, &AccountTreeWidget::on_setup_row));
+    m_factory->signal_bind().connect(sigc::mem_fun(*this, &AccountTreeWidget::on_bind_row));
+    m_factory->signal_unbind().connect(sigc::mem_fun(*this, &AccountTreeWidget::on_unbind_row));
+
+    // Configure ListView for proper display
+    m_list_view.set_model(Gtk::NoSelection::create(m_tree_model));
+    m_list_view.set_factory(m_factory);
+    m_list_view.set_show_separators(false);
+    m_list_view.add_css_class("navigation-sidebar");
 
     // Make ScrolledWindow expand to fill the parent
     m_scrolled_window.set_policy(Gtk::PolicyType::AUTOMATIC, Gtk::PolicyType::AUTOMATIC);
     m_scrolled_window.set_vexpand(true);
     m_scrolled_window.set_hexpand(true);
-    m_scrolled_window.set_child(m_list_box);
+    m_scrolled_window.set_child(m_list_view);
     append(m_scrolled_window);
 }
 
-AccountTreeWidget::~AccountTreeWidget() = default;
+AccountTreeWidget::~AccountTreeWidget() {
+    // Unbind the rows while the state unbinding touches is still alive
+    m_list_view.set_model({});
+}
 
 // Right-click signal accessors
 sigc::signal<void(std::string, Gtk::Widget*, double, double)>& AccountTreeWidget::signal_account_right_click() {
@@ -41,13 +221,19 @@ void AccountTreeWidget::set_data(const std::vector<keeptower::AccountGroup>& gro
     // Cache the data for filtering
     m_all_groups = groups;
     m_all_accounts = accounts;
-
-    // Apply current filters and rebuild
-    if (m_search_text.empty() && m_tag_filter.empty()) {
-        rebuild_rows(groups, accounts);
-    } else {
-        set_filters(m_search_text, m_tag_filter, m_field_filter);
+    m_membership_index.rebuild(m_all_groups, m_all_accounts);
+
+    // Reindex only the accounts whose searchable text changed
+    const auto slots = m_search_index.sync(m_all_accounts);
+    m_search_slot_accounts.assign(m_search_index.slot_count(), nullptr);
+    for (size_t i = 0; i < slots.size(); ++i) {
+        if (slots[i] != KeepTower::AccountSearchIndex::NO_SLOT) {
+            m_search_slot_accounts[slots[i]] = &m_all_accounts[i];
+        }
     }
+
+    // Apply current filters and update
+    rebuild_rows(filtered_accounts());
 }
 
 void AccountTreeWidget::set_data(const std::vector<KeepTower::GroupView>& groups,
@@ -122,8 +308,8 @@ void AccountTreeWidget::set_sort_direction(SortDirection direction) {
     if (m_sort_direction != direction) {
         m_sort_direction = direction;
         m_signal_sort_direction_changed.emit(direction);
-        // Rebuild with current data to apply new sort
-        rebuild_rows(m_all_groups, m_all_accounts);
+        // Update with current data to apply new sort
+        rebuild_rows(filtered_accounts());
     }
 }
 
@@ -137,321 +323,184 @@ void AccountTreeWidget::toggle_sort_direction() {
     set_sort_direction(new_direction);
 }
 
-void AccountTreeWidget::rebuild_rows(const std::vector<keeptower::AccountGroup>& groups,
-                                     const std::vector<keeptower::AccountRecord>& accounts) {
-    // Clear previous widgets (compatible with GTK 4.10+)
-    while (auto child = m_list_box.get_first_child()) {
-        m_list_box.remove(*child);
-    }
-    m_group_rows.clear();
-    m_account_rows.clear();
-
-    // Debug: Log total accounts and their group memberships
-    g_debug("AccountTreeWidget::rebuild_rows: %zu total accounts, %zu groups",
-            accounts.size(), groups.size());
-    for (size_t i = 0; i < accounts.size(); ++i) {
-        g_debug("  Account[%zu] '%s': %d group memberships",
-                i, accounts[i].account_name().c_str(), accounts[i].groups_size());
-        for (int j = 0; j < accounts[i].groups_size(); ++j) {
-            g_debug("    - Member of group_id: %s (display_order=%d)",
-                    accounts[i].groups(j).group_id().c_str(),
-                    accounts[i].groups(j).display_order());
+void AccountTreeWidget::rebuild_rows(const std::vector<const keeptower::AccountRecord*>& accounts) {
+    g_debug("AccountTreeWidget::rebuild_rows: %zu visible accounts, %zu groups",
+            accounts.size(), m_all_groups.size());
+
+    // Sort by name, then ID so equal names keep a stable order
+    const bool descending = m_sort_direction == SortDirection::DESCENDING;
+    auto sorted = [descending](std::vector<const keeptower::AccountRecord*> list) {
+        std::sort(list.begin(), list.end(),
+            [descending](const keeptower::AccountRecord* a, const keeptower::AccountRecord* b) {
+                if (a->account_name() != b->account_name()) {
+                    return descending ? a->account_name() > b->account_name()
+                                      : a->account_name() < b->account_name();
+                }
+                return descending ? a->id() > b->id() : a->id() < b->id();
+            });
+        return list;
+    };
+
+    // Sort once, then deal each account into the groups its membership
+    // bits name: every list comes out in order and the work is
+    // proportional to the rows produced
+    std::vector<const keeptower::AccountRecord*> ordered = sorted(accounts);
+    std::vector<const keeptower::AccountRecord*> favorites;
+    std::vector<std::vector<const keeptower::AccountRecord*>> members(m_membership_index.slot_count());
+    m_visible_account_ids.clear();
+    m_visible_account_ids.reserve(ordered.size());
+    for (const auto* account : ordered) {
+        m_visible_account_ids.insert(account->id());
+        if (account->is_favorite()) {
+            favorites.push_back(account);
         }
-    }
-    for (size_t i = 0; i < groups.size(); ++i) {
-        g_debug("  Group[%zu] id='%s' name='%s'",
-                i, groups[i].group_id().c_str(), groups[i].group_name().c_str());
+        const auto position = static_cast<uint32_t>(account - m_all_accounts.data());
+        m_membership_index.for_each_group(position, [&members, account](uint32_t slot) {
+            members[slot].push_back(account);
+        });
     }
 
-    // Create "Favorites" system group with favorited accounts
-    std::vector<size_t> favorite_indices;
-    for (size_t i = 0; i < accounts.size(); ++i) {
-        if (accounts[i].is_favorite()) {
-            favorite_indices.push_back(i);
-        }
-    }
+    // Groups in display order with the accounts each lists
+    struct GroupRows {
+        keeptower::AccountGroup group;
+        std::vector<const keeptower::AccountRecord*> accounts;
+    };
+    std::vector<GroupRows> wanted_groups;
+    wanted_groups.reserve(m_all_groups.size() + 2);
 
-    if (!favorite_indices.empty()) {
-        // Create a synthetic AccountGroup for favorites
+    // "Favorites" system group, only while something is favorited
+    if (!favorites.empty()) {
         keeptower::AccountGroup favorites_group;
-        favorites_group.set_group_id("favorites");
+        favorites_group.set_group_id(std::string(FAVORITES_GROUP_ID));
         favorites_group.set_group_name("⭐ Favorites");
         favorites_group.set_icon("starred-symbolic");
-
-        auto group_row = Gtk::make_managed<GroupRowWidget>();
-        group_row->set_group(favorites_group);
-        group_row->set_visible(true);
-        group_row->signal_selected().connect(
-            sigc::mem_fun(*this, &AccountTreeWidget::on_group_row_selected));
-        group_row->signal_right_clicked().connect(
-            [this](const std::string& group_id, Gtk::Widget* widget, double x, double y) {
-                m_signal_group_right_click.emit(group_id, widget, x, y);
-            });
-        group_row->signal_account_dropped().connect(
-            [this](const std::string& account_id, const std::string& group_id) {
-                m_signal_account_reordered.emit(account_id, group_id, 0);
-            });
-
-        // Wrap in ListBoxRow to control behavior
-        auto list_row = Gtk::make_managed<Gtk::ListBoxRow>();
-        list_row->set_activatable(false);
-        list_row->set_selectable(false);
-        list_row->set_child(*group_row);
-        m_list_box.append(*list_row);
-
-        m_group_rows.push_back(group_row);
-
-        // Sort favorites alphabetically based on sort direction
-        std::sort(favorite_indices.begin(), favorite_indices.end(),
-            [&accounts, direction = m_sort_direction](size_t a, size_t b) {
-                bool less_than = accounts[a].account_name() < accounts[b].account_name();
-                return (direction == SortDirection::ASCENDING) ? less_than : !less_than;
-            });
-
-        // Add favorite accounts as children of the group
-        for (size_t index : favorite_indices) {
-            auto account_row = Gtk::make_managed<AccountRowWidget>();
-            account_row->set_account(accounts[index]);
-            account_row->set_visible(true);
-            account_row->signal_selected().connect(
-                sigc::mem_fun(*this, &AccountTreeWidget::on_account_row_selected));
-            account_row->signal_right_clicked().connect(
-                [this](const std::string& account_id, Gtk::Widget* widget, double x, double y) {
-                    m_signal_account_right_click.emit(account_id, widget, x, y);
-                });
-            account_row->signal_favorite_toggled().connect(
-                [this](const std::string& account_id) {
-                    m_signal_favorite_toggled.emit(account_id);
-                });
-            group_row->add_child(*account_row);  // Add as child of group, not sibling
-            m_account_rows.push_back(account_row);
-        }
+        wanted_groups.push_back({std::move(favorites_group), std::move(favorites)});
     }
 
-    // Add user-created groups with their accounts
-    for (const auto& group : groups) {
-        // Skip system group (favorites)
-        if (group.group_id() == "favorites") {
+    // User-created groups, shown even when empty so new groups are visible
+    std::unordered_set<std::string_view> listed_groups;
+    for (const auto& group : m_all_groups) {
+        if (group.group_id() == FAVORITES_GROUP_ID || group.group_id() == ALL_GROUP_ID ||
+            !listed_groups.insert(group.group_id()).second) {
             continue;
         }
-
-
-        // Get accounts in this group
-        std::vector<size_t> group_account_indices;
-        for (size_t i = 0; i < accounts.size(); ++i) {
-            for (int j = 0; j < accounts[i].groups_size(); ++j) {
-                if (accounts[i].groups(j).group_id() == group.group_id()) {
-                    group_account_indices.push_back(i);
-                    // Debug: Log when we find an account in this group
-                    g_debug("AccountTreeWidget: Account '%s' (index %zu) is in group '%s'",
-                            accounts[i].account_name().c_str(), i, group.group_name().c_str());
-                    break;
-                }
-            }
-        }
-
-        // Debug: Log group membership count
-        g_debug("AccountTreeWidget: Group '%s' has %zu accounts",
-                group.group_name().c_str(), group_account_indices.size());
-
-        // Always show groups, even if empty, so users can see newly created groups
-        auto group_row = Gtk::make_managed<GroupRowWidget>();
-        group_row->set_group(group);
-        group_row->set_visible(true);
-        group_row->signal_selected().connect(
-            sigc::mem_fun(*this, &AccountTreeWidget::on_group_row_selected));
-        group_row->signal_right_clicked().connect(
-            [this](const std::string& group_id, Gtk::Widget* widget, double x, double y) {
-                m_signal_group_right_click.emit(group_id, widget, x, y);
-            });
-        group_row->signal_account_dropped().connect(
-            [this](const std::string& account_id, const std::string& group_id) {
-                m_signal_account_reordered.emit(account_id, group_id, 0);
-            });
-
-        // Wrap in ListBoxRow to control behavior
-        auto list_row = Gtk::make_managed<Gtk::ListBoxRow>();
-        list_row->set_activatable(false);
-        list_row->set_selectable(false);
-        list_row->set_child(*group_row);
-        m_list_box.append(*list_row);
-
-        m_group_rows.push_back(group_row);
-
-        // Sort accounts alphabetically based on sort direction
-        std::sort(group_account_indices.begin(), group_account_indices.end(),
-            [&accounts, direction = m_sort_direction](size_t a, size_t b) {
-                bool less_than = accounts[a].account_name() < accounts[b].account_name();
-                return (direction == SortDirection::ASCENDING) ? less_than : !less_than;
-            });
-
-        // Add accounts as children of this group
-        for (size_t index : group_account_indices) {
-
-            auto account_row = Gtk::make_managed<AccountRowWidget>();
-            account_row->set_account(accounts[index]);
-            account_row->set_visible(true);
-            account_row->signal_selected().connect(
-                sigc::mem_fun(*this, &AccountTreeWidget::on_account_row_selected));
-            account_row->signal_right_clicked().connect(
-                [this](const std::string& account_id, Gtk::Widget* widget, double x, double y) {
-                    m_signal_account_right_click.emit(account_id, widget, x, y);
-                });
-            account_row->signal_favorite_toggled().connect(
-                [this](const std::string& account_id) {
-                    m_signal_favorite_toggled.emit(account_id);
-                });
-            account_row->signal_account_dropped_on_account().connect(
-                [this, group_id = group.group_id()](const std::string& dragged_id, const std::string& /* target_id */) {
-                    // Accounts are sorted alphabetically, so just emit with index 0
-                    // The actual position doesn't matter since rebuild will re-sort
-                    m_signal_account_reordered.emit(dragged_id, group_id, 0);
-                });
-            group_row->add_child(*account_row);  // Add as child of group, not sibling
-            m_account_rows.push_back(account_row);
-        }
+        const uint32_t slot = m_membership_index.slot_of(group.group_id());
+        wanted_groups.push_back({group, slot != KeepTower::GroupMembershipIndex::NO_SLOT
+                                            ? std::move(members[slot])
+                                            : std::vector<const keeptower::AccountRecord*>{}});
     }
 
-    // Create "All Accounts" system group - TEMPORARILY SHOW ALL to debug
-    // Create a synthetic AccountGroup for all accounts
+    // "All Accounts" system group
     keeptower::AccountGroup all_group;
-    all_group.set_group_id("all");
+    all_group.set_group_id(std::string(ALL_GROUP_ID));
     all_group.set_group_name("All Accounts");
     all_group.set_icon("folder-symbolic");
+    wanted_groups.push_back({std::move(all_group), std::move(ordered)});
 
-    auto all_group_row = Gtk::make_managed<GroupRowWidget>();
-    all_group_row->set_group(all_group);
-    all_group_row->set_visible(true);
-    all_group_row->signal_selected().connect(
-        sigc::mem_fun(*this, &AccountTreeWidget::on_group_row_selected));
-    all_group_row->signal_right_clicked().connect(
-        [this](const std::string& group_id, Gtk::Widget* widget, double x, double y) {
-            m_signal_group_right_click.emit(group_id, widget, x, y);
-        });
-    all_group_row->signal_account_dropped().connect(
-        [this](const std::string& account_id, [[maybe_unused]] const std::string& group_id) {
-            // Dropping into 'All Accounts' means remove from any specific group
-            // The account stays in the vault and remains visible in All Accounts
-            // Emit with empty string to indicate "remove from current group"
-            m_signal_account_reordered.emit(account_id, "", 0);
-        });
-
-    // Wrap in ListBoxRow to control behavior
-    auto all_list_row = Gtk::make_managed<Gtk::ListBoxRow>();
-    all_list_row->set_activatable(false);
-    all_list_row->set_selectable(false);
-    all_list_row->set_child(*all_group_row);
-    m_list_box.append(*all_list_row);
-
-    m_group_rows.push_back(all_group_row);
-
-    // Temporarily show ALL accounts here to debug
-    std::vector<size_t> all_indices;
-    for (size_t i = 0; i < accounts.size(); ++i) {
-        all_indices.push_back(i);
+    // Reuse group items that still match so their rows and expansion persist
+    std::unordered_map<std::string, Glib::RefPtr<AccountTreeItem>> existing_groups;
+    for (guint i = 0; i < m_root_store->get_n_items(); ++i) {
+        auto item = m_root_store->get_item(i);
+        existing_groups.emplace(item->id(), item);
     }
 
-    // Sort all accounts alphabetically based on sort direction
-    std::sort(all_indices.begin(), all_indices.end(),
-        [&accounts, direction = m_sort_direction](size_t a, size_t b) {
-            bool less_than = accounts[a].account_name() < accounts[b].account_name();
-            return (direction == SortDirection::ASCENDING) ? less_than : !less_than;
-        });
-
-    // Add all accounts as children of the group
-    for (size_t index : all_indices) {
-        auto account_row = Gtk::make_managed<AccountRowWidget>();
-        account_row->set_account(accounts[index]);
-        account_row->set_visible(true);
-        account_row->signal_selected().connect(
-            sigc::mem_fun(*this, &AccountTreeWidget::on_account_row_selected));
-        account_row->signal_right_clicked().connect(
-            [this](const std::string& account_id, Gtk::Widget* widget, double x, double y) {
-                m_signal_account_right_click.emit(account_id, widget, x, y);
-            });
-        account_row->signal_favorite_toggled().connect(
-            [this](const std::string& account_id) {
-                m_signal_favorite_toggled.emit(account_id);
-            });
-        account_row->signal_account_dropped_on_account().connect(
-            [this](const std::string& dragged_id, const std::string& /* target_id */) {
-                // In 'All Accounts', just emit to remove from all groups
-                // Don't calculate index since accounts are sorted alphabetically
-                m_signal_account_reordered.emit(dragged_id, "", 0);
+    std::vector<Glib::RefPtr<AccountTreeItem>> group_items;
+    group_items.reserve(wanted_groups.size());
+    for (auto& wanted : wanted_groups) {
+        auto candidate = AccountTreeItem::create_group(wanted.group);
+        auto it = existing_groups.find(wanted.group.group_id());
+        auto item = (it != existing_groups.end() && it->second->same_content(*candidate)) ? it->second : candidate;
+
+        // Accounts first, so a reused group updates in place
+        const std::string& group_id = item->id();
+        sync_store(item->children(), wanted.accounts,
+            [](const keeptower::AccountRecord* account) -> std::string_view { return account->id(); },
+            [](const AccountTreeItem& listed, const keeptower::AccountRecord* account) {
+                return listed.name() == account->account_name() && listed.is_favorite() == account->is_favorite();
+            },
+            [&group_id](const keeptower::AccountRecord* account) {
+                return AccountTreeItem::create_account(account->id(), account->account_name(),
+                                                       account->is_favorite(), group_id);
             });
-        all_group_row->add_child(*account_row);  // Add as child of group, not sibling
-        m_account_rows.push_back(account_row);
+        group_items.push_back(std::move(item));
     }
-}
 
-void AccountTreeWidget::on_account_row_selected(const std::string& account_id) {
-    m_signal_account_selected.emit(account_id);
-}
+    sync_store(m_root_store, group_items,
+        [](const Glib::RefPtr<AccountTreeItem>& item) -> std::string_view { return item->id(); },
+        [](const AccountTreeItem& listed, const Glib::RefPtr<AccountTreeItem>& item) { return &listed == item.get(); },
+        [](const Glib::RefPtr<AccountTreeItem>& item) { return item; });
+
+    // New group rows autoexpand; collapse the ones the user collapsed
+    if (!m_collapsed_groups.empty()) {
+        for (guint i = 0; i < m_root_store->get_n_items(); ++i) {
+            if (m_collapsed_groups.contains(m_root_store->get_item(i)->id())) {
+                if (auto row = m_tree_model->get_child_row(i)) {
+                    row->set_expanded(false);
+                }
+            }
+        }
+    }
 
-void AccountTreeWidget::on_group_row_selected(const std::string& group_id) {
-    m_signal_group_selected.emit(group_id);
+    refresh_bound_rows();
 }
 
-void AccountTreeWidget::set_filters(const std::string& search_text, const std::string& tag_filter, int field_filter) {
-    m_search_text = search_text;
-    m_tag_filter = tag_filter;
-    m_field_filter = field_filter;
+std::vector<const keeptower::AccountRecord*> AccountTreeWidget::filtered_accounts() const {
+    std::vector<const keeptower::AccountRecord*> filtered;
+    filtered.reserve(m_all_accounts.size());
 
     // If no filters active, show all accounts
-    if (search_text.empty() && tag_filter.empty()) {
-        rebuild_rows(m_all_groups, m_all_accounts);
-        return;
+    if (m_search_text.empty() && m_tag_filter.empty()) {
+        for (const auto& account : m_all_accounts) {
+            filtered.push_back(&account);
+        }
+        return filtered;
     }
 
-    // Filter accounts based on search text and tag
-    std::vector<keeptower::AccountRecord> filtered_accounts;
+    // Fold the search text once; fields are compared in place
+    const KeepTower::FoldedNeedle needle(m_search_text);
 
-    for (const auto& account : m_all_accounts) {
+    // Helper to check if a field matches the search text
+    auto check_field = [&needle](const std::string& field_value) {
+        return needle.found_in(field_value);
+    };
+
+    auto check_tags = [&](const keeptower::AccountRecord& account) {
+        for (int i = 0; i < account.tags_size(); ++i) {
+            if (check_field(account.tags(i))) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    auto passes = [&](const keeptower::AccountRecord& account) {
         // Check tag filter first
-        bool tag_match = tag_filter.empty();
-        if (!tag_filter.empty()) {
+        bool tag_match = m_tag_filter.empty();
+        if (!m_tag_filter.empty()) {
             for (int i = 0; i < account.tags_size(); ++i) {
-                if (account.tags(i) == tag_filter) {
+                if (account.tags(i) == m_tag_filter) {
                     tag_match = true;
                     break;
                 }
             }
         }
 
-        if (!tag_match) continue;
+        if (!tag_match) return false;
 
         // Check search text filter
-        if (!search_text.empty()) {
-            std::string search_lower = search_text;
-            std::transform(search_lower.begin(), search_lower.end(), search_lower.begin(), ::tolower);
-
+        if (!m_search_text.empty()) {
             bool text_match = false;
 
-            // Helper to check if a field matches the search text
-            auto check_field = [&](const std::string& field_value) {
-                std::string field_lower = field_value;
-                std::transform(field_lower.begin(), field_lower.end(), field_lower.begin(), ::tolower);
-                return field_lower.find(search_lower) != std::string::npos;
-            };
-
             // Check based on field_filter
             // 0=All, 1=Account Name, 2=Username, 3=Email, 4=Website, 5=Notes, 6=Tags
-            switch (field_filter) {
+            switch (m_field_filter) {
                 case 0: // All fields
                     text_match = check_field(account.account_name()) ||
                                 check_field(account.user_name()) ||
                                 check_field(account.email()) ||
                                 check_field(account.website()) ||
-                                check_field(account.notes());
-                    // Check tags
-                    if (!text_match) {
-                        for (int i = 0; i < account.tags_size(); ++i) {
-                            if (check_field(account.tags(i))) {
-                                text_match = true;
-                                break;
-                            }
-                        }
-                    }
+                                check_field(account.notes()) ||
+                                check_tags(account);
                     break;
                 case 1: // Account Name
                     text_match = check_field(account.account_name());
@@ -469,52 +518,186 @@ void AccountTreeWidget::set_filters(const std::string& search_text, const std::s
                     text_match = check_field(account.notes());
                     break;
                 case 6: // Tags
-                    for (int i = 0; i < account.tags_size(); ++i) {
-                        if (check_field(account.tags(i))) {
-                            text_match = true;
-                            break;
-                        }
-                    }
+                    text_match = check_tags(account);
                     break;
             }
 
-            if (!text_match) continue;
+            if (!text_match) return false;
         }
 
         // Account passed all filters
-        filtered_accounts.push_back(account);
+        return true;
+    };
+
+    // Only accounts with every trigram of the search text can contain it
+    if (!m_search_text.empty() && m_search_index.size() == m_all_accounts.size()) {
+        static constexpr uint8_t index_fields[] = {
+            KeepTower::AccountSearchIndex::ALL_FIELDS, KeepTower::AccountSearchIndex::ACCOUNT_NAME,
+            KeepTower::AccountSearchIndex::USER_NAME, KeepTower::AccountSearchIndex::EMAIL,
+            KeepTower::AccountSearchIndex::WEBSITE, KeepTower::AccountSearchIndex::NOTES,
+            KeepTower::AccountSearchIndex::TAGS};
+        const uint8_t fields = (m_field_filter >= 0 && m_field_filter < static_cast<int>(std::size(index_fields)))
+            ? index_fields[m_field_filter] : uint8_t{KeepTower::AccountSearchIndex::ALL_FIELDS};
+        for (const uint32_t slot : m_search_index.candidates(m_search_text, fields)) {
+            const auto* account = m_search_slot_accounts[slot];
+            if (account && passes(*account)) {
+                filtered.push_back(account);
+            }
+        }
+        return filtered;
+    }
+
+    for (const auto& account : m_all_accounts) {
+        if (passes(account)) {
+            filtered.push_back(&account);
+        }
+    }
+
+    return filtered;
+}
+
+void AccountTreeWidget::on_setup_row(const Glib::RefPtr<Gtk::ListItem>& list_item) {
+    auto* row = Gtk::make_managed<AccountTreeRow>();
+    list_item->set_activatable(false);
+    list_item->set_selectable(false);
+    list_item->set_child(*row);
+
+    // Connected once per recycled row; handlers read the item bound at the time
+    auto& group_row = row->group_row();
+    group_row.signal_selected().connect(
+        sigc::mem_fun(*this, &AccountTreeWidget::on_group_row_selected));
+    group_row.signal_expanded_changed().connect(
+        sigc::mem_fun(*this, &AccountTreeWidget::on_group_expanded_changed));
+    group_row.signal_right_clicked().connect(
+        [this](const std::string& group_id, Gtk::Widget* widget, double x, double y) {
+            m_signal_group_right_click.emit(group_id, widget, x, y);
+        });
+    group_row.signal_account_dropped().connect(
+        [this](const std::string& account_id, const std::string& group_id) {
+            // Dropping into 'All Accounts' means remove from any specific group
+            // Emit with empty string to indicate "remove from current group"
+            m_signal_account_reordered.emit(account_id, group_id == ALL_GROUP_ID ? "" : group_id, 0);
+        });
+
+    auto& account_row = row->account_row();
+    account_row.signal_selected().connect(
+        sigc::mem_fun(*this, &AccountTreeWidget::on_account_row_selected));
+    account_row.signal_right_clicked().connect(
+        [this](const std::string& account_id, Gtk::Widget* widget, double x, double y) {
+            m_signal_account_right_click.emit(account_id, widget, x, y);
+        });
+    account_row.signal_favorite_toggled().connect(
+        [this](const std::string& account_id) {
+            m_signal_favorite_toggled.emit(account_id);
+        });
+    account_row.signal_account_dropped_on_account().connect(
+        [this, row](const std::string& dragged_id, const std::string& /* target_id */) {
+            const auto& item = row->item();
+            if (!item || item->group_id() == FAVORITES_GROUP_ID) {
+                return;
+            }
+            // Accounts are sorted alphabetically, so just emit with index 0
+            // In 'All Accounts' the empty group removes it from its groups
+            m_signal_account_reordered.emit(dragged_id, item->group_id() == ALL_GROUP_ID ? "" : item->group_id(), 0);
+        });
+}
+
+void AccountTreeWidget::on_bind_row(const Glib::RefPtr<Gtk::ListItem>& list_item) {
+    auto* row = dynamic_cast<AccountTreeRow*>(list_item->get_child());
+    auto tree_row = std::dynamic_pointer_cast<Gtk::TreeListRow>(list_item->get_item());
+    if (!row || !tree_row) {
+        return;
+    }
+    auto item = std::dynamic_pointer_cast<AccountTreeItem>(tree_row->get_item());
+    if (!item) {
+        return;
+    }
+
+    row->bind(tree_row, item);
+    row->refresh(m_selected_account_id);
+    m_bound_rows.insert(row);
+}
+
+void AccountTreeWidget::on_unbind_row(const Glib::RefPtr<Gtk::ListItem>& list_item) {
+    if (auto* row = dynamic_cast<AccountTreeRow*>(list_item->get_child())) {
+        row->unbind();
+        m_bound_rows.erase(row);
+    }
+}
+
+void AccountTreeWidget::refresh_bound_rows() {
+    for (auto* row : m_bound_rows) {
+        row->refresh(m_selected_account_id);
+    }
+}
+
+void AccountTreeWidget::on_account_row_selected(const std::string& account_id) {
+    m_signal_account_selected.emit(account_id);
+}
+
+void AccountTreeWidget::on_group_row_selected(const std::string& group_id) {
+    m_signal_group_selected.emit(group_id);
+}
+
+void AccountTreeWidget::on_group_expanded_changed(const std::string& group_id, bool expanded) {
+    if (expanded) {
+        m_collapsed_groups.erase(group_id);
+    } else {
+        m_collapsed_groups.insert(group_id);
     }
 
-    // Rebuild with filtered accounts
-    rebuild_rows(m_all_groups, filtered_accounts);
+    for (guint i = 0; i < m_root_store->get_n_items(); ++i) {
+        if (m_root_store->get_item(i)->id() == group_id) {
+            if (auto row = m_tree_model->get_child_row(i)) {
+                row->set_expanded(expanded);
+            }
+            return;
+        }
+    }
+}
+
+void AccountTreeWidget::set_filters(const std::string& search_text, const std::string& tag_filter, int field_filter) {
+    m_search_text = search_text;
+    m_tag_filter = tag_filter;
+    m_field_filter = field_filter;
+
+    rebuild_rows(filtered_accounts());
 }
 
 void AccountTreeWidget::clear_filters() {
     m_search_text.clear();
     m_tag_filter.clear();
     m_field_filter = 0;
-    rebuild_rows(m_all_groups, m_all_accounts);
+    rebuild_rows(filtered_accounts());
 }
 
-void AccountTreeWidget::select_account_by_id(const std::string& account_id) {
-    // Safety check: ensure account rows vector is not empty
-    if (m_account_rows.empty()) {
-        g_warning("AccountTreeWidget::select_account_by_id: No account rows available");
-        return;
-    }
+Glib::RefPtr<Gio::ListModel> AccountTreeWidget::get_model() const {
+    return m_tree_model;
+}
 
-    bool found = false;
+std::vector<std::string> AccountTreeWidget::displayed_group_ids() const {
+    std::vector<std::string> ids;
+    for (guint i = 0; i < m_root_store->get_n_items(); ++i) {
+        ids.push_back(m_root_store->get_item(i)->id());
+    }
+    return ids;
+}
 
-    // Verify that the requested account exists in the current view before
-    // emitting selection. Signal handlers can synchronously rebuild rows.
-    for (auto* account_row : m_account_rows) {
-        if (account_row && account_row->account_id() == account_id) {
-            found = true;
-            break;
+std::vector<std::string> AccountTreeWidget::displayed_account_ids() const {
+    std::vector<std::string> ids;
+    for (guint i = 0; i < m_root_store->get_n_items(); ++i) {
+        const auto& children = m_root_store->get_item(i)->children();
+        for (guint j = 0; j < children->get_n_items(); ++j) {
+            ids.push_back(children->get_item(j)->id());
         }
     }
+    return ids;
+}
 
-    if (!found) {
+void AccountTreeWidget::select_account_by_id(const std::string& account_id) {
+    // Verify that the requested account exists in the current view before
+    // emitting selection. Signal handlers can synchronously update the rows.
+    if (!m_visible_account_ids.contains(account_id)) {
         // Account not found in current view (might be filtered out)
         g_debug("AccountTreeWidget::select_account_by_id: Account '%s' not found in current view",
                 account_id.c_str());
@@ -522,17 +705,16 @@ void AccountTreeWidget::select_account_by_id(const std::string& account_id) {
     }
 
     // Trigger the selection signal which will propagate to MainWindow.
-    // This may rebuild the widget tree, so do not retain row pointers across it.
     on_account_row_selected(account_id);
 
-    // Re-resolve the row after signal delivery before updating visual state.
-    for (auto* account_row : m_account_rows) {
-        if (account_row && account_row->account_id() == account_id) {
-            account_row->set_selected(true);
-            return;
-        }
+    // Re-check after signal delivery before updating visual state.
+    if (!m_visible_account_ids.contains(account_id)) {
+        g_debug("AccountTreeWidget::select_account_by_id: Account '%s' no longer present after selection callback",
+                account_id.c_str());
+        return;
     }
 
-    g_debug("AccountTreeWidget::select_account_by_id: Account '%s' no longer present after selection callback",
-            account_id.c_str());
+    // Rows scrolled into view later pick this up when bound
+    m_selected_account_id = account_id;
+    refresh_bound_rows();
 }
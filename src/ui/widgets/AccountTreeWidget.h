@@ -15,18 +15,28 @@
 
 #pragma once
 #include <sigc++/sigc++.h>
+#include <giomm/liststore.h>
 #include <gtkmm/box.h>
-#include <gtkmm/listbox.h>
-#include <gtkmm/listboxrow.h>
+#include <gtkmm/listitem.h>
+#include <gtkmm/listview.h>
 #include <gtkmm/scrolledwindow.h>
+#include <gtkmm/signallistitemfactory.h>
+#include <gtkmm/treelistmodel.h>
+#include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
+#include "AccountTreeItem.h"
 #include "GroupRowWidget.h"
 #include "AccountRowWidget.h"
 #include "core/VaultBoundaryTypes.h"
+#include "core/managers/AccountSearchIndex.h"
+#include "core/managers/GroupMembershipIndex.h"
 #include "record.pb.h"
 
+class AccountTreeRow;
+
 /**
  * @brief Sort direction for account/group display
  */
@@ -42,6 +52,13 @@ enum class SortDirection {
  * Main tree widget that orchestrates the display of all accounts and groups.
  * Manages filtering, sorting, drag-and-drop, and event propagation.
  *
+ * Rows live in a Gtk::TreeListModel over a Gio::ListStore of AccountTreeItem
+ * groups, each holding a store of its accounts, shown by a Gtk::ListView.
+ * The view only creates widgets for rows on screen and recycles them while
+ * scrolling. Data, filter and sort changes are applied as a diff against the
+ * current stores, so rows that stay keep their model objects and only
+ * inserted, removed or changed rows are touched.
+ *
  * @section account_tree_widget_features Features
  * - Group-based hierarchical organization
  * - Real-time search filtering (name, username, email, website, tags)
@@ -142,14 +159,44 @@ public:
      */
     void select_account_by_id(const std::string& account_id);
 
+    /**
+     * @brief Flattened rows as shown (Gtk::TreeListRow items)
+     * @return Model of the expanded tree
+     */
+    Glib::RefPtr<Gio::ListModel> get_model() const;
+
+    /**
+     * @brief IDs of the listed groups, in display order
+     * @return Group IDs, including the synthetic "favorites" and "all" groups
+     */
+    std::vector<std::string> displayed_group_ids() const;
+
+    /**
+     * @brief IDs of the listed accounts, group by group in display order
+     * @return Account IDs (an account appears once per group it is listed in),
+     *         whether or not its group is expanded
+     */
+    std::vector<std::string> displayed_account_ids() const;
+
 private:
+    // Row model: groups at the top level, each owning its account store
+    Glib::RefPtr<Gio::ListStore<AccountTreeItem>> m_root_store;
+    Glib::RefPtr<Gtk::TreeListModel> m_tree_model;
+    Glib::RefPtr<Gtk::SignalListItemFactory> m_factory;
+
+    // Rows currently bound to an item (only those near the viewport)
+    std::unordered_set<AccountTreeRow*> m_bound_rows;
+
+    // Accounts present in the current view, for select_account_by_id()
+    std::unordered_set<std::string> m_visible_account_ids;
+
+    // View state that survives updates
+    std::set<std::string> m_collapsed_groups;
+    std::string m_selected_account_id;
+
     // Internal widgets
     Gtk::ScrolledWindow m_scrolled_window;
-    Gtk::ListBox m_list_box; // ListBox for group/account rows
-
-    // Store row widgets for lookup
-    std::vector<GroupRowWidget*> m_group_rows;
-    std::vector<AccountRowWidget*> m_account_rows;
+    Gtk::ListView m_list_view;
 
     // Filter state
     std::string m_search_text;
@@ -162,14 +209,28 @@ private:
     // Cached data for filtering
     std::vector<keeptower::AccountGroup> m_all_groups;
     std::vector<keeptower::AccountRecord> m_all_accounts;
+    KeepTower::GroupMembershipIndex m_membership_index;  // Over m_all_groups/m_all_accounts
+    KeepTower::AccountSearchIndex m_search_index;        // Trigrams of m_all_accounts
+    std::vector<const keeptower::AccountRecord*> m_search_slot_accounts;  // Search index slot -> account
+
+    // Internal: bring the row model in line with the given accounts
+    void rebuild_rows(const std::vector<const keeptower::AccountRecord*>& accounts);
+
+    // Internal: accounts passing the current filters
+    std::vector<const keeptower::AccountRecord*> filtered_accounts() const;
+
+    // Internal: list item factory callbacks
+    void on_setup_row(const Glib::RefPtr<Gtk::ListItem>& list_item);
+    void on_bind_row(const Glib::RefPtr<Gtk::ListItem>& list_item);
+    void on_unbind_row(const Glib::RefPtr<Gtk::ListItem>& list_item);
 
-    // Internal: clear and rebuild rows
-    void rebuild_rows(const std::vector<keeptower::AccountGroup>& groups,
-                     const std::vector<keeptower::AccountRecord>& accounts);
+    // Internal: re-apply expansion and selection to the rows on screen
+    void refresh_bound_rows();
 
-    // Internal: handle row selection
+    // Internal: handle row selection and expansion
     void on_account_row_selected(const std::string& account_id);
     void on_group_row_selected(const std::string& group_id);
+    void on_group_expanded_changed(const std::string& group_id, bool expanded);
 
     // Signals
     sigc::signal<void(std::string, Gtk::Widget*, double, double)> m_signal_account_right_click;
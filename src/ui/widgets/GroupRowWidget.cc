@@ -71,11 +71,15 @@ GroupRowWidget::GroupRowWidget()
 GroupRowWidget::~GroupRowWidget() = default;
 
 void GroupRowWidget::set_group(const keeptower::AccountGroup& group) {
-    m_group_id = group.group_id();
-    m_label.set_text(group.group_name());
+    set_group(group.group_id(), group.group_name(), group.icon());
+}
+
+void GroupRowWidget::set_group(const std::string& group_id, const std::string& group_name, const std::string& icon) {
+    m_group_id = group_id;
+    m_label.set_text(group_name);
     // Set icon if available, else fallback
-    if (!group.icon().empty()) {
-        m_icon.set_from_icon_name(group.icon());
+    if (!icon.empty()) {
+        m_icon.set_from_icon_name(icon);
     } else {
         m_icon.set_from_icon_name("folder-symbolic");
     }
@@ -139,6 +143,10 @@ sigc::signal<void(std::string, std::string)>& GroupRowWidget::signal_account_dro
     return m_signal_account_dropped;
 }
 
+sigc::signal<void(std::string, bool)>& GroupRowWidget::signal_expanded_changed() {
+    return m_signal_expanded_changed;
+}
+
 sigc::signal<void(std::string, Gtk::Widget*, double, double)>& GroupRowWidget::signal_right_clicked() {
     return m_signal_right_clicked;
 }
@@ -150,22 +158,12 @@ void GroupRowWidget::on_header_clicked([[maybe_unused]] int n_press,
     // Selection should only happen on double-click or via another mechanism
     g_debug("GroupRowWidget::on_header_clicked - group '%s', current expanded=%d",
             m_group_id.c_str(), m_expanded);
-    g_debug("  Widget visible=%d, parent=%p", get_visible(), static_cast<void*>(get_parent()));
 
     set_expanded(!m_expanded);
     g_debug("  After toggle: expanded=%d", m_expanded);
-    g_debug("  Widget still visible=%d", get_visible());
-
-    // Force parent to recalculate layout - walk up the widget tree
-    auto widget = static_cast<Gtk::Widget*>(this);
-    int depth = 0;
-    while (widget && depth < 5) {  // Limit to 5 levels
-        g_debug("  Requesting resize for widget %s (visible=%d)",
-                G_OBJECT_TYPE_NAME(widget->gobj()), widget->get_visible());
-        widget->queue_resize();
-        widget = widget->get_parent();
-        depth++;
-    }
+
+    // Children are separate rows of the owning list; let it show or hide them
+    m_signal_expanded_changed.emit(m_group_id, m_expanded);
 
     // DO NOT emit selection signal here - that triggers rebuild
     // m_signal_selected.emit(m_group_id);
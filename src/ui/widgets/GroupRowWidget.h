@@ -51,6 +51,14 @@ public:
      */
     void set_group(const keeptower::AccountGroup& group);
 
+    /**
+     * @brief Set the fields the row displays
+     * @param group_id Group unique identifier
+     * @param group_name Name to show
+     * @param icon Icon name (empty for the default folder icon)
+     */
+    void set_group(const std::string& group_id, const std::string& group_name, const std::string& icon);
+
     /**
      * @brief Get current group ID
      * @return Group unique identifier
@@ -102,6 +110,12 @@ public:
      */
     sigc::signal<void(std::string, std::string)>& signal_account_dropped();
 
+    /**
+     * @brief Signal emitted when the user expands or collapses the group
+     * @return Signal with (group_id, expanded) parameters
+     */
+    sigc::signal<void(std::string, bool)>& signal_expanded_changed();
+
     /** @brief Signal emitted when group is right-clicked
      *  @return Signal with (group_id, widget, x, y) parameters for context menu */
     sigc::signal<void(std::string, Gtk::Widget*, double, double)>& signal_right_clicked();
@@ -133,6 +147,7 @@ private:
     sigc::signal<void(std::string)> m_signal_selected;
     sigc::signal<void(std::string, int)> m_signal_reordered;
     sigc::signal<void(std::string, std::string)> m_signal_account_dropped;
+    sigc::signal<void(std::string, bool)> m_signal_expanded_changed;
     sigc::signal<void(std::string, Gtk::Widget*, double, double)> m_signal_right_clicked;
 
     // Helpers
@@ -69,6 +69,37 @@ MainWindow::MainWindow()
     int rs_redundancy = settings->get_int("rs-redundancy-percent");
     m_vault_manager->apply_default_fec_preferences(use_rs, rs_redundancy);
 
+    // Journaled saves append delta records instead of rewriting the vault
+    m_vault_manager->set_journal_enabled(settings->get_boolean("journaled-saves"));
+
+    // Compress the serialized vault ahead of encryption on full saves
+    m_vault_manager->set_payload_compression(settings->get_boolean("compress-vault-payload"));
+
+    // Coalesce structural edits (groups, reordering) into background saves
+    m_vault_manager->set_save_coalesce_window(
+        std::chrono::milliseconds(settings->get_int("save-coalesce-ms")));
+
+    // Durability of full vault writes (process-wide)
+    if (const auto policy = KeepTower::VaultFileService::parse_sync_policy(
+            settings->get_string("save-sync-policy").raw())) {
+        KeepTower::VaultFileService::set_sync_policy(*policy);
+    }
+
+    // The account list is built from the vault index at unlock; refresh it
+    // once the remaining account fields (notes etc.) have been decrypted
+    m_vault_manager->set_account_details_loaded_callback([this]() {
+        update_account_list();
+        filter_accounts(m_search_entry.get_text());
+    });
+
+    // Coalesced saves fail in the background; the vault stays marked modified,
+    // so closing prompts to save and an explicit save retries the write
+    m_vault_manager->set_save_failed_callback([this]() {
+        m_status_label.set_text("Recent changes could not be saved");
+        show_error_dialog("Failed to save recent changes to the vault.\n\n"
+                          "The changes are still open in KeepTower. Save the vault to try again.");
+    });
+
     // Load backup settings and apply to VaultManager
     const SettingsValidator::BackupPreferences backup_prefs =
         SettingsValidator::get_backup_preferences(settings);
@@ -80,6 +111,9 @@ MainWindow::MainWindow()
     if (!m_vault_manager->apply_backup_settings(backup_settings)) {
         KeepTower::Log::warning("MainWindow: Invalid backup settings in preferences; using policy defaults");
     }
+    if (!m_vault_manager->set_backup_store(settings->get_string("backup-store").raw())) {
+        KeepTower::Log::warning("MainWindow: Unknown backup store in preferences; keeping full copies");
+    }
 
     // Setup undo/redo state change callback
     m_undo_manager.set_state_changed_callback([this](bool can_undo, bool can_redo) {
@@ -1443,11 +1477,8 @@ void MainWindow::on_delete_group(const std::string& group_id) {
 // Helper methods for widget-based UI
 int MainWindow::find_account_index_by_id(const std::string& account_id) const {
     if (!m_vault_manager) return -1;
-    const auto accounts = m_vault_manager->get_all_accounts_view();
-    for (size_t i = 0; i < accounts.size(); ++i) {
-        if (accounts[i].id == account_id) return static_cast<int>(i);
-    }
-    return -1;
+    const auto index = m_vault_manager->find_account_index(account_id);
+    return index ? static_cast<int>(*index) : -1;
 }
 
 void MainWindow::filter_accounts_by_group(const std::string& group_id) {
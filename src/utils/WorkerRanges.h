@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file WorkerRanges.h
+ * @brief Split independent work units across short-lived worker threads
+ *
+ * Shared by the segmented cipher, the FEC codecs and vault verification.
+ * Running out of threads (std::system_error from std::thread) is not an
+ * error: whatever was not handed to a worker runs on the calling thread.
+ */
+
+#ifndef KEEPTOWER_WORKER_RANGES_H
+#define KEEPTOWER_WORKER_RANGES_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace KeepTower {
+
+/**
+ * @brief Threads worth starting for a job
+ * @param max_threads Caller's cap (0 = hardware concurrency)
+ * @param units Independent work units (segments, groups, windows, files)
+ * @param work Total work in the caller's measure (bytes, codewords)
+ * @param min_work_per_thread Work below which another thread costs more than it saves
+ * @return Between 1 and units
+ */
+inline size_t worker_count(unsigned max_threads, size_t units, size_t work, size_t min_work_per_thread) {
+    const size_t threads = max_threads != 0 ? max_threads : std::max(1u, std::thread::hardware_concurrency());
+    return std::clamp<size_t>(work / min_work_per_thread, 1, std::max<size_t>(1, std::min(threads, units)));
+}
+
+/**
+ * @brief Run fn(first, last) over [0, units) split into contiguous ranges
+ *
+ * One range per thread; the calling thread handles the last one, plus every
+ * range whose worker could not be started. fn keeps whatever scratch state
+ * it needs for its range.
+ *
+ * @param units Work units
+ * @param threads Ranges to split into (see worker_count())
+ * @param fn bool(size_t first, size_t last)
+ * @return true if every range succeeded
+ */
+template <typename Fn>
+bool for_each_range(size_t units, size_t threads, Fn&& fn) {
+    if (threads <= 1) {
+        return fn(size_t{0}, units);
+    }
+
+    const size_t per_thread = (units + threads - 1) / threads;
+    std::atomic<bool> ok{true};
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+    size_t first = 0;
+    try {
+        for (size_t t = 0; t + 1 < threads && first < units; ++t) {
+            const size_t last = std::min(units, first + per_thread);
+            workers.emplace_back([&, first, last]() {
+                if (!fn(first, last)) {
+                    ok.store(false, std::memory_order_relaxed);
+                }
+            });
+            first = last;
+        }
+    } catch (const std::system_error&) {
+        // Out of threads: the ranges not handed out run here
+    }
+    if (first < units && !fn(first, units)) {
+        ok.store(false, std::memory_order_relaxed);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return ok.load();
+}
+
+/**
+ * @brief Run fn() on up to threads threads, the calling thread included
+ *
+ * For work units of very different cost: each fn() pulls units from shared
+ * state until none are left, so fewer threads than asked for (when starting
+ * one fails) still finish everything.
+ *
+ * @param threads Threads to run fn() on (0 or 1 = calling thread only)
+ * @param fn void()
+ */
+template <typename Fn>
+void run_workers(size_t threads, Fn&& fn) {
+    std::vector<std::thread> workers;
+    if (threads > 1) {
+        workers.reserve(threads - 1);
+        try {
+            for (size_t t = 1; t < threads; ++t) {
+                workers.emplace_back([&fn]() { fn(); });
+            }
+        } catch (const std::system_error&) {
+            // Fewer threads than asked for: the ones running share the rest
+        }
+    }
+    fn();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+}  // namespace KeepTower
+
+#endif  // KEEPTOWER_WORKER_RANGES_H
@@ -0,0 +1,196 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2026 tjdeveng
+
+#include "FoldedSearch.h"
+
+#include <bit>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define KEEPTOWER_FOLD_X86 1
+#include <immintrin.h>
+#else
+#define KEEPTOWER_FOLD_X86 0
+#endif
+
+namespace KeepTower {
+
+namespace {
+
+constexpr char CASE_BIT = 0x20;
+
+constexpr bool is_letter(char c) noexcept {
+    const char lower = static_cast<char>(c | CASE_BIT);
+    return lower >= 'a' && lower <= 'z';
+}
+
+/// Folded needle bytes and the case bit to OR into text before comparing
+struct Needle {
+    const char* folded;
+    const char* case_bits;
+    size_t size;
+};
+
+// (text | case bit) == folded byte holds for both cases of a letter and
+// only for the byte itself otherwise
+bool matches_at(const Needle& needle, const char* text) noexcept {
+    size_t i = 0;
+    for (; i + 8 <= needle.size; i += 8) {
+        uint64_t t, bits, folded;
+        std::memcpy(&t, text + i, 8);
+        std::memcpy(&bits, needle.case_bits + i, 8);
+        std::memcpy(&folded, needle.folded + i, 8);
+        if ((t | bits) != folded) {
+            return false;
+        }
+    }
+    for (; i < needle.size; ++i) {
+        if (static_cast<char>(text[i] | needle.case_bits[i]) != needle.folded[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t find_scalar(const Needle& needle, const char* text, size_t size, size_t from) noexcept {
+    const char first = needle.folded[0];
+    const char first_bit = needle.case_bits[0];
+    for (size_t i = from; i + needle.size <= size; ++i) {
+        if (static_cast<char>(text[i] | first_bit) == first && matches_at(needle, text + i)) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
+#if KEEPTOWER_FOLD_X86
+
+/*
+ * Compare a block of positions against the needle's first byte and the
+ * block starting needle.size - 1 later against its last byte; positions
+ * where both match are checked in full.
+ */
+
+__attribute__((target("sse2")))
+size_t find_sse2(const Needle& needle, const char* text, size_t size) noexcept {
+    const size_t last = needle.size - 1;
+    const __m128i first = _mm_set1_epi8(needle.folded[0]);
+    const __m128i first_bit = _mm_set1_epi8(needle.case_bits[0]);
+    const __m128i final = _mm_set1_epi8(needle.folded[last]);
+    const __m128i final_bit = _mm_set1_epi8(needle.case_bits[last]);
+
+    size_t i = 0;
+    for (; i + last + 16 <= size; i += 16) {
+        const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+        const __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i + last));
+        const __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(head, first_bit), first),
+                                           _mm_cmpeq_epi8(_mm_or_si128(tail, final_bit), final));
+        for (auto mask = static_cast<uint32_t>(_mm_movemask_epi8(hits)); mask != 0; mask &= mask - 1) {
+            const size_t position = i + static_cast<size_t>(std::countr_zero(mask));
+            if (matches_at(needle, text + position)) {
+                return position;
+            }
+        }
+    }
+    return find_scalar(needle, text, size, i);
+}
+
+__attribute__((target("avx2")))
+size_t find_avx2(const Needle& needle, const char* text, size_t size) noexcept {
+    const size_t last = needle.size - 1;
+    const __m256i first = _mm256_set1_epi8(needle.folded[0]);
+    const __m256i first_bit = _mm256_set1_epi8(needle.case_bits[0]);
+    const __m256i final = _mm256_set1_epi8(needle.folded[last]);
+    const __m256i final_bit = _mm256_set1_epi8(needle.case_bits[last]);
+
+    size_t i = 0;
+    size_t found = std::string_view::npos;
+    for (; found == std::string_view::npos && i + last + 32 <= size; i += 32) {
+        const __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+        const __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i + last));
+        const __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_or_si256(head, first_bit), first),
+                                              _mm256_cmpeq_epi8(_mm256_or_si256(tail, final_bit), final));
+        for (auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits)); mask != 0; mask &= mask - 1) {
+            const size_t position = i + static_cast<size_t>(std::countr_zero(mask));
+            if (matches_at(needle, text + position)) {
+                found = position;
+                break;
+            }
+        }
+    }
+
+    // The compiler does not clear the upper halves for target("avx2")
+    // functions; left dirty they slow every SSE instruction that follows
+    _mm256_zeroupper();
+    if (found != std::string_view::npos) {
+        return found;
+    }
+
+    // Finish the last partial block sixteen positions at a time
+    found = find_sse2(needle, text + i, size - i);
+    return found != std::string_view::npos ? i + found : found;
+}
+
+#endif  // KEEPTOWER_FOLD_X86
+
+}  // namespace
+
+FoldedNeedle::FoldedNeedle(std::string_view needle, Kernel kernel)
+    : m_kernel(kernel_supported(kernel) ? kernel : best_kernel()) {
+    m_folded.reserve(needle.size());
+    m_case_bits.reserve(needle.size());
+    for (const char c : needle) {
+        const bool letter = is_letter(c);
+        m_folded.push_back(letter ? static_cast<char>(c | CASE_BIT) : c);
+        m_case_bits.push_back(letter ? CASE_BIT : 0);
+    }
+}
+
+size_t FoldedNeedle::find_in(std::string_view haystack) const noexcept {
+    if (m_folded.empty()) {
+        return 0;
+    }
+    if (haystack.size() < m_folded.size()) {
+        return std::string_view::npos;
+    }
+
+    const Needle needle{m_folded.data(), m_case_bits.data(), m_folded.size()};
+#if KEEPTOWER_FOLD_X86
+    if (m_kernel == Kernel::Avx2) {
+        return find_avx2(needle, haystack.data(), haystack.size());
+    }
+    if (m_kernel == Kernel::Sse2) {
+        return find_sse2(needle, haystack.data(), haystack.size());
+    }
+#endif
+    return find_scalar(needle, haystack.data(), haystack.size(), 0);
+}
+
+FoldedNeedle::Kernel FoldedNeedle::best_kernel() noexcept {
+    if (kernel_supported(Kernel::Avx2)) {
+        return Kernel::Avx2;
+    }
+    if (kernel_supported(Kernel::Sse2)) {
+        return Kernel::Sse2;
+    }
+    return Kernel::Scalar;
+}
+
+bool FoldedNeedle::kernel_supported(Kernel kernel) noexcept {
+    switch (kernel) {
+        case Kernel::Scalar:
+            return true;
+#if KEEPTOWER_FOLD_X86
+        case Kernel::Sse2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2");
+        case Kernel::Avx2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+}  // namespace KeepTower
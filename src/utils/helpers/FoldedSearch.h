@@ -0,0 +1,96 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2026 tjdeveng
+
+/**
+ * @file FoldedSearch.h
+ * @brief Case-insensitive substring search without lowercase copies
+ *
+ * Search filters used to lowercase a copy of every field they looked at
+ * before calling find(). FoldedNeedle folds the search text once and then
+ * compares each field in place, sixteen or thirty-two positions at a time
+ * on x86 (SSE2/AVX2) and one at a time elsewhere.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace KeepTower {
+
+/**
+ * @brief Search text folded once for ASCII case-insensitive substring search
+ *
+ * Matches what lowercasing both strings with std::tolower in the "C"
+ * locale and calling find() would: ASCII letters match either case, every
+ * other byte (including UTF-8 sequences) only itself.
+ *
+ * The vector kernels look for the needle's first and last bytes at every
+ * candidate position of a block in two compares, and only check the bytes
+ * between where both match.
+ *
+ * @section Thread Safety
+ * Immutable after construction; searches may run concurrently.
+ */
+class FoldedNeedle {
+public:
+    /// Search implementation
+    enum class Kernel : uint8_t {
+        Scalar,  ///< Portable, one position at a time
+        Sse2,    ///< 16 positions per step
+        Avx2     ///< 32 positions per step
+    };
+
+    /**
+     * @brief Fold search text
+     * @param needle Text to find, in any case
+     * @param kernel Implementation (falls back to best_kernel() if unsupported)
+     */
+    explicit FoldedNeedle(std::string_view needle, Kernel kernel = best_kernel());
+
+    /**
+     * @brief Position of the first case-insensitive occurrence
+     * @param haystack Text to search
+     * @return Byte offset, or std::string_view::npos (0 for an empty needle)
+     */
+    [[nodiscard]] size_t find_in(std::string_view haystack) const noexcept;
+
+    /**
+     * @brief Whether the haystack contains the needle, ignoring case
+     * @param haystack Text to search
+     * @return true if found (always for an empty needle)
+     */
+    [[nodiscard]] bool found_in(std::string_view haystack) const noexcept {
+        return find_in(haystack) != std::string_view::npos;
+    }
+
+    /** @brief Folded (lowercase) needle
+     *  @return Needle text */
+    [[nodiscard]] const std::string& folded() const noexcept { return m_folded; }
+
+    /** @brief Needle length in bytes
+     *  @return Size */
+    [[nodiscard]] size_t size() const noexcept { return m_folded.size(); }
+
+    /** @brief Kernel in use
+     *  @return Kernel */
+    [[nodiscard]] Kernel kernel() const noexcept { return m_kernel; }
+
+    /** @brief Fastest kernel the running CPU supports
+     *  @return Kernel */
+    [[nodiscard]] static Kernel best_kernel() noexcept;
+
+    /** @brief Whether the running CPU supports a kernel
+     *  @param kernel Kernel to check
+     *  @return true if usable */
+    [[nodiscard]] static bool kernel_supported(Kernel kernel) noexcept;
+
+private:
+    std::string m_folded;      ///< Needle with ASCII letters lowercased
+    std::string m_case_bits;   ///< 0x20 where the needle has a letter, else 0
+    Kernel m_kernel;
+};
+
+}  // namespace KeepTower
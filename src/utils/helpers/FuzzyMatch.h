@@ -52,23 +52,19 @@ inline int levenshtein_distance(std::string_view s1, std::string_view s2) {
     return prev_row[len2];
 }
 
-/// @brief Calculate fuzzy match score (0-100, higher = better match)
-/// @param query Search query
-/// @param target Target string to match against
-/// @return Match score (0 = no match, 100 = perfect match)
-inline int fuzzy_score(std::string_view query, std::string_view target) {
-    if (query.empty()) return 0;
-    if (target.empty()) return 0;
-
-    // Convert to lowercase for comparison
-    std::string query_lower;
-    std::string target_lower;
-    query_lower.reserve(query.size());
-    target_lower.reserve(target.size());
-
-    for (char c : query) query_lower += std::tolower(c);
-    for (char c : target) target_lower += std::tolower(c);
+namespace detail {
+
+/// @brief ASCII-lowercased copy of a string
+inline std::string to_lower(std::string_view text) {
+    std::string lower;
+    lower.reserve(text.size());
+    for (char c : text) lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return lower;
+}
 
+/// @brief Score for exact, prefix and substring matches of lowercased strings
+/// @return 100, 90 or 80, or 0 if the query does not occur in the target
+inline int containment_score(std::string_view query_lower, std::string_view target_lower) {
     // Exact match = 100 points
     if (query_lower == target_lower) {
         return 100;
@@ -80,13 +76,15 @@ inline int fuzzy_score(std::string_view query, std::string_view target) {
     }
 
     // Contains query as substring = 80 points
-    if (target_lower.find(query_lower) != std::string::npos) {
+    if (target_lower.find(query_lower) != std::string_view::npos) {
         return 80;
     }
+    return 0;
+}
 
-    // Calculate Levenshtein distance for fuzzy matching
-    const int distance = levenshtein_distance(query_lower, target_lower);
-    const int max_len = static_cast<int>(std::max(query_lower.size(), target_lower.size()));
+/// @brief Fuzzy score for an edit distance between strings of the given lengths
+inline int similarity_score(int distance, size_t query_len, size_t target_len) {
+    const int max_len = static_cast<int>(std::max(query_len, target_len));
 
     // Score based on similarity (inverse of edit distance ratio)
     // distance/max_len ranges from 0.0 (identical) to 1.0 (completely different)
@@ -96,13 +94,76 @@ inline int fuzzy_score(std::string_view query, std::string_view target) {
     return static_cast<int>(similarity * 70);
 }
 
+} // namespace detail
+
+/// @brief Calculate fuzzy match score (0-100, higher = better match)
+/// @param query Search query
+/// @param target Target string to match against
+/// @return Match score (0 = no match, 100 = perfect match)
+inline int fuzzy_score(std::string_view query, std::string_view target) {
+    if (query.empty()) return 0;
+    if (target.empty()) return 0;
+
+    // Convert to lowercase for comparison
+    const std::string query_lower = detail::to_lower(query);
+    const std::string target_lower = detail::to_lower(target);
+
+    if (const int score = detail::containment_score(query_lower, target_lower); score > 0) {
+        return score;
+    }
+
+    // Calculate Levenshtein distance for fuzzy matching
+    const int distance = levenshtein_distance(query_lower, target_lower);
+    return detail::similarity_score(distance, query_lower.size(), target_lower.size());
+}
+
+/// @brief Check if the edit-distance score alone reaches a threshold
+///
+/// The part of fuzzy_matches() after exact, prefix and substring matches
+/// have been ruled out, for callers that check those themselves. Skips the
+/// edit distance when the length difference alone (a lower bound on it)
+/// already keeps the score under the threshold.
+///
+/// @param query Search query
+/// @param target Target string
+/// @param threshold Minimum score required
+/// @return True if the similarity score (0-70) >= threshold
+inline bool similarity_matches(std::string_view query, std::string_view target, int threshold) {
+    const size_t longer = std::max(query.size(), target.size());
+    const size_t shorter = std::min(query.size(), target.size());
+    if (longer == 0) {
+        return 0 >= threshold;
+    }
+    if (detail::similarity_score(static_cast<int>(longer - shorter), query.size(), target.size()) < threshold) {
+        return false;
+    }
+
+    // levenshtein_distance() ignores case itself
+    const int distance = levenshtein_distance(query, target);
+    return detail::similarity_score(distance, query.size(), target.size()) >= threshold;
+}
+
 /// @brief Check if a string fuzzy matches query with minimum score threshold
+///
+/// Same result as comparing fuzzy_score() with the threshold, but skips the
+/// edit distance when the length difference rules it out.
+///
 /// @param query Search query
 /// @param target Target string
 /// @param threshold Minimum score required (default: 30)
 /// @return True if score >= threshold
 inline bool fuzzy_matches(std::string_view query, std::string_view target, int threshold = 30) {
-    return fuzzy_score(query, target) >= threshold;
+    if (query.empty() || target.empty()) {
+        return 0 >= threshold;
+    }
+
+    const std::string query_lower = detail::to_lower(query);
+    const std::string target_lower = detail::to_lower(target);
+
+    if (const int score = detail::containment_score(query_lower, target_lower); score > 0) {
+        return score >= threshold;
+    }
+    return similarity_matches(query_lower, target_lower, threshold);
 }
 
 } // namespace KeepTower::FuzzyMatch
@@ -7,7 +7,13 @@
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <iostream>
+#include <random>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 using namespace KeepTower;
 
@@ -15,6 +21,7 @@ namespace {
 
 keeptower::AccountRecord make_account(const std::string& name, int32_t global_display_order = -1) {
     keeptower::AccountRecord account;
+    account.set_id("id-" + name);
     account.set_account_name(name);
     account.set_user_name(name + "-user");
     account.set_global_display_order(global_display_order);
@@ -190,4 +197,136 @@ TEST_F(AccountManagerUnitTests, CanDeleteAccountMatchesIndexValidity) {
 
     EXPECT_TRUE(manager.can_delete_account(0));
     EXPECT_FALSE(manager.can_delete_account(1));
-}
\ No newline at end of file
+}
+TEST_F(AccountManagerUnitTests, ChangeListenerHearsEveryChangeToTheList) {
+    using Change = AccountManager::AccountChange;
+    std::vector<std::pair<Change, std::string>> changes;
+    manager.set_change_listener([&changes](Change change, std::string_view id) {
+        changes.emplace_back(change, std::string{id});
+    });
+
+    ASSERT_TRUE(manager.add_account(make_account("A")));
+    ASSERT_TRUE(manager.add_account(make_account("B")));
+    EXPECT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes.back(), std::make_pair(Change::Added, std::string{"id-B"}));
+
+    ASSERT_TRUE(manager.update_account(0, make_account("A2")));
+    ASSERT_NE(manager.get_account_mutable(1), nullptr);
+    ASSERT_EQ(changes.size(), 5u);
+    EXPECT_EQ(changes[2], std::make_pair(Change::Rewritten, std::string{"id-A"}));
+    EXPECT_EQ(changes[3], std::make_pair(Change::Added, std::string{"id-A2"}));  // Re-keyed
+    EXPECT_EQ(changes[4], std::make_pair(Change::Rewritten, std::string{"id-B"}));
+
+    // Reordering only renumbers display order; positions stay put
+    changes.clear();
+    ASSERT_TRUE(manager.reorder_account(0, 1));
+    ASSERT_NE(manager.get_account(0), nullptr);
+    EXPECT_FALSE(manager.delete_account(5));
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].first, Change::Reordered);
+    EXPECT_EQ(changes[1].first, Change::Reordered);
+
+    changes.clear();
+    ASSERT_TRUE(manager.delete_account(0));
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0], std::make_pair(Change::Removed, std::string{"id-A2"}));
+}
+
+TEST_F(AccountManagerUnitTests, FindIndexByIdFollowsAddDeleteAndReorder) {
+    for (const char* name : {"A", "B", "C", "D"}) {
+        ASSERT_TRUE(manager.add_account(make_account(name)));
+    }
+    EXPECT_EQ(manager.find_index_by_id("id-C"), 2u);
+
+    ASSERT_TRUE(manager.delete_account(1));
+    EXPECT_EQ(manager.find_index_by_id("id-A"), 0u);
+    EXPECT_FALSE(manager.find_index_by_id("id-B").has_value());
+    EXPECT_EQ(manager.find_index_by_id("id-C"), 1u);
+    EXPECT_EQ(manager.find_index_by_id("id-D"), 2u);
+
+    ASSERT_TRUE(manager.reorder_account(0, 2));
+    EXPECT_EQ(manager.find_index_by_id("id-A"), 0u);
+    EXPECT_EQ(manager.find_index_by_id("id-D"), 2u);
+
+    ASSERT_TRUE(manager.add_account(make_account("E")));
+    EXPECT_EQ(manager.find_index_by_id("id-E"), 3u);
+    EXPECT_FALSE(manager.find_index_by_id("missing").has_value());
+}
+
+TEST_F(AccountManagerUnitTests, FindIndexByIdReturnsFirstOfDuplicateIds) {
+    ASSERT_TRUE(manager.add_account(make_account("X")));
+    ASSERT_TRUE(manager.add_account(make_account("Y")));
+    ASSERT_TRUE(manager.add_account(make_account("X")));
+    EXPECT_EQ(manager.find_index_by_id("id-X"), 0u);
+
+    ASSERT_TRUE(manager.delete_account(0));
+    EXPECT_EQ(manager.find_index_by_id("id-X"), 1u);
+    EXPECT_EQ(manager.find_index_by_id("id-Y"), 0u);
+}
+
+TEST_F(AccountManagerUnitTests, FindIndexByIdSeesChangedIds) {
+    ASSERT_TRUE(manager.add_account(make_account("A")));
+    ASSERT_TRUE(manager.add_account(make_account("B")));
+    EXPECT_EQ(manager.find_index_by_id("id-B"), 1u);
+
+    // Through the manager
+    ASSERT_TRUE(manager.update_account(1, make_account("Renamed")));
+    EXPECT_FALSE(manager.find_index_by_id("id-B").has_value());
+    EXPECT_EQ(manager.find_index_by_id("id-Renamed"), 1u);
+
+    auto* account = manager.get_account_mutable(0);
+    ASSERT_NE(account, nullptr);
+    account->set_id("id-Edited");
+    EXPECT_EQ(manager.find_index_by_id("id-Edited"), 0u);
+
+    // Behind its back: a stale hit is caught, and a reported change is picked up
+    vault_data.mutable_accounts(0)->set_id("id-Direct");
+    EXPECT_FALSE(manager.find_index_by_id("id-Edited").has_value());
+    vault_data.mutable_accounts(1)->set_id("id-Direct2");
+    manager.invalidate_id_index();
+    EXPECT_EQ(manager.find_index_by_id("id-Direct2"), 1u);
+
+    *vault_data.add_accounts() = make_account("Appended");
+    EXPECT_EQ(manager.find_index_by_id("id-Appended"), 2u);
+}
+
+// Microbenchmark: lookups must not slow down with the size of the vault
+TEST_F(AccountManagerUnitTests, Performance_FindIndexByIdIsConstantTime) {
+    static constexpr size_t LOOKUPS = 200000;
+
+    auto nanoseconds_per_lookup = [](size_t account_count) {
+        keeptower::VaultData data;
+        bool data_modified = false;
+        AccountManager accounts(data, data_modified);
+        std::vector<std::string> ids;
+        ids.reserve(account_count);
+        for (size_t i = 0; i < account_count; ++i) {
+            auto* account = data.add_accounts();
+            account->set_id("3f2504e0-4f89-11d3-9a0c-" + std::to_string(1000000000000 + i));
+            ids.push_back(account->id());
+        }
+        std::shuffle(ids.begin(), ids.end(), std::mt19937(42));
+        EXPECT_TRUE(accounts.find_index_by_id(ids.front()).has_value());  // Builds the index
+
+        double best = 1e18;
+        for (int run = 0; run < 3; ++run) {
+            size_t found = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = 0; i < LOOKUPS; ++i) {
+                found += accounts.find_index_by_id(ids[i % ids.size()]).has_value() ? 1 : 0;
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            EXPECT_EQ(found, LOOKUPS);
+            best = std::min(best, std::chrono::duration<double, std::nano>(elapsed).count() / LOOKUPS);
+        }
+        return best;
+    };
+
+    const double small = nanoseconds_per_lookup(1000);
+    const double large = nanoseconds_per_lookup(100000);
+    std::cout << "find_index_by_id: " << small << " ns/lookup at 1k accounts, "
+              << large << " ns/lookup at 100k accounts" << std::endl;
+
+    // A linear scan would be ~100x slower at 100k; allow for cache misses
+    EXPECT_LT(large, small * 20);
+}
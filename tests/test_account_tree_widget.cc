@@ -3,12 +3,12 @@
 
 #include <gtest/gtest.h>
 #include <gtkmm/application.h>
+#include <gtkmm/treelistrow.h>
 #include <gtkmm/window.h>
 
 #include "../src/ui/widgets/AccountTreeWidget.h"
 
 #include <algorithm>
-#include <functional>
 #include <vector>
 
 namespace {
@@ -41,30 +41,9 @@ keeptower::AccountRecord make_account(const std::string& id,
     return account;
 }
 
-template <typename WidgetT>
-std::vector<WidgetT*> collect_descendants(Gtk::Widget& root) {
-    std::vector<WidgetT*> matches;
-
-    std::function<void(Gtk::Widget&)> visit = [&](Gtk::Widget& widget) {
-        if (auto* typed = dynamic_cast<WidgetT*>(&widget)) {
-            matches.push_back(typed);
-        }
-
-        for (auto* child = widget.get_first_child(); child; child = child->get_next_sibling()) {
-            visit(*child);
-        }
-    };
-
-    visit(root);
-    return matches;
-}
-
+// Rows are virtualized, so inspect the model rather than the row widgets
 std::vector<std::string> account_row_ids(AccountTreeWidget& tree_widget) {
-    std::vector<std::string> ids;
-    for (auto* row : collect_descendants<AccountRowWidget>(tree_widget)) {
-        ids.push_back(row->account_id());
-    }
-    return ids;
+    return tree_widget.displayed_account_ids();
 }
 
 int count_account_id(AccountTreeWidget& tree_widget, const std::string& id) {
@@ -73,11 +52,12 @@ int count_account_id(AccountTreeWidget& tree_widget, const std::string& id) {
 }
 
 std::vector<std::string> group_row_ids(AccountTreeWidget& tree_widget) {
-    std::vector<std::string> ids;
-    for (auto* row : collect_descendants<GroupRowWidget>(tree_widget)) {
-        ids.push_back(row->group_id());
-    }
-    return ids;
+    return tree_widget.displayed_group_ids();
+}
+
+Glib::RefPtr<AccountTreeItem> item_at(AccountTreeWidget& tree_widget, guint position) {
+    auto row = std::dynamic_pointer_cast<Gtk::TreeListRow>(tree_widget.get_model()->get_object(position));
+    return row ? std::dynamic_pointer_cast<AccountTreeItem>(row->get_item()) : nullptr;
 }
 
 class AccountTreeWidgetTest : public ::testing::Test {
@@ -241,4 +221,89 @@ TEST_F(AccountTreeWidgetTest, FiltersLimitRowsAndClearFiltersRestoresData) {
     EXPECT_EQ(count_account_id(*m_tree_widget, "beta-id"), 2);
 }
 
-}  // namespace
\ No newline at end of file
+TEST_F(AccountTreeWidgetTest, FilteringOnlyTouchesRowsThatChange) {
+    std::vector<keeptower::AccountGroup> groups;
+    groups.push_back(make_group("group-1", "Work"));
+
+    std::vector<keeptower::AccountRecord> accounts;
+    accounts.push_back(make_account("account-a", "Alpha", "group-1"));
+    accounts.push_back(make_account("account-b", "Beta", "group-1"));
+    accounts.push_back(make_account("account-c", "Gamma", "group-1"));
+    m_tree_widget->set_data(groups, accounts);
+
+    // group-1, its three accounts, "all" and its three accounts
+    auto model = m_tree_widget->get_model();
+    ASSERT_EQ(model->get_n_items(), 8u);
+    const auto gamma = item_at(*m_tree_widget, 3);
+    ASSERT_TRUE(gamma);
+    EXPECT_EQ(gamma->id(), "account-c");
+
+    guint removed_total = 0;
+    guint added_total = 0;
+    model->signal_items_changed().connect([&](guint, guint removed, guint added) {
+        removed_total += removed;
+        added_total += added;
+    });
+
+    // Every name contains "a": nothing changes
+    m_tree_widget->set_filters("a", "", 1);
+    EXPECT_EQ(removed_total + added_total, 0u);
+
+    // Alpha and Beta drop out of both groups; Gamma's rows are left alone
+    m_tree_widget->set_filters("m", "", 1);
+    EXPECT_EQ(removed_total, 4u);
+    EXPECT_EQ(added_total, 0u);
+    EXPECT_EQ(account_row_ids(*m_tree_widget),
+              (std::vector<std::string>{"account-c", "account-c"}));
+    EXPECT_EQ(item_at(*m_tree_widget, 1), gamma);
+
+    removed_total = 0;
+    added_total = 0;
+    m_tree_widget->clear_filters();
+    EXPECT_EQ(removed_total, 0u);
+    EXPECT_EQ(added_total, 4u);
+    EXPECT_EQ(item_at(*m_tree_widget, 3), gamma);
+}
+
+TEST_F(AccountTreeWidgetTest, ChangedAccountIsReplacedInPlace) {
+    std::vector<keeptower::AccountGroup> groups;
+    groups.push_back(make_group("group-1", "Work"));
+
+    std::vector<keeptower::AccountRecord> accounts;
+    accounts.push_back(make_account("account-a", "Alpha", "group-1"));
+    accounts.push_back(make_account("account-b", "Beta", "group-1"));
+    m_tree_widget->set_data(groups, accounts);
+    const auto alpha = item_at(*m_tree_widget, 1);
+
+    // Favoriting adds the favorites group and rebinds Beta's rows only
+    accounts[1].set_is_favorite(true);
+    m_tree_widget->set_data(groups, accounts);
+
+    EXPECT_EQ(group_row_ids(*m_tree_widget),
+              (std::vector<std::string>{"favorites", "group-1", "all"}));
+    EXPECT_EQ(item_at(*m_tree_widget, 3), alpha);
+    const auto beta = item_at(*m_tree_widget, 4);
+    ASSERT_TRUE(beta);
+    EXPECT_EQ(beta->id(), "account-b");
+    EXPECT_TRUE(beta->is_favorite());
+}
+
+TEST_F(AccountTreeWidgetTest, RenamedAccountMovesToItsSortedPosition) {
+    std::vector<keeptower::AccountGroup> groups;
+    groups.push_back(make_group("group-1", "Work"));
+
+    std::vector<keeptower::AccountRecord> accounts;
+    accounts.push_back(make_account("account-a", "Alpha", "group-1"));
+    accounts.push_back(make_account("account-b", "Beta", "group-1"));
+    accounts.push_back(make_account("account-c", "Gamma", "group-1"));
+    m_tree_widget->set_data(groups, accounts);
+
+    accounts[0].set_account_name("Zeta");
+    m_tree_widget->set_data(groups, accounts);
+
+    EXPECT_EQ(account_row_ids(*m_tree_widget),
+              (std::vector<std::string>{"account-b", "account-c", "account-a",
+                                        "account-b", "account-c", "account-a"}));
+}
+
+}  // namespace
@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file test_chunked_backup_store.cc
+ * @brief Unit tests for the deduplicating chunked backup store
+ */
+
+#include <gtest/gtest.h>
+#include "../src/lib/backup/ChunkedBackupStore.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace KeepTower;
+namespace fs = std::filesystem;
+
+class ChunkedBackupStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = fs::temp_directory_path() / "keeptower_test_chunked_backups";
+        fs::remove_all(test_dir);
+        fs::create_directories(test_dir);
+        vault_path = test_dir / "test.vault";
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir);
+    }
+
+    static std::vector<uint8_t> random_bytes(size_t size, uint32_t seed) {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> bytes(size);
+        for (auto& b : bytes) {
+            b = static_cast<uint8_t>(rng());
+        }
+        return bytes;
+    }
+
+    void write_vault(const std::vector<uint8_t>& bytes) const {
+        std::ofstream out(vault_path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    std::vector<uint8_t> read_vault() const {
+        std::ifstream in(vault_path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    }
+
+    size_t object_count() const {
+        size_t count = 0;
+        for (const auto& entry : fs::recursive_directory_iterator(
+                 ChunkedBackupStore::store_root(vault_path.string(), "") / "objects")) {
+            count += entry.is_regular_file() ? 1 : 0;
+        }
+        return count;
+    }
+
+    // Recipe names have millisecond resolution
+    static void next_timestamp() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+
+    fs::path test_dir;
+    fs::path vault_path;
+};
+
+TEST_F(ChunkedBackupStoreTest, SplitIsBoundedAndContentDefined) {
+    const auto image = random_bytes(4 * 1024 * 1024, 1);
+    const auto lengths = ChunkedBackupStore::split(image);
+
+    size_t total = 0;
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        EXPECT_LE(lengths[i], ChunkedBackupStore::MAX_CHUNK_SIZE);
+        if (i + 1 < lengths.size()) {
+            EXPECT_GE(lengths[i], ChunkedBackupStore::MIN_CHUNK_SIZE);
+        }
+        total += lengths[i];
+    }
+    EXPECT_EQ(total, image.size());
+
+    // Inserting bytes mid-image only moves the boundaries around the edit
+    auto edited = image;
+    const auto insert = random_bytes(100, 2);
+    edited.insert(edited.begin() + static_cast<std::ptrdiff_t>(image.size() / 2), insert.begin(), insert.end());
+    const auto edited_lengths = ChunkedBackupStore::split(edited);
+
+    auto boundaries = [](const std::vector<size_t>& chunk_lengths, size_t shift_from, size_t shift) {
+        std::vector<size_t> ends;
+        size_t end = 0;
+        for (size_t length : chunk_lengths) {
+            end += length;
+            ends.push_back(end > shift_from ? end - shift : end);
+        }
+        return ends;
+    };
+    const auto before = boundaries(lengths, SIZE_MAX, 0);
+    const auto after = boundaries(edited_lengths, image.size() / 2, insert.size());
+    std::vector<size_t> shared;
+    std::set_intersection(before.begin(), before.end(), after.begin(), after.end(), std::back_inserter(shared));
+    EXPECT_GE(shared.size() + 3, before.size());
+}
+
+TEST_F(ChunkedBackupStoreTest, UnchangedAndAppendedImagesOnlyWriteNewChunks) {
+    auto image = random_bytes(2 * 1024 * 1024, 3);
+    write_vault(image);
+
+    auto first = ChunkedBackupStore::create_backup(vault_path.string(), "");
+    ASSERT_TRUE(first.has_value());
+    EXPECT_EQ(first->new_chunks, first->chunk_count);
+
+    next_timestamp();
+    auto unchanged = ChunkedBackupStore::create_backup(vault_path.string(), "");
+    ASSERT_TRUE(unchanged.has_value());
+    EXPECT_EQ(unchanged->new_chunks, 0u);
+    EXPECT_EQ(unchanged->bytes_written, 0u);
+
+    // A journal append grows the file without touching the base image
+    const auto record = random_bytes(3000, 4);
+    image.insert(image.end(), record.begin(), record.end());
+    write_vault(image);
+    next_timestamp();
+    auto appended = ChunkedBackupStore::create_backup(vault_path.string(), "");
+    ASSERT_TRUE(appended.has_value());
+    EXPECT_LE(appended->new_chunks, 2u);
+    EXPECT_LT(appended->bytes_written, 2 * ChunkedBackupStore::MAX_CHUNK_SIZE);
+
+    EXPECT_EQ(ChunkedBackupStore::list_backups(vault_path.string(), "").size(), 3u);
+}
+
+TEST_F(ChunkedBackupStoreTest, RestoreReassemblesNewestBackup) {
+    const auto original = random_bytes(700 * 1024, 5);
+    write_vault(original);
+    ASSERT_TRUE(ChunkedBackupStore::create_backup(vault_path.string(), "").has_value());
+
+    write_vault(random_bytes(1000, 6));
+    ASSERT_TRUE(ChunkedBackupStore::restore_most_recent(vault_path.string(), "").has_value());
+    EXPECT_EQ(read_vault(), original);
+
+    const auto perms = fs::status(vault_path).permissions();
+    EXPECT_EQ(perms & (fs::perms::group_all | fs::perms::others_all), fs::perms::none);
+}
+
+TEST_F(ChunkedBackupStoreTest, RestoreRejectsCorruptChunkAndLeavesVaultAlone) {
+    write_vault(random_bytes(300 * 1024, 7));
+    auto backup = ChunkedBackupStore::create_backup(vault_path.string(), "");
+    ASSERT_TRUE(backup.has_value());
+
+    // Flip a byte in one stored chunk
+    const fs::path objects = ChunkedBackupStore::store_root(vault_path.string(), "") / "objects";
+    for (const auto& entry : fs::recursive_directory_iterator(objects)) {
+        if (entry.is_regular_file()) {
+            std::fstream object(entry.path(), std::ios::binary | std::ios::in | std::ios::out);
+            object.seekp(10);
+            object.put('\x5A');
+            break;
+        }
+    }
+
+    const auto current = random_bytes(1000, 8);
+    write_vault(current);
+    auto result = ChunkedBackupStore::restore(vault_path.string(), backup->recipe);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), VaultError::FileReadFailed);
+    EXPECT_EQ(read_vault(), current);
+    EXPECT_FALSE(ChunkedBackupStore::restore_most_recent(vault_path.string(), "").has_value());
+}
+
+TEST_F(ChunkedBackupStoreTest, PruneDropsOldBackupsAndTheirChunks) {
+    std::vector<uint8_t> newest;
+    for (uint32_t i = 0; i < 3; ++i) {
+        newest = random_bytes(500 * 1024, 10 + i);
+        write_vault(newest);
+        ASSERT_TRUE(ChunkedBackupStore::create_backup(vault_path.string(), "").has_value());
+        next_timestamp();
+    }
+
+    ChunkedBackupStore::prune(vault_path.string(), 1, "");
+
+    EXPECT_EQ(ChunkedBackupStore::list_backups(vault_path.string(), "").size(), 1u);
+    EXPECT_EQ(object_count(), ChunkedBackupStore::split(newest).size());
+
+    write_vault({});
+    ASSERT_TRUE(ChunkedBackupStore::restore_most_recent(vault_path.string(), "").has_value());
+    EXPECT_EQ(read_vault(), newest);
+}
+
+TEST_F(ChunkedBackupStoreTest, CompressionShrinksCompressibleChunks) {
+    std::vector<uint8_t> image(1024 * 1024);
+    for (size_t i = 0; i < image.size(); ++i) {
+        image[i] = static_cast<uint8_t>((i / 64) % 7);
+    }
+    write_vault(image);
+
+    auto backup = ChunkedBackupStore::create_backup(vault_path.string(), "", true);
+    ASSERT_TRUE(backup.has_value());
+    EXPECT_LT(backup->bytes_written, image.size() / 4);
+
+    write_vault({});
+    ASSERT_TRUE(ChunkedBackupStore::restore(vault_path.string(), backup->recipe).has_value());
+    EXPECT_EQ(read_vault(), image);
+}
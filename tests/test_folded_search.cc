@@ -0,0 +1,203 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// SPDX-FileCopyrightText: 2026 tjdeveng
+
+/**
+ * @file test_folded_search.cc
+ * @brief Unit tests and scan-rate benchmark for FoldedNeedle
+ */
+
+#include <gtest/gtest.h>
+#include "../src/utils/helpers/FoldedSearch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using KeepTower::FoldedNeedle;
+
+namespace {
+
+std::vector<FoldedNeedle::Kernel> supported_kernels() {
+    std::vector<FoldedNeedle::Kernel> kernels;
+    for (auto kernel : {FoldedNeedle::Kernel::Scalar, FoldedNeedle::Kernel::Sse2, FoldedNeedle::Kernel::Avx2}) {
+        if (FoldedNeedle::kernel_supported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+const char* kernel_name(FoldedNeedle::Kernel kernel) {
+    switch (kernel) {
+        case FoldedNeedle::Kernel::Sse2: return "SSE2";
+        case FoldedNeedle::Kernel::Avx2: return "AVX2";
+        default: return "scalar";
+    }
+}
+
+std::string lowered(std::string_view text) {
+    std::string lower(text);
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    return lower;
+}
+
+// What the filters did before: lowercase copies and find()
+size_t reference_find(std::string_view haystack, std::string_view needle) {
+    return lowered(haystack).find(lowered(needle));
+}
+
+}  // namespace
+
+TEST(FoldedSearchTest, IgnoresAsciiCaseOnly) {
+    for (const auto kernel : supported_kernels()) {
+        SCOPED_TRACE(kernel_name(kernel));
+        EXPECT_EQ(FoldedNeedle("GMAIL", kernel).find_in("john.doe@Gmail.com"), 9u);
+        EXPECT_TRUE(FoldedNeedle("hub w", kernel).found_in("GitHub Work"));
+        EXPECT_FALSE(FoldedNeedle("gitlab", kernel).found_in("GitHub Work"));
+
+        // Bytes one case bit apart that are not letters stay distinct
+        EXPECT_FALSE(FoldedNeedle("@", kernel).found_in("`"));
+        EXPECT_FALSE(FoldedNeedle("[", kernel).found_in("{"));
+        EXPECT_FALSE(FoldedNeedle("1", kernel).found_in("\x11"));
+
+        // UTF-8 is compared byte for byte
+        EXPECT_TRUE(FoldedNeedle("caf\xC3\xA9", kernel).found_in("Caf\xC3\xA9 Noir"));
+        EXPECT_FALSE(FoldedNeedle("\xC3\xA9", kernel).found_in("\xC3\x89"));
+    }
+}
+
+TEST(FoldedSearchTest, EdgeCases) {
+    for (const auto kernel : supported_kernels()) {
+        SCOPED_TRACE(kernel_name(kernel));
+        EXPECT_EQ(FoldedNeedle("", kernel).find_in(""), 0u);
+        EXPECT_EQ(FoldedNeedle("", kernel).find_in("abc"), 0u);
+        EXPECT_EQ(FoldedNeedle("abc", kernel).find_in(""), std::string_view::npos);
+        EXPECT_EQ(FoldedNeedle("abcd", kernel).find_in("abc"), std::string_view::npos);
+        EXPECT_EQ(FoldedNeedle("ABC", kernel).find_in("abc"), 0u);
+
+        // Matches at the very end of blocks of each width
+        for (const size_t length : {15u, 16u, 17u, 31u, 32u, 33u, 64u, 65u}) {
+            std::string text(length, 'x');
+            text.replace(length - 3, 3, "KEY");
+            EXPECT_EQ(FoldedNeedle("key", kernel).find_in(text), length - 3) << length;
+            EXPECT_EQ(FoldedNeedle("y", kernel).find_in(text), length - 1) << length;
+        }
+    }
+    EXPECT_EQ(FoldedNeedle("Key").folded(), "key");
+    EXPECT_EQ(FoldedNeedle("Key").size(), 3u);
+}
+
+TEST(FoldedSearchTest, EveryKernelMatchesLowercasedFind) {
+    std::mt19937 rng(42);
+    // Letters of both cases, their non-letter case-bit partners, and UTF-8 bytes
+    const std::string alphabet = "aAbBzZ@`[{09 .\xC3\xA9\x89";
+    auto random_text = [&](size_t length) {
+        std::string text;
+        for (size_t i = 0; i < length; ++i) {
+            text.push_back(alphabet[rng() % alphabet.size()]);
+        }
+        return text;
+    };
+
+    for (int round = 0; round < 3000; ++round) {
+        const std::string haystack = random_text(rng() % 200);
+        std::string needle;
+        if (!haystack.empty() && rng() % 2 == 0) {
+            // A slice of the haystack with its case flipped at random
+            const size_t start = rng() % haystack.size();
+            needle = haystack.substr(start, 1 + rng() % 40);
+            for (char& c : needle) {
+                if (std::isalpha(static_cast<unsigned char>(c)) && rng() % 2 == 0) {
+                    c = static_cast<char>(c ^ 0x20);
+                }
+            }
+        } else {
+            needle = random_text(1 + rng() % 4);
+        }
+
+        const size_t expected = reference_find(haystack, needle);
+        for (const auto kernel : supported_kernels()) {
+            ASSERT_EQ(FoldedNeedle(needle, kernel).find_in(haystack), expected)
+                << kernel_name(kernel) << " needle \"" << needle << "\" in \"" << haystack << "\"";
+        }
+    }
+}
+
+TEST(FoldedSearchTest, UnsupportedKernelFallsBack) {
+    const FoldedNeedle needle("abc", FoldedNeedle::Kernel::Avx2);
+    EXPECT_TRUE(FoldedNeedle::kernel_supported(needle.kernel()));
+    EXPECT_EQ(FoldedNeedle("abc").kernel(), FoldedNeedle::best_kernel());
+}
+
+TEST(FoldedSearchTest, Performance_ScanRate) {
+    // Field-like text: words, addresses and URLs in mixed case
+    std::mt19937 rng(7);
+    std::string text;
+    std::vector<std::string_view> fields;
+    std::vector<size_t> field_starts;
+    const size_t total = size_t{64} << 20;
+    text.reserve(total + 64);
+    while (text.size() < total) {
+        field_starts.push_back(text.size());
+        const size_t length = 8 + rng() % 56;
+        for (size_t i = 0; i < length; ++i) {
+            const uint32_t r = rng() % 32;
+            text.push_back(r < 26 ? static_cast<char>((rng() % 4 == 0 ? 'A' : 'a') + r) : " .@/-_"[r - 26]);
+        }
+    }
+    for (size_t i = 0; i < field_starts.size(); ++i) {
+        const size_t end = i + 1 < field_starts.size() ? field_starts[i + 1] : text.size();
+        fields.emplace_back(text.data() + field_starts[i], end - field_starts[i]);
+    }
+    const std::string absent = "Qx9Keeptower";  // Not in the text, so every byte is scanned
+    const double gigabytes = static_cast<double>(text.size()) / 1e9;
+
+    auto seconds_since = [](auto start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    // Baseline: what the filters did, a lowercase copy per field and find()
+    const std::string absent_lower = lowered(absent);
+    auto start = std::chrono::steady_clock::now();
+    size_t copied_hits = 0;
+    for (const auto field : fields) {
+        copied_hits += lowered(field).find(absent_lower) != std::string::npos;
+    }
+    const double copy_rate = gigabytes / seconds_since(start);
+    std::cout << "  lowercase copy + find, per field: " << copy_rate << " GB/s" << std::endl;
+    EXPECT_EQ(copied_hits, 0u);
+
+    double scalar_rate = 0.0;
+    double best_rate = 0.0;
+    for (const auto kernel : supported_kernels()) {
+        const FoldedNeedle needle(absent, kernel);
+
+        start = std::chrono::steady_clock::now();
+        const size_t found = needle.find_in(text);
+        const double whole_rate = gigabytes / seconds_since(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t hits = 0;
+        for (const auto field : fields) {
+            hits += needle.found_in(field);
+        }
+        const double field_rate = gigabytes / seconds_since(start);
+
+        std::cout << "  " << kernel_name(kernel) << ": " << whole_rate << " GB/s over one 64 MiB buffer, "
+                  << field_rate << " GB/s over " << fields.size() << " fields" << std::endl;
+        EXPECT_EQ(found, std::string_view::npos);
+        EXPECT_EQ(hits, 0u);
+
+        if (kernel == FoldedNeedle::Kernel::Scalar) {
+            scalar_rate = whole_rate;
+        }
+        best_rate = std::max(best_rate, whole_rate);
+    }
+
+    EXPECT_GE(best_rate, scalar_rate);
+    EXPECT_GT(best_rate, copy_rate);
+}
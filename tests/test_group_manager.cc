@@ -151,6 +151,27 @@ TEST_F(GroupManagerTest, DeleteGroupRemovesFromAccounts) {
     EXPECT_EQ(vault_data.accounts(1).groups_size(), 0);
 }
 
+TEST_F(GroupManagerTest, AccountChangeListenerHearsMembershipChanges) {
+    std::vector<std::string> changed;
+    group_manager->set_account_change_listener([&changed](std::string_view account_id) {
+        changed.emplace_back(account_id);
+    });
+
+    const std::string group_id = group_manager->create_group("Work");
+    EXPECT_TRUE(changed.empty());  // Group list changes touch no account
+
+    ASSERT_TRUE(group_manager->add_account_to_group(1, group_id));
+    ASSERT_TRUE(group_manager->add_account_to_group(3, group_id));
+    ASSERT_TRUE(group_manager->reorder_account_in_group(3, group_id, 2));
+    ASSERT_TRUE(group_manager->remove_account_from_group(1, group_id));
+    ASSERT_TRUE(group_manager->remove_account_from_group(1, group_id));  // Already out: no change
+    EXPECT_EQ(changed, (std::vector<std::string>{"account-1", "account-3", "account-3", "account-1"}));
+
+    changed.clear();
+    ASSERT_TRUE(group_manager->delete_group(group_id));
+    EXPECT_EQ(changed, (std::vector<std::string>{"account-3"}));
+}
+
 TEST_F(GroupManagerTest, DeleteGroupPreventsSystemGroup) {
     // Create a system group manually
     auto* sys_group = vault_data.add_groups();
@@ -534,6 +555,183 @@ TEST_F(GroupManagerTest, StressTestManyAccounts) {
     }
 }
 
+// ============================================================================
+// Membership index tests
+// ============================================================================
+
+TEST_F(GroupManagerTest, MembershipIndexListsMembersInAccountOrder) {
+    std::string group_id = group_manager->create_group("Work");
+    ASSERT_TRUE(group_manager->add_account_to_group(3, group_id));
+    ASSERT_TRUE(group_manager->add_account_to_group(0, group_id));
+    ASSERT_TRUE(group_manager->add_account_to_group(1, group_id));
+
+    const auto& index = group_manager->membership_index();
+    const uint32_t slot = index.slot_of(group_id);
+    ASSERT_NE(slot, GroupMembershipIndex::NO_SLOT);
+    EXPECT_EQ(std::vector<uint32_t>(index.members(slot).begin(), index.members(slot).end()),
+              (std::vector<uint32_t>{0, 1, 3}));
+
+    ASSERT_TRUE(group_manager->remove_account_from_group(1, group_id));
+    EXPECT_EQ(std::vector<uint32_t>(index.members(slot).begin(), index.members(slot).end()),
+              (std::vector<uint32_t>{0, 3}));
+    EXPECT_FALSE(index.contains(1, slot));
+
+    ASSERT_TRUE(group_manager->delete_group(group_id));
+    EXPECT_EQ(group_manager->membership_index().slot_of(group_id), GroupMembershipIndex::NO_SLOT);
+    EXPECT_EQ(vault_data.accounts(3).groups_size(), 0);
+}
+
+TEST_F(GroupManagerTest, MembershipIndexFollowsOutsideChanges) {
+    std::string group_id = group_manager->create_group("Work");
+    EXPECT_FALSE(group_manager->is_account_in_group(2, group_id));
+
+    // Edited behind the manager's back, then reported
+    vault_data.mutable_accounts(2)->add_groups()->set_group_id(group_id);
+    group_manager->invalidate_membership_index();
+    EXPECT_TRUE(group_manager->is_account_in_group(2, group_id));
+
+    // A changed account count is noticed without being reported
+    auto* account = vault_data.add_accounts();
+    account->set_id("account-5");
+    account->add_groups()->set_group_id(group_id);
+    EXPECT_TRUE(group_manager->is_account_in_group(5, group_id));
+    EXPECT_TRUE(group_manager->remove_account_from_group(5, group_id));
+    EXPECT_EQ(vault_data.accounts(5).groups_size(), 0);
+}
+
+TEST_F(GroupManagerTest, MembershipIndexSpansManyGroups) {
+    std::vector<std::string> group_ids;
+    for (int i = 0; i < 130; ++i) {
+        group_ids.push_back(group_manager->create_group("Group " + std::to_string(i)));
+        ASSERT_FALSE(group_ids.back().empty());
+        if (i % 3 == 0) {
+            ASSERT_TRUE(group_manager->add_account_to_group(2, group_ids.back()));
+        }
+    }
+
+    for (int i = 0; i < 130; ++i) {
+        EXPECT_EQ(group_manager->is_account_in_group(2, group_ids[i]), i % 3 == 0) << i;
+        EXPECT_FALSE(group_manager->is_account_in_group(1, group_ids[i])) << i;
+    }
+
+    size_t visited = 0;
+    group_manager->membership_index().for_each_group(2, [&](uint32_t) { ++visited; });
+    EXPECT_EQ(visited, 44u);
+
+    ASSERT_TRUE(group_manager->reorder_account_in_group(2, group_ids[129], 7));
+    EXPECT_FALSE(group_manager->reorder_account_in_group(2, group_ids[128], 7));
+}
+
+TEST_F(GroupManagerTest, StaleMembershipToMissingGroupCanBeRemoved) {
+    vault_data.mutable_accounts(0)->add_groups()->set_group_id("deleted-group");
+
+    EXPECT_TRUE(group_manager->is_account_in_group(0, "deleted-group"));
+    EXPECT_TRUE(group_manager->remove_account_from_group(0, "deleted-group"));
+    EXPECT_TRUE(modified_flag);
+    EXPECT_EQ(vault_data.accounts(0).groups_size(), 0);
+}
+
+TEST_F(GroupManagerTest, GroupLookupFollowsCreateAndDelete) {
+    std::vector<std::string> group_ids;
+    for (const char* name : {"A", "B", "C", "D"}) {
+        group_ids.push_back(group_manager->create_group(name));
+    }
+    const std::string favorites_id = group_manager->get_favorites_group_id();
+
+    ASSERT_TRUE(group_manager->delete_group(group_ids[1]));
+    EXPECT_EQ(group_manager->get_group(group_ids[1]), nullptr);
+    ASSERT_NE(group_manager->get_group(group_ids[2]), nullptr);
+    EXPECT_EQ(group_manager->get_group(group_ids[2])->group_name(), "C");
+    EXPECT_EQ(group_manager->get_group(favorites_id)->group_name(), "Favorites");
+
+    ASSERT_TRUE(group_manager->rename_group(group_ids[3], "D2"));
+    EXPECT_EQ(vault_data.groups(2).group_name(), "D2");
+
+    // Added behind the manager's back
+    auto* outside = vault_data.add_groups();
+    outside->set_group_id("outside");
+    outside->set_group_name("Outside");
+    ASSERT_NE(group_manager->get_group("outside"), nullptr);
+    EXPECT_TRUE(group_manager->reorder_group("outside", 3));
+}
+
+TEST(GroupMembershipIndexTest, IgnoresUnknownAndRepeatedMemberships) {
+    std::vector<keeptower::AccountGroup> groups(2);
+    groups[0].set_group_id("a");
+    groups[1].set_group_id("b");
+    std::vector<keeptower::AccountRecord> accounts(3);
+    accounts[0].add_groups()->set_group_id("b");
+    accounts[0].add_groups()->set_group_id("b");
+    accounts[1].add_groups()->set_group_id("unknown");
+    accounts[2].add_groups()->set_group_id("a");
+    accounts[2].add_groups()->set_group_id("b");
+
+    GroupMembershipIndex index;
+    index.rebuild(groups, accounts);
+    EXPECT_EQ(index.group_count(), 2u);
+    EXPECT_EQ(index.account_count(), 3u);
+    EXPECT_EQ(index.members(index.slot_of("b")).size(), 2u);
+    EXPECT_EQ(index.members(index.slot_of("a")).size(), 1u);
+    EXPECT_TRUE(index.members(GroupMembershipIndex::NO_SLOT).empty());
+    EXPECT_FALSE(index.contains(1, index.slot_of("unknown")));
+}
+
+TEST(GroupMembershipIndexTest, ReusesSlotsOfRemovedGroups) {
+    std::vector<keeptower::AccountGroup> groups(1);
+    groups[0].set_group_id("a");
+    std::vector<keeptower::AccountRecord> accounts(2);
+    accounts[1].add_groups()->set_group_id("a");
+
+    GroupMembershipIndex index;
+    index.rebuild(groups, accounts);
+    const uint32_t slot = index.slot_of("a");
+    EXPECT_EQ(index.remove_group("a"), (std::vector<uint32_t>{1}));
+    EXPECT_FALSE(index.contains(1, slot));
+
+    EXPECT_EQ(index.add_group("c"), slot);
+    EXPECT_TRUE(index.members(slot).empty()) << "A reused slot starts empty";
+    EXPECT_TRUE(index.insert(0, slot));
+    EXPECT_FALSE(index.insert(0, slot));
+    EXPECT_TRUE(index.erase(0, slot));
+    EXPECT_FALSE(index.erase(0, slot));
+}
+
+TEST(IdPositionIndexTest, StaysConsistentThroughAppendsAndErases) {
+    const auto id_of = [](const keeptower::AccountGroup& group) -> const std::string& { return group.group_id(); };
+    std::vector<keeptower::AccountGroup> groups;
+    auto append = [&groups](const std::string& id) {
+        groups.emplace_back().set_group_id(id);
+    };
+
+    IdPositionIndex index;
+    for (const char* id : {"a", "b", "a", "c", "d"}) {
+        append(id);
+    }
+    EXPECT_EQ(index.lookup(groups, "a", id_of), 0u);
+    EXPECT_TRUE(index.consistent_with(groups, id_of));
+
+    append("e");
+    index.appended(groups, id_of);
+    EXPECT_TRUE(index.consistent_with(groups, id_of));
+
+    for (const size_t position : {0u, 2u, 0u}) {
+        const std::string erased = groups[position].group_id();
+        groups.erase(groups.begin() + static_cast<std::ptrdiff_t>(position));
+        index.erased(groups, position, erased, id_of);
+        EXPECT_TRUE(index.valid());
+        EXPECT_TRUE(index.consistent_with(groups, id_of)) << "after erasing " << erased;
+    }
+    EXPECT_EQ(index.lookup(groups, "a", id_of), 0u);
+    EXPECT_EQ(index.lookup(groups, "e", id_of), 2u);
+
+    // An append it was not told about makes the next report resync
+    append("f");
+    append("g");
+    index.appended(groups, id_of);
+    EXPECT_FALSE(index.valid());
+    EXPECT_EQ(index.lookup(groups, "g", id_of), 4u);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
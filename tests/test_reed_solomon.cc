@@ -3,8 +3,10 @@
 
 #include <gtest/gtest.h>
 #include "../src/lib/fec/ReedSolomon.h"
+#include "../src/lib/fec/RsCodec.h"
 #include <algorithm>
 #include <random>
+#include <set>
 
 /**
  * @brief Test fixture for Reed-Solomon operations
@@ -629,6 +631,240 @@ TEST_F(ReedSolomonTest, EncodedDataMetadata) {
     EXPECT_GE(encoded->num_data_blocks, expected_blocks);
 }
 
+/**
+ * @brief Test that the parity length follows the redundancy setting
+ */
+TEST_F(ReedSolomonTest, ParityLengthFollowsRedundancy) {
+    std::vector<uint8_t> data(64 * 1024, 0x5A);
+
+    for (uint8_t redundancy : {5, 10, 20, 30, 50}) {
+        ReedSolomon rs_custom(redundancy);
+        auto encoded = rs_custom.encode(data);
+        ASSERT_TRUE(encoded.has_value());
+        EXPECT_EQ(encoded->parity_symbols, ReedSolomon::parity_symbols_for(redundancy));
+        EXPECT_EQ(encoded->parity_symbols % 2, 0u);
+        EXPECT_EQ(encoded->data.size(), rs_custom.calculate_encoded_size(data.size()));
+
+        // Overhead lands within a point of the setting (no block padding)
+        const double overhead = 100.0 * (encoded->data.size() - data.size()) / data.size();
+        EXPECT_NEAR(overhead, redundancy, 1.0) << "redundancy " << (int)redundancy;
+    }
+
+    // 5% is cheaper than the fixed RS(255,223) layout used to be
+    EXPECT_LT(ReedSolomon(5).calculate_encoded_size(data.size()), data.size() / 223 * 255);
+}
+
+/**
+ * @brief Test that interleaving spreads a contiguous burst over many codewords
+ */
+TEST_F(ReedSolomonTest, InterleavedBurstCorrection) {
+    std::vector<uint8_t> data(200 * 1024);
+    std::mt19937 rng(7);
+    for (auto& b : data) {
+        b = static_cast<uint8_t>(rng());
+    }
+
+    size_t previous_burst = 0;
+    for (uint8_t redundancy : {5, 10, 20, 50}) {
+        ReedSolomon rs_custom(redundancy);
+        auto encoded = rs_custom.encode(data);
+        ASSERT_TRUE(encoded.has_value());
+        EXPECT_GT(encoded->interleave_depth, 1u);
+        EXPECT_LE(encoded->interleave_depth, ReedSolomon::MAX_INTERLEAVE_DEPTH);
+
+        // The longest burst every group survives grows with the setting
+        const size_t burst = encoded->interleave_depth * (encoded->parity_symbols / 2);
+        EXPECT_GT(burst, previous_burst);
+        previous_burst = burst;
+
+        auto damaged = encoded->data;
+        const size_t start = damaged.size() / 3;
+        for (size_t i = start; i < start + burst; ++i) {
+            damaged[i] = static_cast<uint8_t>(~damaged[i]);
+        }
+        auto decoded = ReedSolomon::decode(damaged, encoded->original_size,
+                                           encoded->parity_symbols, encoded->interleave_depth);
+        ASSERT_TRUE(decoded.has_value()) << "redundancy " << (int)redundancy << " burst " << burst;
+        EXPECT_EQ(*decoded, data);
+    }
+
+    // 50% survives a 4 KiB sector's worth of damage
+    EXPECT_GE(previous_burst, 4096u);
+}
+
+/**
+ * @brief Test that decoding uses the recorded parameters
+ */
+TEST_F(ReedSolomonTest, DecodeUsesRecordedParameters) {
+    std::vector<uint8_t> data(5000, 0x3C);
+    auto encoded = ReedSolomon(50).encode(data);
+    ASSERT_TRUE(encoded.has_value());
+
+    // A decoder configured for another setting still reads it
+    auto decoded = rs->decode(*encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, data);
+
+    auto mismatched = ReedSolomon::decode(encoded->data, encoded->original_size,
+                                          encoded->parity_symbols - 2, encoded->interleave_depth);
+    EXPECT_FALSE(mismatched.has_value());
+    EXPECT_FALSE(ReedSolomon::decode(encoded->data, encoded->original_size, 0, 1).has_value());
+}
+
+/**
+ * @brief Test that data written with the fixed RS(255,223) layout still decodes
+ */
+TEST_F(ReedSolomonTest, LegacyLayoutDecodes) {
+    std::vector<uint8_t> data(1000);
+    std::iota(data.begin(), data.end(), 0);
+
+    // Zero-padded RS(255,223) codewords back to back
+    std::vector<uint8_t> padded((data.size() + 222) / 223 * 223, 0);
+    std::copy(data.begin(), data.end(), padded.begin());
+    std::vector<uint8_t> legacy(padded.size() / 223 * 255);
+    ASSERT_TRUE(KeepTower::RsCodec(32).encode(padded, legacy));
+    legacy[10] ^= 0xFF;
+    legacy[300] ^= 0x0F;
+
+    auto decoded = ReedSolomon::decode_legacy(legacy, data.size());
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, data);
+}
+
+/**
+ * @brief Test that clean data decodes through the checksum fast path
+ */
+TEST_F(ReedSolomonTest, ChecksumsCoverEverySegment) {
+    std::vector<uint8_t> data(10000, 0x42);
+    auto encoded = rs->encode(data);
+    ASSERT_TRUE(encoded.has_value());
+    EXPECT_EQ(encoded->checksums.size(), ReedSolomon::checksum_count(encoded->data.size()));
+    EXPECT_EQ(encoded->data.size(), ReedSolomon::encoded_size(data.size(), encoded->parity_symbols));
+
+    auto decoded = rs->decode(*encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, data);
+
+    // A damaged checksum only costs erasures of intact symbols
+    encoded->checksums[0] ^= 1;
+    decoded = rs->decode(*encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, data);
+}
+
+/**
+ * @brief Test that checksum-located damage is decoded as erasures
+ */
+TEST_F(ReedSolomonTest, ChecksumErasuresDoubleBurstCapacity) {
+    std::vector<uint8_t> data(200 * 1024);
+    std::mt19937 rng(9);
+    for (auto& b : data) {
+        b = static_cast<uint8_t>(rng());
+    }
+
+    ReedSolomon rs20(20);
+    auto encoded = rs20.encode(data);
+    ASSERT_TRUE(encoded.has_value());
+
+    // 1.7x the longest burst unlocated-error decoding can take
+    const size_t burst = encoded->interleave_depth * encoded->parity_symbols / 2 * 17 / 10;
+    const size_t start = encoded->data.size() / 2;
+    for (size_t i = start; i < start + burst; ++i) {
+        encoded->data[i] = static_cast<uint8_t>(~encoded->data[i]);
+    }
+
+    auto decoded = rs20.decode(*encoded);
+    ASSERT_TRUE(decoded.has_value()) << "burst " << burst;
+    EXPECT_EQ(*decoded, data);
+
+    auto without_checksums = ReedSolomon::decode(encoded->data, encoded->original_size,
+                                                 encoded->parity_symbols, encoded->interleave_depth);
+    EXPECT_FALSE(without_checksums.has_value());
+}
+
+/**
+ * @brief Test that splitting the work across threads changes nothing
+ */
+TEST_F(ReedSolomonTest, ThreadedMatchesSerial) {
+    // Enough codewords for several workers, with a shortened last group
+    std::vector<uint8_t> data(4 * 1024 * 1024 + 12345);
+    std::mt19937 rng(17);
+    for (auto& b : data) {
+        b = static_cast<uint8_t>(rng());
+    }
+
+    ReedSolomon serial(10);
+    serial.set_max_threads(1);
+    ReedSolomon threaded(10);
+    threaded.set_max_threads(4);
+    EXPECT_EQ(threaded.get_max_threads(), 4u);
+
+    auto expected = serial.encode(data);
+    auto encoded = threaded.encode(data);
+    ASSERT_TRUE(expected.has_value());
+    ASSERT_TRUE(encoded.has_value());
+    EXPECT_EQ(encoded->data, expected->data);
+    EXPECT_EQ(encoded->checksums, expected->checksums);
+
+    for (size_t i = 0; i < encoded->data.size(); i += 50000) {
+        encoded->data[i] ^= 0xA5;
+    }
+    auto decoded = threaded.decode(*encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, data);
+
+    auto full = ReedSolomon::decode(encoded->data, encoded->original_size, encoded->parity_symbols,
+                                    encoded->interleave_depth, {}, nullptr, 4);
+    ASSERT_TRUE(full.has_value());
+    EXPECT_EQ(*full, data);
+}
+
+/**
+ * @brief Test that decode reports what it repaired in each codeword
+ */
+TEST_F(ReedSolomonTest, ReportsPerBlockCorrections) {
+    // Whole codewords, so every symbol row holds one byte per codeword
+    std::vector<uint8_t> data(80 * (255 - rs->get_parity_symbols()));
+    std::iota(data.begin(), data.end(), 0);
+    auto encoded = rs->encode(data);
+    ASSERT_TRUE(encoded.has_value());
+
+    auto decoded = rs->decode(*encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(encoded->corrections.corrected_per_block.size(), encoded->num_data_blocks);
+    EXPECT_EQ(encoded->corrections.corrected_symbols, 0u);
+    EXPECT_EQ(encoded->corrections.repaired_blocks, 0u);
+
+    // Stored byte i * depth + c is symbol i of codeword c
+    const size_t depth = encoded->interleave_depth;
+    ASSERT_GT(depth, 9u);
+    const size_t offsets[] = {0 * depth + 3, 5 * depth + 3, 7 * depth + 9};
+    encoded->data[offsets[0]] ^= 0x11;
+    encoded->data[offsets[1]] ^= 0x22;
+    encoded->data[offsets[2]] ^= 0x33;
+    std::set<size_t> segments;
+    for (size_t offset : offsets) {
+        segments.insert(offset / ReedSolomon::CHECKSUM_SEGMENT_SIZE);
+    }
+
+    decoded = rs->decode(*encoded);
+    ASSERT_TRUE(decoded.has_value());
+    EXPECT_EQ(*decoded, data);
+    const auto& stats = encoded->corrections;
+    EXPECT_EQ(stats.corrected_per_block[3], 2);
+    EXPECT_EQ(stats.corrected_per_block[9], 1);
+    EXPECT_EQ(stats.corrected_symbols, 3u);
+    EXPECT_EQ(stats.repaired_blocks, 2u);
+    EXPECT_EQ(stats.damaged_segments, segments.size());
+
+    // Without checksums the errors are located the slow way, same tally
+    ReedSolomon::CorrectionStats full;
+    ASSERT_TRUE(ReedSolomon::decode(encoded->data, encoded->original_size, encoded->parity_symbols,
+                                    encoded->interleave_depth, {}, &full).has_value());
+    EXPECT_EQ(full.corrected_per_block, stats.corrected_per_block);
+    EXPECT_EQ(full.damaged_segments, 0u);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
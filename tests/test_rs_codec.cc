@@ -0,0 +1,295 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+/**
+ * @file test_rs_codec.cc
+ * @brief Unit tests for the in-tree RS(255,k) codec, its SIMD kernels and CRC-32C
+ */
+
+#include <gtest/gtest.h>
+#include "../src/lib/fec/Crc32c.h"
+#include "../src/lib/fec/GF256.h"
+#include "../src/lib/fec/RsCodec.h"
+
+#ifdef KEEPTOWER_HAVE_LIBCORRECT
+extern "C" {
+#include <correct.h>
+}
+#endif
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace KeepTower;
+
+namespace {
+
+constexpr size_t PARITY = 32;
+constexpr size_t DATA = RsCodec::BLOCK_SIZE - PARITY;
+
+std::vector<uint8_t> random_bytes(size_t size, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> bytes(size);
+    for (auto& b : bytes) {
+        b = static_cast<uint8_t>(rng());
+    }
+    return bytes;
+}
+
+std::vector<RsCodec::Kernel> supported_kernels() {
+    std::vector<RsCodec::Kernel> kernels;
+    for (auto kernel : {RsCodec::Kernel::Scalar, RsCodec::Kernel::Ssse3, RsCodec::Kernel::Avx2}) {
+        if (RsCodec::kernel_supported(kernel)) {
+            kernels.push_back(kernel);
+        }
+    }
+    return kernels;
+}
+
+// c(a^j) with codeword[0] as the x^254 coefficient, evaluated without the codec
+uint8_t evaluate(const uint8_t* codeword, uint8_t point) {
+    uint8_t value = 0;
+    for (size_t i = 0; i < RsCodec::BLOCK_SIZE; ++i) {
+        value = gf256::mul(value, point) ^ codeword[i];
+    }
+    return value;
+}
+
+}  // namespace
+
+TEST(GF256Test, TablesDescribeTheCcsdsField) {
+    std::set<uint8_t> elements;
+    for (size_t i = 0; i < gf256::FIELD_ORDER; ++i) {
+        elements.insert(gf256::exp(i));
+        EXPECT_EQ(gf256::log(gf256::exp(i)), i);
+    }
+    EXPECT_EQ(elements.size(), gf256::FIELD_ORDER);
+    EXPECT_EQ(elements.count(0), 0u);
+
+    for (unsigned a = 0; a < 256; ++a) {
+        for (unsigned x = 0; x < 256; x += 7) {
+            const auto& row = gf256::NIBBLE_TABLES.rows[a];
+            EXPECT_EQ(row[x & 15] ^ row[16 + (x >> 4)], gf256::mul(a, x));
+        }
+        if (a != 0) {
+            EXPECT_EQ(gf256::mul(gf256::div(1, a), a), 1);
+        }
+    }
+}
+
+TEST(RsCodecTest, ParityMatchesReferenceVector) {
+    std::vector<uint8_t> message(DATA);
+    for (size_t i = 0; i < DATA; ++i) {
+        message[i] = static_cast<uint8_t>(i * 37 + 11);
+    }
+    const std::vector<uint8_t> expected_parity = {
+        0x90, 0x32, 0x4f, 0x33, 0xa0, 0x74, 0xb9, 0x18, 0x53, 0xa7, 0x82, 0x7d, 0x15, 0x25, 0x46, 0x08,
+        0xb8, 0x96, 0x75, 0x71, 0x08, 0x98, 0x29, 0x3e, 0xcf, 0xb6, 0x0f, 0xd8, 0x30, 0xe3, 0xfb, 0xf5};
+
+    for (auto kernel : supported_kernels()) {
+        RsCodec codec(PARITY, kernel);
+        std::vector<uint8_t> codeword(RsCodec::BLOCK_SIZE);
+        ASSERT_TRUE(codec.encode(message, codeword));
+        EXPECT_TRUE(std::equal(message.begin(), message.end(), codeword.begin()));
+        EXPECT_TRUE(std::equal(expected_parity.begin(), expected_parity.end(), codeword.begin() + DATA))
+            << "kernel " << static_cast<int>(kernel);
+    }
+}
+
+TEST(RsCodecTest, CodewordsVanishAtGeneratorRoots) {
+    for (size_t parity : {2u, 16u, 32u, 64u, 100u}) {
+        RsCodec codec(parity);
+        const auto data = random_bytes(3 * codec.data_symbols(), static_cast<uint32_t>(parity));
+        std::vector<uint8_t> codewords(3 * RsCodec::BLOCK_SIZE);
+        ASSERT_TRUE(codec.encode(data, codewords));
+        for (size_t block = 0; block < 3; ++block) {
+            for (size_t root = 1; root <= parity; ++root) {
+                EXPECT_EQ(evaluate(codewords.data() + block * RsCodec::BLOCK_SIZE, gf256::exp(root)), 0)
+                    << "parity " << parity << " root " << root;
+            }
+        }
+    }
+}
+
+TEST(RsCodecTest, KernelsProduceIdenticalCodewords) {
+    // 70 codewords: two full SIMD batches and a partial one
+    const auto data = random_bytes(70 * DATA, 1);
+    std::vector<uint8_t> reference(70 * RsCodec::BLOCK_SIZE);
+    ASSERT_TRUE(RsCodec(PARITY, RsCodec::Kernel::Scalar).encode(data, reference));
+
+    for (auto kernel : supported_kernels()) {
+        RsCodec codec(PARITY, kernel);
+        EXPECT_EQ(codec.kernel(), kernel);
+        std::vector<uint8_t> codewords(reference.size());
+        ASSERT_TRUE(codec.encode(data, codewords));
+        EXPECT_EQ(codewords, reference) << "kernel " << static_cast<int>(kernel);
+    }
+}
+
+TEST(RsCodecTest, CorrectsUpToHalfTheParityInEveryCodeword) {
+    std::mt19937 rng(2);
+    for (auto kernel : supported_kernels()) {
+        for (size_t parity : {8u, 32u, 50u}) {
+            RsCodec codec(parity, kernel);
+            const size_t k = codec.data_symbols();
+            const size_t count = 40;
+            const auto data = random_bytes(count * k, static_cast<uint32_t>(parity));
+            std::vector<uint8_t> codewords(count * RsCodec::BLOCK_SIZE);
+            ASSERT_TRUE(codec.encode(data, codewords));
+
+            // Leave every third codeword clean so both paths run in one batch
+            size_t injected = 0;
+            for (size_t block = 0; block < count; block += 3) {
+                std::vector<size_t> positions(RsCodec::BLOCK_SIZE);
+                std::iota(positions.begin(), positions.end(), 0);
+                std::shuffle(positions.begin(), positions.end(), rng);
+                const size_t errors = 1 + block % (parity / 2);
+                for (size_t e = 0; e < errors; ++e) {
+                    codewords[block * RsCodec::BLOCK_SIZE + positions[e]] ^= static_cast<uint8_t>(1 + rng() % 255);
+                }
+                injected += errors;
+            }
+
+            std::vector<uint8_t> decoded(count * k);
+            const auto corrected = codec.decode(codewords, decoded);
+            ASSERT_TRUE(corrected.has_value()) << "kernel " << static_cast<int>(kernel) << " parity " << parity;
+            EXPECT_EQ(*corrected, injected);
+            EXPECT_EQ(decoded, data);
+        }
+    }
+}
+
+TEST(RsCodecTest, RejectsCodewordsBeyondCapacity) {
+    RsCodec codec(PARITY);
+    const auto data = random_bytes(DATA, 3);
+    std::vector<uint8_t> codeword(RsCodec::BLOCK_SIZE);
+    ASSERT_TRUE(codec.encode(data, codeword));
+
+    for (size_t i = 0; i < PARITY / 2 + 1; ++i) {
+        codeword[i * 7] ^= 0xA5;
+    }
+    std::vector<uint8_t> decoded(DATA);
+    const auto corrected = codec.decode(codeword, decoded);
+    // A wrong codeword may lie within reach, but the original cannot
+    if (corrected.has_value()) {
+        EXPECT_NE(decoded, data);
+    }
+}
+
+TEST(RsCodecTest, RejectsMismatchedBufferSizes) {
+    RsCodec codec(PARITY);
+    std::vector<uint8_t> data(DATA * 2);
+    std::vector<uint8_t> codewords(RsCodec::BLOCK_SIZE * 2);
+    EXPECT_FALSE(codec.encode(std::span<const uint8_t>(data).first(DATA), codewords));
+    EXPECT_FALSE(codec.decode(std::span<const uint8_t>(codewords).first(300), data).has_value());
+    EXPECT_THROW(RsCodec(0), std::invalid_argument);
+    EXPECT_THROW(RsCodec(RsCodec::BLOCK_SIZE), std::invalid_argument);
+    EXPECT_EQ(&RsCodec::shared(PARITY), &RsCodec::shared(PARITY));
+}
+
+TEST(RsCodecTest, ErasuresCostHalfAnError) {
+    std::mt19937 rng(5);
+    RsCodec codec(PARITY);
+    const auto data = random_bytes(DATA, 6);
+    std::vector<uint8_t> original(RsCodec::BLOCK_SIZE);
+    ASSERT_TRUE(codec.encode(data, original));
+
+    // (erasures, errors) pairs on the 2e + s <= n boundary
+    for (auto [erasure_count, error_count] : {std::pair<size_t, size_t>{PARITY, 0},
+                                              {PARITY - 2, 1},
+                                              {PARITY / 2, PARITY / 4},
+                                              {1, PARITY / 2 - 1}}) {
+        std::vector<size_t> positions(RsCodec::BLOCK_SIZE);
+        std::iota(positions.begin(), positions.end(), 0);
+        std::shuffle(positions.begin(), positions.end(), rng);
+
+        auto codeword = original;
+        std::vector<uint8_t> erasures;
+        for (size_t e = 0; e < erasure_count + error_count; ++e) {
+            codeword[positions[e]] ^= static_cast<uint8_t>(1 + rng() % 255);
+            if (e < erasure_count) {
+                erasures.push_back(static_cast<uint8_t>(positions[e]));
+            }
+        }
+
+        const auto fixed = codec.correct_erasures(codeword, erasures);
+        ASSERT_TRUE(fixed.has_value()) << erasure_count << " erasures, " << error_count << " errors";
+        EXPECT_EQ(*fixed, erasure_count + error_count);
+        EXPECT_EQ(codeword, original);
+    }
+
+    // Flagged symbols that are actually intact change nothing
+    auto clean = original;
+    const std::vector<uint8_t> spurious = {0, 17, 254};
+    clean[40] ^= 0x33;
+    const auto fixed = codec.correct_erasures(clean, spurious);
+    ASSERT_TRUE(fixed.has_value());
+    EXPECT_EQ(*fixed, 1u);
+    EXPECT_EQ(clean, original);
+
+    // Without the erasure positions the same damage is out of reach
+    auto damaged = original;
+    for (size_t i = 0; i < PARITY; ++i) {
+        damaged[i * 3] ^= 0x5A;
+    }
+    const auto unlocated = codec.correct_erasures(damaged, {});
+    EXPECT_TRUE(!unlocated.has_value() || damaged != original);
+}
+
+TEST(Crc32cTest, MatchesCastagnoliReference) {
+    const std::string check = "123456789";
+    EXPECT_EQ(crc32c(std::span(reinterpret_cast<const uint8_t*>(check.data()), check.size())), 0xE3069283u);
+    EXPECT_EQ(crc32c({}), 0u);
+
+    // Bitwise reference over every length around the 8-byte stride
+    const auto bytes = random_bytes(300, 7);
+    for (size_t length = 0; length <= bytes.size(); length += 13) {
+        uint32_t crc = ~0u;
+        for (size_t i = 0; i < length; ++i) {
+            crc ^= bytes[i];
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? 0x82F63B78u : 0u);
+            }
+        }
+        EXPECT_EQ(crc32c(std::span<const uint8_t>(bytes).first(length)), ~crc) << "length " << length;
+    }
+}
+
+#ifdef KEEPTOWER_HAVE_LIBCORRECT
+TEST(RsCodecTest, BitCompatibleWithLibcorrect) {
+    correct_reed_solomon* reference = correct_reed_solomon_create(
+        correct_rs_primitive_polynomial_ccsds, 1, 1, PARITY);
+    ASSERT_NE(reference, nullptr);
+
+    const size_t count = 50;
+    const auto data = random_bytes(count * DATA, 4);
+    std::vector<uint8_t> expected(count * RsCodec::BLOCK_SIZE);
+    for (size_t block = 0; block < count; ++block) {
+        ASSERT_EQ(correct_reed_solomon_encode(reference, data.data() + block * DATA, DATA,
+                                              expected.data() + block * RsCodec::BLOCK_SIZE),
+                  static_cast<ssize_t>(RsCodec::BLOCK_SIZE));
+    }
+
+    for (auto kernel : supported_kernels()) {
+        RsCodec codec(PARITY, kernel);
+        std::vector<uint8_t> codewords(expected.size());
+        ASSERT_TRUE(codec.encode(data, codewords));
+        EXPECT_EQ(codewords, expected);
+
+        // Codewords written by libcorrect decode, including repairs
+        auto damaged = expected;
+        damaged[5] ^= 0xFF;
+        damaged[RsCodec::BLOCK_SIZE + 250] ^= 0x01;
+        std::vector<uint8_t> decoded(data.size());
+        ASSERT_TRUE(codec.decode(damaged, decoded).has_value());
+        EXPECT_EQ(decoded, data);
+    }
+    correct_reed_solomon_destroy(reference);
+}
+#endif
@@ -8,6 +8,9 @@
 
 #include <gtest/gtest.h>
 #include "../src/ui/controllers/SearchController.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
 #include <vector>
 
 /**
@@ -397,3 +400,331 @@ TEST_F(SearchControllerTest, Copyable) {
 
     EXPECT_EQ(results1.size(), results2.size());
 }
+
+// ============================================================================
+// Search index
+// ============================================================================
+
+namespace {
+
+using KeepTower::AccountSearchIndex;
+
+keeptower::AccountRecord indexed_account(const std::string& id, const std::string& name,
+                                         const std::string& notes = "") {
+    keeptower::AccountRecord account;
+    account.set_id(id);
+    account.set_account_name(name);
+    account.set_notes(notes);
+    return account;
+}
+
+std::vector<std::string> candidate_ids(const AccountSearchIndex& index, std::string_view query,
+                                       uint8_t fields = AccountSearchIndex::ALL_FIELDS,
+                                       size_t max_missing = 0) {
+    std::vector<std::string> ids;
+    for (const uint32_t slot : index.candidates(query, fields, max_missing)) {
+        ids.emplace_back(index.id_of(slot));
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+std::vector<std::string> result_ids(const std::vector<keeptower::AccountRecord>& accounts) {
+    std::vector<std::string> ids;
+    for (const auto& account : accounts) {
+        ids.push_back(account.id());
+    }
+    return ids;
+}
+
+/// Accounts built from a fixed vocabulary of random words, like a large vault
+std::vector<keeptower::AccountRecord> generated_accounts(size_t count) {
+    static constexpr const char* tags[] = {"work", "personal", "finance", "social", "shopping", "dev"};
+    uint32_t state = 12345;
+    auto next = [&state]() { state = state * 1664525u + 1013904223u; return state >> 8; };
+
+    std::vector<std::string> vocabulary(20000);
+    for (auto& word : vocabulary) {
+        const uint32_t length = 4 + next() % 7;
+        for (uint32_t i = 0; i < length; ++i) {
+            word.push_back(static_cast<char>('a' + next() % 26));
+        }
+    }
+    auto word = [&]() -> const std::string& { return vocabulary[next() % vocabulary.size()]; };
+
+    std::vector<keeptower::AccountRecord> accounts;
+    accounts.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        keeptower::AccountRecord account;
+        const std::string site = word();
+        const std::string user = word();
+        account.set_id("acct-" + std::to_string(i));
+        account.set_account_name(site + " " + word());
+        account.set_user_name(user + std::to_string(next() % 1000));
+        account.set_email(user + "@" + word() + ".com");
+        account.set_website("https://" + site + ".example");
+        account.set_notes(word() + " " + word() + " " + word() + " " + word());
+        account.add_tags(tags[next() % std::size(tags)]);
+        accounts.push_back(std::move(account));
+    }
+    return accounts;
+}
+
+}  // namespace
+
+TEST(AccountSearchIndexTest, CandidatesCoverSubstringMatchesInRequestedFields) {
+    AccountSearchIndex index;
+    std::vector<keeptower::AccountRecord> accounts = {
+        indexed_account("a", "GitHub Work", "code"),
+        indexed_account("b", "Gmail", "github mirror"),
+        indexed_account("c", "Bank"),
+    };
+    index.rebuild(accounts);
+
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(index.slot_of("b"), 1u);
+    EXPECT_EQ(candidate_ids(index, "GITHUB"), (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(candidate_ids(index, "github", AccountSearchIndex::ACCOUNT_NAME), (std::vector<std::string>{"a"}));
+    EXPECT_EQ(candidate_ids(index, "github", AccountSearchIndex::NOTES), (std::vector<std::string>{"b"}));
+    EXPECT_TRUE(candidate_ids(index, "gitlab").empty());
+    EXPECT_TRUE(candidate_ids(index, "").empty());
+}
+
+TEST(AccountSearchIndexTest, ShortQueriesMatchTrigramsContainingThem) {
+    AccountSearchIndex index;
+    std::vector<keeptower::AccountRecord> accounts = {
+        indexed_account("a", "X"),
+        indexed_account("b", "ox"),
+        indexed_account("c", "Bank"),
+    };
+    index.rebuild(accounts);
+
+    EXPECT_EQ(AccountSearchIndex::trigram_count("ox"), 0u);
+    EXPECT_EQ(candidate_ids(index, "x"), (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(candidate_ids(index, "OX"), (std::vector<std::string>{"b"}));
+    EXPECT_EQ(candidate_ids(index, "an"), (std::vector<std::string>{"c"}));
+}
+
+TEST(AccountSearchIndexTest, MaxMissingKeepsAccountsSharingSomeTrigrams) {
+    AccountSearchIndex index;
+    std::vector<keeptower::AccountRecord> accounts = {
+        indexed_account("a", "GitHub"),
+        indexed_account("b", "Bank"),
+    };
+    index.rebuild(accounts);
+
+    // "gitub" has git/itu/tub; only "git" is in GitHub
+    EXPECT_EQ(AccountSearchIndex::trigram_count("gitub"), 3u);
+    EXPECT_TRUE(candidate_ids(index, "gitub").empty());
+    EXPECT_TRUE(candidate_ids(index, "gitub", AccountSearchIndex::ALL_FIELDS, 1).empty());
+    EXPECT_EQ(candidate_ids(index, "gitub", AccountSearchIndex::ALL_FIELDS, 2), (std::vector<std::string>{"a"}));
+    EXPECT_EQ(candidate_ids(index, "gitub", AccountSearchIndex::ALL_FIELDS, 10), (std::vector<std::string>{"a"}));
+}
+
+TEST(AccountSearchIndexTest, UpsertAndRemoveUpdateOnlyThatAccount) {
+    AccountSearchIndex index;
+    index.upsert(indexed_account("a", "Netflix"));
+    index.upsert(indexed_account("b", "Bank"));
+
+    // Update replaces the old text
+    EXPECT_EQ(index.upsert(indexed_account("a", "Hulu")), 0u);
+    EXPECT_TRUE(candidate_ids(index, "netflix").empty());
+    EXPECT_EQ(candidate_ids(index, "hulu"), (std::vector<std::string>{"a"}));
+
+    // Removal frees the slot for the next account
+    EXPECT_TRUE(index.remove("a"));
+    EXPECT_FALSE(index.remove("a"));
+    EXPECT_EQ(index.slot_of("a"), AccountSearchIndex::NO_SLOT);
+    EXPECT_TRUE(candidate_ids(index, "hulu").empty());
+    EXPECT_EQ(index.upsert(indexed_account("c", "Hulu Kids")), 0u);
+    EXPECT_EQ(candidate_ids(index, "hulu"), (std::vector<std::string>{"c"}));
+    EXPECT_EQ(index.size(), 2u);
+
+    index.clear();
+    EXPECT_EQ(index.size(), 0u);
+    EXPECT_EQ(index.trigram_total(), 0u);
+}
+
+TEST(AccountSearchIndexTest, SyncFollowsTheAccountList) {
+    AccountSearchIndex index;
+    std::vector<keeptower::AccountRecord> accounts = {
+        indexed_account("a", "Netflix"),
+        indexed_account("b", "Bank"),
+        indexed_account("c", "Gmail"),
+    };
+    index.sync(accounts);
+
+    accounts.erase(accounts.begin() + 1);
+    accounts[0].set_account_name("Netflix Family");
+    accounts.push_back(indexed_account("d", "Bank of Nowhere"));
+    const auto slots = index.sync(accounts);
+
+    ASSERT_EQ(slots.size(), 3u);
+    for (size_t i = 0; i < accounts.size(); ++i) {
+        EXPECT_EQ(index.id_of(slots[i]), accounts[i].id());
+    }
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(candidate_ids(index, "bank"), (std::vector<std::string>{"d"}));
+    EXPECT_EQ(candidate_ids(index, "family"), (std::vector<std::string>{"a"}));
+}
+
+TEST_F(SearchControllerTest, IndexedFilterMatchesFullScan) {
+    SearchController indexed;
+    indexed.index_accounts(test_accounts);
+
+    for (const char* text : {"gmail", "john", "com", "infra", "gitub", "zzzz", "GitHub", "wo"}) {
+        for (const auto field : {SearchField::ALL, SearchField::ACCOUNT_NAME, SearchField::EMAIL,
+                                 SearchField::NOTES, SearchField::TAGS}) {
+            SearchCriteria criteria;
+            criteria.search_text = text;
+            criteria.field_filter = field;
+            criteria.fuzzy_threshold = 20;
+            EXPECT_EQ(result_ids(indexed.filter_accounts(test_accounts, criteria)),
+                      result_ids(controller->filter_accounts(test_accounts, criteria)))
+                << text << " in field " << static_cast<int>(field);
+        }
+    }
+}
+
+TEST_F(SearchControllerTest, IndexFollowsIncrementalChanges) {
+    controller->index_accounts(test_accounts);
+
+    SearchCriteria criteria;
+    criteria.search_text = "disney";
+
+    keeptower::AccountRecord added;
+    added.set_id("5");
+    added.set_account_name("Disney Plus");
+    test_accounts.push_back(added);
+    controller->index_account(added);
+    ASSERT_EQ(controller->filter_accounts(test_accounts, criteria).size(), 1u);
+
+    test_accounts.back().set_account_name("Hulu");
+    controller->index_account(test_accounts.back());
+    EXPECT_TRUE(controller->filter_accounts(test_accounts, criteria).empty());
+    criteria.search_text = "hulu";
+    EXPECT_EQ(controller->filter_accounts(test_accounts, criteria).size(), 1u);
+
+    test_accounts.erase(test_accounts.begin());
+    controller->unindex_account("1");
+    criteria.search_text = "gmail";
+    criteria.field_filter = SearchField::ACCOUNT_NAME;
+    EXPECT_TRUE(controller->filter_accounts(test_accounts, criteria).empty());
+    EXPECT_EQ(controller->search_index().size(), test_accounts.size());
+}
+
+TEST_F(SearchControllerTest, StaleIndexFallsBackToScanning) {
+    controller->index_accounts(test_accounts);
+
+    keeptower::AccountRecord unindexed;
+    unindexed.set_id("5");
+    unindexed.set_account_name("Disney Plus");
+    test_accounts.push_back(unindexed);
+
+    SearchCriteria criteria;
+    criteria.search_text = "disney";
+    EXPECT_EQ(controller->filter_accounts(test_accounts, criteria).size(), 1u);
+
+    controller->clear_index();
+    EXPECT_EQ(controller->search_index().size(), 0u);
+    EXPECT_EQ(controller->filter_accounts(test_accounts, criteria).size(), 1u);
+}
+
+TEST(SearchControllerIndexTest, GeneratedVaultFindsTheSameSubstringMatches) {
+    const auto accounts = generated_accounts(2000);
+    SearchController scanning;
+    SearchController indexed;
+    indexed.index_accounts(accounts);
+
+    const std::string name = accounts[17].account_name();
+    const std::string user = accounts[500].user_name();
+    for (const std::string& text : {name.substr(0, 4), name, user.substr(1, 3), std::string("example"),
+                                    std::string("finance"), std::string("@"), user.substr(0, 2),
+                                    std::string("zzzz")}) {
+        SearchCriteria criteria;
+        criteria.search_text = text;
+        criteria.fuzzy_threshold = 75;  // Substring matches only
+        EXPECT_EQ(result_ids(indexed.filter_accounts(accounts, criteria)),
+                  result_ids(scanning.filter_accounts(accounts, criteria)))
+            << text;
+    }
+
+    // Typo matches are the scan's, at thresholds the index narrows and at ones it cannot
+    for (const int threshold : {30, 60}) {
+        SearchCriteria fuzzy;
+        fuzzy.search_text = "finanse";
+        fuzzy.fuzzy_threshold = threshold;
+        const auto found = result_ids(indexed.filter_accounts(accounts, fuzzy));
+        EXPECT_FALSE(found.empty()) << threshold;
+        EXPECT_EQ(found, result_ids(scanning.filter_accounts(accounts, fuzzy))) << threshold;
+    }
+}
+
+TEST_F(SearchControllerTest, IndexKeepsTypoMatchesTheTrigramsMiss) {
+    test_accounts.clear();
+    for (const char* name : {"ac", "aXbXcXdXeXf", "unrelated"}) {
+        keeptower::AccountRecord account;
+        account.set_id(name);
+        account.set_account_name(name);
+        test_accounts.push_back(account);
+    }
+    controller->index_accounts(test_accounts);
+
+    // Too short for a trigram: "ac" scores 35 against "ab"
+    SearchCriteria criteria;
+    criteria.search_text = "ab";
+    criteria.field_filter = SearchField::ACCOUNT_NAME;
+    EXPECT_EQ(result_ids(controller->filter_accounts(test_accounts, criteria)),
+              (std::vector<std::string>{"ac"}));
+
+    // Five insertions share no trigram with the query but still score 38
+    criteria.search_text = "abcdef";
+    EXPECT_EQ(result_ids(controller->filter_accounts(test_accounts, criteria)),
+              (std::vector<std::string>{"aXbXcXdXeXf"}));
+
+    // Substring-only thresholds still narrow through the index
+    criteria.fuzzy_threshold = 75;
+    EXPECT_TRUE(controller->filter_accounts(test_accounts, criteria).empty());
+}
+
+TEST(SearchControllerIndexTest, Performance_SearchHundredThousandAccounts) {
+    const auto accounts = generated_accounts(100000);
+    SearchController controller;
+
+    auto start = std::chrono::steady_clock::now();
+    controller.index_accounts(accounts);
+    const auto build = std::chrono::steady_clock::now() - start;
+
+    const std::string site = accounts[4242].account_name().substr(0, accounts[4242].account_name().find(' '));
+    const std::string user = accounts[90000].user_name();
+    double worst_ms = 0.0;
+    // Typo-tolerant thresholds score every account; the index serves substring search
+    for (const std::string& text : {site, site.substr(0, 3), site.substr(0, 2) + site.substr(3),
+                                    user, std::string("gmail")}) {
+        SearchCriteria criteria;
+        criteria.search_text = text;
+        criteria.fuzzy_threshold = 75;
+        start = std::chrono::steady_clock::now();
+        const auto results = controller.filter_accounts(accounts, criteria);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        worst_ms = std::max(worst_ms, ms);
+        std::cout << "  \"" << text << "\": " << results.size() << " results in " << ms << " ms" << std::endl;
+    }
+
+    // The same search without the index scores every account
+    SearchController scanning;
+    SearchCriteria criteria;
+    criteria.search_text = site;
+    criteria.fuzzy_threshold = 75;
+    start = std::chrono::steady_clock::now();
+    const auto scanned = scanning.filter_accounts(accounts, criteria);
+    const double scan_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "  Index of 100000 accounts built in "
+              << std::chrono::duration<double, std::milli>(build).count() << " ms, "
+              << controller.search_index().trigram_total() << " trigrams" << std::endl;
+    std::cout << "  Slowest indexed search: " << worst_ms << " ms (full scan: " << scan_ms << " ms)" << std::endl;
+
+    EXPECT_FALSE(scanned.empty());
+    EXPECT_LT(worst_ms, scan_ms);
+}
@@ -11,7 +11,9 @@
 
 #include <gtest/gtest.h>
 #include "../src/lib/crypto/VaultCrypto.h"
+#include "../src/lib/crypto/AesGcmContext.h"
 #include <algorithm>
+#include <array>
 #include <cstring>
 
 using namespace KeepTower;
@@ -382,6 +384,81 @@ TEST_F(VaultCryptoTest, DecryptDataWithLargeCiphertext) {
     EXPECT_EQ(decrypted, large_plaintext);
 }
 
+// ============================================================================
+// In-Place Seal/Open Tests
+// ============================================================================
+
+TEST_F(VaultCryptoTest, SealInPlaceMatchesEncryptData) {
+    std::vector<uint8_t> expected;
+    ASSERT_TRUE(VaultCrypto::encrypt_data(test_plaintext, test_key, expected, test_iv));
+
+    std::vector<uint8_t> data = test_plaintext;
+    std::array<uint8_t, VaultCrypto::TAG_LENGTH> tag{};
+    ASSERT_TRUE(VaultCrypto::seal(data, test_key, test_iv, tag));
+    data.insert(data.end(), tag.begin(), tag.end());
+    EXPECT_EQ(data, expected);
+
+    data.resize(test_plaintext.size());
+    ASSERT_TRUE(VaultCrypto::open(data, test_key, test_iv, tag));
+    EXPECT_EQ(data, test_plaintext);
+}
+
+TEST_F(VaultCryptoTest, OpenFailureCleansBufferAndChecksAad) {
+    const std::vector<uint8_t> aad = {'r', 'e', 'c', '1'};
+    std::vector<uint8_t> data = test_plaintext;
+    std::array<uint8_t, VaultCrypto::TAG_LENGTH> tag{};
+    ASSERT_TRUE(VaultCrypto::seal(data, test_key, test_iv, tag, aad));
+    const auto sealed = data;
+
+    const std::vector<uint8_t> other_aad = {'r', 'e', 'c', '2'};
+    EXPECT_FALSE(VaultCrypto::open(data, test_key, test_iv, tag, other_aad));
+    EXPECT_TRUE(std::all_of(data.begin(), data.end(), [](uint8_t b) { return b == 0; }));
+
+    data = sealed;
+    EXPECT_TRUE(VaultCrypto::open(data, test_key, test_iv, tag, aad));
+    EXPECT_EQ(data, test_plaintext);
+
+    std::array<uint8_t, 8> short_tag{};
+    EXPECT_FALSE(VaultCrypto::seal(data, test_key, test_iv, short_tag));
+}
+
+TEST_F(VaultCryptoTest, ContextReusesKeyAcrossManyRecords) {
+    AesGcmContext ctx(test_key);
+    ASSERT_TRUE(ctx.is_valid());
+    EXPECT_FALSE(AesGcmContext(std::vector<uint8_t>(16)).is_valid());
+
+    struct Record {
+        std::vector<uint8_t> iv;
+        std::vector<uint8_t> data;
+        std::array<uint8_t, VaultCrypto::TAG_LENGTH> tag{};
+    };
+    std::vector<Record> records(64);
+    for (size_t i = 0; i < records.size(); ++i) {
+        records[i].iv = VaultCrypto::generate_random_bytes(VaultCrypto::IV_LENGTH);
+        records[i].data.assign(i * 7, static_cast<uint8_t>(i));
+        ASSERT_TRUE(ctx.seal(records[i].iv, records[i].data, records[i].tag));
+    }
+
+    // Records sealed through the context open with the one-shot API and vice versa
+    AesGcmContext moved(std::move(ctx));
+    for (size_t i = 0; i < records.size(); ++i) {
+        auto copy = records[i].data;
+        ASSERT_TRUE(VaultCrypto::open(copy, test_key, records[i].iv, records[i].tag)) << i;
+        ASSERT_TRUE(moved.open(records[i].iv, records[i].data, records[i].tag)) << i;
+        EXPECT_EQ(records[i].data, copy);
+        EXPECT_EQ(records[i].data, std::vector<uint8_t>(i * 7, static_cast<uint8_t>(i)));
+    }
+
+    // A failed open leaves the context usable
+    records[1].tag[0] ^= 0x01;
+    EXPECT_FALSE(moved.open(records[1].iv, records[1].data, records[1].tag));
+    std::vector<uint8_t> fresh = test_plaintext;
+    std::array<uint8_t, VaultCrypto::TAG_LENGTH> tag{};
+    ASSERT_TRUE(moved.seal(test_iv, fresh, tag));
+    ASSERT_TRUE(moved.open(test_iv, fresh, tag));
+    EXPECT_EQ(fresh, test_plaintext);
+}
+
 // ============================================================================
 // Random Generation Tests
 // ============================================================================
@@ -789,4 +866,152 @@ TEST_F(VaultCryptoTest, PBKDF2IterationsAffectOutput) {
     ASSERT_TRUE(VaultCrypto::derive_key(test_password, test_salt, key_high, 20000));
 
     EXPECT_NE(key_low, key_high);
-}
\ No newline at end of file
+}
+// ============================================================================
+// Segmented (STREAM) Encryption Tests
+// ============================================================================
+
+TEST_F(VaultCryptoTest, StreamRoundTripAcrossSegmentBoundaries) {
+    constexpr size_t segment = VaultCrypto::MIN_STREAM_SEGMENT_SIZE;
+    for (size_t size : {size_t{0}, size_t{1}, segment - 1, segment, segment + 1, 37 * segment + 5}) {
+        std::vector<uint8_t> plaintext(size);
+        for (size_t i = 0; i < size; ++i) {
+            plaintext[i] = static_cast<uint8_t>(i * 31);
+        }
+
+        std::vector<uint8_t> ciphertext;
+        ASSERT_TRUE(VaultCrypto::encrypt_stream(plaintext, test_key, ciphertext, test_iv, segment));
+        const size_t segments = std::max<size_t>(1, (size + segment - 1) / segment);
+        EXPECT_EQ(ciphertext.size(),
+                  VaultCrypto::STREAM_HEADER_LENGTH + size + segments * VaultCrypto::TAG_LENGTH);
+        EXPECT_EQ(VaultCrypto::stream_ciphertext_size(ciphertext), ciphertext.size());
+
+        std::vector<uint8_t> decrypted;
+        ASSERT_TRUE(VaultCrypto::decrypt_stream(ciphertext, test_key, test_iv, decrypted)) << size;
+        EXPECT_EQ(decrypted, plaintext);
+    }
+}
+
+TEST_F(VaultCryptoTest, StreamOutputIndependentOfThreadCount) {
+    std::vector<uint8_t> plaintext(200 * VaultCrypto::MIN_STREAM_SEGMENT_SIZE, 0x5A);
+
+    std::vector<uint8_t> single;
+    std::vector<uint8_t> parallel;
+    ASSERT_TRUE(VaultCrypto::encrypt_stream(plaintext, test_key, single, test_iv,
+                                            VaultCrypto::MIN_STREAM_SEGMENT_SIZE, 1));
+    ASSERT_TRUE(VaultCrypto::encrypt_stream(plaintext, test_key, parallel, test_iv,
+                                            VaultCrypto::MIN_STREAM_SEGMENT_SIZE, 8));
+    EXPECT_EQ(single, parallel);
+
+    std::vector<uint8_t> decrypted;
+    ASSERT_TRUE(VaultCrypto::decrypt_stream(single, test_key, test_iv, decrypted, 8));
+    EXPECT_EQ(decrypted, plaintext);
+}
+
+TEST_F(VaultCryptoTest, StreamInPlaceMatchesCopyingEncryption) {
+    constexpr size_t segment = VaultCrypto::MIN_STREAM_SEGMENT_SIZE;
+    for (size_t size : {size_t{0}, size_t{1}, segment, 3 * segment + 7, 100 * segment}) {
+        std::vector<uint8_t> plaintext(size);
+        for (size_t i = 0; i < size; ++i) {
+            plaintext[i] = static_cast<uint8_t>(i * 13 + 1);
+        }
+        std::vector<uint8_t> expected;
+        ASSERT_TRUE(VaultCrypto::encrypt_stream(plaintext, test_key, expected, test_iv, segment));
+
+        // Plaintext is serialized into the tail of the final buffer
+        const auto sealed_size = VaultCrypto::sealed_stream_size(size, segment);
+        ASSERT_TRUE(sealed_size.has_value());
+        std::vector<uint8_t> buffer(*sealed_size, 0xEE);
+        std::copy(plaintext.begin(), plaintext.end(), buffer.end() - static_cast<std::ptrdiff_t>(size));
+
+        ASSERT_TRUE(VaultCrypto::encrypt_stream_in_place(buffer, size, test_key, test_iv, segment, 4)) << size;
+        EXPECT_EQ(buffer, expected) << size;
+    }
+
+    // A wrongly sized buffer is rejected and cleansed
+    std::vector<uint8_t> short_buffer(VaultCrypto::STREAM_HEADER_LENGTH + 10, 0xAB);
+    EXPECT_FALSE(VaultCrypto::encrypt_stream_in_place(short_buffer, 10, test_key, test_iv, segment));
+    EXPECT_TRUE(std::all_of(short_buffer.begin(), short_buffer.end(), [](uint8_t b) { return b == 0; }));
+    EXPECT_FALSE(VaultCrypto::sealed_stream_size(10, 1).has_value());
+}
+
+TEST_F(VaultCryptoTest, StreamDetectsTamperingReorderingAndTruncation) {
+    constexpr size_t segment = VaultCrypto::MIN_STREAM_SEGMENT_SIZE;
+    std::vector<uint8_t> plaintext(4 * segment, 0x11);
+    std::vector<uint8_t> ciphertext;
+    ASSERT_TRUE(VaultCrypto::encrypt_stream(plaintext, test_key, ciphertext, test_iv, segment));
+    std::vector<uint8_t> out;
+
+    // Bit flip inside a middle segment
+    auto flipped = ciphertext;
+    flipped[VaultCrypto::STREAM_HEADER_LENGTH + 2 * (segment + VaultCrypto::TAG_LENGTH) + 7] ^= 0x01;
+    EXPECT_FALSE(VaultCrypto::decrypt_stream(flipped, test_key, test_iv, out));
+    EXPECT_TRUE(out.empty());
+
+    // Swap two full segments
+    auto swapped = ciphertext;
+    const size_t stride = segment + VaultCrypto::TAG_LENGTH;
+    std::swap_ranges(swapped.begin() + VaultCrypto::STREAM_HEADER_LENGTH,
+                     swapped.begin() + VaultCrypto::STREAM_HEADER_LENGTH + stride,
+                     swapped.begin() + VaultCrypto::STREAM_HEADER_LENGTH + stride);
+    EXPECT_FALSE(VaultCrypto::decrypt_stream(swapped, test_key, test_iv, out));
+
+    // Drop the last segment and shrink the recorded size to match
+    std::vector<uint8_t> truncated(ciphertext.begin(), ciphertext.end() - static_cast<std::ptrdiff_t>(stride));
+    const uint64_t shorter = 3 * segment;
+    for (size_t i = 0; i < 8; ++i) {
+        truncated[8 + i] = static_cast<uint8_t>(shorter >> (8 * i));
+    }
+    EXPECT_FALSE(VaultCrypto::decrypt_stream(truncated, test_key, test_iv, out));
+
+    // Trailing bytes are not part of the stream
+    auto extended = ciphertext;
+    extended.push_back(0);
+    EXPECT_FALSE(VaultCrypto::decrypt_stream(extended, test_key, test_iv, out));
+
+    // Wrong IV prefix
+    auto other_iv = test_iv;
+    other_iv[0] ^= 0xFF;
+    EXPECT_FALSE(VaultCrypto::decrypt_stream(ciphertext, test_key, other_iv, out));
+}
+
+TEST_F(VaultCryptoTest, StreamRejectsInvalidParameters) {
+    std::vector<uint8_t> ciphertext;
+    EXPECT_FALSE(VaultCrypto::encrypt_stream(test_plaintext, test_key, ciphertext, test_iv,
+                                             VaultCrypto::MIN_STREAM_SEGMENT_SIZE - 1));
+    EXPECT_FALSE(VaultCrypto::encrypt_stream(test_plaintext, test_key, ciphertext, test_iv,
+                                             VaultCrypto::MAX_STREAM_SEGMENT_SIZE + 1));
+
+    const std::vector<uint8_t> short_key(16, 0x01);
+    EXPECT_FALSE(VaultCrypto::encrypt_stream(test_plaintext, short_key, ciphertext, test_iv));
+
+    const std::vector<uint8_t> garbage(8, 0xFF);
+    EXPECT_FALSE(VaultCrypto::stream_ciphertext_size(garbage).has_value());
+}
+
+TEST_F(VaultCryptoTest, StreamRangeDecryptsOnlyCoveringSegments) {
+    constexpr size_t segment = VaultCrypto::MIN_STREAM_SEGMENT_SIZE;
+    std::vector<uint8_t> plaintext(10 * segment + 100);
+    for (size_t i = 0; i < plaintext.size(); ++i) {
+        plaintext[i] = static_cast<uint8_t>(i * 7);
+    }
+    std::vector<uint8_t> ciphertext;
+    ASSERT_TRUE(VaultCrypto::encrypt_stream(plaintext, test_key, ciphertext, test_iv, segment));
+
+    std::vector<uint8_t> range;
+    ASSERT_TRUE(VaultCrypto::decrypt_stream_range(ciphertext, test_key, test_iv, segment - 3, 10, range));
+    EXPECT_EQ(range, std::vector<uint8_t>(plaintext.begin() + segment - 3, plaintext.begin() + segment + 7));
+
+    // Length is clamped to the end of the plaintext
+    ASSERT_TRUE(VaultCrypto::decrypt_stream_range(ciphertext, test_key, test_iv, 10 * segment, SIZE_MAX, range));
+    EXPECT_EQ(range, std::vector<uint8_t>(plaintext.begin() + 10 * segment, plaintext.end()));
+    EXPECT_FALSE(VaultCrypto::decrypt_stream_range(ciphertext, test_key, test_iv, plaintext.size() + 1, 1, range));
+
+    // Damage outside the range does not affect it; damage inside is detected
+    auto damaged = ciphertext;
+    damaged[VaultCrypto::STREAM_HEADER_LENGTH + 5 * (segment + VaultCrypto::TAG_LENGTH)] ^= 0x01;
+    ASSERT_TRUE(VaultCrypto::decrypt_stream_range(damaged, test_key, test_iv, 0, 2 * segment, range));
+    EXPECT_EQ(range, std::vector<uint8_t>(plaintext.begin(), plaintext.begin() + 2 * segment));
+    EXPECT_FALSE(VaultCrypto::decrypt_stream_range(damaged, test_key, test_iv, 4 * segment, 2 * segment, range));
+    EXPECT_TRUE(range.empty());
+}
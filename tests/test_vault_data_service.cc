@@ -49,3 +49,20 @@ TEST_F(VaultDataServiceTest, MigrateSchemaUpdatesLegacyVault) {
     EXPECT_EQ(vault.metadata().schema_version(), 2);
     EXPECT_EQ(vault.metadata().access_count(), 1);
 }
+
+TEST_F(VaultDataServiceTest, PayloadRoundTripRestoresDeferredDetails) {
+    auto vault = make_vault();
+    vault.mutable_accounts(0)->set_id("account-1");
+    vault.mutable_accounts(0)->set_notes("long notes");
+
+    auto payload = VaultDataService::serialize_vault_payload(vault);
+    ASSERT_TRUE(payload.has_value());
+    const auto index_end = VaultDataService::payload_index_end(*payload);
+    ASSERT_TRUE(index_end.has_value());
+
+    auto restored = VaultDataService::deserialize_vault_payload(*payload);
+    ASSERT_TRUE(restored.has_value());
+    ASSERT_EQ(restored->accounts_size(), 1);
+    EXPECT_EQ(restored->accounts(0).password(), "secret");
+    EXPECT_EQ(restored->accounts(0).notes(), "long notes");
+}
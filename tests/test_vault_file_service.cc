@@ -5,11 +5,15 @@
 #include <gtest/gtest.h>
 #include "../src/core/services/VaultFileService.h"
 #include "../src/lib/vaultformat/VaultFormatV2.h"
+#include "../src/lib/fec/ReedSolomon.h"
+#include "../src/lib/storage/BackupManifest.h"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <vector>
 #include <cstdint>
 #include <chrono>
+#include <span>
 #include <thread>
 
 using namespace KeepTower;
@@ -163,10 +167,70 @@ TEST_F(VaultFileServiceTest, WriteV2Vault_WritesHeaderAndScrubsUsernames) {
     EXPECT_EQ(file_header.vault_header.key_slots[0].username_hash, expected_username_hash);
     EXPECT_EQ(file_header.vault_header.key_slots[0].username_hash_size, 4u);
 
-    const std::vector<uint8_t> written_ciphertext(file_bytes.begin() + static_cast<std::ptrdiff_t>(data_offset), file_bytes.end());
+    // Nonzero redundancy frames the ciphertext with data FEC; it stays verbatim
+    EXPECT_EQ(file_header.data_fec_parity_symbols, ReedSolomon::parity_symbols_for(30));
+    auto metadata = VaultFileService::read_v2_metadata(file_bytes);
+    ASSERT_TRUE(metadata.has_value());
+    const std::span<const uint8_t> payload = std::span<const uint8_t>(file_bytes).subspan(data_offset);
+    auto section = VaultFileService::open_v2_data_section(*metadata, payload);
+    ASSERT_TRUE(section.has_value());
+    EXPECT_EQ(section->stored_size, payload.size());
+    EXPECT_EQ(payload.size(), VaultFileService::v2_payload_size(30, ciphertext.size()));
+    EXPECT_EQ(section->ciphertext.data(), payload.data() + VaultFormatV2::DATA_FEC_PREFIX_SIZE);
+    const std::vector<uint8_t> written_ciphertext(section->ciphertext.begin(), section->ciphertext.end());
     EXPECT_EQ(written_ciphertext, ciphertext);
 }
 
+TEST_F(VaultFileServiceTest, WriteV2Vault_WithoutDataFecStoresBareCiphertext) {
+    VaultHeaderV2 vault_header;
+    const std::array<uint8_t, 12> data_iv{};
+    const std::vector<uint8_t> ciphertext = {0xAA, 0xBB, 0xCC, 0xDD};
+
+    ASSERT_TRUE(VaultFileService::write_v2_vault(
+        test_vault_path.string(), vault_header, 100000, {}, data_iv, ciphertext, true, 0).has_value());
+
+    const auto file_bytes = read_all_bytes(test_vault_path);
+    auto metadata = VaultFileService::read_v2_metadata(file_bytes);
+    ASSERT_TRUE(metadata.has_value());
+    EXPECT_EQ(metadata->data_fec_parity_symbols, 0u);
+    const std::vector<uint8_t> written_ciphertext(
+        file_bytes.begin() + static_cast<std::ptrdiff_t>(metadata->data_offset), file_bytes.end());
+    EXPECT_EQ(written_ciphertext, ciphertext);
+    EXPECT_EQ(VaultFileService::v2_payload_size(0, ciphertext.size()), ciphertext.size());
+}
+
+TEST_F(VaultFileServiceTest, OpenV2DataSection_RepairsCorruptedCiphertext) {
+    VaultHeaderV2 vault_header;
+    const std::array<uint8_t, 12> data_iv{};
+    std::vector<uint8_t> ciphertext(200000);
+    for (size_t i = 0; i < ciphertext.size(); ++i) {
+        ciphertext[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+
+    ASSERT_TRUE(VaultFileService::write_v2_vault(
+        test_vault_path.string(), vault_header, 100000, {}, data_iv, ciphertext, true, 20).has_value());
+
+    auto file_bytes = read_all_bytes(test_vault_path);
+    auto metadata = VaultFileService::read_v2_metadata(file_bytes);
+    ASSERT_TRUE(metadata.has_value());
+    ASSERT_NE(metadata->data_fec_parity_symbols, 0u);
+
+    // Bit rot in the middle of the ciphertext
+    const size_t ciphertext_offset = metadata->data_offset + VaultFormatV2::DATA_FEC_PREFIX_SIZE;
+    for (size_t i = 50000; i < 50300; ++i) {
+        file_bytes[ciphertext_offset + i] ^= 0xFF;
+    }
+
+    const std::span<const uint8_t> payload = std::span<const uint8_t>(file_bytes).subspan(metadata->data_offset);
+    auto section = VaultFileService::open_v2_data_section(*metadata, payload);
+    ASSERT_TRUE(section.has_value());
+    EXPECT_FALSE(section->repaired.empty());
+    EXPECT_EQ(section->damaged_windows, 1u);
+    EXPECT_EQ(section->repaired_bytes, 300u);
+    EXPECT_TRUE(std::equal(section->ciphertext.begin(), section->ciphertext.end(),
+                           ciphertext.begin(), ciphertext.end()));
+}
+
 TEST_F(VaultFileServiceTest, ReadV2Metadata_ReturnsManagerFacingHeaderData) {
     VaultHeaderV2 vault_header;
     vault_header.security_policy.pbkdf2_iterations = 600000;
@@ -269,6 +333,41 @@ TEST_F(VaultFileServiceTest, ReadVaultFile_RejectsExcessiveSize) {
     EXPECT_EQ(result.error(), VaultError::InvalidData);
 }
 
+TEST_F(VaultFileServiceTest, MapVaultFile_ViewsWholeFileAndParsesHeaderInPlace) {
+    create_v2_vault_with_header(test_vault_path, false, true, "YK-42");
+
+    auto mapped = VaultFileService::map_vault_file(test_vault_path.string());
+    ASSERT_TRUE(mapped.has_value());
+    const auto expected = read_all_bytes(test_vault_path);
+    ASSERT_EQ(mapped->size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), mapped->bytes().begin()));
+
+    auto metadata = VaultFileService::read_v2_metadata(mapped->bytes());
+    ASSERT_TRUE(metadata.has_value());
+    ASSERT_EQ(metadata->vault_header.key_slots.size(), 1u);
+    EXPECT_EQ(metadata->data_offset + 4, mapped->size());
+
+    // Moving the mapping keeps the bytes where they are
+    const auto* data = mapped->bytes().data();
+    MappedVaultFile moved = std::move(*mapped);
+    EXPECT_EQ(moved.bytes().data(), data);
+    EXPECT_TRUE(mapped->empty());
+}
+
+TEST_F(VaultFileServiceTest, MapVaultFile_RejectsSymlinkAndDirectory) {
+    create_v2_vault_file(test_vault_path);
+    const auto link_path = test_dir / "link.vault";
+    fs::create_symlink(test_vault_path, link_path);
+
+    auto via_link = VaultFileService::map_vault_file(link_path.string());
+    ASSERT_FALSE(via_link.has_value());
+    EXPECT_EQ(via_link.error(), VaultError::FileReadError);
+
+    auto directory = VaultFileService::map_vault_file(test_dir.string());
+    ASSERT_FALSE(directory.has_value());
+    EXPECT_EQ(directory.error(), VaultError::FileReadError);
+}
+
 // ============================================================================
 // File Writing Tests
 // ============================================================================
@@ -352,6 +451,65 @@ TEST_F(VaultFileServiceTest, WriteVaultFile_SecurePermissions) {
 }
 #endif
 
+TEST_F(VaultFileServiceTest, WriteVaultFile_EveryPolicyLeavesOnlyTheVault) {
+    using SyncPolicy = VaultFileService::SyncPolicy;
+    VaultFileService::reset_write_latency();
+
+    std::vector<uint8_t> data(256 * 1024);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    for (SyncPolicy policy : {SyncPolicy::Strict, SyncPolicy::DataOnly, SyncPolicy::Batched}) {
+        VaultFileService::set_sync_policy(policy);
+        EXPECT_EQ(VaultFileService::sync_policy(), policy);
+        data[0] = static_cast<uint8_t>(policy);
+        ASSERT_TRUE(VaultFileService::write_vault_file(test_vault_path.string(), data, true, 0).has_value());
+
+        std::ifstream file(test_vault_path, std::ios::binary);
+        const std::vector<uint8_t> read_data((std::istreambuf_iterator<char>(file)),
+                                             std::istreambuf_iterator<char>());
+        EXPECT_EQ(read_data, data);
+
+        const auto latency = VaultFileService::write_latency(policy);
+        EXPECT_EQ(latency.writes, 1u);
+        EXPECT_GE(latency.total, latency.sync_total);
+        EXPECT_EQ(latency.last, latency.total);
+    }
+    EXPECT_TRUE(VaultFileService::sync_deferred().has_value());
+    VaultFileService::set_sync_policy(SyncPolicy::DataOnly);
+
+    // No staging files survive, whichever way the data was staged
+    size_t entries = 0;
+    for (const auto& entry : fs::directory_iterator(test_dir)) {
+        EXPECT_EQ(entry.path(), test_vault_path);
+        ++entries;
+    }
+    EXPECT_EQ(entries, 1u);
+}
+
+TEST_F(VaultFileServiceTest, WriteVaultFile_FailedRenameKeepsOldVaultAndCleansUp) {
+    // A directory in the vault's place makes the final rename fail
+    ASSERT_TRUE(fs::create_directory(test_vault_path));
+    std::vector<uint8_t> data = {0x01, 0x02, 0x03};
+    EXPECT_FALSE(VaultFileService::write_vault_file(test_vault_path.string(), data, true, 0).has_value());
+    EXPECT_TRUE(fs::is_directory(test_vault_path));
+
+    size_t entries = 0;
+    for ([[maybe_unused]] const auto& entry : fs::directory_iterator(test_dir)) {
+        ++entries;
+    }
+    EXPECT_EQ(entries, 1u);
+}
+
+TEST_F(VaultFileServiceTest, SyncPolicyNamesRoundTrip) {
+    using SyncPolicy = VaultFileService::SyncPolicy;
+    for (SyncPolicy policy : {SyncPolicy::Strict, SyncPolicy::DataOnly, SyncPolicy::Batched}) {
+        EXPECT_EQ(VaultFileService::parse_sync_policy(VaultFileService::sync_policy_name(policy)), policy);
+    }
+    EXPECT_FALSE(VaultFileService::parse_sync_policy("never").has_value());
+}
+
 // ============================================================================
 // Format Detection Tests
 // ============================================================================
@@ -420,6 +578,55 @@ TEST_F(VaultFileServiceTest, CheckVaultRequiresYubiKey_NoRequirement) {
     EXPECT_TRUE(serial.empty());
 }
 
+TEST_F(VaultFileServiceTest, ProbeV2Header_ReadsOnlyHeaderOfLargeFile) {
+    create_v2_vault_with_header(test_vault_path, false, true, "YK-777");
+    const auto header_only = fs::file_size(test_vault_path) - 4;
+
+    // Sparse multi-hundred-MB payload: the probe must not touch it
+    fs::resize_file(test_vault_path, 600ULL * 1024 * 1024);
+
+    auto metadata = VaultFileService::probe_v2_header(test_vault_path.string());
+    ASSERT_TRUE(metadata.has_value());
+    EXPECT_EQ(metadata->data_offset, header_only);
+    ASSERT_EQ(metadata->vault_header.key_slots.size(), 1u);
+    EXPECT_EQ(metadata->vault_header.key_slots[0].yubikey_serial, "YK-777");
+
+    // Second probe is served from the cache
+    auto again = VaultFileService::probe_v2_header(test_vault_path.string());
+    ASSERT_TRUE(again.has_value());
+    EXPECT_EQ(again->data_offset, metadata->data_offset);
+
+    std::string serial;
+    EXPECT_TRUE(VaultFileService::check_vault_requires_yubikey(test_vault_path.string(), serial));
+    EXPECT_EQ(serial, "YK-777");
+}
+
+TEST_F(VaultFileServiceTest, ProbeV2Header_SameSizeRewriteIsReparsed) {
+    create_v2_vault_with_header(test_vault_path, false, true, "YK-111");
+    auto first = VaultFileService::probe_v2_header(test_vault_path.string());
+    ASSERT_TRUE(first.has_value());
+
+    // Rewritten in place within the same timestamp tick: identity may match
+    create_v2_vault_with_header(test_vault_path, false, true, "YK-222");
+    auto second = VaultFileService::probe_v2_header(test_vault_path.string());
+    ASSERT_TRUE(second.has_value());
+    ASSERT_EQ(second->vault_header.key_slots.size(), 1u);
+    EXPECT_EQ(second->vault_header.key_slots[0].yubikey_serial, "YK-222");
+}
+
+TEST_F(VaultFileServiceTest, ProbeV2Header_RejectsTruncatedHeader) {
+    create_v2_vault_with_header(test_vault_path, true, false);
+    fs::resize_file(test_vault_path, 40);
+
+    auto metadata = VaultFileService::probe_v2_header(test_vault_path.string());
+    ASSERT_FALSE(metadata.has_value());
+    EXPECT_EQ(metadata.error(), VaultError::CorruptedFile);
+
+    auto missing = VaultFileService::probe_v2_header((test_dir / "missing.vault").string());
+    ASSERT_FALSE(missing.has_value());
+    EXPECT_EQ(missing.error(), VaultError::FileNotFound);
+}
+
 // ============================================================================
 // Backup Management Tests
 // ============================================================================
@@ -451,6 +658,32 @@ TEST_F(VaultFileServiceTest, CreateBackup_CustomDirectory) {
         << "Backup should be in custom directory";
 }
 
+TEST_F(VaultFileServiceTest, CreateBackup_CopiesBytesWithoutStagingLeftovers) {
+    create_v2_vault_file(test_vault_path);
+    fs::create_directories(test_backup_dir);
+
+    auto result = VaultFileService::create_backup(
+        test_vault_path.string(), test_backup_dir.string());
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_EQ(read_all_bytes(result.value()), read_all_bytes(test_vault_path));
+
+    const auto perms = fs::status(result.value()).permissions();
+    EXPECT_TRUE((perms & (fs::perms::group_all | fs::perms::others_all)) == fs::perms::none)
+        << "Backup must stay owner-only";
+
+    // The copy is staged under a hidden name and renamed into place; only the
+    // backup and the manifest indexing it remain
+    const fs::path manifest = BackupManifest::path_for(test_vault_path.string(), test_backup_dir.string());
+    size_t entries = 0;
+    for (const auto& entry : fs::directory_iterator(test_backup_dir)) {
+        EXPECT_TRUE(entry.path() == manifest || !entry.path().filename().string().starts_with("."))
+            << "Staging file left behind: " << entry.path();
+        ++entries;
+    }
+    EXPECT_EQ(entries, 2u);
+}
+
 TEST_F(VaultFileServiceTest, CreateBackup_SourceNotFound) {
     auto result = VaultFileService::create_backup("/nonexistent/vault.vault");
 
@@ -502,6 +735,53 @@ TEST_F(VaultFileServiceTest, ListBackups_MultipleBackups) {
     }
 }
 
+TEST_F(VaultFileServiceTest, ListBackups_ReadsManifestAndRebuildsItWhenMissing) {
+    create_v2_vault_file(test_vault_path);
+
+    auto older = VaultFileService::create_backup(test_vault_path.string());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto newer = VaultFileService::create_backup(test_vault_path.string());
+    ASSERT_TRUE(older.has_value());
+    ASSERT_TRUE(newer.has_value());
+
+    const fs::path manifest = BackupManifest::path_for(test_vault_path.string(), "");
+    ASSERT_TRUE(fs::exists(manifest)) << "Backups should be recorded in the manifest";
+
+    const auto entries = BackupManifest::load(test_vault_path.string(), "");
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_TRUE(entries[0].is_intact());
+    EXPECT_EQ(entries[0].size, fs::file_size(test_vault_path));
+
+    const std::vector<std::string> expected = {newer.value(), older.value()};
+    EXPECT_EQ(VaultFileService::list_backups(test_vault_path.string()), expected);
+
+    // A lost manifest is rebuilt from the directory
+    fs::remove(manifest);
+    EXPECT_EQ(VaultFileService::list_backups(test_vault_path.string()), expected);
+    EXPECT_TRUE(fs::exists(manifest));
+}
+
+TEST_F(VaultFileServiceTest, RestoreFromBackup_SkipsBackupThatNoLongerMatchesManifest) {
+    create_v2_vault_file(test_vault_path);
+    const auto original_bytes = read_all_bytes(test_vault_path);
+
+    auto intact = VaultFileService::create_backup(test_vault_path.string());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto damaged = VaultFileService::create_backup(test_vault_path.string());
+    ASSERT_TRUE(intact.has_value());
+    ASSERT_TRUE(damaged.has_value());
+    fs::resize_file(damaged.value(), 16);
+
+    {
+        std::ofstream file(test_vault_path, std::ios::binary | std::ios::trunc);
+        file << "This vault was modified";
+    }
+
+    ASSERT_TRUE(VaultFileService::restore_from_backup(test_vault_path.string()).has_value());
+    EXPECT_EQ(read_all_bytes(test_vault_path), original_bytes)
+        << "Restore should fall back to the newest backup that is still intact";
+}
+
 TEST_F(VaultFileServiceTest, RestoreFromBackup_Success) {
     // Create original vault and capture its exact bytes
     create_v2_vault_file(test_vault_path);
@@ -12,6 +12,9 @@
 #include <gtest/gtest.h>
 #include "../src/lib/vaultformat/VaultFormatV2.h"
 #include "../src/core/VaultError.h"
+#include "../src/lib/fec/RsCodec.h"
+#include "../src/lib/fec/Crc32c.h"
+#include <algorithm>
 #include <vector>
 #include <cstring>
 
@@ -257,6 +260,30 @@ TEST_F(VaultFormatV2Test, WriteHeaderRespectsHigherUserRedundancy) {
     EXPECT_EQ(read_header.fec_redundancy_percent, 30);  // User preference preserved
 }
 
+TEST_F(VaultFormatV2Test, HeaderFlagsCarryPayloadCompression) {
+    header.payload_compression = VaultFormatV2::PAYLOAD_COMPRESSION_ZLIB;
+    auto write_result = VaultFormatV2::write_header(header, true, 10);
+    ASSERT_TRUE(write_result.has_value());
+
+    auto file_data = write_result.value();
+    EXPECT_NE(file_data[16] & VaultFormatV2::HEADER_FLAG_FEC_ENABLED, 0);
+    EXPECT_EQ((file_data[16] & VaultFormatV2::HEADER_COMPRESSION_MASK) >> VaultFormatV2::HEADER_COMPRESSION_SHIFT,
+              VaultFormatV2::PAYLOAD_COMPRESSION_ZLIB);
+
+    auto read_result = VaultFormatV2::read_header(file_data);
+    ASSERT_TRUE(read_result.has_value());
+    EXPECT_EQ(read_result->first.payload_compression, VaultFormatV2::PAYLOAD_COMPRESSION_ZLIB);
+
+    // A codec this build does not know must not reach the protobuf parser
+    file_data[16] |= VaultFormatV2::HEADER_COMPRESSION_MASK;
+    auto unknown = VaultFormatV2::read_header(file_data);
+    ASSERT_FALSE(unknown.has_value());
+    EXPECT_EQ(unknown.error(), VaultError::UnsupportedVersion);
+
+    header.payload_compression = 7;
+    EXPECT_FALSE(VaultFormatV2::write_header(header, true, 10).has_value());
+}
+
 // ============================================================================
 // Header Read Tests
 // ============================================================================
@@ -273,6 +300,7 @@ TEST_F(VaultFormatV2Test, ReadHeaderRoundTripWithoutFEC) {
     auto& [read_header, offset] = read_result.value();
 
     // Verify magic, version, PBKDF2
+    EXPECT_EQ(read_header.payload_compression, VaultFormatV2::PAYLOAD_COMPRESSION_NONE);
     EXPECT_EQ(read_header.magic, VaultFormatV2::VAULT_MAGIC);
     EXPECT_EQ(read_header.version, VaultFormatV2::VAULT_VERSION_V2);
     EXPECT_EQ(read_header.pbkdf2_iterations, 100000u);
@@ -286,6 +314,29 @@ TEST_F(VaultFormatV2Test, ReadHeaderRoundTripWithoutFEC) {
     EXPECT_EQ(read_header.data_iv, header.data_iv);
 }
 
+TEST_F(VaultFormatV2Test, ReadHeaderRoundTripV3SegmentedPayload) {
+    header.version = VaultFormatV2::VAULT_VERSION_V3;
+    auto write_result = VaultFormatV2::write_header(header, true, 0);
+    ASSERT_TRUE(write_result.has_value());
+
+    auto version = VaultFormatV2::detect_version(write_result.value());
+    ASSERT_TRUE(version.has_value());
+    EXPECT_EQ(version.value(), VaultFormatV2::VAULT_VERSION_V3);
+    EXPECT_TRUE(VaultFormatV2::is_valid_v2_vault(write_result.value()));
+
+    auto read_result = VaultFormatV2::read_header(write_result.value());
+    ASSERT_TRUE(read_result.has_value());
+    EXPECT_EQ(read_result.value().first.version, VaultFormatV2::VAULT_VERSION_V3);
+    EXPECT_EQ(read_result.value().first.data_iv, header.data_iv);
+}
+
+TEST_F(VaultFormatV2Test, WriteHeaderRejectsUnsupportedVersion) {
+    header.version = 4;
+    auto write_result = VaultFormatV2::write_header(header, false, 0);
+    ASSERT_FALSE(write_result.has_value());
+    EXPECT_EQ(write_result.error(), VaultError::UnsupportedVersion);
+}
+
 TEST_F(VaultFormatV2Test, ReadHeaderRoundTripWithFEC) {
     // Write header with FEC
     auto write_result = VaultFormatV2::write_header(header, true, 30);
@@ -306,6 +357,94 @@ TEST_F(VaultFormatV2Test, ReadHeaderRoundTripWithFEC) {
     EXPECT_EQ(read_header.data_iv, header.data_iv);
 }
 
+TEST_F(VaultFormatV2Test, HeaderFecRecordsCodewordParameters) {
+    auto write_result = VaultFormatV2::write_header(header, true, 30);
+    ASSERT_TRUE(write_result.has_value());
+    const auto& file_data = write_result.value();
+    EXPECT_NE(file_data[16] & VaultFormatV2::HEADER_FLAG_FEC_INTERLEAVED, 0);
+    EXPECT_NE(file_data[16] & VaultFormatV2::HEADER_FLAG_FEC_CHECKSUMS, 0);
+
+    // Format: ... flags(1) + redundancy(1) + orig_size(4) + parity(1) + depth(1) + [encoded_data]
+    EXPECT_EQ(file_data[22], ReedSolomon::parity_symbols_for(30));
+    EXPECT_GE(file_data[23], 1);
+
+    auto read_result = VaultFormatV2::read_header(file_data);
+    ASSERT_TRUE(read_result.has_value());
+    EXPECT_EQ(read_result->first.fec_parity_symbols, file_data[22]);
+    EXPECT_EQ(read_result->first.fec_interleave_depth, file_data[23]);
+    EXPECT_EQ(read_result->first.fec_redundancy_percent, 30);
+
+    // A damaged run inside the encoded header is located by its checksum
+    auto damaged = file_data;
+    for (size_t i = 30; i < 60; ++i) {
+        damaged[i] ^= 0xFF;
+    }
+    auto repaired = VaultFormatV2::read_header(damaged);
+    ASSERT_TRUE(repaired.has_value());
+    EXPECT_EQ(repaired->first.vault_header.security_policy.min_password_length, 12u);
+}
+
+TEST_F(VaultFormatV2Test, HeaderFecChecksumsAreStoredLittleEndian) {
+    auto write_result = VaultFormatV2::write_header(header, true, 30);
+    ASSERT_TRUE(write_result.has_value());
+    const auto& file_data = write_result.value();
+
+    const uint32_t original_size = (static_cast<uint32_t>(file_data[18]) << 24) |
+                                   (static_cast<uint32_t>(file_data[19]) << 16) |
+                                   (static_cast<uint32_t>(file_data[20]) << 8) | file_data[21];
+    const size_t encoded_size = ReedSolomon::encoded_size(original_size, file_data[22]);
+    const size_t count = ReedSolomon::checksum_count(encoded_size);
+    ASSERT_GT(count, 0u);
+    ASSERT_GE(file_data.size(), 24 + encoded_size + 4 * count);
+
+    // The byte order is part of the file format, whatever the host's is
+    const std::span<const uint8_t> encoded(file_data.data() + 24, encoded_size);
+    for (size_t i = 0; i < count; ++i) {
+        const size_t offset = i * ReedSolomon::CHECKSUM_SEGMENT_SIZE;
+        const uint32_t crc = crc32c(encoded.subspan(
+            offset, std::min(ReedSolomon::CHECKSUM_SEGMENT_SIZE, encoded_size - offset)));
+        const uint8_t* stored = encoded.data() + encoded_size + 4 * i;
+        EXPECT_EQ(stored[0], static_cast<uint8_t>(crc));
+        EXPECT_EQ(stored[1], static_cast<uint8_t>(crc >> 8));
+        EXPECT_EQ(stored[2], static_cast<uint8_t>(crc >> 16));
+        EXPECT_EQ(stored[3], static_cast<uint8_t>(crc >> 24));
+    }
+}
+
+TEST_F(VaultFormatV2Test, ReadsHeaderFecWrittenBeforeInterleaving) {
+    // Earlier releases wrote zero-padded RS(255,223) codewords back to back
+    const auto vault_header_data = header.vault_header.serialize();
+    std::vector<uint8_t> padded((vault_header_data.size() + 222) / 223 * 223, 0);
+    std::copy(vault_header_data.begin(), vault_header_data.end(), padded.begin());
+    std::vector<uint8_t> codewords(padded.size() / 223 * 255);
+    ASSERT_TRUE(RsCodec(32).encode(padded, codewords));
+    codewords[3] ^= 0xFF;
+
+    const uint32_t original_size = static_cast<uint32_t>(vault_header_data.size());
+    std::vector<uint8_t> section = {20,
+                                    static_cast<uint8_t>(original_size >> 24),
+                                    static_cast<uint8_t>(original_size >> 16),
+                                    static_cast<uint8_t>(original_size >> 8),
+                                    static_cast<uint8_t>(original_size)};
+    section.insert(section.end(), codewords.begin(), codewords.end());
+
+    auto plain = VaultFormatV2::write_header(header, false, 0);
+    ASSERT_TRUE(plain.has_value());
+    std::vector<uint8_t> file_data(plain->begin(), plain->begin() + 16);
+    const uint32_t header_size = static_cast<uint32_t>(1 + section.size());
+    std::memcpy(file_data.data() + 12, &header_size, sizeof(header_size));
+    file_data.push_back(VaultFormatV2::HEADER_FLAG_FEC_ENABLED);
+    file_data.insert(file_data.end(), section.begin(), section.end());
+    file_data.insert(file_data.end(), header.data_salt.begin(), header.data_salt.end());
+    file_data.insert(file_data.end(), header.data_iv.begin(), header.data_iv.end());
+
+    auto read_result = VaultFormatV2::read_header(file_data);
+    ASSERT_TRUE(read_result.has_value());
+    EXPECT_EQ(read_result->first.fec_parity_symbols, 0);
+    EXPECT_EQ(read_result->first.vault_header.security_policy.min_password_length, 12u);
+    EXPECT_EQ(read_result->first.data_iv, header.data_iv);
+}
+
 TEST_F(VaultFormatV2Test, ReadHeaderTooSmallFile) {
     std::vector<uint8_t> data = {1, 2, 3}; // Too small
 
@@ -527,3 +666,76 @@ TEST_F(VaultFormatV2Test, FECRecoveryFromMinorCorruption) {
         EXPECT_EQ(read_result.error(), VaultError::FECDecodingFailed);
     }
 }
+
+TEST_F(VaultFormatV2Test, DataFecParametersRoundTripInsideHeaderFec) {
+    header.data_fec_parity_symbols = 24;
+    header.data_fec_window_size = 64 * 1024;
+    auto write_result = VaultFormatV2::write_header(header, true, 10);
+    ASSERT_TRUE(write_result.has_value());
+    EXPECT_NE((*write_result)[16] & VaultFormatV2::HEADER_FLAG_DATA_FEC, 0);
+
+    auto read_result = VaultFormatV2::read_header(*write_result);
+    ASSERT_TRUE(read_result.has_value());
+    EXPECT_EQ(read_result->first.data_fec_parity_symbols, 24);
+    EXPECT_EQ(read_result->first.data_fec_window_size, 64u * 1024);
+    EXPECT_EQ(read_result->first.vault_header.security_policy.min_password_length, 12u);
+
+    // Headers without data FEC keep the flag clear
+    header.data_fec_parity_symbols = 0;
+    auto plain = VaultFormatV2::write_header(header, true, 10);
+    ASSERT_TRUE(plain.has_value());
+    EXPECT_EQ((*plain)[16] & VaultFormatV2::HEADER_FLAG_DATA_FEC, 0);
+
+    header.data_fec_parity_symbols = 24;
+    header.data_fec_window_size = 1;
+    EXPECT_FALSE(VaultFormatV2::write_header(header, true, 10).has_value());
+}
+
+TEST_F(VaultFormatV2Test, DataSectionRepairsCiphertextBeforeDecryption) {
+    std::vector<uint8_t> ciphertext(300 * 1024);
+    for (size_t i = 0; i < ciphertext.size(); ++i) {
+        ciphertext[i] = static_cast<uint8_t>(i * 7 + (i >> 9));
+    }
+    auto framing = VaultFormatV2::protect_data_section(24, 64 * 1024, ciphertext);
+    ASSERT_TRUE(framing.has_value());
+    ASSERT_EQ(framing->prefix.size(), VaultFormatV2::DATA_FEC_PREFIX_SIZE);
+
+    std::vector<uint8_t> section = framing->prefix;
+    section.insert(section.end(), ciphertext.begin(), ciphertext.end());
+    section.insert(section.end(), framing->trailer.begin(), framing->trailer.end());
+    const size_t stored_size = section.size();
+    section.push_back(0xAB);  // A journal frame may follow
+
+    auto clean = VaultFormatV2::open_data_section(24, 64 * 1024, section);
+    ASSERT_TRUE(clean.has_value());
+    EXPECT_EQ(clean->stored_size, stored_size);
+    EXPECT_TRUE(clean->repaired.empty());
+    EXPECT_EQ(clean->ciphertext.data(), section.data() + VaultFormatV2::DATA_FEC_PREFIX_SIZE);
+    EXPECT_TRUE(std::equal(clean->ciphertext.begin(), clean->ciphertext.end(), ciphertext.begin()));
+
+    // Two length copies and one checksum segment of ciphertext are lost
+    auto damaged = section;
+    std::fill_n(damaged.begin(), 24, 0);
+    for (size_t i = 24 * 4096; i < 25 * 4096; ++i) {
+        damaged[VaultFormatV2::DATA_FEC_PREFIX_SIZE + i] ^= 0x3C;
+    }
+    auto repaired = VaultFormatV2::open_data_section(24, 64 * 1024, damaged);
+    ASSERT_TRUE(repaired.has_value());
+    EXPECT_EQ(repaired->damaged_windows, 1u);
+    EXPECT_EQ(repaired->repaired_bytes, 4096u);
+    EXPECT_EQ(repaired->stored_size, stored_size);
+    EXPECT_TRUE(std::equal(repaired->ciphertext.begin(), repaired->ciphertext.end(), ciphertext.begin()));
+
+    // Every length copy gone: the section cannot be located
+    std::fill_n(damaged.begin(), VaultFormatV2::DATA_FEC_PREFIX_SIZE, 0);
+    auto lost = VaultFormatV2::open_data_section(24, 64 * 1024, damaged);
+    ASSERT_FALSE(lost.has_value());
+    EXPECT_EQ(lost.error(), VaultError::CorruptedFile);
+
+    // A whole window overwritten is beyond the parity
+    auto wiped = section;
+    std::fill_n(wiped.begin() + VaultFormatV2::DATA_FEC_PREFIX_SIZE, 64 * 1024, 0);
+    auto unrepairable = VaultFormatV2::open_data_section(24, 64 * 1024, wiped);
+    ASSERT_FALSE(unrepairable.has_value());
+    EXPECT_EQ(unrepairable.error(), VaultError::FECDecodingFailed);
+}
@@ -0,0 +1,321 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include <gtest/gtest.h>
+#include "../src/core/services/VaultJournalService.h"
+#include "lib/crypto/VaultCrypto.h"
+#include "record.pb.h"
+#include <filesystem>
+#include <fstream>
+#include <initializer_list>
+#include <vector>
+#include <cstdint>
+
+using namespace KeepTower;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Unit tests for VaultJournalService
+ *
+ * Uses a synthetic "header + base ciphertext" file so the tests exercise
+ * framing, sealing, replay and compaction decisions without a real vault.
+ */
+class VaultJournalServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = fs::temp_directory_path() / "keeptower_journal_service_test";
+        fs::create_directories(test_dir);
+        test_vault_path = (test_dir / "journal.vault").string();
+
+        dek.assign(VaultCrypto::KEY_LENGTH, 0x42);
+        base_iv.assign(VaultCrypto::IV_LENGTH, 0xB7);  // High bit set: IV bytes compare as unsigned
+        header.assign(64, 0xA5);
+        base.assign(4096, 0x3C);
+
+        add_account(data, "id-1", "One");
+        add_account(data, "id-2", "Two");
+        add_account(data, "id-3", "Three");
+        data.mutable_metadata()->set_name("Journal Test");
+
+        write_base_file();
+    }
+
+    void TearDown() override {
+        if (fs::exists(test_dir)) {
+            fs::remove_all(test_dir);
+        }
+    }
+
+    static void add_account(keeptower::VaultData& vault, const std::string& id, const std::string& name) {
+        auto* account = vault.add_accounts();
+        account->set_id(id);
+        account->set_account_name(name);
+        account->set_password("secret-" + id);
+    }
+
+    void write_base_file() {
+        std::ofstream file(test_vault_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        file.write(reinterpret_cast<const char*>(base.data()), static_cast<std::streamsize>(base.size()));
+    }
+
+    std::vector<uint8_t> read_file() const {
+        std::ifstream file(test_vault_path, std::ios::binary);
+        return std::vector<uint8_t>((std::istreambuf_iterator<char>(file)),
+                                    std::istreambuf_iterator<char>());
+    }
+
+    void start_journal(VaultJournalService& journal) {
+        journal.reset(header, base_iv, base.size(), header.size() + base.size(), 0, data);
+        ASSERT_TRUE(journal.is_active());
+    }
+
+    // Note the accounts a test changed and close the generation a write covers
+    static VaultJournalService::Generation changed(VaultJournalService& journal,
+                                                   std::initializer_list<const char*> ids) {
+        for (const char* id : ids) {
+            journal.note_account_changed(id);
+        }
+        return journal.close_generation();
+    }
+
+    // Re-read the file and replay its journal onto a fresh copy of the base state
+    keeptower::VaultData replay_from_disk(const keeptower::VaultData& base_state, size_t* applied = nullptr) const {
+        const auto bytes = read_file();
+        const std::span<const uint8_t> payload(bytes.data() + header.size(), bytes.size() - header.size());
+        const auto layout = VaultJournalService::split_payload(payload);
+        EXPECT_EQ(layout.base_size, base.size());
+
+        keeptower::VaultData replayed = base_state;
+        const size_t count = VaultJournalService::replay(layout.frames, dek, base_iv, replayed);
+        if (applied) {
+            *applied = count;
+        }
+        return replayed;
+    }
+
+    static std::string serialized(const keeptower::VaultData& vault) {
+        std::string out;
+        EXPECT_TRUE(vault.SerializeToString(&out));
+        return out;
+    }
+
+    fs::path test_dir;
+    std::string test_vault_path;
+    std::vector<uint8_t> dek;
+    std::vector<uint8_t> base_iv;
+    std::vector<uint8_t> header;
+    std::vector<uint8_t> base;
+    keeptower::VaultData data;
+};
+
+TEST_F(VaultJournalServiceTest, SplitPayloadWithoutJournalReturnsWholeBase) {
+    const auto layout = VaultJournalService::split_payload(base);
+    EXPECT_EQ(layout.base_size, base.size());
+    EXPECT_EQ(layout.valid_size, base.size());
+    EXPECT_TRUE(layout.frames.empty());
+}
+
+TEST_F(VaultJournalServiceTest, AppendAndReplayRoundTripsMutations) {
+    const keeptower::VaultData base_state = data;
+    VaultJournalService journal;
+    start_journal(journal);
+
+    // Update, delete, add and reorder in one record
+    data.mutable_accounts(1)->set_password("changed");
+    data.mutable_accounts()->erase(data.mutable_accounts()->begin());
+    add_account(data, "id-4", "Four");
+    data.mutable_accounts()->SwapElements(0, 2);
+    data.mutable_metadata()->set_last_modified(12345);
+
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-1", "id-2", "id-4"})));
+    EXPECT_EQ(journal.record_count(), 1u);
+
+    // Second record: only a field change
+    data.mutable_accounts(0)->set_notes("note");
+    data.mutable_metadata()->set_last_modified(12346);
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-4"})));
+    EXPECT_EQ(journal.record_count(), 2u);
+
+    size_t applied = 0;
+    const auto replayed = replay_from_disk(base_state, &applied);
+    EXPECT_EQ(applied, 2u);
+    EXPECT_EQ(serialized(replayed), serialized(data));
+}
+
+TEST_F(VaultJournalServiceTest, AppendWithoutChangesWritesNothing) {
+    VaultJournalService journal;
+    start_journal(journal);
+
+    // A save stamps last_modified even when nothing else changed
+    data.mutable_metadata()->set_last_modified(12345);
+
+    const auto size_before = fs::file_size(test_vault_path);
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, journal.close_generation()));
+    EXPECT_EQ(fs::file_size(test_vault_path), size_before);
+    EXPECT_EQ(journal.record_count(), 0u);
+}
+
+TEST_F(VaultJournalServiceTest, AppendWritesOnlyChangedAccounts) {
+    for (int i = 0; i < 200; ++i) {
+        add_account(data, "bulk-" + std::to_string(i), std::string(200, 'x'));
+    }
+    VaultJournalService journal;
+    start_journal(journal);
+
+    data.mutable_accounts(5)->set_user_name("renamed");
+    data.mutable_metadata()->set_last_modified(12345);
+    const auto size_before = fs::file_size(test_vault_path);
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"bulk-2"})));
+
+    const auto record_size = fs::file_size(test_vault_path) - size_before;
+    EXPECT_LT(record_size, 1024u);
+}
+
+TEST_F(VaultJournalServiceTest, AppendWritesOnlyNotedAccounts) {
+    const keeptower::VaultData base_state = data;
+    VaultJournalService journal;
+    start_journal(journal);
+
+    // Accounts are not diffed: an un-noted edit stays out of the record
+    data.mutable_accounts(0)->set_notes("noted");
+    data.mutable_accounts(1)->set_notes("not noted");
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-1"})));
+
+    const auto replayed = replay_from_disk(base_state);
+    EXPECT_EQ(replayed.accounts(0).notes(), "noted");
+    EXPECT_EQ(replayed.accounts(1).notes(), "");
+}
+
+TEST_F(VaultJournalServiceTest, NotesAfterTheSnapshotWaitForTheNextWrite) {
+    const keeptower::VaultData base_state = data;
+    VaultJournalService journal;
+    start_journal(journal);
+
+    data.mutable_accounts(0)->set_account_name("First");
+    const auto first = changed(journal, {"id-1"});
+    const keeptower::VaultData first_snapshot = data;
+
+    // Edited after the snapshot was taken, before its write
+    data.mutable_accounts(1)->set_account_name("Second");
+    journal.note_account_changed("id-2");
+
+    keeptower::VaultData snapshot = first_snapshot;
+    ASSERT_TRUE(journal.append(test_vault_path, snapshot, dek, first));
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, journal.close_generation()));
+
+    EXPECT_EQ(serialized(replay_from_disk(base_state)), serialized(data));
+}
+
+TEST_F(VaultJournalServiceTest, SupersededSnapshotNotesCarryOver) {
+    const keeptower::VaultData base_state = data;
+    VaultJournalService journal;
+    start_journal(journal);
+
+    // The first snapshot is dropped unwritten; the second covers both edits
+    data.mutable_accounts(0)->set_account_name("First");
+    (void)changed(journal, {"id-1"});
+    data.mutable_accounts()->erase(data.mutable_accounts()->begin() + 2);
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-3"})));
+
+    EXPECT_EQ(serialized(replay_from_disk(base_state)), serialized(data));
+}
+
+TEST_F(VaultJournalServiceTest, ReplacedAccountsForceCompaction) {
+    VaultJournalService journal;
+    start_journal(journal);
+
+    journal.note_accounts_replaced();
+    const auto generation = journal.close_generation();
+    EXPECT_FALSE(journal.can_append(header, generation));
+
+    // A full write of that generation tracks a new base image
+    journal.reset(header, base_iv, base.size(), header.size() + base.size(), 0, data, generation);
+    EXPECT_TRUE(journal.can_append(header, journal.close_generation()));
+}
+
+TEST_F(VaultJournalServiceTest, ReplayRejectsRecordsForDifferentBase) {
+    const keeptower::VaultData base_state = data;
+    VaultJournalService journal;
+    start_journal(journal);
+
+    data.mutable_accounts(0)->set_account_name("Changed");
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-1"})));
+
+    const auto bytes = read_file();
+    const std::span<const uint8_t> payload(bytes.data() + header.size(), bytes.size() - header.size());
+    const auto layout = VaultJournalService::split_payload(payload);
+    ASSERT_EQ(layout.frames.size(), 1u);
+
+    keeptower::VaultData replayed = base_state;
+    const std::vector<uint8_t> other_iv(VaultCrypto::IV_LENGTH, 0x99);
+    EXPECT_EQ(VaultJournalService::replay(layout.frames, dek, other_iv, replayed), 0u);
+    EXPECT_EQ(serialized(replayed), serialized(base_state));
+
+    const std::vector<uint8_t> wrong_dek(VaultCrypto::KEY_LENGTH, 0x01);
+    EXPECT_EQ(VaultJournalService::replay(layout.frames, wrong_dek, base_iv, replayed), 0u);
+}
+
+TEST_F(VaultJournalServiceTest, TornTailIsIgnored) {
+    const keeptower::VaultData base_state = data;
+    VaultJournalService journal;
+    start_journal(journal);
+
+    data.mutable_accounts(0)->set_account_name("First");
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-1"})));
+    const auto intact_size = fs::file_size(test_vault_path);
+    const keeptower::VaultData after_first = data;
+
+    data.mutable_accounts(1)->set_account_name("Second");
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-2"})));
+    fs::resize_file(test_vault_path, fs::file_size(test_vault_path) - 5);
+
+    const auto bytes = read_file();
+    const std::span<const uint8_t> payload(bytes.data() + header.size(), bytes.size() - header.size());
+    const auto layout = VaultJournalService::split_payload(payload);
+    EXPECT_EQ(layout.base_size, base.size());
+    EXPECT_EQ(layout.frames.size(), 1u);
+    EXPECT_EQ(header.size() + layout.valid_size, intact_size);
+
+    keeptower::VaultData replayed = base_state;
+    EXPECT_EQ(VaultJournalService::replay(layout.frames, dek, base_iv, replayed), 1u);
+    EXPECT_EQ(serialized(replayed), serialized(after_first));
+}
+
+TEST_F(VaultJournalServiceTest, CanAppendRequiresMatchingHeaderAndThresholds) {
+    VaultJournalService journal;
+    EXPECT_FALSE(journal.can_append(header, journal.close_generation()));
+
+    start_journal(journal);
+    EXPECT_TRUE(journal.can_append(header, journal.close_generation()));
+
+    auto changed_header = header;
+    changed_header[3] ^= 0xFF;
+    EXPECT_FALSE(journal.can_append(changed_header, journal.close_generation()));
+
+    journal.set_compaction_thresholds(1, 0);
+    data.mutable_accounts(0)->set_account_name("Changed");
+    ASSERT_TRUE(journal.append(test_vault_path, data, dek, changed(journal, {"id-1"})));
+    EXPECT_FALSE(journal.can_append(header, journal.close_generation()));
+}
+
+TEST_F(VaultJournalServiceTest, AppendRefusesWhenFileChangedOnDisk) {
+    VaultJournalService journal;
+    start_journal(journal);
+
+    // Another writer replaced the file with a different header
+    header[0] ^= 0xFF;
+    write_base_file();
+
+    data.mutable_accounts(0)->set_account_name("Changed");
+    EXPECT_FALSE(journal.append(test_vault_path, data, dek, changed(journal, {"id-1"})));
+    EXPECT_EQ(fs::file_size(test_vault_path), header.size() + base.size());
+}
+
+TEST_F(VaultJournalServiceTest, DuplicateAccountIdsDisableJournal) {
+    add_account(data, "id-1", "Duplicate");
+    VaultJournalService journal;
+    journal.reset(header, base_iv, base.size(), header.size() + base.size(), 0, data);
+    EXPECT_FALSE(journal.is_active());
+    EXPECT_FALSE(journal.can_append(header, journal.close_generation()));
+}
@@ -5,12 +5,17 @@
 
 #include "VaultManager.h"
 
+#include <glibmm/main.h>
+
+#include <chrono>
 #include <filesystem>
 #include <fstream>
+#include <thread>
 
 #include "lib/crypto/KeyWrapping.h"
 #include "lib/storage/VaultIO.h"
 #include "../src/core/services/IVaultYubiKeyService.h"
+#include "../src/core/services/VaultFileService.h"
 
 namespace fs = std::filesystem;
 
@@ -162,12 +167,20 @@ protected:
 
     void TearDown() override {
         vault_manager.reset();
+        KeepTower::VaultFileService::set_sync_policy(KeepTower::VaultFileService::SyncPolicy::DataOnly);
         try {
             fs::remove_all(test_dir);
         } catch (...) {
         }
     }
 
+    // Saves stage in anonymous or uniquely named files and rename over the
+    // vault; a directory in the vault's place makes that rename fail
+    void block_vault_writes() {
+        fs::remove(test_vault_path);
+        ASSERT_TRUE(fs::create_directory(test_vault_path));
+    }
+
     fs::path test_dir;
     std::string test_vault_path;
     std::unique_ptr<VaultManager> vault_manager;
@@ -401,8 +414,7 @@ TEST_F(VaultManagerTest, CreateGroupSaveFailureRollsBackInMemoryState) {
 
     const auto baseline_groups = vault_manager->get_all_groups_view();
 
-    const fs::path blocking_temp_path = fs::path(test_vault_path).concat(".tmp");
-    ASSERT_TRUE(fs::create_directory(blocking_temp_path));
+    block_vault_writes();
 
     EXPECT_TRUE(vault_manager->is_vault_open());
     EXPECT_EQ(vault_manager->create_group("Work"), "");
@@ -431,8 +443,7 @@ TEST_F(VaultManagerTest, DeleteGroupSaveFailureRollsBackInMemoryState) {
             return group.group_name == "Work";
         }));
 
-    const fs::path blocking_temp_path = fs::path(test_vault_path).concat(".tmp");
-    ASSERT_TRUE(fs::create_directory(blocking_temp_path));
+    block_vault_writes();
 
     EXPECT_FALSE(vault_manager->delete_group(group_id));
 
@@ -452,8 +463,7 @@ TEST_F(VaultManagerTest, RenameGroupSaveFailureRollsBackInMemoryState) {
     const std::string group_id = vault_manager->create_group("Work");
     ASSERT_FALSE(group_id.empty());
 
-    const fs::path blocking_temp_path = fs::path(test_vault_path).concat(".tmp");
-    ASSERT_TRUE(fs::create_directory(blocking_temp_path));
+    block_vault_writes();
 
     EXPECT_FALSE(vault_manager->rename_group(group_id, "Renamed Work"));
 
@@ -555,6 +565,237 @@ TEST_F(VaultManagerTest, GlobalOrderingHelpersResetAndPersistOrderingState) {
     EXPECT_FALSE(vault_manager->has_custom_global_ordering());
 }
 
+TEST_F(VaultManagerTest, JournaledSavesAppendAndReplayOnReopen) {
+    const auto policy = make_test_policy();
+    vault_manager->set_journal_enabled(true);
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+
+    for (int i = 0; i < 20; ++i) {
+        const auto id = "acct-" + std::to_string(i);
+        ASSERT_TRUE(vault_manager->add_account(make_account_detail(id, "Account " + id, "user-" + id)));
+    }
+    ASSERT_TRUE(vault_manager->save_vault());  // Full write: new base image
+    const auto base_size = fs::file_size(test_vault_path);
+
+    auto edited = make_account_detail("acct-3", "Renamed", "user-acct-3");
+    ASSERT_TRUE(vault_manager->update_account(3, edited));
+    ASSERT_TRUE(vault_manager->save_vault());
+    ASSERT_TRUE(vault_manager->delete_account(0));
+    ASSERT_TRUE(vault_manager->save_vault());
+
+    // Both saves appended small records instead of rewriting the vault
+    const auto journaled_size = fs::file_size(test_vault_path);
+    EXPECT_GT(journaled_size, base_size);
+    EXPECT_LT(journaled_size - base_size, base_size);
+
+    const auto expected = vault_manager->get_all_accounts_view();
+    ASSERT_TRUE(vault_manager->close_vault());
+
+    ASSERT_TRUE(vault_manager->open_vault_v2(test_vault_path, test_username, test_password));
+    const auto reopened = vault_manager->get_all_accounts_view();
+    ASSERT_EQ(reopened.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(reopened[i].id, expected[i].id);
+        EXPECT_EQ(reopened[i].account_name, expected[i].account_name);
+    }
+    EXPECT_EQ(reopened.size(), 19u);
+}
+
+TEST_F(VaultManagerTest, JournaledSavesCarryGroupAndOrderChanges) {
+    const auto policy = make_test_policy();
+    vault_manager->set_journal_enabled(true);
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+    for (int i = 0; i < 10; ++i) {
+        const auto id = "acct-" + std::to_string(i);
+        ASSERT_TRUE(vault_manager->add_account(make_account_detail(id, "Account " + id, "user-" + id)));
+    }
+    ASSERT_TRUE(vault_manager->save_vault());
+    const auto base_size = fs::file_size(test_vault_path);
+
+    // Each of these saves through the journal; only the accounts they touch are noted
+    const std::string group_id = vault_manager->create_group("Work");
+    ASSERT_FALSE(group_id.empty());
+    ASSERT_TRUE(vault_manager->add_account_to_group(2, group_id));
+    ASSERT_TRUE(vault_manager->add_account_to_group(7, group_id));
+    ASSERT_TRUE(vault_manager->reorder_account(0, 5));
+    ASSERT_TRUE(vault_manager->remove_account_from_group(7, group_id));
+    ASSERT_GT(fs::file_size(test_vault_path), base_size);
+
+    const auto expected = vault_manager->get_all_accounts_view();
+    ASSERT_TRUE(vault_manager->close_vault());
+
+    ASSERT_TRUE(vault_manager->open_vault_v2(test_vault_path, test_username, test_password));
+    const auto reopened = vault_manager->get_all_accounts_view();
+    ASSERT_EQ(reopened.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(reopened[i].id, expected[i].id);
+        EXPECT_EQ(reopened[i].global_display_order, expected[i].global_display_order);
+        ASSERT_EQ(reopened[i].groups.size(), expected[i].groups.size());
+        for (size_t g = 0; g < expected[i].groups.size(); ++g) {
+            EXPECT_EQ(reopened[i].groups[g].group_id, expected[i].groups[g].group_id);
+        }
+    }
+    EXPECT_TRUE(vault_manager->is_account_in_group(2, group_id));
+    EXPECT_FALSE(vault_manager->is_account_in_group(7, group_id));
+}
+
+TEST_F(VaultManagerTest, CompressedPayloadSavesReopenAndJournal) {
+    const auto policy = make_test_policy();
+    vault_manager->set_journal_enabled(true);
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+    for (int i = 0; i < 40; ++i) {
+        const auto id = "acct-" + std::to_string(i);
+        auto account = make_account_detail(id, "Account " + id, "user-" + id);
+        account.notes = "Security questions: first pet, street grew up on, mother's maiden name.";
+        ASSERT_TRUE(vault_manager->add_account(account));
+    }
+    ASSERT_TRUE(vault_manager->save_vault());
+    const auto plain_size = fs::file_size(test_vault_path);
+
+    // The setting applies to the next full write
+    vault_manager->set_payload_compression(true);
+    ASSERT_TRUE(vault_manager->add_account(make_account_detail("acct-40", "Account 40", "user-40")));
+    ASSERT_TRUE(vault_manager->save_vault());
+    const auto compressed_size = fs::file_size(test_vault_path);
+    EXPECT_LT(compressed_size, plain_size);
+    const auto header = read_file_bytes(test_vault_path);
+    ASSERT_GT(header.size(), 16u);
+    EXPECT_NE(header[16] & 0x0E, 0);
+
+    // Journal records still append behind a compressed base image
+    ASSERT_TRUE(vault_manager->delete_account(0));
+    ASSERT_TRUE(vault_manager->save_vault());
+    EXPECT_GT(fs::file_size(test_vault_path), compressed_size);
+    EXPECT_LT(fs::file_size(test_vault_path), plain_size);
+
+    const auto expected = vault_manager->get_all_accounts_view();
+    ASSERT_TRUE(vault_manager->close_vault());
+
+    vault_manager->set_payload_compression(false);
+    ASSERT_TRUE(vault_manager->open_vault_v2(test_vault_path, test_username, test_password));
+    const auto reopened = vault_manager->get_all_accounts_view();
+    ASSERT_EQ(reopened.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(reopened[i].id, expected[i].id);
+    }
+    auto details = vault_manager->get_account_view(0);
+    ASSERT_TRUE(details.has_value());
+    EXPECT_EQ(details->notes, "Security questions: first pet, street grew up on, mother's maiden name.");
+}
+
+TEST_F(VaultManagerTest, CoalescedSavesDeferWritesUntilFlush) {
+    const auto policy = make_test_policy();
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+    for (const auto* id : {"one", "two", "three"}) {
+        ASSERT_TRUE(vault_manager->add_account(make_account_detail(id, id, std::string("user-") + id)));
+    }
+    ASSERT_TRUE(vault_manager->save_vault());
+
+    // No main loop runs in this test, so nothing is written until a barrier
+    vault_manager->set_save_coalesce_window(std::chrono::milliseconds(100));
+    const auto before = read_file_bytes(test_vault_path);
+    ASSERT_TRUE(vault_manager->reorder_account(0, 2));
+    ASSERT_TRUE(vault_manager->reorder_account(0, 1));
+    const std::string group_id = vault_manager->create_group("Deferred");
+    ASSERT_FALSE(group_id.empty());
+    EXPECT_EQ(read_file_bytes(test_vault_path), before);
+    EXPECT_TRUE(vault_manager->is_modified());  // Unsaved until the write lands
+
+    ASSERT_TRUE(vault_manager->flush_pending_saves());
+    EXPECT_NE(read_file_bytes(test_vault_path), before);
+    EXPECT_FALSE(vault_manager->is_modified());
+
+    // Later edits are flushed by close
+    ASSERT_TRUE(vault_manager->rename_group(group_id, "Renamed"));
+    const auto expected = vault_manager->get_all_accounts_view();
+    ASSERT_TRUE(vault_manager->close_vault());
+
+    ASSERT_TRUE(vault_manager->open_vault_v2(test_vault_path, test_username, test_password));
+    const auto reopened = vault_manager->get_all_accounts_view();
+    ASSERT_EQ(reopened.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        EXPECT_EQ(reopened[i].id, expected[i].id);
+        EXPECT_EQ(reopened[i].global_display_order, expected[i].global_display_order);
+    }
+    const auto groups = vault_manager->get_all_groups_view();
+    EXPECT_TRUE(std::any_of(groups.begin(), groups.end(),
+        [](const KeepTower::GroupView& group) { return group.group_name == "Renamed"; }));
+}
+
+TEST_F(VaultManagerTest, FailedCoalescedSaveIsReported) {
+    const auto policy = make_test_policy();
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+    ASSERT_TRUE(vault_manager->add_account(make_account_detail("one", "One", "user-one")));
+    ASSERT_TRUE(vault_manager->save_vault());
+
+    int failures = 0;
+    vault_manager->set_save_failed_callback([&failures]() { ++failures; });
+    vault_manager->set_save_coalesce_window(std::chrono::milliseconds(20));
+    ASSERT_FALSE(vault_manager->create_group("Deferred").empty());
+    block_vault_writes();
+
+    // Run the main loop until the window closes and the write result comes back
+    const auto context = Glib::MainContext::get_default();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (failures == 0 && std::chrono::steady_clock::now() < deadline) {
+        if (!context->iteration(false)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    EXPECT_EQ(failures, 1);
+    EXPECT_TRUE(vault_manager->is_modified());
+
+    // Until a save succeeds, group edits save synchronously and roll back on failure
+    EXPECT_TRUE(vault_manager->create_group("Second").empty());
+    const auto groups = vault_manager->get_all_groups_view();
+    EXPECT_TRUE(std::any_of(groups.begin(), groups.end(),
+        [](const KeepTower::GroupView& group) { return group.group_name == "Deferred"; }));
+    EXPECT_FALSE(std::any_of(groups.begin(), groups.end(),
+        [](const KeepTower::GroupView& group) { return group.group_name == "Second"; }));
+}
+
+TEST_F(VaultManagerTest, BackupSettingsWaitForBackgroundSave) {
+    const auto policy = make_test_policy();
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+    ASSERT_TRUE(vault_manager->add_account(make_account_detail("one", "One", "user-one")));
+
+    const fs::path first_dir = test_dir / "first_backups";
+    const fs::path second_dir = test_dir / "second_backups";
+    VaultManager::BackupSettings settings = vault_manager->get_backup_settings();
+    settings.enabled = true;
+    settings.count = 10;
+    settings.path = first_dir.string();
+    ASSERT_TRUE(vault_manager->apply_backup_settings(settings));
+    ASSERT_TRUE(vault_manager->save_vault(true));
+    const auto first_backups = KeepTower::VaultIO::list_backups(test_vault_path, first_dir.string()).size();
+
+    // Run the main loop until the debounced snapshot is captured and handed to the worker
+    vault_manager->set_save_coalesce_window(std::chrono::milliseconds(20));
+    const auto before = read_file_bytes(test_vault_path);
+    ASSERT_FALSE(vault_manager->create_group("Deferred").empty());
+    ASSERT_TRUE(vault_manager->is_modified());
+    const auto context = Glib::MainContext::get_default();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (vault_manager->is_modified() && std::chrono::steady_clock::now() < deadline) {
+        if (!context->iteration(false)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    ASSERT_FALSE(vault_manager->is_modified());
+
+    // The setter waits for that write, so it finishes under the old settings
+    settings.path = second_dir.string();
+    ASSERT_TRUE(vault_manager->apply_backup_settings(settings));
+    EXPECT_NE(read_file_bytes(test_vault_path), before);
+    ASSERT_TRUE(vault_manager->set_backup_store("copies"));
+
+    // Later saves use only the new settings
+    ASSERT_TRUE(vault_manager->save_vault(true));
+    EXPECT_EQ(KeepTower::VaultIO::list_backups(test_vault_path, first_dir.string()).size(), first_backups);
+    EXPECT_FALSE(KeepTower::VaultIO::list_backups(test_vault_path, second_dir.string()).empty());
+    EXPECT_EQ(vault_manager->get_backup_settings().path, second_dir.string());
+}
+
 TEST_F(VaultManagerTest, ReorderAccountFailsWhenVaultClosed) {
     EXPECT_FALSE(vault_manager->reorder_account(0, 1));
 }
@@ -576,8 +817,7 @@ TEST_F(VaultManagerTest, ReorderGroup_SuccessAndSaveFailureRollback) {
     ASSERT_NE(second_it, groups.end());
     EXPECT_EQ(second_it->display_order, 0);
 
-    const fs::path blocking_tmp = fs::path(test_vault_path).concat(".tmp");
-    ASSERT_TRUE(fs::create_directory(blocking_tmp));
+    block_vault_writes();
     EXPECT_FALSE(vault_manager->reorder_group(first_group_id, 0));
 }
 
@@ -666,8 +906,7 @@ TEST_F(VaultManagerTest, AddAccountToGroup_SaveFailRollsBack) {
     auto detail = make_account_detail("bank-1", "BankAccount", "alice");
     ASSERT_TRUE(vault_manager->add_account(detail));
 
-    const fs::path blocking_tmp = fs::path(test_vault_path).concat(".tmp");
-    ASSERT_TRUE(fs::create_directory(blocking_tmp));
+    block_vault_writes();
 
     EXPECT_FALSE(vault_manager->add_account_to_group(0, group_id));
     EXPECT_FALSE(vault_manager->is_account_in_group(0, group_id));
@@ -700,8 +939,7 @@ TEST_F(VaultManagerTest, RemoveAccountFromGroup_SaveFailRollsBack) {
     ASSERT_TRUE(vault_manager->add_account(detail));
     ASSERT_TRUE(vault_manager->add_account_to_group(0, group_id));
 
-    const fs::path blocking_tmp = fs::path(test_vault_path).concat(".tmp");
-    ASSERT_TRUE(fs::create_directory(blocking_tmp));
+    block_vault_writes();
 
     EXPECT_FALSE(vault_manager->remove_account_from_group(0, group_id));
     EXPECT_TRUE(vault_manager->is_account_in_group(0, group_id));
@@ -737,8 +975,7 @@ TEST_F(VaultManagerTest, ReorderAccountInGroup_SaveFailRollsBack) {
     ASSERT_TRUE(vault_manager->add_account(detail));
     ASSERT_TRUE(vault_manager->add_account_to_group(0, group_id));
 
-    const fs::path blocking_tmp = fs::path(test_vault_path).concat(".tmp");
-    ASSERT_TRUE(fs::create_directory(blocking_tmp));
+    block_vault_writes();
 
     EXPECT_FALSE(vault_manager->reorder_account_in_group(0, group_id, 5));
 }
@@ -876,3 +1113,60 @@ TEST_F(VaultManagerTest, VerifyCredentialsV2YubiKeyPathUsesInjectedService) {
     EXPECT_EQ(fake_service->last_timeout_ms, VaultManager::YUBIKEY_TIMEOUT_MS);
 }
 
+
+TEST_F(VaultManagerTest, SaveWritesSegmentedPayloadThatReopens) {
+    const auto policy = make_test_policy();
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+    // Enough data to span several stream segments
+    for (int i = 0; i < 400; ++i) {
+        const std::string id = "seg-" + std::to_string(i);
+        ASSERT_TRUE(vault_manager->add_account(make_account_detail(id, id + std::string(200, 'n'), "user-" + id)));
+    }
+    ASSERT_TRUE(vault_manager->save_vault());
+
+    const auto bytes = read_file_bytes(test_vault_path);
+    ASSERT_GE(bytes.size(), 8u);
+    const uint32_t version = static_cast<uint32_t>(bytes[4]) | (static_cast<uint32_t>(bytes[5]) << 8) |
+                             (static_cast<uint32_t>(bytes[6]) << 16) | (static_cast<uint32_t>(bytes[7]) << 24);
+    EXPECT_EQ(version, KeepTower::VaultFileService::FORMAT_VERSION_SEGMENTED_PAYLOAD);
+
+    ASSERT_TRUE(vault_manager->close_vault());
+    ASSERT_TRUE(vault_manager->open_vault_v2(test_vault_path, test_username, test_password));
+    EXPECT_EQ(vault_manager->get_all_accounts_view().size(), 400u);
+}
+
+TEST_F(VaultManagerTest, OpenDefersAccountDetailsUntilNeeded) {
+    const auto policy = make_test_policy();
+    ASSERT_TRUE(vault_manager->create_vault_v2(test_vault_path, test_username, test_password, policy));
+    for (int i = 0; i < 50; ++i) {
+        const std::string id = "lazy-" + std::to_string(i);
+        ASSERT_TRUE(vault_manager->add_account(make_account_detail(id, "Account " + id, "user-" + id)));
+    }
+    ASSERT_TRUE(vault_manager->save_vault());
+    ASSERT_TRUE(vault_manager->close_vault());
+
+    ASSERT_TRUE(vault_manager->open_vault_v2(test_vault_path, test_username, test_password));
+
+    // The list renders from the index tier
+    const auto list = vault_manager->get_all_accounts_view();
+    ASSERT_EQ(list.size(), 50u);
+    EXPECT_EQ(list[7].account_name, "Account lazy-7");
+
+    // Opening a record waits for its details
+    const auto detail = vault_manager->get_account_view(7);
+    ASSERT_TRUE(detail.has_value());
+    EXPECT_TRUE(vault_manager->are_account_details_loaded());
+    EXPECT_EQ(detail->password, "SecretPassword123!");
+    EXPECT_EQ(detail->notes, "notes-for-lazy-7");
+    EXPECT_EQ(detail->email, "lazy-7@example.com");
+
+    // Saving after the merge keeps every field
+    ASSERT_TRUE(vault_manager->save_vault());
+    ASSERT_TRUE(vault_manager->close_vault());
+    ASSERT_TRUE(vault_manager->open_vault_v2(test_vault_path, test_username, test_password));
+    ASSERT_TRUE(vault_manager->ensure_account_details_loaded());
+    const auto reopened = vault_manager->get_account_view(49);
+    ASSERT_TRUE(reopened.has_value());
+    EXPECT_EQ(reopened->password, "SecretPassword123!");
+    EXPECT_EQ(reopened->password_history.size(), 2u);
+}
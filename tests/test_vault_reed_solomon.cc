@@ -205,6 +205,42 @@ TEST_F(VaultReedSolomonTest, OpenRSVault_WithMinorCorruption_Recovers) {
     EXPECT_EQ(account_2->account_name(), "Test");
 }
 
+TEST_F(VaultReedSolomonTest, OpenRSVault_WithCiphertextCorruption_Recovers) {
+    VaultManager manager;
+    configure_for_testing(manager);
+
+    manager.set_reed_solomon_enabled(true);
+    manager.set_rs_redundancy_percent(20);
+    ASSERT_TRUE(manager.create_vault_v2(test_vault_path, test_username, test_password, policy));
+    auto account = createAccount("Example", "user@example.com");
+    ASSERT_TRUE(manager.account_manager()->add_account(account));
+    ASSERT_TRUE(manager.save_vault());
+    ASSERT_TRUE(manager.close_vault());
+
+    // Flip bytes inside the encrypted payload, which GCM alone would reject
+    size_t ciphertext_offset = 0;
+    {
+        const auto file_data = readFileBytes(test_vault_path);
+        auto header_result = KeepTower::VaultFormatV2::read_header(file_data);
+        ASSERT_TRUE(header_result.has_value());
+        EXPECT_NE(header_result->first.data_fec_parity_symbols, 0);
+        ciphertext_offset = header_result->second + KeepTower::VaultFormatV2::DATA_FEC_PREFIX_SIZE;
+    }
+    std::vector<size_t> corrupt_positions;
+    for (size_t i = 0; i < 8; ++i) {
+        corrupt_positions.push_back(ciphertext_offset + 40 + i);
+    }
+    corruptFile(test_vault_path, corrupt_positions);
+
+    VaultManager manager2;
+    configure_for_testing(manager2);
+    ASSERT_TRUE(manager2.open_vault_v2(test_vault_path, test_username, test_password));
+    EXPECT_EQ(manager2.get_account_count(), 1);
+    auto* account_out = manager2.account_manager()->get_account(0);
+    ASSERT_NE(account_out, nullptr);
+    EXPECT_EQ(account_out->account_name(), "Example");
+}
+
 TEST_F(VaultReedSolomonTest, OpenRSVault_WithSevereCorruption_Fails) {
     VaultManager manager;
     configure_for_testing(manager);
@@ -0,0 +1,213 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include <gtest/gtest.h>
+#include "../src/core/services/VaultSaveScheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace KeepTower;
+using namespace std::chrono_literals;
+
+/**
+ * @brief Unit tests for VaultSaveScheduler
+ *
+ * The owner-thread main loop is simulated with a queue that the test drains
+ * explicitly, so capture always happens on the test thread.
+ */
+class VaultSaveSchedulerTest : public ::testing::Test {
+protected:
+    VaultSaveScheduler::PostFn make_post() {
+        return [this](std::function<void()> fn) {
+            std::lock_guard lock(posted_mutex);
+            posted.push_back(std::move(fn));
+        };
+    }
+
+    VaultSaveScheduler::CaptureFn make_capture() {
+        return [this]() -> VaultSaveScheduler::SaveTask {
+            ++captures;
+            const int snapshot = value;
+            return [this, snapshot]() {
+                ++writes;
+                written_value = snapshot;
+                return !fail_writes.load();
+            };
+        };
+    }
+
+    // Run posted callbacks on this thread until one arrives or the timeout expires
+    bool pump_until_posted(std::chrono::milliseconds timeout = 2s) {
+        const auto end = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < end) {
+            std::deque<std::function<void()>> ready;
+            {
+                std::lock_guard lock(posted_mutex);
+                ready.swap(posted);
+            }
+            if (!ready.empty()) {
+                for (auto& fn : ready) {
+                    fn();
+                }
+                return true;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+        return false;
+    }
+
+    std::mutex posted_mutex;
+    std::deque<std::function<void()>> posted;
+    int value = 0;
+    std::atomic<int> captures{0};
+    std::atomic<int> writes{0};
+    std::atomic<int> written_value{-1};
+    std::atomic<bool> fail_writes{false};
+};
+
+TEST_F(VaultSaveSchedulerTest, BurstOfNotificationsCoalescesIntoOneWrite) {
+    VaultSaveScheduler scheduler(make_capture(), make_post(), 20ms);
+
+    for (int i = 1; i <= 50; ++i) {
+        value = i;
+        scheduler.notify_dirty();
+    }
+    EXPECT_TRUE(scheduler.has_pending());
+
+    ASSERT_TRUE(pump_until_posted());
+    scheduler.wait_idle();
+
+    EXPECT_EQ(captures.load(), 1);
+    EXPECT_EQ(writes.load(), 1);
+    EXPECT_EQ(written_value.load(), 50);
+    EXPECT_FALSE(scheduler.has_pending());
+    EXPECT_EQ(scheduler.completed_saves(), 1u);
+}
+
+TEST_F(VaultSaveSchedulerTest, NothingHappensBeforeWindowCloses) {
+    VaultSaveScheduler scheduler(make_capture(), make_post(), 10s);
+
+    scheduler.notify_dirty();
+    EXPECT_FALSE(pump_until_posted(50ms));
+    EXPECT_EQ(captures.load(), 0);
+    EXPECT_EQ(writes.load(), 0);
+    EXPECT_TRUE(scheduler.has_pending());
+}
+
+TEST_F(VaultSaveSchedulerTest, FlushCapturesImmediatelyAndWaits) {
+    VaultSaveScheduler scheduler(make_capture(), make_post(), 10s);
+
+    value = 7;
+    scheduler.notify_dirty();
+    EXPECT_TRUE(scheduler.flush());
+
+    EXPECT_EQ(writes.load(), 1);
+    EXPECT_EQ(written_value.load(), 7);
+    EXPECT_FALSE(scheduler.has_pending());
+
+    // Nothing dirty: flush is a pure barrier
+    EXPECT_TRUE(scheduler.flush());
+    EXPECT_EQ(writes.load(), 1);
+}
+
+TEST_F(VaultSaveSchedulerTest, StaleCaptureRequestAfterFlushIsIgnored) {
+    VaultSaveScheduler scheduler(make_capture(), make_post(), 1ms);
+
+    scheduler.notify_dirty();
+    std::this_thread::sleep_for(20ms);  // Worker posts a capture request
+    EXPECT_TRUE(scheduler.flush());     // ...but flush captures first
+
+    ASSERT_TRUE(pump_until_posted());
+    scheduler.wait_idle();
+    EXPECT_EQ(captures.load(), 1);
+    EXPECT_EQ(writes.load(), 1);
+}
+
+TEST_F(VaultSaveSchedulerTest, CancelPendingDropsNotifications) {
+    VaultSaveScheduler scheduler(make_capture(), make_post(), 10s);
+
+    scheduler.notify_dirty();
+    scheduler.cancel_pending();
+    EXPECT_FALSE(scheduler.has_pending());
+    EXPECT_TRUE(scheduler.flush());
+    EXPECT_EQ(captures.load(), 0);
+}
+
+TEST_F(VaultSaveSchedulerTest, FailedWriteIsReportedUntilCleared) {
+    VaultSaveScheduler scheduler(make_capture(), make_post(), 10s);
+
+    fail_writes = true;
+    scheduler.notify_dirty();
+    EXPECT_FALSE(scheduler.flush());
+    EXPECT_TRUE(scheduler.last_save_failed());
+
+    fail_writes = false;
+    scheduler.notify_dirty();
+    EXPECT_TRUE(scheduler.flush());
+    EXPECT_FALSE(scheduler.last_save_failed());
+
+    fail_writes = true;
+    scheduler.notify_dirty();
+    EXPECT_FALSE(scheduler.flush());
+    scheduler.clear_failure();
+    EXPECT_FALSE(scheduler.last_save_failed());
+}
+
+TEST_F(VaultSaveSchedulerTest, CompletionCallbackRunsOnOwnerThread) {
+    VaultSaveScheduler scheduler(make_capture(), make_post(), 1ms);
+    std::vector<bool> results;
+    std::thread::id reported_on;
+    scheduler.set_completion_callback([&](bool success) {
+        results.push_back(success);
+        reported_on = std::this_thread::get_id();
+    });
+
+    fail_writes = true;
+    scheduler.notify_dirty();
+    ASSERT_TRUE(pump_until_posted());  // Capture
+    scheduler.wait_idle();
+    EXPECT_TRUE(results.empty());      // Not reported from the worker
+    ASSERT_TRUE(pump_until_posted());  // Write result
+    EXPECT_EQ(results, std::vector<bool>{false});
+    EXPECT_EQ(reported_on, std::this_thread::get_id());
+
+    // Writes that flush() waits for are reported once the owner thread runs again
+    fail_writes = false;
+    scheduler.set_window(10s);
+    scheduler.notify_dirty();
+    EXPECT_TRUE(scheduler.flush());
+    EXPECT_EQ(results.size(), 1u);
+    ASSERT_TRUE(pump_until_posted());
+    EXPECT_EQ(results, (std::vector<bool>{false, true}));
+}
+
+TEST_F(VaultSaveSchedulerTest, EmptyCaptureSkipsWrite) {
+    VaultSaveScheduler scheduler(
+        [this]() -> VaultSaveScheduler::SaveTask {
+            ++captures;
+            return {};
+        },
+        make_post(), 10s);
+
+    scheduler.notify_dirty();
+    EXPECT_TRUE(scheduler.flush());
+    EXPECT_EQ(captures.load(), 1);
+    EXPECT_EQ(scheduler.completed_saves(), 0u);
+}
+
+TEST_F(VaultSaveSchedulerTest, PostedCaptureAfterDestructionIsHarmless) {
+    {
+        VaultSaveScheduler scheduler(make_capture(), make_post(), 1ms);
+        scheduler.notify_dirty();
+        std::this_thread::sleep_for(20ms);
+    }
+    // The capture request outlived the scheduler; running it must be a no-op
+    (void)pump_until_posted(50ms);
+    EXPECT_EQ(captures.load(), 0);
+}
@@ -0,0 +1,330 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include <gtest/gtest.h>
+#include "../src/core/services/VaultScrubService.h"
+#include "../src/core/services/VaultFileService.h"
+#include "../src/lib/storage/BackupManifest.h"
+#include "../src/lib/vaultformat/VaultFormatV2.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace KeepTower;
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Unit tests for VaultScrubService
+ *
+ * Vaults are written with write_v2_vault() and a synthetic ciphertext; the
+ * scrubber never decrypts, so no keys are needed.
+ */
+class VaultScrubServiceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = fs::temp_directory_path() / "keeptower_scrub_service_test";
+        fs::remove_all(test_dir);
+        fs::create_directories(test_dir);
+        vault_path = (test_dir / "vault.vault").string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir);
+    }
+
+    void write_vault(uint8_t redundancy = 20, size_t ciphertext_size = 200000) {
+        VaultHeaderV2 vault_header;
+        const std::array<uint8_t, 32> data_salt{1, 2, 3, 4};
+        const std::array<uint8_t, 12> data_iv{};
+        std::vector<uint8_t> ciphertext(ciphertext_size);
+        for (size_t i = 0; i < ciphertext.size(); ++i) {
+            ciphertext[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+        ASSERT_TRUE(VaultFileService::write_v2_vault(
+            vault_path, vault_header, 100000, data_salt, data_iv, ciphertext, true, redundancy).has_value());
+        original = read_all();
+        auto metadata = VaultFileService::read_v2_metadata(original);
+        ASSERT_TRUE(metadata.has_value());
+        data_offset = metadata->data_offset;
+    }
+
+    std::vector<uint8_t> read_all() const {
+        std::ifstream file(vault_path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // Overwrite in place, as bit rot would (same inode, no truncation)
+    void damage(size_t offset, size_t length) const {
+        std::fstream file(vault_path, std::ios::binary | std::ios::in | std::ios::out);
+        for (size_t i = offset; i < offset + length; ++i) {
+            file.seekg(static_cast<std::streamoff>(i));
+            const auto byte = static_cast<char>(file.get() ^ 0x5A);
+            file.seekp(static_cast<std::streamoff>(i));
+            file.put(byte);
+        }
+    }
+
+    std::optional<VaultFileService::FileIdentity> identity() const {
+        const int fd = open(vault_path.c_str(), O_RDONLY);
+        auto result = VaultFileService::file_identity(fd);
+        close(fd);
+        return result;
+    }
+
+    static VaultScrubService::Options no_repair() {
+        VaultScrubService::Options options;
+        options.repair = false;
+        return options;
+    }
+
+    fs::path test_dir;
+    std::string vault_path;
+    std::vector<uint8_t> original;
+    size_t data_offset = 0;
+};
+
+TEST_F(VaultScrubServiceTest, CleanVaultIsReportedCleanWithBaseline) {
+    write_vault();
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Clean);
+    EXPECT_TRUE(scrubbed.report.data_fec);
+    EXPECT_FALSE(scrubbed.report.rewritten);
+    ASSERT_TRUE(scrubbed.baseline.has_value());
+    EXPECT_EQ(scrubbed.baseline->identity, identity());
+
+    // The baseline is consistent with the next pass
+    VaultScrubService::Expectation expected{scrubbed.baseline->identity, scrubbed.baseline->digest, {}, {}};
+    EXPECT_EQ(VaultScrubService::scrub_file(vault_path, expected, {}).report.status,
+              VaultScrubService::FileStatus::Clean);
+}
+
+TEST_F(VaultScrubServiceTest, CorruptedCiphertextIsRepairedInPlace) {
+    write_vault();
+    const size_t segment = data_offset + VaultFormatV2::DATA_FEC_PREFIX_SIZE + 8192;
+    damage(segment, 300);
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Repaired);
+    EXPECT_EQ(scrubbed.report.damaged_windows, 1u);
+    EXPECT_EQ(scrubbed.report.data_bytes_repaired, 300u);
+    EXPECT_TRUE(scrubbed.report.rewritten);
+    EXPECT_EQ(read_all(), original);
+    ASSERT_TRUE(scrubbed.baseline.has_value());
+    EXPECT_EQ(scrubbed.baseline->identity, identity());
+}
+
+TEST_F(VaultScrubServiceTest, CorruptedHeaderIsRepairedInPlace) {
+    write_vault();
+    damage(VaultFormatV2::PREAMBLE_SIZE + 40, 3);
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Repaired);
+    EXPECT_EQ(scrubbed.report.header_bytes_repaired, 3u);
+    EXPECT_EQ(read_all(), original);
+}
+
+TEST_F(VaultScrubServiceTest, DamagedLengthCopyIsRepaired) {
+    write_vault();
+    damage(data_offset + 2, 1);
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Repaired);
+    EXPECT_EQ(scrubbed.report.damaged_length_copies, 1u);
+    EXPECT_EQ(read_all(), original);
+}
+
+TEST_F(VaultScrubServiceTest, RepairCanBeDisabled) {
+    write_vault();
+    damage(data_offset + VaultFormatV2::DATA_FEC_PREFIX_SIZE + 4096, 10);
+    const auto damaged = read_all();
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, no_repair());
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Damaged);
+    EXPECT_EQ(scrubbed.report.damaged_windows, 1u);
+    EXPECT_FALSE(scrubbed.report.rewritten);
+    EXPECT_FALSE(scrubbed.baseline.has_value());
+    EXPECT_EQ(read_all(), damaged);
+}
+
+TEST_F(VaultScrubServiceTest, DamageBeyondFecIsReportedNotWritten) {
+    write_vault();
+    const size_t ciphertext = data_offset + VaultFormatV2::DATA_FEC_PREFIX_SIZE;
+    damage(ciphertext, 64 * 1024);
+    const auto damaged = read_all();
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Damaged);
+    EXPECT_TRUE(scrubbed.report.data_unreadable);
+    EXPECT_EQ(read_all(), damaged);
+}
+
+TEST_F(VaultScrubServiceTest, UnprotectedBytesAreCaughtByTheDigest) {
+    write_vault();
+    auto clean = VaultScrubService::scrub_file(vault_path, {}, {});
+    ASSERT_TRUE(clean.baseline.has_value());
+
+    // The data salt sits outside header FEC; restore the identity so the
+    // change looks like rot rather than a save
+    const auto mtime = fs::last_write_time(vault_path);
+    damage(data_offset - 20, 1);
+    fs::last_write_time(vault_path, mtime);
+    ASSERT_EQ(identity(), clean.baseline->identity);
+
+    VaultScrubService::Expectation expected{clean.baseline->identity, clean.baseline->digest, {}, {}};
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, expected, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Damaged);
+    EXPECT_TRUE(scrubbed.report.digest_mismatch);
+    EXPECT_FALSE(scrubbed.baseline.has_value());
+}
+
+TEST_F(VaultScrubServiceTest, DigestOfAnotherIdentityIsNotCompared) {
+    write_vault();
+    auto clean = VaultScrubService::scrub_file(vault_path, {}, {});
+    ASSERT_TRUE(clean.baseline.has_value());
+
+    // A save rewrote the file: its new contents are not damage
+    original[data_offset - 20] ^= 1;
+    std::ofstream(vault_path, std::ios::binary | std::ios::trunc)
+        .write(reinterpret_cast<const char*>(original.data()), static_cast<std::streamsize>(original.size()));
+
+    VaultScrubService::Expectation expected{clean.baseline->identity, clean.baseline->digest, {}, {}};
+    EXPECT_EQ(VaultScrubService::scrub_file(vault_path, expected, {}).report.status,
+              VaultScrubService::FileStatus::Clean);
+}
+
+TEST_F(VaultScrubServiceTest, BackupIsCheckedAgainstItsManifestEntry) {
+    write_vault();
+    auto entry = BackupManifest::describe(vault_path, 1);
+    ASSERT_TRUE(entry.has_value());
+
+    VaultScrubService::Expectation expected;
+    expected.size = entry->size;
+    expected.header_digest = entry->header_digest;
+    EXPECT_EQ(VaultScrubService::scrub_file(vault_path, expected, {}).report.status,
+              VaultScrubService::FileStatus::Clean);
+
+    // Header damage that FEC repairs still matches the recorded digest
+    damage(VaultFormatV2::PREAMBLE_SIZE + 40, 1);
+    EXPECT_EQ(VaultScrubService::scrub_file(vault_path, expected, {}).report.status,
+              VaultScrubService::FileStatus::Repaired);
+
+    expected.header_digest->at(0) ^= 1;
+    auto mismatched = VaultScrubService::scrub_file(vault_path, expected, {});
+    EXPECT_EQ(mismatched.report.status, VaultScrubService::FileStatus::Damaged);
+    EXPECT_TRUE(mismatched.report.digest_mismatch);
+}
+
+TEST_F(VaultScrubServiceTest, TruncatedJournalIsReportedDamaged) {
+    write_vault();
+    std::ofstream(vault_path, std::ios::binary | std::ios::app) << "torn journal frame";
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Damaged);
+    EXPECT_TRUE(scrubbed.report.journal_damaged);
+}
+
+TEST_F(VaultScrubServiceTest, VaultWithoutDataFecIsStillChecked) {
+    write_vault(0);
+
+    auto scrubbed = VaultScrubService::scrub_file(vault_path, {}, {});
+    EXPECT_EQ(scrubbed.report.status, VaultScrubService::FileStatus::Clean);
+    EXPECT_FALSE(scrubbed.report.data_fec);
+}
+
+TEST_F(VaultScrubServiceTest, NonVaultFilesAreSkipped) {
+    std::ofstream(vault_path, std::ios::binary) << "not a vault";
+    EXPECT_EQ(VaultScrubService::scrub_file(vault_path, {}, {}).report.status,
+              VaultScrubService::FileStatus::Skipped);
+    EXPECT_EQ(VaultScrubService::scrub_file((test_dir / "missing").string(), {}, {}).report.status,
+              VaultScrubService::FileStatus::Skipped);
+}
+
+TEST_F(VaultScrubServiceTest, PaceCanAbandonAFile) {
+    write_vault();
+    VaultScrubService::Options options;
+    options.pace = [](uint64_t) { return false; };
+    EXPECT_EQ(VaultScrubService::scrub_file(vault_path, {}, options).report.status,
+              VaultScrubService::FileStatus::Skipped);
+}
+
+TEST_F(VaultScrubServiceTest, ReplaceIfUnchangedRefusesAChangedFile) {
+    write_vault();
+    const auto before = identity();
+    ASSERT_TRUE(before.has_value());
+
+    // A save replaces the file under the scrubber
+    ASSERT_TRUE(VaultFileService::write_vault_file(vault_path, original, true).has_value());
+
+    const std::span<const uint8_t> image(original);
+    const std::array parts{image};
+    auto result = VaultFileService::replace_vault_file_if_unchanged(vault_path, parts, *before);
+    ASSERT_FALSE(result.has_value());
+    EXPECT_EQ(result.error(), VaultError::Busy);
+
+    const auto current = identity();
+    EXPECT_TRUE(VaultFileService::replace_vault_file_if_unchanged(vault_path, parts, *current).has_value());
+}
+
+TEST_F(VaultScrubServiceTest, WorkerRepairsTheWatchedVault) {
+    write_vault();
+    damage(data_offset + VaultFormatV2::DATA_FEC_PREFIX_SIZE + 4096, 100);
+
+    VaultScrubService::Config config;
+    config.idle_delay = 0ms;
+    config.bytes_per_second = 0;
+    VaultScrubService scrubber(config);
+    EXPECT_FALSE(scrubber.status().watching);
+
+    scrubber.watch(vault_path, "");
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (scrubber.completed_passes() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(5ms);
+    }
+    ASSERT_EQ(scrubber.completed_passes(), 1u);
+
+    const auto status = scrubber.status();
+    EXPECT_TRUE(status.watching);
+    ASSERT_TRUE(status.last_pass.has_value());
+    ASSERT_FALSE(status.last_pass->files.empty());
+    EXPECT_EQ(status.last_pass->files.front().path, vault_path);
+    EXPECT_EQ(status.last_pass->count(VaultScrubService::FileStatus::Repaired), 1u);
+    EXPECT_EQ(read_all(), original);
+
+    scrubber.unwatch();
+    EXPECT_FALSE(scrubber.status().watching);
+}
+
+TEST_F(VaultScrubServiceTest, RecentActivityHoldsBackAPass) {
+    write_vault();
+
+    VaultScrubService::Config config;
+    config.idle_delay = 1h;
+    VaultScrubService scrubber(config);
+    scrubber.watch(vault_path, "");
+    scrubber.notify_activity();
+    std::this_thread::sleep_for(50ms);
+    EXPECT_EQ(scrubber.completed_passes(), 0u);
+
+    // An explicit request does not wait for the process to go idle
+    scrubber.request_pass();
+    const auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (scrubber.completed_passes() == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(5ms);
+    }
+    EXPECT_EQ(scrubber.completed_passes(), 1u);
+}
+
+TEST(VaultScrubServiceStatusTest, StatusNames) {
+    EXPECT_STREQ(to_string(VaultScrubService::FileStatus::Clean), "clean");
+    EXPECT_STREQ(to_string(VaultScrubService::FileStatus::Repaired), "repaired");
+    EXPECT_STREQ(to_string(VaultScrubService::FileStatus::Damaged), "damaged");
+    EXPECT_STREQ(to_string(VaultScrubService::FileStatus::Skipped), "skipped");
+}
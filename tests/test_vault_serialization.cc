@@ -12,6 +12,7 @@
 #include <gtest/gtest.h>
 #include "../src/lib/vaultformat/VaultSerialization.h"
 #include "record.pb.h"
+#include <algorithm>
 
 using namespace KeepTower;
 
@@ -839,4 +840,174 @@ TEST_F(VaultSerializationTest, MigratePreservesUnknownSchemaVersion) {
     EXPECT_EQ(future_vault.metadata().schema_version(), 999);
     EXPECT_EQ(future_vault.metadata().access_count(), 11);
     EXPECT_TRUE(modified);
-}
\ No newline at end of file
+}
+// ============================================================================
+// Two-Tier Payload Tests
+// ============================================================================
+
+TEST_F(VaultSerializationTest, TieredRoundTripRestoresAllFields) {
+    auto* account = vault_data.mutable_accounts(0);
+    account->add_tags("work");
+    account->set_is_favorite(true);
+    account->add_password_history("old-pass");
+    auto* field = account->add_custom_fields();
+    field->set_name("PIN");
+    field->set_value("1234");
+    account->mutable_totp()->set_secret("JBSWY3DP");
+    auto* membership = account->add_groups();
+    membership->set_group_id("group-1");
+    membership->set_display_order(3);
+    vault_data.mutable_metadata()->set_name("Tiered");
+
+    auto second = *account;
+    second.set_id("test-account-2");
+    second.set_notes("Second notes");
+    *vault_data.add_accounts() = second;
+
+    auto payload = VaultSerialization::serialize_tiered(vault_data);
+    ASSERT_TRUE(payload.has_value());
+    ASSERT_TRUE(VaultSerialization::tiered_index_end(*payload).has_value());
+
+    auto restored = VaultSerialization::deserialize_payload(*payload);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored->SerializeAsString(), vault_data.SerializeAsString());
+}
+
+TEST_F(VaultSerializationTest, TieredIndexHoldsOnlyListFields) {
+    vault_data.mutable_accounts(0)->add_tags("work");
+    auto payload = VaultSerialization::serialize_tiered(vault_data);
+    ASSERT_TRUE(payload.has_value());
+
+    const auto index_end = VaultSerialization::tiered_index_end(*payload);
+    ASSERT_TRUE(index_end.has_value());
+    const std::span<const uint8_t> bytes(*payload);
+    auto index = VaultSerialization::deserialize(
+        bytes.subspan(VaultSerialization::TIERED_PREFIX_LENGTH,
+                      *index_end - VaultSerialization::TIERED_PREFIX_LENGTH));
+    ASSERT_TRUE(index.has_value());
+    ASSERT_EQ(index->accounts_size(), 1);
+
+    const auto& listed = index->accounts(0);
+    EXPECT_EQ(listed.id(), "test-account-1");
+    EXPECT_EQ(listed.account_name(), "Test Account");
+    EXPECT_EQ(listed.user_name(), "testuser");
+    EXPECT_EQ(listed.website(), "https://example.com");
+    EXPECT_EQ(listed.tags_size(), 1);
+    EXPECT_TRUE(listed.password().empty());
+    EXPECT_TRUE(listed.notes().empty());
+    EXPECT_EQ(listed.created_at(), 0);
+}
+
+TEST_F(VaultSerializationTest, MergeDetailsMatchesByIdAfterIndexEdits) {
+    auto* second = vault_data.add_accounts();
+    second->set_id("test-account-2");
+    second->set_account_name("Second");
+    second->set_password("second-pass");
+
+    auto payload = VaultSerialization::serialize_tiered(vault_data);
+    ASSERT_TRUE(payload.has_value());
+    const auto index_end = VaultSerialization::tiered_index_end(*payload);
+    ASSERT_TRUE(index_end.has_value());
+    const std::span<const uint8_t> bytes(*payload);
+    auto index = VaultSerialization::deserialize(
+        bytes.subspan(VaultSerialization::TIERED_PREFIX_LENGTH,
+                      *index_end - VaultSerialization::TIERED_PREFIX_LENGTH));
+    auto details = VaultSerialization::deserialize(bytes.subspan(*index_end));
+    ASSERT_TRUE(index.has_value());
+    ASSERT_TRUE(details.has_value());
+
+    // List-level edits made before the bulk tier arrives survive the merge
+    index->mutable_accounts()->erase(index->mutable_accounts()->begin());
+    index->mutable_accounts(0)->set_account_name("Renamed");
+    VaultSerialization::merge_account_details(*index, *details);
+
+    ASSERT_EQ(index->accounts_size(), 1);
+    EXPECT_EQ(index->accounts(0).account_name(), "Renamed");
+    EXPECT_EQ(index->accounts(0).password(), "second-pass");
+}
+
+TEST_F(VaultSerializationTest, PreparedPayloadWritesSameBytesIntoCallerBuffer) {
+    for (bool unique_ids : {true, false}) {
+        if (!unique_ids) {
+            vault_data.add_accounts()->set_id("test-account-1");
+        }
+        auto expected = VaultSerialization::serialize_tiered(vault_data);
+        auto prepared = VaultSerialization::prepare_tiered(vault_data);
+        ASSERT_TRUE(expected.has_value());
+        ASSERT_TRUE(prepared.has_value());
+        EXPECT_EQ(prepared->tiered, unique_ids);
+        ASSERT_EQ(prepared->size(), expected->size());
+
+        std::vector<uint8_t> buffer(prepared->size() + 8, 0xCC);
+        std::span<uint8_t> out(buffer.data() + 8, prepared->size());
+        ASSERT_TRUE(VaultSerialization::write_payload(*prepared, out).has_value());
+        EXPECT_TRUE(std::equal(out.begin(), out.end(), expected->begin()));
+
+        EXPECT_FALSE(VaultSerialization::write_payload(*prepared, std::span<uint8_t>(buffer)).has_value());
+    }
+}
+
+TEST_F(VaultSerializationTest, TieredFallsBackWhenIdsAreNotUnique) {
+    vault_data.add_accounts()->set_id("test-account-1");
+    auto payload = VaultSerialization::serialize_tiered(vault_data);
+    ASSERT_TRUE(payload.has_value());
+    EXPECT_FALSE(VaultSerialization::tiered_index_end(*payload).has_value());
+
+    auto restored = VaultSerialization::deserialize_payload(*payload);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored->accounts_size(), 2);
+}
+
+TEST_F(VaultSerializationTest, CompressedPayloadRoundTripsAndShrinks) {
+    for (int i = 0; i < 50; ++i) {
+        auto* account = vault_data.add_accounts();
+        account->set_id("account-" + std::to_string(i));
+        account->set_account_name("Account " + std::to_string(i));
+        account->set_notes("Recovery codes are kept in the safe deposit box at the usual branch.");
+        account->add_groups()->set_group_id("5f0c6a2e-8d1b-4c3e-9a7f-2b6d4e8f1a3c");
+    }
+    auto prepared = VaultSerialization::prepare_tiered(vault_data);
+    ASSERT_TRUE(prepared.has_value());
+
+    std::vector<uint8_t> buffer(VaultSerialization::compressed_payload_bound(prepared->size()));
+    auto compressed_size = VaultSerialization::write_compressed_payload(*prepared, buffer);
+    ASSERT_TRUE(compressed_size.has_value());
+    EXPECT_LT(*compressed_size, prepared->size() / 2);
+
+    auto payload = VaultSerialization::decompress_payload(std::span<const uint8_t>(buffer).first(*compressed_size));
+    ASSERT_TRUE(payload.has_value());
+    auto expected = VaultSerialization::serialize_tiered(vault_data);
+    ASSERT_TRUE(expected.has_value());
+    EXPECT_EQ(*payload, *expected);
+
+    auto restored = VaultSerialization::deserialize_payload(*payload);
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored->SerializeAsString(), vault_data.SerializeAsString());
+
+    // Undersized output buffers are refused rather than truncated
+    EXPECT_FALSE(VaultSerialization::write_compressed_payload(
+        *prepared, std::span<uint8_t>(buffer).first(*compressed_size)).has_value());
+}
+
+TEST_F(VaultSerializationTest, DecompressRejectsDamagedStreams) {
+    auto prepared = VaultSerialization::prepare_tiered(vault_data);
+    ASSERT_TRUE(prepared.has_value());
+    std::vector<uint8_t> buffer(VaultSerialization::compressed_payload_bound(prepared->size()));
+    auto compressed_size = VaultSerialization::write_compressed_payload(*prepared, buffer);
+    ASSERT_TRUE(compressed_size.has_value());
+    buffer.resize(*compressed_size);
+
+    auto truncated = buffer;
+    truncated.pop_back();
+    EXPECT_FALSE(VaultSerialization::decompress_payload(truncated).has_value());
+
+    auto wrong_size = buffer;
+    wrong_size[0] ^= 0x01;
+    EXPECT_FALSE(VaultSerialization::decompress_payload(wrong_size).has_value());
+
+    auto oversized = buffer;
+    oversized[7] = 0xFF;
+    EXPECT_FALSE(VaultSerialization::decompress_payload(oversized).has_value());
+
+    EXPECT_FALSE(VaultSerialization::decompress_payload(std::span<const uint8_t>(buffer).first(4)).has_value());
+}
@@ -0,0 +1,256 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include <gtest/gtest.h>
+#include "../src/core/VaultManager.h"
+#include "../src/core/services/VaultVerificationService.h"
+#include "../src/core/services/VaultFileService.h"
+#include "../src/lib/storage/VaultIO.h"
+#include "../src/lib/vaultformat/VaultFormatV2.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+using namespace KeepTower;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Unit tests for VaultVerificationService
+ *
+ * Structural checks use vaults written by write_v2_vault() around a synthetic
+ * ciphertext; credential checks need a real vault, created with VaultManager.
+ */
+class VaultVerificationServiceTest : public ::testing::Test {
+protected:
+    using FileStatus = VaultVerificationService::FileStatus;
+    using Stage = VaultVerificationService::Stage;
+    using CredentialStatus = VaultVerificationService::CredentialStatus;
+
+    void SetUp() override {
+        test_dir = fs::temp_directory_path() / "keeptower_verification_service_test";
+        fs::remove_all(test_dir);
+        fs::create_directories(test_dir);
+        vault_path = (test_dir / "vault.vault").string();
+    }
+
+    void TearDown() override {
+        fs::remove_all(test_dir);
+    }
+
+    void write_vault(uint8_t redundancy = 20) {
+        VaultHeaderV2 vault_header;
+        const std::array<uint8_t, 32> data_salt{1, 2, 3, 4};
+        const std::array<uint8_t, 12> data_iv{};
+        std::vector<uint8_t> ciphertext(200000);
+        for (size_t i = 0; i < ciphertext.size(); ++i) {
+            ciphertext[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+        ASSERT_TRUE(VaultFileService::write_v2_vault(
+            vault_path, vault_header, 100000, data_salt, data_iv, ciphertext, true, redundancy).has_value());
+        auto metadata = VaultFileService::read_v2_metadata(read_all());
+        ASSERT_TRUE(metadata.has_value());
+        data_offset = metadata->data_offset;
+    }
+
+    void create_real_vault() {
+        VaultManager manager;
+        manager.set_reed_solomon_enabled(false);
+        VaultSecurityPolicy policy;
+        policy.require_yubikey = false;
+        policy.min_password_length = 12;
+        policy.pbkdf2_iterations = 100000;
+        policy.password_history_depth = 0;
+        ASSERT_TRUE(manager.create_vault_v2(vault_path, "admin", "correct_password", policy));
+        ASSERT_TRUE(manager.close_vault());
+    }
+
+    std::vector<uint8_t> read_all() const {
+        std::ifstream file(vault_path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void damage(size_t offset, size_t length) const {
+        std::fstream file(vault_path, std::ios::binary | std::ios::in | std::ios::out);
+        for (size_t i = offset; i < offset + length; ++i) {
+            file.seekg(static_cast<std::streamoff>(i));
+            const auto byte = static_cast<char>(file.get() ^ 0x5A);
+            file.seekp(static_cast<std::streamoff>(i));
+            file.put(byte);
+        }
+    }
+
+    static VaultVerificationService::Credential credential(const std::string& user, const std::string& password) {
+        return {user, password};
+    }
+
+    fs::path test_dir;
+    std::string vault_path;
+    size_t data_offset = 0;
+};
+
+TEST_F(VaultVerificationServiceTest, IntactVaultPassesEveryCheck) {
+    write_vault();
+
+    const auto report = VaultVerificationService().verify(vault_path);
+    EXPECT_EQ(report.status, FileStatus::Intact);
+    EXPECT_EQ(report.failed_stage, Stage::None);
+    EXPECT_FALSE(report.error.has_value());
+    EXPECT_EQ(report.path, vault_path);
+    EXPECT_EQ(report.size, fs::file_size(vault_path));
+    EXPECT_TRUE(report.header_fec);
+    EXPECT_TRUE(report.data_fec);
+    EXPECT_EQ(report.damaged_windows, 0u);
+    EXPECT_EQ(report.credential, CredentialStatus::NotChecked);
+}
+
+TEST_F(VaultVerificationServiceTest, CorrectableDamageIsDegraded) {
+    write_vault();
+    damage(data_offset + VaultFormatV2::DATA_FEC_PREFIX_SIZE + 8192, 300);
+
+    const auto report = VaultVerificationService().verify(vault_path);
+    EXPECT_EQ(report.status, FileStatus::Degraded);
+    EXPECT_EQ(report.damaged_windows, 1u);
+    EXPECT_EQ(report.repaired_bytes, 300u);
+    EXPECT_TRUE(VaultVerificationService::is_restorable(vault_path));
+}
+
+TEST_F(VaultVerificationServiceTest, DamageBeyondFecFailsTheDataCheck) {
+    write_vault();
+    damage(data_offset + VaultFormatV2::DATA_FEC_PREFIX_SIZE, 64 * 1024);
+
+    const auto report = VaultVerificationService().verify(vault_path);
+    EXPECT_EQ(report.status, FileStatus::Damaged);
+    EXPECT_EQ(report.failed_stage, Stage::Data);
+    EXPECT_TRUE(report.error.has_value());
+    EXPECT_FALSE(VaultVerificationService::is_restorable(vault_path));
+}
+
+TEST_F(VaultVerificationServiceTest, TruncatedHeaderFailsTheHeaderCheck) {
+    write_vault();
+    fs::resize_file(vault_path, VaultFormatV2::PREAMBLE_SIZE + 16);
+
+    const auto report = VaultVerificationService().verify(vault_path);
+    EXPECT_EQ(report.status, FileStatus::Damaged);
+    EXPECT_EQ(report.failed_stage, Stage::Header);
+}
+
+TEST_F(VaultVerificationServiceTest, TornJournalTailIsDegraded) {
+    write_vault();
+    std::ofstream(vault_path, std::ios::binary | std::ios::app) << "torn journal frame";
+
+    const auto report = VaultVerificationService().verify(vault_path);
+    EXPECT_EQ(report.status, FileStatus::Degraded);
+    EXPECT_TRUE(report.journal_torn);
+    EXPECT_EQ(report.journal_frames, 0u);
+}
+
+TEST_F(VaultVerificationServiceTest, OtherFilesAreUnsupportedOrUnreadable) {
+    std::ofstream(vault_path, std::ios::binary) << "not a vault";
+    EXPECT_EQ(VaultVerificationService().verify(vault_path).status, FileStatus::Unsupported);
+
+    const auto missing = VaultVerificationService().verify((test_dir / "missing").string());
+    EXPECT_EQ(missing.status, FileStatus::Damaged);
+    EXPECT_EQ(missing.failed_stage, Stage::File);
+}
+
+TEST_F(VaultVerificationServiceTest, CorrectPasswordAuthenticatesTheCiphertext) {
+    create_real_vault();
+
+    const VaultVerificationService verifier(credential("admin", "correct_password"));
+    const auto report = verifier.verify(vault_path);
+    EXPECT_EQ(report.status, FileStatus::Intact);
+    EXPECT_EQ(report.credential, CredentialStatus::Verified);
+    EXPECT_EQ(report.active_key_slots, 1u);
+
+    // A second file with the same slot reuses the cached KEK
+    const auto copy = (test_dir / "copy.vault").string();
+    fs::copy_file(vault_path, copy);
+    EXPECT_EQ(verifier.verify(copy).credential, CredentialStatus::Verified);
+}
+
+TEST_F(VaultVerificationServiceTest, WrongPasswordOrUserIsReportedButNotDamage) {
+    create_real_vault();
+
+    const auto rejected = VaultVerificationService(credential("admin", "wrong_password")).verify(vault_path);
+    EXPECT_EQ(rejected.status, FileStatus::Intact);
+    EXPECT_EQ(rejected.credential, CredentialStatus::Rejected);
+
+    const auto unknown = VaultVerificationService(credential("nobody", "correct_password")).verify(vault_path);
+    EXPECT_EQ(unknown.status, FileStatus::Intact);
+    EXPECT_EQ(unknown.credential, CredentialStatus::NoSuchUser);
+}
+
+TEST_F(VaultVerificationServiceTest, AlteredCiphertextFailsAuthentication) {
+    create_real_vault();
+    auto metadata = VaultFileService::read_v2_metadata(read_all());
+    ASSERT_TRUE(metadata.has_value());
+    damage(metadata->data_offset + 20, 1);
+
+    // Without FEC the structure still looks fine; only the tag catches it
+    EXPECT_EQ(VaultVerificationService().verify(vault_path).status, FileStatus::Intact);
+
+    const auto report = VaultVerificationService(credential("admin", "correct_password")).verify(vault_path);
+    EXPECT_EQ(report.status, FileStatus::Damaged);
+    EXPECT_EQ(report.failed_stage, Stage::Credential);
+    EXPECT_EQ(report.credential, CredentialStatus::TagMismatch);
+}
+
+TEST_F(VaultVerificationServiceTest, VerifyAllKeepsTheOrderGiven) {
+    write_vault();
+    const auto other = (test_dir / "other.vault").string();
+    std::ofstream(other, std::ios::binary) << "not a vault";
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < 8; ++i) {
+        paths.push_back(i % 2 == 0 ? vault_path : other);
+    }
+    const auto reports = VaultVerificationService().verify_all(paths, 3);
+    ASSERT_EQ(reports.size(), paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        EXPECT_EQ(reports[i].path, paths[i]);
+        EXPECT_EQ(reports[i].status, i % 2 == 0 ? FileStatus::Intact : FileStatus::Unsupported);
+    }
+    EXPECT_TRUE(VaultVerificationService().verify_all({}).empty());
+}
+
+TEST_F(VaultVerificationServiceTest, RestoreSkipsBackupsTheValidatorRejects) {
+    write_vault();
+    const auto original = read_all();
+
+    auto good = VaultIO::create_backup(vault_path);
+    ASSERT_TRUE(good.has_value());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    auto bad = VaultIO::create_backup(vault_path);
+    ASSERT_TRUE(bad.has_value());
+
+    std::ofstream(vault_path, std::ios::binary | std::ios::trunc) << "lost";
+
+    std::vector<std::string> offered;
+    const auto accept = [&](const std::string& backup) {
+        offered.push_back(backup);
+        return backup != *bad;
+    };
+    ASSERT_TRUE(VaultIO::restore_from_backup(vault_path, "", accept).has_value());
+    EXPECT_EQ(read_all(), original);
+    ASSERT_EQ(offered.size(), 2u);
+    EXPECT_EQ(offered[0], *bad) << "Newest backup is offered first";
+
+    const auto reject_all = [](const std::string&) { return false; };
+    EXPECT_FALSE(VaultIO::restore_from_backup(vault_path, "", reject_all).has_value());
+}
+
+TEST(VaultVerificationServiceNamesTest, MachineReadableNames) {
+    using Service = VaultVerificationService;
+    EXPECT_STREQ(to_string(Service::FileStatus::Intact), "intact");
+    EXPECT_STREQ(to_string(Service::FileStatus::Degraded), "degraded");
+    EXPECT_STREQ(to_string(Service::FileStatus::Damaged), "damaged");
+    EXPECT_STREQ(to_string(Service::FileStatus::Unsupported), "unsupported");
+    EXPECT_STREQ(to_string(Service::Stage::None), "none");
+    EXPECT_STREQ(to_string(Service::Stage::Credential), "credential");
+    EXPECT_STREQ(to_string(Service::CredentialStatus::NotChecked), "not_checked");
+    EXPECT_STREQ(to_string(Service::CredentialStatus::NeedsYubiKey), "needs_yubikey");
+    EXPECT_STREQ(to_string(Service::CredentialStatus::TagMismatch), "tag_mismatch");
+}
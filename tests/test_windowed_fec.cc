@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include <gtest/gtest.h>
+#include "../src/lib/fec/WindowedFec.h"
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using KeepTower::WindowedFec;
+
+namespace {
+
+std::vector<uint8_t> random_bytes(size_t size, uint32_t seed) {
+    std::vector<uint8_t> data(size);
+    std::mt19937 rng(seed);
+    for (auto& b : data) {
+        b = static_cast<uint8_t>(rng());
+    }
+    return data;
+}
+
+std::vector<uint8_t> encode(const WindowedFec& fec, std::span<const uint8_t> data) {
+    std::vector<uint8_t> trailer(fec.trailer_size(data.size()));
+    EXPECT_TRUE(fec.encode(data, trailer));
+    return trailer;
+}
+
+}  // namespace
+
+/**
+ * @brief Test that clean data passes the checksums without decoding
+ */
+TEST(WindowedFecTest, CleanDataHasNoDamagedWindows) {
+    const WindowedFec fec(24, 64 * 1024);
+    for (size_t size : {size_t{1}, size_t{230}, size_t{4096}, size_t{64 * 1024}, size_t{200 * 1024 + 7}}) {
+        const auto data = random_bytes(size, static_cast<uint32_t>(size));
+        const auto trailer = encode(fec, data);
+        auto damaged = fec.find_damaged(data, trailer);
+        ASSERT_TRUE(damaged.has_value()) << size;
+        EXPECT_TRUE(damaged->empty()) << size;
+    }
+}
+
+/**
+ * @brief Test that the trailer costs about the parity ratio
+ */
+TEST(WindowedFecTest, TrailerSizeFollowsParity) {
+    const WindowedFec fec(24);
+    const size_t size = 8 * 1024 * 1024;
+    const double overhead = static_cast<double>(fec.trailer_size(size)) / size;
+    EXPECT_GT(overhead, 24.0 / 231.0);
+    EXPECT_LT(overhead, 24.0 / 231.0 + 0.01);
+    EXPECT_EQ(fec.trailer_size(0), 0u);
+    EXPECT_EQ(fec.window_count(size), 8u);
+
+    std::vector<uint8_t> data(100);
+    std::vector<uint8_t> wrong(fec.trailer_size(data.size()) + 1);
+    EXPECT_FALSE(fec.encode(data, wrong));
+    EXPECT_FALSE(fec.find_damaged(data, wrong).has_value());
+}
+
+/**
+ * @brief Test that a burst inside one window is repaired in place
+ */
+TEST(WindowedFecTest, RepairsBurstInDamagedWindow) {
+    const WindowedFec fec(24, 256 * 1024);
+    const auto original = random_bytes(1024 * 1024 + 5000, 3);
+    const auto trailer = encode(fec, original);
+
+    // Window 2 has about 1135 codewords: 20 KiB costs each ~18 erasures of 24
+    auto data = original;
+    const size_t start = 2 * 256 * 1024 + 1000;
+    for (size_t i = start; i < start + 20 * 1024; ++i) {
+        data[i] ^= 0xFF;
+    }
+
+    auto damaged = fec.find_damaged(data, trailer);
+    ASSERT_TRUE(damaged.has_value());
+    ASSERT_EQ(*damaged, std::vector<size_t>{2});
+
+    auto changed = fec.repair(data, trailer, *damaged);
+    ASSERT_TRUE(changed.has_value());
+    EXPECT_EQ(*changed, 20u * 1024);
+    EXPECT_EQ(data, original);
+}
+
+/**
+ * @brief Test that damage to the trailer itself is harmless
+ */
+TEST(WindowedFecTest, DamagedTrailerRepairsNothing) {
+    const WindowedFec fec(12, 16 * 1024);
+    const auto original = random_bytes(50000, 4);
+    auto trailer = encode(fec, original);
+    trailer[10] ^= 0x01;               // Parity of window 0
+    trailer[trailer.size() - 1] ^= 0x80;  // Last parity checksum
+
+    auto data = original;
+    auto damaged = fec.find_damaged(data, trailer);
+    ASSERT_TRUE(damaged.has_value());
+    EXPECT_EQ(damaged->size(), 2u);
+
+    auto changed = fec.repair(data, trailer, *damaged);
+    ASSERT_TRUE(changed.has_value());
+    EXPECT_EQ(*changed, 0u);
+    EXPECT_EQ(data, original);
+}
+
+/**
+ * @brief Test that damage beyond capacity is reported, not miscorrected
+ */
+TEST(WindowedFecTest, RejectsDamageBeyondCapacity) {
+    const WindowedFec fec(12, 64 * 1024);
+    const auto original = random_bytes(64 * 1024, 5);
+    const auto trailer = encode(fec, original);
+
+    auto data = random_bytes(64 * 1024, 6);
+    auto damaged = fec.find_damaged(data, trailer);
+    ASSERT_TRUE(damaged.has_value());
+    ASSERT_EQ(damaged->size(), 1u);
+    EXPECT_FALSE(fec.repair(data, trailer, *damaged).has_value());
+
+    const size_t out_of_range[] = {7};
+    EXPECT_FALSE(fec.repair(data, trailer, out_of_range).has_value());
+}
+
+/**
+ * @brief Test that worker threads produce the serial trailer
+ */
+TEST(WindowedFecTest, ThreadedMatchesSerial) {
+    const WindowedFec fec(44, 128 * 1024);
+    const auto data = random_bytes(3 * 1024 * 1024 + 123, 7);
+
+    std::vector<uint8_t> serial(fec.trailer_size(data.size()));
+    std::vector<uint8_t> threaded(serial.size());
+    ASSERT_TRUE(fec.encode(data, serial, 1));
+    ASSERT_TRUE(fec.encode(data, threaded, 4));
+    EXPECT_EQ(serial, threaded);
+
+    auto damaged_data = data;
+    for (size_t i = 0; i < damaged_data.size(); i += 300 * 1024) {
+        damaged_data[i] ^= 0x5A;
+    }
+    auto damaged = fec.find_damaged(damaged_data, threaded, 4);
+    ASSERT_TRUE(damaged.has_value());
+    auto changed = fec.repair(damaged_data, threaded, *damaged, 4);
+    ASSERT_TRUE(changed.has_value());
+    EXPECT_EQ(damaged_data, data);
+}
+
+/**
+ * @brief Test parameter validation
+ */
+TEST(WindowedFecTest, ValidatesParameters) {
+    EXPECT_TRUE(WindowedFec::valid_parameters(24, WindowedFec::DEFAULT_WINDOW_SIZE));
+    EXPECT_FALSE(WindowedFec::valid_parameters(0, WindowedFec::DEFAULT_WINDOW_SIZE));
+    EXPECT_FALSE(WindowedFec::valid_parameters(255, WindowedFec::DEFAULT_WINDOW_SIZE));
+    EXPECT_FALSE(WindowedFec::valid_parameters(24, WindowedFec::MIN_WINDOW_SIZE - 1));
+    EXPECT_FALSE(WindowedFec::valid_parameters(24, WindowedFec::MAX_WINDOW_SIZE + 1));
+    EXPECT_THROW(WindowedFec(0), std::invalid_argument);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,61 @@
+// SPDX-License-Identifier: GPL-3.0-or-later
+// Copyright (C) 2026 KeepTower Contributors
+
+#include <gtest/gtest.h>
+#include "utils/WorkerRanges.h"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace KeepTower;
+
+TEST(WorkerRangesTest, WorkerCountStaysWithinUnitsAndCap) {
+    EXPECT_EQ(worker_count(8, 100, 100, 1), 8u);
+    EXPECT_EQ(worker_count(8, 3, 100, 1), 3u);       // No more threads than units
+    EXPECT_EQ(worker_count(8, 100, 10, 4), 2u);      // Too little work for more
+    EXPECT_EQ(worker_count(8, 100, 0, 4), 1u);
+    EXPECT_EQ(worker_count(8, 0, 0, 4), 1u);
+    EXPECT_GE(worker_count(0, 100, 100, 1), 1u);     // 0 = hardware concurrency
+}
+
+TEST(WorkerRangesTest, RangesCoverEveryUnitOnce) {
+    for (size_t threads : {1u, 2u, 3u, 7u}) {
+        std::vector<std::atomic<int>> hits(50);
+        std::mutex mutex;
+        std::vector<std::pair<size_t, size_t>> ranges;
+        EXPECT_TRUE(for_each_range(hits.size(), threads, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                ++hits[i];
+            }
+            std::lock_guard lock(mutex);
+            ranges.emplace_back(first, last);
+            return true;
+        }));
+        for (const auto& hit : hits) {
+            EXPECT_EQ(hit.load(), 1);
+        }
+        EXPECT_EQ(ranges.size(), threads);
+    }
+}
+
+TEST(WorkerRangesTest, FailedRangeFailsTheJob) {
+    EXPECT_FALSE(for_each_range(40, 4, [](size_t first, size_t) { return first != 10; }));
+    EXPECT_FALSE(for_each_range(40, 1, [](size_t, size_t) { return false; }));
+}
+
+TEST(WorkerRangesTest, RunWorkersDrainsSharedQueue) {
+    for (size_t threads : {0u, 1u, 4u}) {
+        std::vector<std::atomic<int>> hits(100);
+        std::atomic<size_t> next{0};
+        run_workers(threads, [&]() {
+            for (size_t i = next.fetch_add(1); i < hits.size(); i = next.fetch_add(1)) {
+                ++hits[i];
+            }
+        });
+        for (const auto& hit : hits) {
+            EXPECT_EQ(hit.load(), 1);
+        }
+    }
+}